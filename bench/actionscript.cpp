@@ -0,0 +1,110 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for the ActionScript interpreter.
+ */
+
+#include "src/common/types.h"
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+
+#include "src/aurora/actionscript/asbuffer.h"
+#include "src/aurora/actionscript/avm.h"
+
+#include "bench/bench.h"
+
+/** Number of frames replayed in each iteration. */
+static const size_t kFrameCount = 2000;
+
+/** Method calls made every frame. */
+static const size_t kCallsPerFrame = 5;
+
+/*
+ *  class Test {
+ *      private var i;
+ *
+ *      public function Test() {
+ *          i = 1;
+ *      }
+ *
+ *      public function inc() {
+ *          i += 1;
+ *  	}
+ *
+ *  	public function dec() {
+ *  		i -= 1;
+ *  	}
+ *
+ *  	public function getI() {
+ *  		return i;
+ *  	}
+ *  }
+ */
+static const byte kTestClass[] = {
+	0x88, 0x37, 0x00, 0x08, 0x00, 0x54, 0x65, 0x73, 0x74, 0x00, 0x5f, 0x67,
+	0x6c, 0x6f, 0x62, 0x61, 0x6c, 0x00, 0x69, 0x00, 0x70, 0x72, 0x6f, 0x74,
+	0x6f, 0x74, 0x79, 0x70, 0x65, 0x00, 0x69, 0x6e, 0x63, 0x00, 0x64, 0x65,
+	0x63, 0x00, 0x67, 0x65, 0x74, 0x49, 0x00, 0x41, 0x53, 0x53, 0x65, 0x74,
+	0x50, 0x72, 0x6f, 0x70, 0x46, 0x6c, 0x61, 0x67, 0x73, 0x00, 0x96, 0x02,
+	0x00, 0x08, 0x00, 0x1c, 0x12, 0x12, 0x9d, 0x02, 0x00, 0xb7, 0x00, 0x96,
+	0x02, 0x00, 0x08, 0x01, 0x1c, 0x96, 0x02, 0x00, 0x08, 0x00, 0x8e, 0x08,
+	0x00, 0x00, 0x00, 0x00, 0x02, 0x29, 0x00, 0x0d, 0x00, 0x96, 0x09, 0x00,
+	0x04, 0x01, 0x08, 0x02, 0x07, 0x01, 0x00, 0x00, 0x00, 0x4f, 0x87, 0x01,
+	0x00, 0x00, 0x4f, 0x96, 0x04, 0x00, 0x04, 0x00, 0x08, 0x03, 0x4e, 0x87,
+	0x01, 0x00, 0x01, 0x17, 0x96, 0x04, 0x00, 0x04, 0x01, 0x08, 0x04, 0x8e,
+	0x08, 0x00, 0x00, 0x00, 0x00, 0x02, 0x29, 0x00, 0x16, 0x00, 0x96, 0x08,
+	0x00, 0x04, 0x01, 0x08, 0x02, 0x04, 0x01, 0x08, 0x02, 0x4e, 0x96, 0x05,
+	0x00, 0x07, 0x01, 0x00, 0x00, 0x00, 0x47, 0x4f, 0x4f, 0x96, 0x04, 0x00,
+	0x04, 0x01, 0x08, 0x05, 0x8e, 0x08, 0x00, 0x00, 0x00, 0x00, 0x02, 0x29,
+	0x00, 0x16, 0x00, 0x96, 0x08, 0x00, 0x04, 0x01, 0x08, 0x02, 0x04, 0x01,
+	0x08, 0x02, 0x4e, 0x96, 0x05, 0x00, 0x07, 0x01, 0x00, 0x00, 0x00, 0x0b,
+	0x4f, 0x4f, 0x96, 0x04, 0x00, 0x04, 0x01, 0x08, 0x06, 0x8e, 0x08, 0x00,
+	0x00, 0x00, 0x00, 0x02, 0x29, 0x00, 0x09, 0x00, 0x96, 0x04, 0x00, 0x04,
+	0x01, 0x08, 0x02, 0x4e, 0x3e, 0x4f, 0x96, 0x0f, 0x00, 0x07, 0x01, 0x00,
+	0x00, 0x00, 0x02, 0x04, 0x01, 0x07, 0x03, 0x00, 0x00, 0x00, 0x08, 0x07,
+	0x3d, 0x17, 0x00
+};
+
+BENCHMARK(ActionScript, replay) {
+	Common::MemoryReadStream stream(kTestClass);
+	Aurora::ActionScript::ASBuffer asBuffer(&stream);
+
+	Aurora::ActionScript::AVM avm;
+	asBuffer.run(avm);
+
+	Aurora::ActionScript::ObjectPtr obj = avm.createNewObject("Test").asObject();
+
+	while (state.keepRunning()) {
+		// Replay a few method calls every frame, like the scripts of a GFx UI would
+		for (size_t i = 0; i < kFrameCount; i++) {
+			const double value = obj->call("getI", avm).asNumber();
+
+			obj->call("inc", avm);
+			obj->call("inc", avm);
+			obj->call("dec", avm);
+
+			if (obj->call("getI", avm).asNumber() != (value + 1))
+				throw Common::Exception("ActionScript replay diverged at frame %u", (uint) i);
+		}
+	}
+
+	state.setItemsProcessed(state.getIterations() * kFrameCount * kCallsPerFrame);
+}
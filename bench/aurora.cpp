@@ -0,0 +1,902 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for the Aurora archive and data file parsers.
+ */
+
+#include <vector>
+
+#include <boost/make_shared.hpp>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/ustring.h"
+#include "src/common/scopedptr.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+#include "src/common/encoding.h"
+
+#include "src/aurora/types.h"
+#include "src/aurora/erfwriter.h"
+#include "src/aurora/erffile.h"
+#include "src/aurora/gff3writer.h"
+#include "src/aurora/gff3batchwriter.h"
+#include "src/aurora/gff3file.h"
+#include "src/aurora/gff4file.h"
+#include "src/aurora/2dafile.h"
+#include "src/aurora/gdafile.h"
+#include "src/aurora/gdaheaders.h"
+#include "src/aurora/talktable_tlk.h"
+#include "src/aurora/talktable_gff.h"
+#include "src/aurora/gff4fields.h"
+#include "src/aurora/smallfile.h"
+
+#include "bench/bench.h"
+
+static const uint32 kERFResourceCount = 4096;
+static const uint32 kERFLookupCount   = 256;
+static const uint32 kGFFStructCount   = 1024;
+static const uint32 kGFFBatchCount    = 256;
+static const uint32 kGFF4RowCount     = 20000;
+static const uint32 kGFF4StringCount  = 1000;
+static const uint32 kTwoDARowCount    = 1024;
+static const uint32 kGDARowCount      = 1024;
+static const uint32 kTLKStringCount   = 4096;
+
+/** When measuring the memory of a talk table, only read every this many strings. */
+static const uint32 kTLKSparseStride = 16;
+
+static std::vector<byte> toVector(Common::MemoryWriteStreamDynamic &stream) {
+	return std::vector<byte>(stream.getData(), stream.getData() + stream.size());
+}
+
+// --- ERF ---
+
+static Common::UString getERFResRef(uint32 i) {
+	return Common::UString::format("resource%05u", i);
+}
+
+static Aurora::FileType getERFFileType(uint32 i) {
+	static const Aurora::FileType kTypes[] = {
+		Aurora::kFileTypeUTC, Aurora::kFileTypeUTI, Aurora::kFileTypeDLG, Aurora::kFileTypeNCS
+	};
+
+	return kTypes[i % ARRAYSIZE(kTypes)];
+}
+
+static std::vector<byte> createERF() {
+	Common::MemoryWriteStreamDynamic erf(true);
+
+	Aurora::ERFWriter writer(MKTAG('E', 'R', 'F', ' '), kERFResourceCount, erf);
+
+	static const byte kResourceData[16] = { 0 };
+	for (uint32 i = 0; i < kERFResourceCount; i++) {
+		Common::MemoryReadStream data(kResourceData);
+
+		writer.add(getERFResRef(i), getERFFileType(i), data);
+	}
+
+	return toVector(erf);
+}
+
+BENCHMARK(ERF, index) {
+	const std::vector<byte> data = createERF();
+
+	while (state.keepRunning()) {
+		Aurora::ERFFile erf(new Common::MemoryReadStream(&data[0], data.size()));
+
+		Bench::doNotOptimize(erf.getResources().size());
+	}
+
+	state.setItemsProcessed(state.getIterations() * kERFResourceCount);
+}
+
+BENCHMARK(ERF, findResource) {
+	const std::vector<byte> data = createERF();
+
+	const Aurora::ERFFile erf(new Common::MemoryReadStream(&data[0], data.size()));
+
+	// Look up resources spread evenly over the whole archive
+	std::vector<uint32> indices;
+	std::vector<Common::UString> names;
+	for (uint32 i = 0; i < kERFLookupCount; i++) {
+		indices.push_back((i * kERFResourceCount) / kERFLookupCount);
+		names.push_back(getERFResRef(indices.back()));
+	}
+
+	while (state.keepRunning()) {
+		uint32 sum = 0;
+		for (uint32 i = 0; i < kERFLookupCount; i++)
+			sum += erf.findResource(names[i], getERFFileType(indices[i]));
+
+		Bench::doNotOptimize(sum);
+	}
+
+	state.setItemsProcessed(state.getIterations() * kERFLookupCount);
+}
+
+// --- GFF3 ---
+
+/** Add a list of kGFFStructCount simple structs to a GFF3. */
+static void fillGFF3(Aurora::GFF3Writer &writer) {
+	Aurora::GFF3WriterListPtr list = writer.getTopLevel()->addList("Entries");
+	for (uint32 i = 0; i < kGFFStructCount; i++) {
+		Aurora::GFF3WriterStructPtr strct = list->addStruct("", i);
+
+		strct->addUint32("ID", i);
+		strct->addFloat("Value", i * 0.5f);
+		strct->addExoString("Name", Common::UString::format("Entry number %u", i));
+		strct->addResRef("Template", Common::UString::format("tmpl%05u", i));
+	}
+}
+
+static std::vector<byte> createGFF3() {
+	Aurora::GFF3Writer writer(MKTAG('U', 'T', 'C', ' '));
+	fillGFF3(writer);
+
+	Common::MemoryWriteStreamDynamic gff3(true);
+	writer.write(gff3);
+
+	return toVector(gff3);
+}
+
+BENCHMARK(GFF3, parse) {
+	const std::vector<byte> data = createGFF3();
+
+	while (state.keepRunning()) {
+		Aurora::GFF3File gff3(new Common::MemoryReadStream(&data[0], data.size()));
+
+		const Aurora::GFF3List &list = gff3.getTopLevel().getList("Entries");
+
+		uint64 sum = 0;
+		for (Aurora::GFF3List::const_iterator s = list.begin(); s != list.end(); ++s)
+			sum += (*s)->getUint("ID") + (*s)->getString("Name").size() + (*s)->getString("Template").size();
+
+		Bench::doNotOptimize(sum);
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+	state.setItemsProcessed(state.getIterations() * kGFFStructCount);
+}
+
+BENCHMARK(GFF3, build) {
+	while (state.keepRunning()) {
+		Aurora::GFF3Writer writer(MKTAG('U', 'T', 'C', ' '));
+		fillGFF3(writer);
+	}
+
+	state.setItemsProcessed(state.getIterations() * kGFFStructCount);
+}
+
+BENCHMARK(GFF3, write) {
+	Aurora::GFF3Writer writer(MKTAG('U', 'T', 'C', ' '));
+	fillGFF3(writer);
+
+	size_t size = 0;
+	while (state.keepRunning()) {
+		Common::MemoryWriteStreamDynamic gff3(true);
+		writer.write(gff3);
+
+		size += gff3.size();
+	}
+
+	state.setBytesProcessed(size);
+	state.setItemsProcessed(state.getIterations() * kGFFStructCount);
+}
+
+static boost::shared_ptr<Aurora::GFF3Writer> createBatchGFF3(uint32 i) {
+	boost::shared_ptr<Aurora::GFF3Writer> gff = boost::make_shared<Aurora::GFF3Writer>(MKTAG('U', 'T', 'C', ' '));
+
+	gff->getTopLevel()->addUint32("Index", i);
+	gff->getTopLevel()->addExoString("Tag", Common::UString::format("creature%u", i));
+
+	Aurora::GFF3WriterListPtr list = gff->getTopLevel()->addList("Items");
+	for (uint32 j = 0; j < (i % 8); j++)
+		list->addStruct("")->addSint32("Value", (int32)(i * j));
+
+	return gff;
+}
+
+/** Write a savegame-like batch of GFF3s into a compressed V2.2 ERF. */
+BENCHMARK(GFF3, batchWriteERF) {
+	uint64 size = 0, peakSerializedSize = 0;
+
+	while (state.keepRunning()) {
+		state.pauseTiming();
+
+		Aurora::GFF3BatchWriter batch;
+		for (uint32 i = 0; i < kGFFBatchCount; i++)
+			batch.add(Common::UString::format("creature%u", i), Aurora::kFileTypeUTC, createBatchGFF3(i));
+
+		Common::MemoryWriteStreamDynamic erf(true);
+		Aurora::ERFWriter erfWriter(MKTAG('S', 'A', 'V', ' '), kGFFBatchCount, erf,
+		                            Aurora::ERFWriter::kERFVersion22, Aurora::LocString(),
+		                            Aurora::ERFWriter::kCompressionHeaderlessZlib);
+
+		state.resumeTiming();
+
+		const Aurora::GFF3BatchWriter::Statistics stats = batch.write(erfWriter);
+		if (stats.count != kGFFBatchCount)
+			throw Common::Exception("Batch wrote %u GFF3s instead of %u", (uint) stats.count, kGFFBatchCount);
+
+		size              += stats.size;
+		peakSerializedSize = MAX<uint64>(peakSerializedSize, stats.peakSerializedSize);
+	}
+
+	state.setBytesProcessed(size);
+	state.setItemsProcessed(state.getIterations() * kGFFBatchCount);
+	state.setMemoryUsed(peakSerializedSize);
+}
+
+// --- GFF4 ---
+
+/** Create a V4.0 PC GFF4 with a top-level list of simple structs.
+ *
+ *  There are two struct templates: the top-level struct holding the list,
+ *  and the list element struct, with a uint32, a float, a string and
+ *  another uint32 field.
+ */
+static std::vector<byte> createGFF4() {
+	static const uint32 kHeaderSize         = 28;
+	static const uint32 kStructTemplateSize = 16;
+	static const uint32 kFieldSize          = 12;
+
+	static const uint32 kElementSize = 16;
+
+	static const uint32 kFieldOffset0 = kHeaderSize   + 2 * kStructTemplateSize;
+	static const uint32 kFieldOffset1 = kFieldOffset0 + 1 * kFieldSize;
+	static const uint32 kDataOffset   = kFieldOffset1 + 4 * kFieldSize;
+
+	Common::MemoryWriteStreamDynamic gff4(true);
+
+	gff4.writeUint32BE(MKTAG('G', 'F', 'F', ' '));
+	gff4.writeUint32BE(MKTAG('V', '4', '.', '0'));
+	gff4.writeUint32BE(MKTAG('P', 'C', ' ', ' '));
+	gff4.writeUint32BE(MKTAG('B', 'N', 'C', 'H'));
+	gff4.writeUint32BE(MKTAG('V', '0', '.', '1'));
+	gff4.writeUint32LE(2);
+	gff4.writeUint32LE(kDataOffset);
+
+	// Struct templates
+	gff4.writeUint32BE(MKTAG('T', 'O', 'P', ' '));
+	gff4.writeUint32LE(1);
+	gff4.writeUint32LE(kFieldOffset0);
+	gff4.writeUint32LE(4);
+
+	gff4.writeUint32BE(MKTAG('E', 'N', 'T', 'R'));
+	gff4.writeUint32LE(4);
+	gff4.writeUint32LE(kFieldOffset1);
+	gff4.writeUint32LE(kElementSize);
+
+	// Fields of the top-level struct: a list of element structs
+	gff4.writeUint32LE(100);
+	gff4.writeUint32LE(0xC000U << 16 | 1);
+	gff4.writeUint32LE(0);
+
+	// Fields of the element struct
+	gff4.writeUint32LE(1);
+	gff4.writeUint32LE(Aurora::GFF4Struct::kFieldTypeUint32);
+	gff4.writeUint32LE(0);
+
+	gff4.writeUint32LE(2);
+	gff4.writeUint32LE(Aurora::GFF4Struct::kFieldTypeFloat32);
+	gff4.writeUint32LE(4);
+
+	gff4.writeUint32LE(3);
+	gff4.writeUint32LE(Aurora::GFF4Struct::kFieldTypeString);
+	gff4.writeUint32LE(8);
+
+	gff4.writeUint32LE(4);
+	gff4.writeUint32LE(Aurora::GFF4Struct::kFieldTypeUint32);
+	gff4.writeUint32LE(12);
+
+	// Data: the top-level struct, the list and then the strings
+
+	gff4.writeUint32LE(4);
+	gff4.writeUint32LE(kGFFStructCount);
+
+	std::vector<Common::UString> strings;
+	for (uint32 i = 0; i < kGFFStructCount; i++)
+		strings.push_back(Common::UString::format("Entry number %u", i));
+
+	uint32 stringOffset = 8 + kGFFStructCount * kElementSize;
+	for (uint32 i = 0; i < kGFFStructCount; i++) {
+		gff4.writeUint32LE(i);
+		gff4.writeIEEEFloatLE(i * 0.5f);
+		gff4.writeUint32LE(stringOffset);
+		gff4.writeUint32LE(i * 2);
+
+		stringOffset += 4 + strings[i].size() * 2;
+	}
+
+	for (std::vector<Common::UString>::const_iterator s = strings.begin(); s != strings.end(); ++s) {
+		gff4.writeUint32LE(s->size());
+		Common::writeString(gff4, *s, Common::kEncodingUTF16LE, false);
+	}
+
+	return toVector(gff4);
+}
+
+BENCHMARK(GFF4, parse) {
+	const std::vector<byte> data = createGFF4();
+
+	while (state.keepRunning()) {
+		Aurora::GFF4File gff4(new Common::MemoryReadStream(&data[0], data.size()));
+
+		const Aurora::GFF4List &list = gff4.getTopLevel().getList(100);
+
+		uint64 sum = 0;
+		for (Aurora::GFF4List::const_iterator s = list.begin(); s != list.end(); ++s)
+			sum += (*s)->getUint(1) + (*s)->getString(3).size() + (*s)->getUint(4);
+
+		Bench::doNotOptimize(sum);
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+	state.setItemsProcessed(state.getIterations() * kGFFStructCount);
+}
+
+/** Generate a V4.1 GFF4 with a list of rows, each with a value, a shared string
+ *  and a reference to a child struct. */
+static std::vector<byte> createGFF4Rows() {
+	static const uint32 kHeaderSize   = 36;
+	static const uint32 kTemplateSize = 16;
+	static const uint32 kFieldSize    = 12;
+
+	const uint32 fieldOffset = kHeaderSize + 3 * kTemplateSize;
+	const uint32 dataOffset  = fieldOffset + 5 * kFieldSize;
+
+	const uint32 rowsOffset     = 8;
+	const uint32 childrenOffset = rowsOffset + 4 + kGFF4RowCount * 12;
+	const uint32 stringOffset   = dataOffset + childrenOffset + kGFF4RowCount * 4;
+
+	Common::MemoryWriteStreamDynamic gff4(true);
+
+	gff4.writeUint32BE(MKTAG('G', 'F', 'F', ' '));
+	gff4.writeUint32BE(MKTAG('V', '4', '.', '1'));
+	gff4.writeUint32BE(MKTAG('P', 'C', ' ', ' '));
+	gff4.writeUint32BE(MKTAG('T', 'E', 'S', 'T'));
+	gff4.writeUint32BE(MKTAG('V', '1', '.', '0'));
+	gff4.writeUint32LE(3);
+	gff4.writeUint32LE(kGFF4StringCount);
+	gff4.writeUint32LE(stringOffset);
+	gff4.writeUint32LE(dataOffset);
+
+	// Struct templates: top-level, row, child
+	gff4.writeUint32BE(MKTAG('T', 'O', 'P', 'L'));
+	gff4.writeUint32LE(1);
+	gff4.writeUint32LE(fieldOffset);
+	gff4.writeUint32LE(4);
+
+	gff4.writeUint32BE(MKTAG('R', 'O', 'W', ' '));
+	gff4.writeUint32LE(3);
+	gff4.writeUint32LE(fieldOffset + 1 * kFieldSize);
+	gff4.writeUint32LE(12);
+
+	gff4.writeUint32BE(MKTAG('C', 'H', 'L', 'D'));
+	gff4.writeUint32LE(1);
+	gff4.writeUint32LE(fieldOffset + 4 * kFieldSize);
+	gff4.writeUint32LE(4);
+
+	// Fields: list of rows; value, string, child reference; child value
+	gff4.writeUint32LE(1);
+	gff4.writeUint32LE(0xC000U << 16 | 1);
+	gff4.writeUint32LE(0);
+
+	gff4.writeUint32LE(10);
+	gff4.writeUint32LE(Aurora::GFF4Struct::kFieldTypeUint32);
+	gff4.writeUint32LE(0);
+	gff4.writeUint32LE(11);
+	gff4.writeUint32LE(Aurora::GFF4Struct::kFieldTypeString);
+	gff4.writeUint32LE(4);
+	gff4.writeUint32LE(12);
+	gff4.writeUint32LE(0x6000U << 16 | 2);
+	gff4.writeUint32LE(8);
+
+	gff4.writeUint32LE(20);
+	gff4.writeUint32LE(Aurora::GFF4Struct::kFieldTypeUint32);
+	gff4.writeUint32LE(0);
+
+	// Data
+	gff4.writeUint32LE(rowsOffset);
+	gff4.writeUint32LE(0);
+
+	gff4.writeUint32LE(kGFF4RowCount);
+	for (size_t i = 0; i < kGFF4RowCount; i++) {
+		gff4.writeUint32LE(i);
+		gff4.writeUint32LE(i % kGFF4StringCount);
+		gff4.writeUint32LE(childrenOffset + i * 4);
+	}
+
+	for (size_t i = 0; i < kGFF4RowCount; i++)
+		gff4.writeUint32LE(i * 2);
+
+	for (size_t i = 0; i < kGFF4StringCount; i++) {
+		gff4.writeString(Common::UString::format("String%u", (uint)i));
+		gff4.writeByte(0);
+	}
+
+	return toVector(gff4);
+}
+
+/** Load the GFF4 rows and read either all rows or only the last one. */
+static void loadGFF4Rows(Bench::State &state, bool lazy, bool traverse) {
+	const std::vector<byte> data = createGFF4Rows();
+
+	uint64 memory = 0;
+	while (state.keepRunning()) {
+		const uint64 heapStart = Bench::getHeapSize();
+
+		Aurora::GFF4File gff4(new Common::MemoryReadStream(&data[0], data.size()), 0xFFFFFFFF, lazy);
+
+		const Aurora::GFF4List &rows = gff4.getTopLevel().getList(1);
+
+		uint64 sum = 0;
+		for (size_t i = traverse ? 0 : (rows.size() - 1); i < rows.size(); i++)
+			sum += rows[i]->getUint(10) + rows[i]->getString(11).size() + rows[i]->getStruct(12)->getUint(20);
+
+		Bench::doNotOptimize(sum);
+
+		memory = Bench::getHeapSize() - heapStart;
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+	state.setItemsProcessed(state.getIterations() * (traverse ? kGFF4RowCount : 1));
+	state.setMemoryUsed(memory);
+}
+
+BENCHMARK(GFF4, loadRows) {
+	loadGFF4Rows(state, false, true);
+}
+
+BENCHMARK(GFF4, loadRowsLazy) {
+	loadGFF4Rows(state, true, true);
+}
+
+BENCHMARK(GFF4, loadOneRow) {
+	loadGFF4Rows(state, false, false);
+}
+
+BENCHMARK(GFF4, loadOneRowLazy) {
+	loadGFF4Rows(state, true, false);
+}
+
+// --- 2DA ---
+
+static std::vector<byte> createTwoDAASCII() {
+	Common::UString twoda = "2DA V2.0\n\n      Label Value Cost Model\n";
+
+	for (uint32 i = 0; i < kTwoDARowCount; i++)
+		twoda += Common::UString::format("%u label_%u %u %u.%u model%04u\n", i, i, i * 3, i, i % 10, i);
+
+	return std::vector<byte>(twoda.c_str(), twoda.c_str() + twoda.size());
+}
+
+static std::vector<byte> createTwoDABinary() {
+	const std::vector<byte> ascii = createTwoDAASCII();
+
+	Common::MemoryReadStream stream(&ascii[0], ascii.size());
+	const Aurora::TwoDAFile twoda(stream);
+
+	Common::MemoryWriteStreamDynamic binary(true);
+	twoda.writeBinary(binary);
+
+	return toVector(binary);
+}
+
+static void parseTwoDA(Bench::State &state, const std::vector<byte> &data) {
+	while (state.keepRunning()) {
+		Common::MemoryReadStream stream(&data[0], data.size());
+		const Aurora::TwoDAFile twoda(stream);
+
+		int64 sum = 0;
+		for (size_t i = 0; i < twoda.getRowCount(); i++)
+			sum += twoda.getRow(i).getInt("Value");
+
+		Bench::doNotOptimize(sum);
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+	state.setItemsProcessed(state.getIterations() * kTwoDARowCount);
+}
+
+BENCHMARK(TwoDA, parseASCII) {
+	parseTwoDA(state, createTwoDAASCII());
+}
+
+BENCHMARK(TwoDA, parseBinary) {
+	parseTwoDA(state, createTwoDABinary());
+}
+
+// --- GDA ---
+
+/** Create a V0.2 GDA with an ID and a Value column, both holding ints. */
+static std::vector<byte> createGDA() {
+	static const uint32 kHeaderSize   = 28;
+	static const uint32 kTemplateSize = 16;
+	static const uint32 kFieldSize    = 12;
+
+	static const uint32 kFieldOffset = kHeaderSize  + 3 * kTemplateSize;
+	static const uint32 kDataOffset  = kFieldOffset + 5 * kFieldSize;
+
+	static const uint32 kColumnsOffset = 8;
+	static const uint32 kRowsOffset    = kColumnsOffset + 4 + 2 * 4;
+
+	Common::MemoryWriteStreamDynamic gda(true);
+
+	gda.writeUint32BE(MKTAG('G', 'F', 'F', ' '));
+	gda.writeUint32BE(MKTAG('V', '4', '.', '0'));
+	gda.writeUint32BE(MKTAG('P', 'C', ' ', ' '));
+	gda.writeUint32BE(MKTAG('G', '2', 'D', 'A'));
+	gda.writeUint32BE(MKTAG('V', '0', '.', '2'));
+	gda.writeUint32LE(3);
+	gda.writeUint32LE(kDataOffset);
+
+	// Struct templates: top-level, column, row
+	gda.writeUint32BE(MKTAG('g', 't', 'o', 'p'));
+	gda.writeUint32LE(2);
+	gda.writeUint32LE(kFieldOffset);
+	gda.writeUint32LE(8);
+
+	gda.writeUint32BE(MKTAG('c', 'o', 'l', 'm'));
+	gda.writeUint32LE(1);
+	gda.writeUint32LE(kFieldOffset + 2 * kFieldSize);
+	gda.writeUint32LE(4);
+
+	gda.writeUint32BE(MKTAG('r', 'o', 'w', 's'));
+	gda.writeUint32LE(2);
+	gda.writeUint32LE(kFieldOffset + 3 * kFieldSize);
+	gda.writeUint32LE(8);
+
+	// Fields: column list, row list; column hash; the two column values
+	gda.writeUint32LE(Aurora::kGFF4G2DAColumnList);
+	gda.writeUint32LE(0xC000U << 16 | 1);
+	gda.writeUint32LE(0);
+	gda.writeUint32LE(Aurora::kGFF4G2DARowList);
+	gda.writeUint32LE(0xC000U << 16 | 2);
+	gda.writeUint32LE(4);
+
+	gda.writeUint32LE(Aurora::kGFF4G2DAColumnHash);
+	gda.writeUint32LE(Aurora::GFF4Struct::kFieldTypeUint32);
+	gda.writeUint32LE(0);
+
+	gda.writeUint32LE(Aurora::kGFF4G2DAColumn1);
+	gda.writeUint32LE(Aurora::GFF4Struct::kFieldTypeSint32);
+	gda.writeUint32LE(0);
+	gda.writeUint32LE(Aurora::kGFF4G2DAColumn2);
+	gda.writeUint32LE(Aurora::GFF4Struct::kFieldTypeSint32);
+	gda.writeUint32LE(4);
+
+	// Data: the top-level struct, the column list and the row list
+	gda.writeUint32LE(kColumnsOffset);
+	gda.writeUint32LE(kRowsOffset);
+
+	gda.writeUint32LE(2);
+	gda.writeUint32LE(Aurora::hashGDAHeader("ID"));
+	gda.writeUint32LE(Aurora::hashGDAHeader("Value"));
+
+	gda.writeUint32LE(kGDARowCount);
+	for (uint32 i = 0; i < kGDARowCount; i++) {
+		gda.writeSint32LE(i);
+		gda.writeSint32LE(i * 3);
+	}
+
+	return toVector(gda);
+}
+
+template<typename Column>
+static void lookupGDA(Bench::State &state, const Aurora::GDAFile &gda, const Column &column) {
+	while (state.keepRunning()) {
+		int32 sum = 0;
+		for (uint32 i = 0; i < kGDARowCount; i++)
+			sum += gda.getInt(i, column);
+
+		Bench::doNotOptimize(sum);
+	}
+
+	state.setItemsProcessed(state.getIterations() * kGDARowCount);
+}
+
+BENCHMARK(GDA, lookupByName) {
+	const std::vector<byte> data = createGDA();
+	const Aurora::GDAFile gda(new Common::MemoryReadStream(&data[0], data.size()));
+
+	lookupGDA(state, gda, Common::UString("Value"));
+}
+
+BENCHMARK(GDA, lookupByHash) {
+	const std::vector<byte> data = createGDA();
+	const Aurora::GDAFile gda(new Common::MemoryReadStream(&data[0], data.size()));
+
+	lookupGDA(state, gda, Aurora::hashGDAHeader("Value"));
+}
+
+BENCHMARK(GDA, lookupByHandle) {
+	const std::vector<byte> data = createGDA();
+	const Aurora::GDAFile gda(new Common::MemoryReadStream(&data[0], data.size()));
+
+	lookupGDA(state, gda, gda.getColumn("Value"));
+}
+
+// --- TLK ---
+
+/** Create a V3.0 TLK, as used by Neverwinter Nights and the Knights of the Old Republic games. */
+static std::vector<byte> createTLK() {
+	static const uint32 kHeaderSize = 20;
+	static const uint32 kEntrySize  = 40;
+
+	std::vector<Common::UString> strings;
+	for (uint32 i = 0; i < kTLKStringCount; i++)
+		strings.push_back(Common::UString::format("This is the talk table string number %u.", i));
+
+	Common::MemoryWriteStreamDynamic tlk(true);
+
+	tlk.writeUint32BE(MKTAG('T', 'L', 'K', ' '));
+	tlk.writeUint32BE(MKTAG('V', '3', '.', '0'));
+	tlk.writeUint32LE(0);
+	tlk.writeUint32LE(kTLKStringCount);
+	tlk.writeUint32LE(kHeaderSize + kTLKStringCount * kEntrySize);
+
+	uint32 offset = 0;
+	for (uint32 i = 0; i < kTLKStringCount; i++) {
+		tlk.writeUint32LE(1); // Text present
+		tlk.writeZeros(24);   // Sound ResRef, volume variance, pitch variance
+		tlk.writeUint32LE(offset);
+		tlk.writeUint32LE(strings[i].size());
+		tlk.writeZeros(4);    // Sound length
+
+		offset += strings[i].size();
+	}
+
+	for (std::vector<Common::UString>::const_iterator s = strings.begin(); s != strings.end(); ++s)
+		tlk.writeString(*s);
+
+	return toVector(tlk);
+}
+
+BENCHMARK(TLK, lookupCold) {
+	const std::vector<byte> data = createTLK();
+
+	while (state.keepRunning()) {
+		Aurora::TalkTable_TLK tlk(new Common::MemoryReadStream(&data[0], data.size()), Common::kEncodingCP1252);
+
+		size_t sum = 0;
+		for (uint32 i = 0; i < kTLKStringCount; i++)
+			sum += tlk.getString(i).size();
+
+		Bench::doNotOptimize(sum);
+	}
+
+	state.setItemsProcessed(state.getIterations() * kTLKStringCount);
+}
+
+BENCHMARK(TLK, lookupCached) {
+	const std::vector<byte> data = createTLK();
+
+	Aurora::TalkTable_TLK tlk(new Common::MemoryReadStream(&data[0], data.size()), Common::kEncodingCP1252);
+	for (uint32 i = 0; i < kTLKStringCount; i++)
+		tlk.getString(i);
+
+	while (state.keepRunning()) {
+		size_t sum = 0;
+		for (uint32 i = 0; i < kTLKStringCount; i++)
+			sum += tlk.getString(i).size();
+
+		Bench::doNotOptimize(sum);
+	}
+
+	state.setItemsProcessed(state.getIterations() * kTLKStringCount);
+}
+
+/** Load a talk table and read every stride-th string, measuring the memory it holds onto. */
+template<class TalkTableType>
+static void measureTalkTableMemory(Bench::State &state, const std::vector<byte> &data, uint32 stride) {
+	uint64 memory = 0;
+	while (state.keepRunning()) {
+		const uint64 heapStart = Bench::getHeapSize();
+
+		TalkTableType talkTable(new Common::MemoryReadStream(&data[0], data.size()), Common::kEncodingCP1252);
+
+		size_t sum = 0;
+		for (uint32 i = 0; i < kTLKStringCount; i += stride)
+			sum += talkTable.getString(i).size();
+
+		Bench::doNotOptimize(sum);
+
+		memory = Bench::getHeapSize() - heapStart;
+	}
+
+	state.setItemsProcessed(state.getIterations() * (kTLKStringCount / stride));
+	state.setMemoryUsed(memory);
+}
+
+BENCHMARK(TLK, memoryLoad) {
+	measureTalkTableMemory<Aurora::TalkTable_TLK>(state, createTLK(), kTLKStringCount);
+}
+
+BENCHMARK(TLK, memorySparse) {
+	measureTalkTableMemory<Aurora::TalkTable_TLK>(state, createTLK(), kTLKSparseStride);
+}
+
+BENCHMARK(TLK, memoryAll) {
+	measureTalkTableMemory<Aurora::TalkTable_TLK>(state, createTLK(), 1);
+}
+
+/** Create a V0.2 GFF4 talk table, as used by Dragon Age: Origins.
+ *
+ *  The top-level struct holds a list of structs with a StrRef and a string each.
+ */
+static std::vector<byte> createTalkTableGFF() {
+	static const uint32 kHeaderSize         = 28;
+	static const uint32 kStructTemplateSize = 16;
+	static const uint32 kFieldSize          = 12;
+
+	static const uint32 kElementSize = 8;
+
+	static const uint32 kFieldOffset0 = kHeaderSize   + 2 * kStructTemplateSize;
+	static const uint32 kFieldOffset1 = kFieldOffset0 + 1 * kFieldSize;
+	static const uint32 kDataOffset   = kFieldOffset1 + 2 * kFieldSize;
+
+	Common::MemoryWriteStreamDynamic gff4(true);
+
+	gff4.writeUint32BE(MKTAG('G', 'F', 'F', ' '));
+	gff4.writeUint32BE(MKTAG('V', '4', '.', '0'));
+	gff4.writeUint32BE(MKTAG('P', 'C', ' ', ' '));
+	gff4.writeUint32BE(MKTAG('T', 'L', 'K', ' '));
+	gff4.writeUint32BE(MKTAG('V', '0', '.', '2'));
+	gff4.writeUint32LE(2);
+	gff4.writeUint32LE(kDataOffset);
+
+	// Struct templates
+	gff4.writeUint32BE(MKTAG('T', 'L', 'K', ' '));
+	gff4.writeUint32LE(1);
+	gff4.writeUint32LE(kFieldOffset0);
+	gff4.writeUint32LE(4);
+
+	gff4.writeUint32BE(MKTAG('S', 'T', 'R', 'N'));
+	gff4.writeUint32LE(2);
+	gff4.writeUint32LE(kFieldOffset1);
+	gff4.writeUint32LE(kElementSize);
+
+	// Fields of the top-level struct: a list of string structs
+	gff4.writeUint32LE(Aurora::kGFF4TalkStringList);
+	gff4.writeUint32LE(0xC000U << 16 | 1);
+	gff4.writeUint32LE(0);
+
+	// Fields of the string struct
+	gff4.writeUint32LE(Aurora::kGFF4TalkStringID);
+	gff4.writeUint32LE(Aurora::GFF4Struct::kFieldTypeUint32);
+	gff4.writeUint32LE(0);
+
+	gff4.writeUint32LE(Aurora::kGFF4TalkString);
+	gff4.writeUint32LE(Aurora::GFF4Struct::kFieldTypeString);
+	gff4.writeUint32LE(4);
+
+	// Data: the top-level struct, the list and then the strings
+
+	gff4.writeUint32LE(4);
+	gff4.writeUint32LE(kTLKStringCount);
+
+	std::vector<Common::UString> strings;
+	for (uint32 i = 0; i < kTLKStringCount; i++)
+		strings.push_back(Common::UString::format("This is the talk table string number %u.", i));
+
+	uint32 stringOffset = 8 + kTLKStringCount * kElementSize;
+	for (uint32 i = 0; i < kTLKStringCount; i++) {
+		gff4.writeUint32LE(i);
+		gff4.writeUint32LE(stringOffset);
+
+		stringOffset += 4 + strings[i].size() * 2;
+	}
+
+	for (std::vector<Common::UString>::const_iterator s = strings.begin(); s != strings.end(); ++s) {
+		gff4.writeUint32LE(s->size());
+		Common::writeString(gff4, *s, Common::kEncodingUTF16LE, false);
+	}
+
+	return toVector(gff4);
+}
+
+BENCHMARK(TalkTableGFF, memoryLoad) {
+	measureTalkTableMemory<Aurora::TalkTable_GFF>(state, createTalkTableGFF(), kTLKStringCount);
+}
+
+BENCHMARK(TalkTableGFF, memorySparse) {
+	measureTalkTableMemory<Aurora::TalkTable_GFF>(state, createTalkTableGFF(), kTLKSparseStride);
+}
+
+BENCHMARK(TalkTableGFF, memoryAll) {
+	measureTalkTableMemory<Aurora::TalkTable_GFF>(state, createTalkTableGFF(), 1);
+}
+
+/** Size of the data to compress with the Nintendo DS LZSS compression. */
+static const size_t kSmallDataSize = 1000000;
+
+/** Create text-like data with runs of bytes and patterns, for the LZSS compression. */
+static std::vector<byte> createSmallData() {
+	static const char * const kWords[] = {
+		"ozymandias ", "king ", "of ", "kings ", "look ", "on ", "my ", "works ", "ye ", "mighty ", "and ", "despair "
+	};
+
+	Bench::FixtureRandom random;
+
+	std::vector<byte> data;
+	data.reserve(kSmallDataSize);
+
+	while (data.size() < kSmallDataSize) {
+		const uint32 choice = random.next(0, 15);
+		if (choice < ARRAYSIZE(kWords)) {
+			for (const char *w = kWords[choice]; *w && (data.size() < kSmallDataSize); w++)
+				data.push_back(*w);
+
+		} else if (choice == 12) {
+			// Run of a single byte
+			const byte value = random.next(0, 255);
+			for (uint32 n = random.next(0, 63); (n > 0) && (data.size() < kSmallDataSize); n--)
+				data.push_back(value);
+
+		} else if (choice == 13) {
+			// Run of a short pattern
+			for (uint32 i = 0, n = random.next(0, 63); (i < n) && (data.size() < kSmallDataSize); i++)
+				data.push_back("abc"[i % 3]);
+
+		} else
+			data.push_back(random.next(0, 255));
+	}
+
+	return data;
+}
+
+BENCHMARK(Small, compress10) {
+	const std::vector<byte> data = createSmallData();
+
+	while (state.keepRunning()) {
+		Common::MemoryReadStream uncompressed(&data[0], data.size());
+		Common::MemoryWriteStreamDynamic compressed(true);
+
+		Aurora::Small::compress10(uncompressed, compressed);
+
+		Bench::doNotOptimize(compressed.size());
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+}
+
+BENCHMARK(Small, decompress10) {
+	const std::vector<byte> data = createSmallData();
+
+	Common::MemoryReadStream uncompressed(&data[0], data.size());
+	Common::MemoryWriteStreamDynamic compressed(true);
+
+	Aurora::Small::compress10(uncompressed, compressed);
+
+	while (state.keepRunning()) {
+		Common::MemoryReadStream small(compressed.getData(), compressed.size());
+		Common::ScopedPtr<Common::SeekableReadStream> decompressed(Aurora::Small::decompress(small));
+
+		if (decompressed->size() != data.size())
+			throw Common::Exception("Decompressed %u bytes instead of %u",
+			                        (uint) decompressed->size(), (uint) data.size());
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+}
@@ -0,0 +1,537 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A small framework for benchmarking the engine subsystems, and the
+ *  benchmark runner's entry point.
+ *
+ *  Every benchmark works on synthetic fixtures it creates itself, so
+ *  neither game data nor a GPU is needed to run them.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <atomic>
+#include <new>
+
+#include "src/version/version.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/platform.h"
+#include "src/common/strutil.h"
+#include "src/common/datetime.h"
+#include "src/common/writefile.h"
+#include "src/common/threads.h"
+
+#include "bench/bench.h"
+
+namespace Bench {
+
+/** Number of bytes currently allocated through operator new. */
+static std::atomic<uint64> heapSize(0);
+
+/** Size of the header in front of each allocation, keeping the alignment malloc() gives us. */
+static const size_t kHeapHeaderSize = 16;
+
+static void *allocateHeap(size_t size) {
+	byte *ptr = static_cast<byte *>(std::malloc(size + kHeapHeaderSize));
+	if (!ptr)
+		return 0;
+
+	*reinterpret_cast<size_t *>(ptr) = size;
+	heapSize += size;
+
+	return ptr + kHeapHeaderSize;
+}
+
+static void freeHeap(void *ptr) {
+	if (!ptr)
+		return;
+
+	byte *header = static_cast<byte *>(ptr) - kHeapHeaderSize;
+
+	heapSize -= *reinterpret_cast<size_t *>(header);
+	std::free(header);
+}
+
+uint64 getHeapSize() {
+	return heapSize;
+}
+
+static uint64 getNanoseconds() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+State::State(uint64 minTime) : _minTime(minTime), _started(false), _running(false),
+	_startTime(0), _time(0), _iterations(0), _bytes(0), _items(0), _memory(0) {
+
+}
+
+bool State::keepRunning() {
+	if (!_started) {
+		_started = true;
+
+		resumeTiming();
+		return true;
+	}
+
+	_iterations++;
+
+	const uint64 elapsed = _running ? (_time + getNanoseconds() - _startTime) : _time;
+	if (elapsed < _minTime)
+		return true;
+
+	pauseTiming();
+	return false;
+}
+
+void State::pauseTiming() {
+	if (!_running)
+		return;
+
+	_time   += getNanoseconds() - _startTime;
+	_running = false;
+}
+
+void State::resumeTiming() {
+	if (_running)
+		return;
+
+	_startTime = getNanoseconds();
+	_running   = true;
+}
+
+uint64 State::getIterations() const {
+	return _iterations;
+}
+
+uint64 State::getTime() const {
+	return _time;
+}
+
+void State::setBytesProcessed(uint64 bytes) {
+	_bytes = bytes;
+}
+
+void State::setItemsProcessed(uint64 items) {
+	_items = items;
+}
+
+void State::setMemoryUsed(uint64 bytes) {
+	_memory = bytes;
+}
+
+uint64 State::getBytesProcessed() const {
+	return _bytes;
+}
+
+uint64 State::getItemsProcessed() const {
+	return _items;
+}
+
+uint64 State::getMemoryUsed() const {
+	return _memory;
+}
+
+
+struct Benchmark {
+	Common::UString name;
+	BenchmarkFunc func;
+
+	Benchmark(const Common::UString &n, BenchmarkFunc f) : name(n), func(f) {
+	}
+};
+
+/** All registered benchmarks.
+ *
+ *  A function-local static, so that it's constructed before the
+ *  registrars in the other translation units use it.
+ */
+static std::vector<Benchmark> &getBenchmarks() {
+	static std::vector<Benchmark> benchmarks;
+
+	return benchmarks;
+}
+
+Registrar::Registrar(const char *group, const char *name, BenchmarkFunc func) {
+	getBenchmarks().push_back(Benchmark(Common::UString::format("%s/%s", group, name), func));
+}
+
+
+FixtureRandom::FixtureRandom(uint32 seed) : _state(seed ? seed : 1) {
+}
+
+uint32 FixtureRandom::next() {
+	// xorshift32
+	_state ^= _state << 13;
+	_state ^= _state >> 17;
+	_state ^= _state <<  5;
+
+	return _state;
+}
+
+uint32 FixtureRandom::next(uint32 min, uint32 max) {
+	return min + (next() % (max - min + 1));
+}
+
+void FixtureRandom::fill(byte *data, size_t size) {
+	for (size_t i = 0; i < size; i++)
+		data[i] = next() >> 24;
+}
+
+
+/** The results of all repetitions of one benchmark. */
+struct Result {
+	Common::UString name;
+
+	bool failed;
+
+	uint64 iterations; ///< Iterations over all repetitions.
+
+	double minTime;    ///< Fastest time per iteration, in ns.
+	double medianTime; ///< Median time per iteration, in ns.
+	double meanTime;   ///< Mean time per iteration, in ns.
+	double stdDev;     ///< Standard deviation of the time per iteration, in ns.
+
+	double bytesPerSecond;
+	double itemsPerSecond;
+
+	uint64 memory; ///< Memory the workload keeps allocated, in bytes.
+
+	Result() : failed(false), iterations(0), minTime(0.0), medianTime(0.0), meanTime(0.0), stdDev(0.0),
+		bytesPerSecond(0.0), itemsPerSecond(0.0), memory(0) {
+	}
+};
+
+struct Options {
+	Common::UString filter;
+	Common::UString json;
+
+	uint32 repetitions;
+	uint32 minTime; ///< Minimum measuring time per repetition, in ms.
+
+	bool list;
+
+	Options() : repetitions(5), minTime(100), list(false) {
+	}
+};
+
+static Result runBenchmark(const Benchmark &benchmark, const Options &options) {
+	Result result;
+	result.name = benchmark.name;
+
+	std::vector<double> times;
+
+	double bytesPerIteration = 0.0, itemsPerIteration = 0.0;
+
+	// One untimed warm-up run, then the measured repetitions
+	for (uint32 i = 0; i <= options.repetitions; i++) {
+		State state(i == 0 ? 0 : (options.minTime * UINT64_C(1000000)));
+
+		benchmark.func(state);
+
+		if ((i == 0) || (state.getIterations() == 0))
+			continue;
+
+		result.iterations += state.getIterations();
+
+		times.push_back(((double) state.getTime()) / state.getIterations());
+
+		bytesPerIteration = ((double) state.getBytesProcessed()) / state.getIterations();
+		itemsPerIteration = ((double) state.getItemsProcessed()) / state.getIterations();
+
+		result.memory = MAX(result.memory, state.getMemoryUsed());
+	}
+
+	if (times.empty())
+		throw Common::Exception("Benchmark didn't run any iterations");
+
+	std::sort(times.begin(), times.end());
+
+	result.minTime = times.front();
+
+	const size_t middle = times.size() / 2;
+	result.medianTime = (times.size() % 2) ? times[middle] : ((times[middle - 1] + times[middle]) / 2.0);
+
+	double sum = 0.0;
+	for (std::vector<double>::const_iterator t = times.begin(); t != times.end(); ++t)
+		sum += *t;
+
+	result.meanTime = sum / times.size();
+
+	double variance = 0.0;
+	for (std::vector<double>::const_iterator t = times.begin(); t != times.end(); ++t)
+		variance += (*t - result.meanTime) * (*t - result.meanTime);
+
+	result.stdDev = (times.size() > 1) ? std::sqrt(variance / (times.size() - 1)) : 0.0;
+
+	if (result.medianTime > 0.0) {
+		result.bytesPerSecond = bytesPerIteration * 1000000000.0 / result.medianTime;
+		result.itemsPerSecond = itemsPerIteration * 1000000000.0 / result.medianTime;
+	}
+
+	return result;
+}
+
+static Common::UString formatTime(double ns) {
+	if (ns < 1000.0)
+		return Common::UString::format("%.1f ns", ns);
+	if (ns < 1000000.0)
+		return Common::UString::format("%.2f us", ns / 1000.0);
+	if (ns < 1000000000.0)
+		return Common::UString::format("%.2f ms", ns / 1000000.0);
+
+	return Common::UString::format("%.2f s", ns / 1000000000.0);
+}
+
+static Common::UString formatThroughput(const Result &result) {
+	if (result.bytesPerSecond > 0.0)
+		return Common::UString::format("%.2f MiB/s", result.bytesPerSecond / (1024.0 * 1024.0));
+	if (result.itemsPerSecond > 0.0)
+		return Common::UString::format("%.2f M/s", result.itemsPerSecond / 1000000.0);
+
+	return "";
+}
+
+static Common::UString formatMemory(uint64 bytes) {
+	if (bytes == 0)
+		return "";
+	if (bytes < 1024)
+		return Common::UString::format("%u B", (uint) bytes);
+	if (bytes < (1024 * 1024))
+		return Common::UString::format("%.2f KiB", bytes / 1024.0);
+
+	return Common::UString::format("%.2f MiB", bytes / (1024.0 * 1024.0));
+}
+
+static void printResult(const Result &result) {
+	if (result.failed) {
+		std::printf("%-40s %12s\n", result.name.c_str(), "FAILED");
+		return;
+	}
+
+	const double relStdDev = (result.meanTime > 0.0) ? (result.stdDev * 100.0 / result.meanTime) : 0.0;
+
+	std::printf("%-40s %12s %12s %7.1f%% %16s %12s\n", result.name.c_str(),
+	            formatTime(result.medianTime).c_str(), formatTime(result.minTime).c_str(),
+	            relStdDev, formatThroughput(result).c_str(), formatMemory(result.memory).c_str());
+	std::fflush(stdout);
+}
+
+static Common::UString formatDouble(double value) {
+	if (!std::isfinite(value))
+		return "0";
+
+	return Common::UString::format("%.3f", value);
+}
+
+static void writeJSON(Common::WriteStream &stream, const std::vector<Result> &results, const Options &options) {
+	const Common::DateTime now(Common::DateTime::kUTC);
+
+	stream.writeString("{\n  \"context\": {\n");
+	stream.writeString(Common::UString::format("    \"version\": \"%s\",\n", Version::getProjectNameVersionFull()));
+	stream.writeString(Common::UString::format("    \"date\": \"%sZ\",\n", now.formatDateTimeISO('T', '-', ':').c_str()));
+	stream.writeString(Common::UString::format("    \"repetitions\": %u,\n", options.repetitions));
+	stream.writeString(Common::UString::format("    \"min_time_ms\": %u\n", options.minTime));
+	stream.writeString("  },\n  \"benchmarks\": [");
+
+	for (std::vector<Result>::const_iterator r = results.begin(); r != results.end(); ++r) {
+		stream.writeString((r == results.begin()) ? "\n" : ",\n");
+
+		stream.writeString(Common::UString::format("    {\"name\": \"%s\", ", r->name.c_str()));
+
+		if (r->failed) {
+			stream.writeString("\"failed\": true}");
+			continue;
+		}
+
+		stream.writeString(Common::UString::format("\"iterations\": %s, ", Common::composeString(r->iterations).c_str()));
+		stream.writeString(Common::UString::format("\"median_ns\": %s, ", formatDouble(r->medianTime).c_str()));
+		stream.writeString(Common::UString::format("\"min_ns\": %s, ", formatDouble(r->minTime).c_str()));
+		stream.writeString(Common::UString::format("\"mean_ns\": %s, ", formatDouble(r->meanTime).c_str()));
+		stream.writeString(Common::UString::format("\"stddev_ns\": %s, ", formatDouble(r->stdDev).c_str()));
+		stream.writeString(Common::UString::format("\"bytes_per_second\": %s, ", formatDouble(r->bytesPerSecond).c_str()));
+		stream.writeString(Common::UString::format("\"items_per_second\": %s, ", formatDouble(r->itemsPerSecond).c_str()));
+		stream.writeString(Common::UString::format("\"memory_bytes\": %s}", Common::composeString(r->memory).c_str()));
+	}
+
+	stream.writeString("\n  ]\n}\n");
+}
+
+static void writeJSON(const Common::UString &file, const std::vector<Result> &results, const Options &options) {
+	Common::WriteFile json;
+	if (!json.open(file))
+		throw Common::Exception("Can't open \"%s\" for writing", file.c_str());
+
+	writeJSON(json, results, options);
+
+	json.flush();
+}
+
+static void displayUsage(const Common::UString &name) {
+	std::printf("Benchmarks for the xoreos engine subsystems\n\n");
+	std::printf("Usage: %s [options]\n\n", name.c_str());
+	std::printf("  -h      --help              Display this text and exit.\n");
+	std::printf("          --list              List all benchmarks and exit.\n");
+	std::printf("          --filter=STR        Only run benchmarks whose name contains STR.\n");
+	std::printf("          --repetitions=NUM   Measure each benchmark NUM times (default: 5).\n");
+	std::printf("          --mintime=MS        Measure each repetition for at least MS\n");
+	std::printf("                              milliseconds (default: 100).\n");
+	std::printf("          --json=FILE         Write the results as JSON into FILE.\n");
+}
+
+static bool parseOption(const Common::UString &arg, const char *name, Common::UString &value) {
+	const Common::UString prefix = Common::UString::format("--%s=", name);
+	if (!arg.beginsWith(prefix))
+		return false;
+
+	value = arg.substr(arg.getPosition(prefix.size()), arg.end());
+	return true;
+}
+
+static bool parseCommandLine(const std::vector<Common::UString> &args, Options &options, int &code) {
+	code = 0;
+
+	for (size_t i = 1; i < args.size(); i++) {
+		Common::UString value;
+
+		if ((args[i] == "-h") || (args[i] == "--help")) {
+			displayUsage(args[0]);
+			return false;
+		}
+
+		if (args[i] == "--list") {
+			options.list = true;
+		} else if (parseOption(args[i], "filter", value)) {
+			options.filter = value;
+		} else if (parseOption(args[i], "json", value)) {
+			options.json = value;
+		} else if (parseOption(args[i], "repetitions", value)) {
+			Common::parseString(value, options.repetitions);
+		} else if (parseOption(args[i], "mintime", value)) {
+			Common::parseString(value, options.minTime);
+		} else {
+			displayUsage(args[0]);
+
+			code = 1;
+			return false;
+		}
+	}
+
+	if (options.repetitions == 0)
+		options.repetitions = 1;
+
+	return true;
+}
+
+} // End of namespace Bench
+
+void *operator new(std::size_t size) {
+	void *ptr = Bench::allocateHeap(size);
+	if (!ptr)
+		throw std::bad_alloc();
+
+	return ptr;
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) throw() {
+	return Bench::allocateHeap(size);
+}
+
+void operator delete(void *ptr) throw() {
+	Bench::freeHeap(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) throw() {
+	Bench::freeHeap(ptr);
+}
+
+int main(int argc, char **argv) {
+	std::vector<Common::UString> args;
+	Common::Platform::getParameters(argc, argv, args);
+
+	int returnValue = 1;
+	try {
+		Bench::Options options;
+		if (!Bench::parseCommandLine(args, options, returnValue))
+			return returnValue;
+
+		Common::initThreads();
+
+		std::vector<Bench::Benchmark> benchmarks = Bench::getBenchmarks();
+		std::sort(benchmarks.begin(), benchmarks.end(), [](const Bench::Benchmark &a, const Bench::Benchmark &b) {
+			return a.name.less(b.name);
+		});
+
+		if (options.list) {
+			for (std::vector<Bench::Benchmark>::const_iterator b = benchmarks.begin(); b != benchmarks.end(); ++b)
+				std::printf("%s\n", b->name.c_str());
+
+			return 0;
+		}
+
+		std::printf("%-40s %12s %12s %8s %16s %12s\n", "Benchmark", "Median", "Min", "StdDev", "Throughput", "Memory");
+
+		returnValue = 0;
+
+		std::vector<Bench::Result> results;
+		for (std::vector<Bench::Benchmark>::const_iterator b = benchmarks.begin(); b != benchmarks.end(); ++b) {
+			if (!options.filter.empty() && !b->name.contains(options.filter))
+				continue;
+
+			Bench::Result result;
+
+			try {
+				result = Bench::runBenchmark(*b, options);
+			} catch (Common::Exception &e) {
+				Common::printException(e, Common::UString::format("ERROR: %s: ", b->name.c_str()));
+
+				result.name   = b->name;
+				result.failed = true;
+
+				returnValue = 1;
+			}
+
+			Bench::printResult(result);
+			results.push_back(result);
+		}
+
+		if (!options.json.empty()) {
+			Bench::writeJSON(options.json, results, options);
+
+			std::printf("\nWrote results to \"%s\"\n", options.json.c_str());
+		}
+
+	} catch (...) {
+		Common::exceptionDispatcherError();
+
+		return 1;
+	}
+
+	return returnValue;
+}
@@ -0,0 +1,151 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A small framework for benchmarking the engine subsystems.
+ */
+
+#ifndef BENCH_BENCH_H
+#define BENCH_BENCH_H
+
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+
+namespace Bench {
+
+/** The state of a running benchmark.
+ *
+ *  A benchmark function first creates its fixtures and then measures
+ *  its workload in a loop, like this:
+ *
+ *  @code
+ *  BENCHMARK(Group, name) {
+ *  	const std::vector<byte> data = createFixture();
+ *
+ *  	while (state.keepRunning())
+ *  		doWork(data);
+ *
+ *  	state.setBytesProcessed(state.getIterations() * data.size());
+ *  }
+ *  @endcode
+ *
+ *  Only the time spent inside the loop is measured. The loop runs until
+ *  the minimum measuring time has passed.
+ */
+class State : boost::noncopyable {
+public:
+	State(uint64 minTime);
+
+	/** Run another iteration of the workload? */
+	bool keepRunning();
+
+	/** Stop measuring time, for example to reset fixtures inside the loop. */
+	void pauseTiming();
+	/** Continue measuring time. */
+	void resumeTiming();
+
+	/** Return the number of finished iterations. */
+	uint64 getIterations() const;
+	/** Return the measured time, in nanoseconds. */
+	uint64 getTime() const;
+
+	/** Set the number of bytes the whole run processed. */
+	void setBytesProcessed(uint64 bytes);
+	/** Set the number of items the whole run processed. */
+	void setItemsProcessed(uint64 items);
+
+	/** Set the number of bytes of memory the workload keeps allocated. */
+	void setMemoryUsed(uint64 bytes);
+
+	uint64 getBytesProcessed() const;
+	uint64 getItemsProcessed() const;
+	uint64 getMemoryUsed() const;
+
+private:
+	uint64 _minTime;
+
+	bool   _started;
+	bool   _running;
+	uint64 _startTime;
+	uint64 _time;
+
+	uint64 _iterations;
+
+	uint64 _bytes;
+	uint64 _items;
+	uint64 _memory;
+};
+
+typedef void (*BenchmarkFunc)(State &state);
+
+/** Register a benchmark. Use the BENCHMARK() macro instead of calling this directly. */
+class Registrar {
+public:
+	Registrar(const char *group, const char *name, BenchmarkFunc func);
+};
+
+/** Make sure the compiler doesn't optimize away a result. */
+template<typename T> inline void doNotOptimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+	asm volatile("" : : "g"(&value) : "memory");
+#else
+	static volatile const void *sink;
+
+	sink = &value;
+#endif
+}
+
+/** Return the number of bytes currently allocated through operator new.
+ *
+ *  The benchmark runner replaces the global allocation functions to keep
+ *  track of this. Memory allocated with malloc() directly, for example by
+ *  zlib, is not included.
+ */
+uint64 getHeapSize();
+
+/** Return a reproducible pseudo-random number sequence for fixtures. */
+class FixtureRandom {
+public:
+	FixtureRandom(uint32 seed = 0x1D1DA1AE);
+
+	uint32 next();
+	/** Return a number in the range [min, max]. */
+	uint32 next(uint32 min, uint32 max);
+
+	/** Fill a buffer with random bytes. */
+	void fill(byte *data, size_t size);
+
+private:
+	uint32 _state;
+};
+
+} // End of namespace Bench
+
+/** Define and register a benchmark. */
+#define BENCHMARK(group, name) \
+	static void bench_##group##_##name(Bench::State &state); \
+	static Bench::Registrar benchRegistrar_##group##_##name(#group, #name, &bench_##group##_##name); \
+	static void bench_##group##_##name(Bench::State &state)
+
+#endif // BENCH_BENCH_H
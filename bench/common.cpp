@@ -0,0 +1,516 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for the common bit stream and Huffman decoding utilities.
+ */
+
+#include <vector>
+#include <thread>
+
+#include "src/common/types.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+#include "src/common/strutil.h"
+#include "src/common/encoding.h"
+#include "src/common/hash.h"
+#include "src/common/md5.h"
+#include "src/common/blowfish.h"
+#include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+#include "src/common/bitstream.h"
+#include "src/common/bitstreamwriter.h"
+#include "src/common/huffman.h"
+#include "src/common/streamtokenizer.h"
+#include "src/common/memorytokenizer.h"
+
+#include "bench/bench.h"
+
+static const size_t kBitStreamSize = 256 * 1024;
+
+static const size_t kHuffmanCodeCount = 9;
+static const size_t kHuffmanSymbols   = 64 * 1024;
+
+static const size_t kEncodingStringCount = 20000;
+static const size_t kEncodingThreadCount = 4;
+
+static const size_t kHashNameCount = 100000;
+
+/** Code lengths of a complete prefix code, i.e. the Kraft sum is exactly 1. */
+static const uint8 kHuffmanLengths[kHuffmanCodeCount] = { 2, 2, 3, 3, 4, 4, 4, 5, 5 };
+
+/** Create the canonical codes for kHuffmanLengths. */
+static std::vector<uint32> createHuffmanCodes() {
+	std::vector<uint32> codes(kHuffmanCodeCount);
+
+	uint32 code = 0;
+	for (size_t i = 0; i < kHuffmanCodeCount; i++) {
+		if (i > 0)
+			code = (code + 1) << (kHuffmanLengths[i] - kHuffmanLengths[i - 1]);
+
+		codes[i] = code;
+	}
+
+	return codes;
+}
+
+static std::vector<byte> createRandomData(size_t size) {
+	std::vector<byte> data(size);
+
+	Bench::FixtureRandom random;
+	random.fill(&data[0], data.size());
+
+	return data;
+}
+
+template<class BitStreamType>
+static void readBits(Bench::State &state, size_t bitsPerRead) {
+	const std::vector<byte> data = createRandomData(kBitStreamSize);
+
+	const size_t readCount = (data.size() * 8) / bitsPerRead;
+
+	while (state.keepRunning()) {
+		Common::MemoryReadStream stream(&data[0], data.size());
+		BitStreamType bits(stream);
+
+		uint32 sum = 0;
+		for (size_t i = 0; i < readCount; i++)
+			sum += bits.getBits(bitsPerRead);
+
+		Bench::doNotOptimize(sum);
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+}
+
+BENCHMARK(BitStream, read8MSB_1) {
+	readBits<Common::BitStream8MSB>(state, 1);
+}
+
+BENCHMARK(BitStream, read8MSB_7) {
+	readBits<Common::BitStream8MSB>(state, 7);
+}
+
+BENCHMARK(BitStream, read32LELSB_7) {
+	readBits<Common::BitStream32LELSB>(state, 7);
+}
+
+BENCHMARK(BitStream, read32LELSB_16) {
+	readBits<Common::BitStream32LELSB>(state, 16);
+}
+
+BENCHMARK(Huffman, decode) {
+	const std::vector<uint32> codes = createHuffmanCodes();
+
+	// Encode a random sequence of symbols
+	Common::MemoryWriteStreamDynamic encoded(true);
+	{
+		Common::BitStreamWriter8MSB writer(encoded);
+
+		Bench::FixtureRandom random;
+		for (size_t i = 0; i < kHuffmanSymbols; i++) {
+			const size_t symbol = random.next(0, kHuffmanCodeCount - 1);
+
+			writer.putBits(codes[symbol], kHuffmanLengths[symbol]);
+		}
+
+		writer.flush();
+	}
+
+	const Common::Huffman huffman(0, kHuffmanCodeCount, &codes[0], kHuffmanLengths);
+
+	while (state.keepRunning()) {
+		Common::MemoryReadStream stream(encoded.getData(), encoded.size());
+		Common::BitStream8MSB bits(stream);
+
+		uint32 sum = 0;
+		for (size_t i = 0; i < kHuffmanSymbols; i++)
+			sum += huffman.getSymbol(bits);
+
+		Bench::doNotOptimize(sum);
+	}
+
+	state.setItemsProcessed(state.getIterations() * kHuffmanSymbols);
+}
+
+// A long, mostly ASCII string, with a few extended characters sprinkled in
+static const byte kCP1252Data[] = {
+	'T', 'h', 'e', ' ', 'q', 'u', 'i', 'c', 'k', ' ', 'b', 'r', 'o', 'w', 'n', ' ',
+	'f', 'o', 'x', ' ', 'j', 'u', 'm', 'p', 's', ' ', 'o', 'v', 'e', 'r', ' ', 't',
+	'h', 'e', ' ', 'l', 'a', 'z', 'y', ' ', 'd', 'o', 'g', ' ', 0x80, ' ', 'F', 0xF6,
+	0xF6, 'b', 0xE4, 'r', ' ', 0x85, ' ', 'T', 'h', 'e', ' ', 'e', 'n', 'd', '.', ' ',
+	'A', 'n', 'd', ' ', 'a', ' ', 'f', 'e', 'w', ' ', 'm', 'o', 'r', 'e', ' ', 'w',
+	'o', 'r', 'd', 's', ' ', 't', 'o', ' ', 'p', 'a', 'd', ' ', 'i', 't', ' ', 'o',
+	'u', 't', ' ', 'a', ' ', 'b', 'i', 't', '.'
+};
+
+static const byte kASCIIData[] = "The quick brown fox jumps over the lazy dog, again and again and again.";
+
+/** Create kEncodingStringCount terminated copies of a string, one after the other. */
+static std::vector<byte> createStringData(const byte *data, size_t size, size_t termSize) {
+	std::vector<byte> buffer;
+	buffer.reserve((size + termSize) * kEncodingStringCount);
+
+	for (size_t i = 0; i < kEncodingStringCount; i++) {
+		buffer.insert(buffer.end(), data, data + size);
+		buffer.insert(buffer.end(), termSize, 0x00);
+	}
+
+	return buffer;
+}
+
+/** Convert the CP1252 string into a different encoding. */
+static std::vector<byte> convertCP1252Data(Common::Encoding encoding) {
+	const Common::UString string = Common::readString(kCP1252Data, sizeof(kCP1252Data), Common::kEncodingCP1252);
+
+	Common::ScopedPtr<Common::MemoryReadStream> converted(Common::convertString(string, encoding, false));
+	if (!converted)
+		throw Common::Exception("Failed to convert the benchmark string");
+
+	return std::vector<byte>(converted->getData(), converted->getData() + converted->size());
+}
+
+/** Read all strings out of the data, returning their number. */
+static size_t readStrings(const std::vector<byte> &data, Common::Encoding encoding) {
+	Common::MemoryReadStream stream(&data[0], data.size());
+
+	size_t count = 0;
+	while (stream.pos() < stream.size()) {
+		Bench::doNotOptimize(Common::readString(stream, encoding).size());
+
+		count++;
+	}
+
+	return count;
+}
+
+static void readStrings(Bench::State &state, const std::vector<byte> &data, Common::Encoding encoding) {
+	size_t count = 0;
+	while (state.keepRunning())
+		count += readStrings(data, encoding);
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+	state.setItemsProcessed(count);
+}
+
+BENCHMARK(Encoding, readStringASCII) {
+	readStrings(state, createStringData(kASCIIData, sizeof(kASCIIData) - 1, 1), Common::kEncodingASCII);
+}
+
+BENCHMARK(Encoding, readStringCP1252) {
+	readStrings(state, createStringData(kCP1252Data, sizeof(kCP1252Data), 1), Common::kEncodingCP1252);
+}
+
+BENCHMARK(Encoding, readStringUTF16LE) {
+	const std::vector<byte> utf16 = convertCP1252Data(Common::kEncodingUTF16LE);
+
+	readStrings(state, createStringData(&utf16[0], utf16.size(), 2), Common::kEncodingUTF16LE);
+}
+
+static void readStringsThread(const std::vector<byte> *data, Common::Encoding encoding, size_t *count) {
+	*count = readStrings(*data, encoding);
+}
+
+/** Decode CP1252 and UTF-16BE strings in several threads at once. */
+BENCHMARK(Encoding, readStringThreads) {
+	const std::vector<byte> utf16 = convertCP1252Data(Common::kEncodingUTF16BE);
+
+	const std::vector<byte> dataCP1252 = createStringData(kCP1252Data, sizeof(kCP1252Data), 1);
+	const std::vector<byte> dataUTF16  = createStringData(&utf16[0], utf16.size(), 2);
+
+	size_t count = 0;
+	while (state.keepRunning()) {
+		std::vector<std::thread> threads;
+		size_t counts[kEncodingThreadCount] = { 0 };
+
+		for (size_t i = 0; i < kEncodingThreadCount; i++) {
+			const bool isUTF16 = (i % 2) == 1;
+
+			threads.push_back(std::thread(readStringsThread, isUTF16 ? &dataUTF16 : &dataCP1252,
+			                              isUTF16 ? Common::kEncodingUTF16BE : Common::kEncodingCP1252,
+			                              &counts[i]));
+		}
+
+		for (size_t i = 0; i < kEncodingThreadCount; i++) {
+			threads[i].join();
+
+			count += counts[i];
+		}
+	}
+
+	state.setBytesProcessed(state.getIterations() * (dataCP1252.size() + dataUTF16.size()) * (kEncodingThreadCount / 2));
+	state.setItemsProcessed(count);
+}
+
+/** Create resource names of mixed case, like the ones found in game archives. */
+static std::vector<Common::UString> createResourceNames() {
+	std::vector<Common::UString> names(kHashNameCount);
+	for (size_t i = 0; i < kHashNameCount; i++)
+		names[i] = Common::UString::format("Data/Models/Resource_%07u.MDL", (uint) i);
+
+	return names;
+}
+
+/** Hash the names case-insensitively, either in one go or by lowercasing them first. */
+static void hashNamesLower(Bench::State &state, Common::HashAlgo algo, bool toLower) {
+	const std::vector<Common::UString> names = createResourceNames();
+
+	while (state.keepRunning()) {
+		uint64 sum = 0;
+		for (size_t i = 0; i < kHashNameCount; i++)
+			sum += toLower ? Common::hashString(names[i].toLower(), algo) : Common::hashStringLower(names[i], algo);
+
+		Bench::doNotOptimize(sum);
+	}
+
+	state.setItemsProcessed(state.getIterations() * kHashNameCount);
+}
+
+BENCHMARK(Hash, lowerDJB2) {
+	hashNamesLower(state, Common::kHashDJB2, false);
+}
+
+BENCHMARK(Hash, lowerFNV32) {
+	hashNamesLower(state, Common::kHashFNV32, false);
+}
+
+BENCHMARK(Hash, lowerFNV64) {
+	hashNamesLower(state, Common::kHashFNV64, false);
+}
+
+BENCHMARK(Hash, lowerCRC32) {
+	hashNamesLower(state, Common::kHashCRC32, false);
+}
+
+BENCHMARK(Hash, toLowerCRC32) {
+	hashNamesLower(state, Common::kHashCRC32, true);
+}
+
+/** Create short resource names and their data pointers for MD5 hashing. */
+static void createMD5Blocks(std::vector<Common::UString> &names,
+                            std::vector<const byte *> &blocks, std::vector<size_t> &lengths) {
+
+	names.resize(kHashNameCount);
+	blocks.resize(kHashNameCount);
+	lengths.resize(kHashNameCount);
+
+	for (size_t i = 0; i < kHashNameCount; i++) {
+		names[i] = Common::UString::format("resource_%07u.mdl", (uint) i);
+
+		blocks [i] = reinterpret_cast<const byte *>(names[i].c_str());
+		lengths[i] = names[i].size();
+	}
+}
+
+BENCHMARK(MD5, single) {
+	std::vector<Common::UString> names;
+	std::vector<const byte *> blocks;
+	std::vector<size_t> lengths;
+	createMD5Blocks(names, blocks, lengths);
+
+	std::vector< std::vector<byte> > digests(kHashNameCount);
+	while (state.keepRunning()) {
+		for (size_t i = 0; i < kHashNameCount; i++)
+			Common::hashMD5(blocks[i], lengths[i], digests[i]);
+
+		Bench::doNotOptimize(digests[0][0]);
+	}
+
+	state.setItemsProcessed(state.getIterations() * kHashNameCount);
+}
+
+BENCHMARK(MD5, multiple) {
+	std::vector<Common::UString> names;
+	std::vector<const byte *> blocks;
+	std::vector<size_t> lengths;
+	createMD5Blocks(names, blocks, lengths);
+
+	std::vector< std::vector<byte> > digests;
+	while (state.keepRunning()) {
+		Common::hashMD5(&blocks[0], &lengths[0], kHashNameCount, digests);
+
+		Bench::doNotOptimize(digests[0][0]);
+	}
+
+	state.setItemsProcessed(state.getIterations() * kHashNameCount);
+}
+
+/** Size of the data to en- and decrypt with Blowfish. */
+static const size_t kBlowfishDataSize = 8 * 1024 * 1024;
+
+static std::vector<byte> createBlowfishKey() {
+	static const byte kKey[] = { 'T', 'h', 'i', 's', ' ', 'a', ' ', 'K', 'e', 'y', '!' };
+
+	return std::vector<byte>(kKey, kKey + sizeof(kKey));
+}
+
+BENCHMARK(Blowfish, decryptStream) {
+	const std::vector<byte> key = createBlowfishKey();
+
+	std::vector<byte> data(kBlowfishDataSize);
+	Bench::FixtureRandom().fill(&data[0], data.size());
+
+	while (state.keepRunning()) {
+		Common::MemoryReadStream cipherStream(&data[0], data.size());
+		Common::ScopedPtr<Common::MemoryReadStream> clearStream(Common::decryptBlowfishEBC(cipherStream, key));
+
+		Bench::doNotOptimize(clearStream->getData()[0]);
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+}
+
+BENCHMARK(Blowfish, decryptInPlace) {
+	const std::vector<byte> key = createBlowfishKey();
+
+	std::vector<byte> data(kBlowfishDataSize);
+	Bench::FixtureRandom().fill(&data[0], data.size());
+
+	while (state.keepRunning()) {
+		Common::decryptBlowfishEBC(&data[0], data.size(), key);
+
+		Bench::doNotOptimize(data[0]);
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+}
+
+BENCHMARK(Blowfish, decryptReadStream) {
+	static const size_t kReadSize = 4096;
+
+	const std::vector<byte> key = createBlowfishKey();
+
+	std::vector<byte> data(kBlowfishDataSize);
+	Bench::FixtureRandom().fill(&data[0], data.size());
+
+	std::vector<byte> buffer(kReadSize);
+
+	while (state.keepRunning()) {
+		Common::MemoryReadStream cipherStream(&data[0], data.size());
+		Common::BlowfishEBCDecryptStream stream(&cipherStream, key);
+
+		while (stream.read(&buffer[0], buffer.size()) == buffer.size())
+			;
+
+		Bench::doNotOptimize(buffer[0]);
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+}
+
+/** Number of vertices (position, normal and texture coordinates) to read from a stream. */
+static const size_t kVertexCount = 100000;
+static const size_t kVertexWidth = 8;
+
+/** Read an array of vertices through a sub stream, like the model loaders do. */
+static void readVertices(Bench::State &state, bool bulk) {
+	const std::vector<byte> data = createRandomData(kVertexCount * kVertexWidth * 4);
+
+	Common::MemoryReadStream stream(&data[0], data.size());
+
+	std::vector<float> values(kVertexCount * kVertexWidth);
+
+	while (state.keepRunning()) {
+		Common::SeekableSubReadStream subStream(&stream, 0, stream.size());
+
+		if (bulk) {
+			subStream.readArrayLE(&values[0], values.size());
+		} else {
+			for (size_t i = 0; i < values.size(); i++)
+				values[i] = subStream.readIEEEFloatLE();
+		}
+
+		Bench::doNotOptimize(values[0]);
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+	state.setItemsProcessed(state.getIterations() * kVertexCount);
+}
+
+BENCHMARK(MemoryReadStream, readFloatSingle) {
+	readVertices(state, false);
+}
+
+BENCHMARK(MemoryReadStream, readFloatArray) {
+	readVertices(state, true);
+}
+
+/** Number of vertices in the ASCII model mesh to tokenize. */
+static const size_t kTokenizerVertexCount = 100000;
+
+/** Create the vertex list of a large ASCII model mesh. */
+static Common::UString createASCIIMesh() {
+	Common::UString model = Common::UString::format("  verts %u\n", (uint) kTokenizerVertexCount);
+	for (size_t i = 0; i < kTokenizerVertexCount; i++)
+		model += Common::UString::format("    %.6f %.6f %.6f\r\n", i * 0.001f, i * -0.25f, i * 3.5f);
+
+	return model;
+}
+
+static void parseToken(const Common::UString &token, float &value) {
+	Common::parseString(token, value);
+}
+
+static void parseToken(const Common::TokenView &token, float &value) {
+	token.parse(value);
+}
+
+/** Parse the vertices out of an ASCII model mesh. */
+template<class Tokenizer, typename Token>
+static void tokenizeMesh(Bench::State &state) {
+	const Common::UString model = createASCIIMesh();
+
+	std::vector<float> verts(kTokenizerVertexCount * 3);
+	std::vector<Token> line;
+
+	while (state.keepRunning()) {
+		Common::MemoryReadStream stream(model.c_str());
+
+		Tokenizer tokenizer(Common::StreamTokenizer::kRuleIgnoreAll);
+		tokenizer.addSeparator(' ');
+		tokenizer.addChunkEnd('\n');
+		tokenizer.addIgnore('\r');
+
+		tokenizer.nextChunk(stream);
+
+		for (size_t i = 0; i < kTokenizerVertexCount; i++) {
+			tokenizer.getTokens(stream, line, 3);
+			tokenizer.nextChunk(stream);
+
+			for (size_t j = 0; j < 3; j++)
+				parseToken(line[j], verts[i * 3 + j]);
+		}
+
+		Bench::doNotOptimize(verts[0]);
+	}
+
+	state.setBytesProcessed(state.getIterations() * model.size());
+	state.setItemsProcessed(state.getIterations() * kTokenizerVertexCount);
+}
+
+BENCHMARK(Tokenizer, streamTokenizer) {
+	tokenizeMesh<Common::StreamTokenizer, Common::UString>(state);
+}
+
+BENCHMARK(Tokenizer, memoryTokenizer) {
+	tokenizeMesh<Common::MemoryTokenizer, Common::TokenView>(state);
+}
@@ -0,0 +1,242 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for the common engine utilities.
+ */
+
+#include <vector>
+
+#include <boost/filesystem.hpp>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+#include "src/common/writefile.h"
+
+#include "src/aurora/resman.h"
+#include "src/aurora/gff3file.h"
+#include "src/aurora/gff3writer.h"
+
+#include "src/engines/aurora/util.h"
+#include "src/engines/aurora/pathfinding.h"
+#include "src/engines/aurora/astar.h"
+#include "src/engines/aurora/blueprintpreloader.h"
+
+#include "bench/bench.h"
+
+/** The size of the walkmesh grid, in cells. */
+static const uint32 kGridSize = 32;
+
+/** Every this many columns, there's a wall blocking the way. */
+static const uint32 kWallSpacing = 6;
+
+/** A walkmesh made of a square grid of quads.
+ *
+ *  Walls with a single gap at alternating ends run through the grid,
+ *  forcing a path from one side to the other to snake through it.
+ */
+class GridPathfinding : public Engines::Pathfinding {
+public:
+	GridPathfinding() : Engines::Pathfinding(std::vector<bool>({ true, false }), 4) {
+		_verticesCount = (kGridSize + 1) * (kGridSize + 1);
+		_facesCount    = kGridSize * kGridSize;
+
+		_vertices.reserve(_verticesCount * 3);
+		for (uint32 y = 0; y <= kGridSize; y++) {
+			for (uint32 x = 0; x <= kGridSize; x++) {
+				_vertices.push_back(x);
+				_vertices.push_back(y);
+				_vertices.push_back(0.0f);
+			}
+		}
+
+		_faces.reserve(_facesCount * 4);
+		_adjFaces.reserve(_facesCount * 4);
+		_faceProperty.reserve(_facesCount);
+
+		for (uint32 y = 0; y < kGridSize; y++) {
+			for (uint32 x = 0; x < kGridSize; x++) {
+				// Counter-clockwise; edge n goes from vertex n to vertex n + 1
+				_faces.push_back(getVertexIndex(x    , y    ));
+				_faces.push_back(getVertexIndex(x + 1, y    ));
+				_faces.push_back(getVertexIndex(x + 1, y + 1));
+				_faces.push_back(getVertexIndex(x    , y + 1));
+
+				_adjFaces.push_back((y > 0)               ? getFaceIndex(x    , y - 1) : UINT32_MAX);
+				_adjFaces.push_back((x < (kGridSize - 1)) ? getFaceIndex(x + 1, y    ) : UINT32_MAX);
+				_adjFaces.push_back((y < (kGridSize - 1)) ? getFaceIndex(x    , y + 1) : UINT32_MAX);
+				_adjFaces.push_back((x > 0)               ? getFaceIndex(x - 1, y    ) : UINT32_MAX);
+
+				_faceProperty.push_back(isWall(x, y) ? 1 : 0);
+			}
+		}
+	}
+
+protected:
+	uint32 findFace(float x, float y, bool onlyWalkable) {
+		if ((x < 0.0f) || (y < 0.0f) || (x >= kGridSize) || (y >= kGridSize))
+			return UINT32_MAX;
+
+		const uint32 face = getFaceIndex(x, y);
+		if (onlyWalkable && !faceWalkable(face))
+			return UINT32_MAX;
+
+		return face;
+	}
+
+private:
+	static uint32 getVertexIndex(uint32 x, uint32 y) {
+		return y * (kGridSize + 1) + x;
+	}
+
+	static uint32 getFaceIndex(uint32 x, uint32 y) {
+		return y * kGridSize + x;
+	}
+
+	static bool isWall(uint32 x, uint32 y) {
+		if ((x % kWallSpacing) != (kWallSpacing - 1))
+			return false;
+
+		// Leave a gap at the top or the bottom, alternating
+		const bool gapAtTop = ((x / kWallSpacing) % 2) == 0;
+
+		return gapAtTop ? (y != (kGridSize - 1)) : (y != 0);
+	}
+};
+
+BENCHMARK(AStar, gridWalls) {
+	GridPathfinding pathfinding;
+
+	Engines::AStar *aStar = new Engines::AStar(&pathfinding);
+	pathfinding.setAStarAlgorithm(aStar);
+
+	std::vector<uint32> path;
+
+	while (state.keepRunning()) {
+		if (!aStar->findPath(0.5f, 0.5f, kGridSize - 0.5f, 0.5f, path))
+			throw Common::Exception("A* didn't find a path through the grid");
+
+		Bench::doNotOptimize(path.size());
+	}
+
+	state.setItemsProcessed(state.getIterations() * path.size());
+}
+
+static const uint32 kUTCID = MKTAG('U', 'T', 'C', ' ');
+
+/** Number of distinct creature blueprints in the area. */
+static const size_t kBlueprintCount = 64;
+/** Number of creature instances in the area. */
+static const size_t kInstanceCount  = 2048;
+
+/** A temporary override directory full of creature blueprints, indexed by the ResMan. */
+class BlueprintDirectory {
+public:
+	BlueprintDirectory() {
+		_baseDir = boost::filesystem::temp_directory_path() /
+		           boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		boost::filesystem::create_directories(_baseDir / "override");
+
+		for (size_t i = 0; i < kBlueprintCount; i++)
+			writeBlueprint(i);
+
+		ResMan.registerDataBase(_baseDir.generic_string());
+		ResMan.indexResourceDir("override", 0, 0, 100);
+	}
+
+	~BlueprintDirectory() {
+		ResMan.clear();
+
+		boost::system::error_code error;
+		boost::filesystem::remove_all(_baseDir, error);
+	}
+
+	static Common::UString getName(size_t i) {
+		return Common::UString::format("creature%u", (uint)i);
+	}
+
+private:
+	boost::filesystem::path _baseDir;
+
+	void writeBlueprint(size_t i) {
+		Aurora::GFF3Writer gff(kUTCID);
+
+		gff.getTopLevel()->addUint32("Index", i);
+		gff.getTopLevel()->addExoString("Tag", getName(i));
+
+		// Give the blueprints a bit of bulk, like a creature's inventory
+		Aurora::GFF3WriterListPtr list = gff.getTopLevel()->addList("ItemList");
+		for (size_t j = 0; j < 64; j++) {
+			Aurora::GFF3WriterStructPtr item = list->addStruct("");
+
+			item->addExoString("InventoryRes", Common::UString::format("item%u", (uint)j));
+			item->addUint16("Repos_PosX", j % 8);
+			item->addUint16("Repos_Posy", j / 8);
+		}
+
+		const boost::filesystem::path file = _baseDir / "override" / getName(i).c_str();
+
+		Common::WriteFile stream(file.generic_string() + ".utc");
+		gff.write(stream);
+	}
+};
+
+/** Load the blueprints of all creature instances in the area. */
+static void loadAreaCreatures() {
+	for (size_t i = 0; i < kInstanceCount; i++) {
+		Common::ScopedPtr<Aurora::GFF3File> gff3(Engines::loadOptionalGFF3(BlueprintDirectory::getName(i % kBlueprintCount),
+		                                         Aurora::kFileTypeUTC, kUTCID));
+		if (!gff3)
+			throw Common::Exception("Failed to load creature %u", (uint) i);
+
+		Bench::doNotOptimize(gff3->getTopLevel().getUint("Index"));
+	}
+}
+
+BENCHMARK(BlueprintPreloader, serial) {
+	BlueprintDirectory blueprints;
+
+	// Load all instances one by one, like the area loaders used to
+	while (state.keepRunning())
+		loadAreaCreatures();
+
+	state.setItemsProcessed(state.getIterations() * kInstanceCount);
+}
+
+BENCHMARK(BlueprintPreloader, preload) {
+	BlueprintDirectory blueprints;
+
+	while (state.keepRunning()) {
+		Engines::BlueprintPreloader preloader;
+		for (size_t i = 0; i < kInstanceCount; i++)
+			preloader.add(BlueprintDirectory::getName(i % kBlueprintCount), Aurora::kFileTypeUTC, kUTCID);
+
+		preloader.read();
+		preloader.parse();
+
+		loadAreaCreatures();
+	}
+
+	state.setItemsProcessed(state.getIterations() * kInstanceCount);
+}
@@ -0,0 +1,262 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for the image decoders.
+ */
+
+#include <vector>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/graphics/images/dds.h"
+#include "src/graphics/images/tpc.h"
+#include "src/graphics/images/tga.h"
+#include "src/graphics/images/txb.h"
+#include "src/graphics/images/s3tc.h"
+
+#include "bench/bench.h"
+
+static const uint32 kImageWidth  = 512;
+static const uint32 kImageHeight = 512;
+
+static const uint32 kDXT1Size  = kImageWidth * kImageHeight / 2;
+static const uint32 kDXT5Size  = kImageWidth * kImageHeight;
+static const uint32 kRGBA8Size = kImageWidth * kImageHeight * 4;
+
+static std::vector<byte> toVector(Common::MemoryWriteStreamDynamic &stream) {
+	return std::vector<byte>(stream.getData(), stream.getData() + stream.size());
+}
+
+static void writeRandomData(Common::WriteStream &stream, size_t size) {
+	std::vector<byte> data(size);
+
+	Bench::FixtureRandom random;
+	random.fill(&data[0], data.size());
+
+	stream.write(&data[0], data.size());
+}
+
+template<class Decoder>
+static void decodeImage(Bench::State &state, const std::vector<byte> &data, bool decompress) {
+	while (state.keepRunning()) {
+		Common::MemoryReadStream stream(&data[0], data.size());
+		Decoder image(stream);
+
+		if (decompress)
+			image.decompress();
+
+		Bench::doNotOptimize(image.getMipMap(0).data[0]);
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+}
+
+// --- DDS ---
+
+static std::vector<byte> createDDS(uint32 fourCC, uint32 dataSize) {
+	Common::MemoryWriteStreamDynamic dds(true);
+
+	dds.writeUint32BE(MKTAG('D', 'D', 'S', ' '));
+	dds.writeUint32LE(124);
+	dds.writeUint32LE(0x00001007); // Caps, height, width, pixel format
+	dds.writeUint32LE(kImageHeight);
+	dds.writeUint32LE(kImageWidth);
+	dds.writeUint32LE(dataSize);
+	dds.writeUint32LE(0);
+	dds.writeUint32LE(1);
+	dds.writeZeros(44);
+
+	dds.writeUint32LE(32);
+	dds.writeUint32LE(0x00000004); // Has FourCC
+	dds.writeUint32BE(fourCC);
+	dds.writeZeros(20);
+
+	dds.writeZeros(16 + 4);
+
+	writeRandomData(dds, dataSize);
+
+	return toVector(dds);
+}
+
+BENCHMARK(DDS, loadDXT1) {
+	decodeImage<Graphics::DDS>(state, createDDS(MKTAG('D', 'X', 'T', '1'), kDXT1Size), false);
+}
+
+BENCHMARK(DDS, decompressDXT1) {
+	decodeImage<Graphics::DDS>(state, createDDS(MKTAG('D', 'X', 'T', '1'), kDXT1Size), true);
+}
+
+BENCHMARK(DDS, decompressDXT5) {
+	decodeImage<Graphics::DDS>(state, createDDS(MKTAG('D', 'X', 'T', '5'), kDXT5Size), true);
+}
+
+// --- TPC ---
+
+static std::vector<byte> createTPC(uint32 dataSize, byte encoding, uint32 pixelSize) {
+	static const char *kTXI = "blending additive\nmipmap 0\nfilter 1\n";
+
+	Common::MemoryWriteStreamDynamic tpc(true);
+
+	tpc.writeUint32LE(dataSize);
+	tpc.writeIEEEFloatLE(0.0f);
+	tpc.writeUint16LE(kImageWidth);
+	tpc.writeUint16LE(kImageHeight);
+	tpc.writeByte(encoding);
+	tpc.writeByte(1);
+	tpc.writeZeros(114);
+
+	writeRandomData(tpc, pixelSize);
+
+	tpc.writeString(kTXI);
+
+	return toVector(tpc);
+}
+
+BENCHMARK(TPC, decompressDXT5) {
+	decodeImage<Graphics::TPC>(state, createTPC(kDXT5Size, 0x04, kDXT5Size), true);
+}
+
+BENCHMARK(TPC, deSwizzleBGRA) {
+	decodeImage<Graphics::TPC>(state, createTPC(0, 0x0C, kRGBA8Size), false);
+}
+
+// --- TGA ---
+
+static void writeTGAHeader(Common::WriteStream &tga, byte imageType) {
+	tga.writeByte(0);         // ID length
+	tga.writeByte(0);         // No color map
+	tga.writeByte(imageType);
+	tga.writeZeros(5 + 2 + 2);
+	tga.writeUint16LE(kImageWidth);
+	tga.writeUint16LE(kImageHeight);
+	tga.writeByte(32);        // Bits per pixel
+	tga.writeByte(0x28);      // 8 alpha bits, top-left origin
+}
+
+static std::vector<byte> createTGARaw() {
+	Common::MemoryWriteStreamDynamic tga(true);
+
+	writeTGAHeader(tga, 2);
+	writeRandomData(tga, kRGBA8Size);
+
+	return toVector(tga);
+}
+
+/** Create an RLE TGA with a mix of run-length and raw packets. */
+static std::vector<byte> createTGARLE() {
+	Common::MemoryWriteStreamDynamic tga(true);
+
+	writeTGAHeader(tga, 10);
+
+	Bench::FixtureRandom random;
+
+	uint32 pixels = kImageWidth * kImageHeight;
+	while (pixels > 0) {
+		const uint32 count = MIN<uint32>(random.next(1, 128), pixels);
+
+		if (random.next() & 1) {
+			tga.writeByte(0x80 | (count - 1));
+			tga.writeUint32LE(random.next());
+		} else {
+			tga.writeByte(count - 1);
+			for (uint32 i = 0; i < count; i++)
+				tga.writeUint32LE(random.next());
+		}
+
+		pixels -= count;
+	}
+
+	return toVector(tga);
+}
+
+BENCHMARK(TGA, loadRaw) {
+	decodeImage<Graphics::TGA>(state, createTGARaw(), false);
+}
+
+BENCHMARK(TGA, loadRLE) {
+	decodeImage<Graphics::TGA>(state, createTGARLE(), false);
+}
+
+// --- TXB ---
+
+static std::vector<byte> createTXB(byte encoding, uint32 dataSize) {
+	Common::MemoryWriteStreamDynamic txb(true);
+
+	txb.writeUint32LE(dataSize);
+	txb.writeIEEEFloatLE(0.0f);
+	txb.writeUint16LE(kImageWidth);
+	txb.writeUint16LE(kImageHeight);
+	txb.writeByte(encoding);
+	txb.writeByte(1);
+	txb.writeUint16LE(0x0101);
+	txb.writeIEEEFloatLE(0.0f);
+	txb.writeZeros(108);
+
+	writeRandomData(txb, dataSize);
+
+	return toVector(txb);
+}
+
+BENCHMARK(TXB, deSwizzleBGRA) {
+	decodeImage<Graphics::TXB>(state, createTXB(0x04, kRGBA8Size), false);
+}
+
+BENCHMARK(TXB, decompressDXT1) {
+	decodeImage<Graphics::TXB>(state, createTXB(0x0A, kDXT1Size), true);
+}
+
+// --- S3TC ---
+
+typedef void (*DecompressFunc)(byte *dest, Common::SeekableReadStream &src, uint32 width, uint32 height, uint32 pitch);
+
+static void decompressS3TC(Bench::State &state, DecompressFunc decompress, uint32 dataSize) {
+	std::vector<byte> data(dataSize);
+
+	Bench::FixtureRandom random;
+	random.fill(&data[0], data.size());
+
+	std::vector<byte> out(kRGBA8Size);
+
+	while (state.keepRunning()) {
+		Common::MemoryReadStream stream(&data[0], data.size());
+
+		decompress(&out[0], stream, kImageWidth, kImageHeight, kImageWidth * 4);
+
+		Bench::doNotOptimize(out[0]);
+	}
+
+	state.setBytesProcessed(state.getIterations() * kRGBA8Size);
+}
+
+BENCHMARK(S3TC, DXT1) {
+	decompressS3TC(state, &Graphics::decompressDXT1, kDXT1Size);
+}
+
+BENCHMARK(S3TC, DXT3) {
+	decompressS3TC(state, &Graphics::decompressDXT3, kDXT5Size);
+}
+
+BENCHMARK(S3TC, DXT5) {
+	decompressS3TC(state, &Graphics::decompressDXT5, kDXT5Size);
+}
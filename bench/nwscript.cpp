@@ -0,0 +1,106 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for the NWScript bytecode interpreter.
+ */
+
+#include <vector>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/aurora/nwscript/variable.h"
+#include "src/aurora/nwscript/objectref.h"
+#include "src/aurora/nwscript/ncsfile.h"
+
+#include "bench/bench.h"
+
+/** Number of loop iterations the benchmark script runs. */
+static const int32 kLoopCount = 10000;
+
+/** Instructions executed by each loop iteration of the benchmark script. */
+static const uint32 kInstructionsPerLoop = 11;
+
+/** Create a script that sums up all integers in [0, kLoopCount).
+ *
+ *  @code
+ *  int main() {
+ *  	int sum = 0;
+ *  	for (int i = 0; i < kLoopCount; i++)
+ *  		sum = sum + i;
+ *
+ *  	return sum;
+ *  }
+ *  @endcode
+ */
+static std::vector<byte> createLoopScript() {
+	Common::MemoryWriteStreamDynamic ncs(true);
+
+	ncs.writeUint32BE(MKTAG('N', 'C', 'S', ' '));
+	ncs.writeUint32BE(MKTAG('V', '1', '.', '0'));
+	ncs.writeByte(0x42);
+	ncs.writeUint32BE(99);
+
+	// 13: CONST int 0 (sum), CONST int 0 (i)
+	ncs.writeByte(0x04); ncs.writeByte(0x03); ncs.writeSint32BE(0);
+	ncs.writeByte(0x04); ncs.writeByte(0x03); ncs.writeSint32BE(0);
+
+	// 25: CPTOPSP i, CONST int kLoopCount, LT, JZ 91
+	ncs.writeByte(0x03); ncs.writeByte(0x01); ncs.writeSint32BE(-4); ncs.writeSint16BE(4);
+	ncs.writeByte(0x04); ncs.writeByte(0x03); ncs.writeSint32BE(kLoopCount);
+	ncs.writeByte(0x0F); ncs.writeByte(0x20);
+	ncs.writeByte(0x1F); ncs.writeByte(0x00); ncs.writeSint32BE(50);
+
+	// 47: CPTOPSP sum, CPTOPSP i, ADD, CPDOWNSP sum, MOVSP
+	ncs.writeByte(0x03); ncs.writeByte(0x01); ncs.writeSint32BE(-8); ncs.writeSint16BE(4);
+	ncs.writeByte(0x03); ncs.writeByte(0x01); ncs.writeSint32BE(-8); ncs.writeSint16BE(4);
+	ncs.writeByte(0x14); ncs.writeByte(0x20);
+	ncs.writeByte(0x01); ncs.writeByte(0x01); ncs.writeSint32BE(-12); ncs.writeSint16BE(4);
+	ncs.writeByte(0x1B); ncs.writeByte(0x00); ncs.writeSint32BE(-4);
+
+	// 79: INCSP i, JMP 25
+	ncs.writeByte(0x24); ncs.writeByte(0x03); ncs.writeSint32BE(-4);
+	ncs.writeByte(0x1D); ncs.writeByte(0x00); ncs.writeSint32BE(-60);
+
+	// 91: MOVSP i, RETN
+	ncs.writeByte(0x1B); ncs.writeByte(0x00); ncs.writeSint32BE(-4);
+	ncs.writeByte(0x20); ncs.writeByte(0x00);
+
+	return std::vector<byte>(ncs.getData(), ncs.getData() + ncs.size());
+}
+
+BENCHMARK(NWScript, loop) {
+	const std::vector<byte> data = createLoopScript();
+
+	Aurora::NWScript::NCSFile ncs(new Common::MemoryReadStream(&data[0], data.size()));
+
+	while (state.keepRunning()) {
+		const Aurora::NWScript::Variable &result = ncs.run(Aurora::NWScript::ObjectReference());
+
+		if (result.getInt() != ((kLoopCount * (kLoopCount - 1)) / 2))
+			throw Common::Exception("NWScript loop returned %d", result.getInt());
+	}
+
+	state.setItemsProcessed(state.getIterations() * kLoopCount * kInstructionsPerLoop);
+}
@@ -0,0 +1,57 @@
+# xoreos - A reimplementation of BioWare's Aurora engine
+#
+# xoreos is the legal property of its developers, whose names
+# can be found in the AUTHORS file distributed with this source
+# distribution.
+#
+# xoreos is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 3
+# of the License, or (at your option) any later version.
+#
+# xoreos is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+
+# Benchmarks for the engine subsystems. Only built on demand, by "make bench".
+
+EXTRA_PROGRAMS += bench/benchmark
+bench_benchmark_SOURCES =
+bench_benchmark_LDADD =
+
+bench_benchmark_SOURCES += \
+    bench/bench.h \
+    $(EMPTY)
+
+bench_benchmark_SOURCES += \
+    bench/bench.cpp \
+    bench/common.cpp \
+    bench/aurora.cpp \
+    bench/images.cpp \
+    bench/sound.cpp \
+    bench/video.cpp \
+    bench/engines.cpp \
+    bench/nwscript.cpp \
+    bench/actionscript.cpp \
+    $(EMPTY)
+
+bench_benchmark_LDADD += \
+    src/engines/libengines.la \
+    src/events/libevents.la \
+    src/video/libvideo.la \
+    src/sound/libsound.la \
+    src/graphics/libgraphics.la \
+    src/aurora/libaurora.la \
+    src/common/libcommon.la \
+    src/version/libversion.la \
+    external/lua/liblua.la \
+    external/toluapp/libtoluapp.la \
+    $(LDADD) \
+    $(EMPTY)
+
+# Automake doesn't clean up EXTRA_PROGRAMS on its own
+CLEANFILES += bench/benchmark$(EXEEXT)
@@ -0,0 +1,161 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for the audio decoders.
+ */
+
+#include <vector>
+
+#include "src/common/types.h"
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/sound/audiostream.h"
+#include "src/sound/decoders/pcm.h"
+#include "src/sound/decoders/adpcm.h"
+#include "src/sound/decoders/wave.h"
+
+#include "bench/bench.h"
+
+static const int kSampleRate = 44100;
+
+/** Size of the encoded audio data: 256 blocks of 2048 bytes. */
+static const uint32 kAudioDataSize = 256 * 2048;
+
+static const uint32 kMSIMABlockAlign = 2048;
+static const uint32 kXboxBlockAlign  = 36;
+
+static const size_t kBufferSize = 4096;
+
+static std::vector<byte> createRandomData(size_t size) {
+	std::vector<byte> data(size);
+
+	Bench::FixtureRandom random;
+	random.fill(&data[0], data.size());
+
+	return data;
+}
+
+/** Fix up the block headers of random ADPCM data to hold valid step indices. */
+static void fixADPCMBlockHeaders(std::vector<byte> &data, uint32 blockAlign, int channels) {
+	Bench::FixtureRandom random;
+
+	for (size_t block = 0; (block + blockAlign) <= data.size(); block += blockAlign)
+		for (int i = 0; i < channels; i++)
+			WRITE_LE_UINT16(&data[block + i * 4 + 2], random.next(0, 88));
+}
+
+/** Decode a whole audio stream, returning the number of samples. */
+static size_t decodeStream(Sound::AudioStream &stream) {
+	int16 buffer[kBufferSize];
+
+	size_t samples = 0;
+	while (!stream.endOfData()) {
+		const size_t count = stream.readBuffer(buffer, kBufferSize);
+		if (count == 0)
+			break;
+
+		samples += count;
+	}
+
+	Bench::doNotOptimize(buffer[0]);
+
+	return samples;
+}
+
+BENCHMARK(Audio, PCM16) {
+	const std::vector<byte> data = createRandomData(kAudioDataSize);
+
+	size_t samples = 0;
+	while (state.keepRunning()) {
+		Common::ScopedPtr<Sound::AudioStream> stream(
+			Sound::makePCMStream(new Common::MemoryReadStream(&data[0], data.size()), kSampleRate,
+			                     Sound::FLAG_16BITS | Sound::FLAG_LITTLE_ENDIAN, 2));
+
+		samples += decodeStream(*stream);
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+	state.setItemsProcessed(samples);
+}
+
+BENCHMARK(Audio, WAV) {
+	const std::vector<byte> pcm = createRandomData(kAudioDataSize);
+
+	Common::MemoryWriteStreamDynamic wav(true);
+
+	wav.writeUint32BE(MKTAG('R', 'I', 'F', 'F'));
+	wav.writeUint32LE(4 + 8 + 16 + 8 + pcm.size());
+	wav.writeUint32BE(MKTAG('W', 'A', 'V', 'E'));
+
+	wav.writeUint32BE(MKTAG('f', 'm', 't', ' '));
+	wav.writeUint32LE(16);
+	wav.writeUint16LE(1);               // PCM
+	wav.writeUint16LE(2);               // Channels
+	wav.writeUint32LE(kSampleRate);
+	wav.writeUint32LE(kSampleRate * 4); // Bytes per second
+	wav.writeUint16LE(4);               // Block align
+	wav.writeUint16LE(16);              // Bits per sample
+
+	wav.writeUint32BE(MKTAG('d', 'a', 't', 'a'));
+	wav.writeUint32LE(pcm.size());
+	wav.write(&pcm[0], pcm.size());
+
+	const std::vector<byte> data(wav.getData(), wav.getData() + wav.size());
+
+	size_t samples = 0;
+	while (state.keepRunning()) {
+		Common::ScopedPtr<Sound::AudioStream> stream(
+			Sound::makeWAVStream(new Common::MemoryReadStream(&data[0], data.size()), true));
+
+		samples += decodeStream(*stream);
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+	state.setItemsProcessed(samples);
+}
+
+static void decodeADPCM(Bench::State &state, Sound::ADPCMTypes type, uint32 blockAlign, int channels) {
+	std::vector<byte> data = createRandomData(kAudioDataSize);
+	fixADPCMBlockHeaders(data, blockAlign * ((type == Sound::kADPCMXbox) ? channels : 1), channels);
+
+	size_t samples = 0;
+	while (state.keepRunning()) {
+		Common::ScopedPtr<Sound::AudioStream> stream(
+			Sound::makeADPCMStream(new Common::MemoryReadStream(&data[0], data.size()), true,
+			                       data.size(), type, kSampleRate, channels, blockAlign));
+
+		samples += decodeStream(*stream);
+	}
+
+	state.setBytesProcessed(state.getIterations() * data.size());
+	state.setItemsProcessed(samples);
+}
+
+BENCHMARK(Audio, MSIMAADPCM) {
+	decodeADPCM(state, Sound::kADPCMMSIma, kMSIMABlockAlign, 2);
+}
+
+BENCHMARK(Audio, XboxADPCM) {
+	decodeADPCM(state, Sound::kADPCMXbox, kXboxBlockAlign, 1);
+}
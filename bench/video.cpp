@@ -0,0 +1,120 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Benchmarks for the per-frame work of the Bink decoder.
+ *
+ *  The video decoders themselves render into a GL texture and can't run
+ *  headless, so we measure the parts of a Bink frame that don't need a GPU:
+ *  the YUV to RGB conversion of each video frame and the transforms used
+ *  to decode each audio block.
+ */
+
+#include <vector>
+
+#include "src/common/types.h"
+#include "src/common/dct.h"
+#include "src/common/rdft.h"
+
+#include "src/graphics/yuv_to_rgb.h"
+
+#include "bench/bench.h"
+
+static const int kFrameWidth  = 640;
+static const int kFrameHeight = 480;
+
+/** Bink audio uses blocks of 2048 samples for 44.1kHz streams. */
+static const int kAudioFrameLenBits = 11;
+static const int kAudioBlockCount   = 64;
+
+static std::vector<byte> createPlane(int width, int height, uint32 seed) {
+	std::vector<byte> plane(width * height);
+
+	Bench::FixtureRandom random(seed);
+	random.fill(&plane[0], plane.size());
+
+	return plane;
+}
+
+BENCHMARK(Bink, convertYUV420) {
+	const std::vector<byte> y = createPlane(kFrameWidth    , kFrameHeight    , 1);
+	const std::vector<byte> u = createPlane(kFrameWidth / 2, kFrameHeight / 2, 2);
+	const std::vector<byte> v = createPlane(kFrameWidth / 2, kFrameHeight / 2, 3);
+	const std::vector<byte> a = createPlane(kFrameWidth    , kFrameHeight    , 4);
+
+	std::vector<byte> bgra(kFrameWidth * kFrameHeight * 4);
+
+	while (state.keepRunning()) {
+		YUVToRGBMan.convert420(Graphics::YUVToRGBManager::kScaleITU, &bgra[0], kFrameWidth * 4,
+		                       &y[0], &u[0], &v[0], &a[0], kFrameWidth, kFrameHeight,
+		                       kFrameWidth, kFrameWidth / 2);
+
+		Bench::doNotOptimize(bgra[0]);
+	}
+
+	state.setBytesProcessed(state.getIterations() * bgra.size());
+	state.setItemsProcessed(state.getIterations());
+}
+
+static std::vector<float> createAudioBlocks() {
+	std::vector<float> data((1 << kAudioFrameLenBits) * kAudioBlockCount);
+
+	Bench::FixtureRandom random;
+	for (std::vector<float>::iterator d = data.begin(); d != data.end(); ++d)
+		*d = ((int32) random.next(0, 65535) - 32768) / 32768.0f;
+
+	return data;
+}
+
+BENCHMARK(Bink, audioDCT) {
+	const std::vector<float> blocks = createAudioBlocks();
+	std::vector<float> data(blocks.size());
+
+	Common::DCT dct(kAudioFrameLenBits, Common::DCT::DCT_III);
+
+	while (state.keepRunning()) {
+		data = blocks;
+
+		for (int i = 0; i < kAudioBlockCount; i++)
+			dct.calc(&data[i << kAudioFrameLenBits]);
+
+		Bench::doNotOptimize(data[0]);
+	}
+
+	state.setItemsProcessed(state.getIterations() * kAudioBlockCount);
+}
+
+BENCHMARK(Bink, audioRDFT) {
+	const std::vector<float> blocks = createAudioBlocks();
+	std::vector<float> data(blocks.size());
+
+	Common::RDFT rdft(kAudioFrameLenBits, Common::RDFT::DFT_C2R);
+
+	while (state.keepRunning()) {
+		data = blocks;
+
+		for (int i = 0; i < kAudioBlockCount; i++)
+			rdft.calc(&data[i << kAudioFrameLenBits]);
+
+		Bench::doNotOptimize(data[0]);
+	}
+
+	state.setItemsProcessed(state.getIterations() * kAudioBlockCount);
+}
@@ -81,6 +81,12 @@ bundle: all
 	chmod 755 $(BUNDLE_NAME)/Contents/MacOS/xoreos
 	$(STRIP) $(BUNDLE_NAME)/Contents/MacOS/xoreos
 
+# Build and run the subsystem benchmarks, writing the results into bench.json
+BENCH_JSON = bench.json
+.PHONY: bench
+bench: bench/benchmark$(EXEEXT)
+	bench/benchmark$(EXEEXT) --json=$(BENCH_JSON)
+
 # Subdirectories
 
 include dists/rules.mk
@@ -92,3 +98,5 @@ include external/rules.mk
 include src/rules.mk
 
 include tests/rules.mk
+
+include bench/rules.mk
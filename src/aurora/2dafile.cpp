@@ -34,8 +34,10 @@
 #include "src/common/strutil.h"
 #include "src/common/encoding.h"
 #include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
 #include "src/common/writefile.h"
 #include "src/common/streamtokenizer.h"
+#include "src/common/memorytokenizer.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/2dafile.h"
@@ -170,7 +172,11 @@ void TwoDAFile::load(Common::SeekableReadStream &twoda) {
 }
 
 void TwoDAFile::read2a(Common::SeekableReadStream &twoda) {
-	Common::StreamTokenizer tokenize(Common::StreamTokenizer::kRuleIgnoreAll);
+	/* Read the whole rest of the file into memory, so that the tokenizer can
+	 * directly look at the characters instead of reading them one by one. */
+	Common::ScopedPtr<Common::MemoryReadStream> twodaMem(twoda.readStream(twoda.size() - twoda.pos()));
+
+	Common::MemoryTokenizer tokenize(Common::StreamTokenizer::kRuleIgnoreAll);
 
 	// Spaces and tabs act to separate cells
 	tokenize.addSeparator(' ');
@@ -182,9 +188,9 @@ void TwoDAFile::read2a(Common::SeekableReadStream &twoda) {
 	// We're ignoring \r
 	tokenize.addIgnore('\r');
 
-	readDefault2a(twoda, tokenize);
-	readHeaders2a(twoda, tokenize);
-	readRows2a(twoda, tokenize);
+	readDefault2a(*twodaMem, tokenize);
+	readHeaders2a(*twodaMem, tokenize);
+	readRows2a(*twodaMem, tokenize);
 }
 
 void TwoDAFile::read2b(Common::SeekableReadStream &twoda) {
@@ -193,19 +199,19 @@ void TwoDAFile::read2b(Common::SeekableReadStream &twoda) {
 	readRows2b(twoda);
 }
 
-void TwoDAFile::readDefault2a(Common::SeekableReadStream &twoda,
-                              Common::StreamTokenizer &tokenize) {
+void TwoDAFile::readDefault2a(Common::MemoryReadStream &twoda,
+                              Common::MemoryTokenizer &tokenize) {
 
 	/* ASCII 2DA files can have default values that are returned for cells
 	 * that don't exist. They are specified in the second line, optionally
 	 * preceded by "Default:".
 	 */
 
-	std::vector<Common::UString> defaultRow;
+	std::vector<Common::TokenView> defaultRow;
 	tokenize.getTokens(twoda, defaultRow, 2);
 
 	if (defaultRow[0].equalsIgnoreCase("Default:"))
-		_defaultString = defaultRow[1];
+		_defaultString = defaultRow[1].toString();
 
 	_defaultInt   = parseInt(_defaultString);
 	_defaultFloat = parseFloat(_defaultString);
@@ -213,8 +219,8 @@ void TwoDAFile::readDefault2a(Common::SeekableReadStream &twoda,
 	tokenize.nextChunk(twoda);
 }
 
-void TwoDAFile::readHeaders2a(Common::SeekableReadStream &twoda,
-                              Common::StreamTokenizer &tokenize) {
+void TwoDAFile::readHeaders2a(Common::MemoryReadStream &twoda,
+                              Common::MemoryTokenizer &tokenize) {
 
 	/* Read the column headers of an ASCII 2DA file. */
 
@@ -224,8 +230,8 @@ void TwoDAFile::readHeaders2a(Common::SeekableReadStream &twoda,
 	tokenize.nextChunk(twoda);
 }
 
-void TwoDAFile::readRows2a(Common::SeekableReadStream &twoda,
-                           Common::StreamTokenizer &tokenize) {
+void TwoDAFile::readRows2a(Common::MemoryReadStream &twoda,
+                           Common::MemoryTokenizer &tokenize) {
 
 	/* And now read the individual cells in the rows. */
 
@@ -39,7 +39,8 @@
 namespace Common {
 	class SeekableReadStream;
 	class WriteStream;
-	class StreamTokenizer;
+	class MemoryReadStream;
+	class MemoryTokenizer;
 }
 
 namespace Aurora {
@@ -181,9 +182,9 @@ private:
 	void read2b(Common::SeekableReadStream &twoda);
 
 	// ASCII loading helpers
-	void readDefault2a(Common::SeekableReadStream &twoda, Common::StreamTokenizer &tokenize);
-	void readHeaders2a(Common::SeekableReadStream &twoda, Common::StreamTokenizer &tokenize);
-	void readRows2a   (Common::SeekableReadStream &twoda, Common::StreamTokenizer &tokenize);
+	void readDefault2a(Common::MemoryReadStream &twoda, Common::MemoryTokenizer &tokenize);
+	void readHeaders2a(Common::MemoryReadStream &twoda, Common::MemoryTokenizer &tokenize);
+	void readRows2a   (Common::MemoryReadStream &twoda, Common::MemoryTokenizer &tokenize);
 
 	// Binary loading helpers
 	void readHeaders2b (Common::SeekableReadStream &twoda);
@@ -23,9 +23,10 @@
  */
 
 #include <cassert>
+#include <cstring>
+
+#include <algorithm>
 
-#include "src/common/bitstream.h"
-#include "src/common/memreadstream.h"
 #include "src/common/debug.h"
 
 #include "src/aurora/actionscript/variable.h"
@@ -87,14 +88,87 @@ enum Opcodes {
 	kActionIf              = 0x9D
 };
 
-ASBuffer::ASBuffer(Common::SeekableReadStream *as) :
-		_currentLength(0), _seeked(0), _script(as) {
+/** Flags of an ActionDefineFunction2, in the order they're stored in the byte code. */
+enum DefineFunction2Flags {
+	kFlagPreloadParent     = 1 << 15,
+	kFlagPreloadRoot       = 1 << 14,
+	kFlagSuppressSuper     = 1 << 13,
+	kFlagPreloadSuper      = 1 << 12,
+	kFlagSuppressArguments = 1 << 11,
+	kFlagPreloadArguments  = 1 << 10,
+	kFlagSuppressThis      = 1 <<  9,
+	kFlagPreloadThis       = 1 <<  8,
+	kFlagReserved          = 0x00FE,
+	kFlagPreloadGlobal     = 1 <<  0
+};
+
+static const size_t kInvalidBranch = SIZE_MAX;
+
+/** A value pushed by an ActionPush. */
+struct PushValue {
+	enum Source {
+		kSourceLiteral,  ///< Push the decoded value.
+		kSourceRegister, ///< Push the contents of a register.
+		kSourceConstant  ///< Push an entry of the constant pool.
+	};
+
+	Source source;
+
+	/** Register number or constant pool index. */
+	uint16 index;
+	/** The decoded value of a literal. */
+	Variable value;
+
+	PushValue(Source s, uint16 i) : source(s), index(i) { }
+	PushValue(const Variable &v) : source(kSourceLiteral), index(0), value(v) { }
+};
+
+/** A decoded actionscript instruction. */
+struct ASBuffer::Instruction {
+	byte opcode;
+
+	/** Offset of the instruction within its block of byte code. */
+	size_t offset;
+
+	/** Branch offset, relative to the end of the instruction (Jump, If). */
+	int16 branchOffset;
+	/** Index of the instruction the branch leads to (Jump, If). */
+	size_t branchTarget;
+
+	/** Register number (StoreRegister) or flags (GetURL2). */
+	byte byteOperand;
+
+	/** The pushed values (Push). */
+	std::vector<PushValue> values;
+	/** The new constant pool (ConstantPool). */
+	std::vector<Common::UString> strings;
+
+	// DefineFunction, DefineFunction2
+	Common::UString functionName;
+	std::vector<uint8> parameterIds;
+	uint8 registerCount;
+	uint16 functionFlags;
+	CodePtr body;
 
+	Instruction() : opcode(0), offset(0), branchOffset(0), branchTarget(kInvalidBranch),
+		byteOperand(0), registerCount(0), functionFlags(0) {
+	}
+};
+
+ASBuffer::ASBuffer(Common::SeekableReadStream *as) : _script(as) {
 	assert(as);
 }
 
+ASBuffer::ASBuffer(CodePtr code) : _script(0), _code(code) {
+	assert(code);
+}
+
 void ASBuffer::run(AVM &avm) {
-	_script->seek(0);
+	if (!_code) {
+		_script->seek(0);
+		_code = decode(*_script, _script->size());
+	}
+
 	execute(avm);
 }
 
@@ -102,22 +176,229 @@ void ASBuffer::setConstantPool(std::vector<Common::UString> constantPool) {
 	_constants = constantPool;
 }
 
-void ASBuffer::execute(AVM &avm) {
-	byte opcode;
-	debugC(kDebugActionScript, 1, "--- Start Actionscript ---");
-	do {
-		_seeked = 0;
-		opcode = _script->readByte();
+ASBuffer::CodePtr ASBuffer::decode(Common::SeekableReadStream &script, size_t end) {
+	const size_t start = script.pos();
+
+	boost::shared_ptr<Code> code(new Code);
+	while (script.pos() < end) {
+		code->push_back(Instruction());
+
+		Instruction &instruction = code->back();
+		instruction.offset = script.pos() - start;
+
+		decodeInstruction(script, end, instruction);
+
+		// Branch targets are stored as offsets until all instructions are known
+		if ((instruction.opcode == kActionJump) || (instruction.opcode == kActionIf))
+			instruction.branchTarget = (script.pos() - start) + instruction.branchOffset;
+
+		if (instruction.opcode == 0)
+			break;
+	}
+
+	resolveBranches(*code, script.pos() - start);
+	return code;
+}
+
+void ASBuffer::decodeInstruction(Common::SeekableReadStream &script, size_t end, Instruction &instruction) {
+	instruction.opcode = script.readByte();
 
-		size_t length = 0;
-		if (opcode >= 0x80)
-			length = _script->readUint16LE();
+	size_t length = 0;
+	if (instruction.opcode >= 0x80)
+		length = script.readUint16LE();
 
-		_currentLength = length;
+	const size_t startPos = script.pos();
+	if ((startPos + length) > end)
+		throw Common::Exception("Invalid tag");
 
-		size_t startPos = _script->pos();
+	// The body of a function definition follows the tag, outside of its length
+	size_t bodySize = 0;
 
-		switch (opcode) {
+	switch (instruction.opcode) {
+		case kActionStoreRegister:
+			instruction.byteOperand = script.readByte();
+			break;
+
+		case kActionConstantPool: {
+				const uint16 count = script.readUint16LE();
+
+				instruction.strings.resize(count);
+				for (size_t i = 0; i < count; ++i)
+					instruction.strings[i] = readString(script);
+			}
+			break;
+
+		case kActionPush:
+			decodePush(script, startPos + length, instruction);
+			break;
+
+		case kActionJump:
+		case kActionIf:
+			instruction.branchOffset = script.readSint16LE();
+			break;
+
+		case kActionGetURL2:
+			instruction.byteOperand = script.readByte();
+			break;
+
+		case kActionDefineFunction:
+			bodySize = decodeDefineFunction(script, end, instruction);
+			break;
+
+		case kActionDefineFunction2:
+			bodySize = decodeDefineFunction2(script, end, instruction);
+			break;
+
+		default:
+			script.skip(length);
+			break;
+	}
+
+	if (script.pos() - startPos != length + bodySize)
+		throw Common::Exception("Invalid tag");
+}
+
+void ASBuffer::decodePush(Common::SeekableReadStream &script, size_t length, Instruction &instruction) {
+	while (script.pos() < length) {
+		const byte type = script.readByte();
+
+		switch (type) {
+			case 0:
+				instruction.values.push_back(PushValue(readString(script)));
+				break;
+
+			case 1:
+				instruction.values.push_back(PushValue(static_cast<double>(script.readIEEEFloatLE())));
+				break;
+
+			case 2:
+				instruction.values.push_back(PushValue(Variable::Null()));
+				break;
+
+			case 3:
+				instruction.values.push_back(PushValue(Variable()));
+				break;
+
+			case 4:
+				instruction.values.push_back(PushValue(PushValue::kSourceRegister, script.readByte()));
+				break;
+
+			case 5:
+				instruction.values.push_back(PushValue(script.readByte() != 0));
+				break;
+
+			case 6: {
+					// Double values are weird encoded.
+					uint32 value[2];
+					value[1] = script.readUint32LE();
+					value[0] = script.readUint32LE();
+
+					double doubleValue;
+					memcpy(&doubleValue, value, 8);
+
+					instruction.values.push_back(PushValue(doubleValue));
+				}
+				break;
+
+			case 7:
+				instruction.values.push_back(PushValue(static_cast<int>(script.readSint32LE())));
+				break;
+
+			// constant pool index 8bit
+			case 8:
+				instruction.values.push_back(PushValue(PushValue::kSourceConstant, script.readByte()));
+				break;
+
+			// constant pool index 16bit
+			case 9:
+				instruction.values.push_back(PushValue(PushValue::kSourceConstant, script.readUint16LE()));
+				break;
+
+			default:
+				throw Common::Exception("invalid type byte in actionscript");
+		}
+	}
+}
+
+size_t ASBuffer::decodeDefineFunction(Common::SeekableReadStream &script, size_t end, Instruction &instruction) {
+	instruction.functionName = readString(script);
+
+	const uint16 numParams = script.readUint16LE();
+	for (size_t i = 0; i < numParams; ++i)
+		readString(script);
+
+	const uint16 codeSize = script.readUint16LE();
+	const size_t bodyEnd = script.pos() + codeSize;
+	if (bodyEnd > end)
+		throw Common::Exception("Invalid tag");
+
+	// The body might end early, on an action end opcode. Skip what's left over
+	instruction.body = decode(script, bodyEnd);
+	script.seek(bodyEnd);
+
+	return codeSize;
+}
+
+size_t ASBuffer::decodeDefineFunction2(Common::SeekableReadStream &script, size_t end, Instruction &instruction) {
+	instruction.functionName = readString(script);
+
+	const uint16 numParams = script.readUint16LE();
+
+	instruction.registerCount = script.readByte();
+	instruction.functionFlags = script.readUint16BE();
+
+	assert((instruction.functionFlags & kFlagReserved) == 0);
+
+	instruction.parameterIds.resize(numParams);
+	for (size_t i = 0; i < numParams; ++i) {
+		instruction.parameterIds[i] = script.readByte();
+		readString(script);
+	}
+
+	const uint16 codeSize = script.readUint16LE();
+	const size_t bodyEnd = script.pos() + codeSize;
+	if (bodyEnd > end)
+		throw Common::Exception("Invalid tag");
+
+	// The body might end early, on an action end opcode. Skip what's left over
+	instruction.body = decode(script, bodyEnd);
+	script.seek(bodyEnd);
+
+	return codeSize;
+}
+
+static bool compareInstructionOffset(const ASBuffer::Instruction &instruction, size_t offset) {
+	return instruction.offset < offset;
+}
+
+void ASBuffer::resolveBranches(Code &code, size_t size) {
+	for (Code::iterator i = code.begin(); i != code.end(); ++i) {
+		if ((i->opcode != kActionJump) && (i->opcode != kActionIf))
+			continue;
+
+		const size_t offset = i->branchTarget;
+
+		Code::const_iterator target = std::lower_bound(code.begin(), code.end(), offset, compareInstructionOffset);
+		if ((target != code.end()) && (target->offset == offset))
+			i->branchTarget = target - code.begin();
+		else if (offset == size)
+			// Branching to the end of the script ends the execution
+			i->branchTarget = code.size();
+		else
+			i->branchTarget = kInvalidBranch;
+	}
+}
+
+void ASBuffer::execute(AVM &avm) {
+	const Code &code = *_code;
+
+	debugC(kDebugActionScript, 1, "--- Start Actionscript ---");
+
+	size_t next = 0;
+	while (next < code.size()) {
+		const Instruction &instruction = code[next++];
+
+		switch (instruction.opcode) {
 			case kActionStop:            actionStop(avm); break;
 			case kActionToggleQuality:   actionToggleQuality(); break;
 			case kActionSubtract:        actionSubtract(); break;
@@ -149,23 +430,22 @@ void ASBuffer::execute(AVM &avm) {
 			case kActionGreater:         actionGreater(); break;
 			case kActionExtends:         actionExtends(); break;
 			case kActionGetURL:          actionGetURL(avm); break;
-			case kActionStoreRegister:   actionStoreRegister(avm); break;
-			case kActionDefineFunction2: actionDefineFunction2(); break;
-			case kActionConstantPool:    actionConstantPool(); break;
-			case kActionPush:            actionPush(avm); break;
-			case kActionJump:            actionJump(); break;
-			case kActionGetURL2:         actionGetURL2(avm); break;
-			case kActionDefineFunction:  actionDefineFunction(); break;
-			case kActionIf:              actionIf(); break;
+			case kActionStoreRegister:   actionStoreRegister(avm, instruction); break;
+			case kActionDefineFunction2: actionDefineFunction2(instruction); break;
+			case kActionConstantPool:    actionConstantPool(instruction); break;
+			case kActionPush:            actionPush(avm, instruction); break;
+			case kActionJump:            actionJump(instruction, next); break;
+			case kActionGetURL2:         actionGetURL2(avm, instruction); break;
+			case kActionDefineFunction:  actionDefineFunction(instruction); break;
+			case kActionIf:              actionIf(instruction, next); break;
 			default:
-				_script->seek(length, Common::SeekableReadStream::kOriginCurrent);
-				if (opcode != 0)
+				if (instruction.opcode != 0)
 					warning("Unknown opcode");
 		}
 
-		if (_script->pos() - startPos != static_cast<size_t>(length + _seeked))
-			throw Common::Exception("Invalid tag");
-	} while (opcode != 0 && _script->pos() != _script->size() && avm.getReturnValue().isUndefined());
+		if ((instruction.opcode == 0) || !avm.getReturnValue().isUndefined())
+			break;
+	}
 
 	debugC(kDebugActionScript, 1, "--- End Actionscript ---");
 }
@@ -600,61 +880,39 @@ void ASBuffer::actionGetURL(AVM &avm) {
 	debugC(kDebugActionScript, 1, "actionGetURL \"%s\" \"%s\"", urlString.c_str(), targetString.c_str());
 }
 
-void ASBuffer::actionStoreRegister(AVM &avm) {
-	byte registerNumber = _script->readByte();
+void ASBuffer::actionStoreRegister(AVM &avm, const Instruction &instruction) {
+	const byte registerNumber = instruction.byteOperand;
 	avm.storeRegister(_stack.top(), registerNumber);
 
 	debugC(kDebugActionScript, 1, "actionStoreRegister %i", registerNumber);
 }
 
-void ASBuffer::actionConstantPool() {
-	uint16 count = _script->readUint16LE();
-	_constants.resize(count);
-	for (int i = 0; i < count; ++i) {
-		Common::UString constant = readString();
-		_constants[i] = constant;
-	}
+void ASBuffer::actionConstantPool(const Instruction &instruction) {
+	_constants = instruction.strings;
 
 	debugC(kDebugActionScript, 1, "actionConstantPool");
 }
 
-void ASBuffer::actionDefineFunction2() {
-	Common::UString functionName = readString();
-	int numParams = _script->readUint16LE();
-	int registerCount = _script->readByte();
+void ASBuffer::actionDefineFunction2(const Instruction &instruction) {
+	const uint16 flags = instruction.functionFlags;
 
-	Common::BitStream8MSB bitstream(_script);
-
-	bool preloadParentFlag = bitstream.getBit() != 0;
-	bool preloadRootFlag = bitstream.getBit() != 0;
-	bool suppressSuperFlag = bitstream.getBit() != 0;
-	bool preloadSuperFlag = bitstream.getBit() != 0;
-	bool suppressArgumentsFlag = bitstream.getBit() != 0;
-	bool preloadArgumentsFlag = bitstream.getBit() != 0;
-	bool suppressThisFlag = bitstream.getBit() != 0;
-	bool preloadThisFlag = bitstream.getBit() != 0;
-
-	unsigned int reserved = bitstream.getBits(7);
-	assert(reserved == 0);
-
-	bool preloadGlobalFlag = bitstream.getBit() != 0;
-
-	std::vector<uint8> parameterIds(numParams);
-	for (int i = 0; i < numParams; ++i) {
-		parameterIds[i] = _script->readByte();
-		readString();
-	}
-
-	unsigned short codeSize = _script->readUint16LE();
-	_seeked = codeSize;
+	const bool preloadParentFlag     = (flags & kFlagPreloadParent) != 0;
+	const bool preloadRootFlag       = (flags & kFlagPreloadRoot) != 0;
+	const bool suppressSuperFlag     = (flags & kFlagSuppressSuper) != 0;
+	const bool preloadSuperFlag      = (flags & kFlagPreloadSuper) != 0;
+	const bool suppressArgumentsFlag = (flags & kFlagSuppressArguments) != 0;
+	const bool preloadArgumentsFlag  = (flags & kFlagPreloadArguments) != 0;
+	const bool suppressThisFlag      = (flags & kFlagSuppressThis) != 0;
+	const bool preloadThisFlag       = (flags & kFlagPreloadThis) != 0;
+	const bool preloadGlobalFlag     = (flags & kFlagPreloadGlobal) != 0;
 
 	_stack.push(
 			ObjectPtr(
 					new ScriptedFunction(
-							_script->readStream(codeSize),
+							instruction.body,
 							_constants,
-							parameterIds,
-							registerCount,
+							instruction.parameterIds,
+							instruction.registerCount,
 							preloadThisFlag,
 							preloadSuperFlag,
 							preloadRootFlag,
@@ -666,10 +924,10 @@ void ASBuffer::actionDefineFunction2() {
 	debugC(
 			kDebugActionScript,
 			1,
-			"actionDefineFunction2 \"%s\" %d %d %s %s %s %s %s %s %s %s %s",
-			functionName.c_str(),
-			numParams,
-			registerCount,
+			"actionDefineFunction2 \"%s\" %u %d %s %s %s %s %s %s %s %s %s",
+			instruction.functionName.c_str(),
+			(uint)instruction.parameterIds.size(),
+			instruction.registerCount,
 			preloadParentFlag ? "true" : "false",
 			preloadRootFlag ? "true" : "false",
 			suppressSuperFlag ? "true" : "false",
@@ -682,116 +940,47 @@ void ASBuffer::actionDefineFunction2() {
 	);
 }
 
-void ASBuffer::actionPush(AVM &avm) {
-	unsigned short length = _currentLength;
-
-	while (length != 0) {
-		byte type = _script->readByte();
-		length -= 1;
-
-		switch (type) {
-			case 0: {
-				Common::UString string = readString();
-				_stack.push(string);
-				debugC(kDebugActionScript, 1, "actionPush \"%s\"", string.c_str());
-				length -= string.size() + 1;
-				break;
-			}
-			case 1: {
-				float floatValue = _script->readIEEEFloatLE();
-				_stack.push(floatValue);
-				debugC(kDebugActionScript, 1, "actionPush %f", floatValue);
-				length -= 4;
-				break;
-			}
-			case 2: {
-				// null
-				debugC(kDebugActionScript, 1, "actionPush null");
-				_stack.push(Variable::Null());
-				break;
-			}
-			case 3: {
-				// undefined
-				debugC(kDebugActionScript, 1, "actionPush undefined");
-				_stack.push(Variable());
+void ASBuffer::actionPush(AVM &avm, const Instruction &instruction) {
+	for (std::vector<PushValue>::const_iterator v = instruction.values.begin(); v != instruction.values.end(); ++v) {
+		switch (v->source) {
+			case PushValue::kSourceRegister:
+				debugC(kDebugActionScript, 1, "actionPush register%d", v->index);
+				_stack.push(avm.getRegister(v->index));
 				break;
-			}
-			case 4: {
-				byte registerNumber = _script->readByte();
-				debugC(kDebugActionScript, 1, "actionPush register%d", registerNumber);
-				_stack.push(avm.getRegister(registerNumber));
-				length -= 1;
-				break;
-			}
-			case 5: {
-				bool boolValue = (_script->readByte() != 0);
-				debugC(kDebugActionScript, 1, "actionPush %s", boolValue ? "true" : "false");
-				_stack.push(boolValue);
-				length -= 1;
-				break;
-			}
-			case 6: {
-				// Double values are weird encoded.
-				uint32 value[2];
-				value[1] = _script->readUint32LE();
-				value[0] = _script->readUint32LE();
 
-				double doubleValue;
-				memcpy(&doubleValue, value, 8);
+			case PushValue::kSourceConstant:
+				if (v->index >= _constants.size())
+					throw Common::Exception("Invalid constant pool index %u", v->index);
 
-				_stack.push(doubleValue);
-				debugC(kDebugActionScript, 1, "actionPush %f", doubleValue);
-				length -= 8;
-				break;
-			}
-			case 7: {
-				int intValue = _script->readSint32LE();
-				_stack.push(intValue);
-				debugC(kDebugActionScript, 1, "actionPush %d", intValue);
-				length -= 4;
-				break;
-			}
-				// constant pool index 8bit
-			case 8: {
-				byte byteValue = _script->readByte();
-				_stack.push(_constants[byteValue]);
-				debugC(kDebugActionScript, 1, "actionPush \"%s\"", _constants[byteValue].c_str());
-				length -= 1;
+				debugC(kDebugActionScript, 1, "actionPush \"%s\"", _constants[v->index].c_str());
+				_stack.push(_constants[v->index]);
 				break;
-			}
-				// constant pool index 16bit
-			case 9: {
-				unsigned short shortValue = _script->readUint16LE();
-				_stack.push(_constants[shortValue]);
-				debugC(kDebugActionScript, 1, "actionPush \"%s\"", _constants[shortValue].c_str());
-				length -= 2;
-				break;
-			}
+
 			default:
-				throw Common::Exception("invalid type byte in actionscript");
+				debugC(kDebugActionScript, 1, "actionPush");
+				_stack.push(v->value);
+				break;
 		}
 	}
 }
 
-void ASBuffer::actionJump() {
-	int16 offset = _script->readSint16LE();
+void ASBuffer::actionJump(const Instruction &instruction, size_t &next) {
+	if (instruction.branchTarget == kInvalidBranch)
+		throw Common::Exception("Invalid tag");
 
-	_script->seek(offset, Common::SeekableReadStream::kOriginCurrent);
-	_seeked = offset;
+	next = instruction.branchTarget;
 
-	debugC(kDebugActionScript, 1, "actionJump %d", offset);
+	debugC(kDebugActionScript, 1, "actionJump %d", instruction.branchOffset);
 }
 
-void ASBuffer::actionGetURL2(AVM &avm) {
-	Common::BitStream8MSB bitstream(_script);
-
-	byte sendVarsMethodId = bitstream.getBits(2);
+void ASBuffer::actionGetURL2(AVM &avm, const Instruction &instruction) {
+	const byte flags = instruction.byteOperand;
 
-	byte reserved = bitstream.getBits(4);
-	assert(reserved == 0);
+	const byte sendVarsMethodId  = flags >> 6;
+	const byte loadTargetFlag    = (flags >> 1) & 1;
+	const byte loadVariablesFlag = flags & 1;
 
-	byte loadTargetFlag = bitstream.getBit();
-	byte loadVariablesFlag = bitstream.getBit();
+	assert((flags & 0x3C) == 0);
 
 	Common::UString sendVarsMethod;
 	switch (sendVarsMethodId) {
@@ -822,48 +1011,38 @@ void ASBuffer::actionGetURL2(AVM &avm) {
 	);
 }
 
-void ASBuffer::actionDefineFunction() {
-	Common::UString functionName = readString();
-
-	uint16 numParams = _script->readUint16LE();
-	for (int i = 0; i < numParams; ++i) {
-		Common::UString param = readString();
-	}
-
-	uint16 codeSize = _script->readUint16LE();
-	_stack.push(ObjectPtr(new ScriptedFunction(_script->readStream(codeSize), _constants, std::vector<uint8>(), 0, false, false, false, false)));
-
-	_seeked = codeSize;
+void ASBuffer::actionDefineFunction(const Instruction &instruction) {
+	_stack.push(ObjectPtr(new ScriptedFunction(instruction.body, _constants, std::vector<uint8>(), 0, false, false, false, false)));
 
 	debugC(
 			kDebugActionScript,
 			1,
 			"actionDefineFunction %s",
-			functionName.c_str()
+			instruction.functionName.c_str()
 	);
 }
 
-void ASBuffer::actionIf() {
-	short branchOffset = _script->readSint16LE();
-
+void ASBuffer::actionIf(const Instruction &instruction, size_t &next) {
 	Variable variable = _stack.top();
 	_stack.pop();
 
 	if (variable.asBoolean()) {
-		_script->seek(branchOffset, Common::SeekableReadStream::kOriginCurrent);
-		_seeked = branchOffset;
+		if (instruction.branchTarget == kInvalidBranch)
+			throw Common::Exception("Invalid tag");
+
+		next = instruction.branchTarget;
 	}
 
-	debugC(kDebugActionScript, 1, "actionIf %i", branchOffset);
+	debugC(kDebugActionScript, 1, "actionIf %i", instruction.branchOffset);
 }
 
-Common::UString ASBuffer::readString() {
+Common::UString ASBuffer::readString(Common::SeekableReadStream &script) {
 	Common::UString string;
 
-	uint32 character = _script->readChar();
+	uint32 character = script.readByte();
 	while (character != 0) {
 		string += character;
-		character = _script->readChar();
+		character = script.readByte();
 	}
 	return string;
 }
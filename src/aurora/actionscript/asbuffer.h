@@ -26,8 +26,10 @@
 #define AURORA_ACTIONSCRIPT_ASBUFFER_H
 
 #include <stack>
+#include <vector>
 
 #include <boost/any.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include "src/common/readstream.h"
 #include "src/common/scopedptr.h"
@@ -41,9 +43,25 @@ namespace ActionScript {
 
 class Variable;
 
+/** Buffer for handling actionscript byte code.
+ *
+ *  The byte code is decoded into a list of instructions on the first run,
+ *  so that repeated runs (frame scripts, class methods) only need to
+ *  dispatch the already decoded operands.
+ */
 class ASBuffer {
 public:
+	struct Instruction;
+
+	/** A decoded block of byte code. */
+	typedef std::vector<Instruction> Code;
+	/** Decoded byte code, shared between all functions defined by it. */
+	typedef boost::shared_ptr<const Code> CodePtr;
+
+	/** Create a buffer over raw byte code. The stream is not taken over. */
 	ASBuffer(Common::SeekableReadStream *as);
+	/** Create a buffer over already decoded byte code. */
+	ASBuffer(CodePtr code);
 
 	void run(AVM &avm);
 
@@ -52,6 +70,15 @@ public:
 private:
 	void execute(AVM &avm);
 
+	static CodePtr decode(Common::SeekableReadStream &script, size_t end);
+	static void decodeInstruction(Common::SeekableReadStream &script, size_t end, Instruction &instruction);
+	static void decodePush(Common::SeekableReadStream &script, size_t length, Instruction &instruction);
+	/** Decode a function definition, returning the size of the function body following the tag. */
+	static size_t decodeDefineFunction(Common::SeekableReadStream &script, size_t end, Instruction &instruction);
+	/** Decode a function definition, returning the size of the function body following the tag. */
+	static size_t decodeDefineFunction2(Common::SeekableReadStream &script, size_t end, Instruction &instruction);
+	static void resolveBranches(Code &code, size_t size);
+
 	void actionStop(AVM &avm);
 	void actionToggleQuality();
 	void actionSubtract();
@@ -83,29 +110,29 @@ private:
 	void actionGreater();
 	void actionExtends();
 	void actionGetURL(AVM &avm);
-	void actionStoreRegister(AVM &avm);
-	void actionConstantPool();
-	void actionDefineFunction2();
-	void actionPush(AVM &avm);
-	void actionJump();
-	void actionGetURL2(AVM &avm);
-	void actionDefineFunction();
-	void actionIf();
+	void actionStoreRegister(AVM &avm, const Instruction &instruction);
+	void actionConstantPool(const Instruction &instruction);
+	void actionDefineFunction2(const Instruction &instruction);
+	void actionPush(AVM &avm, const Instruction &instruction);
+	void actionJump(const Instruction &instruction, size_t &next);
+	void actionGetURL2(AVM &avm, const Instruction &instruction);
+	void actionDefineFunction(const Instruction &instruction);
+	void actionIf(const Instruction &instruction, size_t &next);
 
 	// Utility methods and variables
-	Common::UString readString();
-
-	size_t _currentLength;
-	ptrdiff_t _seeked;
+	static Common::UString readString(Common::SeekableReadStream &script);
 
 	// Constant pool
 	std::vector<Common::UString> _constants;
 
 	// Execution stack
-	std::stack<Variable> _stack;
+	std::stack<Variable, std::vector<Variable> > _stack;
 
-	// The script data
+	// The script data, until it has been decoded
 	Common::SeekableReadStream *_script;
+
+	// The decoded script
+	CodePtr _code;
 };
 
 } // End of namespace ActionScript
@@ -46,7 +46,8 @@ AVM::AVM() : _handler(0) {
 		_registers[i].push(Variable());
 
 	_variables["_global"] = ObjectPtr(new Object());
-	_variables["_root"] = ObjectPtr(new Object());
+	MovieClipPtr root(new MovieClip());
+	_variables["_root"] = ObjectPtr(root);
 	_variables["Object"] = ObjectPtr(new DummyFunction());
 	_variables["Object"].asObject()->setMember("registerClass", new NativeFunction(std::bind(&AVM::registerClass, this, std::placeholders::_1), false, false, false, false));
 	_variables["Object"].asObject()->setMember("prototype", ObjectPtr(new Object()));
@@ -60,6 +61,7 @@ AVM::AVM() : _handler(0) {
 	_variables["TextField"].asObject()->setMember("prototype", ObjectPtr(new TextField()));
 
 	_stage = new Stage();
+	_stage->setRoot(root);
 	_variables["Stage"] = ObjectPtr(_stage);
 
 
@@ -80,6 +82,10 @@ void AVM::setStageSize(unsigned int width, unsigned int height) {
 	_stage->setSize(width, height);
 }
 
+Stage &AVM::getStage() {
+	return *_stage;
+}
+
 void AVM::setRegisterClassFunction(RegisterClassFunction registerClass) {
 	_registerClass = registerClass;
 }
@@ -26,6 +26,7 @@
 #define AURORA_ACTIONSCRIPT_AVM_H
 
 #include <stack>
+#include <map>
 
 #include <functional>
 
@@ -86,6 +87,8 @@ public:
 
 	/** Set the stage size. */
 	void setStageSize(unsigned int width, unsigned int height);
+	/** Get the stage, holding the display list. */
+	Stage &getStage();
 
 	/** Set a callback for the Object.registerClass() function. */
 	void setRegisterClassFunction(RegisterClassFunction);
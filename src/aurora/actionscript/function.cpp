@@ -62,19 +62,15 @@ bool Function::getPreloadGlobalFlag() {
 	return _preloadGlobalFlag;
 }
 
-ScriptedFunction::ScriptedFunction(Common::SeekableReadStream *as, std::vector<Common::UString> constants,
+ScriptedFunction::ScriptedFunction(ASBuffer::CodePtr code, std::vector<Common::UString> constants,
                                    std::vector<uint8> parameterIds, uint8 numRegisters,
                                    bool preloadThisFlag, bool preloadSuperFlag, bool preloadRootFlag,
                                    bool preloadGlobalFlag) :
 	Function(parameterIds, numRegisters, preloadThisFlag, preloadSuperFlag, preloadRootFlag, preloadGlobalFlag),
-	_stream(as), _buffer(as) {
+	_buffer(code) {
 	_buffer.setConstantPool(constants);
 }
 
-ScriptedFunction::~ScriptedFunction() {
-	delete _stream;
-}
-
 Variable ScriptedFunction::operator()(AVM &avm) {
 	_buffer.run(avm);
 	return avm.getReturnValue();
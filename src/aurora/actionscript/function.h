@@ -76,7 +76,7 @@ private:
 class ScriptedFunction : public Function {
 public:
 	ScriptedFunction(
-			Common::SeekableReadStream *as,
+			ASBuffer::CodePtr code,
 			std::vector<Common::UString> constantPool,
 			std::vector<uint8> parameterIds,
 			uint8 numRegisters,
@@ -85,12 +85,10 @@ public:
 			bool preloadRootFlag,
 			bool preloadGlobalFlag
 	);
-	~ScriptedFunction();
 
 	Variable operator()(AVM &avm);
 
 private:
-	Common::SeekableReadStream *_stream;
 	ASBuffer _buffer;
 };
 
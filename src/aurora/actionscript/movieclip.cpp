@@ -22,14 +22,266 @@
  *  MovieClip implementation for actionscript.
  */
 
+#include "src/common/error.h"
+
 #include "src/aurora/actionscript/movieclip.h"
 
 namespace Aurora {
 
 namespace ActionScript {
 
-MovieClip::MovieClip() {
+MovieClip::MovieClip() : _parent(0), _characterId(0), _x(0.0f), _y(0.0f),
+	_xScale(100.0f), _yScale(100.0f), _rotation(0.0f), _alpha(100.0f), _visible(true),
+	_dirty(kDirtyAll) {
+
+}
+
+MovieClip::~MovieClip() {
+	for (DisplayList::iterator c = _children.begin(); c != _children.end(); ++c)
+		c->second->_parent = 0;
+}
+
+bool MovieClip::hasMember(const Common::UString &id) const {
+	if (id == "_x" || id == "_y" || id == "_xscale" || id == "_yscale" ||
+	    id == "_rotation" || id == "_alpha" || id == "_visible")
+		return true;
+
+	return Object::hasMember(id);
+}
+
+Variable MovieClip::getMember(const Variable &id) {
+	if (id.isString()) {
+		const Common::UString name = id.asString();
+
+		if (name == "_x")
+			return _x;
+		if (name == "_y")
+			return _y;
+		if (name == "_xscale")
+			return _xScale;
+		if (name == "_yscale")
+			return _yScale;
+		if (name == "_rotation")
+			return _rotation;
+		if (name == "_alpha")
+			return _alpha;
+		if (name == "_visible")
+			return _visible;
+	}
+
+	return Object::getMember(id);
+}
+
+void MovieClip::setMember(const Variable &id, const Variable &value) {
+	if (id.isString()) {
+		const Common::UString name = id.asString();
+
+		if (name == "_x") {
+			setPosition(value.asNumber(), _y);
+			return;
+		}
+		if (name == "_y") {
+			setPosition(_x, value.asNumber());
+			return;
+		}
+		if (name == "_xscale") {
+			setScale(value.asNumber(), _yScale);
+			return;
+		}
+		if (name == "_yscale") {
+			setScale(_xScale, value.asNumber());
+			return;
+		}
+		if (name == "_rotation") {
+			setRotation(value.asNumber());
+			return;
+		}
+		if (name == "_alpha") {
+			setAlpha(value.asNumber());
+			return;
+		}
+		if (name == "_visible") {
+			setVisible(value.asBoolean());
+			return;
+		}
+	}
+
+	Object::setMember(id, value);
+}
+
+void MovieClip::placeChild(uint16 depth, MovieClipPtr clip) {
+	if (!clip)
+		throw Common::Exception("MovieClip::placeChild(): No clip");
+	if (clip->_parent)
+		throw Common::Exception("MovieClip::placeChild(): Clip is already placed");
+
+	MovieClipPtr &slot = _children[depth];
+	if (slot)
+		slot->_parent = 0;
+
+	slot = clip;
+	clip->_parent = this;
+
+	clip->markAllDirty();
+	markDirty(kDirtyDisplayList | kDirtyChildren);
+}
+
+void MovieClip::removeChild(uint16 depth) {
+	DisplayList::iterator c = _children.find(depth);
+	if (c == _children.end())
+		return;
+
+	c->second->_parent = 0;
+	_children.erase(c);
+
+	markDirty(kDirtyDisplayList);
+}
+
+MovieClipPtr MovieClip::getChild(uint16 depth) const {
+	DisplayList::const_iterator c = _children.find(depth);
+	if (c == _children.end())
+		return MovieClipPtr();
+
+	return c->second;
+}
+
+size_t MovieClip::getChildCount() const {
+	return _children.size();
+}
+
+MovieClip *MovieClip::getParent() const {
+	return _parent;
+}
+
+uint16 MovieClip::getCharacterId() const {
+	return _characterId;
+}
+
+void MovieClip::setCharacterId(uint16 characterId) {
+	if (_characterId == characterId)
+		return;
+
+	_characterId = characterId;
+	markDirty(kDirtyContent);
+}
+
+float MovieClip::getX() const {
+	return _x;
+}
+
+float MovieClip::getY() const {
+	return _y;
+}
+
+void MovieClip::setPosition(float x, float y) {
+	if ((_x == x) && (_y == y))
+		return;
+
+	_x = x;
+	_y = y;
+	markDirty(kDirtyTransform);
+}
+
+float MovieClip::getXScale() const {
+	return _xScale;
+}
+
+float MovieClip::getYScale() const {
+	return _yScale;
+}
+
+void MovieClip::setScale(float xScale, float yScale) {
+	if ((_xScale == xScale) && (_yScale == yScale))
+		return;
+
+	_xScale = xScale;
+	_yScale = yScale;
+	markDirty(kDirtyTransform);
+}
+
+float MovieClip::getRotation() const {
+	return _rotation;
+}
+
+void MovieClip::setRotation(float rotation) {
+	if (_rotation == rotation)
+		return;
+
+	_rotation = rotation;
+	markDirty(kDirtyTransform);
+}
+
+float MovieClip::getAlpha() const {
+	return _alpha;
+}
+
+void MovieClip::setAlpha(float alpha) {
+	if (_alpha == alpha)
+		return;
+
+	_alpha = alpha;
+	markDirty(kDirtyAppearance);
+}
+
+bool MovieClip::isVisible() const {
+	return _visible;
+}
+
+void MovieClip::setVisible(bool visible) {
+	if (_visible == visible)
+		return;
+
+	_visible = visible;
+	markDirty(kDirtyAppearance);
+}
+
+uint32 MovieClip::getDirtyFlags() const {
+	return _dirty;
+}
+
+void MovieClip::markDirty(uint32 flags) {
+	_dirty |= flags;
+
+	// Every parent already flagged means every grandparent is flagged as well
+	for (MovieClip *parent = _parent; parent && !(parent->_dirty & kDirtyChildren); parent = parent->_parent)
+		parent->_dirty |= kDirtyChildren;
+}
+
+void MovieClip::markAllDirty() {
+	_dirty |= kDirtyAll;
+	if (!_children.empty())
+		_dirty |= kDirtyChildren;
+
+	for (DisplayList::iterator c = _children.begin(); c != _children.end(); ++c)
+		c->second->markAllDirty();
+}
+
+size_t MovieClip::update(const RedrawFunction &redraw) {
+	size_t count = 0;
+
+	const uint32 dirty = _dirty & kDirtyAll;
+	if (dirty != kDirtyNone) {
+		if (redraw)
+			redraw(*this, dirty);
+
+		count++;
+	}
+
+	// Changes inside of an invisible clip stay pending until it's visible again
+	if (!_visible) {
+		_dirty &= kDirtyChildren;
+		return count;
+	}
+
+	const bool childrenDirty = (_dirty & kDirtyChildren) != 0;
+	_dirty = kDirtyNone;
+
+	if (childrenDirty)
+		for (DisplayList::iterator c = _children.begin(); c != _children.end(); ++c)
+			if (c->second->_dirty != kDirtyNone)
+				count += c->second->update(redraw);
 
+	return count;
 }
 
 } // End of namespace ActionScript
@@ -25,15 +25,122 @@
 #ifndef AURORA_ACTIONSCRIPT_MOVIECLIP_H
 #define AURORA_ACTIONSCRIPT_MOVIECLIP_H
 
+#include <map>
+#include <functional>
+
+#include "src/common/types.h"
+
 #include "src/aurora/actionscript/object.h"
 
 namespace Aurora {
 
 namespace ActionScript {
 
+class MovieClip;
+
+typedef boost::shared_ptr<MovieClip> MovieClipPtr;
+
+/** A movie clip, a node in the retained display list of a stage.
+ *
+ *  Every change to a clip's display properties or display list marks the
+ *  clip as dirty. Updating the display list then only visits subtrees that
+ *  contain dirty clips and only redraws the clips that actually changed.
+ */
 class MovieClip : public Object {
 public:
+	/** What changed about a movie clip since the last update. */
+	enum DirtyFlags {
+		kDirtyNone        = 0,
+		kDirtyTransform   = 1 << 0, ///< Position, scale or rotation changed.
+		kDirtyAppearance  = 1 << 1, ///< Visibility or alpha changed.
+		kDirtyContent     = 1 << 2, ///< The displayed character changed.
+		kDirtyDisplayList = 1 << 3, ///< Clips were placed into or removed from this clip.
+		kDirtyChildren    = 1 << 4, ///< A clip further down the display list changed.
+
+		kDirtyAll         = kDirtyTransform | kDirtyAppearance | kDirtyContent | kDirtyDisplayList
+	};
+
+	/** Callback for redrawing a changed movie clip, with its DirtyFlags. */
+	typedef std::function<void (MovieClip &clip, uint32 dirty)> RedrawFunction;
+
 	MovieClip();
+	~MovieClip();
+
+	bool hasMember(const Common::UString &id) const override;
+
+	Variable getMember(const Variable &id) override;
+	void setMember(const Variable &id, const Variable &value) override;
+	using Object::setMember;
+
+	// .--- Display list
+	/** Place a clip at a depth, replacing the clip that was there. */
+	void placeChild(uint16 depth, MovieClipPtr clip);
+	/** Remove the clip at a depth. */
+	void removeChild(uint16 depth);
+	/** Return the clip at a depth, or an empty pointer if there is none. */
+	MovieClipPtr getChild(uint16 depth) const;
+	/** Return the number of clips directly below this one. */
+	size_t getChildCount() const;
+	/** Return the clip this clip was placed in, or 0. */
+	MovieClip *getParent() const;
+	// '---
+
+	// .--- Display properties
+	uint16 getCharacterId() const;
+	void setCharacterId(uint16 characterId);
+
+	float getX() const;
+	float getY() const;
+	void setPosition(float x, float y);
+
+	float getXScale() const;
+	float getYScale() const;
+	void setScale(float xScale, float yScale);
+
+	float getRotation() const;
+	void setRotation(float rotation);
+
+	float getAlpha() const;
+	void setAlpha(float alpha);
+
+	bool isVisible() const;
+	void setVisible(bool visible);
+	// '---
+
+	// .--- Dirty tracking
+	/** Return the DirtyFlags accumulated since the last update. */
+	uint32 getDirtyFlags() const;
+	/** Mark the clip as changed, and its parents as having changed children. */
+	void markDirty(uint32 flags);
+
+	/** Redraw all changed clips in this part of the display list.
+	 *
+	 *  Clips inside of invisible clips keep their flags until they become visible.
+	 *
+	 *  @param  redraw Called for every clip that changed, parents before children.
+	 *  @return The number of redrawn clips.
+	 */
+	size_t update(const RedrawFunction &redraw);
+	// '---
+
+private:
+	typedef std::map<uint16, MovieClipPtr> DisplayList;
+
+	DisplayList _children;
+	MovieClip *_parent;
+
+	uint16 _characterId;
+
+	float _x, _y;
+	float _xScale, _yScale;
+	float _rotation;
+	float _alpha;
+	bool _visible;
+
+	uint32 _dirty;
+
+	/** Mark this clip and all clips below it as completely changed. */
+	void markAllDirty();
 };
 
 } // End of namespace ActionScript
@@ -22,6 +22,8 @@
  *  Abstract object which is inherited by every other class.
  */
 
+#include <algorithm>
+
 #include <boost/weak_ptr.hpp>
 
 #include "src/common/error.h"
@@ -44,16 +46,23 @@ Object::Object(Object *object) {
 Object::~Object() {
 }
 
+static const Common::UString kConstructor("constructor");
+
 std::vector<Common::UString> Object::getSlots() const {
 	std::vector<Common::UString> slots;
-	for (std::map<Common::UString, Variable>::const_iterator iter = _members.begin(); iter != _members.end() ; iter++) {
+	slots.reserve(_members.size());
+
+	for (MemberMap::const_iterator iter = _members.begin(); iter != _members.end() ; iter++) {
 		slots.push_back(iter->first);
 	}
+
+	// Keep the enumeration order independent of the hashing
+	std::sort(slots.begin(), slots.end());
 	return slots;
 }
 
 bool Object::hasMember(const Common::UString &id) const {
-	std::map<Common::UString, Variable>::const_iterator iter = _members.find("constructor");
+	MemberMap::const_iterator iter = _members.find(kConstructor);
 	if (iter != _members.end())
 		if (iter->second.asObject()->hasMember(id))
 			return true;
@@ -66,15 +75,15 @@ Variable Object::getMember(const Variable &id) {
 
 	const Common::UString idString = id.asString();
 
-	std::map<Common::UString, Variable>::iterator iter = _members.find("constructor");
-	if (hasMember(idString) && iter != _members.end() && iter->second.asObject()->hasMember(idString))
+	MemberMap::iterator iter = _members.find(kConstructor);
+	if (iter != _members.end() && iter->second.asObject()->hasMember(idString))
 		return iter->second.asObject()->getMember(id);
-	else if (_members.find(idString) != _members.end())
-		return _members[idString];
-	else {
-		_members.insert(std::make_pair(idString, ObjectPtr(new Object)));
-		return _members[idString];
-	}
+
+	iter = _members.find(idString);
+	if (iter != _members.end())
+		return iter->second;
+
+	return _members.insert(std::make_pair(idString, Variable(ObjectPtr(new Object)))).first->second;
 }
 
 void Object::setMember(const Variable &id, const Variable &value) {
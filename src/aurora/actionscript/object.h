@@ -25,7 +25,7 @@
 #ifndef AURORA_ACTIONSCRIPT_OBJECT_H
 #define AURORA_ACTIONSCRIPT_OBJECT_H
 
-#include <map>
+#include <unordered_map>
 
 #include <boost/shared_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
@@ -61,7 +61,10 @@ public:
 	Variable call(const Common::UString &function, AVM &avm, const std::vector<Variable> &arguments = std::vector<Variable>());
 
 private:
-	std::map<Common::UString, Variable> _members;
+	typedef std::unordered_map<Common::UString, Variable,
+	                           Common::hashUStringCaseSensitive, Common::equalsUStringSensitive> MemberMap;
+
+	MemberMap _members;
 };
 
 } // End of namespace ActionScript
@@ -24,7 +24,8 @@
 
 #include "src/aurora/actionscript/stage.h"
 
-Aurora::ActionScript::Stage::Stage() : _width(0), _height(0) {
+Aurora::ActionScript::Stage::Stage() : _width(0), _height(0),
+	_lastRedrawCount(0), _totalRedrawCount(0), _updateCount(0) {
 }
 
 bool Aurora::ActionScript::Stage::hasMember(const Common::UString &id) const {
@@ -47,3 +48,34 @@ void Aurora::ActionScript::Stage::setSize(unsigned int width, unsigned int heigh
 	_width = width;
 	_height = height;
 }
+
+void Aurora::ActionScript::Stage::setRoot(MovieClipPtr root) {
+	_root = root;
+}
+
+Aurora::ActionScript::MovieClipPtr Aurora::ActionScript::Stage::getRoot() const {
+	return _root;
+}
+
+size_t Aurora::ActionScript::Stage::updateDisplayList(const MovieClip::RedrawFunction &redraw) {
+	_lastRedrawCount = 0;
+	if (_root && (_root->getDirtyFlags() != MovieClip::kDirtyNone))
+		_lastRedrawCount = _root->update(redraw);
+
+	_totalRedrawCount += _lastRedrawCount;
+	_updateCount++;
+
+	return _lastRedrawCount;
+}
+
+size_t Aurora::ActionScript::Stage::getLastRedrawCount() const {
+	return _lastRedrawCount;
+}
+
+uint64 Aurora::ActionScript::Stage::getTotalRedrawCount() const {
+	return _totalRedrawCount;
+}
+
+uint64 Aurora::ActionScript::Stage::getUpdateCount() const {
+	return _updateCount;
+}
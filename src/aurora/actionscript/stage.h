@@ -26,6 +26,7 @@
 #define AURORA_ACTIONSCRIPT_STAGE_H
 
 #include "src/aurora/actionscript/object.h"
+#include "src/aurora/actionscript/movieclip.h"
 
 namespace Aurora {
 
@@ -41,8 +42,34 @@ public:
 
 	void setSize(unsigned int width, unsigned int height);
 
+	/** Set the root of the display list. */
+	void setRoot(MovieClipPtr root);
+	/** Return the root of the display list. */
+	MovieClipPtr getRoot() const;
+
+	/** Redraw all clips in the display list that changed since the last update.
+	 *
+	 *  To be called once per frame.
+	 *
+	 *  @return The number of redrawn clips.
+	 */
+	size_t updateDisplayList(const MovieClip::RedrawFunction &redraw);
+
+	/** Return the number of clips redrawn in the last update. */
+	size_t getLastRedrawCount() const;
+	/** Return the number of clips redrawn in all updates so far. */
+	uint64 getTotalRedrawCount() const;
+	/** Return the number of updates so far. */
+	uint64 getUpdateCount() const;
+
 private:
 	unsigned int _width, _height;
+
+	MovieClipPtr _root;
+
+	size_t _lastRedrawCount;
+	uint64 _totalRedrawCount;
+	uint64 _updateCount;
 };
 
 } // End of namespace ActionScript
@@ -717,6 +717,16 @@ Common::SeekableReadStream *ERFFile::getResource(uint32 index, bool tryNoCopy) c
 
 	_erf->seek(res.offset);
 
+	if ((_header.encryption != kEncryptionNone) && (_header.compression != kCompressionNone)) {
+		/* Decrypt the data while decompressing it. The data is read and decrypted
+		 * frame by frame, directly within the input buffer of the decompressor. */
+
+		Common::SubReadStream packedStream(_erf.get(), res.packedSize);
+		Common::ScopedPtr<Common::ReadStream> stream(createDecryptStream(packedStream, _header.encryption, _password));
+
+		return decompress(*stream, res.packedSize, res.unpackedSize);
+	}
+
 	// Read
 	Common::MemoryReadStream *stream = _erf->readStream(res.packedSize);
 
@@ -741,6 +751,19 @@ Common::MemoryReadStream *ERFFile::decrypt(Common::SeekableReadStream &cryptStre
 	}
 }
 
+Common::ReadStream *ERFFile::createDecryptStream(Common::ReadStream &cryptStream,
+                                                 Encryption encryption, const std::vector<byte> &password) {
+	switch (encryption) {
+		case kEncryptionBlowfishDAO:
+		case kEncryptionBlowfishDA2:
+		case kEncryptionBlowfishNWN:
+			return new Common::BlowfishEBCDecryptStream(&cryptStream, password);
+
+		default:
+			throw Common::Exception("Invalid ERF encryption %u", (uint) encryption);
+	}
+}
+
 Common::MemoryReadStream *ERFFile::decrypt(Common::SeekableReadStream *cryptStream,
                                            Encryption encryption, const std::vector<byte> &password) {
 
@@ -791,6 +814,41 @@ Common::SeekableReadStream *ERFFile::decompress(Common::MemoryReadStream *packed
 	throw Common::Exception("Invalid ERF compression %u", (uint) _header.compression);
 }
 
+Common::SeekableReadStream *ERFFile::decompress(Common::ReadStream &packedStream,
+                                                uint32 packedSize, uint32 unpackedSize) const {
+
+	switch (_header.compression) {
+		case kCompressionNone:
+			{
+				Common::ScopedPtr<Common::MemoryReadStream> stream(packedStream.readStream(packedSize));
+
+				return decompress(stream.release(), unpackedSize);
+			}
+
+		case kCompressionBioWareZlib:
+			{
+				if (packedSize < 1)
+					throw Common::Exception("Failed to inflate: no window size");
+
+				// An extra one byte header specifies the window size
+				const int windowBits = packedStream.readByte() >> 4;
+
+				return Common::decompressDeflate(packedStream, packedSize - 1, unpackedSize, -windowBits);
+			}
+
+		case kCompressionHeaderlessZlib:
+			return Common::decompressDeflate(packedStream, packedSize, unpackedSize, -Common::kWindowBitsMax);
+
+		case kCompressionStandardZlib:
+			return Common::decompressDeflate(packedStream, packedSize, unpackedSize, Common::kWindowBitsMax);
+
+		default:
+			break;
+	}
+
+	throw Common::Exception("Invalid ERF compression %u", (uint) _header.compression);
+}
+
 Common::SeekableReadStream *ERFFile::decompressBiowareZlib(Common::MemoryReadStream *packedStream,
                                                            uint32 unpackedSize) const {
 
@@ -279,6 +279,10 @@ private:
 	static Common::SeekableReadStream *decrypt(Common::SeekableReadStream &erf, size_t size,
 	                                           Encryption encryption, const std::vector<byte> &password);
 
+	/** Create a stream that decrypts the data of another stream while reading. */
+	static Common::ReadStream *createDecryptStream(Common::ReadStream &cryptStream,
+	                                               Encryption encryption, const std::vector<byte> &password);
+
 	static bool decryptNWNPremiumHeader(Common::SeekableReadStream &erf, ERFHeader &header,
 	                                    const std::vector<byte> &password);
 	static bool findNWNPremiumKey      (Common::SeekableReadStream &erf, ERFHeader &header,
@@ -292,6 +296,9 @@ private:
 	// .--- Compression
 	Common::SeekableReadStream *decompress(Common::MemoryReadStream *packedStream,
 	                                       uint32 unpackedSize) const;
+	/** Decompress the packed data while reading it from a stream. */
+	Common::SeekableReadStream *decompress(Common::ReadStream &packedStream,
+	                                       uint32 packedSize, uint32 unpackedSize) const;
 
 	Common::SeekableReadStream *decompressBiowareZlib   (Common::MemoryReadStream *packedStream,
 	                                                     uint32 unpackedSize) const;
@@ -24,6 +24,8 @@
 
 #include <ctime>
 
+#include "src/common/deflate.h"
+
 #include "src/aurora/erfwriter.h"
 #include "src/aurora/util.h"
 
@@ -31,8 +33,36 @@ namespace Aurora {
 
 static const uint32 kVersion10 = MKTAG('V', '1', '.', '0');
 
-ERFWriter::ERFWriter(uint32 id, uint32 fileCount, Common::SeekableWriteStream &stream, Version version, LocString description) :
-		_stream(stream), _version(version), _fileCount(fileCount) {
+/** Write the stream's data into the archive, compressed if requested.
+ *
+ *  Returns the size of the written data, and sets unpackedSize to the size of the stream.
+ */
+static size_t writeResource(Common::WriteStream &archive, Common::ReadStream &stream,
+                            ERFWriter::Compression compression, size_t &unpackedSize) {
+
+	switch (compression) {
+		case ERFWriter::kCompressionNone:
+			unpackedSize = archive.writeStream(stream);
+			return unpackedSize;
+
+		case ERFWriter::kCompressionBioWareZlib:
+			// Raw DEFLATE, with an extra byte specifying the window size
+			archive.writeByte(Common::kWindowBitsMax << 4);
+			return 1 + Common::compressDeflate(stream, archive, Common::kWindowBitsMaxRaw, unpackedSize);
+
+		case ERFWriter::kCompressionHeaderlessZlib:
+			return Common::compressDeflate(stream, archive, Common::kWindowBitsMaxRaw, unpackedSize);
+	}
+
+	throw Common::Exception("Invalid ERF compression %u", (uint) compression);
+}
+
+ERFWriter::ERFWriter(uint32 id, uint32 fileCount, Common::SeekableWriteStream &stream, Version version,
+                     LocString description, Compression compression) :
+		_stream(stream), _version(version), _compression(compression), _fileCount(fileCount) {
+
+	if ((_compression != kCompressionNone) && (_version != kERFVersion22))
+		throw Common::Exception("ERF compression is only supported by V2.2");
 
 	switch (_version) {
 		case kERFVersion10: {
@@ -113,6 +143,41 @@ ERFWriter::ERFWriter(uint32 id, uint32 fileCount, Common::SeekableWriteStream &s
 			break;
 		}
 
+		case kERFVersion22: {
+			// Write magic id and version.
+			Common::writeString(stream, "ERF V2.2", Common::kEncodingUTF16LE, false);
+
+			// Write entry count.
+			stream.writeUint32LE(_fileCount);
+
+			// Write the creation time of the file
+			std::time_t now = std::time(0);
+			std::tm *timepoint = std::localtime(&now);
+			stream.writeUint32LE(timepoint->tm_year);
+			stream.writeUint32LE(timepoint->tm_yday);
+
+			// Write unknown 0xFFFFFFFF value.
+			stream.writeUint32LE(0xFFFFFFFF);
+
+			// Write the flags, which hold the compression type. No encryption.
+			stream.writeUint32LE(static_cast<uint32>(_compression) << 29);
+
+			// Write module ID and an empty password digest.
+			stream.writeUint32LE(0);
+			stream.writeZeros(16);
+
+			// The offset to the resource table.
+			_resourceTableOffset = stream.pos();
+
+			// Write empty table of contents.
+			stream.writeZeros(76 * _fileCount);
+
+			// The offset to the resource data.
+			_offsetToResourceData = stream.pos();
+
+			break;
+		}
+
 		default:
 			throw Common::Exception("Unsupported ERF version");
 	}
@@ -177,6 +242,28 @@ void ERFWriter::add(const Common::UString &resRef, FileType resType, Common::Rea
 
 			break;
 		}
+
+		case kERFVersion22: {
+			// Write the resource data
+			_stream.seek(_offsetToResourceData);
+
+			size_t unpackedSize = 0;
+			const size_t packedSize = writeResource(_stream, stream, _compression, unpackedSize);
+
+			// Write the resource table entry.
+			_stream.seek(_resourceTableOffset + _currentFileCount * 76);
+
+			Common::writeStringFixed(_stream, TypeMan.addFileType(resRef, resType), Common::kEncodingUTF16LE, 64);
+			_stream.writeUint32LE(_offsetToResourceData);
+			_stream.writeUint32LE(packedSize);
+			_stream.writeUint32LE(unpackedSize);
+
+			// Advance offset and file count.
+			_offsetToResourceData += packedSize;
+			_currentFileCount += 1;
+
+			break;
+		}
 	}
 }
 
@@ -36,7 +36,15 @@ class ERFWriter {
 public:
 	enum Version {
 		kERFVersion10,
-		kERFVersion20
+		kERFVersion20,
+		kERFVersion22
+	};
+
+	/** How the resources are compressed. Only supported by V2.2. */
+	enum Compression {
+		kCompressionNone           = 0, ///< No compression at all.
+		kCompressionBioWareZlib    = 1, ///< Compression using DEFLATE with an extra header byte.
+		kCompressionHeaderlessZlib = 7  ///< Compression using DEFLATE with default parameters.
 	};
 
 	/** Create an ERF writer by writing the header to the stream and reserve fileCount
@@ -47,18 +55,25 @@ public:
 	 *  @param stream The write stream in which the archive should be written.
 	 *  @param version The ERF version to write
 	 *  @param description The LocString, that should be used for the description.
+	 *  @param compression The compression to use for all resources.
 	 */
 	ERFWriter(uint32 id, uint32 fileCount, Common::SeekableWriteStream &stream,
-	          Version version = kERFVersion10, LocString description = LocString());
+	          Version version = kERFVersion10, LocString description = LocString(),
+	          Compression compression = kCompressionNone);
 	~ERFWriter() = default;
 
-	/** Add a new stream to this archive to be packed. */
+	/** Add a new stream to this archive to be packed.
+	 *
+	 *  The stream is read until its end and copied, or compressed, directly
+	 *  into the archive stream.
+	 */
 	void add(const Common::UString &resRef, FileType resType, Common::ReadStream &stream);
 
 private:
 	Common::SeekableWriteStream &_stream;
 
 	const Version _version;
+	const Compression _compression;
 
 	uint32 _currentFileCount { 0 };
 	uint32 _fileCount { 0 };
@@ -29,12 +29,14 @@
 #include <cassert>
 
 #include "src/common/error.h"
+#include "src/common/scopedptr.h"
 #include "src/common/readstream.h"
 #include "src/common/hash.h"
 #include "src/common/strutil.h"
 
 #include "src/aurora/gdafile.h"
 #include "src/aurora/gff4file.h"
+#include "src/aurora/gdaheaders.h"
 
 static const uint32 kG2DAID    = MKTAG('G', '2', 'D', 'A');
 static const uint32 kVersion01 = MKTAG('V', '0', '.', '1');
@@ -71,48 +73,18 @@ bool GDAFile::hasRow(size_t row) const {
 }
 
 const GFF4Struct *GDAFile::getRow(size_t row) const {
-	assert(_rowStarts.size() == _rows.size());
-
-	/* To find the correct GFF4 for this row, we go through
-	 * the list of row start indices in reverse, until we
-	 * found one that's not bigger than the row we want.
-	 */
-
-	for (ptrdiff_t i = _rowStarts.size() - 1; i >= 0; i--) {
-		if (_rowStarts[i] <= row) {
-			row -= _rowStarts[i];
-
-			if (row >= _rows[i]->size())
-				return 0;
-
-			return (*_rows[i])[row];
-		}
-	}
+	if (row >= _rowStructs.size())
+		return 0;
 
-	return 0;
+	return _rowStructs[row];
 }
 
 size_t GDAFile::findRow(uint32 id) const {
-	size_t idColumn = findColumn("ID");
-	if (idColumn == kInvalidColumn)
+	RowIDMap::const_iterator r = _rowIDs.find(id);
+	if (r == _rowIDs.end())
 		return kInvalidRow;
 
-	// Go through all rows of all GFF4s, and look for the ID
-
-	size_t gff4 = 0;
-	for (size_t i = 0, j = 0; i < _rowCount; i++, j++) {
-		if (j >= _rows[gff4]->size()) {
-			if (++gff4 >= _rows.size())
-				break;
-
-			j = 0;
-		}
-
-		if ((*_rows[gff4])[j] && ((*_rows[gff4])[j]->getUint(idColumn) == id))
-			return i;
-	}
-
-	return kInvalidRow;
+	return r->second;
 }
 
 size_t GDAFile::findColumn(const Common::UString &name) const {
@@ -120,7 +92,7 @@ size_t GDAFile::findColumn(const Common::UString &name) const {
 	if (c != _columnNameMap.end())
 		return c->second;
 
-	size_t column = findColumn(Common::hashStringCRC32(name.toLower(), Common::kEncodingUTF16LE));
+	size_t column = findColumn((uint32) Common::hashStringLower(name, Common::kHashCRC32, Common::kEncodingUTF16LE));
 	_columnNameMap[name] = column;
 
 	return column;
@@ -128,93 +100,165 @@ size_t GDAFile::findColumn(const Common::UString &name) const {
 
 size_t GDAFile::findColumn(uint32 hash) const {
 	ColumnHashMap::const_iterator c = _columnHashMap.find(hash);
-	if (c != _columnHashMap.end())
-		return c->second;
+	if (c == _columnHashMap.end())
+		return kInvalidColumn;
 
-	for (size_t i = 0; i < _columns->size(); i++) {
-		if (!(*_columns)[i])
-			continue;
+	return kGFF4G2DAColumn1 + c->second;
+}
 
-		if ((*_columns)[i]->getUint(kGFF4G2DAColumnHash) == hash) {
-			_columnHashMap[hash] = kGFF4G2DAColumn1 + i;
+GDAFile::ColumnHandle GDAFile::getColumn(const Common::UString &name) const {
+	const size_t column = findColumn(name);
+	if (column == kInvalidColumn)
+		return ColumnHandle();
 
-			return kGFF4G2DAColumn1 + i;
-		}
-	}
+	return ColumnHandle(column - kGFF4G2DAColumn1);
+}
+
+GDAFile::ColumnHandle GDAFile::getColumn(uint32 hash) const {
+	ColumnHashMap::const_iterator c = _columnHashMap.find(hash);
+	if (c == _columnHashMap.end())
+		return ColumnHandle();
 
-	_columnHashMap[hash] = kInvalidColumn;
-	return kInvalidColumn;
+	return ColumnHandle(c->second);
 }
 
-const GFF4Struct *GDAFile::getRowColumn(size_t row, uint32 hash, size_t &column) const {
-	const GFF4Struct *gdaRow = getRow(row);
-	if (!gdaRow || ((column = findColumn(hash)) == kInvalidColumn))
+const GDAFile::ColumnData *GDAFile::getColumnData(size_t row, ColumnHandle column) const {
+	if (!column.isValid() || (row >= _rowCount))
 		return 0;
 
-	return gdaRow;
+	const ColumnData &data = _columnData[column._index];
+	if ((data.storage == kStorageNone) || !data.present[row])
+		return 0;
+
+	return &data;
 }
 
-const GFF4Struct *GDAFile::getRowColumn(size_t row, const Common::UString &name, size_t &column) const {
-	const GFF4Struct *gdaRow = getRow(row);
-	if (!gdaRow || ((column = findColumn(name)) == kInvalidColumn))
+const GFF4Struct *GDAFile::getMismatchedRow(size_t row, ColumnHandle column) const {
+	if (!column.isValid() || (row >= _rowCount))
+		return 0;
+
+	if (!_columnData[column._index].mismatched[row])
 		return 0;
 
-	return gdaRow;
+	return _rowStructs[row];
 }
 
-Common::UString GDAFile::getString(size_t row, uint32 columnHash, const Common::UString &def) const {
-	size_t gdaColumn;
-	const GFF4Struct *gdaRow = getRowColumn(row, columnHash, gdaColumn);
-	if (!gdaRow)
+Common::UString GDAFile::getString(size_t row, ColumnHandle column, const Common::UString &def) const {
+	const GFF4Struct *mismatched = getMismatchedRow(row, column);
+	if (mismatched)
+		return mismatched->getString(kGFF4G2DAColumn1 + column._index, def);
+
+	const ColumnData *data = getColumnData(row, column);
+	if (!data)
 		return def;
 
-	return gdaRow->getString(gdaColumn, def);
+	if (data->storage != kStorageString)
+		throw Common::Exception("GDA: Column is not a string type");
+
+	return data->strings[row];
 }
 
-Common::UString GDAFile::getString(size_t row, const Common::UString &columnName,
-                                   const Common::UString &def) const {
-	size_t gdaColumn;
-	const GFF4Struct *gdaRow = getRowColumn(row, columnName, gdaColumn);
-	if (!gdaRow)
+int32 GDAFile::getInt(size_t row, ColumnHandle column, int32 def) const {
+	const GFF4Struct *mismatched = getMismatchedRow(row, column);
+	if (mismatched)
+		return (int32) mismatched->getSint(kGFF4G2DAColumn1 + column._index, def);
+
+	const ColumnData *data = getColumnData(row, column);
+	if (!data)
 		return def;
 
-	return gdaRow->getString(gdaColumn, def);
+	if (data->storage != kStorageInt)
+		throw Common::Exception("GDA: Column is not an int type");
+
+	return data->ints[row];
 }
 
-int32 GDAFile::getInt(size_t row, uint32 columnHash, int32 def) const {
-	size_t gdaColumn;
-	const GFF4Struct *gdaRow = getRowColumn(row, columnHash, gdaColumn);
-	if (!gdaRow)
+float GDAFile::getFloat(size_t row, ColumnHandle column, float def) const {
+	const GFF4Struct *mismatched = getMismatchedRow(row, column);
+	if (mismatched)
+		return (float) mismatched->getDouble(kGFF4G2DAColumn1 + column._index, def);
+
+	const ColumnData *data = getColumnData(row, column);
+	if (!data)
 		return def;
 
-	return gdaRow->getSint(gdaColumn, def);
+	if (data->storage != kStorageFloat)
+		throw Common::Exception("GDA: Column is not a float type");
+
+	return data->floats[row];
 }
 
-int32 GDAFile::getInt(size_t row, const Common::UString &columnName, int32 def) const {
-	size_t gdaColumn;
-	const GFF4Struct *gdaRow = getRowColumn(row, columnName, gdaColumn);
-	if (!gdaRow)
-		return def;
+Common::UString GDAFile::getString(size_t row, uint32 columnHash, const Common::UString &def) const {
+	return getString(row, getColumn(columnHash), def);
+}
 
-	return gdaRow->getSint(gdaColumn, def);
+Common::UString GDAFile::getString(size_t row, const Common::UString &columnName,
+                                   const Common::UString &def) const {
+	return getString(row, getColumn(columnName), def);
 }
 
-float GDAFile::getFloat(size_t row, uint32 columnHash, float def) const {
-	size_t gdaColumn;
-	const GFF4Struct *gdaRow = getRowColumn(row, columnHash, gdaColumn);
-	if (!gdaRow)
-		return def;
+int32 GDAFile::getInt(size_t row, uint32 columnHash, int32 def) const {
+	return getInt(row, getColumn(columnHash), def);
+}
+
+int32 GDAFile::getInt(size_t row, const Common::UString &columnName, int32 def) const {
+	return getInt(row, getColumn(columnName), def);
+}
 
-	return gdaRow->getDouble(gdaColumn, def);
+float GDAFile::getFloat(size_t row, uint32 columnHash, float def) const {
+	return getFloat(row, getColumn(columnHash), def);
 }
 
 float GDAFile::getFloat(size_t row, const Common::UString &columnName, float def) const {
-	size_t gdaColumn;
-	const GFF4Struct *gdaRow = getRowColumn(row, columnName, gdaColumn);
-	if (!gdaRow)
-		return def;
+	return getFloat(row, getColumn(columnName), def);
+}
+
+GDAFile::Storage GDAFile::getStorage(Type type) {
+	switch (type) {
+		case kTypeString:
+		case kTypeResource:
+			return kStorageString;
+
+		case kTypeInt:
+		case kTypeBool:
+			return kStorageInt;
+
+		case kTypeFloat:
+			return kStorageFloat;
+
+		default:
+			break;
+	}
 
-	return gdaRow->getDouble(gdaColumn, def);
+	return kStorageNone;
+}
+
+GDAFile::Storage GDAFile::getStorage(const GFF4Struct &row, uint32 field) {
+	switch (row.getFieldType(field)) {
+		case GFF4Struct::kFieldTypeString:
+		case GFF4Struct::kFieldTypeASCIIString:
+			return kStorageString;
+
+		case GFF4Struct::kFieldTypeUint8:
+		case GFF4Struct::kFieldTypeUint16:
+		case GFF4Struct::kFieldTypeUint32:
+		case GFF4Struct::kFieldTypeUint64:
+		case GFF4Struct::kFieldTypeSint8:
+		case GFF4Struct::kFieldTypeSint16:
+		case GFF4Struct::kFieldTypeSint32:
+		case GFF4Struct::kFieldTypeSint64:
+			return kStorageInt;
+
+		case GFF4Struct::kFieldTypeFloat32:
+		case GFF4Struct::kFieldTypeFloat64:
+		case GFF4Struct::kFieldTypeNDSFixed:
+			return kStorageFloat;
+
+		default:
+			break;
+	}
+
+	return kStorageNone;
 }
 
 GDAFile::Type GDAFile::identifyType(const Columns &columns, const Row &rows, size_t column) const {
@@ -271,6 +315,28 @@ GDAFile::Type GDAFile::identifyType(const Columns &columns, const Row &rows, siz
 	return kTypeEmpty;
 }
 
+void GDAFile::ColumnData::resize(size_t size) {
+	present.resize(size, false);
+	mismatched.resize(size, false);
+
+	switch (storage) {
+		case kStorageInt:
+			ints.resize(size, 0);
+			break;
+
+		case kStorageFloat:
+			floats.resize(size, 0.0f);
+			break;
+
+		case kStorageString:
+			strings.resize(size);
+			break;
+
+		default:
+			break;
+	}
+}
+
 void GDAFile::load(Common::SeekableReadStream *gda) {
 	try {
 		_gff4s.push_back(new GFF4File(gda, kG2DAID));
@@ -284,10 +350,11 @@ void GDAFile::load(Common::SeekableReadStream *gda) {
 		_columns = &top.getList(kGFF4G2DAColumnList);
 		_rows.push_back(&top.getList(kGFF4G2DARowList));
 
-		_rowStarts.push_back(_rowCount);
 		_rowCount += _rows.back()->size();
 
 		_headers.resize(_columns->size());
+		_columnData.resize(_columns->size());
+
 		for (size_t i = 0; i < _columns->size(); i++) {
 			if (!(*_columns)[i])
 				continue;
@@ -295,8 +362,16 @@ void GDAFile::load(Common::SeekableReadStream *gda) {
 			_headers[i].hash  = (uint32) (*_columns)[i]->getUint(kGFF4G2DAColumnHash);
 			_headers[i].type  =          identifyType(_columns, _rows.back(), i);
 			_headers[i].field = (uint32) kGFF4G2DAColumn1 + i;
+
+			// If several columns have the same hash, the first one wins
+			_columnHashMap.insert(std::make_pair(_headers[i].hash, i));
+
+			_columnData[i].storage = getStorage(_headers[i].type);
 		}
 
+		convertRows();
+		indexRows();
+
 	} catch (Common::Exception &e) {
 		e.add("Failed reading GDA file");
 		throw;
@@ -305,18 +380,15 @@ void GDAFile::load(Common::SeekableReadStream *gda) {
 
 void GDAFile::add(Common::SeekableReadStream *gda) {
 	try {
-		_gff4s.push_back(new GFF4File(gda, kG2DAID));
+		Common::ScopedPtr<GFF4File> gff4(new GFF4File(gda, kG2DAID));
 
-		const uint32 version = _gff4s.back()->getTypeVersion();
+		const uint32 version = gff4->getTypeVersion();
 		if ((version != kVersion01) && (version != kVersion02))
 			throw Common::Exception("Unsupported GDA file version %s", Common::debugTag(version).c_str());
 
-		const GFF4Struct &top = _gff4s.back()->getTopLevel();
+		const GFF4Struct &top = gff4->getTopLevel();
 
-		_rows.push_back(&top.getList(kGFF4G2DARowList));
-
-		_rowStarts.push_back(_rowCount);
-		_rowCount += _rows.back()->size();
+		Row rows = &top.getList(kGFF4G2DARowList);
 
 		Columns columns = &top.getList(kGFF4G2DAColumnList);
 		if (columns->size() != _columns->size())
@@ -327,18 +399,104 @@ void GDAFile::add(Common::SeekableReadStream *gda) {
 			const uint32 hash1 = (uint32) (* columns)[i]->getUint(kGFF4G2DAColumnHash);
 			const uint32 hash2 = (uint32) (*_columns)[i]->getUint(kGFF4G2DAColumnHash);
 
-			const Type type1 = identifyType( columns, _rows.back(), i);
-			const Type type2 = identifyType(_columns, _rows[0]    , i);
+			const Type type1 = identifyType( columns, rows    , i);
+			const Type type2 = identifyType(_columns, _rows[0], i);
 
 			if ((hash1 != hash2) || (type1 != type2))
 				throw Common::Exception("Columns don't match (%u: %u+%d vs. %u+%d)", (uint) i,
 				                        hash1, (int)type1, hash2, (int)type2);
 		}
 
+		_gff4s.push_back(gff4.release());
+		_rows.push_back(rows);
+
+		_rowCount += _rows.back()->size();
+
+		convertRows();
+		indexRows();
+
 	} catch (Common::Exception &e) {
 		e.add("Failed adding GDA file");
 		throw;
 	}
 }
 
+void GDAFile::convertRows() {
+	const GFF4List &rows  = *_rows.back();
+	const size_t    start = _rowStructs.size();
+
+	assert((start + rows.size()) == _rowCount);
+
+	_rowStructs.insert(_rowStructs.end(), rows.begin(), rows.end());
+
+	for (size_t i = 0; i < _columnData.size(); i++) {
+		ColumnData &column = _columnData[i];
+		column.resize(_rowCount);
+
+		const uint32 field = kGFF4G2DAColumn1 + i;
+
+		for (size_t j = 0; j < rows.size(); j++) {
+			if (!rows[j])
+				continue;
+
+			const Storage storage = getStorage(*rows[j], field);
+			if (storage == kStorageNone)
+				continue;
+
+			// A column without a known type takes on the type of its first value
+			if (column.storage == kStorageNone) {
+				column.storage = storage;
+				column.resize(_rowCount);
+			}
+
+			const size_t row = start + j;
+
+			/* A value of a different type than its column is left in its GFF4
+			 * struct and read from there, with the GFF4 conversion rules. */
+			if (storage != column.storage) {
+				column.mismatched[row] = true;
+				continue;
+			}
+
+			switch (storage) {
+				case kStorageInt:
+					column.ints[row] = (int32) rows[j]->getSint(field);
+					break;
+
+				case kStorageFloat:
+					column.floats[row] = (float) rows[j]->getDouble(field);
+					break;
+
+				case kStorageString:
+					column.strings[row] = rows[j]->getString(field);
+					break;
+
+				default:
+					break;
+			}
+
+			column.present[row] = true;
+		}
+	}
+}
+
+void GDAFile::indexRows() {
+	ColumnHashMap::const_iterator idColumn = _columnHashMap.find(hashGDAHeader("ID"));
+	if (idColumn == _columnHashMap.end())
+		return;
+
+	const ColumnData &ids = _columnData[idColumn->second];
+	if (ids.storage != kStorageInt)
+		return;
+
+	/* Rows of later GDAs override rows with the same ID of earlier GDAs.
+	 * Within one GDA, the first row with an ID wins, so we go through
+	 * the rows in reverse. */
+
+	const size_t start = _rowCount - _rows.back()->size();
+	for (size_t i = _rowCount; i-- > start; )
+		if (ids.present[i])
+			_rowIDs[(uint32) ids.ints[i]] = i;
+}
+
 } // End of namespace Aurora
@@ -26,7 +26,7 @@
 #define AURORA_GDAFILE_H
 
 #include <vector>
-#include <map>
+#include <unordered_map>
 
 #include <boost/noncopyable.hpp>
 
@@ -57,7 +57,16 @@ namespace Aurora {
  *  an MGDA, creating a merged, combined table. This is commonly used
  *  by the Dragon Age games. Within these MGDAs, rows are not anymore
  *  identified by raw row index (since this index is now meaningless),
- *  but by an "ID" column.
+ *  but by an "ID" column. When several GDAs within an MGDA contain a
+ *  row with the same ID, the row of the GDA added last overrides the
+ *  others for the purpose of findRow().
+ *
+ *  On load, the rows are converted into a column-oriented table of
+ *  typed values, so that the getters don't need to go through the
+ *  GFF4 structs. For repeated lookups of the same column, the column
+ *  can be resolved once into a ColumnHandle with getColumn(); the
+ *  column hash itself can be computed at compile time with
+ *  hashGDAHeader() (see gdaheaders.h).
  */
 class GDAFile : boost::noncopyable {
 public:
@@ -83,6 +92,22 @@ public:
 	};
 	typedef std::vector<Header> Headers;
 
+	/** A resolved column, for fast repeated lookups. */
+	class ColumnHandle {
+	public:
+		ColumnHandle() : _index(kInvalidColumn) { }
+
+		/** Does this handle refer to an existing column? */
+		bool isValid() const { return _index != kInvalidColumn; }
+
+	private:
+		explicit ColumnHandle(size_t index) : _index(index) { }
+
+		size_t _index;
+
+		friend class GDAFile;
+	};
+
 
 	/** Take over this stream and read a GDA file out of it. */
 	GDAFile(Common::SeekableReadStream *gda);
@@ -121,6 +146,11 @@ public:
 	/** Find a column by its hash. */
 	size_t findColumn(uint32 hash) const;
 
+	/** Resolve a column by its name. */
+	ColumnHandle getColumn(const Common::UString &name) const;
+	/** Resolve a column by its hash. */
+	ColumnHandle getColumn(uint32 hash) const;
+
 	Common::UString getString(size_t row, uint32 columnHash, const Common::UString &def = "") const;
 	Common::UString getString(size_t row, const Common::UString &columnName,
 	                          const Common::UString &def = "") const;
@@ -131,16 +161,47 @@ public:
 	float getFloat(size_t row, uint32 columnHash, float def = 0.0f) const;
 	float getFloat(size_t row, const Common::UString &columnName, float def = 0.0f) const;
 
+	Common::UString getString(size_t row, ColumnHandle column, const Common::UString &def = "") const;
+	int32 getInt(size_t row, ColumnHandle column, int32 def = 0) const;
+	float getFloat(size_t row, ColumnHandle column, float def = 0.0f) const;
+
 
 private:
 	typedef Common::PtrVector<GFF4File> GFF4s;
 	typedef const GFF4List * Columns;
 	typedef const GFF4List * Row;
 	typedef std::vector<Row> Rows;
-	typedef std::vector<size_t> RowStarts;
 
-	typedef std::map<uint32, size_t> ColumnHashMap;
-	typedef std::map<Common::UString, size_t> ColumnNameMap;
+	typedef std::vector<const GFF4Struct *> RowStructs;
+
+	/** How the values of a column are stored. */
+	enum Storage {
+		kStorageNone,   ///< No values.
+		kStorageInt,    ///< Integer values.
+		kStorageFloat,  ///< Floating point values.
+		kStorageString  ///< String values.
+	};
+
+	/** The converted values of one column, over all rows of all GDAs. */
+	struct ColumnData {
+		Storage storage;
+
+		std::vector<bool> present;    ///< Does the row have a value in this column?
+		std::vector<bool> mismatched; ///< Is the row's value of a different type than the column?
+
+		std::vector<int32> ints;
+		std::vector<float> floats;
+		std::vector<Common::UString> strings;
+
+		ColumnData() : storage(kStorageNone) { }
+
+		void resize(size_t size);
+	};
+	typedef std::vector<ColumnData> ColumnDatas;
+
+	typedef std::unordered_map<uint32, size_t> ColumnHashMap;
+	typedef std::unordered_map<Common::UString, size_t, Common::hashUStringCaseSensitive> ColumnNameMap;
+	typedef std::unordered_map<uint32, size_t> RowIDMap;
 
 
 	GFF4s _gff4s;
@@ -152,18 +213,33 @@ private:
 
 	size_t _rowCount;
 
-	RowStarts _rowStarts;
+	/** The GFF4 structs of all rows of all GDAs. */
+	RowStructs _rowStructs;
+	/** The typed values of all columns. */
+	ColumnDatas _columnData;
 
-	mutable ColumnHashMap _columnHashMap;
+	ColumnHashMap _columnHashMap;
 	mutable ColumnNameMap _columnNameMap;
 
+	/** Map of row IDs to row indices, with later GDAs overriding earlier ones. */
+	RowIDMap _rowIDs;
+
 
 	void load(Common::SeekableReadStream *gda);
 
 	Type identifyType(const Columns &columns, const Row &rows, size_t column) const;
 
-	const GFF4Struct *getRowColumn(size_t row, uint32 hash, size_t &column) const;
-	const GFF4Struct *getRowColumn(size_t row, const Common::UString &name, size_t &column) const;
+	static Storage getStorage(Type type);
+	static Storage getStorage(const GFF4Struct &row, uint32 field);
+
+	/** Convert the rows of the GDA last added into the typed column values. */
+	void convertRows();
+	/** Add the IDs of the rows of the GDA last added to the row ID map. */
+	void indexRows();
+
+	const ColumnData *getColumnData(size_t row, ColumnHandle column) const;
+	/** Return the GFF4 struct of a row whose value in this column doesn't match the column type. */
+	const GFF4Struct *getMismatchedRow(size_t row, ColumnHandle column) const;
 };
 
 } // End of namespace Aurora
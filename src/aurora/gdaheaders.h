@@ -19,7 +19,8 @@
  */
 
 /** @file
- *   Resolve a GDA column header hash back to its string.
+ *   Resolve a GDA column header hash back to its string, and
+ *   compute GDA column header hashes at compile time.
  */
 
 #ifndef AURORA_GDAHEADERS_H
@@ -31,6 +32,45 @@ namespace Aurora {
 
 const char *findGDAHeader(uint32 hash);
 
+namespace GDAHeaderCRC32 {
+
+/* Compile-time version of Common::hashStringCRC32(name.toLower(), Common::kEncodingUTF16LE).
+ * Since constexpr functions in C++11 are limited to a single return statement,
+ * this is written as a set of recursive functions. */
+
+constexpr uint32 crc32Bits(uint32 c, int bits) {
+	return (bits == 0) ? c : crc32Bits((c & 1) ? (0xEDB88320 ^ (c >> 1)) : (c >> 1), bits - 1);
+}
+
+constexpr uint32 crc32Byte(uint32 hash, uint8 c) {
+	return crc32Bits((hash ^ c) & 0xFF, 8) ^ (hash >> 8);
+}
+
+constexpr uint8 toLower(char c) {
+	return ((c >= 'A') && (c <= 'Z')) ? (uint8) (c - 'A' + 'a') : (uint8) c;
+}
+
+constexpr uint32 hash(const char *name, uint32 crc) {
+	return (*name == '\0') ? (crc ^ 0xFFFFFFFF) : hash(name + 1, crc32Byte(crc32Byte(crc, toLower(*name)), 0));
+}
+
+} // End of namespace GDAHeaderCRC32
+
+/** Hash a GDA column header name at compile time.
+ *
+ *  This returns the same value as hashing the lower-cased name encoded
+ *  in UTF-16LE with CRC32, which is how GDA files store their column
+ *  headers. Only ASCII names are supported.
+ *
+ *  Example:
+ *  @code
+ *  static const uint32 kColumnModelName = Aurora::hashGDAHeader("ModelName");
+ *  @endcode
+ */
+constexpr uint32 hashGDAHeader(const char *name) {
+	return GDAHeaderCRC32::hash(name, 0xFFFFFFFF);
+}
+
 } // End of namespace Aurora
 
 #endif // AURORA_GDAHEADERS_H
@@ -0,0 +1,133 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Writing several GFF3s in parallel.
+ */
+
+#include <chrono>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ptrvector.h"
+#include "src/common/memwritestream.h"
+#include "src/common/memreadstream.h"
+#include "src/common/threads.h"
+
+#include "src/aurora/gff3batchwriter.h"
+#include "src/aurora/gff3writer.h"
+#include "src/aurora/erfwriter.h"
+#include "src/aurora/thewitchersavewriter.h"
+
+namespace Aurora {
+
+/** How many GFF3s per thread are serialized before they are passed on. */
+static const size_t kGFF3sPerThread = 4;
+
+GFF3BatchWriter::GFF3BatchWriter(unsigned int threads) : _threads(threads) {
+	if (_threads == 0)
+		_threads = Common::getHardwareConcurrency();
+}
+
+GFF3BatchWriter::~GFF3BatchWriter() {
+}
+
+void GFF3BatchWriter::add(const Common::UString &resRef, FileType type, boost::shared_ptr<GFF3Writer> gff) {
+	if (!gff)
+		throw Common::Exception("GFF3BatchWriter::add(): No GFF3");
+
+	Entry entry;
+	entry.resRef = resRef;
+	entry.type   = type;
+	entry.gff    = gff;
+
+	_entries.push_back(entry);
+}
+
+size_t GFF3BatchWriter::size() const {
+	return _entries.size();
+}
+
+GFF3BatchWriter::Statistics GFF3BatchWriter::write(const AddFunction &addFunction) {
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	Statistics stats;
+
+	std::vector<Entry> entries;
+	entries.swap(_entries);
+
+	const size_t window = _threads * kGFF3sPerThread;
+
+	for (size_t first = 0; first < entries.size(); first += window) {
+		const size_t count = MIN(window, entries.size() - first);
+
+		Common::PtrVector<Common::MemoryWriteStreamDynamic> data;
+		data.resize(count);
+
+		Common::parallelFor(count, [&](size_t i) {
+			Common::ScopedPtr<Common::MemoryWriteStreamDynamic> stream(new Common::MemoryWriteStreamDynamic(true));
+
+			entries[first + i].gff->write(*stream);
+
+			data[i] = stream.release();
+		}, _threads);
+
+		size_t windowSize = 0;
+		for (size_t i = 0; i < count; i++)
+			windowSize += data[i]->size();
+
+		stats.size              += windowSize;
+		stats.peakSerializedSize = MAX(stats.peakSerializedSize, windowSize);
+
+		// Pass on the serialized GFF3s in order, freeing each one right afterwards
+		for (size_t i = 0; i < count; i++) {
+			Common::MemoryReadStream stream(data[i]->getData(), data[i]->size());
+
+			addFunction(entries[first + i].resRef, entries[first + i].type, stream);
+
+			delete data[i];
+			data[i] = 0;
+
+			// Release our reference to the GFF3, it's not needed anymore
+			entries[first + i].gff.reset();
+		}
+
+		stats.count += count;
+	}
+
+	stats.duration = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	return stats;
+}
+
+GFF3BatchWriter::Statistics GFF3BatchWriter::write(ERFWriter &erf) {
+	return write([&erf](const Common::UString &resRef, FileType type, Common::SeekableReadStream &data) {
+		erf.add(resRef, type, data);
+	});
+}
+
+GFF3BatchWriter::Statistics GFF3BatchWriter::write(TheWitcherSaveWriter &save) {
+	return write([&save](const Common::UString &resRef, FileType type, Common::SeekableReadStream &data) {
+		save.add(resRef, type, data);
+	});
+}
+
+} // End of namespace Aurora
@@ -0,0 +1,109 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Writing several GFF3s in parallel.
+ */
+
+#ifndef AURORA_GFF3BATCHWRITER_H
+#define AURORA_GFF3BATCHWRITER_H
+
+#include <vector>
+#include <functional>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "src/common/ustring.h"
+#include "src/common/readstream.h"
+
+#include "src/aurora/types.h"
+
+namespace Aurora {
+
+class GFF3Writer;
+class ERFWriter;
+class TheWitcherSaveWriter;
+
+/** Writes several independent GFF3s into an archive.
+ *
+ *  The GFF3s are serialized on several threads, a few at a time, and each
+ *  serialized GFF3 is passed on to the archive as soon as all GFF3s before
+ *  it have been. Only the few GFF3s currently being worked on are held in
+ *  memory as serialized data.
+ *
+ *  The archive itself is only written to from the calling thread.
+ */
+class GFF3BatchWriter : boost::noncopyable {
+public:
+	/** Statistics about a write(). */
+	struct Statistics {
+		size_t count;              ///< The number of written GFF3s.
+		size_t size;               ///< The combined size of the serialized GFF3s, in bytes.
+		size_t peakSerializedSize; ///< The most serialized data held in memory at once, in bytes.
+		double duration;           ///< The time the whole write() took, in milliseconds.
+
+		Statistics() : count(0), size(0), peakSerializedSize(0), duration(0.0) { }
+	};
+
+	/** Function receiving a serialized GFF3, to add it to an archive. */
+	typedef std::function<void (const Common::UString &resRef, FileType type,
+	                            Common::SeekableReadStream &data)> AddFunction;
+
+	/** Create a batch writer.
+	 *
+	 *  @param threads The number of threads to serialize on. 0 means one per core.
+	 */
+	GFF3BatchWriter(unsigned int threads = 0);
+	~GFF3BatchWriter();
+
+	/** Queue a GFF3 to be written. */
+	void add(const Common::UString &resRef, FileType type, boost::shared_ptr<GFF3Writer> gff);
+
+	/** Return the number of queued GFF3s. */
+	size_t size() const;
+
+	/** Serialize all queued GFF3s and pass them on in the order they were queued.
+	 *
+	 *  Empties the queue.
+	 */
+	Statistics write(const AddFunction &addFunction);
+
+	/** Serialize all queued GFF3s into an ERF archive. */
+	Statistics write(ERFWriter &erf);
+	/** Serialize all queued GFF3s into a The Witcher save. */
+	Statistics write(TheWitcherSaveWriter &save);
+
+private:
+	struct Entry {
+		Common::UString resRef;
+		FileType type;
+
+		boost::shared_ptr<GFF3Writer> gff;
+	};
+
+	unsigned int _threads;
+
+	std::vector<Entry> _entries;
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_GFF3BATCHWRITER_H
@@ -33,6 +33,7 @@
 #include "src/common/encoding.h"
 #include "src/common/ustring.h"
 #include "src/common/strutil.h"
+#include "src/common/trace.h"
 
 #include "src/aurora/gff3file.h"
 #include "src/aurora/util.h"
@@ -64,7 +65,8 @@ void GFF3File::Header::read(Common::SeekableReadStream &gff3) {
 
 
 GFF3File::GFF3File(Common::SeekableReadStream *gff3, uint32 id, bool repairNWNPremium) :
-	_stream(gff3), _repairNWNPremium(repairNWNPremium), _offsetCorrection(0) {
+	_stream(gff3), _streamMemory(Common::kMemoryParsers), _repairNWNPremium(repairNWNPremium),
+	_offsetCorrection(0) {
 
 	assert(_stream);
 
@@ -72,7 +74,7 @@ GFF3File::GFF3File(Common::SeekableReadStream *gff3, uint32 id, bool repairNWNPr
 }
 
 GFF3File::GFF3File(const Common::UString &gff3, FileType type, uint32 id, bool repairNWNPremium) :
-	_repairNWNPremium(repairNWNPremium), _offsetCorrection(0) {
+	_streamMemory(Common::kMemoryParsers), _repairNWNPremium(repairNWNPremium), _offsetCorrection(0) {
 
 	_stream.reset(ResMan.getResource(gff3, type));
 	if (!_stream)
@@ -95,12 +97,16 @@ const GFF3Struct &GFF3File::getTopLevel() const {
 // --- Loader ---
 
 void GFF3File::load(uint32 id) {
+	TRACE_ZONE("GFF3File::load", "resources");
+
 	try {
 
 		loadHeader(id);
 		loadStructs();
 		loadLists();
 
+		_streamMemory.set(_stream->size());
+
 	} catch (Common::Exception &e) {
 		e.add("Failed reading GFF3 file");
 		throw;
@@ -34,6 +34,7 @@
 #include "src/common/scopedptr.h"
 #include "src/common/ptrvector.h"
 #include "src/common/ustring.h"
+#include "src/common/memaccount.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/aurorafile.h"
@@ -124,6 +125,8 @@ private:
 
 	Common::ScopedPtr<Common::SeekableReadStream> _stream;
 
+	Common::MemoryAccount _streamMemory; ///< The memory of the GFF3's data.
+
 	Header _header; ///< The GFF3's header.
 
 	/** Should we try to read GFF3 files found in Neverwinter Nights premium modules? */
@@ -22,371 +22,232 @@
  *  Writer for writing version V3.2/V3.3 of BioWare's GFFs (generic file format).
  */
 
-#include <algorithm>
+#include <cstring>
 
 #include <boost/make_shared.hpp>
 
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/hash.h"
 #include "src/common/writestream.h"
-#include "src/common/memreadstream.h"
 
 #include "src/aurora/gff3writer.h"
 
 namespace Aurora {
 
-GFF3Writer::VoidData::VoidData(Common::SeekableReadStream *stream) {
-	data.reset(stream);
-	data->seek(0);
-}
-
-GFF3Writer::VoidData &GFF3Writer::VoidData::operator=(const VoidData &rhs) {
-	data.reset();
-
-	if (!rhs.data)
-		return *this;
+static const uint32 kHeaderSize = 56; // ID + version + offsets and counts
 
-	data.reset(rhs.data->readStream(rhs.data->size()));
-	rhs.data->seek(0);
+static const uint32 kStructSize = 12;
+static const uint32 kFieldSize  = 12;
+static const uint32 kLabelSize  = 16;
 
-	return *this;
+static uint64 hashFieldData(const byte *data, size_t size) {
+	return Common::hashDataFNV64(0xCBF29CE484222325LL, data, size);
 }
 
 
-GFF3Writer::GFF3Writer(uint32 id, uint32 version) : _id(id), _version(version) {
+GFF3Writer::GFF3Writer(uint32 id, uint32 version) : _id(id), _version(version),
+	_fieldData(true), _fieldDataSize(0) {
+
 	_structs.push_back(boost::make_shared<GFF3WriterStruct>(this));
 }
 
+GFF3Writer::~GFF3Writer() {
+}
+
 GFF3WriterStructPtr GFF3Writer::getTopLevel() {
 	return _structs[0];
 }
 
 void GFF3Writer::write(Common::WriteStream &stream) {
-	// Extract all individual values of the fields.
-	std::list<Value> individualValues;
-	for (const auto &field : _fields) {
-		if (std::find(individualValues.begin(), individualValues.end(), field->value) == individualValues.end())
-			individualValues.push_back(field->value);
-	}
+	const uint32 structOffset = kHeaderSize;
+	const uint32 structCount  = _structs.size();
 
-	stream.writeUint32BE(_id);
-	stream.writeUint32BE(_version);
+	const uint32 fieldOffset = structOffset + structCount * kStructSize;
+	const uint32 fieldCount  = _fields.size();
 
-	uint32 structOffset = 56; // ID + version + header
-	uint32 structCount = static_cast<uint32>(_structs.size());
+	const uint32 labelOffset = fieldOffset + fieldCount * kFieldSize;
+	const uint32 labelCount  = _labels.size();
 
-	uint32 fieldOffset = structOffset + structCount * 12;
-	uint32 fieldCount = static_cast<uint32>(_fields.size());
+	const uint32 fieldDataOffset = labelOffset + labelCount * kLabelSize;
+	const uint32 fieldDataCount  = _fieldDataSize;
 
-	uint32 labelOffset = fieldOffset + fieldCount * 12;
-	uint32 labelCount = static_cast<uint32>(_labels.size());
+	// Field indices of all structs with more than one field
+	uint32 fieldIndicesCount = 0;
+	for (std::vector<GFF3WriterStructPtr>::const_iterator s = _structs.begin(); s != _structs.end(); ++s)
+		if ((*s)->getFieldCount() > 1)
+			fieldIndicesCount += (*s)->getFieldCount() * 4;
 
-	uint32 fieldDataOffset = labelOffset + labelCount * 16;
-	uint32 fieldDataCount = 0;
+	const uint32 fieldIndicesOffset = fieldDataOffset + fieldDataCount;
 
-	// Count the total size of field data
-	for (const auto &value : individualValues) {
-		fieldDataCount += getFieldDataSize(value);
+	// All list elements, plus the size of each list
+	std::vector<uint32> listOffsets;
+	listOffsets.reserve(_lists.size());
+
+	uint32 listIndicesCount = 0;
+	for (std::vector<GFF3WriterListPtr>::const_iterator l = _lists.begin(); l != _lists.end(); ++l) {
+		listOffsets.push_back(listIndicesCount);
+		listIndicesCount += ((*l)->getSize() + 1) * 4;
 	}
 
-	uint32 fieldIndicesOffset = fieldDataOffset + fieldDataCount;
-	uint32 fieldIndicesCount = 0;
+	const uint32 listIndicesOffset = fieldIndicesOffset + fieldIndicesCount;
 
-	// Count all fields of structs with more than one field
-	for (size_t i = 0; i < _structs.size(); ++i) {
-		const GFF3WriterStructPtr strct = _structs[i];
-		if (strct->getFieldCount() <= 1)
-			continue;
+	// Assemble the whole GFF3 in memory, then write it in one go
+	const size_t size = listIndicesOffset + listIndicesCount;
 
-		fieldIndicesCount += strct->getFieldCount() * 4;
-	}
+	Common::ScopedArray<byte> data(new byte[size]);
+	Common::MemoryWriteStream out(data.get(), size);
 
-	uint32 listIndicesOffset = fieldIndicesOffset + fieldIndicesCount;
-	uint32 listIndicesCount = 0;
+	out.writeUint32BE(_id);
+	out.writeUint32BE(_version);
 
-	// Count all lists elements plus their size as int
-	for (size_t i = 0; i < _lists.size(); ++i) {
-		listIndicesCount += (_lists[i]->getSize() + 1) * 4;
-	}
+	out.writeUint32LE(structOffset);
+	out.writeUint32LE(structCount);
+	out.writeUint32LE(fieldOffset);
+	out.writeUint32LE(fieldCount);
+	out.writeUint32LE(labelOffset);
+	out.writeUint32LE(labelCount);
+	out.writeUint32LE(fieldDataOffset);
+	out.writeUint32LE(fieldDataCount);
+	out.writeUint32LE(fieldIndicesOffset);
+	out.writeUint32LE(fieldIndicesCount);
+	out.writeUint32LE(listIndicesOffset);
+	out.writeUint32LE(listIndicesCount);
 
-	// Write the header
-	stream.writeUint32LE(structOffset);
-	stream.writeUint32LE(structCount);
-	stream.writeUint32LE(fieldOffset);
-	stream.writeUint32LE(fieldCount);
-	stream.writeUint32LE(labelOffset);
-	stream.writeUint32LE(labelCount);
-	stream.writeUint32LE(fieldDataOffset);
-	stream.writeUint32LE(fieldDataCount);
-	stream.writeUint32LE(fieldIndicesOffset);
-	stream.writeUint32LE(fieldIndicesCount);
-	stream.writeUint32LE(listIndicesOffset);
-	stream.writeUint32LE(listIndicesCount);
-
-	// Write structs data
-	size_t structFieldIndicesIndex = 0;
-	for (size_t i = 0; i < _structs.size(); ++i) {
-		GFF3WriterStructPtr strct = _structs[i];
-
-		// Struct ID
-		stream.writeUint32LE(strct->getID());
-
-		// Field index
-		if (strct->getFieldCount() > 1) {
-			stream.writeUint32LE(structFieldIndicesIndex * 4);
-			structFieldIndicesIndex += strct->getFieldCount();
-		} else {
-			if (strct->getFieldCount() != 0)
-				stream.writeUint32LE(strct->_fieldIndices[0]);
-			else
-				stream.writeUint32LE(0);
-		}
-
-		// Field count
-		stream.writeUint32LE(strct->getFieldCount());
-	}
+	// Structs
+	uint32 structFieldIndicesIndex = 0;
+	for (std::vector<GFF3WriterStructPtr>::const_iterator s = _structs.begin(); s != _structs.end(); ++s) {
+		const GFF3WriterStruct &strct = **s;
+
+		out.writeUint32LE(strct.getID());
 
-	// Write fields
-	size_t fieldDataIndex = 0;
-	size_t listDataIndex = 0;
-
-	// Maps for checking for already existing values
-	std::map<Value, size_t> valueIndices;
-
-	for (size_t i = 0; i < _fields.size(); ++i) {
-		FieldPtr field = _fields[i];
-		stream.writeUint32LE(field->value.type);
-		stream.writeUint32LE(field->labelIndex);
-
-		/* Determine if this field has simple values (less equal 32 bit) which are written in the field
-		 * or complex values, bigger than 32bit like strings written in the field data section. */
-		const bool simple =
-			field->value.type == GFF3Struct::kFieldTypeByte ||
-			field->value.type == GFF3Struct::kFieldTypeChar ||
-			field->value.type == GFF3Struct::kFieldTypeUint16 ||
-			field->value.type == GFF3Struct::kFieldTypeUint32 ||
-			field->value.type == GFF3Struct::kFieldTypeStruct ||
-			field->value.type == GFF3Struct::kFieldTypeSint16 ||
-			field->value.type == GFF3Struct::kFieldTypeSint32 ||
-			field->value.type == GFF3Struct::kFieldTypeFloat ||
-			field->value.type == GFF3Struct::kFieldTypeList;
-
-		if (simple) {
-			// If the values are simple (less equal 4 bytes) write them to the field
-			switch (field->value.type) {
-				case GFF3Struct::kFieldTypeByte:
-				case GFF3Struct::kFieldTypeUint16:
-				case GFF3Struct::kFieldTypeUint32:
-				case GFF3Struct::kFieldTypeStruct:
-					stream.writeUint32LE(boost::get<uint32>(field->value.data));
-					break;
-				case GFF3Struct::kFieldTypeList:
-					stream.writeUint32LE(listDataIndex * 4);
-					listDataIndex += 1 + _lists[boost::get<uint32>(field->value.data)]->getSize();
-					break;
-				case GFF3Struct::kFieldTypeChar:
-				case GFF3Struct::kFieldTypeSint16:
-				case GFF3Struct::kFieldTypeSint32:
-					stream.writeSint32LE(boost::get<int32>(field->value.data));
-					break;
-				case GFF3Struct::kFieldTypeFloat:
-					stream.writeIEEEFloatLE(boost::get<float>(field->value.data));
-					break;
-				default:
-					throw Common::Exception("Invalid Field type");
-			}
-		} else {
-			// If the values are complex (greater then 4 bytes) write the index to the field data
-
-			size_t index = 0;
-			if (valueIndices.find(field->value) == valueIndices.end()) {
-				index = fieldDataIndex;
-				fieldDataIndex += getFieldDataSize(field->value);
-				valueIndices[field->value] = index;
-			} else {
-				index = valueIndices[field->value];
-			}
-
-			stream.writeUint32LE(index);
-		}
+		if (strct.getFieldCount() > 1) {
+			out.writeUint32LE(structFieldIndicesIndex * 4);
+			structFieldIndicesIndex += strct.getFieldCount();
+		} else
+			out.writeUint32LE(strct._fieldIndices.empty() ? 0 : strct._fieldIndices[0]);
+
+		out.writeUint32LE(strct.getFieldCount());
 	}
 
-	// Write labels
-	for (size_t i = 0; i < _labels.size(); ++i) {
-		const Common::UString &label = _labels[i];
-		stream.write(label.c_str(), MIN<size_t>(label.size(), 16));
-		stream.writeZeros(16 - MIN<size_t>(label.size(), 16));
+	// Fields
+	for (std::vector<Field>::const_iterator f = _fields.begin(); f != _fields.end(); ++f) {
+		out.writeUint32LE(f->type);
+		out.writeUint32LE(f->labelIndex);
+
+		if (f->type == GFF3Struct::kFieldTypeList)
+			out.writeUint32LE(listOffsets[f->data]);
+		else
+			out.writeUint32LE(f->data);
 	}
 
-	// Write field data
-	for (const auto &value : individualValues) {
-		switch (value.type) {
-			case GFF3Struct::kFieldTypeUint64:
-				stream.writeUint64LE(boost::get<uint64>(value.data));
-				break;
-			case GFF3Struct::kFieldTypeSint64:
-				stream.writeSint64LE(boost::get<int64>(value.data));
-				break;
-			case GFF3Struct::kFieldTypeDouble:
-				stream.writeIEEEDoubleLE(boost::get<double>(value.data));
-				break;
-			case GFF3Struct::kFieldTypeStrRef:
-				stream.writeUint32LE(4);
-				stream.writeUint32LE(boost::get<uint32>(value.data));
-				break;
-			case GFF3Struct::kFieldTypeResRef:
-				if (value.isRaw) {
-					const VoidData &voidData = boost::get<VoidData>(value.data);
-
-					stream.writeByte(MIN<size_t>(255, static_cast<uint32>(voidData.data->size())));
-					stream.writeStream(*voidData.data, 255);
-					voidData.data->seek(0);
-
-				} else {
-					const Common::UString &string = boost::get<Common::UString>(value.data);
-
-					stream.writeByte(MIN<size_t>(255, string.size()));
-					stream.write(string.c_str(), MIN<size_t>(string.size(), 255));
-				}
-
-				break;
-			case GFF3Struct::kFieldTypeExoString:
-				if (value.isRaw) {
-					const VoidData &voidData = boost::get<VoidData>(value.data);
-
-					stream.writeUint32LE(static_cast<uint32>(voidData.data->size()));
-					stream.writeStream(*voidData.data);
-					voidData.data->seek(0);
-
-				} else {
-					const Common::UString &string = boost::get<Common::UString>(value.data);
-
-					stream.writeUint32LE(static_cast<uint32>(string.size()));
-					stream.writeString(string);
-				}
-				break;
-			case GFF3Struct::kFieldTypeLocString:
-				stream.writeUint32LE(boost::get<LocString>(value.data).getWrittenSize() + 8);
-				stream.writeUint32LE(boost::get<LocString>(value.data).getID());
-				stream.writeUint32LE(boost::get<LocString>(value.data).getNumStrings());
-				boost::get<LocString>(value.data).writeLocString(stream);
-				break;
-			case GFF3Struct::kFieldTypeVoid:
-				stream.writeUint32LE(static_cast<uint32>(boost::get<VoidData>(value.data).data->size()));
-				stream.writeStream(*boost::get<VoidData>(value.data).data);
-				boost::get<VoidData>(value.data).data->seek(0);
-				break;
-			case GFF3Struct::kFieldTypeVector:
-				stream.writeIEEEFloatLE(boost::get<Vector4>(value.data).vec.x);
-				stream.writeIEEEFloatLE(boost::get<Vector4>(value.data).vec.y);
-				stream.writeIEEEFloatLE(boost::get<Vector4>(value.data).vec.z);
-				break;
-			case GFF3Struct::kFieldTypeOrientation:
-				stream.writeIEEEFloatLE(boost::get<Vector4>(value.data).vec.x);
-				stream.writeIEEEFloatLE(boost::get<Vector4>(value.data).vec.y);
-				stream.writeIEEEFloatLE(boost::get<Vector4>(value.data).vec.z);
-				stream.writeIEEEFloatLE(boost::get<Vector4>(value.data).vec.w);
-				break;
-			default:
-				break;
-		}
+	// Labels
+	for (std::vector<Common::UString>::const_iterator l = _labels.begin(); l != _labels.end(); ++l) {
+		const size_t labelSize = MIN<size_t>(l->size(), kLabelSize);
+
+		out.write(l->c_str(), labelSize);
+		out.writeZeros(kLabelSize - labelSize);
 	}
 
-	// Write field indices of every struct with more than one field
-	for (size_t i = 0; i < _structs.size(); ++i) {
-		GFF3WriterStructPtr strct = _structs[i];
-		if (strct->getFieldCount() <= 1)
+	// Field data
+	if (_fieldDataSize > 0)
+		out.write(_fieldData.getData(), _fieldDataSize);
+
+	// Field indices
+	for (std::vector<GFF3WriterStructPtr>::const_iterator s = _structs.begin(); s != _structs.end(); ++s) {
+		const GFF3WriterStruct &strct = **s;
+		if (strct.getFieldCount() <= 1)
 			continue;
 
-		for (size_t j = 0; j < strct->getFieldCount(); ++j) {
-			stream.writeUint32LE(strct->_fieldIndices[j]);
-		}
+		for (std::vector<uint32>::const_iterator i = strct._fieldIndices.begin(); i != strct._fieldIndices.end(); ++i)
+			out.writeUint32LE(*i);
 	}
 
-	// Write list indices
-	for (size_t i = 0; i < _lists.size(); ++i) {
-		GFF3WriterListPtr list = _lists[i];
-		stream.writeUint32LE(list->getSize());
-		for (size_t j = 0; j < list->_strcts.size(); ++j) {
-			stream.writeUint32LE(list->_strcts[j]);
-		}
+	// List indices
+	for (std::vector<GFF3WriterListPtr>::const_iterator l = _lists.begin(); l != _lists.end(); ++l) {
+		out.writeUint32LE((*l)->getSize());
+
+		for (std::vector<uint32>::const_iterator i = (*l)->_strcts.begin(); i != (*l)->_strcts.end(); ++i)
+			out.writeUint32LE(*i);
 	}
+
+	assert(out.pos() == size);
+
+	stream.write(data.get(), size);
 }
 
 uint32 GFF3Writer::addLabel(const Common::UString &label) {
-	std::vector<Common::UString>::iterator iter = std::find(_labels.begin(), _labels.end(), label);
-	if (iter != _labels.end()) {
-		return static_cast<uint32>(std::distance(_labels.begin(), iter));
-	} else {
+	std::pair<LabelMap::iterator, bool> result = _labelIndices.insert(std::make_pair(label, (uint32)_labels.size()));
+	if (result.second)
 		_labels.push_back(label);
-		return static_cast<uint32>(_labels.size() - 1);
-	}
-}
 
-uint32 GFF3Writer::getFieldDataSize(Value value) {
-	switch (value.type) {
-		case GFF3Struct::kFieldTypeUint64:
-		case GFF3Struct::kFieldTypeSint64:
-		case GFF3Struct::kFieldTypeStrRef:
-		case GFF3Struct::kFieldTypeDouble:
-			return 8;
-		case GFF3Struct::kFieldTypeExoString:
-			if (value.isRaw)
-				return 4 + boost::get<VoidData>(value.data).data->size();
-			else
-				return 4 + boost::get<Common::UString>(value.data).size();
-		case GFF3Struct::kFieldTypeLocString:
-			return 12 + boost::get<LocString>(value.data).getWrittenSize();
-		case GFF3Struct::kFieldTypeResRef:
-			if (value.isRaw)
-				return 1 + MIN<size_t>(255, boost::get<VoidData>(value.data).data->size());
-			else
-				return 1 + MIN<size_t>(255, boost::get<Common::UString>(value.data).size());
-		case GFF3Struct::kFieldTypeVector:
-			return 12;
-		case GFF3Struct::kFieldTypeOrientation:
-			return 16;
-		case GFF3Struct::kFieldTypeVoid:
-			return 4 + boost::get<VoidData>(value.data).data->size();
-		default:
-			return 0;
-	}
+	return result.first->second;
 }
 
-size_t GFF3Writer::createField(GFF3Struct::FieldType type, const Common::UString &label) {
-	// Create a field index
-	size_t index = _fields.size();
+uint32 GFF3Writer::createField(GFF3Struct::FieldType type, const Common::UString &label, uint32 data) {
+	Field field;
+	field.type       = type;
+	field.labelIndex = addLabel(label);
+	field.data       = data;
 
-	// Create field
-	GFF3Writer::FieldPtr field = boost::make_shared<Field>();
-	field->value.type = type;
-	field->labelIndex = addLabel(label);
 	_fields.push_back(field);
 
-	return index;
+	return _fields.size() - 1;
 }
 
-GFF3WriterStructPtr GFF3WriterList::addStruct(const Common::UString &label) {
-	return addStruct(label, static_cast<uint32>(_parent->_structs.size()) - 1);
+uint32 GFF3Writer::createStruct(const Common::UString &label, uint32 id, GFF3WriterStructPtr &strct) {
+	strct = boost::make_shared<GFF3WriterStruct>(this, id);
+
+	const uint32 field = createField(GFF3Struct::kFieldTypeStruct, label, _structs.size());
+
+	_structs.push_back(strct);
+
+	return field;
 }
 
-GFF3WriterStructPtr GFF3WriterList::addStruct(const Common::UString &label, uint32 id) {
-	// Create the structure pointer
-	GFF3WriterStructPtr strct(
-			boost::make_shared<GFF3WriterStruct>(_parent, id));
+Common::WriteStream &GFF3Writer::beginFieldData() {
+	// Overwrite whatever is left over from a discarded duplicate
+	_fieldData.seek(_fieldDataSize);
+
+	return _fieldData;
+}
+
+uint32 GFF3Writer::endFieldData() {
+	const size_t offset = _fieldDataSize;
+	const size_t size   = _fieldData.pos() - offset;
+
+	if ((offset + size) > 0xFFFFFFFF)
+		throw Common::Exception("GFF3 field data too big");
+
+	const byte *data = _fieldData.getData() + offset;
+	const uint64 hash = hashFieldData(data, size);
 
-	// Create a field index
-	_strcts.push_back(_parent->_structs.size());
-	GFF3Writer::FieldPtr field = boost::make_shared<GFF3Writer::Field>();
-	field->value.type = GFF3Struct::kFieldTypeStruct;
-	field->value.data = static_cast<uint32>(_parent->_structs.size());
+	std::pair<FieldDataMap::const_iterator, FieldDataMap::const_iterator> values = _fieldDataValues.equal_range(hash);
+	for (FieldDataMap::const_iterator v = values.first; v != values.second; ++v)
+		if ((v->second.size == size) && !std::memcmp(_fieldData.getData() + v->second.offset, data, size))
+			return v->second.offset;
 
-	// Add the label
-	field->labelIndex = _parent->addLabel(label);
+	FieldData value;
+	value.offset = offset;
+	value.size   = size;
 
-	// Insert the newly created struct into the struct vector
-	_parent->_structs.push_back(strct);
+	_fieldDataValues.insert(std::make_pair(hash, value));
 
-	// Insert the struct to the field vector
-	_parent->_fields.push_back(field);
+	_fieldDataSize = offset + size;
+
+	return offset;
+}
+
+GFF3WriterStructPtr GFF3WriterList::addStruct(const Common::UString &label) {
+	return addStruct(label, static_cast<uint32>(_parent->_structs.size()) - 1);
+}
+
+GFF3WriterStructPtr GFF3WriterList::addStruct(const Common::UString &label, uint32 id) {
+	GFF3WriterStructPtr strct;
+	_parent->createStruct(label, id, strct);
+
+	_strcts.push_back(_parent->_structs.size() - 1);
 
 	return strct;
 }
@@ -411,139 +272,168 @@ GFF3WriterStructPtr GFF3WriterStruct::addStruct(const Common::UString &label) {
 }
 
 GFF3WriterStructPtr GFF3WriterStruct::addStruct(const Common::UString &label, uint32 id) {
-	// Create the structure pointer
-	GFF3WriterStructPtr strct(
-			boost::make_shared<GFF3WriterStruct>(_parent, id));
-
-	// Create a field index
-	_fieldIndices.push_back(_parent->_fields.size());
-	GFF3Writer::FieldPtr field = boost::make_shared<GFF3Writer::Field>();
-	field->value.type = GFF3Struct::kFieldTypeStruct;
-	field->value.data = static_cast<uint32>(_parent->_structs.size());
-
-	// Add the label
-	field->labelIndex = _parent->addLabel(label);
-
-	// Insert the newly created struct into the struct vector
-	_parent->_structs.push_back(strct);
-
-	// Insert the struct to the field vector
-	_parent->_fields.push_back(field);
+	GFF3WriterStructPtr strct;
+	_fieldIndices.push_back(_parent->createStruct(label, id, strct));
 
 	return strct;
 }
 
 GFF3WriterListPtr GFF3WriterStruct::addList(const Common::UString &label) {
-	// Create the list pointer
-	GFF3WriterListPtr strct(boost::make_shared<GFF3WriterList>(_parent));
-
-	// Create a field index
-	_fieldIndices.push_back(_parent->_fields.size());
-	GFF3Writer::FieldPtr field = boost::make_shared<GFF3Writer::Field>();
-	field->value.type = GFF3Struct::kFieldTypeList;
-	field->value.data = static_cast<uint32>(_parent->_lists.size());
-
-	// Add the label
-	field->labelIndex = _parent->addLabel(label);
+	GFF3WriterListPtr list(boost::make_shared<GFF3WriterList>(_parent));
 
-	// Insert the newly created list into the lists vector
-	_parent->_lists.push_back(strct);
+	addField(GFF3Struct::kFieldTypeList, label, _parent->_lists.size());
 
-	// Insert the list to the field vector
-	_parent->_fields.push_back(field);
+	_parent->_lists.push_back(list);
 
-	return strct;
+	return list;
 }
 
 void GFF3WriterStruct::addByte(const Common::UString &label, uint8 value) {
-	createField(GFF3Struct::kFieldTypeByte, label)->value.data = static_cast<uint32>(value);
+	addField(GFF3Struct::kFieldTypeByte, label, value);
 }
 
 void GFF3WriterStruct::addChar(const Common::UString &label, int8 value) {
-	createField(GFF3Struct::kFieldTypeChar, label)->value.data = static_cast<int32>(value);
+	addField(GFF3Struct::kFieldTypeChar, label, static_cast<uint32>(static_cast<int32>(value)));
 }
 
 void GFF3WriterStruct::addFloat(const Common::UString &label, float value) {
-	createField(GFF3Struct::kFieldTypeFloat, label)->value.data = value;
+	addField(GFF3Struct::kFieldTypeFloat, label, convertIEEEFloat(value));
 }
 
 void GFF3WriterStruct::addDouble(const Common::UString &label, double value) {
-	createField(GFF3Struct::kFieldTypeDouble, label)->value.data = value;
+	_parent->beginFieldData().writeIEEEDoubleLE(value);
+	addFieldData(GFF3Struct::kFieldTypeDouble, label);
 }
 
 void GFF3WriterStruct::addUint16(const Common::UString &label, uint16 value) {
-	createField(GFF3Struct::kFieldTypeUint16, label)->value.data = static_cast<uint32>(value);
+	addField(GFF3Struct::kFieldTypeUint16, label, value);
 }
 
 void GFF3WriterStruct::addUint32(const Common::UString &label, uint32 value) {
-	createField(GFF3Struct::kFieldTypeUint32, label)->value.data = value;
+	addField(GFF3Struct::kFieldTypeUint32, label, value);
 }
 
 void GFF3WriterStruct::addUint64(const Common::UString &label, uint64 value) {
-	createField(GFF3Struct::kFieldTypeUint64, label)->value.data = value;
+	_parent->beginFieldData().writeUint64LE(value);
+	addFieldData(GFF3Struct::kFieldTypeUint64, label);
 }
 
 void GFF3WriterStruct::addSint16(const Common::UString &label, int16 value) {
-	createField(GFF3Struct::kFieldTypeSint16, label)->value.data = static_cast<int32>(value);
+	addField(GFF3Struct::kFieldTypeSint16, label, static_cast<uint32>(static_cast<int32>(value)));
 }
 
 void GFF3WriterStruct::addSint32(const Common::UString &label, int32 value) {
-	createField(GFF3Struct::kFieldTypeSint32, label)->value.data = value;
+	addField(GFF3Struct::kFieldTypeSint32, label, static_cast<uint32>(value));
 }
 
 void GFF3WriterStruct::addSint64(const Common::UString &label, int64 value) {
-	createField(GFF3Struct::kFieldTypeSint64, label)->value.data = value;
+	_parent->beginFieldData().writeSint64LE(value);
+	addFieldData(GFF3Struct::kFieldTypeSint64, label);
 }
 
 void GFF3WriterStruct::addExoString(const Common::UString &label, const Common::UString &value) {
-	createField(GFF3Struct::kFieldTypeExoString, label)->value.data = value;
+	Common::WriteStream &data = _parent->beginFieldData();
+
+	data.writeUint32LE(value.size());
+	data.writeString(value);
+
+	addFieldData(GFF3Struct::kFieldTypeExoString, label);
 }
 
 void GFF3WriterStruct::addExoString(const Common::UString &label, Common::SeekableReadStream *value) {
-	GFF3Writer::FieldPtr field = createField(GFF3Struct::kFieldTypeExoString, label);
+	Common::ScopedPtr<Common::SeekableReadStream> stream(value);
+	stream->seek(0);
+
+	Common::WriteStream &data = _parent->beginFieldData();
 
-	field->value.data = GFF3Writer::VoidData(value);
-	field->value.isRaw = true;
+	data.writeUint32LE(stream->size());
+	data.writeStream(*stream);
+
+	addFieldData(GFF3Struct::kFieldTypeExoString, label);
 }
 
 void GFF3WriterStruct::addStrRef(const Common::UString &label, uint32 value) {
-	createField(GFF3Struct::kFieldTypeStrRef, label)->value.data = value;
+	Common::WriteStream &data = _parent->beginFieldData();
+
+	data.writeUint32LE(4);
+	data.writeUint32LE(value);
+
+	addFieldData(GFF3Struct::kFieldTypeStrRef, label);
 }
 
 void GFF3WriterStruct::addResRef(const Common::UString &label, const Common::UString &value) {
-	createField(GFF3Struct::kFieldTypeResRef, label)->value.data = value;
+	const size_t size = MIN<size_t>(value.size(), 255);
+
+	Common::WriteStream &data = _parent->beginFieldData();
+
+	data.writeByte(size);
+	data.write(value.c_str(), size);
+
+	addFieldData(GFF3Struct::kFieldTypeResRef, label);
 }
 
 void GFF3WriterStruct::addResRef(const Common::UString &label, Common::SeekableReadStream *value) {
-	GFF3Writer::FieldPtr field = createField(GFF3Struct::kFieldTypeResRef, label);
+	Common::ScopedPtr<Common::SeekableReadStream> stream(value);
+	stream->seek(0);
+
+	Common::WriteStream &data = _parent->beginFieldData();
 
-	field->value.data = GFF3Writer::VoidData(value);
-	field->value.isRaw = true;
+	data.writeByte(MIN<size_t>(stream->size(), 255));
+	data.writeStream(*stream, 255);
+
+	addFieldData(GFF3Struct::kFieldTypeResRef, label);
 }
 
 void GFF3WriterStruct::addVoid(const Common::UString &label, Common::SeekableReadStream *value) {
-	GFF3Writer::FieldPtr field = createField(GFF3Struct::kFieldTypeVoid, label);
+	Common::ScopedPtr<Common::SeekableReadStream> stream(value);
+	stream->seek(0);
+
+	Common::WriteStream &data = _parent->beginFieldData();
 
-	field->value.data = GFF3Writer::VoidData(value);
-	field->value.isRaw = true;
+	data.writeUint32LE(stream->size());
+	data.writeStream(*stream);
+
+	addFieldData(GFF3Struct::kFieldTypeVoid, label);
 }
 
 void GFF3WriterStruct::addVector(const Common::UString &label, glm::vec3 value) {
-	createField(GFF3Struct::kFieldTypeVector, label)->value.data = glm::vec4(value, 0.0f);
+	Common::WriteStream &data = _parent->beginFieldData();
+
+	data.writeIEEEFloatLE(value.x);
+	data.writeIEEEFloatLE(value.y);
+	data.writeIEEEFloatLE(value.z);
+
+	addFieldData(GFF3Struct::kFieldTypeVector, label);
 }
 
 void GFF3WriterStruct::addOrientation(const Common::UString &label, glm::vec4 value) {
-	createField(GFF3Struct::kFieldTypeOrientation, label)->value.data = value;
+	Common::WriteStream &data = _parent->beginFieldData();
+
+	data.writeIEEEFloatLE(value.x);
+	data.writeIEEEFloatLE(value.y);
+	data.writeIEEEFloatLE(value.z);
+	data.writeIEEEFloatLE(value.w);
+
+	addFieldData(GFF3Struct::kFieldTypeOrientation, label);
 }
 
 void GFF3WriterStruct::addLocString(const Common::UString &label, const LocString &value) {
-	createField(GFF3Struct::kFieldTypeLocString, label)->value.data = value;
+	Common::WriteStream &data = _parent->beginFieldData();
+
+	data.writeUint32LE(value.getWrittenSize() + 8);
+	data.writeUint32LE(value.getID());
+	data.writeUint32LE(value.getNumStrings());
+	value.writeLocString(data);
+
+	addFieldData(GFF3Struct::kFieldTypeLocString, label);
+}
+
+void GFF3WriterStruct::addField(GFF3Struct::FieldType type, const Common::UString &label, uint32 data) {
+	_fieldIndices.push_back(_parent->createField(type, label, data));
 }
 
-GFF3Writer::FieldPtr GFF3WriterStruct::createField(GFF3Struct::FieldType type, const Common::UString &label) {
-	size_t index = _parent->createField(type, label);
-	_fieldIndices.push_back(index);
-	return _parent->_fields.back();
+void GFF3WriterStruct::addFieldData(GFF3Struct::FieldType type, const Common::UString &label) {
+	_fieldIndices.push_back(_parent->createField(type, label, _parent->endFieldData()));
 }
 
 GFF3WriterStruct::GFF3WriterStruct(GFF3Writer *parent, uint32 id) : _id(id), _parent(parent) {
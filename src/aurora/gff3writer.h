@@ -25,19 +25,16 @@
 #ifndef AURORA_GFF3WRITER_H
 #define AURORA_GFF3WRITER_H
 
-#include <list>
-#include <functional>
+#include <vector>
+#include <unordered_map>
 
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
-#include <boost/variant.hpp>
 
-#ifdef BOOST_COMP_CLANG
-	#define GLM_LANG_STL11_FORCED // Fix clang glm c++11 bug
-#endif // BOOST_COMP_CLANG
-#include "external/glm/glm.hpp"
-#include "external/glm/gtx/hash.hpp"
+#include "external/glm/vec3.hpp"
+#include "external/glm/vec4.hpp"
 
+#include "src/common/ustring.h"
 #include "src/common/readstream.h"
 #include "src/common/memwritestream.h"
 
@@ -52,10 +49,18 @@ class GFF3WriterList;
 typedef boost::shared_ptr<GFF3WriterStruct> GFF3WriterStructPtr;
 typedef boost::shared_ptr<GFF3WriterList> GFF3WriterListPtr;
 
+/** Writer for GFF3 files.
+ *
+ *  Values that don't fit into a field are serialized into the field
+ *  data as soon as they are added, and identical values are only stored
+ *  once. Writing the GFF3 then only needs to fill in the few remaining
+ *  offsets, and it can be done repeatedly.
+ */
 class GFF3Writer : boost::noncopyable {
 public:
 	// TODO: Add a constructor consuming a GFF3File object.
 	GFF3Writer(uint32 id, uint32 version = MKTAG('V', '3', '.', '2'));
+	~GFF3Writer();
 
 	/** Get the top-level struct. */
 	GFF3WriterStructPtr getTopLevel();
@@ -64,95 +69,31 @@ public:
 	void write(Common::WriteStream &stream);
 
 private:
-	struct Vector4 {
-		glm::vec4 vec;
-
-		Vector4(glm::vec4 vector) : vec(vector) {
-		}
-
-		bool operator==(const Vector4 &v)  const {
-			return vec == v.vec;
-		}
-
-		bool operator<(const Vector4 &v) const {
-			std::hash<glm::vec4> h;
-			return h(vec) < h(v.vec);
-		}
+	/** A field, as it is written into the GFF3. */
+	struct Field {
+		uint32 type;       ///< The type of the field, a GFF3Struct::FieldType.
+		uint32 labelIndex; ///< The index of the field's label.
+
+		/** The field's value.
+		 *
+		 *  Depending on the type of the field, this is the value itself,
+		 *  the index of a struct or a list, or an offset into the field data.
+		 */
+		uint32 data;
 	};
 
-	/** A special struct type for representing void data. */
-	struct VoidData {
-		Common::ScopedPtr<Common::SeekableReadStream> data;
-
-		VoidData() { }
-
-		VoidData(Common::SeekableReadStream *stream);
-
-		VoidData(const VoidData &voidData) { *this = voidData; }
-
-		VoidData &operator=(const VoidData &rhs);
-
-		bool operator==(const VoidData &rhs) const {
-			return data.get() == rhs.data.get();
-		}
-
-		bool operator<(const VoidData &rhs) const {
-			return std::less<Common::SeekableReadStream*>{}(data.get(), rhs.data.get());
-		}
+	/** A value within the field data. */
+	struct FieldData {
+		uint32 offset;
+		uint32 size;
 	};
 
-	/** A variant containing all possible types of GFF data. */
-	typedef boost::variant<
-		uint32,
-		uint64,
-		int32,
-		int64,
-		float,
-		double,
-		Vector4,
-		Common::UString,
-		LocString,
-		VoidData
-	> ValueData;
-
-	class ValueDataLess : public boost::static_visitor<bool> {
-	public:
-		template<typename T, typename U> bool operator()(const T &UNUSED(v1), const U &UNUSED(v2)) const { return false; }
-
-		template<typename T> bool operator()(const T &v1, const T &v2) const { return v1 < v2; }
-	};
+	typedef std::unordered_map<Common::UString, uint32,
+	                           Common::hashUStringCaseSensitive,
+	                           Common::equalsUStringSensitive> LabelMap;
 
-	/** A value holds a type and data. */
-	struct Value {
-		GFF3Struct::FieldType type;
-		ValueData data;
-		bool isRaw { false };
-
-		/** Equality operator for std::find. */
-		bool operator==(const Value &rhs) const {
-			return type == rhs.type &&
-			       data == rhs.data;
-		}
-
-		/** Relational operator for map find. */
-		bool operator<(const Value &rhs) const {
-			if (type != rhs.type) {
-				return type < rhs.type;
-			} else if (data.which() != rhs.data.which()) {
-				return data.which() < rhs.data.which();
-			} else {
-				return boost::apply_visitor(ValueDataLess(), data, rhs.data);
-			}
-		}
-	};
-
-	/** An implementation for a field. */
-	struct Field : boost::noncopyable {
-		uint32 labelIndex;
-		Value value;
-	};
-
-	typedef boost::shared_ptr<Field> FieldPtr;
+	/** Values in the field data, indexed by the hash of their data. */
+	typedef std::unordered_multimap<uint64, FieldData> FieldDataMap;
 
 	uint32 _id;
 	uint32 _version;
@@ -161,17 +102,36 @@ private:
 	std::vector<GFF3WriterListPtr> _lists;
 
 	std::vector<Common::UString> _labels;
-	std::vector<FieldPtr> _fields;
+	LabelMap _labelIndices;
+
+	std::vector<Field> _fields;
+
+	/** The serialized values of all fields that don't fit into the field itself. */
+	Common::MemoryWriteStreamDynamic _fieldData;
+	/** The size of the field data that's actually in use. */
+	uint32 _fieldDataSize;
+
+	FieldDataMap _fieldDataValues;
 
 	friend class GFF3WriterList;
 	friend class GFF3WriterStruct;
 
 	/** Adds a label to the writer and returns the corresponding index. */
 	uint32 addLabel(const Common::UString &label);
-	/** Get the actual size of the field. */
-	static uint32 getFieldDataSize(Value field);
 
-	size_t createField(GFF3Struct::FieldType type, const Common::UString &label);
+	/** Create a new field and return its index. */
+	uint32 createField(GFF3Struct::FieldType type, const Common::UString &label, uint32 data);
+	/** Create a new struct and return the index of the field pointing to it. */
+	uint32 createStruct(const Common::UString &label, uint32 id, GFF3WriterStructPtr &strct);
+
+	/** Return the stream to serialize a new value into the field data. */
+	Common::WriteStream &beginFieldData();
+	/** Finish serializing a value into the field data and return its offset.
+	 *
+	 *  If the same value already exists in the field data, the new copy
+	 *  is discarded and the offset of the existing one is returned.
+	 */
+	uint32 endFieldData();
 };
 
 /** A GFF3 list containing GFF3 structs. */
@@ -191,7 +151,7 @@ private:
 	friend class GFF3WriterStruct;
 
 	GFF3Writer *_parent;
-	std::vector<size_t> _strcts;
+	std::vector<uint32> _strcts;
 };
 
 /** A GFF3 struct containing GFF3 fields.
@@ -254,11 +214,14 @@ public:
 	void addLocString(const Common::UString &label, const LocString &value);
 
 private:
-	GFF3Writer::FieldPtr createField(GFF3Struct::FieldType type, const Common::UString &label);
+	/** Add a new field to this struct. */
+	void addField(GFF3Struct::FieldType type, const Common::UString &label, uint32 data);
+	/** Add a new field whose value has just been serialized into the field data. */
+	void addFieldData(GFF3Struct::FieldType type, const Common::UString &label);
 
 	uint32 _id;
 	GFF3Writer *_parent;
-	std::vector<size_t> _fieldIndices;
+	std::vector<uint32> _fieldIndices;
 
 	friend class GFF3Writer;
 	friend class GFF3WriterList;
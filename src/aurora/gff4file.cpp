@@ -27,13 +27,17 @@
  */
 
 #include <cassert>
+#include <cstring>
+#include <algorithm>
 
 #include "external/glm/gtc/type_ptr.hpp"
 
 #include "src/common/error.h"
 #include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
 #include "src/common/encoding.h"
 #include "src/common/strutil.h"
+#include "src/common/trace.h"
 
 #include "src/aurora/gff4file.h"
 #include "src/aurora/util.h"
@@ -76,16 +80,16 @@ bool GFF4File::Header::isBigEndian() const {
 }
 
 
-GFF4File::GFF4File(Common::SeekableReadStream *gff4, uint32 type) :
-	_origStream(gff4), _topLevelStruct(0) {
+GFF4File::GFF4File(Common::SeekableReadStream *gff4, uint32 type, bool lazy) :
+	_origStream(gff4), _streamMemory(Common::kMemoryParsers), _lazy(lazy), _memory(0), _topLevelStruct(0) {
 
 	assert(_origStream);
 
 	load(type);
 }
 
-GFF4File::GFF4File(const Common::UString &gff4, FileType fileType, uint32 type) :
-	_topLevelStruct(0) {
+GFF4File::GFF4File(const Common::UString &gff4, FileType fileType, uint32 type, bool lazy) :
+	_streamMemory(Common::kMemoryParsers), _lazy(lazy), _memory(0), _topLevelStruct(0) {
 
 	_origStream.reset(ResMan.getResource(gff4, fileType));
 	if (!_origStream)
@@ -107,6 +111,12 @@ void GFF4File::clear() {
 
 	_structs.clear();
 	_topLevelStruct = 0;
+
+	_memory = 0;
+}
+
+bool GFF4File::isLazy() const {
+	return _lazy;
 }
 
 uint32 GFF4File::getType() const {
@@ -141,11 +151,33 @@ const GFF4Struct &GFF4File::getTopLevel() const {
 // --- Loader ---
 
 void GFF4File::load(uint32 type) {
+	TRACE_ZONE("GFF4File::load", "resources");
+
 	try {
 
+		if (_lazy) {
+			/* We're going to jump around the GFF4 a lot while lazily loading
+			 * structs, so make sure we can do that cheaply. */
+			Common::MemoryReadStream *memory = dynamic_cast<Common::MemoryReadStream *>(_origStream.get());
+			if (!memory) {
+				_origStream->seek(0);
+
+				memory = _origStream->readStream(_origStream->size());
+				_origStream.reset(memory);
+			}
+
+			_memory = memory->getData();
+		}
+
 		loadHeader(type);
 		loadStructs();
-		loadStrings();
+
+		if (_lazy)
+			loadStringsLazy();
+		else
+			loadStrings();
+
+		_streamMemory.set(_origStream->size());
 
 	} catch (Common::Exception &e) {
 		clear();
@@ -259,6 +291,34 @@ void GFF4File::loadStrings() {
 		_sharedStrings[i] = Common::readString(*_stream, Common::kEncodingUTF8);
 }
 
+void GFF4File::loadStringsLazy() {
+	/* Only find where the shared strings are, and decode
+	 * them straight from memory when they're requested. */
+
+	if (!_header.hasSharedStrings)
+		return;
+
+	const size_t size = _origStream->size();
+	if (_header.stringOffset > size)
+		throw Common::Exception(Common::kSeekError);
+
+	_sharedStrings.resize(_header.stringCount);
+	_sharedStringDatas.resize(_header.stringCount);
+
+	size_t offset = _header.stringOffset;
+	for (uint32 i = 0; i < _header.stringCount; i++) {
+		const byte *string = _memory + offset;
+		const byte *end    = static_cast<const byte *>(std::memchr(string, 0, size - offset));
+
+		_sharedStringDatas[i].offset = offset;
+		_sharedStringDatas[i].size   = end ? (end - string) : (size - offset);
+
+		_sharedStringDatas[i].decoded = false;
+
+		offset += _sharedStringDatas[i].size + (end ? 1 : 0);
+	}
+}
+
 // --- Helpers for GFF4Struct ---
 
 void GFF4File::registerStruct(uint64 id, GFF4Struct *strct) {
@@ -313,9 +373,25 @@ bool GFF4File::hasSharedStrings() const {
 	return _header.hasSharedStrings;
 }
 
-Common::UString GFF4File::getSharedString(uint32 i) const {
+static const Common::UString kEmptyString;
+const Common::UString &GFF4File::getSharedString(uint32 i) const {
 	if (i == 0xFFFFFFFF)
-		return "";
+		return kEmptyString;
+
+	if (_lazy) {
+		if (i >= _sharedStringDatas.size())
+			throw Common::Exception("GFF4: Shared string index out of range (%u >= %u)",
+			                        i, (uint) _sharedStringDatas.size());
+
+		// Decode the string into the table the first time it's requested
+		SharedStringData &data = _sharedStringDatas[i];
+		if (!data.decoded) {
+			_sharedStrings[i] = Common::readString(_memory + data.offset, data.size, Common::kEncodingUTF8);
+			data.decoded = true;
+		}
+
+		return _sharedStrings[i];
+	}
 
 	if (i >= _sharedStrings.size())
 		throw Common::Exception("GFF4: Shared string index out of range (%u >= %u)",
@@ -418,7 +494,13 @@ void GFF4Struct::load(GFF4File &parent, uint32 offset, const GFF4File::StructTem
 	 * Go through all the fields in the template and create field
 	 * instances within this struct instance. If the field is itself
 	 * a struct, recursively create a new struct instance for it. If
-	 * the field is a generic, create a struct for it as well. */
+	 * the field is a generic, create a struct for it as well.
+	 *
+	 * When loading lazily, the structs of these fields are only
+	 * created when they're first accessed. */
+
+	_fields.reserve(tmplt.fields.size());
+	_fieldLabels.reserve(tmplt.fields.size());
 
 	for (size_t i = 0; i < tmplt.fields.size(); i++) {
 		const GFF4File::StructTemplate::Field &field = tmplt.fields[i];
@@ -430,21 +512,48 @@ void GFF4Struct::load(GFF4File &parent, uint32 offset, const GFF4File::StructTem
 		if ((offset == 0xFFFFFFFF) || (field.offset == 0xFFFFFFFF))
 			fieldOffset = 0xFFFFFFFF;
 
-		// Load the field and its struct(s), if any
-		Field &f = _fields[field.label] = Field(field.label, field.type, field.flags, fieldOffset);
-		if (f.type == kFieldTypeStruct)
-			loadStructs(parent, f);
+		_fields.push_back(Field(field.label, field.type, field.flags, fieldOffset));
+
+		Field &f = _fields.back();
 		if (f.type == kFieldTypeGeneric)
-			loadGeneric(parent, f);
+			f.offset = getDataOffset(f.isList, f.offset);
 
 		if ((f.type == kFieldTypeASCIIString) && parent.hasSharedStrings())
 			throw Common::Exception("GFF4: TODO: ASCII string field in a file with shared strings");
 	}
 
+	sortFields();
+
 	_fieldCount = _fields.size();
+
+	// Load the fields' struct(s), if any
+	if (!parent.isLazy())
+		for (FieldList::const_iterator f = _fields.begin(); f != _fields.end(); ++f)
+			getStructs(*f);
+}
+
+void GFF4Struct::sortFields() {
+	std::stable_sort(_fields.begin(), _fields.end(), [](const Field &a, const Field &b) {
+		return a.label < b.label;
+	});
+
+	// If a label appears several times, the last field with that label wins
+	FieldList::iterator last = _fields.begin();
+	for (FieldList::iterator f = _fields.begin(); f != _fields.end(); ++f) {
+		FieldList::iterator next = f + 1;
+		if ((next != _fields.end()) && (next->label == f->label))
+			continue;
+
+		if (last != f)
+			*last = *f;
+
+		++last;
+	}
+
+	_fields.erase(last, _fields.end());
 }
 
-void GFF4Struct::loadStructs(GFF4File &parent, Field &field) {
+void GFF4Struct::loadStructs(GFF4File &parent, const Field &field) const {
 	if (field.offset == 0xFFFFFFFF)
 		return;
 
@@ -487,8 +596,7 @@ void GFF4Struct::loadStructs(GFF4File &parent, Field &field) {
 	}
 }
 
-void GFF4Struct::loadGeneric(GFF4File &parent, Field &field) {
-	field.offset = getDataOffset(field.isList, field.offset);
+void GFF4Struct::loadGeneric(GFF4File &parent, const Field &field) const {
 	if (field.offset == 0xFFFFFFFF)
 		return;
 
@@ -531,13 +639,16 @@ void GFF4Struct::load(GFF4File &parent, const Field &genericParent) {
 
 		_fieldLabels.push_back(i);
 
-		// Load the field and its struct(s), if any
-		Field &f = _fields[i] = Field(i, fieldType, fieldFlags, fieldOffset, true);
-		if (f.type == kFieldTypeStruct)
-			loadStructs(parent, f);
+		// Load the field and its struct(s), if any. The labels are ascending, no need to sort
+		_fields.push_back(Field(i, fieldType, fieldFlags, fieldOffset, true));
+
+		const Field &f = _fields.back();
 		if (f.type == kFieldTypeGeneric)
 			throw Common::Exception("GFF4: Found a generic with type generic?");
 
+		if (!parent.isLazy())
+			getStructs(f);
+
 		if ((f.type == kFieldTypeASCIIString) && parent.hasSharedStrings())
 			throw Common::Exception("GFF4: TODO: ASCII string field in a file with shared strings");
 	}
@@ -600,11 +711,34 @@ bool GFF4Struct::getFieldProperties(uint32 field, FieldType &type, uint32 &label
 // --- Field value reader helpers ---
 
 const GFF4Struct::Field *GFF4Struct::getField(uint32 field) const {
-	FieldMap::const_iterator f = _fields.find(field);
-	if (f == _fields.end())
+	FieldList::const_iterator f = std::lower_bound(_fields.begin(), _fields.end(), field,
+	                                               [](const Field &a, uint32 label) {
+		return a.label < label;
+	});
+
+	if ((f == _fields.end()) || (f->label != field))
 		return 0;
 
-	return &f->second;
+	return &*f;
+}
+
+const GFF4List &GFF4Struct::getStructs(const Field &field) const {
+	if (field.structsLoaded)
+		return field.structs;
+
+	try {
+		if (field.type == kFieldTypeStruct)
+			loadStructs(*_parent, field);
+		else if (field.type == kFieldTypeGeneric)
+			loadGeneric(*_parent, field);
+	} catch (...) {
+		field.structs.clear();
+		throw;
+	}
+
+	field.structsLoaded = true;
+
+	return field.structs;
 }
 
 uint32 GFF4Struct::getDataOffset(bool isReference, uint32 offset) const {
@@ -1359,8 +1493,9 @@ const GFF4Struct *GFF4Struct::getStruct(uint32 field) const {
 	if (f->isList)
 		throw Common::Exception("GFF4: Tried reading list as singular value");
 
-	if (!f->structs.empty())
-		return f->structs[0];
+	const GFF4List &structs = getStructs(*f);
+	if (!structs.empty())
+		return structs[0];
 
 	return 0;
 }
@@ -1375,8 +1510,9 @@ const GFF4Struct *GFF4Struct::getGeneric(uint32 field) const {
 	if (f->type != kFieldTypeGeneric)
 		throw Common::Exception("GFF4: Field is not of generic type");
 
-	if (!f->structs.empty())
-		return f->structs[0];
+	const GFF4List &structs = getStructs(*f);
+	if (!structs.empty())
+		return structs[0];
 
 	return 0;
 }
@@ -1391,7 +1527,7 @@ const GFF4List &GFF4Struct::getList(uint32 field) const {
 	if (f->type != kFieldTypeStruct)
 		throw Common::Exception("GFF4: Field is not of struct type");
 
-	return f->structs;
+	return getStructs(*f);
 }
 
 // --- Struct data reader ---
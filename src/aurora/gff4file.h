@@ -26,7 +26,7 @@
 #define AURORA_GFF4FILE_H
 
 #include <vector>
-#include <map>
+#include <unordered_map>
 
 #include "external/glm/mat4x4.hpp"
 
@@ -36,6 +36,7 @@
 #include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
 #include "src/common/encoding.h"
+#include "src/common/memaccount.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/aurorafile.h"
@@ -87,17 +88,28 @@ class GFF4Struct;
  *    French, Italian, German and Spanish (EFIGS) versions have the strings
  *    in TLK files encoded in Windows CP-1252.
  *
+ *  A GFF4File can be loaded lazily. In that case, the whole GFF4 is held
+ *  in memory, and only the top-level struct is read when the GFF4File is
+ *  constructed. Every other struct and generic is read the first time it's
+ *  accessed through the struct (or generic) that references it, and the
+ *  strings in the shared string table are only decoded when requested. A
+ *  struct's getRefCount() then only counts the references that have been
+ *  followed so far. Just like the rest of GFF4File, this is not thread-safe.
+ *
  *  See also: GFF3File in gff3file.h for the earlier V3.2/V3.3 versions of
  *  the GFF format.
  */
 class GFF4File : boost::noncopyable, public AuroraFile {
 public:
 	/** Take over this stream and read a GFF4 file out of it. */
-	GFF4File(Common::SeekableReadStream *gff4, uint32 type = 0xFFFFFFFF);
+	GFF4File(Common::SeekableReadStream *gff4, uint32 type = 0xFFFFFFFF, bool lazy = false);
 	/** Request this resource from the ResourceManager and read a GFF4 file out of it. */
-	GFF4File(const Common::UString &gff4, FileType fileType, uint32 type = 0xFFFFFFFF);
+	GFF4File(const Common::UString &gff4, FileType fileType, uint32 type = 0xFFFFFFFF, bool lazy = false);
 	~GFF4File();
 
+	/** Are structs and shared strings only read when they're first accessed? */
+	bool isLazy() const;
+
 	/** Return the GFF4's specific type. */
 	uint32 getType() const;
 	/** Return the GFF4's specific type version. */
@@ -155,20 +167,39 @@ private:
 
 	typedef std::vector<StructTemplate> StructTemplates;
 	typedef std::vector<Common::UString> SharedStrings;
-	typedef std::map<uint64, GFF4Struct *> StructMap;
+
+	/** The location of a shared string, when they're loaded lazily. */
+	struct SharedStringData {
+		uint32 offset;
+		uint32 size;
+
+		bool decoded; ///< Has the string already been decoded into the table?
+	};
+
+	typedef std::vector<SharedStringData> SharedStringDatas;
+	typedef std::unordered_map<uint64, GFF4Struct *> StructMap;
 
 
 
 	Common::ScopedPtr<Common::SeekableReadStream> _origStream;
 	Common::ScopedPtr<Common::SeekableSubReadStreamEndian> _stream;
 
+	Common::MemoryAccount _streamMemory; ///< The memory of the GFF4's data.
+
 	/** This GFF4's header. */
 	Header          _header;
 	/** All struct templates in this GFF4. */
 	StructTemplates _structTemplates;
 
-	/** The shared strings used in V4.1. */
-	SharedStrings _sharedStrings;
+	/** Only load structs and shared strings when they're accessed? */
+	bool _lazy;
+	/** The whole GFF4, held in memory when loading lazily. */
+	const byte *_memory;
+
+	/** The shared strings used in V4.1. When loading lazily, filled on first access. */
+	mutable SharedStrings _sharedStrings;
+	/** The location of the shared strings used in V4.1, when loading lazily. */
+	mutable SharedStringDatas _sharedStringDatas;
 
 	/** All actual structs in this GFF4. */
 	StructMap   _structs;
@@ -181,6 +212,7 @@ private:
 	void loadHeader(uint32 type);
 	void loadStructs();
 	void loadStrings();
+	void loadStringsLazy();
 
 	void clear();
 	// '---
@@ -195,7 +227,7 @@ private:
 	uint32 getDataOffset() const;
 
 	bool hasSharedStrings() const;
-	Common::UString getSharedString(uint32 i) const;
+	const Common::UString &getSharedString(uint32 i) const;
 	// '---
 
 	friend class GFF4Struct;
@@ -360,17 +392,20 @@ private:
 		bool isGeneric { false };   ///< Is this field found in a generic?
 
 		uint16   structIndex { 0 }; ///< Index of the field's struct type (if kFieldTypeStruct).
-		GFF4List structs;           ///< List of GFF4Struct (if kFieldTypeStruct).
+
+		mutable GFF4List structs; ///< List of GFF4Struct (if kFieldTypeStruct or kFieldTypeGeneric).
+		mutable bool structsLoaded { false }; ///< Have the structs been loaded yet?
 
 		Field() = default;
 		Field(uint32 l, uint16 t, uint16 f, uint32 o, bool g = false);
 		~Field() = default;
 	};
 
-	typedef std::map<uint32, Field> FieldMap;
+	/** All fields of a struct, sorted by label. */
+	typedef std::vector<Field> FieldList;
 
 
-	const GFF4File *_parent;
+	GFF4File *_parent;
 
 	uint32 _label;
 
@@ -379,7 +414,7 @@ private:
 
 	size_t _fieldCount;
 
-	FieldMap _fields;
+	FieldList _fields;
 
 	/** The labels of all fields in this struct. */
 	std::vector<uint32> _fieldLabels;
@@ -393,17 +428,22 @@ private:
 	~GFF4Struct();
 
 	void load(GFF4File &parent, uint32 offset, const GFF4File::StructTemplate &tmplt);
-	void loadStructs(GFF4File &parent, Field &field);
-	void loadGeneric(GFF4File &parent, Field &field);
+	void loadStructs(GFF4File &parent, const Field &field) const;
+	void loadGeneric(GFF4File &parent, const Field &field) const;
 
 	void load(GFF4File &parent, const Field &genericParent);
 
+	void sortFields();
+
 	static uint64 generateID(uint32 offset, const GFF4File::StructTemplate *tmplt = 0);
 	// '---
 
 	// .--- Field and field data accessors
 	const Field *getField(uint32 field) const;
 
+	/** Return the structs of a struct or generic field, loading them if necessary. */
+	const GFF4List &getStructs(const Field &field) const;
+
 	uint32 getDataOffset(bool isReference, uint32 offset) const;
 	uint32 getDataOffset(const Field &field) const;
 
@@ -25,6 +25,8 @@
 #ifndef AURORA_GFXFILE_H
 #define AURORA_GFXFILE_H
 
+#include <map>
+
 #include <boost/variant.hpp>
 #include <boost/optional.hpp>
 
@@ -22,8 +22,10 @@
  *  Handling BioWare's LYTs (Layout files).
  */
 
+#include "src/common/scopedptr.h"
 #include "src/common/readstream.h"
-#include "src/common/streamtokenizer.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memorytokenizer.h"
 #include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/strutil.h"
@@ -45,7 +47,7 @@ void LYTFile::clear() {
 	_fileDependency.clear();
 }
 
-void LYTFile::assertTokenCount(const std::vector<Common::UString> &tokens, size_t n,
+void LYTFile::assertTokenCount(const std::vector<Common::TokenView> &tokens, size_t n,
                                const Common::UString &name) {
 
 	if (tokens.size() != n)
@@ -53,25 +55,28 @@ void LYTFile::assertTokenCount(const std::vector<Common::UString> &tokens, size_
 		                        name.c_str(), (uint)tokens.size());
 }
 
-void LYTFile::load(Common::SeekableReadStream &lyt) {
+void LYTFile::load(Common::SeekableReadStream &stream) {
 	clear();
 
-	Common::StreamTokenizer tokenizer(Common::StreamTokenizer::kRuleIgnoreAll);
+	Common::ScopedPtr<Common::MemoryReadStream> lytStream(stream.readStream(stream.size() - stream.pos()));
+	Common::MemoryReadStream &lyt = *lytStream;
+
+	Common::MemoryTokenizer tokenizer(Common::StreamTokenizer::kRuleIgnoreAll);
 	tokenizer.addSeparator(' ');
 	tokenizer.addChunkEnd('\n');
 	tokenizer.addIgnore('\r');
 
+	std::vector<Common::TokenView> strings;
 	while (!lyt.eos()) {
-		std::vector<Common::UString> strings;
 		tokenizer.getTokens(lyt, strings);
 
 		if (strings.empty()) {
 			// Empty line?
-		} else if (*strings[0].begin() == '#') {
+		} else if (strings[0][0] == '#') {
 			// Comment line
 		} else if (strings[0] == "filedependancy") {
 			// A clone2727 note: It's spelled "dependency", BioWare.
-			_fileDependency = strings[1];
+			_fileDependency = strings[1].toString();
 
 		} else if (strings[0] == "roomcount") {
 			// Rooms
@@ -79,7 +84,7 @@ void LYTFile::load(Common::SeekableReadStream &lyt) {
 			assertTokenCount(strings, 2, "roomcount");
 
 			int roomCount;
-			Common::parseString(strings[1], roomCount);
+			strings[1].parse(roomCount);
 			_rooms.resize(roomCount);
 
 			for (int i = 0; i < roomCount; i++) {
@@ -88,10 +93,10 @@ void LYTFile::load(Common::SeekableReadStream &lyt) {
 
 				assertTokenCount(strings, 4, "room");
 
-				_rooms[i].model = strings[0];
-				Common::parseString(strings[1], _rooms[i].x);
-				Common::parseString(strings[2], _rooms[i].y);
-				Common::parseString(strings[3], _rooms[i].z);
+				_rooms[i].model = strings[0].toString();
+				strings[1].parse(_rooms[i].x);
+				strings[2].parse(_rooms[i].y);
+				strings[3].parse(_rooms[i].z);
 				_rooms[i].canWalk = false;
 			}
 
@@ -101,7 +106,7 @@ void LYTFile::load(Common::SeekableReadStream &lyt) {
 			assertTokenCount(strings, 2, "trackcount");
 
 			int trackCount;
-			Common::parseString(strings[1], trackCount);
+			strings[1].parse(trackCount);
 
 			for (int i = 0; i < trackCount; i++)
 				tokenizer.nextChunk(lyt);
@@ -112,7 +117,7 @@ void LYTFile::load(Common::SeekableReadStream &lyt) {
 			assertTokenCount(strings, 2, "obstaclecount");
 
 			int obstacleCount;
-			Common::parseString(strings[1], obstacleCount);
+			strings[1].parse(obstacleCount);
 
 			for (int i = 0; i < obstacleCount; i++)
 				tokenizer.nextChunk(lyt);
@@ -123,7 +128,7 @@ void LYTFile::load(Common::SeekableReadStream &lyt) {
 			assertTokenCount(strings, 2, "artplaceablecount");
 
 			int artPlaceablesCount;
-			Common::parseString(strings[1], artPlaceablesCount);
+			strings[1].parse(artPlaceablesCount);
 			_artPlaceables.resize(artPlaceablesCount);
 
 			for (int i = 0; i < artPlaceablesCount; i++) {
@@ -132,10 +137,10 @@ void LYTFile::load(Common::SeekableReadStream &lyt) {
 
 				assertTokenCount(strings, 4, "artplaceable");
 
-				_artPlaceables[i].model = strings[0];
-				Common::parseString(strings[1], _artPlaceables[i].x);
-				Common::parseString(strings[2], _artPlaceables[i].y);
-				Common::parseString(strings[3], _artPlaceables[i].z);
+				_artPlaceables[i].model = strings[0].toString();
+				strings[1].parse(_artPlaceables[i].x);
+				strings[2].parse(_artPlaceables[i].y);
+				strings[3].parse(_artPlaceables[i].z);
 			}
 
 		} else if (strings[0] == "walkmeshRooms") {
@@ -144,7 +149,7 @@ void LYTFile::load(Common::SeekableReadStream &lyt) {
 			assertTokenCount(strings, 2, "walkmeshRooms");
 
 			int walkmeshRoomCount;
-			Common::parseString(strings[1], walkmeshRoomCount);
+			strings[1].parse(walkmeshRoomCount);
 
 			for (int i = 0; i < walkmeshRoomCount; i++) {
 				tokenizer.nextChunk(lyt);
@@ -152,8 +157,9 @@ void LYTFile::load(Common::SeekableReadStream &lyt) {
 
 				assertTokenCount(strings, 1, "walkmesh room");
 
+				const Common::UString walkmeshRoom = strings[0].toString();
 				for (size_t j = 0; j < _rooms.size(); j++) {
-					if (_rooms[j].model.equals(strings[0]))
+					if (_rooms[j].model.equals(walkmeshRoom))
 						_rooms[j].canWalk = true;
 				}
 			}
@@ -164,7 +170,7 @@ void LYTFile::load(Common::SeekableReadStream &lyt) {
 			assertTokenCount(strings, 2, "doorhookcount");
 
 			int doorHookCount;
-			Common::parseString(strings[1], doorHookCount);
+			strings[1].parse(doorHookCount);
 			_doorHooks.resize(doorHookCount);
 
 			for (int i = 0; i < doorHookCount; i++) {
@@ -173,17 +179,17 @@ void LYTFile::load(Common::SeekableReadStream &lyt) {
 
 				assertTokenCount(strings, 10, "doorHook");
 
-				_doorHooks[i].room = strings[0];
-				_doorHooks[i].name = strings[1];
-
-				Common::parseString(strings[2], _doorHooks[i].x);
-				Common::parseString(strings[3], _doorHooks[i].y);
-				Common::parseString(strings[4], _doorHooks[i].z);
-				Common::parseString(strings[5], _doorHooks[i].unk1);
-				Common::parseString(strings[6], _doorHooks[i].unk2);
-				Common::parseString(strings[7], _doorHooks[i].unk3);
-				Common::parseString(strings[8], _doorHooks[i].unk4);
-				Common::parseString(strings[9], _doorHooks[i].unk5);
+				_doorHooks[i].room = strings[0].toString();
+				_doorHooks[i].name = strings[1].toString();
+
+				strings[2].parse(_doorHooks[i].x);
+				strings[3].parse(_doorHooks[i].y);
+				strings[4].parse(_doorHooks[i].z);
+				strings[5].parse(_doorHooks[i].unk1);
+				strings[6].parse(_doorHooks[i].unk2);
+				strings[7].parse(_doorHooks[i].unk3);
+				strings[8].parse(_doorHooks[i].unk4);
+				strings[9].parse(_doorHooks[i].unk5);
 			}
 
 		} else if (strings[0] == "beginlayout") {
@@ -192,7 +198,7 @@ void LYTFile::load(Common::SeekableReadStream &lyt) {
 			// End parsing
 			break;
 		} else {
-			throw Common::Exception("LYTFile::load(): Unknown token %s", strings[0].c_str());
+			throw Common::Exception("LYTFile::load(): Unknown token %s", strings[0].toString().c_str());
 		}
 
 		tokenizer.nextChunk(lyt);
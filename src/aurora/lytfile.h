@@ -32,6 +32,7 @@
 
 namespace Common {
 	class SeekableReadStream;
+	class TokenView;
 }
 
 namespace Aurora {
@@ -109,7 +110,7 @@ private:
 	DoorHookArray _doorHooks;
 	Common::UString _fileDependency;
 
-	void assertTokenCount(const std::vector<Common::UString> &tokens, size_t n,
+	void assertTokenCount(const std::vector<Common::TokenView> &tokens, size_t n,
 	                      const Common::UString &name);
 };
 
@@ -25,12 +25,14 @@
 // Based on http://dsibrew.org/wiki/NDS_Format
 
 #include <cassert>
+#include <cstring>
 
 #include "src/common/util.h"
 #include "src/common/ustring.h"
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
 #include "src/common/readfile.h"
+#include "src/common/mappedfile.h"
 #include "src/common/encoding.h"
 
 #include "src/aurora/ndsrom.h"
@@ -38,13 +40,21 @@
 
 namespace Aurora {
 
-NDSFile::NDSFile(const Common::UString &fileName) {
-	_nds.reset(new Common::ReadFile(fileName));
+NDSFile::NDSFile(const Common::UString &fileName) : _data(0) {
+	try {
+		_mappedFile.reset(new Common::MappedFile(fileName));
+	} catch (...) {
+	}
+
+	if (_mappedFile)
+		_nds.reset(new Common::MemoryReadStream(_mappedFile->getData(), _mappedFile->size()));
+	else
+		_nds.reset(new Common::ReadFile(fileName));
 
 	load(*_nds);
 }
 
-NDSFile::NDSFile(Common::SeekableReadStream *nds) : _nds(nds) {
+NDSFile::NDSFile(Common::SeekableReadStream *nds) : _nds(nds), _data(0) {
 	assert(_nds);
 
 	load(*_nds);
@@ -74,20 +84,36 @@ void NDSFile::load(Common::SeekableReadStream &nds) {
 		throw;
 	}
 
+	// If the stream holds the whole ROM in memory, we can hand out views into it
+	nds.seek(0);
+	_data = nds.readInPlace(nds.size());
 }
 
 void NDSFile::readNames(Common::SeekableReadStream &nds, uint32 offset, uint32 length) {
+	if (length <= 8)
+		return;
+
+	if ((offset >= nds.size()) || ((nds.size() - offset) <= 8))
+		throw Common::Exception("File name table out of range (%u/%u)", offset, (uint)nds.size());
+
+	length = MIN<size_t>(length, nds.size() - offset) - 8;
+
+	// Read the whole name table at once and parse it in memory
 	nds.seek(offset + 8);
+	Common::ScopedPtr<Common::MemoryReadStream> names(nds.readStream(length));
 
-	uint32 index = 0;
-	while (((size_t)nds.pos()) < (size_t)(offset + length)) {
-		Resource res;
+	const byte *data = names->getData();
 
-		byte nameLength = nds.readByte();
-		if ((nameLength == 0) || ((size_t)nds.pos() >= (size_t)(offset + length)))
+	uint32 index = 0;
+	for (size_t pos = 0; pos < length; ) {
+		const byte nameLength = data[pos++];
+		if ((nameLength == 0) || (pos >= length) || ((length - pos) < nameLength))
 			break;
 
-		Common::UString name = Common::readStringFixed(nds, Common::kEncodingASCII, nameLength).toLower();
+		Common::UString name = Common::readString(data + pos, nameLength, Common::kEncodingASCII).toLower();
+		pos += nameLength;
+
+		Resource res;
 
 		res.name  = TypeMan.setFileType(name, kFileTypeNone);
 		res.type  = TypeMan.getFileType(name);
@@ -100,10 +126,15 @@ void NDSFile::readNames(Common::SeekableReadStream &nds, uint32 offset, uint32 l
 void NDSFile::readFAT(Common::SeekableReadStream &nds, uint32 offset) {
 	nds.seek(offset);
 
+	// Each FAT entry is a pair of start and end offsets
+	std::vector<uint32> fat(_resources.size() * 2);
+	if (!fat.empty())
+		nds.readArrayLE(&fat[0], fat.size());
+
 	_iResources.resize(_resources.size());
-	for (IResourceList::iterator res = _iResources.begin(); res != _iResources.end(); ++res) {
-		res->offset = nds.readUint32LE();
-		res->size   = nds.readUint32LE() - res->offset; // Value is the end offset
+	for (size_t i = 0; i < _iResources.size(); i++) {
+		_iResources[i].offset = fat[i * 2 + 0];
+		_iResources[i].size   = fat[i * 2 + 1] - fat[i * 2 + 0];
 	}
 }
 
@@ -166,7 +197,19 @@ uint32 NDSFile::getResourceSize(uint32 index) const {
 Common::SeekableReadStream *NDSFile::getResource(uint32 index, bool tryNoCopy) const {
 	const IResource &res = getIResource(index);
 
-	_nds->seek(res.offset);
+	if (_data) {
+		if ((res.offset > _nds->size()) || ((_nds->size() - res.offset) < res.size))
+			throw Common::Exception(Common::kReadError);
+
+		// The ROM is in memory: no need to touch the shared stream at all
+		if (tryNoCopy)
+			return new Common::MemoryReadStream(_data + res.offset, res.size);
+
+		Common::ScopedArray<byte> data(new byte[res.size]);
+		std::memcpy(data.get(), _data + res.offset, res.size);
+
+		return new Common::MemoryReadStream(data.release(), res.size, true);
+	}
 
 	if (tryNoCopy)
 		return new Common::SeekableSubReadStream(_nds.get(), res.offset, res.offset + res.size);
@@ -37,11 +37,19 @@
 namespace Common {
 	class UString;
 	class SeekableReadStream;
+	class MappedFile;
 }
 
 namespace Aurora {
 
-/** A class encapsulating Nintendo DS ROM access. */
+/** A class encapsulating Nintendo DS ROM access.
+ *
+ *  When opened from the filesystem, the ROM is mapped into memory.
+ *  Whenever the ROM data is held in memory (a mapped file or a stream
+ *  that keeps its data in memory), resources are handed out as views
+ *  directly into that data. These can be requested, and read, from
+ *  several threads at once.
+ */
 class NDSFile : public Archive {
 public:
 	/** Over this file in the filesystem and read a NDS file out of it. */
@@ -82,8 +90,14 @@ private:
 
 	typedef std::vector<IResource> IResourceList;
 
+	/** The mapped ROM file, if we could map it. */
+	Common::ScopedPtr<Common::MappedFile> _mappedFile;
+
 	Common::ScopedPtr<Common::SeekableReadStream> _nds;
 
+	/** The whole ROM data, if it's available in memory. */
+	const byte *_data;
+
 	Common::UString _title;
 	Common::UString _code;
 	Common::UString _maker;
@@ -39,6 +39,7 @@
 #include "src/common/readstream.h"
 #include "src/common/encoding.h"
 #include "src/common/debug.h"
+#include "src/common/trace.h"
 
 #include "src/aurora/resman.h"
 
@@ -276,13 +277,13 @@ void NCSFile::setupOpcodes() {
 
 #undef OPCODE
 
-NCSFile::NCSFile(Common::SeekableReadStream *ncs) : _script(ncs) {
+NCSFile::NCSFile(Common::SeekableReadStream *ncs) : _script(ncs), _scriptMemory(Common::kMemoryScripts) {
 	assert(_script);
 
 	load();
 }
 
-NCSFile::NCSFile(const Common::UString &ncs) : _name(ncs) {
+NCSFile::NCSFile(const Common::UString &ncs) : _name(ncs), _scriptMemory(Common::kMemoryScripts) {
 	_script.reset(ResMan.getResource(ncs, kFileTypeNCS));
 	if (!_script)
 		throw Common::Exception("No such NCS \"%s\"", ncs.c_str());
@@ -353,6 +354,8 @@ void NCSFile::load() {
 
 	setupOpcodes();
 
+	_scriptMemory.set(_script->size());
+
 	reset();
 }
 
@@ -381,6 +384,8 @@ const Variable &NCSFile::run(const ScriptState &state, Object *owner, Object *tr
 }
 
 const Variable &NCSFile::run(const ScriptState &state, const ObjectReference owner, const ObjectReference triggerer) {
+	TRACE_ZONE("NCSFile::run", "scripts");
+
 	debugC(kDebugScripts, 1, "=== Running script \"%s\" (%d) ===",
 	       _name.c_str(), state.offset);
 
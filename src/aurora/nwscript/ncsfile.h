@@ -30,6 +30,7 @@
 
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
+#include "src/common/memaccount.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/aurorafile.h"
@@ -184,6 +185,8 @@ private:
 	NCSStack _stack;
 	Common::ScopedPtr<Common::SeekableReadStream> _script;
 
+	Common::MemoryAccount _scriptMemory; ///< The memory of the script's bytecode.
+
 	Variable _return;
 
 	ObjectReference _owner;
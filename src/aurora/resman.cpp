@@ -33,6 +33,7 @@
 #include "src/common/filepath.h"
 #include "src/common/readfile.h"
 #include "src/common/writefile.h"
+#include "src/common/trace.h"
 
 #include "src/aurora/resman.h"
 #include "src/aurora/util.h"
@@ -107,7 +108,7 @@ bool ResourceManager::Resource::operator<(const Resource &right) const {
 
 
 ResourceManager::ResourceManager() : _hasSmall(false),
-	_hashAlgo(Common::kHashFNV64) {
+	_hashAlgo(Common::kHashFNV64), _resourceMemory(Common::kMemoryResources) {
 
 	// These file types are archives
 
@@ -199,6 +200,7 @@ void ResourceManager::clearResources() {
 	_openedArchives.clear();
 
 	_resources.clear();
+	_resourceMemory.set(0);
 
 	_changes.clear();
 }
@@ -594,6 +596,7 @@ void ResourceManager::undo(Common::ChangeID &changeID) {
 
 		// Remove the resource, and the name list too if it's empty
 		resChange->hashIt->second.erase(resChange->resIt);
+		_resourceMemory.remove(kResourceEntrySize);
 
 		if (resChange->hashIt->second.empty())
 			_resources.erase(resChange->hashIt);
@@ -761,6 +764,8 @@ Common::SeekableReadStream *ResourceManager::getResource(uint64 hash, FileType *
 }
 
 Common::SeekableReadStream *ResourceManager::getResource(const Resource &res, bool tryNoCopy) const {
+	TRACE_ZONE("ResourceManager::getResource", "resources");
+
 	Common::SeekableReadStream *stream = 0;
 
 	switch (res.source) {
@@ -898,7 +903,7 @@ inline uint64 ResourceManager::getHash(const Common::UString &name, FileType typ
 }
 
 inline uint64 ResourceManager::getHash(const Common::UString &name) const {
-	return Common::hashString(name.toLower(), _hashAlgo);
+	return Common::hashStringLower(name, _hashAlgo);
 }
 
 void ResourceManager::checkHashCollision(const Resource &resource, ResourceMap::const_iterator resList) {
@@ -971,6 +976,8 @@ void ResourceManager::addResource(Resource &resource, uint64 hash, Change *chang
 	resList->second.push_back(resource);
 	Resource *res = &resList->second.back();
 
+	_resourceMemory.add(kResourceEntrySize);
+
 	checkResourceIsArchive(*res, change);
 
 	// Remember the resource in the change set
@@ -36,6 +36,7 @@
 #include "src/common/filelist.h"
 #include "src/common/hash.h"
 #include "src/common/changeid.h"
+#include "src/common/memaccount.h"
 
 #include "src/aurora/types.h"
 
@@ -429,6 +430,9 @@ private:
 	typedef std::list<Resource> ResourceList;
 	/** Map over resources, indexed by their hashed name. */
 	typedef std::map<uint64, ResourceList> ResourceMap;
+
+	/** Approximate memory used by one entry in a resource list. */
+	static const size_t kResourceEntrySize = sizeof(Resource) + 2 * sizeof(void *);
 	// '---
 
 	// .--- Changes
@@ -494,6 +498,8 @@ private:
 	ResourceMap   _resources; ///< All currently known resources.
 	ChangeSetList _changes;   ///< Changes produced by indexing the currently known resources.
 
+	Common::MemoryAccount _resourceMemory; ///< Approximate memory used by the resource index.
+
 	FileTypeSet  _archiveTypeTypes [kArchiveMAX];  ///< All valid archive types file types.
 	FileTypeList _resourceTypeTypes[kResourceMAX]; ///< All valid resource type file types.
 
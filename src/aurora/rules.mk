@@ -51,6 +51,7 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/locstring.h \
     src/aurora/gff3file.h \
     src/aurora/gff3writer.h \
+    src/aurora/gff3batchwriter.h \
     src/aurora/gff4file.h \
     src/aurora/gff4fields.h \
     src/aurora/dlgfile.h \
@@ -99,6 +100,7 @@ src_aurora_libaurora_la_SOURCES += \
     src/aurora/locstring.cpp \
     src/aurora/gff3file.cpp \
     src/aurora/gff3writer.cpp \
+    src/aurora/gff3batchwriter.cpp \
     src/aurora/gff4file.cpp \
     src/aurora/dlgfile.cpp \
     src/aurora/lytfile.cpp \
@@ -23,11 +23,13 @@
  */
 
 #include <cassert>
+#include <cstring>
 
+#include "src/common/util.h"
 #include "src/common/scopedptr.h"
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
-#include "src/common/memwritestream.h"
+#include "src/common/writestream.h"
 
 #include "src/aurora/smallfile.h"
 
@@ -55,124 +57,218 @@ static void compress00(Common::ReadStream &in, Common::WriteStream &small, uint3
 	small.writeStream(in, size);
 }
 
+/** Input source for the LZSS decompression, reading byte by byte out of a stream. */
+class StreamSource {
+public:
+	StreamSource(Common::ReadStream &stream) : _stream(&stream) { }
+
+	byte readByte() {
+		return _stream->readByte();
+	}
+
+private:
+	Common::ReadStream *_stream;
+};
+
+/** Input source for the LZSS decompression, reading out of a memory buffer. */
+class MemorySource {
+public:
+	MemorySource(const byte *data, size_t size) : _data(data), _end(data + size) { }
+
+	byte readByte() {
+		if (_data >= _end)
+			throw Common::Exception(Common::kReadError);
+
+		return *_data++;
+	}
+
+private:
+	const byte *_data;
+	const byte *_end;
+};
+
 /* Simple LZSS 0x10 decompression.
  *
  * Code loosely based on DSDecmp by Barubary, released under the terms of the MIT license.
  *
  * See <https://github.com/gravgun/dsdecmp/blob/master/CSharp/DSDecmp/Formats/Nitro/LZ10.cs#L121>
  * and <https://code.google.com/p/dsdecmp/>.
+ *
+ * Since all the decompressed data ends up in the output buffer anyway, we
+ * copy straight out of the output buffer instead of keeping a separate
+ * ring buffer.
  */
-static void decompress10(Common::ReadStream &small, Common::WriteStream &out, uint32 size) {
-	byte   buffer[0x10000];
-	uint32 bufferPos = 0;
-
-	uint16 flags = 0xFF00;
-
+template<class Source>
+static void decompress10(Source &small, byte *out, uint32 size) {
 	uint32 outSize = 0;
 	while (outSize < size) {
-		// Only our canaries left => Read flags for the next 8 blocks
-		if (flags == 0xFF00)
-			flags = (small.readByte() << 8) | 0x00FF;
+		// Read flags for the next 8 blocks
+		byte flags = small.readByte();
+
+		for (int i = 0; (i < 8) && (outSize < size); i++, flags <<= 1) {
+			if (!(flags & 0x80)) {
+				// Literal byte
+				out[outSize++] = small.readByte();
+				continue;
+			}
 
-		if (flags & 0x8000) {
 			// Copy from buffer
 
 			const byte data1 = small.readByte();
 			const byte data2 = small.readByte();
 
 			// Copy how many bytes from where (relative) in the buffer?
-			const uint8  length = (data1 >> 4) + 3;
-			const uint16 offset = (((data1 & 0x0F) << 8) | data2) + 1;
-
-			// Direct offset. Add size of the buffer once, to protect from overroll
-			uint32 copyOffset = bufferPos + sizeof(buffer) - offset;
-
-			// Copy length bytes (and store each back into the buffer)
-			for (uint8 i = 0; i < length; i++, copyOffset++) {
-				if ((copyOffset % sizeof(buffer)) >= outSize)
-					throw Common::Exception("Tried to copy past the buffer");
-
-				const byte data = buffer[copyOffset % sizeof(buffer)];
+			const uint32 length = (data1 >> 4) + 3;
+			const uint32 offset = (((data1 & 0x0F) << 8) | data2) + 1;
+
+			if (offset > outSize)
+				throw Common::Exception("Tried to copy past the buffer");
+			if (length > (size - outSize))
+				throw Common::Exception("Invalid \"small\" data");
+
+			const byte *copySrc  = out + outSize - offset;
+			byte       *copyDest = out + outSize;
+
+			if (offset >= length) {
+				// No overlap
+				std::memcpy(copyDest, copySrc, length);
+			} else if (offset == 1) {
+				// Repeating a single byte
+				std::memset(copyDest, *copySrc, length);
+			} else {
+				// Overlapping, repeating a pattern. This needs to go byte by byte
+				for (uint32 j = 0; j < length; j++)
+					copyDest[j] = copySrc[j];
+			}
 
-				out.writeByte(data);
-				outSize++;
+			outSize += length;
+		}
+	}
+}
 
-				buffer[bufferPos] = data;
-				bufferPos = (bufferPos + 1) % sizeof(buffer);
-			}
+static void decompress10(Common::ReadStream &small, Common::WriteStream &out, uint32 size) {
+	Common::ScopedArray<byte> buffer(new byte[size]);
 
-		} else {
-			// Read literal byte
+	StreamSource source(small);
+	decompress10(source, buffer.get(), size);
 
-			const byte data = small.readByte();
+	out.write(buffer.get(), size);
+}
 
-			out.writeByte(data);
-			outSize++;
+/** The maximum displacement of an LZSS 0x10 block. */
+static const size_t kMaxDisplacement = 0x1000;
+/** The minimum displacement we use for an LZSS 0x10 block.
+ *
+ *  The format allows a displacement of 1, but, like the original tools, we
+ *  never produce it. Decompressors writing to VRAM, which can only be
+ *  written 16 bits at a time, can't handle a displacement of 1.
+ */
+static const size_t kMinDisplacement = 2;
+/** The minimum length of an LZSS 0x10 block. */
+static const size_t kMinLength = 3;
+/** The maximum length of an LZSS 0x10 block. */
+static const size_t kMaxLength = 0x12;
 
-			buffer[bufferPos] = data;
-			bufferPos = (bufferPos + 1) % sizeof(buffer);
-		}
+static const size_t kHashBits = 12;
+static const uint32 kHashNone = 0xFFFFFFFF;
 
-		flags <<= 1;
-	}
+/** Hash the kMinLength bytes that start a block. */
+static inline uint32 hashBlockStart(const byte *data) {
+	const uint32 key = (data[0] << 16) | (data[1] << 8) | data[2];
 
-	if (outSize != size)
-		throw Common::Exception("Invalid \"small\" data");
+	return (key * 2654435761U) >> (32 - kHashBits);
 }
 
-/** Determine the maximum size of an LZSS-compressed block.
- *
- *  Since this function supports continuously copying bytes from the "edge"
- *  of the current compression pointer (which is the main difference between
- *  LZSS and vanilla LZ77), both newPtr and oldPtr need to point into the
- *  same memory region.
+/** Hash chains over the positions in the LZSS window.
  *
- *  Takes O(newLength * oldLength) = O(n^2) time.
- *
- *  @param  newPtr The start of the data that needs to be compressed.
- *  @param  newLength The number of bytes that still need to be compressed.
- *  @param  oldPtr The start of the raw file.
- *  @param  oldLength The number of bytes already compressed.
- *  @param  displacement The offset of the start of the longest block to refer to.
- *  @param  minDisplacement The minimum allowed value for a valid displacement.
- *  @return The length of the longest sequence of bytes that can be copied from oldPtr.
+ *  For each hash of kMinLength bytes, we remember the latest position
+ *  starting with bytes of that hash, and for each position in the window
+ *  the previous position with the same hash. Only those positions can
+ *  start a block of at least kMinLength bytes.
  */
-size_t getOccurrenceLength(const byte *newPtr, size_t newLength,
-                           const byte *oldPtr, size_t oldLength,
-                           size_t &displacement, size_t minDisplacement = 1) {
-	displacement = 0;
-
-	// Can we actually do anything with the data?
-	if ((minDisplacement > oldLength) || (newLength == 0))
-		return 0;
-
-	size_t maxLength = 0;
-	for (size_t i = 0; i < oldLength - minDisplacement; i++) {
-		/* Try out every single possible displacement value, from the
-		 * start of the old data to the end. */
-
-		const byte *currentOldPtr = oldPtr + i;
-		size_t currentLength = 0;
-
-		/* Determine the length we can copy if we go back (oldLength - i) bytes.
-		 *  Always check the next newLength bytes, because we do LZSS. */
-		for (size_t j = 0; j < newLength; j++, currentLength++)
-			if (currentOldPtr[j] != newPtr[j])
-				break;
+class HashChains {
+public:
+	HashChains(const byte *data, size_t size) : _data(data), _size(size), _inserted(0) {
+		for (size_t i = 0; i < ARRAYSIZE(_head); i++)
+			_head[i] = kHashNone;
+		for (size_t i = 0; i < ARRAYSIZE(_prev); i++)
+			_prev[i] = kHashNone;
+	}
+
+	/** Add all positions up to pos (exclusive) to the chains. */
+	void insertUntil(size_t pos) {
+		for (; _inserted < pos; _inserted++) {
+			if ((_inserted + kMinLength) > _size)
+				continue;
 
-		if (currentLength > maxLength) {
-			// We've bettered our last try
-			maxLength = currentLength;
-			displacement = oldLength - i;
+			const uint32 hash = hashBlockStart(_data + _inserted);
 
-			// If we can't get any better than that, stop
-			if (maxLength == newLength)
+			_prev[_inserted % kMaxDisplacement] = _head[hash];
+			_head[hash] = _inserted;
+		}
+	}
+
+	/** Find the longest block at pos that can be copied from earlier in the data.
+	 *
+	 *  Of several equally long blocks, the one furthest back is taken. This is
+	 *  the same block the exhaustive search of the original tools finds, and so
+	 *  the compressed output is the same.
+	 *
+	 *  @param  pos The position in the data to find a block for.
+	 *  @param  displacement The displacement of the block found.
+	 *  @return The length of the block found, or 0 if there's none.
+	 */
+	size_t findBlock(size_t pos, size_t &displacement) {
+		insertUntil(pos);
+
+		displacement = 0;
+
+		const size_t maxLength = MIN(_size - pos, kMaxLength);
+		if (maxLength < kMinLength)
+			return 0;
+
+		const byte *newData = _data + pos;
+
+		size_t bestLength = 0;
+		for (uint32 candidate = _head[hashBlockStart(newData)]; candidate != kHashNone;
+		     candidate = _prev[candidate % kMaxDisplacement]) {
+
+			const size_t candidateDisplacement = pos - candidate;
+			if (candidateDisplacement > kMaxDisplacement)
 				break;
+
+			if (candidateDisplacement < kMinDisplacement)
+				continue;
+
+			const byte *oldData = _data + candidate;
+
+			// Check the byte that would make this block longer than the best one first
+			if ((bestLength > 0) && (oldData[bestLength - 1] != newData[bestLength - 1]))
+				continue;
+
+			size_t length = 0;
+			while ((length < maxLength) && (oldData[length] == newData[length]))
+				length++;
+
+			// Going from newer to older positions, so equally long blocks replace the best one
+			if ((length >= kMinLength) && (length >= bestLength)) {
+				bestLength   = length;
+				displacement = candidateDisplacement;
+			}
 		}
+
+		return bestLength;
 	}
 
-	return maxLength;
-}
+private:
+	const byte *_data;
+	size_t _size;
+
+	size_t _inserted; ///< Number of positions added to the chains.
+
+	uint32 _head[1 << kHashBits];  ///< Latest position for each hash.
+	uint32 _prev[kMaxDisplacement]; ///< Previous position with the same hash, for each position.
+};
 
 /* Simple LZSS 0x10 compression.
  *
@@ -180,12 +276,17 @@ size_t getOccurrenceLength(const byte *newPtr, size_t newLength,
  *
  * See <https://github.com/gravgun/dsdecmp/blob/master/CSharp/DSDecmp/Formats/Nitro/LZ10.cs#L249>
  * and <https://code.google.com/p/dsdecmp/>.
+ *
+ * Instead of trying out every position in the window, we only look at the
+ * positions that start with the same bytes, found through hash chains.
  */
 static void compress10(Common::ReadStream &in, Common::WriteStream &small, uint32 size) {
 	Common::ScopedArray<byte> inBuffer(new byte[size]);
 	if (in.read(inBuffer.get(), size) != size)
 		throw Common::Exception(Common::kReadError);
 
+	Common::ScopedPtr<HashChains> chains(new HashChains(inBuffer.get(), size));
+
 	// Buffer for 8 blocks (max. 2 bytes each), plus their flags byte
 	byte outBuffer[8 * 2 + 1] = { 0 };
 	size_t bufferedBlocks = 0, bufferLength = 1;
@@ -209,20 +310,14 @@ static void compress10(Common::ReadStream &in, Common::WriteStream &small, uint3
 		 * format supports) of the already compressed data, but only check the next
 		 * 0x12 bytes (the maximum copy length). */
 
-		const size_t newLength = MIN<size_t>(size - inRead, 0x12);
-		const size_t oldLength = MIN<size_t>(inRead, 0x1000);
-
 		size_t displacement = 0;
-		const size_t length =
-			getOccurrenceLength(inBuffer.get() + inRead            , newLength,
-			                    inBuffer.get() + inRead - oldLength, oldLength,
-			                    displacement);
+		const size_t length = chains->findBlock(inRead, displacement);
 
 		/* If the length of the occurrence is at least 3 bytes, we safe space by
 		 * referring to the earlier place in the data. If it's shorter (or even
 		 * non-existent), then just encode the next byte literally. */
 
-		if (length >= 3) {
+		if (length >= kMinLength) {
 			inRead += length;
 
 			// Mark the block as compressed
@@ -281,34 +376,54 @@ Common::SeekableReadStream *Small::decompress(Common::SeekableReadStream *small)
 		// Uncompressed. Just return a sub stream for the raw data
 		return new Common::SeekableSubReadStream(in.release(), pos, pos + size, true);
 
-	Common::MemoryWriteStreamDynamic out(true, size);
+	Common::ScopedArray<byte> out(new byte[size]);
 
 	try {
-		::Aurora::decompress(*in, out, type, size);
+		if (type != 0x10)
+			throw Common::Exception("Unsupported type 0x%08X", (uint) type);
+
+		// We own the stream, so we can read all of the compressed data into memory in one go
+		const size_t packedSize = in->size() - pos;
+
+		Common::ScopedArray<byte> packed(new byte[packedSize]);
+		if (in->read(packed.get(), packedSize) != packedSize)
+			throw Common::Exception(Common::kReadError);
+
+		MemorySource source(packed.get(), packedSize);
+		decompress10(source, out.get(), size);
+
 	} catch (Common::Exception &e) {
 		e.add("Failed to decompress \"small\" file");
 		throw e;
 	}
 
-	out.setDisposable(false);
-	return new Common::MemoryReadStream(out.getData(), out.size(), true);
+	return new Common::MemoryReadStream(out.release(), size, true);
 }
 
 Common::SeekableReadStream *Small::decompress(Common::ReadStream &small) {
 	uint32 type, size;
 	readSmallHeader(small, type, size);
 
-	Common::MemoryWriteStreamDynamic out(true, size);
+	Common::ScopedArray<byte> out(new byte[size]);
 
 	try {
-		::Aurora::decompress(small, out, type, size);
+		if (type == 0x00) {
+			if (small.read(out.get(), size) != size)
+				throw Common::Exception(Common::kReadError);
+
+		} else if (type == 0x10) {
+			StreamSource source(small);
+			decompress10(source, out.get(), size);
+
+		} else
+			throw Common::Exception("Unsupported type 0x%08X", (uint) type);
+
 	} catch (Common::Exception &e) {
 		e.add("Failed to decompress \"small\" file");
 		throw e;
 	}
 
-	out.setDisposable(false);
-	return new Common::MemoryReadStream(out.getData(), out.size(), true);
+	return new Common::MemoryReadStream(out.release(), size, true);
 }
 
 Common::SeekableReadStream *Small::decompress(Common::ReadStream *small) {
@@ -43,7 +43,7 @@ static const uint32 kVersion05 = MKTAG('V', '0', '.', '5');
 namespace Aurora {
 
 TalkTable_GFF::TalkTable_GFF(Common::SeekableReadStream *tlk, Common::Encoding encoding) :
-	TalkTable(encoding) {
+	TalkTable(encoding), _huffmanLoaded(false) {
 
 	load(tlk);
 }
@@ -57,13 +57,17 @@ bool TalkTable_GFF::hasEntry(uint32 strRef) const {
 
 static const Common::UString kEmptyString = "";
 const Common::UString &TalkTable_GFF::getString(uint32 strRef) const {
-	Entries::iterator e = _entries.find(strRef);
-	if (e == _entries.end())
+	Entries::const_iterator e = _entries.find(strRef);
+	if ((e == _entries.end()) || !e->second)
 		return kEmptyString;
 
-	readString(*e->second);
+	std::lock_guard<std::mutex> lock(_mutex);
 
-	return e->second->text;
+	StringCache::const_iterator s = _strings.find(strRef);
+	if (s != _strings.end())
+		return s->second;
+
+	return _strings.insert(std::make_pair(strRef, readString(*e->second))).first->second;
 }
 
 const Common::UString &TalkTable_GFF::getSoundResRef(uint32 UNUSED(strRef)) const {
@@ -111,11 +115,7 @@ void TalkTable_GFF::load02(const GFF4Struct &top) {
 		if (strRef == 0xFFFFFFFF)
 			continue;
 
-		Common::ScopedPtr<Entry> entry(new Entry(*s));
-
-		std::pair<Entries::iterator, bool> result = _entries.insert(std::make_pair(strRef, entry.get()));
-		if (result.second)
-			entry.release();
+		_entries.insert(std::make_pair(strRef, *s));
 	}
 }
 
@@ -135,36 +135,34 @@ void TalkTable_GFF::load05(const GFF4Struct &top) {
 		if (strRef == 0xFFFFFFFF)
 			continue;
 
-		Common::ScopedPtr<Entry> entry(new Entry(*s));
-
-		std::pair<Entries::iterator, bool> result = _entries.insert(std::make_pair(strRef, entry.get()));
-		if (result.second)
-			entry.release();
+		_entries.insert(std::make_pair(strRef, *s));
 	}
 }
 
-void TalkTable_GFF::readString(Entry &entry) const {
-	if (!entry.strct)
-		return;
-
+Common::UString TalkTable_GFF::readString(const GFF4Struct &strct) const {
 	if      (_gff->getTypeVersion() == kVersion02)
-		readString02(entry);
+		return readString02(strct);
 	else if (_gff->getTypeVersion() == kVersion04)
-		readString05(entry, _gff->isBigEndian());
+		return readString05(strct);
 	else if (_gff->getTypeVersion() == kVersion05)
-		readString05(entry, _gff->isBigEndian());
+		return readString05(strct);
 
-	entry.strct = 0;
+	return "";
 }
 
-void TalkTable_GFF::readString02(Entry &entry) const {
+Common::UString TalkTable_GFF::readString02(const GFF4Struct &strct) const {
 	if (_encoding != Common::kEncodingInvalid)
-		entry.text = entry.strct->getString(kGFF4TalkString, _encoding);
-	else
-		entry.text = "[???]";
+		return strct.getString(kGFF4TalkString, _encoding);
+
+	return "[???]";
 }
 
-void TalkTable_GFF::readString05(Entry &entry, bool bigEndian) const {
+void TalkTable_GFF::loadHuffman() const {
+	if (_huffmanLoaded)
+		return;
+
+	_huffmanLoaded = true;
+
 	Common::ScopedPtr<Common::SeekableReadStream>
 		huffTree (_gff->getTopLevel().getData(kGFF4HuffTalkStringHuffTree)),
 		bitStream(_gff->getTopLevel().getData(kGFF4HuffTalkStringBitStream));
@@ -172,14 +170,30 @@ void TalkTable_GFF::readString05(Entry &entry, bool bigEndian) const {
 	if (!huffTree || !bitStream)
 		return;
 
+	const bool bigEndian = _gff->isBigEndian();
+
 	Common::SeekableSubReadStreamEndian huffTreeEndian(huffTree.get(), 0, huffTree->size(), bigEndian);
 	Common::SeekableSubReadStreamEndian bitStreamEndian(bitStream.get(), 0, bitStream->size(), bigEndian);
 
-	readString05(huffTreeEndian, bitStreamEndian, entry);
+	// Both streams share the same GFF stream, so we need to seek before reading
+	huffTreeEndian.seek(0);
+
+	_huffTree.resize(huffTreeEndian.size() / 4);
+	for (std::vector<int32>::iterator n = _huffTree.begin(); n != _huffTree.end(); ++n)
+		*n = huffTreeEndian.readSint32();
+
+	bitStreamEndian.seek(0);
+
+	_bitStream.resize(bitStreamEndian.size() / 4);
+	for (std::vector<uint32>::iterator b = _bitStream.begin(); b != _bitStream.end(); ++b)
+		*b = bitStreamEndian.readUint32();
 }
 
-void TalkTable_GFF::readString05(Common::SeekableSubReadStreamEndian &huffTree,
-                                 Common::SeekableSubReadStreamEndian &bitStream, Entry &entry) const {
+Common::UString TalkTable_GFF::readString05(const GFF4Struct &strct) const {
+	loadHuffman();
+
+	if (_huffTree.empty() || _bitStream.empty())
+		return "";
 
 	/* Read a string encoded in a Huffman'd bitstream.
 	 *
@@ -192,20 +206,25 @@ void TalkTable_GFF::readString05(Common::SeekableSubReadStreamEndian &huffTree,
 
 	std::vector<uint16> utf16Str;
 
-	const uint32 startOffset = entry.strct->getUint(kGFF4HuffTalkStringBitOffset);
+	const uint32 startOffset = strct.getUint(kGFF4HuffTalkStringBitOffset);
 
 	uint32 index = startOffset >> 5;
 	uint32 shift = startOffset & 0x1F;
 
 	do {
-		ptrdiff_t e = (huffTree.size() / 8) - 1;
+		ptrdiff_t e = (_huffTree.size() / 2) - 1;
 
 		while (e >= 0) {
-			bitStream.seek(index * 4);
-			const ptrdiff_t offset = (bitStream.readUint32() >> shift) & 1;
+			if (index >= _bitStream.size())
+				throw Common::Exception(Common::kReadError);
+
+			const ptrdiff_t offset = (_bitStream[index] >> shift) & 1;
+
+			const size_t node = (e * 2) + offset;
+			if (node >= _huffTree.size())
+				throw Common::Exception(Common::kReadError);
 
-			huffTree.seek(((e * 2) + offset) * 4);
-			e = huffTree.readSint32();
+			e = _huffTree[node];
 
 			shift++;
 			index += (shift >> 5);
@@ -220,7 +239,7 @@ void TalkTable_GFF::readString05(Common::SeekableSubReadStreamEndian &huffTree,
 	const byte  *data = reinterpret_cast<const byte *>(&utf16Str[0]);
 	const size_t size = utf16Str.size() * 2;
 
-	entry.text = Common::readString(data, size, Common::kEncodingUTF16LE);
+	return Common::readString(data, size, Common::kEncodingUTF16LE);
 }
 
 } // End of namespace Aurora
@@ -26,18 +26,19 @@
 #define AURORA_TALKTABLE_GFF_H
 
 #include <map>
+#include <vector>
+#include <unordered_map>
 
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
-#include "src/common/ptrmap.h"
 #include "src/common/ustring.h"
+#include "src/common/mutex.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/talktable.h"
 
 namespace Common {
 	class SeekableReadStream;
-	class SeekableSubReadStreamEndian;
 }
 
 namespace Aurora {
@@ -56,6 +57,11 @@ namespace Aurora {
  *  - V0.2, used by Sonic Chronicles and Dragon Age: Origins (PC)
  *  - V0.4, used by Dragon Age: Origins (Xbox 360)
  *  - V0.5, used by Dragon Age II
+ *
+ *  Strings are decoded on first access and then cached. For V0.4 and
+ *  V0.5, the Huffman tree and bitstream are read once, on the first
+ *  string access. All of this is guarded by a mutex, so a GFF'd talk
+ *  table can be safely queried from several threads.
  */
 class TalkTable_GFF : public TalkTable {
 public:
@@ -72,31 +78,32 @@ public:
 
 
 private:
-	struct Entry {
-		Common::UString text;
+	typedef std::map<uint32, const GFF4Struct *> Entries;
+	typedef std::unordered_map<uint32, Common::UString> StringCache;
 
-		const GFF4Struct *strct;
 
-		Entry(const GFF4Struct *s = 0) : strct(s) { }
-	};
+	Common::ScopedPtr<GFF4File> _gff;
 
-	typedef Common::PtrMap<uint32, Entry> Entries;
+	Entries _entries;
 
+	mutable StringCache _strings; ///< Already decoded strings.
 
-	Common::ScopedPtr<GFF4File> _gff;
+	mutable bool _huffmanLoaded;           ///< Have we read the Huffman data yet?
+	mutable std::vector<int32>  _huffTree;  ///< The Huffman tree nodes (V0.4/V0.5).
+	mutable std::vector<uint32> _bitStream; ///< The Huffman'd string bitstream (V0.4/V0.5).
 
-	mutable Entries _entries;
+	/** Mutex guarding the caches and the GFF. */
+	mutable std::mutex _mutex;
 
 	void load(Common::SeekableReadStream *tlk);
 	void load02(const GFF4Struct &top);
 	void load05(const GFF4Struct &top);
 
-	void readString(Entry &entry) const;
-	void readString02(Entry &entry) const;
-	void readString05(Entry &entry, bool bigEndian) const;
+	void loadHuffman() const;
 
-	void readString05(Common::SeekableSubReadStreamEndian &huffTree,
-	                  Common::SeekableSubReadStreamEndian &bitStream, Entry &entry) const;
+	Common::UString readString(const GFF4Struct &strct) const;
+	Common::UString readString02(const GFF4Struct &strct) const;
+	Common::UString readString05(const GFF4Struct &strct) const;
 };
 
 } // End of namespace Aurora
@@ -29,6 +29,7 @@
 #include <cassert>
 
 #include "src/common/util.h"
+#include "src/common/endianness.h"
 #include "src/common/strutil.h"
 #include "src/common/memreadstream.h"
 #include "src/common/readfile.h"
@@ -44,7 +45,8 @@ static const uint32 kVersion4 = MKTAG('V', '4', '.', '0');
 namespace Aurora {
 
 TalkTable_TLK::TalkTable_TLK(Common::SeekableReadStream *tlk, Common::Encoding encoding) :
-	TalkTable(encoding), _tlk(tlk) {
+	TalkTable(encoding), _tlk(tlk), _languageID(kLanguageInvalid), _entryCount(0), _entrySize(0),
+	_stringsOffset(0) {
 
 	assert(_tlk);
 
@@ -65,25 +67,28 @@ void TalkTable_TLK::load() {
 			throw Common::Exception("Unsupported TLK file version %s", Common::debugTag(_version).c_str());
 
 		_languageID = _tlk->readUint32LE();
-
-		uint32 stringCount = _tlk->readUint32LE();
-		_entries.resize(stringCount);
+		_entryCount = _tlk->readUint32LE();
 
 		// V4 added this field; it's right after the header in V3
 		uint32 tableOffset = 20;
 		if (_version == kVersion4)
 			tableOffset = _tlk->readUint32LE();
 
-		const uint32 stringsOffset = _tlk->readUint32LE();
+		_stringsOffset = _tlk->readUint32LE();
 
-		// Go to the table
-		_tlk->seek(tableOffset);
+		_entrySize = (_version == kVersion3) ? kEntrySizeV3 : kEntrySizeV4;
+
+		if ((tableOffset > _tlk->size()) || (_entryCount > ((_tlk->size() - tableOffset) / _entrySize)))
+			throw Common::Exception("Entry table doesn't fit into the TLK (%u entries)", _entryCount);
+
+		// Read in the whole entry table in one go
+		const size_t tableSize = _entryCount * _entrySize;
 
-		// Read in all the table data
-		if (_version == kVersion3)
-			readEntryTableV3(stringsOffset);
-		else
-			readEntryTableV4();
+		_entries.reset(new byte[tableSize]);
+
+		_tlk->seek(tableOffset);
+		if (_tlk->read(_entries.get(), tableSize) != tableSize)
+			throw Common::Exception(Common::kReadError);
 
 	} catch (Common::Exception &e) {
 		e.add("Failed reading TLK file");
@@ -91,32 +96,31 @@ void TalkTable_TLK::load() {
 	}
 }
 
-void TalkTable_TLK::readEntryTableV3(uint32 stringsOffset) {
-	for (Entries::iterator entry = _entries.begin(); entry != _entries.end(); ++entry) {
-		entry->flags          = _tlk->readUint32LE();
-		entry->soundResRef    = Common::readStringFixed(*_tlk, Common::kEncodingASCII, 16);
-		entry->volumeVariance = _tlk->readUint32LE();
-		entry->pitchVariance  = _tlk->readUint32LE();
-		entry->offset         = _tlk->readUint32LE() + stringsOffset;
-		entry->length         = _tlk->readUint32LE();
-		entry->soundLength    = _tlk->readIEEEFloatLE();
-		entry->soundID        = kFieldIDInvalid;
-	}
-}
+TalkTable_TLK::Entry TalkTable_TLK::getEntry(uint32 strRef) const {
+	assert(strRef < _entryCount);
 
-void TalkTable_TLK::readEntryTableV4() {
-	for (Entries::iterator entry = _entries.begin(); entry != _entries.end(); ++entry) {
-		entry->soundID = _tlk->readUint32LE();
-		entry->offset  = _tlk->readUint32LE();
-		entry->length  = _tlk->readUint16LE();
-		entry->flags   = kFlagTextPresent;
+	const byte *data = _entries.get() + strRef * _entrySize;
+
+	Entry entry;
+
+	if (_entrySize == kEntrySizeV3) {
+		entry.flags   = READ_LE_UINT32(data +  0);
+		entry.offset  = READ_LE_UINT32(data + 28) + _stringsOffset;
+		entry.length  = READ_LE_UINT32(data + 32);
+		entry.soundID = kFieldIDInvalid;
+	} else {
+		entry.soundID = READ_LE_UINT32(data + 0);
+		entry.offset  = READ_LE_UINT32(data + 4);
+		entry.length  = READ_LE_UINT16(data + 8);
+		entry.flags   = kFlagTextPresent;
 	}
+
+	return entry;
 }
 
-void TalkTable_TLK::readString(Entry &entry) const {
-	if (!entry.text.empty() || (entry.length == 0) || !(entry.flags & kFlagTextPresent))
-		// We already have the string
-		return;
+Common::UString TalkTable_TLK::readString(const Entry &entry) const {
+	if ((entry.length == 0) || !(entry.flags & kFlagTextPresent))
+		return "";
 
 	assert(_tlk);
 
@@ -124,15 +128,15 @@ void TalkTable_TLK::readString(Entry &entry) const {
 
 	uint32 length = MIN<size_t>(entry.length, _tlk->size() - _tlk->pos());
 	if (length == 0)
-		return;
+		return "";
 
 	Common::ScopedPtr<Common::MemoryReadStream> data(_tlk->readStream(length));
 	Common::ScopedPtr<Common::MemoryReadStream> parsed(LangMan.preParseColorCodes(*data));
 
 	if (_encoding != Common::kEncodingInvalid)
-		entry.text = Common::readString(*parsed, _encoding);
-	else
-		entry.text = "[???]";
+		return Common::readString(*parsed, _encoding);
+
+	return "[???]";
 }
 
 uint32 TalkTable_TLK::getLanguageID() const {
@@ -140,31 +144,44 @@ uint32 TalkTable_TLK::getLanguageID() const {
 }
 
 bool TalkTable_TLK::hasEntry(uint32 strRef) const {
-	return strRef < _entries.size();
+	return strRef < _entryCount;
 }
 
 static const Common::UString kEmptyString = "";
 const Common::UString &TalkTable_TLK::getString(uint32 strRef) const {
-	if (strRef >= _entries.size())
+	if (strRef >= _entryCount)
 		return kEmptyString;
 
-	readString(_entries[strRef]);
+	std::lock_guard<std::mutex> lock(_mutex);
 
-	return _entries[strRef].text;
+	StringCache::const_iterator s = _strings.find(strRef);
+	if (s != _strings.end())
+		return s->second;
+
+	return _strings.insert(std::make_pair(strRef, readString(getEntry(strRef)))).first->second;
 }
 
 const Common::UString &TalkTable_TLK::getSoundResRef(uint32 strRef) const {
-	if (strRef >= _entries.size())
+	if ((strRef >= _entryCount) || (_entrySize != kEntrySizeV3))
 		return kEmptyString;
 
-	return _entries[strRef].soundResRef;
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	StringCache::const_iterator s = _soundResRefs.find(strRef);
+	if (s != _soundResRefs.end())
+		return s->second;
+
+	const byte *soundResRef = _entries.get() + strRef * _entrySize + 4;
+
+	return _soundResRefs.insert(std::make_pair(strRef,
+			Common::readString(soundResRef, 16, Common::kEncodingASCII))).first->second;
 }
 
 uint32 TalkTable_TLK::getSoundID(uint32 strRef) const {
-	if (strRef >= _entries.size())
+	if (strRef >= _entryCount)
 		return kFieldIDInvalid;
 
-	return _entries[strRef].soundID;
+	return getEntry(strRef).soundID;
 }
 
 uint32 TalkTable_TLK::getLanguageID(Common::SeekableReadStream &tlk) {
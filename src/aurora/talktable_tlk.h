@@ -25,11 +25,12 @@
 #ifndef AURORA_TALKTABLE_TLK_H
 #define AURORA_TALKTABLE_TLK_H
 
-#include <vector>
+#include <unordered_map>
 
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
+#include "src/common/mutex.h"
 
 #include "src/aurora/aurorafile.h"
 #include "src/aurora/talktable.h"
@@ -49,6 +50,12 @@ namespace Aurora {
  *  - V3.0, used by Neverwinter Nights, Neverwinter Nights 2, Knight of
  *    the Old Republic, Knight of the Old Republic II and The Witcher
  *  - V4.0, used by Jade Empire
+ *
+ *  The entry table is kept in memory as one block of raw, fixed-size
+ *  entry headers, which are only decoded when an entry is requested.
+ *  Strings are read and decoded on first access and then cached. Both
+ *  the string reading and the cache are guarded by a mutex, so a TLK
+ *  can be safely queried from several threads.
  */
 class TalkTable_TLK : public AuroraFile, public TalkTable {
 public:
@@ -78,38 +85,45 @@ private:
 		kFlagSoundLengthPresent = (1 << 2)
 	};
 
-	/** A talk resource entry. */
+	/** Size of an entry header in a V3.0 TLK, in bytes. */
+	static const size_t kEntrySizeV3 = 40;
+	/** Size of an entry header in a V4.0 TLK, in bytes. */
+	static const size_t kEntrySizeV4 = 10;
+
+	/** A talk resource entry, decoded out of its raw header. */
 	struct Entry {
-		Common::UString text;
 		uint32 offset;
 		uint32 length;
-
-		// V3
 		uint32 flags;
-		Common::UString soundResRef;
-		uint32 volumeVariance; // Unused
-		uint32 pitchVariance; // Unused
-		float soundLength; // In seconds
 
-		// V4
-		uint32 soundID;
+		uint32 soundID; // V4
 	};
 
-	typedef std::vector<Entry> Entries;
+	typedef std::unordered_map<uint32, Common::UString> StringCache;
 
 
 	Common::ScopedPtr<Common::SeekableReadStream> _tlk;
 
 	uint32 _languageID;
 
-	mutable Entries _entries;
+	uint32 _entryCount;    ///< The number of entries in the table.
+	size_t _entrySize;     ///< The size of a single raw entry header.
+	uint32 _stringsOffset; ///< Offset to the string data (V3 only).
+
+	/** The raw entry headers, decoded on demand. */
+	Common::ScopedArray<byte> _entries;
+
+	mutable StringCache _strings;      ///< Already read and decoded strings.
+	mutable StringCache _soundResRefs; ///< Already decoded sound ResRefs.
+
+	/** Mutex guarding the TLK stream and the caches. */
+	mutable std::mutex _mutex;
 
 	void load();
 
-	void readEntryTableV3(uint32 stringsOffset);
-	void readEntryTableV4();
+	Entry getEntry(uint32 strRef) const;
 
-	void readString(Entry &entry) const;
+	Common::UString readString(const Entry &entry) const;
 };
 
 } // End of namespace Aurora
@@ -22,8 +22,10 @@
  *  Handling BioWare's VISs (Visibility files).
  */
 
+#include "src/common/scopedptr.h"
 #include "src/common/readstream.h"
-#include "src/common/streamtokenizer.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memorytokenizer.h"
 #include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/strutil.h"
@@ -42,16 +44,19 @@ void VISFile::clear() {
 	_map.clear();
 }
 
-void VISFile::load(Common::SeekableReadStream &vis) {
+void VISFile::load(Common::SeekableReadStream &stream) {
 	clear();
 
-	Common::StreamTokenizer tokenizer(Common::StreamTokenizer::kRuleIgnoreAll);
+	Common::ScopedPtr<Common::MemoryReadStream> visStream(stream.readStream(stream.size() - stream.pos()));
+	Common::MemoryReadStream &vis = *visStream;
+
+	Common::MemoryTokenizer tokenizer(Common::StreamTokenizer::kRuleIgnoreAll);
 	tokenizer.addSeparator(' ');
 	tokenizer.addChunkEnd('\n');
 	tokenizer.addIgnore('\r');
 
+	std::vector<Common::TokenView> strings;
 	for (;;) {
-		std::vector<Common::UString> strings;
 		tokenizer.getTokens(vis, strings);
 
 		// Make sure we don't get any empty lines
@@ -70,12 +75,12 @@ void VISFile::load(Common::SeekableReadStream &vis) {
 		if (strings.size() > 2)
 			throw Common::Exception("Malformed VIS file");
 
-		Common::UString room = strings[0].toLower();
+		Common::UString room = strings[0].toString().toLower();
 		std::vector<Common::UString> visibilityArray;
 
 		int roomCount = 0;
 		if (strings.size() > 1)
-			Common::parseString(strings[1], roomCount);
+			strings[1].parse(roomCount);
 
 		int realRoomCount = 0;
 
@@ -101,7 +106,7 @@ void VISFile::load(Common::SeekableReadStream &vis) {
 				break;
 			}
 
-			visibilityArray.push_back(strings[0]);
+			visibilityArray.push_back(strings[0].toString());
 			realRoomCount++;
 		}
 
@@ -61,10 +61,22 @@ static void displayUsage(const Common::UString &name) {
 	std::printf("          --nologfile=BOOL    Don't write a log file.\n");
 	std::printf("          --consolelog=FILE   Write all debug console output into this file too.\n");
 	std::printf("          --noconsolelog=BOOL Don't write a debug console log file.\n");
+	std::printf("          --modelcache=BOOL   Cache ASCII models in a compiled binary form.\n");
+	std::printf("          --modelcachedir=DIR Store the compiled models in DIR.\n");
+	std::printf("          --warmmodels=BOOL   Compile all ASCII models when entering a module.\n");
+	std::printf("          --compactmeshes=BOOL\n");
+	std::printf("                              Store model vertices in smaller data types.\n");
+	std::printf("          --roomstreaming=BOOL\n");
+	std::printf("                              Only load the Dragon Age rooms around the camera.\n");
+	std::printf("          --roomstreambudget=SIZE\n");
+	std::printf("                              Memory budget for streamed rooms, in MB.\n");
+	std::printf("          --trace=FILE        Trace the whole session and write it into FILE.\n");
+	std::printf("          --memorylog=SECS    Log the memory usage every SECS seconds.\n");
 	std::printf("\n");
 	std::printf("FILE: Absolute or relative path to a file.\n");
 	std::printf("DIR:  Absolute or relative path to a directory.\n");
 	std::printf("SIZE: A positive integer.\n");
+	std::printf("SECS: A positive integer, in seconds.\n");
 	std::printf("BOOL: \"true\", \"yes\", \"y\", \"on\" and \"1\" are true, everything else is false.\n");
 	std::printf("VOL:  A double ranging from 0.0 (min) - 1.0 (max).\n");
 	std::printf("LANG: A language identifier. Full name, ISO 639-1 or ISO 639-2 language code;\n");
@@ -23,6 +23,7 @@
  */
 
 #include <cassert>
+#include <cstring>
 
 #include "src/common/util.h"
 #include "src/common/error.h"
@@ -335,34 +336,111 @@ static void blowfishECB(BlowfishContext &ctx, Mode mode, const byte *input, byte
 }
 // '--- Blowfish, based on the implementation from mbed TLS ---'
 
+/* Blocks in EBC mode are independent of each other, so we can work on
+ * several of them at the same time. Interleaving the rounds of 4 blocks
+ * lets the CPU overlap the S-box lookups of one block with the ones of
+ * the others, instead of waiting on the long dependency chain of the
+ * Feistel network of a single block. */
+static const size_t kInterleavedBlocks = 4;
+
+/** One Feistel round on 4 blocks. The roles of left and right alternate, so no swapping is needed. */
+#define BLOWFISH_ROUND4(a, b, p) \
+	a##0 ^= (p); b##0 ^= F(ctx, a##0); \
+	a##1 ^= (p); b##1 ^= F(ctx, a##1); \
+	a##2 ^= (p); b##2 ^= F(ctx, a##2); \
+	a##3 ^= (p); b##3 ^= F(ctx, a##3);
+
+static void blowfishEnc4(const BlowfishContext &ctx, uint32 (&xl)[kInterleavedBlocks], uint32 (&xr)[kInterleavedBlocks]) {
+	uint32 l0 = xl[0], l1 = xl[1], l2 = xl[2], l3 = xl[3];
+	uint32 r0 = xr[0], r1 = xr[1], r2 = xr[2], r3 = xr[3];
+
+	for (size_t i = 0; i < kRoundCount; i += 2) {
+		BLOWFISH_ROUND4(l, r, ctx.P[i    ])
+		BLOWFISH_ROUND4(r, l, ctx.P[i + 1])
+	}
+
+	xl[0] = r0 ^ ctx.P[kRoundCount + 1]; xr[0] = l0 ^ ctx.P[kRoundCount];
+	xl[1] = r1 ^ ctx.P[kRoundCount + 1]; xr[1] = l1 ^ ctx.P[kRoundCount];
+	xl[2] = r2 ^ ctx.P[kRoundCount + 1]; xr[2] = l2 ^ ctx.P[kRoundCount];
+	xl[3] = r3 ^ ctx.P[kRoundCount + 1]; xr[3] = l3 ^ ctx.P[kRoundCount];
+}
+
+static void blowfishDec4(const BlowfishContext &ctx, uint32 (&xl)[kInterleavedBlocks], uint32 (&xr)[kInterleavedBlocks]) {
+	uint32 l0 = xl[0], l1 = xl[1], l2 = xl[2], l3 = xl[3];
+	uint32 r0 = xr[0], r1 = xr[1], r2 = xr[2], r3 = xr[3];
+
+	for (size_t i = kRoundCount + 1; i > 1; i -= 2) {
+		BLOWFISH_ROUND4(l, r, ctx.P[i    ])
+		BLOWFISH_ROUND4(r, l, ctx.P[i - 1])
+	}
+
+	xl[0] = r0 ^ ctx.P[0]; xr[0] = l0 ^ ctx.P[1];
+	xl[1] = r1 ^ ctx.P[0]; xr[1] = l1 ^ ctx.P[1];
+	xl[2] = r2 ^ ctx.P[0]; xr[2] = l2 ^ ctx.P[1];
+	xl[3] = r3 ^ ctx.P[0]; xr[3] = l3 ^ ctx.P[1];
+}
+
+#undef BLOWFISH_ROUND4
+
+/** Encrypt/Decrypt a run of blocks in place. */
+static void blowfishECBBlocks(BlowfishContext &ctx, Mode mode, byte *data, size_t blockCount) {
+	for (; blockCount >= kInterleavedBlocks; blockCount -= kInterleavedBlocks) {
+		uint32 xl[kInterleavedBlocks], xr[kInterleavedBlocks];
+
+		for (size_t j = 0; j < kInterleavedBlocks; j++) {
+			xl[j] = READ_BE_UINT32(data + j * kBlockSize);
+			xr[j] = READ_BE_UINT32(data + j * kBlockSize + 4);
+		}
+
+		if (mode == kModeDecrypt)
+			blowfishDec4(ctx, xl, xr);
+		else
+			blowfishEnc4(ctx, xl, xr);
+
+		for (size_t j = 0; j < kInterleavedBlocks; j++) {
+			WRITE_BE_UINT32(data + j * kBlockSize    , xl[j]);
+			WRITE_BE_UINT32(data + j * kBlockSize + 4, xr[j]);
+		}
+
+		data += kInterleavedBlocks * kBlockSize;
+	}
+
+	for (; blockCount > 0; blockCount--, data += kBlockSize)
+		blowfishECB(ctx, mode, data, data);
+}
+
+static void blowfishEBC(byte *data, size_t size, const std::vector<byte> &key, Mode mode) {
+	if ((size % kBlockSize) != 0)
+		throw Exception("Blowfish operates on blocks of 8 bytes (%u)", (uint) size);
+
+	BlowfishContext ctx;
+
+	blowfishSetKey(ctx, &key[0], key.size());
+
+	blowfishECBBlocks(ctx, mode, data, size / kBlockSize);
+}
+
 MemoryReadStream *blowfishEBC(SeekableReadStream &input, const std::vector<byte> &key, Mode mode) {
 	BlowfishContext ctx;
 
 	blowfishSetKey(ctx, &key[0], key.size());
 
-	size_t inputSize = input.size() - input.pos();
+	const size_t inputSize = input.size() - input.pos();
 
 	// Round up to the next multiple of the block size
 	const size_t outputSize = ((inputSize + kBlockSize - 1) / kBlockSize) * kBlockSize;
 
 	ScopedArray<byte> output(new byte[outputSize]);
 
-	byte buffer[kBlockSize];
-	byte *data = output.get();
-	while (inputSize > 0) {
-		const size_t toRead = MIN<size_t>(inputSize, kBlockSize);
-
-		if (input.read(buffer, toRead) != toRead)
-			throw Exception(kReadError);
+	// Read the whole input directly into the output buffer, and work in place there
 
-		if (toRead < kBlockSize)
-			std::memset(buffer + toRead, 0, kBlockSize - toRead);
+	if (input.read(output.get(), inputSize) != inputSize)
+		throw Exception(kReadError);
 
-		blowfishECB(ctx, mode, buffer, data);
+	if (outputSize > inputSize)
+		std::memset(output.get() + inputSize, 0, outputSize - inputSize);
 
-		data      += toRead;
-		inputSize -= toRead;
-	}
+	blowfishECBBlocks(ctx, mode, output.get(), outputSize / kBlockSize);
 
 	return new MemoryReadStream(output.release(), outputSize, true);
 }
@@ -378,4 +456,97 @@ MemoryReadStream *decryptBlowfishEBC(SeekableReadStream &input, const std::vecto
 	return blowfishEBC(input, key, kModeDecrypt);
 }
 
+void encryptBlowfishEBC(byte *data, size_t size, const std::vector<byte> &key) {
+	blowfishEBC(data, size, key, kModeEncrypt);
+}
+
+void decryptBlowfishEBC(byte *data, size_t size, const std::vector<byte> &key) {
+	blowfishEBC(data, size, key, kModeDecrypt);
+}
+
+
+BlowfishEBCDecryptStream::BlowfishEBCDecryptStream(ReadStream *parentStream, const std::vector<byte> &key,
+                                                   bool disposeParentStream) :
+	_parentStream(parentStream, disposeParentStream), _ctx(new BlowfishContext), _blockPos(kBlockSize) {
+
+	assert(parentStream);
+
+	blowfishSetKey(*_ctx, &key[0], key.size());
+}
+
+BlowfishEBCDecryptStream::~BlowfishEBCDecryptStream() {
+}
+
+bool BlowfishEBCDecryptStream::eos() const {
+	return (_blockPos >= kBlockSize) && _parentStream->eos();
+}
+
+void BlowfishEBCDecryptStream::decryptBlock(size_t size) {
+	if (size < kBlockSize)
+		std::memset(_block + size, 0, kBlockSize - size);
+
+	blowfishECBBlocks(*_ctx, kModeDecrypt, _block, 1);
+
+	_blockPos = 0;
+}
+
+size_t BlowfishEBCDecryptStream::readBlock(byte *data, size_t dataSize) {
+	const size_t fromBlock = MIN(dataSize, kBlockSize - _blockPos);
+
+	std::memcpy(data, _block + _blockPos, fromBlock);
+	_blockPos += fromBlock;
+
+	return fromBlock;
+}
+
+size_t BlowfishEBCDecryptStream::read(void *dataPtr, size_t dataSize) {
+	byte *data = reinterpret_cast<byte *>(dataPtr);
+
+	// Left-overs from the last decrypted block
+	const size_t fromBlock = readBlock(data, dataSize);
+
+	data     += fromBlock;
+	dataSize -= fromBlock;
+
+	size_t total = fromBlock;
+
+	// Complete blocks are read and decrypted directly within the caller's buffer
+	const size_t fullSize = (dataSize / kBlockSize) * kBlockSize;
+	if (fullSize > 0) {
+		const size_t fullRead   = _parentStream->read(data, fullSize);
+		const size_t blocksSize = (fullRead / kBlockSize) * kBlockSize;
+
+		blowfishECBBlocks(*_ctx, kModeDecrypt, data, blocksSize / kBlockSize);
+
+		data     += blocksSize;
+		dataSize -= blocksSize;
+		total    += blocksSize;
+
+		if (fullRead != fullSize) {
+			// The parent stream ended within a block. Pad and decrypt what's left of it
+			if (fullRead > blocksSize) {
+				std::memcpy(_block, data, fullRead - blocksSize);
+				decryptBlock(fullRead - blocksSize);
+
+				total += readBlock(data, dataSize);
+			}
+
+			return total;
+		}
+	}
+
+	// A partial block at the end goes through our own block buffer
+	if (dataSize > 0) {
+		const size_t blockRead = _parentStream->read(_block, kBlockSize);
+		if (blockRead == 0)
+			return total;
+
+		decryptBlock(blockRead);
+
+		total += readBlock(data, dataSize);
+	}
+
+	return total;
+}
+
 } // End of namespace Common
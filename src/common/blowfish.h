@@ -28,17 +28,65 @@
 #include <vector>
 
 #include "src/common/types.h"
+#include "src/common/scopedptr.h"
+#include "src/common/disposableptr.h"
+#include "src/common/readstream.h"
 
 namespace Common {
 
-class SeekableReadStream;
 class MemoryReadStream;
 
+struct BlowfishContext;
+
 /** Encrypt the stream with the Blowfish algorithm in EBC mode. */
 MemoryReadStream *encryptBlowfishEBC(SeekableReadStream &input, const std::vector<byte> &key);
 /** Decrypt the stream with the Blowfish algorithm in EBC mode. */
 MemoryReadStream *decryptBlowfishEBC(SeekableReadStream &input, const std::vector<byte> &key);
 
+/** Encrypt the data in place with the Blowfish algorithm in EBC mode.
+ *
+ *  The size of the data has to be a multiple of 8 bytes.
+ */
+void encryptBlowfishEBC(byte *data, size_t size, const std::vector<byte> &key);
+/** Decrypt the data in place with the Blowfish algorithm in EBC mode.
+ *
+ *  The size of the data has to be a multiple of 8 bytes.
+ */
+void decryptBlowfishEBC(byte *data, size_t size, const std::vector<byte> &key);
+
+/** A stream that decrypts another stream with the Blowfish algorithm in EBC mode while reading.
+ *
+ *  The data is decrypted in place, directly within the buffer passed to
+ *  read(). This way, encrypted data can be fed into a decompressor without
+ *  first creating a decrypted copy of the whole data.
+ *
+ *  Like decryptBlowfishEBC(), a partial block at the end of the parent
+ *  stream is padded with zeros and decrypted as a whole block.
+ */
+class BlowfishEBCDecryptStream : public ReadStream {
+public:
+	BlowfishEBCDecryptStream(ReadStream *parentStream, const std::vector<byte> &key,
+	                         bool disposeParentStream = false);
+	~BlowfishEBCDecryptStream();
+
+	bool eos() const;
+
+	size_t read(void *dataPtr, size_t dataSize);
+
+private:
+	DisposablePtr<ReadStream> _parentStream;
+
+	ScopedPtr<BlowfishContext> _ctx;
+
+	byte   _block[8]; ///< The current, decrypted block.
+	size_t _blockPos; ///< Position within the current block. 8 if none is left.
+
+	/** Pad the first size bytes in the block buffer with zeros and decrypt them. */
+	void decryptBlock(size_t size);
+	/** Copy what's left of the current block into data. */
+	size_t readBlock(byte *data, size_t dataSize);
+};
+
 } // End of namespace Common
 
 #endif // COMMON_BLOWFISH_H
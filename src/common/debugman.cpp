@@ -24,6 +24,12 @@
  *  The debug manager, managing debug channels.
  */
 
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
 #include "src/version/version.h"
 
 #include "src/common/maths.h"
@@ -32,7 +38,6 @@
 #include "src/common/filepath.h"
 #include "src/common/debugman.h"
 #include "src/common/configman.h"
-#include "src/common/datetime.h"
 
 DECLARE_SINGLETON(Common::DebugManager)
 
@@ -69,7 +74,68 @@ static const char * const kDebugGLTypes[kDebugGLTypeMAX] = {
 	"Error", "Deprecated", "Undefined", "Portability", "Performance", "Other"
 };
 
-DebugManager::DebugManager() : _logFileStartLine(false), _changedConfig(false) {
+/** Maximum time in milliseconds a log line waits before the writer picks it up. */
+static const uint32 kLogWriterInterval = 50;
+
+/** Size of a line's header within a log ring: the time and the length. */
+static const size_t kLogLineHeaderSize = sizeof(uint64) + sizeof(uint32);
+
+static std::atomic<uint32> debugManagerInstances(0);
+
+static uint64 getSteadyTime() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int64 getWallTime() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+/** Copy data into a ring buffer, wrapping around at its end. */
+static void writeRing(byte *ring, size_t ringSize, size_t pos, const void *data, size_t size) {
+	pos %= ringSize;
+
+	const size_t first = MIN(size, ringSize - pos);
+
+	std::memcpy(ring + pos, data, first);
+	std::memcpy(ring, static_cast<const byte *>(data) + first, size - first);
+}
+
+/** Copy data out of a ring buffer, wrapping around at its end. */
+static void readRing(const byte *ring, size_t ringSize, size_t pos, void *data, size_t size) {
+	pos %= ringSize;
+
+	const size_t first = MIN(size, ringSize - pos);
+
+	std::memcpy(data, ring + pos, first);
+	std::memcpy(static_cast<byte *>(data) + first, ring, size - first);
+}
+
+
+DebugManager::LogRing::LogRing() : head(0), tail(0), lineOpen(false), lineTime(0) {
+}
+
+
+DebugManager::LogRingOwner::LogRingOwner() : ring(0), instanceID(0) {
+}
+
+DebugManager::LogRingOwner::~LogRingOwner() {
+	DebugManager *manager = _manager.load();
+	if (ring && manager && (manager->_instanceID == instanceID))
+		manager->releaseLogRing(*ring);
+}
+
+
+std::atomic<DebugManager *> DebugManager::_manager(0);
+
+thread_local DebugManager::LogRingOwner DebugManager::_threadLogRing;
+
+
+DebugManager::DebugManager() : _instanceID(++debugManagerInstances), _logFileOpen(false),
+	_logSteadyBase(0), _logWallBase(0), _lastStampSecond(-1), _logWriterRunning(false),
+	_logWriterStop(false), _changedConfig(false) {
+
 	for (size_t i = 0; i < kDebugChannelCount; i++) {
 		_channels[i].name        = kDebugNames[i];
 		_channels[i].description = kDebugDescriptions[i];
@@ -82,10 +148,20 @@ DebugManager::DebugManager() : _logFileStartLine(false), _changedConfig(false) {
 	}
 
 	_channelMap["all"] = kDebugChannelAll;
+
+	_manager.store(this);
 }
 
 DebugManager::~DebugManager() {
+	DebugManager *manager = this;
+	_manager.compare_exchange_strong(manager, 0);
+
 	closeLogFile();
+
+	/* Threads that are still running keep a pointer to their ring. But
+	 * they'll never use it again, because the instance ID won't match. */
+	for (std::vector<LogRing *>::iterator r = _logRings.begin(); r != _logRings.end(); ++r)
+		delete *r;
 }
 
 void DebugManager::getDebugChannels(std::vector<UString> &names, std::vector<UString> &descriptions) const {
@@ -220,8 +296,6 @@ void DebugManager::logDebugGL(DebugChannel channel, uint32 level, DebugGLType ty
 bool DebugManager::openLogFile(const UString &file) {
 	closeLogFile();
 
-	_logFileStartLine = true;
-
 	// Create the directories in the path, if necessary
 	UString path = FilePath::canonicalize(file);
 
@@ -231,8 +305,20 @@ bool DebugManager::openLogFile(const UString &file) {
 		return false;
 	}
 
-	if (!_logFile.open(path))
-		return false;
+	{
+		std::lock_guard<std::mutex> lock(_batchMutex);
+
+		if (!_logFile.open(path))
+			return false;
+
+		_logSteadyBase   = getSteadyTime();
+		_logWallBase     = getWallTime();
+		_lastStampSecond = -1;
+	}
+
+	_logFileOpen.store(true);
+
+	startLogWriter();
 
 	logString(Version::getProjectNameVersionFull());
 	logString("\n");
@@ -241,38 +327,297 @@ bool DebugManager::openLogFile(const UString &file) {
 }
 
 void DebugManager::closeLogFile() {
+	if (!_logFileOpen.exchange(false))
+		return;
+
+	stopLogWriter();
+
+	/* Write out the lines that are still in the process of being assembled.
+	 * Like opening, closing the log file is only done while no other threads
+	 * are logging, so we can touch their unfinished lines here. */
+	std::vector<LogRing *> rings;
+	{
+		std::lock_guard<std::mutex> lock(_logRingsMutex);
+		rings = _logRings;
+	}
+
+	for (std::vector<LogRing *>::iterator r = rings.begin(); r != rings.end(); ++r)
+		if ((*r)->lineOpen)
+			pushLine(**r);
+
+	writeBatch();
+
+	std::lock_guard<std::mutex> lock(_batchMutex);
 	_logFile.close();
 }
 
+void DebugManager::flushLogFile() {
+	if (_logFileOpen.load())
+		writeBatch();
+}
+
 void DebugManager::logString(const UString &str) {
-	if (!_logFile.isOpen())
+	logString(str.c_str());
+}
+
+void DebugManager::logString(const char *str) {
+	if (!str || !_logFileOpen.load(std::memory_order_relaxed))
+		return;
+
+	logData(str, std::strlen(str));
+}
+
+DebugManager::LogRing &DebugManager::getLogRing() {
+	LogRing *ring = _threadLogRing.ring;
+	if (ring && (_threadLogRing.instanceID == _instanceID))
+		return *ring;
+
+	std::lock_guard<std::mutex> lock(_logRingsMutex);
+
+	if (!_freeLogRings.empty()) {
+		ring = _freeLogRings.back();
+		_freeLogRings.pop_back();
+	} else {
+		ring = new LogRing;
+		_logRings.push_back(ring);
+	}
+
+	_threadLogRing.ring       = ring;
+	_threadLogRing.instanceID = _instanceID;
+
+	return *ring;
+}
+
+void DebugManager::releaseLogRing(LogRing &ring) {
+	/* The owning thread is ending. Finish the line it was still assembling,
+	 * so that it doesn't get lost. The lines already in the ring are picked up
+	 * by the writer as usual, even after another thread took over the ring. */
+	if (ring.lineOpen) {
+		if (_logFileOpen.load()) {
+			ring.line += '\n';
+			pushLine(ring);
+		}
+
+		ring.line.clear();
+		ring.lineOpen = false;
+	}
+
+	std::lock_guard<std::mutex> lock(_logRingsMutex);
+
+	_freeLogRings.push_back(&ring);
+}
+
+void DebugManager::logData(const char *str, size_t length) {
+	LogRing &ring = getLogRing();
+
+	// Assemble the string into lines, and hand over each line once it's complete
+	while (length > 0) {
+		if (!ring.lineOpen) {
+			ring.lineOpen = true;
+			ring.lineTime = getSteadyTime();
+		}
+
+		const char *lineEnd = static_cast<const char *>(std::memchr(str, '\n', length));
+		const size_t size   = lineEnd ? (lineEnd - str + 1) : length;
+
+		ring.line.append(str, size);
+
+		str    += size;
+		length -= size;
+
+		if (lineEnd)
+			pushLine(ring);
+	}
+}
+
+void DebugManager::pushLine(LogRing &ring) {
+	const size_t length = ring.line.size();
+	const size_t size   = kLogLineHeaderSize + length;
+
+	// Huge lines and lines logged without a writer thread skip the ring
+	if (!_logWriterRunning.load(std::memory_order_relaxed) || (size > (LogRing::kSize / 4))) {
+		writeLineDirect(ring);
 		return;
+	}
+
+	const size_t head = ring.head.load(std::memory_order_relaxed);
+
+	// If the ring is full, wait for the writer to make room
+	while ((head - ring.tail.load(std::memory_order_acquire) + size) > LogRing::kSize) {
+		if (!_logWriterRunning.load(std::memory_order_relaxed)) {
+			writeLineDirect(ring);
+			return;
+		}
+
+		_logWriterWake.notify_one();
+		std::this_thread::yield();
+	}
+
+	const uint64 time       = ring.lineTime;
+	const uint32 lineLength = length;
+
+	writeRing(ring.data, LogRing::kSize, head                 , &time      , sizeof(time));
+	writeRing(ring.data, LogRing::kSize, head + sizeof(time)  , &lineLength, sizeof(lineLength));
+	writeRing(ring.data, LogRing::kSize, head + kLogLineHeaderSize, ring.line.data(), length);
+
+	ring.head.store(head + size, std::memory_order_release);
+
+	ring.line.clear();
+	ring.lineOpen = false;
+
+	// Wake up the writer early if the ring is filling up
+	if ((head + size - ring.tail.load(std::memory_order_relaxed)) > (LogRing::kSize / 2))
+		_logWriterWake.notify_one();
+}
+
+void DebugManager::startLogWriter() {
+	_logWriterStop = false;
+
+	try {
+		_logWriter = std::thread(&DebugManager::logWriterThread, this);
+	} catch (...) {
+		// No writer thread, so the lines will be written directly
+		return;
+	}
+
+	_logWriterRunning.store(true);
+}
+
+void DebugManager::stopLogWriter() {
+	_logWriterRunning.store(false);
+
+	if (!_logWriter.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(_logWriterMutex);
+		_logWriterStop = true;
+	}
+
+	_logWriterWake.notify_one();
+	_logWriter.join();
+}
+
+void DebugManager::logWriterThread() {
+	std::unique_lock<std::mutex> lock(_logWriterMutex);
+
+	while (!_logWriterStop) {
+		_logWriterWake.wait_for(lock, std::chrono::milliseconds(kLogWriterInterval));
+
+		lock.unlock();
+		writeBatch();
+		lock.lock();
+	}
+}
+
+void DebugManager::writeBatch() {
+	std::lock_guard<std::mutex> lock(_batchMutex);
+
+	{
+		std::lock_guard<std::mutex> ringsLock(_logRingsMutex);
+		_batchRings = _logRings;
+	}
 
-	// If we're at the start of a new line, write the timestamp
-	if (_logFileStartLine) {
-		UString tstamp;
+	_batchHeads.resize(_batchRings.size());
+	_batchLines.clear();
+	_batchText.clear();
+
+	// Collect the pending lines of all rings
+	for (size_t i = 0; i < _batchRings.size(); i++) {
+		const LogRing &ring = *_batchRings[i];
+
+		const size_t head = ring.head.load(std::memory_order_acquire);
+		size_t pos = ring.tail.load(std::memory_order_relaxed);
+
+		while (pos < head) {
+			uint64 time;
+			uint32 length;
+
+			readRing(ring.data, LogRing::kSize, pos               , &time  , sizeof(time));
+			readRing(ring.data, LogRing::kSize, pos + sizeof(time), &length, sizeof(length));
+
+			LogLine line = { time, _batchText.size(), length };
+			_batchLines.push_back(line);
+
+			_batchText.resize(line.offset + length);
+			readRing(ring.data, LogRing::kSize, pos + kLogLineHeaderSize, &_batchText[line.offset], length);
+
+			pos += kLogLineHeaderSize + length;
+		}
+
+		_batchHeads[i] = head;
+	}
+
+	if (!_batchLines.empty()) {
+		/* Interleave the lines of the different threads by their time. The
+		 * sort is stable, so the lines of each thread stay in their order. */
+		std::stable_sort(_batchLines.begin(), _batchLines.end(), [](const LogLine &a, const LogLine &b) {
+			return a.time < b.time;
+		});
+
+		_batchOut.clear();
+		for (std::vector<LogLine>::const_iterator l = _batchLines.begin(); l != _batchLines.end(); ++l)
+			formatLine(l->time, _batchText.data() + l->offset, l->length);
 
 		try {
-			tstamp = "[" + DateTime(DateTime::kUTC).formatDateTimeISO('T', '-', ':') + "] ";
+			if (_logFile.isOpen()) {
+				_logFile.write(_batchOut.data(), _batchOut.size());
+				_logFile.flush();
+			}
 		} catch (...) {
-			tstamp = "[0000-00-00T00:00:00] ";
+			// There's nobody we could tell about this, so we drop the lines
 		}
+	}
+
+	// Only now are the lines out of the rings, so free up their space
+	for (size_t i = 0; i < _batchRings.size(); i++)
+		_batchRings[i]->tail.store(_batchHeads[i], std::memory_order_release);
+}
+
+void DebugManager::writeLineDirect(LogRing &ring) {
+	// Write all earlier lines first, so that the lines of this thread stay in order
+	writeBatch();
+
+	std::lock_guard<std::mutex> lock(_batchMutex);
+
+	_batchOut.clear();
+	formatLine(ring.lineTime, ring.line.data(), ring.line.size());
 
-		_logFile.writeString(tstamp);
+	try {
+		if (_logFile.isOpen()) {
+			_logFile.write(_batchOut.data(), _batchOut.size());
+			_logFile.flush();
+		}
+	} catch (...) {
 	}
 
-	_logFile.writeString(str);
+	ring.line.clear();
+	ring.lineOpen = false;
+}
+
+const std::string &DebugManager::formatTimestamp(uint64 time) {
+	const int64 wallTime = _logWallBase + ((int64) time - (int64) _logSteadyBase);
+	const int64 second   = (wallTime >= 0) ? (wallTime / 1000000000) : ((wallTime + 1) / 1000000000 - 1);
+
+	// Lines usually come in bursts, so we only need to format a new timestamp occasionally
+	if (second == _lastStampSecond)
+		return _lastStamp;
 
-	// Find out whether we just started a new line. If this fails, force one
 	try {
-		_logFileStartLine = !str.empty() && (*--str.end() == '\n');
+		_lastStamp = boost::posix_time::to_iso_extended_string(boost::posix_time::from_time_t((std::time_t) second));
 	} catch (...) {
-		_logFile.writeString("\n");
-		_logFileStartLine = true;
+		_lastStamp = "0000-00-00T00:00:00";
 	}
 
-	if (_logFileStartLine)
-		_logFile.flush();
+	_lastStampSecond = second;
+	return _lastStamp;
+}
+
+void DebugManager::formatLine(uint64 time, const char *text, size_t length) {
+	_batchOut += '[';
+	_batchOut += formatTimestamp(time);
+	_batchOut += "] ";
+	_batchOut.append(text, length);
 }
 
 void DebugManager::logCommandLine(const std::vector<UString> &argv) {
@@ -29,10 +29,19 @@
 
 #include <vector>
 #include <map>
+#include <string>
+#include <atomic>
+
+#if defined(__MINGW32__ ) && !defined(_GLIBCXX_HAS_GTHREADS)
+	#include "external/mingw-std-threads/mingw.thread.h"
+#else
+	#include <thread>
+#endif
 
 #include "src/common/types.h"
 #include "src/common/ustring.h"
 #include "src/common/singleton.h"
+#include "src/common/mutex.h"
 #include "src/common/writefile.h"
 
 namespace Common {
@@ -104,6 +113,12 @@ enum DebugGLType {
  *  exceeds the current level of C1, which is 3. Likewise, the level of
  *  message 3, 1, exceeds the current level of C2. In fact, with a
  *  current level of 0, no messages will be shown for C2 at all, ever.
+ *
+ *  Writing into the log file happens asynchronously. Every thread collects
+ *  its log lines in its own ring buffer, and a background writer thread
+ *  regularly moves the lines of all threads into the log file, flushing
+ *  it once per batch. Lines are stamped with a monotonic clock when they
+ *  are logged, and the timestamps are only formatted by the writer thread.
  */
 class DebugManager : public Singleton<DebugManager> {
 public:
@@ -154,11 +169,19 @@ public:
 	 *  string will be the first line written to the file.
 	 */
 	bool openLogFile(const UString &file);
-	/** Close the current log file. */
+	/** Close the current log file, writing out all pending log lines first. */
 	void closeLogFile();
 
+	/** Write all log lines that are still pending into the current log file.
+	 *
+	 *  This blocks until the lines have been written and flushed.
+	 */
+	void flushLogFile();
+
 	/** Log that string to the current log file. */
 	void logString(const UString &str);
+	/** Log that string to the current log file. */
+	void logString(const char *str);
 
 	/** Write the whole command line to the current log file. */
 	void logCommandLine(const std::vector<UString> &argv);
@@ -178,15 +201,102 @@ private:
 		uint32 glTypeIDs[kDebugGLTypeMAX];
 	};
 
+	/** A ring buffer collecting the log lines of one thread.
+	 *
+	 *  Only the owning thread ever writes into the ring and advances the head,
+	 *  and only the writer moves the tail, once the lines have been written.
+	 */
+	struct LogRing {
+		static const size_t kSize = 64 * 1024;
+
+		byte data[kSize];
+
+		std::atomic<size_t> head; ///< Total number of bytes ever written into the ring.
+		std::atomic<size_t> tail; ///< Total number of bytes ever written into the log file.
+
+		std::string line;     ///< The line currently being assembled by the owning thread.
+		bool        lineOpen; ///< Have we started assembling a line?
+		uint64      lineTime; ///< The monotonic time the current line was started at.
+
+		LogRing();
+	};
+
+	/** Hands a thread's log ring back to the manager when the thread ends. */
+	struct LogRingOwner {
+		LogRing *ring;
+		uint32 instanceID; ///< The instance of the manager the ring belongs to.
+
+		LogRingOwner();
+		~LogRingOwner();
+	};
+
+	/** A log line, collected from a ring by the writer. */
+	struct LogLine {
+		uint64 time;   ///< The monotonic time the line was started at.
+		size_t offset; ///< Offset of the line's text within the batch text.
+		size_t length; ///< Length of the line's text.
+	};
+
 	typedef std::map<UString, DebugChannel, UString::iless> ChannelMap;
 
 	Channel    _channels[kDebugChannelCount]; ///< All debug channels.
 	ChannelMap _channelMap;                   ///< Debug channels indexed by name.
 
+	/** Unique ID of this manager instance, to detect stale thread-local rings. */
+	const uint32 _instanceID;
+
+	/** The newest existing manager instance, if any. */
+	static std::atomic<DebugManager *> _manager;
+
+	/** The current thread's log ring, if it logged anything yet. */
+	static thread_local LogRingOwner _threadLogRing;
+
 	WriteFile _logFile;
-	bool _logFileStartLine;
+	std::atomic<bool> _logFileOpen;
+
+	uint64 _logSteadyBase; ///< Monotonic time the log file was opened at.
+	int64  _logWallBase;   ///< Wall-clock time the log file was opened at, in ns since the epoch.
+
+	int64       _lastStampSecond; ///< The second the last formatted timestamp is for.
+	std::string _lastStamp;       ///< The last formatted timestamp.
+
+	std::vector<LogRing *> _logRings;     ///< The rings of all threads that ever logged.
+	std::vector<LogRing *> _freeLogRings; ///< Rings of ended threads, to be reused by new threads.
+	std::mutex _logRingsMutex;            ///< Mutex protecting the ring lists.
+
+	std::vector<LogRing *> _batchRings; ///< The rings visited by the current batch.
+	std::vector<size_t>    _batchHeads; ///< The ring heads the current batch reads up to.
+	std::vector<LogLine>   _batchLines; ///< The lines of the current batch.
+	std::string _batchText; ///< The text of all lines of the current batch.
+	std::string _batchOut;  ///< The formatted output of the current batch.
+	std::mutex  _batchMutex; ///< Mutex protecting the batch and the log file.
+
+	std::thread _logWriter;
+	std::atomic<bool> _logWriterRunning;
+	bool _logWriterStop;
+	std::mutex _logWriterMutex;
+	std::condition_variable _logWriterWake;
 
 	bool _changedConfig;
+
+
+	LogRing &getLogRing();
+	void releaseLogRing(LogRing &ring);
+
+	void logData(const char *str, size_t length);
+	void pushLine(LogRing &ring);
+
+	void startLogWriter();
+	void stopLogWriter();
+	void logWriterThread();
+
+	/** Write all pending lines of all rings into the log file. */
+	void writeBatch();
+	/** Write all pending lines, then this one directly. */
+	void writeLineDirect(LogRing &ring);
+
+	const std::string &formatTimestamp(uint64 time);
+	void formatLine(uint64 time, const char *text, size_t length);
 };
 
 } // End of namespace Common
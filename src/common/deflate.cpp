@@ -31,6 +31,7 @@
 #include "src/common/scopedptr.h"
 #include "src/common/ptrvector.h"
 #include "src/common/memreadstream.h"
+#include "src/common/writestream.h"
 
 namespace Common {
 
@@ -128,15 +129,61 @@ byte *decompressDeflateWithoutOutputSize(const byte *data, size_t inputSize, siz
 }
 
 SeekableReadStream *decompressDeflate(ReadStream &input, size_t inputSize,
-                                      size_t outputSize, int windowBits) {
+                                      size_t outputSize, int windowBits, unsigned int frameSize) {
 
-	ScopedArray<byte> compressedData(new byte[inputSize]);
-	if (input.read(compressedData.get(), inputSize) != inputSize)
-		throw Exception(kReadError);
+	ScopedArray<byte> decompressedData(new byte[outputSize]);
+
+	z_stream strm;
+	BOOST_SCOPE_EXIT( (&strm) ) {
+			inflateEnd(&strm);
+	} BOOST_SCOPE_EXIT_END
+
+	initZStream(strm, windowBits, 0, 0);
+
+	// Set the output data pointer and size
+	strm.avail_out = outputSize;
+	strm.next_out  = decompressedData.get();
+
+	ScopedArray<byte> inputData(new byte[MIN<size_t>(inputSize, frameSize)]);
+
+	/* Read a frame from the input stream whenever zlib has consumed the
+	 * previous one, until the whole input has been read. */
+
+	int zResult = Z_OK;
+	while (zResult != Z_STREAM_END) {
+		if (strm.avail_in == 0) {
+			const size_t frame = MIN<size_t>(inputSize, frameSize);
+			if (frame == 0)
+				break;
+
+			if (input.read(inputData.get(), frame) != frame)
+				throw Exception(kReadError);
+
+			inputSize -= frame;
+			setZStreamInput(strm, frame, inputData.get());
+		}
+
+		zResult = inflate(&strm, Z_NO_FLUSH);
+		if ((zResult != Z_OK) && (zResult != Z_STREAM_END)) {
+			if ((zResult == Z_BUF_ERROR) && (strm.avail_out == 0))
+				throw Exception("Failed to inflate: premature end of output buffer");
+
+			throw Exception("Failed to inflate: %s (%d)", zError(zResult), zResult);
+		}
+	}
+
+	// Was the end of the input stream correctly reached?
+	if ((zResult != Z_STREAM_END) || (strm.avail_out != 0)) {
+		if (strm.avail_out == 0)
+			throw Exception("Failed to inflate: premature end of output buffer");
+
+		if (zResult == Z_STREAM_END)
+			throw Exception("Failed to inflate: output buffer not completely filled");
 
-	const byte *decompressedData = decompressDeflate(compressedData.get(), inputSize, outputSize, windowBits);
+		throw Exception("Failed to inflate: input buffer empty, stream not ended");
+	}
 
-	return new MemoryReadStream(decompressedData, outputSize, true);
+	return new MemoryReadStream(decompressedData.release(), outputSize, true);
 }
 
 SeekableReadStream *decompressDeflateWithoutOutputSize(ReadStream &input, size_t inputSize,
@@ -197,4 +244,61 @@ size_t decompressDeflateChunk(SeekableReadStream &input, int windowBits,
 	return strm.total_out;
 }
 
+size_t compressDeflate(ReadStream &input, WriteStream &output, int windowBits, size_t &inputSize,
+                       int level, unsigned int frameSize) {
+
+	z_stream strm;
+	strm.zalloc = Z_NULL;
+	strm.zfree  = Z_NULL;
+	strm.opaque = Z_NULL;
+
+	setZStreamInput(strm, 0, 0);
+
+	int zResult = deflateInit2(&strm, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY);
+	if (zResult != Z_OK)
+		throw Exception("Could not initialize zlib deflate: %s (%d)", zError(zResult), zResult);
+
+	BOOST_SCOPE_EXIT( (&strm) ) {
+			deflateEnd(&strm);
+	} BOOST_SCOPE_EXIT_END
+
+	ScopedArray<byte> inputData(new byte[frameSize]);
+	ScopedArray<byte> outputData(new byte[frameSize]);
+
+	inputSize = 0;
+
+	/* Read a frame from the input, compress it and write out whatever
+	 * zlib produced, until the whole input is consumed and flushed. */
+
+	int flush = Z_NO_FLUSH;
+	do {
+		if ((strm.avail_in == 0) && (flush != Z_FINISH)) {
+			const size_t size = input.read(inputData.get(), frameSize);
+
+			setZStreamInput(strm, size, inputData.get());
+			inputSize += size;
+
+			if (input.eos() || (size < frameSize))
+				flush = Z_FINISH;
+		}
+
+		do {
+			strm.avail_out = frameSize;
+			strm.next_out  = outputData.get();
+
+			zResult = deflate(&strm, flush);
+			if (zResult == Z_STREAM_ERROR)
+				throw Exception("Failed to deflate: %s (%d)", zError(zResult), zResult);
+
+			const size_t size = frameSize - strm.avail_out;
+			if (output.write(outputData.get(), size) != size)
+				throw Exception(kWriteError);
+
+		} while (strm.avail_out == 0);
+
+	} while (zResult != Z_STREAM_END);
+
+	return strm.total_out;
+}
+
 } // End of namespace Common
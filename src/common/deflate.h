@@ -30,13 +30,13 @@
 namespace Common {
 
 /* TODO (should be need it):
- * - Compression
  * - Decompress dynamically, without needing to know the size
  *   of the decompressed data beforehand
  */
 
 class ReadStream;
 class SeekableReadStream;
+class WriteStream;
 
 static const int kWindowBitsMax    =  15;
 static const int kWindowBitsMaxRaw = -kWindowBitsMax;
@@ -72,6 +72,9 @@ byte *decompressDeflateWithoutOutputSize(const byte *data, size_t inputSize, siz
                                          int windowBits, unsigned int frameSize = 4096);
 
 /** Decompress (inflate) using zlib's DEFLATE algorithm.
+ *
+ *  The input data is read and decompressed frame by frame, so the whole
+ *  compressed data is never held in memory at once.
  *
  *  @param  input      The compressed input data.
  *  @param  inputSize  The size of the input data to read in bytes.
@@ -82,10 +85,11 @@ byte *decompressDeflateWithoutOutputSize(const byte *data, size_t inputSize, siz
  *  @param windowBits  The base two logarithm of the window size (the size of
  *                     the history buffer). See the zlib documentation on
  *                     inflateInit2() for details.
+ *  @param frameSize   The size of frame for reading from the input stream.
  *  @return A stream of the decompressed data.
  */
 SeekableReadStream *decompressDeflate(ReadStream &input, size_t inputSize,
-                                      size_t outputSize, int windowBits);
+                                      size_t outputSize, int windowBits, unsigned int frameSize = 4096);
 
 /** Decompress (inflate) using zlib's DEFLATE algorithm without knowing the output size.
  *
@@ -117,6 +121,25 @@ SeekableReadStream *decompressDeflateWithoutOutputSize(ReadStream &input, size_t
 size_t decompressDeflateChunk(SeekableReadStream &input, int windowBits, byte *output, size_t outputSize,
                               unsigned int frameSize = 4096);
 
+/** Compress (deflate) using zlib's DEFLATE algorithm.
+ *
+ *  The input is read and compressed in frames, and the compressed data is
+ *  directly written to the output stream, without holding either of them
+ *  in memory as a whole.
+ *
+ *  @param  input      The stream to compress, read until its end.
+ *  @param  output     The stream to write the compressed data to.
+ *  @param  windowBits The base two logarithm of the window size (the size of
+ *                     the history buffer). See the zlib documentation on
+ *                     deflateInit2() for details.
+ *  @param  inputSize  Will be set to the number of bytes read from input.
+ *  @param  level      The compression level, from 0 (none) to 9 (best).
+ *  @param  frameSize  The size of the frames to read and write.
+ *  @return The number of bytes written to output.
+ */
+size_t compressDeflate(ReadStream &input, WriteStream &output, int windowBits, size_t &inputSize,
+                       int level = 6, unsigned int frameSize = 4096);
+
 } // End of namespace Common
 
 #endif // COMMON_DEFLATE_H
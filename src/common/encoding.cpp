@@ -28,14 +28,17 @@
 #include <iconv.h>
 
 #include <vector>
+#include <iterator>
 
 #include "src/common/encoding.h"
+#include "src/common/encodingtables.h"
 #include "src/common/error.h"
 #include "src/common/scopedptr.h"
 #include "src/common/singleton.h"
 #include "src/common/ustring.h"
 #include "src/common/memreadstream.h"
 #include "src/common/writestream.h"
+#include "src/common/mutex.h"
 
 namespace Common {
 
@@ -56,7 +59,252 @@ static const size_t kTerminatorLength  [kEncodingMAX] = {
 	1, 1, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1
 };
 
-/** A manager handling string encoding conversions. */
+/** Return the codepage table of a single-byte encoding, or 0 if the encoding has none. */
+static const uint16 *getEncodingTable(Encoding encoding) {
+	switch (encoding) {
+		case kEncodingLatin9:
+			return kEncodingTableLatin9;
+
+		case kEncodingCP1250:
+			return kEncodingTableCP1250;
+
+		case kEncodingCP1251:
+			return kEncodingTableCP1251;
+
+		case kEncodingCP1252:
+			return kEncodingTableCP1252;
+
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+/** Can we transcode this encoding ourselves, without going through iconv?
+ *
+ *  All our native conversions are stateless, and can therefore be used
+ *  from several threads at once.
+ */
+static bool isNativeEncoding(Encoding encoding) {
+	switch (encoding) {
+		case kEncodingASCII:
+		case kEncodingUTF8:
+		case kEncodingUTF16LE:
+		case kEncodingUTF16BE:
+		case kEncodingLatin9:
+		case kEncodingCP1250:
+		case kEncodingCP1251:
+		case kEncodingCP1252:
+			return true;
+
+		default:
+			break;
+	}
+
+	return false;
+}
+
+/** Append a run of plain 7-bit ASCII characters to a string.
+ *
+ *  Stops at the first byte that's either 0x00 or not 7-bit ASCII. The bulk
+ *  of the run is checked and copied 8 bytes at a time.
+ *
+ *  @return The number of bytes that were appended.
+ */
+static size_t appendASCIIRun(std::string &str, const byte *data, size_t n) {
+	static const uint64 kOnes  = UINT64_C(0x0101010101010101);
+	static const uint64 kHighs = UINT64_C(0x8080808080808080);
+
+	size_t i = 0;
+
+	/* A byte has its high bit set in (v | (v - kOnes)) if it either has
+	 * the high bit set already, or if it is 0x00 and therefore borrows. */
+	while ((i + 8) <= n) {
+		const uint64 v = READ_UINT64(data + i);
+		if (((v | (v - kOnes)) & kHighs) != 0)
+			break;
+
+		i += 8;
+	}
+
+	while ((i < n) && (data[i] != 0x00) && (data[i] < 0x80))
+		i++;
+
+	str.append(reinterpret_cast<const char *>(data), i);
+	return i;
+}
+
+/** Decode a single-byte codepage into an UTF-8 string, stopping at 0x00. */
+static bool decodeSingleByte(std::string &str, const uint16 *table, const byte *data, size_t n) {
+	str.reserve(n);
+
+	size_t i = 0;
+	while (i < n) {
+		i += appendASCIIRun(str, data + i, n - i);
+		if ((i >= n) || (data[i] == 0x00))
+			break;
+
+		const uint16 c = table[data[i++] - 0x80];
+		if (c == 0x0000)
+			return false;
+
+		utf8::unchecked::append(c, std::back_inserter(str));
+	}
+
+	return true;
+}
+
+/** Decode UTF-16 into an UTF-8 string, stopping at 0x0000. */
+static bool decodeUTF16(std::string &str, const byte *data, size_t n, bool bigEndian) {
+	if ((n % 2) != 0)
+		return false;
+
+	str.reserve(n / 2);
+
+	for (size_t i = 0; i < n; i += 2) {
+		uint32 c = bigEndian ? READ_BE_UINT16(data + i) : READ_LE_UINT16(data + i);
+		if (c == 0x0000)
+			break;
+
+		if (c < 0x80) {
+			str += (char) c;
+			continue;
+		}
+
+		if ((c >= 0xDC00) && (c <= 0xDFFF))
+			return false;
+
+		if ((c >= 0xD800) && (c <= 0xDBFF)) {
+			if ((i + 4) > n)
+				return false;
+
+			i += 2;
+
+			const uint32 low = bigEndian ? READ_BE_UINT16(data + i) : READ_LE_UINT16(data + i);
+			if ((low < 0xDC00) || (low > 0xDFFF))
+				return false;
+
+			c = 0x10000 + (((c - 0xD800) << 10) | (low - 0xDC00));
+		}
+
+		utf8::unchecked::append(c, std::back_inserter(str));
+	}
+
+	return true;
+}
+
+/** Convert an encoding we can handle natively into an UTF-8 string. */
+static UString decodeNative(Encoding encoding, const byte *data, size_t n) {
+	std::string str;
+
+	bool success = false;
+	switch (encoding) {
+		case kEncodingASCII:
+		case kEncodingUTF8:
+			{
+				const byte *end = reinterpret_cast<const byte *>(std::memchr(data, 0, n));
+
+				return UString(reinterpret_cast<const char *>(data), end ? (end - data) : n);
+			}
+
+		case kEncodingUTF16LE:
+			success = decodeUTF16(str, data, n, false);
+			break;
+
+		case kEncodingUTF16BE:
+			success = decodeUTF16(str, data, n, true);
+			break;
+
+		default:
+			success = decodeSingleByte(str, getEncodingTable(encoding), data, n);
+			break;
+	}
+
+	if (!success) {
+		warning("Failed to convert %s string to UTF-8: Invalid input sequence", kEncodingName[encoding]);
+		return "[!?!]";
+	}
+
+	return UString(str);
+}
+
+/** Find the byte representing this codepoint in a single-byte codepage. */
+static bool encodeSingleByte(const uint16 *table, uint32 c, byte &b) {
+	if (c < 0x80) {
+		b = c;
+		return true;
+	}
+
+	for (size_t i = 0; i < 128; i++) {
+		if (table[i] == c) {
+			b = 0x80 + i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/** Convert an UTF-8 string into an encoding we can handle natively. */
+static MemoryReadStream *encodeNative(Encoding encoding, const UString &str, bool terminate) {
+	const bool isUTF16 = (encoding == kEncodingUTF16LE) || (encoding == kEncodingUTF16BE);
+	const bool isASCII = (encoding == kEncodingASCII);
+
+	const uint16 *table = getEncodingTable(encoding);
+
+	// Each codepoint takes up at most one byte, or two UTF-16 code units
+	const size_t maxSize = str.size() * (isUTF16 ? 4 : 1) + (terminate ? kTerminatorLength[encoding] : 0);
+
+	ScopedArray<byte> dataOut(new byte[maxSize]);
+
+	size_t size = 0;
+	for (UString::iterator it = str.begin(); it != str.end(); ++it) {
+		const uint32 c = *it;
+
+		if (isASCII) {
+			// Non-ASCII characters are silently dropped
+			if (UString::isASCII(c))
+				dataOut[size++] = c;
+
+		} else if (isUTF16) {
+			uint16 units[2] = { (uint16) c, 0x0000 };
+			size_t unitCount = 1;
+
+			if (c >= 0x10000) {
+				units[0] = 0xD800 + ((c - 0x10000) >> 10);
+				units[1] = 0xDC00 + ((c - 0x10000) & 0x3FF);
+				unitCount = 2;
+			}
+
+			for (size_t i = 0; i < unitCount; i++, size += 2) {
+				if (encoding == kEncodingUTF16LE)
+					WRITE_LE_UINT16(dataOut.get() + size, units[i]);
+				else
+					WRITE_BE_UINT16(dataOut.get() + size, units[i]);
+			}
+
+		} else {
+			if (!encodeSingleByte(table, c, dataOut[size++])) {
+				warning("Failed to convert UTF-8 string to %s: Character U+%04X can't be represented",
+				        kEncodingName[encoding], (uint) c);
+				return 0;
+			}
+		}
+	}
+
+	for (size_t i = 0; terminate && (i < kTerminatorLength[encoding]); i++)
+		dataOut[size++] = '\0';
+
+	return new MemoryReadStream(dataOut.release(), size, true);
+}
+
+/** A manager handling string encoding conversions through iconv.
+ *
+ *  Only used for the encodings we can't transcode natively, i.e. the
+ *  multi-byte CJK codepages. The iconv contexts are stateful, so each
+ *  one is guarded by its own mutex.
+ */
 class ConversionManager : public Singleton<ConversionManager> {
 public:
 	ConversionManager() {
@@ -66,12 +314,14 @@ public:
 		}
 
 		for (size_t i = 0; i < kEncodingMAX; i++)
-			if ((_contextFrom[i] = iconv_open("UTF-8", kEncodingName[i])) == ((iconv_t) -1))
-				warning("Failed to initialize %s -> UTF-8 conversion: %s", kEncodingName[i], strerror(errno));
+			if (!isNativeEncoding((Encoding) i))
+				if ((_contextFrom[i] = iconv_open("UTF-8", kEncodingName[i])) == ((iconv_t) -1))
+					warning("Failed to initialize %s -> UTF-8 conversion: %s", kEncodingName[i], strerror(errno));
 
 		for (size_t i = 0; i < kEncodingMAX; i++)
-			if ((_contextTo  [i] = iconv_open(kEncodingName[i], "UTF-8")) == ((iconv_t) -1))
-				warning("Failed to initialize UTF-8 -> %s conversion: %s", kEncodingName[i], strerror(errno));
+			if (!isNativeEncoding((Encoding) i))
+				if ((_contextTo  [i] = iconv_open(kEncodingName[i], "UTF-8")) == ((iconv_t) -1))
+					warning("Failed to initialize UTF-8 -> %s conversion: %s", kEncodingName[i], strerror(errno));
 	}
 
 	~ConversionManager() {
@@ -97,10 +347,12 @@ public:
 		return false;
 	}
 
-	UString convert(Encoding encoding, byte *data, size_t n) {
+	UString convert(Encoding encoding, const byte *data, size_t n) {
 		if (((size_t) encoding) >= kEncodingMAX)
 			throw Exception("Invalid encoding %d", encoding);
 
+		std::lock_guard<std::mutex> lock(_mutexFrom[encoding]);
+
 		return convert(_contextFrom[encoding], data, n, kEncodingGrowthFrom[encoding], 1);
 	}
 
@@ -108,8 +360,7 @@ public:
 		if (((size_t) encoding) >= kEncodingMAX)
 			throw Exception("Invalid encoding %d", encoding);
 
-		if (encoding == kEncodingASCII)
-			return clean7bitASCII(str, terminate);
+		std::lock_guard<std::mutex> lock(_mutexTo[encoding]);
 
 		return convert(_contextTo[encoding], str, kEncodingGrowthTo[encoding],
 		               terminate ? kTerminatorLength[encoding] : 0);
@@ -119,19 +370,23 @@ private:
 	iconv_t _contextFrom[kEncodingMAX];
 	iconv_t _contextTo  [kEncodingMAX];
 
-	byte *doConvert(iconv_t &ctx, byte *data, size_t nIn, size_t nOut, size_t &size) {
+	std::mutex _mutexFrom[kEncodingMAX];
+	std::mutex _mutexTo  [kEncodingMAX];
+
+	byte *doConvert(iconv_t &ctx, const byte *data, size_t nIn, size_t nOut, size_t &size) {
 		size_t inBytes  = nIn;
 		size_t outBytes = nOut;
 
 		ScopedArray<byte> convData(new byte[outBytes]);
 
+		byte *inBuf  = const_cast<byte *>(data);
 		byte *outBuf = convData.get();
 
 		// Reset the converter's state
 		iconv(ctx, 0, 0, 0, 0);
 
 		// Convert
-		if (iconv(ctx, const_cast<ICONV_CONST char **>(reinterpret_cast<char **>(&data)), &inBytes,
+		if (iconv(ctx, const_cast<ICONV_CONST char **>(reinterpret_cast<char **>(&inBuf)), &inBytes,
 		          reinterpret_cast<char **>(&outBuf), &outBytes) == ((size_t) -1)) {
 
 			warning("iconv() failed: %s", strerror(errno));
@@ -143,7 +398,7 @@ private:
 		return convData.release();
 	}
 
-	UString convert(iconv_t &ctx, byte *data, size_t n, size_t growth, size_t termSize) {
+	UString convert(iconv_t &ctx, const byte *data, size_t n, size_t growth, size_t termSize) {
 		if (ctx == ((iconv_t) -1))
 			return "[!!!]";
 
@@ -162,9 +417,9 @@ private:
 		if (ctx == ((iconv_t) -1))
 			return 0;
 
-		byte  *dataIn = const_cast<byte *>(reinterpret_cast<const byte *>(str.c_str()));
-		size_t nIn    = std::strlen(str.c_str());
-		size_t nOut   = nIn * growth + termSize;
+		const byte *dataIn = reinterpret_cast<const byte *>(str.c_str());
+		size_t nIn  = std::strlen(str.c_str());
+		size_t nOut = nIn * growth + termSize;
 
 		size_t size;
 		ScopedArray<byte> dataOut(doConvert(ctx, dataIn, nIn, nOut, size));
@@ -176,30 +431,24 @@ private:
 
 		return new MemoryReadStream(dataOut.release(), size, true);
 	}
-
-	MemoryReadStream *clean7bitASCII(const UString &str, bool terminate) {
-		ScopedArray<byte> dataOut(new byte[str.size() + (terminate ? 1 : 0)]);
-
-		size_t size = 0;
-		for (UString::iterator c = str.begin(); c != str.end(); ++c)
-			if (UString::isASCII(*c))
-				dataOut[size++] = *c;
-
-		if (terminate)
-			dataOut[size++] = '\0';
-
-		return new MemoryReadStream(dataOut.release(), size, true);
-	}
 };
 
 }
 
-#define ConvMan Common::ConversionManager::instance()
-
 DECLARE_SINGLETON(Common::ConversionManager)
 
 namespace Common {
 
+/** Return the conversion manager, creating it in a thread-safe manner. */
+static ConversionManager &getConversionManager() {
+	static std::once_flag created;
+	std::call_once(created, &ConversionManager::instance);
+
+	return ConversionManager::instance();
+}
+
+#define ConvMan Common::getConversionManager()
+
 UString getEncodingName(Encoding encoding) {
 	if (((size_t) encoding) >= kEncodingMAX)
 		return "Invalid";
@@ -208,107 +457,74 @@ UString getEncodingName(Encoding encoding) {
 }
 
 bool hasSupportEncoding(Encoding encoding) {
+	if (isNativeEncoding(encoding))
+		return true;
+
 	return ConvMan.hasSupportTranscode(Common::kEncodingUTF8, encoding             ) &&
 	       ConvMan.hasSupportTranscode(encoding             , Common::kEncodingUTF8);
 }
 
-static uint32 readFakeChar(SeekableReadStream &stream, Encoding encoding) {
-	byte data[2];
-
-	switch (encoding) {
-		case kEncodingASCII:
-		case kEncodingLatin9:
-		case kEncodingUTF8:
-		case kEncodingCP1250:
-		case kEncodingCP1251:
-		case kEncodingCP1252:
-		case kEncodingCP932:
-		case kEncodingCP936:
-		case kEncodingCP949:
-		case kEncodingCP950:
-			if (stream.read(data, 1) != 1)
-				return 0;
-
-			return data[0];
-
-		case kEncodingUTF16LE:
-			if (stream.read(data, 2) != 2)
-				return 0;
+static UString createString(const byte *data, size_t size, Encoding encoding) {
+	if (size == 0)
+		return "";
 
-			return READ_LE_UINT16(data);
+	if (isNativeEncoding(encoding))
+		return decodeNative(encoding, data, size);
 
-		case kEncodingUTF16BE:
-			if (stream.read(data, 2) != 2)
-				return 0;
+	return ConvMan.convert(encoding, data, size);
+}
 
-			return READ_BE_UINT16(data);
+/** Read the raw bytes of a string out of a stream.
+ *
+ *  The stream is read in chunks, and seeked back to directly after the
+ *  end-of-string (or end-of-line) sequence once one is found.
+ */
+static void readRawString(SeekableReadStream &stream, Encoding encoding, bool line, std::vector<byte> &output) {
+	if (((size_t) encoding) >= kEncodingMAX)
+		return;
 
-		default:
-			break;
-	}
+	const size_t unitSize  = kTerminatorLength[encoding];
+	const bool   bigEndian = encoding == kEncodingUTF16BE;
 
-	return 0;
-}
+	byte buffer[256];
 
-static void writeFakeChar(std::vector<byte> &output, uint32 c, Encoding encoding) {
-	byte data[2];
+	while (true) {
+		const size_t start = stream.pos();
+		const size_t count = stream.read(buffer, sizeof(buffer));
 
-	switch (encoding) {
-		case kEncodingASCII:
-		case kEncodingLatin9:
-		case kEncodingUTF8:
-		case kEncodingCP1250:
-		case kEncodingCP1251:
-		case kEncodingCP1252:
-		case kEncodingCP932:
-		case kEncodingCP936:
-		case kEncodingCP949:
-		case kEncodingCP950:
-			output.push_back(c);
-			break;
+		// An incomplete unit at the very end of the stream is dropped
+		const size_t n = count - (count % unitSize);
 
-		case kEncodingUTF16LE:
-			WRITE_LE_UINT16(data, c);
-			output.push_back(data[0]);
-			output.push_back(data[1]);
-			break;
+		size_t runStart = 0;
+		for (size_t i = 0; i < n; i += unitSize) {
+			const uint32 c = (unitSize == 1) ? buffer[i] :
+				(bigEndian ? READ_BE_UINT16(buffer + i) : READ_LE_UINT16(buffer + i));
 
-		case kEncodingUTF16BE:
-			WRITE_BE_UINT16(data, c);
-			output.push_back(data[0]);
-			output.push_back(data[1]);
-			break;
+			const bool end = (c == '\0') || (line && (c == '\n'));
+			if (!end && (!line || (c != '\r')))
+				continue;
 
-		default:
-			break;
-	}
-}
+			output.insert(output.end(), buffer + runStart, buffer + i);
+			runStart = i + unitSize;
 
-static UString createString(std::vector<byte> &output, Encoding encoding) {
-	if (output.empty())
-		return "";
+			if (end) {
+				stream.seek(start + i + unitSize);
+				return;
+			}
+		}
 
-	switch (encoding) {
-		case kEncodingASCII:
-		case kEncodingUTF8:
-			output.push_back('\0');
-			return UString(reinterpret_cast<const char *>(&output[0]));
+		output.insert(output.end(), buffer + runStart, buffer + n);
 
-		default:
-			return ConvMan.convert(encoding, &output[0], output.size());
+		if (count < sizeof(buffer))
+			return;
 	}
-
-	return "";
 }
 
 UString readString(SeekableReadStream &stream, Encoding encoding) {
 	std::vector<byte> output;
+	readRawString(stream, encoding, false, output);
 
-	uint32 c;
-	while (((c = readFakeChar(stream, encoding)) != '\0') && !stream.eos())
-		writeFakeChar(output, c, encoding);
-
-	return createString(output, encoding);
+	return createString(output.empty() ? 0 : &output[0], output.size(), encoding);
 }
 
 UString readStringFixed(SeekableReadStream &stream, Encoding encoding, size_t length) {
@@ -319,38 +535,19 @@ UString readStringFixed(SeekableReadStream &stream, Encoding encoding, size_t le
 	output.resize(length);
 
 	length = stream.read(&output[0], length);
-	output.resize(length);
 
-	return createString(output, encoding);
+	return createString(&output[0], length, encoding);
 }
 
 UString readStringLine(SeekableReadStream &stream, Encoding encoding) {
 	std::vector<byte> output;
+	readRawString(stream, encoding, true, output);
 
-	uint32 c;
-	while (((c = readFakeChar(stream, encoding)) != '\0') && !stream.eos()) {
-		if (c == '\n')
-			break;
-
-		if (c == '\r')
-			continue;
-
-		writeFakeChar(output, c, encoding);
-	}
-
-	return createString(output, encoding);
+	return createString(output.empty() ? 0 : &output[0], output.size(), encoding);
 }
 
 UString readString(const byte *data, size_t size, Encoding encoding) {
-	if (size == 0)
-		return "";
-
-	std::vector<byte> output;
-	output.resize(size);
-
-	std::memcpy(&output[0], data, size);
-
-	return createString(output, encoding);
+	return createString(data, size, encoding);
 }
 
 size_t writeString(WriteStream &stream, const Common::UString &str, Encoding encoding, bool terminate) {
@@ -377,6 +574,9 @@ MemoryReadStream *convertString(const UString &str, Encoding encoding, bool term
 		return new MemoryReadStream(reinterpret_cast<const byte *>(str.c_str()),
 		                            std::strlen(str.c_str()) + (terminateString ? 1 : 0));
 
+	if (isNativeEncoding(encoding))
+		return encodeNative(encoding, str, terminateString);
+
 	return ConvMan.convert(encoding, str, terminateString);
 }
 
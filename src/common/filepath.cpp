@@ -352,6 +352,22 @@ bool FilePath::createDirectories(const UString &path) {
 	}
 }
 
+void FilePath::renameFile(const UString &from, const UString &to) {
+	try {
+		boost::filesystem::rename(from.c_str(), to.c_str());
+	} catch (std::exception &se) {
+		throw Exception(se);
+	}
+}
+
+bool FilePath::removeFile(const UString &path) {
+	try {
+		return boost::filesystem::remove(path.c_str());
+	} catch (std::exception &se) {
+		throw Exception(se);
+	}
+}
+
 UString FilePath::escapeStringLiteral(const UString &str) {
 	const std::regex esc("[\\^\\.\\$\\|\\(\\)\\[\\]\\*\\+\\?\\/\\\\]");
 	const std::string rep("\\$&");
@@ -211,6 +211,20 @@ public:
 	 */
 	static bool createDirectories(const UString &path);
 
+	/** Rename a file, replacing the target file if it already exists.
+	 *
+	 *  @param  from The path of the file to rename.
+	 *  @param  to   The new path of the file.
+	 */
+	static void renameFile(const UString &from, const UString &to);
+
+	/** Remove a file.
+	 *
+	 *  @param  path The file to remove.
+	 *  @return true if the file existed and was removed.
+	 */
+	static bool removeFile(const UString &path);
+
 	/** Escape a string literal for use in a regexp. */
 	static UString escapeStringLiteral(const UString &str);
 
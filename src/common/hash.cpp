@@ -0,0 +1,351 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Utility hash functions.
+ */
+
+#include <cstring>
+
+#include <algorithm>
+
+#include "src/common/hash.h"
+#include "src/common/endianness.h"
+
+namespace Common {
+
+// .--- Bulk hashing of raw data ---.
+uint32 hashDataDJB2(uint32 hash, const byte *data, size_t size) {
+	while (size-- > 0)
+		hash = hashDJB2(hash, *data++);
+
+	return hash;
+}
+
+uint32 hashDataFNV32(uint32 hash, const byte *data, size_t size) {
+	while (size-- > 0)
+		hash = hashFNV32(hash, *data++);
+
+	return hash;
+}
+
+uint64 hashDataFNV64(uint64 hash, const byte *data, size_t size) {
+	while (size-- > 0)
+		hash = hashFNV64(hash, *data++);
+
+	return hash;
+}
+
+/** The CRC32 lookup tables for slicing-by-8.
+ *
+ *  Table 0 is the standard CRC32 table. Table n contains the CRC32 of
+ *  the value of table 0, followed by n zero bytes. This lets us combine
+ *  the results of 8 independent table lookups into the CRC32 of 8 bytes.
+ */
+struct CRC32Tables {
+	uint32 table[8][256];
+
+	CRC32Tables() {
+		for (size_t i = 0; i < 256; i++)
+			table[0][i] = kCRC32Tab[i];
+
+		for (size_t i = 0; i < 256; i++)
+			for (size_t j = 1; j < 8; j++)
+				table[j][i] = (table[j - 1][i] >> 8) ^ kCRC32Tab[table[j - 1][i] & 0xFF];
+	}
+};
+
+static const CRC32Tables &getCRC32Tables() {
+	static const CRC32Tables tables;
+
+	return tables;
+}
+
+uint32 hashDataCRC32(uint32 hash, const byte *data, size_t size) {
+	if (size >= 8) {
+		const uint32 (&t)[8][256] = getCRC32Tables().table;
+
+		while (size >= 8) {
+			const uint32 one = READ_LE_UINT32(data) ^ hash;
+			const uint32 two = READ_LE_UINT32(data + 4);
+
+			hash = t[7][ one        & 0xFF] ^ t[6][(one >>  8) & 0xFF] ^
+			       t[5][(one >> 16) & 0xFF] ^ t[4][ one >> 24        ] ^
+			       t[3][ two        & 0xFF] ^ t[2][(two >>  8) & 0xFF] ^
+			       t[1][(two >> 16) & 0xFF] ^ t[0][ two >> 24        ];
+
+			data += 8;
+			size -= 8;
+		}
+	}
+
+	while (size-- > 0)
+		hash = hashCRC32(hash, *data++);
+
+	return hash;
+}
+// '--- Bulk hashing of raw data ---'
+
+
+// .--- Hashing of strings ---.
+struct HasherDJB2 {
+	typedef uint32 Value;
+
+	static Value init() { return 5381; }
+	static Value finish(Value hash) { return hash; }
+
+	static Value hashChar(Value hash, uint32 c) { return hashDJB2(hash, c); }
+	static Value hashData(Value hash, const byte *data, size_t size) { return hashDataDJB2(hash, data, size); }
+};
+
+struct HasherFNV32 {
+	typedef uint32 Value;
+
+	static Value init() { return 0x811C9DC5; }
+	static Value finish(Value hash) { return hash; }
+
+	static Value hashChar(Value hash, uint32 c) { return hashFNV32(hash, c); }
+	static Value hashData(Value hash, const byte *data, size_t size) { return hashDataFNV32(hash, data, size); }
+};
+
+struct HasherFNV64 {
+	typedef uint64 Value;
+
+	static Value init() { return 0xCBF29CE484222325LL; }
+	static Value finish(Value hash) { return hash; }
+
+	static Value hashChar(Value hash, uint32 c) { return hashFNV64(hash, c); }
+	static Value hashData(Value hash, const byte *data, size_t size) { return hashDataFNV64(hash, data, size); }
+};
+
+struct HasherCRC32 {
+	typedef uint32 Value;
+
+	static Value init() { return 0xFFFFFFFF; }
+	static Value finish(Value hash) { return hash ^ 0xFFFFFFFF; }
+
+	static Value hashChar(Value hash, uint32 c) { return hashCRC32(hash, c); }
+	static Value hashData(Value hash, const byte *data, size_t size) { return hashDataCRC32(hash, data, size); }
+};
+
+/** How the characters of an ASCII string are laid out when encoded. */
+enum ASCIILayout {
+	kASCIILayoutNone,    ///< Unknown, the string has to be converted.
+	kASCIILayoutBytes,   ///< One byte per character, identical to ASCII.
+	kASCIILayoutUTF16LE, ///< Two bytes per character, ASCII byte first.
+	kASCIILayoutUTF16BE  ///< Two bytes per character, ASCII byte second.
+};
+
+static ASCIILayout getASCIILayout(Encoding encoding) {
+	switch (encoding) {
+		// kEncodingInvalid stands for "the string's Unicode codepoints" here
+		case kEncodingInvalid:
+		case kEncodingASCII:
+		case kEncodingUTF8:
+		case kEncodingLatin9:
+		case kEncodingCP1250:
+		case kEncodingCP1251:
+		case kEncodingCP1252:
+			return kASCIILayoutBytes;
+
+		case kEncodingUTF16LE:
+			return kASCIILayoutUTF16LE;
+
+		case kEncodingUTF16BE:
+			return kASCIILayoutUTF16BE;
+
+		default:
+			break;
+	}
+
+	return kASCIILayoutNone;
+}
+
+/** Does this string consist only of ASCII characters? */
+static bool isASCII(const char *str, size_t size) {
+	// Check 8 characters at once for set high bits
+	while (size >= 8) {
+		uint64 chars;
+		std::memcpy(&chars, str, 8);
+
+		if (chars & UINT64_C(0x8080808080808080))
+			return false;
+
+		str  += 8;
+		size -= 8;
+	}
+
+	while (size-- > 0)
+		if (*str++ & 0x80)
+			return false;
+
+	return true;
+}
+
+static inline byte toLowerASCII(byte c) {
+	return ((byte) (c - 'A') < 26) ? (c | 0x20) : c;
+}
+
+/** Hash a string that consists only of ASCII characters, directly out of its memory. */
+template<class Hasher>
+static typename Hasher::Value hashASCII(const byte *str, size_t size, ASCIILayout layout, bool lower) {
+	typename Hasher::Value hash = Hasher::init();
+
+	if ((layout == kASCIILayoutBytes) && !lower)
+		return Hasher::finish(Hasher::hashData(hash, str, size));
+
+	// Lower-case and/or widen the string chunk-wise into a small buffer
+
+	byte buffer[512];
+
+	const size_t width = (layout == kASCIILayoutBytes) ? 1 : 2;
+	const size_t chunk = sizeof(buffer) / width;
+
+	while (size > 0) {
+		const size_t n = std::min(chunk, size);
+
+		if (layout == kASCIILayoutBytes) {
+			for (size_t i = 0; i < n; i++)
+				buffer[i] = lower ? toLowerASCII(str[i]) : str[i];
+		} else {
+			const size_t charByte = (layout == kASCIILayoutUTF16LE) ? 0 : 1;
+
+			for (size_t i = 0; i < n; i++) {
+				buffer[i * 2 +     charByte] = lower ? toLowerASCII(str[i]) : str[i];
+				buffer[i * 2 + 1 - charByte] = 0;
+			}
+		}
+
+		hash = Hasher::hashData(hash, buffer, n * width);
+
+		str  += n;
+		size -= n;
+	}
+
+	return Hasher::finish(hash);
+}
+
+/** Hash a string, either as a series of Unicode codepoints (for kEncodingInvalid)
+ *  or as a series of bytes in the given encoding. */
+template<class Hasher>
+static typename Hasher::Value hashString(const UString &string, Encoding encoding, bool lower) {
+	const char  *str  = string.c_str();
+	const size_t size = std::strlen(str);
+
+	const ASCIILayout layout = getASCIILayout(encoding);
+	if ((layout != kASCIILayoutNone) && isASCII(str, size))
+		return hashASCII<Hasher>(reinterpret_cast<const byte *>(str), size, layout, lower);
+
+	// Slow path: go through the string character by character
+
+	if (lower)
+		return hashString<Hasher>(string.toLower(), encoding, false);
+
+	typename Hasher::Value hash = Hasher::init();
+
+	if (encoding == kEncodingInvalid) {
+		for (UString::iterator it = string.begin(); it != string.end(); ++it)
+			hash = Hasher::hashChar(hash, *it);
+
+		return Hasher::finish(hash);
+	}
+
+	ScopedPtr<SeekableReadStream> data(convertString(string, encoding, false));
+	if (!data)
+		return hash;
+
+	uint32 c;
+	while ((c = data->readChar()) != ReadStream::kEOF)
+		hash = Hasher::hashChar(hash, c);
+
+	return Hasher::finish(hash);
+}
+
+uint32 hashStringDJB2(const UString &string) {
+	return hashString<HasherDJB2>(string, kEncodingInvalid, false);
+}
+
+uint32 hashStringDJB2(const UString &string, Encoding encoding) {
+	return hashString<HasherDJB2>(string, encoding, false);
+}
+
+uint32 hashStringFNV32(const UString &string) {
+	return hashString<HasherFNV32>(string, kEncodingInvalid, false);
+}
+
+uint32 hashStringFNV32(const UString &string, Encoding encoding) {
+	return hashString<HasherFNV32>(string, encoding, false);
+}
+
+uint64 hashStringFNV64(const UString &string) {
+	return hashString<HasherFNV64>(string, kEncodingInvalid, false);
+}
+
+uint64 hashStringFNV64(const UString &string, Encoding encoding) {
+	return hashString<HasherFNV64>(string, encoding, false);
+}
+
+uint32 hashStringCRC32(const UString &string) {
+	return hashString<HasherCRC32>(string, kEncodingInvalid, false);
+}
+
+uint32 hashStringCRC32(const UString &string, Encoding encoding) {
+	return hashString<HasherCRC32>(string, encoding, false);
+}
+
+static uint64 hashString(const UString &string, HashAlgo algo, Encoding encoding, bool lower) {
+	switch (algo) {
+		case kHashDJB2:
+			return hashString<HasherDJB2>(string, encoding, lower);
+
+		case kHashFNV32:
+			return hashString<HasherFNV32>(string, encoding, lower);
+
+		case kHashFNV64:
+			return hashString<HasherFNV64>(string, encoding, lower);
+
+		case kHashCRC32:
+			return hashString<HasherCRC32>(string, encoding, lower);
+
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+uint64 hashString(const UString &string, HashAlgo algo) {
+	return hashString(string, algo, kEncodingInvalid, false);
+}
+
+uint64 hashString(const UString &string, HashAlgo algo, Encoding encoding) {
+	return hashString(string, algo, encoding, false);
+}
+
+uint64 hashStringLower(const UString &string, HashAlgo algo) {
+	return hashString(string, algo, kEncodingInvalid, true);
+}
+
+uint64 hashStringLower(const UString &string, HashAlgo algo, Encoding encoding) {
+	return hashString(string, algo, encoding, true);
+}
+// '--- Hashing of strings ---'
+
+} // End of namespace Common
@@ -43,33 +43,24 @@ enum HashAlgo {
 	kHashMAX         ///< For range checks.
 };
 
+/* The hashString*() functions below hash strings that consist solely
+ * of ASCII characters directly out of the string's memory, in bulk.
+ * Only strings with non-ASCII characters and encodings that are not
+ * ASCII-compatible go through the slower, character-by-character path.
+ *
+ * The hashData*() functions continue a running hash over a block of
+ * raw data. They neither initialize nor finalize the hash value.
+ */
+
 // .--- djb2 hash function by Daniel J. Bernstein ---.
 static inline uint32 hashDJB2(uint32 hash, uint32 c) {
 	return ((hash << 5) + hash) + c;
 }
 
-static inline uint32 hashStringDJB2(const UString &string) {
-	uint32 hash = 5381;
-
-	for (UString::iterator it = string.begin(); it != string.end(); ++it)
-		hash = hashDJB2(hash, *it);
-
-	return hash;
-}
-
-static inline uint32 hashStringDJB2(const UString &string, Encoding encoding) {
-	uint32 hash = 5381;
-
-	ScopedPtr<SeekableReadStream> data(convertString(string, encoding, false));
-	if (!data)
-		return hash;
-
-	uint32 c;
-	while ((c = data->readChar()) != ReadStream::kEOF)
-		hash = hashDJB2(hash, c);
+uint32 hashDataDJB2(uint32 hash, const byte *data, size_t size);
 
-	return hash;
-}
+uint32 hashStringDJB2(const UString &string);
+uint32 hashStringDJB2(const UString &string, Encoding encoding);
 // '--- djb2 hash function by Daniel J. Bernstein ---'
 
 // .--- 32bit Fowler-Noll-Vo hash by Glenn Fowler, Landon Curt Noll and Phong Vo ---.
@@ -77,28 +68,10 @@ static inline uint32 hashFNV32(uint32 hash, uint32 c) {
 	return (hash * 16777619) ^ c;
 }
 
-static inline uint32 hashStringFNV32(const UString &string) {
-	uint32 hash = 0x811C9DC5;
-
-	for (UString::iterator it = string.begin(); it != string.end(); ++it)
-		hash = hashFNV32(hash, *it);
-
-	return hash;
-}
-
-static inline uint32 hashStringFNV32(const UString &string, Encoding encoding) {
-	uint32 hash = 0x811C9DC5;
-
-	ScopedPtr<SeekableReadStream> data(convertString(string, encoding, false));
-	if (!data)
-		return hash;
+uint32 hashDataFNV32(uint32 hash, const byte *data, size_t size);
 
-	uint32 c;
-	while ((c = data->readChar()) != ReadStream::kEOF)
-		hash = hashFNV32(hash, c);
-
-	return hash;
-}
+uint32 hashStringFNV32(const UString &string);
+uint32 hashStringFNV32(const UString &string, Encoding encoding);
 // '--- 32bit Fowler-Noll-Vo hash by Glenn Fowler, Landon Curt Noll and Phong Vo ---'
 
 // .--- 64bit Fowler-Noll-Vo hash by Glenn Fowler, Landon Curt Noll and Phong Vo ---.
@@ -106,28 +79,10 @@ static inline uint64 hashFNV64(uint64 hash, uint32 c) {
 	return (hash * 1099511628211LL) ^ c;
 }
 
-static inline uint64 hashStringFNV64(const UString &string) {
-	uint64 hash = 0xCBF29CE484222325LL;
-
-	for (UString::iterator it = string.begin(); it != string.end(); ++it)
-		hash = hashFNV64(hash, *it);
-
-	return hash;
-}
-
-static inline uint64 hashStringFNV64(const UString &string, Encoding encoding) {
-	uint64 hash = 0xCBF29CE484222325LL;
+uint64 hashDataFNV64(uint64 hash, const byte *data, size_t size);
 
-	ScopedPtr<SeekableReadStream> data(convertString(string, encoding, false));
-	if (!data)
-		return hash;
-
-	uint32 c;
-	while ((c = data->readChar()) != ReadStream::kEOF)
-		hash = hashFNV64(hash, c);
-
-	return hash;
-}
+uint64 hashStringFNV64(const UString &string);
+uint64 hashStringFNV64(const UString &string, Encoding encoding);
 // '--- 64bit Fowler-Noll-Vo hash by Glenn Fowler, Landon Curt Noll and Phong Vo ---'
 
 /* .--- CRC32, based on the implementation by Gary S. Brown ---.
@@ -190,73 +145,30 @@ static inline uint32 hashCRC32(uint32 hash, uint32 c) {
 	return kCRC32Tab[(hash ^ c) & 0xFF] ^ (hash >> 8);
 }
 
-static inline uint32 hashStringCRC32(const UString &string) {
-	uint32 hash = 0xFFFFFFFF;
+/** Continue a CRC32 over a block of data, 8 bytes at a time ("slicing-by-8"). */
+uint32 hashDataCRC32(uint32 hash, const byte *data, size_t size);
 
-	for (UString::iterator it = string.begin(); it != string.end(); ++it)
-		hash = hashCRC32(hash, *it);
-
-	return hash ^ 0xFFFFFFFF;
-}
-
-static inline uint32 hashStringCRC32(const UString &string, Encoding encoding) {
-	uint32 hash = 0xFFFFFFFF;
-
-	ScopedPtr<SeekableReadStream> data(convertString(string, encoding, false));
-	if (!data)
-		return hash;
-
-	uint32 c;
-	while ((c = data->readChar()) != ReadStream::kEOF)
-		hash = hashCRC32(hash, c);
-
-	return hash ^ 0xFFFFFFFF;
-}
+uint32 hashStringCRC32(const UString &string);
+uint32 hashStringCRC32(const UString &string, Encoding encoding);
 // '--- CRC32, based on the implementation by Gary S. Brown ---'
 
 /** Hash the string with the given algorithm, as a series of UTF-8 characters. */
-static inline uint64 hashString(const UString &string, HashAlgo algo) {
-	switch (algo) {
-		case kHashDJB2:
-			return hashStringDJB2(string);
-
-		case kHashFNV32:
-			return hashStringFNV32(string);
-
-		case kHashFNV64:
-			return hashStringFNV64(string);
-
-		case kHashCRC32:
-			return hashStringCRC32(string);
-
-		default:
-			break;
-	}
-
-	return 0;
-}
-
+uint64 hashString(const UString &string, HashAlgo algo);
 /** Hash the string with the given algorithm, as a series of bytes in the given encoding. */
-static inline uint64 hashString(const UString &string, HashAlgo algo, Encoding encoding) {
-	switch (algo) {
-		case kHashDJB2:
-			return hashStringDJB2(string, encoding);
-
-		case kHashFNV32:
-			return hashStringFNV32(string, encoding);
-
-		case kHashFNV64:
-			return hashStringFNV64(string, encoding);
-
-		case kHashCRC32:
-			return hashStringCRC32(string, encoding);
-
-		default:
-			break;
-	}
+uint64 hashString(const UString &string, HashAlgo algo, Encoding encoding);
 
-	return 0;
-}
+/** Hash the lower-cased string with the given algorithm, as a series of UTF-8 characters.
+ *
+ *  This is equivalent to hashString(string.toLower(), algo), but does
+ *  not create a temporary lower-case copy of the string.
+ */
+uint64 hashStringLower(const UString &string, HashAlgo algo);
+/** Hash the lower-cased string with the given algorithm, as a series of bytes in the given encoding.
+ *
+ *  This is equivalent to hashString(string.toLower(), algo, encoding), but
+ *  does not create a temporary lower-case copy of the string.
+ */
+uint64 hashStringLower(const UString &string, HashAlgo algo, Encoding encoding);
 
 static inline UString formatHash(uint64 hash) {
 	return UString::format("0x%04X%04X%04X%04X",
@@ -0,0 +1,155 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Read-only memory mapping of files.
+ */
+
+#include "src/common/system.h"
+
+#if defined(WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#include <limits>
+
+#include <boost/filesystem/path.hpp>
+
+#include "src/common/mappedfile.h"
+#include "src/common/ustring.h"
+#include "src/common/error.h"
+
+namespace Common {
+
+MappedFile::MappedFile(const UString &fileName) : _data(0), _size(0), _file(0), _mapping(0) {
+	try {
+		map(fileName);
+	} catch (Exception &e) {
+		unmap();
+
+		e.add("Can't map file \"%s\"", fileName.c_str());
+		throw;
+	}
+}
+
+MappedFile::~MappedFile() {
+	unmap();
+}
+
+const byte *MappedFile::getData() const {
+	return _data;
+}
+
+size_t MappedFile::size() const {
+	return _size;
+}
+
+#if defined(WIN32)
+
+void MappedFile::map(const UString &fileName) {
+	HANDLE file = CreateFileW(boost::filesystem::path(fileName.c_str()).c_str(), GENERIC_READ, FILE_SHARE_READ,
+	                          0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (file == INVALID_HANDLE_VALUE)
+		throw Exception("Failed to open file");
+
+	_file = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize))
+		throw Exception("Failed to query the file size");
+
+	if ((fileSize.QuadPart <= 0) || ((uint64)fileSize.QuadPart > std::numeric_limits<size_t>::max()))
+		throw Exception("Invalid file size");
+
+	HANDLE mapping = CreateFileMappingW(file, 0, PAGE_READONLY, 0, 0, 0);
+	if (!mapping)
+		throw Exception("Failed to create file mapping");
+
+	_mapping = mapping;
+
+	_data = static_cast<const byte *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!_data)
+		throw Exception("Failed to map view of file");
+
+	_size = (size_t)fileSize.QuadPart;
+}
+
+void MappedFile::unmap() {
+	if (_data)
+		UnmapViewOfFile(_data);
+
+	if (_mapping)
+		CloseHandle(static_cast<HANDLE>(_mapping));
+	if (_file)
+		CloseHandle(static_cast<HANDLE>(_file));
+
+	_data    = 0;
+	_size    = 0;
+	_mapping = 0;
+	_file    = 0;
+}
+
+#else
+
+void MappedFile::map(const UString &fileName) {
+	const int file = open(boost::filesystem::path(fileName.c_str()).c_str(), O_RDONLY);
+	if (file == -1)
+		throw Exception("Failed to open file");
+
+	struct stat fileStat;
+	if ((fstat(file, &fileStat) != 0) || (fileStat.st_size <= 0) ||
+	    ((uint64)fileStat.st_size > std::numeric_limits<size_t>::max())) {
+
+		close(file);
+		throw Exception("Invalid file size");
+	}
+
+	const size_t fileSize = (size_t)fileStat.st_size;
+
+	void *data = mmap(0, fileSize, PROT_READ, MAP_PRIVATE, file, 0);
+
+	// The mapping stays valid after the file descriptor is closed
+	close(file);
+
+	if (data == MAP_FAILED)
+		throw Exception("Failed to map file");
+
+	_data = static_cast<const byte *>(data);
+	_size = fileSize;
+}
+
+void MappedFile::unmap() {
+	if (_data)
+		munmap(const_cast<byte *>(_data), _size);
+
+	_data = 0;
+	_size = 0;
+}
+
+#endif
+
+} // End of namespace Common
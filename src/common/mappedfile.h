@@ -0,0 +1,72 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Read-only memory mapping of files.
+ */
+
+#ifndef COMMON_MAPPEDFILE_H
+#define COMMON_MAPPEDFILE_H
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+
+namespace Common {
+
+class UString;
+
+/** A file mapped read-only into memory.
+ *
+ *  The whole file is mapped at once, and its contents can then be
+ *  accessed directly through getData(), without any reads or seeks.
+ *  Pages are loaded by the OS on demand, so mapping even large files
+ *  is cheap. Since nothing is ever written, the data can be safely
+ *  accessed from several threads at once.
+ */
+class MappedFile : boost::noncopyable {
+public:
+	/** Map the file with the given UTF-8 encoded name.
+	 *
+	 *  Throws an Exception if the file can't be mapped, for example
+	 *  because it doesn't exist or is empty.
+	 */
+	MappedFile(const UString &fileName);
+	~MappedFile();
+
+	/** Return the mapped contents of the file. */
+	const byte *getData() const;
+	/** Return the size of the file. */
+	size_t size() const;
+
+private:
+	const byte *_data;
+	size_t _size;
+
+	void *_file;    ///< The OS file handle, if it has to be kept open.
+	void *_mapping; ///< The OS mapping handle, if there is one.
+
+	void map(const UString &fileName);
+	void unmap();
+};
+
+} // End of namespace Common
+
+#endif // COMMON_MAPPEDFILE_H
@@ -22,8 +22,11 @@
  *  Hashing/digesting using the MD5 algorithm.
  */
 
+#include <cassert>
 #include <cstring>
 
+#include "src/common/util.h"
+#include "src/common/endianness.h"
 #include "src/common/md5.h"
 #include "src/common/ustring.h"
 #include "src/common/readstream.h"
@@ -313,6 +316,218 @@ static void md5Final(byte *result, MD5Context &ctx) {
 // '--- MD5, based on the implementation by Alexander Peslyak ---'
 
 
+/* .--- Interleaved MD5 of several independent messages ---.
+ *
+ * The same MD5 transformation as above, but run on kMD5Lanes independent
+ * messages at once. Every step is done for all lanes in a tight loop,
+ * which the compiler can turn into SIMD instructions, and which at the
+ * very least hides the latencies of the long dependency chain of a single
+ * MD5 computation.
+ */
+static const size_t kMD5Lanes = 4;
+
+/** The state of all lanes, [a, b, c, d][lane]. */
+typedef uint32 MD5LaneState[4][kMD5Lanes];
+/** One 64-byte block of all lanes, [word][lane]. */
+typedef uint32 MD5LaneBlock[16][kMD5Lanes];
+
+#define STEP4(f, a, b, c, d, n, t, s) \
+	for (size_t l = 0; l < kMD5Lanes; l++) { \
+		(a)[l] += f((b)[l], (c)[l], (d)[l]) + x[(n)][l] + (t); \
+		(a)[l] = (((a)[l] << (s)) | ((a)[l] >> (32 - (s)))); \
+		(a)[l] += (b)[l]; \
+	}
+
+static void md5Body4(MD5LaneState &state, const MD5LaneBlock &x) {
+	uint32 a[kMD5Lanes], b[kMD5Lanes], c[kMD5Lanes], d[kMD5Lanes];
+
+	std::memcpy(a, state[0], sizeof(a));
+	std::memcpy(b, state[1], sizeof(b));
+	std::memcpy(c, state[2], sizeof(c));
+	std::memcpy(d, state[3], sizeof(d));
+
+/* Round 1 */
+		STEP4(F, a, b, c, d, 0, 0xD76AA478, 7)
+		STEP4(F, d, a, b, c, 1, 0xE8C7B756, 12)
+		STEP4(F, c, d, a, b, 2, 0x242070DB, 17)
+		STEP4(F, b, c, d, a, 3, 0xC1BDCEEE, 22)
+		STEP4(F, a, b, c, d, 4, 0xF57C0FAF, 7)
+		STEP4(F, d, a, b, c, 5, 0x4787C62A, 12)
+		STEP4(F, c, d, a, b, 6, 0xA8304613, 17)
+		STEP4(F, b, c, d, a, 7, 0xFD469501, 22)
+		STEP4(F, a, b, c, d, 8, 0x698098D8, 7)
+		STEP4(F, d, a, b, c, 9, 0x8B44F7AF, 12)
+		STEP4(F, c, d, a, b, 10, 0xFFFF5BB1, 17)
+		STEP4(F, b, c, d, a, 11, 0x895CD7BE, 22)
+		STEP4(F, a, b, c, d, 12, 0x6B901122, 7)
+		STEP4(F, d, a, b, c, 13, 0xFD987193, 12)
+		STEP4(F, c, d, a, b, 14, 0xA679438E, 17)
+		STEP4(F, b, c, d, a, 15, 0x49B40821, 22)
+
+/* Round 2 */
+		STEP4(G, a, b, c, d, 1, 0xF61E2562, 5)
+		STEP4(G, d, a, b, c, 6, 0xC040B340, 9)
+		STEP4(G, c, d, a, b, 11, 0x265E5A51, 14)
+		STEP4(G, b, c, d, a, 0, 0xE9B6C7AA, 20)
+		STEP4(G, a, b, c, d, 5, 0xD62F105D, 5)
+		STEP4(G, d, a, b, c, 10, 0x02441453, 9)
+		STEP4(G, c, d, a, b, 15, 0xD8A1E681, 14)
+		STEP4(G, b, c, d, a, 4, 0xE7D3FBC8, 20)
+		STEP4(G, a, b, c, d, 9, 0x21E1CDE6, 5)
+		STEP4(G, d, a, b, c, 14, 0xC33707D6, 9)
+		STEP4(G, c, d, a, b, 3, 0xF4D50D87, 14)
+		STEP4(G, b, c, d, a, 8, 0x455A14ED, 20)
+		STEP4(G, a, b, c, d, 13, 0xA9E3E905, 5)
+		STEP4(G, d, a, b, c, 2, 0xFCEFA3F8, 9)
+		STEP4(G, c, d, a, b, 7, 0x676F02D9, 14)
+		STEP4(G, b, c, d, a, 12, 0x8D2A4C8A, 20)
+
+/* Round 3 */
+		STEP4(H, a, b, c, d, 5, 0xFFFA3942, 4)
+		STEP4(H2, d, a, b, c, 8, 0x8771F681, 11)
+		STEP4(H, c, d, a, b, 11, 0x6D9D6122, 16)
+		STEP4(H2, b, c, d, a, 14, 0xFDE5380C, 23)
+		STEP4(H, a, b, c, d, 1, 0xA4BEEA44, 4)
+		STEP4(H2, d, a, b, c, 4, 0x4BDECFA9, 11)
+		STEP4(H, c, d, a, b, 7, 0xF6BB4B60, 16)
+		STEP4(H2, b, c, d, a, 10, 0xBEBFBC70, 23)
+		STEP4(H, a, b, c, d, 13, 0x289B7EC6, 4)
+		STEP4(H2, d, a, b, c, 0, 0xEAA127FA, 11)
+		STEP4(H, c, d, a, b, 3, 0xD4EF3085, 16)
+		STEP4(H2, b, c, d, a, 6, 0x04881D05, 23)
+		STEP4(H, a, b, c, d, 9, 0xD9D4D039, 4)
+		STEP4(H2, d, a, b, c, 12, 0xE6DB99E5, 11)
+		STEP4(H, c, d, a, b, 15, 0x1FA27CF8, 16)
+		STEP4(H2, b, c, d, a, 2, 0xC4AC5665, 23)
+
+/* Round 4 */
+		STEP4(I, a, b, c, d, 0, 0xF4292244, 6)
+		STEP4(I, d, a, b, c, 7, 0x432AFF97, 10)
+		STEP4(I, c, d, a, b, 14, 0xAB9423A7, 15)
+		STEP4(I, b, c, d, a, 5, 0xFC93A039, 21)
+		STEP4(I, a, b, c, d, 12, 0x655B59C3, 6)
+		STEP4(I, d, a, b, c, 3, 0x8F0CCC92, 10)
+		STEP4(I, c, d, a, b, 10, 0xFFEFF47D, 15)
+		STEP4(I, b, c, d, a, 1, 0x85845DD1, 21)
+		STEP4(I, a, b, c, d, 8, 0x6FA87E4F, 6)
+		STEP4(I, d, a, b, c, 15, 0xFE2CE6E0, 10)
+		STEP4(I, c, d, a, b, 6, 0xA3014314, 15)
+		STEP4(I, b, c, d, a, 13, 0x4E0811A1, 21)
+		STEP4(I, a, b, c, d, 4, 0xF7537E82, 6)
+		STEP4(I, d, a, b, c, 11, 0xBD3AF235, 10)
+		STEP4(I, c, d, a, b, 2, 0x2AD7D2BB, 15)
+		STEP4(I, b, c, d, a, 9, 0xEB86D391, 21)
+
+	for (size_t l = 0; l < kMD5Lanes; l++) {
+		state[0][l] += a[l];
+		state[1][l] += b[l];
+		state[2][l] += c[l];
+		state[3][l] += d[l];
+	}
+}
+
+#undef STEP4
+
+/** A message to be hashed in one MD5 lane. */
+struct MD5LaneMessage {
+	const byte *data;
+	size_t fullBlocks;  ///< Number of complete 64-byte blocks in data.
+	size_t blockCount;  ///< Number of blocks, including the padding.
+
+	byte tail[128];     ///< The remaining data, plus padding and length.
+
+	MD5LaneMessage() : data(0), fullBlocks(0), blockCount(0) {
+	}
+
+	void set(const byte *d, size_t size) {
+		data       = d;
+		fullBlocks = size / 64;
+
+		const size_t tailSize = size % 64;
+		blockCount = fullBlocks + ((tailSize < 56) ? 1 : 2);
+
+		const size_t tailBlocks = blockCount - fullBlocks;
+
+		std::memset(tail, 0, tailBlocks * 64);
+		if (tailSize > 0)
+			std::memcpy(tail, data + fullBlocks * 64, tailSize);
+
+		tail[tailSize] = 0x80;
+
+		const uint64 bits = ((uint64) size) << 3;
+		for (size_t i = 0; i < 8; i++)
+			tail[tailBlocks * 64 - 8 + i] = (byte) (bits >> (i * 8));
+	}
+
+	const byte *getBlock(size_t n) const {
+		if (n < fullBlocks)
+			return data + n * 64;
+
+		return tail + (n - fullBlocks) * 64;
+	}
+};
+
+static void md5Lanes(const byte * const *data, const size_t *dataLength, size_t count, byte *digests) {
+	assert(count <= kMD5Lanes);
+
+	MD5LaneMessage messages[kMD5Lanes];
+
+	size_t maxBlocks = 0;
+	for (size_t l = 0; l < count; l++) {
+		messages[l].set(data[l], dataLength[l]);
+
+		maxBlocks = MAX(maxBlocks, messages[l].blockCount);
+	}
+
+	MD5LaneState state;
+	for (size_t l = 0; l < kMD5Lanes; l++) {
+		state[0][l] = 0x67452301;
+		state[1][l] = 0xEFCDAB89;
+		state[2][l] = 0x98BADCFE;
+		state[3][l] = 0x10325476;
+	}
+
+	MD5LaneBlock block;
+	std::memset(block, 0, sizeof(block));
+
+	for (size_t n = 0; n < maxBlocks; n++) {
+		bool allLanes = count == kMD5Lanes;
+
+		for (size_t l = 0; l < count; l++) {
+			if (n >= messages[l].blockCount) {
+				allLanes = false;
+				continue;
+			}
+
+			const byte *ptr = messages[l].getBlock(n);
+			for (size_t i = 0; i < 16; i++)
+				block[i][l] = READ_LE_UINT32(ptr + i * 4);
+		}
+
+		if (allLanes) {
+			md5Body4(state, block);
+			continue;
+		}
+
+		MD5LaneState newState;
+		std::memcpy(newState, state, sizeof(state));
+
+		md5Body4(newState, block);
+
+		// Only lanes whose message still had this block take the new state
+		for (size_t l = 0; l < count; l++)
+			if (n < messages[l].blockCount)
+				for (size_t i = 0; i < 4; i++)
+					state[i][l] = newState[i][l];
+	}
+
+	for (size_t l = 0; l < count; l++)
+		for (size_t i = 0; i < 4; i++)
+			WRITE_LE_UINT32(digests + l * kMD5Length + i * 4, state[i][l]);
+}
+// '--- Interleaved MD5 of several independent messages ---'
+
+
 void hashMD5(ReadStream &stream, std::vector<byte> &digest) {
 	MD5Context ctx;
 
@@ -344,6 +559,22 @@ void hashMD5(const std::vector<byte> &data, std::vector<byte> &digest) {
 	hashMD5(&data[0], data.size(), digest);
 }
 
+void hashMD5(const byte * const *data, const size_t *dataLength, size_t count,
+             std::vector< std::vector<byte> > &digests) {
+
+	digests.resize(count);
+
+	byte laneDigests[kMD5Lanes * kMD5Length];
+	for (size_t i = 0; i < count; i += kMD5Lanes) {
+		const size_t lanes = MIN(kMD5Lanes, count - i);
+
+		md5Lanes(data + i, dataLength + i, lanes, laneDigests);
+
+		for (size_t l = 0; l < lanes; l++)
+			digests[i + l].assign(laneDigests + l * kMD5Length, laneDigests + (l + 1) * kMD5Length);
+	}
+}
+
 
 bool compareMD5Digest(ReadStream &stream, const std::vector<byte> &digest) {
 	if (digest.size() != kMD5Length)
@@ -46,6 +46,20 @@ void hashMD5(const UString &string, std::vector<byte> &digest);
 /** Hash the array of data into an MD5 digest of 16 bytes. */
 void hashMD5(const std::vector<byte> &data, std::vector<byte> &digest);
 
+/** Hash several independent blocks of data into one MD5 digest of 16 bytes each.
+ *
+ *  This produces the same digests as calling hashMD5() on each block of
+ *  data separately, but several blocks are hashed interleaved, which is
+ *  noticeably faster when hashing a lot of blocks at once.
+ *
+ *  @param data       The count blocks of data to hash.
+ *  @param dataLength The lengths of the count blocks of data.
+ *  @param count      The number of blocks of data to hash.
+ *  @param digests    The count resulting digests.
+ */
+void hashMD5(const byte * const *data, const size_t *dataLength, size_t count,
+             std::vector< std::vector<byte> > &digests);
+
 /** Hash the stream and compare the digests, returning true if they match. */
 bool compareMD5Digest(ReadStream &stream, const std::vector<byte> &digest);
 /** Hash the array of data and compare the digests, returning true if they match. */
@@ -0,0 +1,164 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Accounting of the memory used by different subsystems.
+ */
+
+#include <cassert>
+
+#include <atomic>
+
+#include "src/common/memaccount.h"
+#include "src/common/ustring.h"
+
+namespace Common {
+
+static const char * const kMemoryCategoryNames[kMemoryCategoryMAX] = {
+	"Images", "Textures", "Meshes", "Model cache", "Resources", "Sound", "Parsers", "Scripts"
+};
+
+static std::atomic<uint64> memoryCurrent[kMemoryCategoryMAX];
+static std::atomic<uint64> memoryPeak   [kMemoryCategoryMAX];
+static std::atomic<uint64> memoryObjects[kMemoryCategoryMAX];
+
+static void addMemory(MemoryCategory category, uint64 size) {
+	const uint64 current = memoryCurrent[category].fetch_add(size, std::memory_order_relaxed) + size;
+
+	uint64 peak = memoryPeak[category].load(std::memory_order_relaxed);
+	while ((current > peak) &&
+	       !memoryPeak[category].compare_exchange_weak(peak, current, std::memory_order_relaxed))
+		;
+}
+
+static void removeMemory(MemoryCategory category, uint64 size) {
+	memoryCurrent[category].fetch_sub(size, std::memory_order_relaxed);
+}
+
+
+MemoryUsage::MemoryUsage() : current(0), peak(0), objects(0) {
+}
+
+
+MemoryAccount::MemoryAccount(MemoryCategory category) : _category(category), _size(0) {
+	assert(((size_t) _category) < kMemoryCategoryMAX);
+}
+
+MemoryAccount::~MemoryAccount() {
+	set(0);
+}
+
+size_t MemoryAccount::get() const {
+	return _size;
+}
+
+void MemoryAccount::set(size_t size) {
+	if (size == _size)
+		return;
+
+	if ((_size == 0) && (size != 0))
+		memoryObjects[_category].fetch_add(1, std::memory_order_relaxed);
+	else if ((_size != 0) && (size == 0))
+		memoryObjects[_category].fetch_sub(1, std::memory_order_relaxed);
+
+	if (size > _size)
+		addMemory(_category, size - _size);
+	else
+		removeMemory(_category, _size - size);
+
+	_size = size;
+}
+
+void MemoryAccount::add(size_t size) {
+	set(_size + size);
+}
+
+void MemoryAccount::remove(size_t size) {
+	assert(size <= _size);
+
+	set(_size - size);
+}
+
+void MemoryAccount::swap(MemoryAccount &right) {
+	assert(_category == right._category);
+
+	// Both accounts are in the same category, so the global usage doesn't change
+	const size_t size = _size;
+
+	_size       = right._size;
+	right._size = size;
+}
+
+
+MemoryUsage getMemoryUsage(MemoryCategory category) {
+	assert(((size_t) category) < kMemoryCategoryMAX);
+
+	MemoryUsage usage;
+
+	usage.current = memoryCurrent[category].load(std::memory_order_relaxed);
+	usage.peak    = memoryPeak   [category].load(std::memory_order_relaxed);
+	usage.objects = memoryObjects[category].load(std::memory_order_relaxed);
+
+	return usage;
+}
+
+void resetMemoryPeaks() {
+	for (size_t i = 0; i < kMemoryCategoryMAX; i++)
+		memoryPeak[i].store(memoryCurrent[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+const char *getMemoryCategoryName(MemoryCategory category) {
+	if (((size_t) category) >= kMemoryCategoryMAX)
+		return "Invalid";
+
+	return kMemoryCategoryNames[category];
+}
+
+UString formatMemorySize(uint64 size) {
+	if (size < 1024)
+		return UString::format("%u B", (uint) size);
+
+	if (size < (1024 * 1024))
+		return UString::format("%.2f KiB", size / 1024.0);
+
+	if (size < (1024ULL * 1024 * 1024))
+		return UString::format("%.2f MiB", size / (1024.0 * 1024.0));
+
+	return UString::format("%.2f GiB", size / (1024.0 * 1024.0 * 1024.0));
+}
+
+UString getMemoryUsageSummary() {
+	UString summary;
+
+	uint64 total = 0;
+	for (size_t i = 0; i < kMemoryCategoryMAX; i++) {
+		const MemoryUsage usage = getMemoryUsage((MemoryCategory) i);
+
+		summary += UString::format("%s: %s (peak %s), ", kMemoryCategoryNames[i],
+		                           formatMemorySize(usage.current).c_str(),
+		                           formatMemorySize(usage.peak).c_str());
+
+		total += usage.current;
+	}
+
+	return summary + "total: " + formatMemorySize(total);
+}
+
+} // End of namespace Common
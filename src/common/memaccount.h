@@ -0,0 +1,109 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Accounting of the memory used by different subsystems.
+ */
+
+#ifndef COMMON_MEMACCOUNT_H
+#define COMMON_MEMACCOUNT_H
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+
+namespace Common {
+
+class UString;
+
+/** The categories memory is accounted in. */
+enum MemoryCategory {
+	kMemoryImages    , ///< Decoded image data.
+	kMemoryTextures  , ///< Image data uploaded into OpenGL textures.
+	kMemoryMeshes    , ///< Vertex and index data of meshes and models.
+	kMemoryModelCache, ///< Compiled model data held by the compiled model cache.
+	kMemoryResources , ///< The resource manager's index of all known resources.
+	kMemorySound     , ///< Sound data queued into OpenAL buffers.
+	kMemoryParsers   , ///< Data held by loaded GFF files.
+	kMemoryScripts   , ///< Bytecode of loaded NWScript scripts.
+
+	kMemoryCategoryMAX
+};
+
+/** The memory usage of a category. */
+struct MemoryUsage {
+	uint64 current; ///< The number of bytes currently used.
+	uint64 peak;    ///< The highest number of bytes ever used at the same time.
+	uint64 objects; ///< The number of objects currently using memory.
+
+	MemoryUsage();
+};
+
+/** An account of the memory used by one object.
+ *
+ *  An object that holds memory of a certain category keeps a MemoryAccount
+ *  as a member and updates it whenever the amount of memory it holds
+ *  changes. The global usage of the category is updated accordingly, and
+ *  when the account is destroyed, its memory is given back.
+ *
+ *  Updating an account only costs a few atomic additions, and the usage
+ *  can be read from any thread.
+ */
+class MemoryAccount : boost::noncopyable {
+public:
+	MemoryAccount(MemoryCategory category);
+	~MemoryAccount();
+
+	/** Return the number of bytes currently held in this account. */
+	size_t get() const;
+
+	/** Set the number of bytes held in this account. */
+	void set(size_t size);
+	/** Add bytes to this account. */
+	void add(size_t size);
+	/** Remove bytes from this account. */
+	void remove(size_t size);
+
+	/** Swap the contents of two accounts of the same category. */
+	void swap(MemoryAccount &right);
+
+private:
+	MemoryCategory _category;
+	size_t _size;
+};
+
+/** Return the current memory usage of a category. */
+MemoryUsage getMemoryUsage(MemoryCategory category);
+
+/** Reset the peak memory usage of all categories to their current usage. */
+void resetMemoryPeaks();
+
+/** Return the name of a memory category. */
+const char *getMemoryCategoryName(MemoryCategory category);
+
+/** Format an amount of memory in a human-readable way, like "12.34 MiB". */
+UString formatMemorySize(uint64 size);
+
+/** Return a one-line summary of the memory usage of all categories, suitable for logging. */
+UString getMemoryUsageSummary();
+
+} // End of namespace Common
+
+#endif // COMMON_MEMACCOUNT_H
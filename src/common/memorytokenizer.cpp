@@ -0,0 +1,329 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Parse tokens out of a memory stream.
+ */
+
+#include <cassert>
+#include <cctype>
+
+#include "src/common/memorytokenizer.h"
+#include "src/common/memreadstream.h"
+
+namespace Common {
+
+bool TokenView::equalsIgnoreCase(const char *str) const {
+	if (std::strlen(str) != _size)
+		return false;
+
+	for (size_t i = 0; i < _size; i++)
+		if (std::tolower((byte) _data[i]) != std::tolower((byte) str[i]))
+			return false;
+
+	return true;
+}
+
+UString TokenView::toString() const {
+	bool isASCII = true;
+	for (size_t i = 0; (i < _size) && isASCII; i++)
+		isASCII = (byte) _data[i] < 0x80;
+
+	if (isASCII)
+		return UString(_data, _size);
+
+	// Like the StreamTokenizer, treat each byte as a character on its own
+	UString str;
+	for (size_t i = 0; i < _size; i++)
+		str += (uint32) (byte) _data[i];
+
+	return str;
+}
+
+
+MemoryTokenizer::Cursor::Cursor(MemoryReadStream &stream) :
+	data(stream.getData()), size(stream.size()), pos(stream.pos()), eos(false) {
+
+}
+
+void MemoryTokenizer::Cursor::apply(MemoryReadStream &stream) const {
+	stream.seek(pos);
+
+	/* The StreamTokenizer tried to read past the end of the stream here,
+	 * setting the end-of-stream flag. Do the same. */
+	if (eos) {
+		byte b;
+		stream.read(&b, 1);
+	}
+}
+
+
+MemoryTokenizer::MemoryTokenizer(StreamTokenizer::ConsecutiveSeparatorRule conSepRule) :
+	_conSepRule(conSepRule), _tokenStorageUsed(0) {
+
+	std::memset(_classes, kClassNone, sizeof(_classes));
+}
+
+void MemoryTokenizer::addClass(byte c, CharacterClass characterClass) {
+	assert(_classes[c] == kClassNone);
+
+	_classes[c] = characterClass;
+}
+
+void MemoryTokenizer::addSeparator(byte c) {
+	addClass(c, kClassSeparator);
+}
+
+void MemoryTokenizer::addChunkEnd(byte c) {
+	addClass(c, kClassChunkEnd);
+}
+
+void MemoryTokenizer::addQuote(byte c) {
+	addClass(c, kClassQuote);
+}
+
+void MemoryTokenizer::addIgnore(byte c) {
+	addClass(c, kClassIgnore);
+}
+
+TokenView MemoryTokenizer::getToken(Cursor &cursor) {
+	bool chunkEnd  = false;
+	bool inQuote   = false;
+	int  separator = -1;
+
+	/* As long as we haven't seen any quote or ignored characters, the token is
+	 * a simple run of characters in the stream, from start to end. Otherwise,
+	 * we need to collect the characters into a separate string. */
+	const size_t start = cursor.pos;
+	size_t end = start;
+
+	std::string *storage = 0;
+
+	while (true) {
+		if (cursor.pos >= cursor.size) {
+			cursor.eos = true;
+			break;
+		}
+
+		const byte c = cursor.data[cursor.pos++];
+		const byte characterClass = _classes[c];
+
+		// A normal character, or any character but ignored and quote characters within quotes
+		if ((characterClass == kClassNone) ||
+		    (inQuote && !(characterClass & (kClassQuote | kClassIgnore)))) {
+
+			if (storage)
+				storage->push_back(c);
+			else
+				end = cursor.pos;
+
+			continue;
+		}
+
+		if (characterClass & (kClassIgnore | kClassQuote)) {
+			if (!storage) {
+				if (_tokenStorageUsed == _tokenStorage.size())
+					_tokenStorage.push_back(std::string());
+
+				storage = &_tokenStorage[_tokenStorageUsed++];
+				storage->assign(reinterpret_cast<const char *>(cursor.data + start), end - start);
+			}
+
+			if (characterClass & kClassQuote)
+				inQuote = !inQuote;
+
+			continue;
+		}
+
+		// Stop before a chunk end character
+		if (characterClass & kClassChunkEnd) {
+			cursor.pos--;
+			chunkEnd = true;
+			break;
+		}
+
+		// Stop after a separator character
+		separator = c;
+		break;
+	}
+
+	TokenView token = storage ? TokenView(storage->data(), storage->size()) :
+	                            TokenView(reinterpret_cast<const char *>(cursor.data + start), end - start);
+
+	// Cut off the token at the first \0, like the StreamTokenizer does
+	const char *nullChar = static_cast<const char *>(std::memchr(token.data(), '\0', token.size()));
+	if (nullChar)
+		token = TokenView(token.data(), nullChar - token.data());
+
+	if (chunkEnd || (_conSepRule == StreamTokenizer::kRuleHeed))
+		return token;
+
+	// Skip following consecutive separators, depending on the ConsecutiveSeparatorRule
+	while (true) {
+		if (cursor.pos >= cursor.size) {
+			cursor.eos = true;
+			break;
+		}
+
+		const byte c = cursor.data[cursor.pos];
+
+		bool shouldSkip = (_classes[c] & kClassSeparator) != 0;
+		if ((_conSepRule == StreamTokenizer::kRuleIgnoreSame) && (c != separator))
+			shouldSkip = false;
+
+		if (!shouldSkip)
+			break;
+
+		cursor.pos++;
+	}
+
+	return token;
+}
+
+bool MemoryTokenizer::isChunkEnd(Cursor &cursor) const {
+	if (cursor.pos >= cursor.size) {
+		cursor.eos = true;
+		return true;
+	}
+
+	return (_classes[cursor.data[cursor.pos]] & kClassChunkEnd) != 0;
+}
+
+void MemoryTokenizer::skipChunk(Cursor &cursor) const {
+	while (true) {
+		if (cursor.pos >= cursor.size) {
+			cursor.eos = true;
+			break;
+		}
+
+		if (_classes[cursor.data[cursor.pos]] & kClassChunkEnd)
+			break;
+
+		cursor.pos++;
+	}
+}
+
+TokenView MemoryTokenizer::getToken(MemoryReadStream &stream) {
+	_tokenStorageUsed = 0;
+
+	Cursor cursor(stream);
+	TokenView token = getToken(cursor);
+	cursor.apply(stream);
+
+	return token;
+}
+
+size_t MemoryTokenizer::getTokens(MemoryReadStream &stream, std::vector<TokenView> &list,
+		size_t min, size_t max, const TokenView &def) {
+
+	assert(max >= min);
+
+	_tokenStorageUsed = 0;
+
+	list.clear();
+	list.reserve(min);
+
+	Cursor cursor(stream);
+
+	size_t realTokenCount = 0;
+	while (!isChunkEnd(cursor) && (realTokenCount < max)) {
+		const TokenView token = getToken(cursor);
+
+		if (!token.empty() || (_conSepRule != StreamTokenizer::kRuleIgnoreAll)) {
+			list.push_back(token);
+			realTokenCount++;
+		}
+	}
+
+	cursor.apply(stream);
+
+	while (list.size() < min)
+		list.push_back(def);
+
+	return realTokenCount;
+}
+
+size_t MemoryTokenizer::getTokens(MemoryReadStream &stream, std::vector<UString> &list,
+		size_t min, size_t max, const UString &def) {
+
+	std::vector<TokenView> tokens;
+	const size_t realTokenCount = getTokens(stream, tokens, 0, max);
+
+	list.clear();
+	list.reserve(MAX(min, tokens.size()));
+
+	for (std::vector<TokenView>::const_iterator t = tokens.begin(); t != tokens.end(); ++t)
+		list.push_back(t->toString());
+
+	while (list.size() < min)
+		list.push_back(def);
+
+	return realTokenCount;
+}
+
+void MemoryTokenizer::findFirstToken(MemoryReadStream &stream) {
+	Cursor cursor(stream);
+
+	while (true) {
+		if (cursor.pos >= cursor.size) {
+			cursor.eos = true;
+			break;
+		}
+
+		if (!(_classes[cursor.data[cursor.pos]] & (kClassSeparator | kClassIgnore)))
+			break;
+
+		cursor.pos++;
+	}
+
+	cursor.apply(stream);
+}
+
+void MemoryTokenizer::skipToken(MemoryReadStream &stream, size_t n) {
+	Cursor cursor(stream);
+
+	while (n-- > 0) {
+		_tokenStorageUsed = 0;
+		getToken(cursor);
+	}
+
+	cursor.apply(stream);
+}
+
+void MemoryTokenizer::skipChunk(MemoryReadStream &stream) {
+	Cursor cursor(stream);
+	skipChunk(cursor);
+	cursor.apply(stream);
+}
+
+void MemoryTokenizer::nextChunk(MemoryReadStream &stream) {
+	Cursor cursor(stream);
+
+	skipChunk(cursor);
+
+	if (cursor.pos >= cursor.size)
+		cursor.eos = true;
+	else if (_classes[cursor.data[cursor.pos]] & kClassChunkEnd)
+		cursor.pos++;
+
+	cursor.apply(stream);
+}
+
+} // End of namespace Common
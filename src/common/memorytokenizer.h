@@ -0,0 +1,182 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Parse tokens out of a memory stream.
+ */
+
+#ifndef COMMON_MEMORYTOKENIZER_H
+#define COMMON_MEMORYTOKENIZER_H
+
+#include <cstring>
+
+#include <vector>
+#include <deque>
+#include <string>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+#include "src/common/strutil.h"
+#include "src/common/streamtokenizer.h"
+
+namespace Common {
+
+class MemoryReadStream;
+
+/** A token parsed by a MemoryTokenizer.
+ *
+ *  A token is only a view onto the characters, which are either directly in
+ *  the stream's memory or within the tokenizer. It stays valid until the next
+ *  token is parsed, or, for tokens parsed by MemoryTokenizer::getTokens(),
+ *  until the next call to getTokens() or getToken().
+ */
+class TokenView {
+public:
+	TokenView() : _data(""), _size(0) { }
+	TokenView(const char *data, size_t size) : _data(data), _size(size) { }
+	TokenView(const char *str) : _data(str), _size(std::strlen(str)) { }
+
+	const char *data() const { return _data; }
+	size_t size() const { return _size; }
+
+	bool empty() const { return _size == 0; }
+
+	char operator[](size_t i) const { return _data[i]; }
+
+	bool operator==(const char *str) const {
+		return (std::strlen(str) == _size) && (std::memcmp(_data, str, _size) == 0);
+	}
+
+	bool operator!=(const char *str) const {
+		return !(*this == str);
+	}
+
+	bool equalsIgnoreCase(const char *str) const;
+
+	/** Convert the token into a UString, with each byte as one character.
+	 *
+	 *  This results in the same string the StreamTokenizer creates.
+	 */
+	UString toString() const;
+
+	/** Parse the token into any POD integer, float/double or bool type.
+	 *
+	 *  @see parseString()
+	 */
+	template<typename T>
+	void parse(T &value, bool allowEmpty = false) const {
+		parseString(_data, _size, value, allowEmpty);
+	}
+
+private:
+	const char *_data;
+	size_t _size;
+};
+
+/** Tokenizes a memory stream.
+ *
+ *  This works exactly like the StreamTokenizer, and the tokens, and the
+ *  position of the stream afterwards, are the same. However, instead of
+ *  reading the stream character by character and creating a new string for
+ *  each token, the MemoryTokenizer looks straight at the memory, classifies
+ *  the characters with a lookup table and returns views onto the memory.
+ *
+ *  Since it works on bytes, only characters < 256 can be special characters.
+ *
+ *  @see StreamTokenizer
+ */
+class MemoryTokenizer {
+public:
+	MemoryTokenizer(StreamTokenizer::ConsecutiveSeparatorRule conSepRule = StreamTokenizer::kRuleHeed);
+
+	/** Add a character on where to split tokens. @see StreamTokenizer::addSeparator() */
+	void addSeparator(byte c);
+	/** Add a character marking the end of a chunk. @see StreamTokenizer::addChunkEnd() */
+	void addChunkEnd (byte c);
+	/** Add a character able to enclose separators and chunk ends. @see StreamTokenizer::addQuote() */
+	void addQuote    (byte c);
+	/** Add a character to ignore. @see StreamTokenizer::addIgnore() */
+	void addIgnore   (byte c);
+
+	/** Parse a token out of the stream. @see StreamTokenizer::getToken() */
+	TokenView getToken(MemoryReadStream &stream);
+
+	/** Parse tokens out of the stream. @see StreamTokenizer::getTokens() */
+	size_t getTokens(MemoryReadStream &stream, std::vector<TokenView> &list,
+			size_t min = 0, size_t max = SIZE_MAX, const TokenView &def = TokenView());
+
+	/** Parse tokens out of the stream, into strings. @see StreamTokenizer::getTokens() */
+	size_t getTokens(MemoryReadStream &stream, std::vector<UString> &list,
+			size_t min = 0, size_t max = SIZE_MAX, const UString &def = "");
+
+	/** Find the first token character, skipping past separators. @see StreamTokenizer::findFirstToken() */
+	void findFirstToken(MemoryReadStream &stream);
+
+	/** Skip a number of tokens. */
+	void skipToken(MemoryReadStream &stream, size_t n = 1);
+
+	/** Skip to the end of the chunk. @see StreamTokenizer::skipChunk() */
+	void skipChunk(MemoryReadStream &stream);
+
+	/** Skip past end of chunk characters. @see StreamTokenizer::nextChunk() */
+	void nextChunk(MemoryReadStream &stream);
+
+private:
+	enum CharacterClass {
+		kClassNone      = 0,
+		kClassSeparator = 1 << 0,
+		kClassQuote     = 1 << 1,
+		kClassChunkEnd  = 1 << 2,
+		kClassIgnore    = 1 << 3
+	};
+
+	/** The current state of parsing through a stream. */
+	struct Cursor {
+		const byte *data;
+		size_t size;
+		size_t pos;
+
+		/** Did we try to read past the end? */
+		bool eos;
+
+		Cursor(MemoryReadStream &stream);
+
+		/** Move the stream to the position of the cursor. */
+		void apply(MemoryReadStream &stream) const;
+	};
+
+	StreamTokenizer::ConsecutiveSeparatorRule _conSepRule;
+
+	byte _classes[256];
+
+	/** Storage for tokens that aren't simply a run of characters in the stream. */
+	std::deque<std::string> _tokenStorage;
+	size_t _tokenStorageUsed;
+
+	void addClass(byte c, CharacterClass characterClass);
+
+	TokenView getToken(Cursor &cursor);
+	bool isChunkEnd(Cursor &cursor) const;
+	void skipChunk(Cursor &cursor) const;
+};
+
+} // End of namespace Common
+
+#endif // COMMON_MEMORYTOKENIZER_H
@@ -72,6 +72,18 @@ size_t MemoryReadStream::read(void *dataPtr, size_t dataSize) {
 	return dataSize;
 }
 
+const byte *MemoryReadStream::readInPlace(size_t dataSize) {
+	if (dataSize > _size - _pos)
+		return 0;
+
+	const byte *data = _ptr;
+
+	_ptr += dataSize;
+	_pos += dataSize;
+
+	return data;
+}
+
 size_t MemoryReadStream::seek(ptrdiff_t offset, Origin whence) {
 	assert((size_t)_pos <= _size);
 
@@ -93,6 +93,8 @@ public:
 
 	size_t read(void *dataPtr, size_t dataSize);
 
+	const byte *readInPlace(size_t dataSize);
+
 	bool eos() const;
 
 	size_t pos() const;
@@ -157,6 +159,22 @@ public:
 	double readIEEEDouble() {
 		return _bigEndian ? readIEEEDoubleBE() : readIEEEDoubleLE();
 	}
+
+	template<typename T>
+	void readArray(T *dest, size_t count) {
+		if (_bigEndian)
+			readArrayBE(dest, count);
+		else
+			readArrayLE(dest, count);
+	}
+
+	template<typename T>
+	void readArrayStrided(T *dest, size_t count, size_t width, size_t destStride, size_t srcStride) {
+		if (_bigEndian)
+			readArrayStridedBE(dest, count, width, destStride, srcStride);
+		else
+			readArrayStridedLE(dest, count, width, destStride, srcStride);
+	}
 };
 
 } // End of namespace Common
@@ -48,6 +48,12 @@
  */
 
 #include <cassert>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#endif
 
 #include "src/common/readstream.h"
 #include "src/common/memreadstream.h"
@@ -73,6 +79,156 @@ MemoryReadStream *ReadStream::readStream(size_t dataSize) {
 	return new MemoryReadStream(buf.release(), dataSize, true);
 }
 
+const byte *ReadStream::readInPlace(size_t UNUSED(dataSize)) {
+	return 0;
+}
+
+#if defined(XOREOS_BIG_ENDIAN)
+static const bool kHostBigEndian = true;
+#else
+static const bool kHostBigEndian = false;
+#endif
+
+static void swapBytes16(byte *data, size_t count) {
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	for (; (i + 8) <= count; i += 8, data += 16) {
+		const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(data), _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8)));
+	}
+#endif
+
+	for (; i < count; i++, data += 2)
+		std::swap(data[0], data[1]);
+}
+
+static void swapBytes32(byte *data, size_t count) {
+	size_t i = 0;
+
+#if defined(__SSE2__)
+	for (; (i + 4) <= count; i += 4, data += 16) {
+		__m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+
+		// Swap the two 16-bit halves of each value, then the two bytes of each half
+		x = _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, 0xB1), 0xB1);
+		x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(data), x);
+	}
+#endif
+
+	for (; i < count; i++, data += 4) {
+		std::swap(data[0], data[3]);
+		std::swap(data[1], data[2]);
+	}
+}
+
+static void swapBytes64(byte *data, size_t count) {
+	for (size_t i = 0; i < count; i++, data += 8) {
+		std::swap(data[0], data[7]);
+		std::swap(data[1], data[6]);
+		std::swap(data[2], data[5]);
+		std::swap(data[3], data[4]);
+	}
+}
+
+/** Convert count values of valueSize bytes each between big and little endian, in place. */
+static void swapBytes(byte *data, size_t count, size_t valueSize) {
+	switch (valueSize) {
+		case 2:
+			swapBytes16(data, count);
+			break;
+
+		case 4:
+			swapBytes32(data, count);
+			break;
+
+		case 8:
+			swapBytes64(data, count);
+			break;
+
+		default:
+			break;
+	}
+}
+
+void ReadStream::readArray(void *dest, size_t count, size_t valueSize, bool bigEndian) {
+	const size_t dataSize = count * valueSize;
+	if (dataSize == 0)
+		return;
+
+	assert(dest);
+
+	if (read(dest, dataSize) != dataSize)
+		throw Exception(kReadError);
+
+	if (bigEndian != kHostBigEndian)
+		swapBytes(reinterpret_cast<byte *>(dest), count, valueSize);
+}
+
+void ReadStream::readArrayStrided(void *dest, size_t count, size_t valueSize, size_t width,
+                                  size_t destStride, size_t srcStride, bool bigEndian) {
+
+	const size_t elementSize = width * valueSize;
+	if ((srcStride < elementSize) || (destStride < elementSize))
+		throw Exception("Invalid array stride (%u, %u < %u)", (uint)srcStride, (uint)destStride, (uint)elementSize);
+
+	if ((count == 0) || (elementSize == 0))
+		return;
+
+	assert(dest);
+
+	// Tightly packed on both sides: read it all in one go
+	if ((srcStride == elementSize) && (destStride == elementSize)) {
+		readArray(dest, count * width, valueSize, bigEndian);
+		return;
+	}
+
+	byte *destData = reinterpret_cast<byte *>(dest);
+
+	const size_t dataSize = (count - 1) * srcStride + elementSize;
+
+	const byte *srcData = readInPlace(dataSize);
+	if (srcData) {
+		// Memory stream: gather straight out of the stream's buffer
+
+		for (size_t i = 0; i < count; i++, srcData += srcStride, destData += destStride)
+			std::memcpy(destData, srcData, elementSize);
+
+	} else {
+		// Otherwise, read the stream in chunks of whole source elements
+
+		static const size_t kChunkSize = 4096;
+
+		const size_t chunkCount = MAX<size_t>(kChunkSize / srcStride, 1);
+		ScopedArray<byte> buffer(new byte[chunkCount * srcStride]);
+
+		for (size_t i = 0; i < count; ) {
+			const size_t n = MIN(chunkCount, count - i);
+
+			// The last element doesn't need the trailing data skipped by the stride
+			const size_t chunkSize = ((i + n) == count) ? ((n - 1) * srcStride + elementSize) : (n * srcStride);
+			if (read(buffer.get(), chunkSize) != chunkSize)
+				throw Exception(kReadError);
+
+			const byte *chunk = buffer.get();
+			for (size_t j = 0; j < n; j++, chunk += srcStride, destData += destStride)
+				std::memcpy(destData, chunk, elementSize);
+
+			i += n;
+		}
+	}
+
+	if ((bigEndian != kHostBigEndian) && (valueSize > 1)) {
+		destData = reinterpret_cast<byte *>(dest);
+
+		for (size_t i = 0; i < count; i++, destData += destStride)
+			swapBytes(destData, width, valueSize);
+	}
+}
+
 
 SeekableReadStream::SeekableReadStream() {
 }
@@ -123,6 +279,17 @@ size_t SubReadStream::read(void *dataPtr, size_t dataSize) {
 	return dataSize;
 }
 
+const byte *SubReadStream::readInPlace(size_t dataSize) {
+	if (dataSize > (size_t)(_end - _pos))
+		return 0;
+
+	const byte *data = _parentStream->readInPlace(dataSize);
+	if (data)
+		_pos += dataSize;
+
+	return data;
+}
+
 
 SeekableSubReadStream::SeekableSubReadStream(SeekableReadStream *parentStream, size_t begin,
                                              size_t end, bool disposeParentStream) :
@@ -50,6 +50,8 @@
 #ifndef COMMON_READSTREAM_H
 #define COMMON_READSTREAM_H
 
+#include <type_traits>
+
 #include "src/common/types.h"
 #include "src/common/endianness.h"
 #include "src/common/disposableptr.h"
@@ -252,12 +254,87 @@ public:
 		return convertIEEEDouble(readUint64BE());
 	}
 
+	/** Read an array of count values of the type T, stored in little endian
+	 *  (LSB first) order, from the stream into dest.
+	 *
+	 *  T has to be an integer or IEEE floating point type of 1, 2, 4 or 8 bytes.
+	 *  This is considerably faster than reading the values one by one.
+	 *
+	 *  When reading fails, a kReadError exception is thrown.
+	 */
+	template<typename T>
+	void readArrayLE(T *dest, size_t count) {
+		readArray(dest, count, getArrayValueSize<T>(), false);
+	}
+
+	/** Read an array of count values of the type T, stored in big endian
+	 *  (MSB first) order, from the stream into dest.
+	 *
+	 *  @see readArrayLE()
+	 */
+	template<typename T>
+	void readArrayBE(T *dest, size_t count) {
+		readArray(dest, count, getArrayValueSize<T>(), true);
+	}
+
+	/** Read count elements of width values of the type T each, stored in
+	 *  little endian (LSB first) order, from the stream into dest.
+	 *
+	 *  Within the stream, the starts of two consecutive elements are srcStride
+	 *  bytes apart; the data in between is skipped. In dest, the starts of two
+	 *  consecutive elements are destStride values of T apart; the values in
+	 *  between are left untouched. This allows to, for example, read the
+	 *  positions out of an array of vertex structs straight into an interleaved
+	 *  vertex buffer.
+	 *
+	 *  After the call, the stream is positioned directly after the last value read.
+	 *
+	 *  When reading fails, a kReadError exception is thrown.
+	 */
+	template<typename T>
+	void readArrayStridedLE(T *dest, size_t count, size_t width, size_t destStride, size_t srcStride) {
+		readArrayStrided(dest, count, getArrayValueSize<T>(), width, destStride * sizeof(T), srcStride, false);
+	}
+
+	/** Read count elements of width values of the type T each, stored in
+	 *  big endian (MSB first) order, from the stream into dest.
+	 *
+	 *  @see readArrayStridedLE()
+	 */
+	template<typename T>
+	void readArrayStridedBE(T *dest, size_t count, size_t width, size_t destStride, size_t srcStride) {
+		readArrayStrided(dest, count, getArrayValueSize<T>(), width, destStride * sizeof(T), srcStride, true);
+	}
+
 	/** Read the specified amount of data into a new[]'ed buffer
 	 *  which then is wrapped into a MemoryReadStream.
 	 *
 	 *  When reading fails, a kReadError exception is thrown.
 	 */
 	MemoryReadStream *readStream(size_t dataSize);
+
+	/** Return a pointer to the next dataSize bytes of data, and advance the stream
+	 *  past them, without copying.
+	 *
+	 *  This is only possible for streams that hold their data in memory. For all
+	 *  other streams, or if there's not enough data left, 0 is returned and the
+	 *  stream is left unchanged.
+	 */
+	virtual const byte *readInPlace(size_t dataSize);
+
+private:
+	template<typename T>
+	static size_t getArrayValueSize() {
+		static_assert(std::is_arithmetic<T>::value, "Arrays can only be read into arithmetic types");
+		static_assert((sizeof(T) == 1) || (sizeof(T) == 2) || (sizeof(T) == 4) || (sizeof(T) == 8),
+		              "Array values need to be 1, 2, 4 or 8 bytes large");
+
+		return sizeof(T);
+	}
+
+	void readArray(void *dest, size_t count, size_t valueSize, bool bigEndian);
+	void readArrayStrided(void *dest, size_t count, size_t valueSize, size_t width,
+	                      size_t destStride, size_t srcStride, bool bigEndian);
 };
 
 
@@ -339,6 +416,8 @@ public:
 
 	size_t read(void *dataPtr, size_t dataSize);
 
+	const byte *readInPlace(size_t dataSize);
+
 protected:
 	DisposablePtr<ReadStream> _parentStream;
 
@@ -420,6 +499,22 @@ public:
 	double readIEEEDouble() {
 		return _bigEndian ? readIEEEDoubleBE() : readIEEEDoubleLE();
 	}
+
+	template<typename T>
+	void readArray(T *dest, size_t count) {
+		if (_bigEndian)
+			readArrayBE(dest, count);
+		else
+			readArrayLE(dest, count);
+	}
+
+	template<typename T>
+	void readArrayStrided(T *dest, size_t count, size_t width, size_t destStride, size_t srcStride) {
+		if (_bigEndian)
+			readArrayStridedBE(dest, count, width, destStride, srcStride);
+		else
+			readArrayStridedLE(dest, count, width, destStride, srcStride);
+	}
 };
 
 } // End of namespace Common
@@ -54,8 +54,11 @@ src_common_libcommon_la_SOURCES += \
     src/common/util.h \
     src/common/strutil.h \
     src/common/encoding.h \
+    src/common/encodingtables.h \
     src/common/platform.h \
     src/common/debugman.h \
+    src/common/trace.h \
+    src/common/memaccount.h \
     src/common/debug.h \
     src/common/uuid.h \
     src/common/datetime.h \
@@ -64,9 +67,11 @@ src_common_libcommon_la_SOURCES += \
     src/common/writestream.h \
     src/common/memwritestream.h \
     src/common/streamtokenizer.h \
+    src/common/memorytokenizer.h \
     src/common/stringmap.h \
     src/common/readline.h \
     src/common/readfile.h \
+    src/common/mappedfile.h \
     src/common/writefile.h \
     src/common/filepath.h \
     src/common/filelist.h \
@@ -104,6 +109,7 @@ src_common_libcommon_la_SOURCES += \
     src/common/threads.cpp \
     src/common/thread.cpp \
     src/common/ustring.cpp \
+    src/common/hash.cpp \
     src/common/md5.cpp \
     src/common/blowfish.cpp \
     src/common/deflate.cpp \
@@ -113,6 +119,8 @@ src_common_libcommon_la_SOURCES += \
     src/common/encoding.cpp \
     src/common/platform.cpp \
     src/common/debugman.cpp \
+    src/common/trace.cpp \
+    src/common/memaccount.cpp \
     src/common/debug.cpp \
     src/common/uuid.cpp \
     src/common/datetime.cpp \
@@ -121,9 +129,11 @@ src_common_libcommon_la_SOURCES += \
     src/common/writestream.cpp \
     src/common/memwritestream.cpp \
     src/common/streamtokenizer.cpp \
+    src/common/memorytokenizer.cpp \
     src/common/stringmap.cpp \
     src/common/readline.cpp \
     src/common/readfile.cpp \
+    src/common/mappedfile.cpp \
     src/common/writefile.cpp \
     src/common/filepath.cpp \
     src/common/filelist.cpp \
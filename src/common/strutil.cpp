@@ -30,6 +30,9 @@
 #include <cstdio>
 #include <cstring>
 
+#include <limits>
+#include <string>
+
 #include "src/common/system.h"
 #include "src/common/strutil.h"
 #include "src/common/util.h"
@@ -213,15 +216,153 @@ static inline void parse(const char *nptr, char **endptr, double &value) {
 }
 
 
-template<typename T> void parseString(const UString &str, T &value, bool allowEmpty) {
-	if (str.empty()) {
-		if (allowEmpty)
-			return;
+/** Parse a plain decimal integer, without any leading zeros, quickly.
+ *
+ *  Anything else, including values out of range, is left to the slow path.
+ */
+template<typename T>
+static bool parseFast(const char *str, const char *end, T &value) {
+	const bool isNegative = (str < end) && (*str == '-');
+	if (isNegative || ((str < end) && (*str == '+')))
+		str++;
+
+	// Octal, hexadecimal or too long
+	const size_t length = end - str;
+	if ((length == 0) || (length > 18) || ((*str == '0') && (length > 1)))
+		return false;
 
-		throw Exception("Trying to parse an empty string");
+	int64 result = 0;
+	for (; str < end; str++) {
+		if ((*str < '0') || (*str > '9'))
+			return false;
+
+		result = result * 10 + (*str - '0');
+	}
+
+	if (std::numeric_limits<T>::is_signed) {
+		if (isNegative)
+			result = -result;
+
+		if ((result < (int64)std::numeric_limits<T>::min()) || (result > (int64)std::numeric_limits<T>::max()))
+			return false;
+
+	} else {
+		if (isNegative || ((uint64)result > (uint64)std::numeric_limits<T>::max()))
+			return false;
+	}
+
+	value = (T) result;
+	return true;
+}
+
+/** Parse a plain decimal floating point number into a double.
+ *
+ *  Only numbers that can be computed exactly with one multiplication or
+ *  division of doubles are handled, which gives the correctly rounded
+ *  double, the same value strtod() returns.
+ */
+static bool parseFastDouble(const char *str, const char *end, double &value) {
+	static const double kPowersOf10[] = {
+		1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	const bool isNegative = (str < end) && (*str == '-');
+	if (isNegative || ((str < end) && (*str == '+')))
+		str++;
+
+	uint64 mantissa = 0;
+	size_t digits = 0, significantDigits = 0;
+	int exponent = 0;
+
+	for (; (str < end) && (*str >= '0') && (*str <= '9'); str++, digits++) {
+		if ((mantissa == 0) && (*str == '0'))
+			continue;
+
+		mantissa = mantissa * 10 + (*str - '0');
+		significantDigits++;
 	}
 
-	const char *nptr = str.c_str();
+	if ((str < end) && (*str == '.')) {
+		for (str++; (str < end) && (*str >= '0') && (*str <= '9'); str++, digits++) {
+			exponent--;
+			if ((mantissa == 0) && (*str == '0'))
+				continue;
+
+			mantissa = mantissa * 10 + (*str - '0');
+			significantDigits++;
+		}
+	}
+
+	if ((digits == 0) || (significantDigits > 19))
+		return false;
+
+	if ((str < end) && ((*str == 'e') || (*str == 'E'))) {
+		str++;
+
+		const bool isExpNegative = (str < end) && (*str == '-');
+		if (isExpNegative || ((str < end) && (*str == '+')))
+			str++;
+
+		if ((str == end) || (end - str) > 3)
+			return false;
+
+		int exp = 0;
+		for (; str < end; str++) {
+			if ((*str < '0') || (*str > '9'))
+				return false;
+
+			exp = exp * 10 + (*str - '0');
+		}
+
+		exponent += isExpNegative ? -exp : exp;
+	}
+
+	if ((str != end) || (mantissa > (UINT64_C(1) << 53)))
+		return false;
+
+	if ((exponent < -22) || (exponent > 22))
+		return false;
+
+	value = (double) mantissa;
+	if (exponent < 0)
+		value /= kPowersOf10[-exponent];
+	else
+		value *= kPowersOf10[exponent];
+
+	if (isNegative)
+		value = -value;
+
+	return true;
+}
+
+static bool parseFast(const char *str, const char *end, double &value) {
+	return parseFastDouble(str, end, value);
+}
+
+static bool parseFast(const char *str, const char *end, float &value) {
+	double d;
+	if (!parseFastDouble(str, end, d))
+		return false;
+
+	const double absD = ABS(d);
+	if ((absD != 0.0) && ((absD < std::numeric_limits<float>::min()) || (absD > std::numeric_limits<float>::max())))
+		return false;
+
+	/* Rounding the correctly rounded double to a float only gives the
+	 * correctly rounded float if the double doesn't lie exactly between
+	 * two floats. */
+	uint64 bits;
+	std::memcpy(&bits, &d, sizeof(bits));
+	if ((bits & UINT64_C(0x1FFFFFFF)) == UINT64_C(0x10000000))
+		return false;
+
+	value = (float) d;
+	return true;
+}
+
+template<typename T> static void parseCString(const char *str, T &value) {
+	const char *nptr = str;
 	char *endptr = 0;
 
 	errno = 0;
@@ -233,13 +374,43 @@ template<typename T> void parseString(const UString &str, T &value, bool allowEm
 		endptr++;
 
 	if (endptr && (*endptr != '\0'))
-		throw Exception("Can't convert \"%s\" to type of size %u", str.c_str(), (uint)sizeof(T));
+		throw Exception("Can't convert \"%s\" to type of size %u", str, (uint)sizeof(T));
 	if (errno == ERANGE)
-		throw Exception("\"%s\" out of range for type of size %u", str.c_str(), (uint)sizeof(T));
+		throw Exception("\"%s\" out of range for type of size %u", str, (uint)sizeof(T));
 
 	value = newValue;
 }
 
+template<typename T> void parseString(const char *str, size_t length, T &value, bool allowEmpty) {
+	if (length == 0) {
+		if (allowEmpty)
+			return;
+
+		throw Exception("Trying to parse an empty string");
+	}
+
+	if (parseFast(str, str + length, value))
+		return;
+
+	const std::string cStr(str, length);
+	parseCString(cStr.c_str(), value);
+}
+
+template<typename T> void parseString(const UString &str, T &value, bool allowEmpty) {
+	if (str.empty()) {
+		if (allowEmpty)
+			return;
+
+		throw Exception("Trying to parse an empty string");
+	}
+
+	const char *cStr = str.c_str();
+	if (parseFast(cStr, cStr + std::strlen(cStr), value))
+		return;
+
+	parseCString(cStr, value);
+}
+
 template<> void parseString(const UString &str, bool &value, bool allowEmpty) {
 	if (str.empty()) {
 		if (allowEmpty)
@@ -259,6 +430,10 @@ template<> void parseString(const UString &str, bool &value, bool allowEmpty) {
 		true : false;
 }
 
+template<> void parseString(const char *str, size_t length, bool &value, bool allowEmpty) {
+	parseString(UString(str, length), value, allowEmpty);
+}
+
 template void parseString<  signed char     >(const UString &str,   signed char      &value, bool allowEmpty);
 template void parseString<unsigned char     >(const UString &str, unsigned char      &value, bool allowEmpty);
 template void parseString<  signed short    >(const UString &str,   signed short     &value, bool allowEmpty);
@@ -273,6 +448,20 @@ template void parseString<unsigned long long>(const UString &str, unsigned long
 template void parseString<float             >(const UString &str, float              &value, bool allowEmpty);
 template void parseString<double            >(const UString &str, double             &value, bool allowEmpty);
 
+template void parseString<  signed char     >(const char *str, size_t length,   signed char      &value, bool allowEmpty);
+template void parseString<unsigned char     >(const char *str, size_t length, unsigned char      &value, bool allowEmpty);
+template void parseString<  signed short    >(const char *str, size_t length,   signed short     &value, bool allowEmpty);
+template void parseString<unsigned short    >(const char *str, size_t length, unsigned short     &value, bool allowEmpty);
+template void parseString<  signed int      >(const char *str, size_t length,   signed int       &value, bool allowEmpty);
+template void parseString<unsigned int      >(const char *str, size_t length, unsigned int       &value, bool allowEmpty);
+template void parseString<  signed long     >(const char *str, size_t length,   signed long      &value, bool allowEmpty);
+template void parseString<unsigned long     >(const char *str, size_t length, unsigned long      &value, bool allowEmpty);
+template void parseString<  signed long long>(const char *str, size_t length,   signed long long &value, bool allowEmpty);
+template void parseString<unsigned long long>(const char *str, size_t length, unsigned long long &value, bool allowEmpty);
+
+template void parseString<float             >(const char *str, size_t length, float              &value, bool allowEmpty);
+template void parseString<double            >(const char *str, size_t length, double             &value, bool allowEmpty);
+
 
 template<typename T> UString composeString(T value) {
 	/* Create a string representation of the value, in decimal notation.
@@ -54,6 +54,13 @@ UString debugTag(uint32 tag, bool trim = false);
  */
 template<typename T> void parseString(const UString &str, T &value, bool allowEmpty = false);
 
+/** Parse a string of length bytes, not necessarily 0-terminated, into any POD
+ *  integer, float/double or bool type.
+ *
+ *  @see parseString(const UString &, T &, bool)
+ */
+template<typename T> void parseString(const char *str, size_t length, T &value, bool allowEmpty = false);
+
 /** Convert any POD integer, float/double or bool type into a string. */
 template<typename T> UString composeString(T value);
 
@@ -26,6 +26,10 @@
 
 #include <cassert>
 
+#include <atomic>
+#include <exception>
+#include <vector>
+
 #if defined(__MINGW32__ ) && !defined(_GLIBCXX_HAS_GTHREADS)
 	#include "external/mingw-std-threads/mingw.thread.h"
 #else
@@ -33,7 +37,9 @@
 #endif
 
 #include "src/common/types.h"
+#include "src/common/util.h"
 #include "src/common/error.h"
+#include "src/common/mutex.h"
 #include "src/common/threads.h"
 
 static bool            threadsInited = false;
@@ -63,4 +69,55 @@ void enforceMainThread() {
 		throw Exception("Unsafe function called in non-main thread");
 }
 
+unsigned int getHardwareConcurrency() {
+	return MAX(std::thread::hardware_concurrency(), 1U);
+}
+
+void parallelFor(size_t count, const std::function<void (size_t)> &function, unsigned int maxThreads) {
+	if (maxThreads == 0)
+		maxThreads = getHardwareConcurrency();
+
+	const size_t threadCount = MIN<size_t>(maxThreads, count);
+	if (threadCount <= 1) {
+		for (size_t i = 0; i < count; i++)
+			function(i);
+
+		return;
+	}
+
+	std::atomic<size_t> next(0);
+	std::atomic<bool> failed(false);
+
+	std::mutex exceptionMutex;
+	std::exception_ptr exception;
+
+	auto worker = [&]() {
+		for (size_t i = next++; (i < count) && !failed; i = next++) {
+			try {
+				function(i);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(exceptionMutex);
+
+				if (!failed.exchange(true))
+					exception = std::current_exception();
+			}
+		}
+	};
+
+	// The calling thread does its share of the work as well
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+
+	for (size_t i = 1; i < threadCount; i++)
+		threads.push_back(std::thread(worker));
+
+	worker();
+
+	for (std::vector<std::thread>::iterator t = threads.begin(); t != threads.end(); ++t)
+		t->join();
+
+	if (exception)
+		std::rethrow_exception(exception);
+}
+
 } // End of namespace Common
@@ -27,6 +27,10 @@
 #ifndef COMMON_THREADS_H
 #define COMMON_THREADS_H
 
+#include <cstddef>
+
+#include <functional>
+
 namespace Common {
 
 /** Initialize the global threading system.
@@ -42,6 +46,21 @@ bool isMainThread();
 /** Throws an Exception if called from a non-main thread. */
 void enforceMainThread();
 
+/** Return the number of threads that can run concurrently. Always at least 1. */
+unsigned int getHardwareConcurrency();
+
+/** Call a function for every index in [0, count), spread over several threads.
+ *
+ *  Returns once all calls are finished. If any of the calls throws, the first
+ *  exception is rethrown in the calling thread, and indices that were not yet
+ *  started are skipped.
+ *
+ *  @param count      The number of indices to call the function for.
+ *  @param function   The function to call. It has to be safe to call concurrently.
+ *  @param maxThreads The maximum number of threads to use. 0 means one per core.
+ */
+void parallelFor(size_t count, const std::function<void (size_t)> &function, unsigned int maxThreads = 0);
+
 } // End of namespace Common
 
 #endif // COMMON_THREADS_H
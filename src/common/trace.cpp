@@ -0,0 +1,273 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Scoped zone tracing, exportable as a Chrome trace.
+ */
+
+#include <cassert>
+#include <chrono>
+
+#include "src/common/trace.h"
+#include "src/common/ustring.h"
+#include "src/common/error.h"
+#include "src/common/threads.h"
+#include "src/common/writestream.h"
+#include "src/common/writefile.h"
+
+DECLARE_SINGLETON(Common::TraceManager)
+
+namespace Common {
+
+std::atomic<bool> TraceManager::_running(false);
+std::atomic<TraceManager *> TraceManager::_manager(0);
+
+thread_local TraceManager::ThreadBufferOwner TraceManager::_threadBuffer;
+
+static int64 getSteadyTime() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+TraceManager::ThreadBuffer::ThreadBuffer(uint32 i, bool mainThread) : id(i), isMainThread(mainThread),
+	generation(0), count(0), dropped(0) {
+
+	for (size_t j = 0; j < kChunksPerThread; j++)
+		chunks[j] = 0;
+}
+
+TraceManager::ThreadBuffer::~ThreadBuffer() {
+	for (size_t j = 0; j < kChunksPerThread; j++)
+		delete[] chunks[j];
+}
+
+
+TraceManager::ThreadBufferOwner::ThreadBufferOwner() : buffer(0) {
+}
+
+TraceManager::ThreadBufferOwner::~ThreadBufferOwner() {
+	/* The thread is ending. Hand its buffer, together with the zones it
+	 * recorded, back to the manager, so that a new thread can reuse it. */
+
+	TraceManager *manager = _manager.load();
+	if (buffer && manager)
+		manager->releaseThreadBuffer(buffer);
+}
+
+
+TraceManager::TraceManager() : _generation(0), _startTime(getSteadyTime()) {
+	_manager.store(this);
+}
+
+TraceManager::~TraceManager() {
+	_running.store(false);
+	_manager.store(0);
+
+	/* Threads that are still running keep a pointer to their buffer. Since
+	 * the manager is only destroyed on shutdown, after all other threads
+	 * are gone, this is safe. */
+	for (std::vector<ThreadBuffer *>::iterator b = _buffers.begin(); b != _buffers.end(); ++b)
+		delete *b;
+}
+
+void TraceManager::start() {
+	_running.store(false);
+
+	// Buffers of older traces are reset by their owning threads when they record next
+	_generation++;
+	_startTime.store(getSteadyTime());
+
+	_running.store(true);
+}
+
+void TraceManager::stop() {
+	_running.store(false);
+}
+
+uint64 TraceManager::getTime() const {
+	return (uint64) MAX<int64>(getSteadyTime() - _startTime.load(std::memory_order_relaxed), 0);
+}
+
+TraceManager::ThreadBuffer *TraceManager::getThreadBuffer() {
+	ThreadBuffer *buffer = _threadBuffer.buffer;
+	if (buffer)
+		return buffer;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	if (!_freeBuffers.empty()) {
+		// Continue the buffer of an ended thread, under the same ID
+		buffer = _freeBuffers.back();
+		_freeBuffers.pop_back();
+	} else {
+		buffer = new ThreadBuffer(_buffers.size() + 1, initedThreads() && isMainThread());
+		_buffers.push_back(buffer);
+	}
+
+	_threadBuffer.buffer = buffer;
+	return buffer;
+}
+
+void TraceManager::releaseThreadBuffer(ThreadBuffer *buffer) {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_freeBuffers.push_back(buffer);
+}
+
+void TraceManager::record(const char *name, const char *category, uint64 start, uint64 end) {
+	ThreadBuffer &buffer = *getThreadBuffer();
+
+	const uint32 generation = _generation.load(std::memory_order_relaxed);
+	if (buffer.generation.load(std::memory_order_relaxed) != generation) {
+		// This is a new trace. Throw away the zones of the old one
+		buffer.count.store(0, std::memory_order_relaxed);
+		buffer.dropped.store(0, std::memory_order_relaxed);
+
+		buffer.generation.store(generation, std::memory_order_release);
+	}
+
+	const size_t count = buffer.count.load(std::memory_order_relaxed);
+
+	const size_t chunk = count / kZonesPerChunk;
+	if (chunk >= kChunksPerThread) {
+		buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	if (!buffer.chunks[chunk])
+		buffer.chunks[chunk] = new Zone[kZonesPerChunk];
+
+	Zone &zone = buffer.chunks[chunk][count % kZonesPerChunk];
+
+	zone.name     = name;
+	zone.category = category;
+	zone.start    = start;
+	zone.end      = MAX(start, end);
+
+	buffer.count.store(count + 1, std::memory_order_release);
+}
+
+size_t TraceManager::getZoneCount() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	const uint32 generation = _generation.load();
+
+	size_t count = 0;
+	for (std::vector<ThreadBuffer *>::const_iterator b = _buffers.begin(); b != _buffers.end(); ++b)
+		if ((*b)->generation.load(std::memory_order_acquire) == generation)
+			count += (*b)->count.load(std::memory_order_acquire);
+
+	return count;
+}
+
+size_t TraceManager::getDroppedCount() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	const uint32 generation = _generation.load();
+
+	size_t count = 0;
+	for (std::vector<ThreadBuffer *>::const_iterator b = _buffers.begin(); b != _buffers.end(); ++b)
+		if ((*b)->generation.load(std::memory_order_acquire) == generation)
+			count += (*b)->dropped.load(std::memory_order_relaxed);
+
+	return count;
+}
+
+/** Escape a string for use within a JSON string literal. */
+static UString escapeJSON(const char *str) {
+	UString escaped;
+
+	for (; str && *str; str++) {
+		const char c = *str;
+
+		if ((c == '"') || (c == '\\'))
+			escaped += '\\';
+
+		if ((byte) c < 0x20)
+			escaped += UString::format("\\u%04X", (uint) (byte) c);
+		else
+			escaped += c;
+	}
+
+	return escaped;
+}
+
+/** Format a time in nanoseconds as microseconds, the unit of the Chrome trace format. */
+static UString formatMicroseconds(uint64 time) {
+	return UString::format("%llu.%03u", (unsigned long long) (time / 1000), (uint) (time % 1000));
+}
+
+void TraceManager::exportChromeTrace(WriteStream &stream) const {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	const uint32 generation = _generation.load();
+
+	stream.writeString("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	bool first = true;
+	for (std::vector<ThreadBuffer *>::const_iterator b = _buffers.begin(); b != _buffers.end(); ++b) {
+		const ThreadBuffer &buffer = **b;
+
+		if (buffer.generation.load(std::memory_order_acquire) != generation)
+			continue;
+
+		const size_t count = buffer.count.load(std::memory_order_acquire);
+		if (count == 0)
+			continue;
+
+		const UString threadName = buffer.isMainThread ? UString("Main thread") : UString::format("Thread %u", buffer.id);
+
+		stream.writeString(UString::format("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,"
+		                                   "\"args\":{\"name\":\"%s\"}}", first ? "" : ",\n", buffer.id, threadName.c_str()));
+		first = false;
+
+		for (size_t i = 0; i < count; i++) {
+			const Zone &zone = buffer.chunks[i / kZonesPerChunk][i % kZonesPerChunk];
+
+			stream.writeString(",\n{\"name\":\"");
+			stream.writeString(escapeJSON(zone.name));
+			stream.writeString("\",\"cat\":\"");
+			stream.writeString(escapeJSON(zone.category));
+			stream.writeString(UString::format("\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%s,\"dur\":%s}", buffer.id,
+			                                   formatMicroseconds(zone.start).c_str(),
+			                                   formatMicroseconds(zone.end - zone.start).c_str()));
+		}
+	}
+
+	stream.writeString("\n]}\n");
+}
+
+void TraceManager::exportChromeTrace(const UString &file) const {
+	WriteFile trace;
+	if (!trace.open(file))
+		throw Exception("Can't open trace file \"%s\" for writing", file.c_str());
+
+	try {
+		exportChromeTrace(trace);
+
+		trace.flush();
+	} catch (Exception &e) {
+		e.add("Failed writing trace file \"%s\"", file.c_str());
+		throw;
+	}
+}
+
+} // End of namespace Common
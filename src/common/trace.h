@@ -0,0 +1,188 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Scoped zone tracing, exportable as a Chrome trace.
+ */
+
+#ifndef COMMON_TRACE_H
+#define COMMON_TRACE_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "src/common/system.h"
+#include "src/common/types.h"
+#include "src/common/singleton.h"
+
+namespace Common {
+
+class UString;
+class WriteStream;
+
+/** The trace manager, recording timed zones of code.
+ *
+ *  A zone is a named, timed section of code, usually a whole function,
+ *  marked with the TRACE_ZONE() macro. While tracing is running, the start
+ *  and end of every zone that's passed through is recorded.
+ *
+ *  Every thread records into its own buffers, so recording a zone never
+ *  waits for a lock. While tracing is stopped, passing through a zone only
+ *  costs checking a single flag. Building without ENABLE_TRACING removes
+ *  the zones completely.
+ *
+ *  The recorded zones can be exported as a JSON file in the Chrome trace
+ *  event format, which can be viewed in chrome://tracing or Perfetto.
+ */
+class TraceManager : public Singleton<TraceManager> {
+public:
+	TraceManager();
+	~TraceManager();
+
+	/** Is tracing currently running? */
+	static bool isRunning() {
+		return _running.load(std::memory_order_relaxed);
+	}
+
+	/** Start tracing, discarding all previously recorded zones. */
+	void start();
+	/** Stop tracing. The recorded zones are kept until tracing is started again. */
+	void stop();
+
+	/** Return the number of recorded zones. */
+	size_t getZoneCount() const;
+	/** Return the number of zones that were dropped because a thread's buffers ran full. */
+	size_t getDroppedCount() const;
+
+	/** Write all recorded zones into a stream, as a Chrome trace JSON. */
+	void exportChromeTrace(WriteStream &stream) const;
+	/** Write all recorded zones into a file, as a Chrome trace JSON. */
+	void exportChromeTrace(const UString &file) const;
+
+	/** Return the current time, in nanoseconds since tracing was started. */
+	uint64 getTime() const;
+
+	/** Record a zone of the current thread.
+	 *
+	 *  The name and category are not copied, so they have to outlive the trace.
+	 *  Normally, these are string literals.
+	 */
+	void record(const char *name, const char *category, uint64 start, uint64 end);
+
+private:
+	static const size_t kZonesPerChunk   = 4096;
+	static const size_t kChunksPerThread = 256;
+
+	/** A recorded zone. */
+	struct Zone {
+		const char *name;
+		const char *category;
+
+		uint64 start;
+		uint64 end;
+	};
+
+	/** The zones recorded by one thread.
+	 *
+	 *  Only the owning thread ever writes into the buffer. Zones are published
+	 *  to other threads by the release-store of the count.
+	 */
+	struct ThreadBuffer {
+		uint32 id;           ///< Sequential ID of the thread, for the trace.
+		bool   isMainThread; ///< Is this the main thread?
+
+		std::atomic<uint32> generation; ///< The trace these zones belong to.
+		std::atomic<size_t> count;      ///< Number of recorded zones.
+		std::atomic<size_t> dropped;    ///< Number of dropped zones.
+
+		Zone *chunks[kChunksPerThread];
+
+		ThreadBuffer(uint32 i, bool mainThread);
+		~ThreadBuffer();
+	};
+
+	/** Hands a thread's buffer back to the manager when the thread ends. */
+	struct ThreadBufferOwner {
+		ThreadBuffer *buffer;
+
+		ThreadBufferOwner();
+		~ThreadBufferOwner();
+	};
+
+	static std::atomic<bool> _running;
+
+	/** The existing trace manager, if any. */
+	static std::atomic<TraceManager *> _manager;
+
+	/** The current thread's trace buffer, if it recorded anything yet. */
+	static thread_local ThreadBufferOwner _threadBuffer;
+
+	std::atomic<uint32> _generation;
+	std::atomic<int64>  _startTime; ///< In nanoseconds of the steady clock.
+
+	mutable std::mutex _mutex;
+	std::vector<ThreadBuffer *> _buffers;     ///< All buffers, including those of ended threads.
+	std::vector<ThreadBuffer *> _freeBuffers; ///< Buffers of ended threads, to be reused by new threads.
+
+	ThreadBuffer *getThreadBuffer();
+	void releaseThreadBuffer(ThreadBuffer *buffer);
+};
+
+/** Records the time spent in a scope as a zone. */
+class TraceZone {
+public:
+	TraceZone(const char *name, const char *category) : _name(name), _category(category), _running(false), _start(0) {
+		if (TraceManager::isRunning()) {
+			_running = true;
+			_start   = TraceManager::instance().getTime();
+		}
+	}
+
+	~TraceZone() {
+		if (_running && TraceManager::isRunning())
+			TraceManager::instance().record(_name, _category, _start, TraceManager::instance().getTime());
+	}
+
+private:
+	const char *_name;
+	const char *_category;
+
+	bool   _running;
+	uint64 _start;
+};
+
+} // End of namespace Common
+
+/** Shortcut for accessing the trace manager. */
+#define TraceMan Common::TraceManager::instance()
+
+#define TRACE_ZONE_CONCAT2(a, b) a##b
+#define TRACE_ZONE_CONCAT(a, b) TRACE_ZONE_CONCAT2(a, b)
+
+#ifdef ENABLE_TRACING
+	/** Record the rest of the current scope as a zone with this name and category. */
+	#define TRACE_ZONE(name, category) \
+		Common::TraceZone TRACE_ZONE_CONCAT(traceZone, __LINE__)(name, category)
+#else
+	#define TRACE_ZONE(name, category) do { } while (0)
+#endif
+
+#endif // COMMON_TRACE_H
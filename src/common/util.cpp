@@ -100,6 +100,7 @@ void NORETURN_PRE error(const char *s, ...) {
 	DebugMan.logString("ERROR: ");
 	DebugMan.logString(buf);
 	DebugMan.logString("!\n");
+	DebugMan.flushLogFile();
 
 	std::exit(1);
 }
@@ -250,3 +251,46 @@ float readIEEEFloat16(uint16 value) {
 	return convertIEEEFloat(fS | fE | fM);
 }
 // '--- Convert IEEE float16 to IEEE float32, based on code by James Tursa ---'
+
+uint16 writeIEEEFloat16(float value) {
+	const uint32 data = convertIEEEFloat(value);
+
+	const uint16 vS = (data >> 16) & 0x8000;   // float16 sign
+	const int32  fE = (data >> 23) & 0xFF;     // float32 exponent
+	uint32       fM =  data        & 0x7FFFFF; // float32 mantissa
+
+	// Check for (-)Inf and NaN
+	if (fE == 0xFF)
+		return vS | 0x7C00 | ((fM != 0) ? 0x0200 : 0x0000);
+
+	// Unbias the float32 exponent, and bias the float16 exponent accordingly
+	const int32 vE = fE - 127 + 15;
+
+	// Too big for a float16: Inf / -Inf
+	if (vE >= 0x1F)
+		return vS | 0x7C00;
+
+	uint32 shift = 13;
+	uint32 half  = (((uint32) MAX<int32>(vE, 0)) << 10);
+
+	if (vE <= 0) {
+		// Too small even for a denormalized float16: 0.0 / -0.0
+		if (vE < -10)
+			return vS;
+
+		// Denormalized float16: make the implicit leading 1 explicit and shift it into place
+		fM   |= 0x800000;
+		shift = 14 - vE;
+	}
+
+	half |= fM >> shift;
+
+	// Round to nearest, ties to even. A carry into the exponent is still correct
+	const uint32 rest    = fM & ((1 << shift) - 1);
+	const uint32 halfway = 1 << (shift - 1);
+
+	if ((rest > halfway) || ((rest == halfway) && (half & 1)))
+		half++;
+
+	return vS | half;
+}
@@ -0,0 +1,189 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Preloading the GFF3 blueprints of an area's objects.
+ */
+
+#include <cstring>
+
+#include <utility>
+
+#include "src/common/scopedptr.h"
+#include "src/common/readstream.h"
+#include "src/common/memreadstream.h"
+#include "src/common/threads.h"
+
+#include "src/aurora/util.h"
+#include "src/aurora/resman.h"
+#include "src/aurora/gff3file.h"
+
+#include "src/engines/aurora/blueprintpreloader.h"
+
+namespace Engines {
+
+BlueprintPreloader *BlueprintPreloader::_active = 0;
+
+BlueprintPreloader::Blueprint::Blueprint() : type(Aurora::kFileTypeNone), id(0xFFFFFFFF),
+	repairNWNPremium(false), count(0), taken(0), found(false) {
+
+}
+
+
+BlueprintPreloader::BlueprintPreloader() : _instanceCount(0), _parsed(false) {
+	if (!_active)
+		_active = this;
+}
+
+BlueprintPreloader::~BlueprintPreloader() {
+	if (_active == this)
+		_active = 0;
+
+	for (BlueprintMap::iterator b = _blueprints.begin(); b != _blueprints.end(); ++b)
+		for (std::vector<Aurora::GFF3File *>::iterator g = b->second.gff3s.begin(); g != b->second.gff3s.end(); ++g)
+			delete *g;
+}
+
+BlueprintPreloader *BlueprintPreloader::getActive() {
+	return _active;
+}
+
+Common::UString BlueprintPreloader::getKey(const Common::UString &name, Aurora::FileType type) {
+	return TypeMan.setFileType(name.toLower(), type);
+}
+
+void BlueprintPreloader::add(const Common::UString &name, Aurora::FileType type,
+                        uint32 id, bool repairNWNPremium) {
+
+	if (name.empty())
+		return;
+
+	Blueprint &blueprint = _blueprints[getKey(name, type)];
+
+	blueprint.name             = name;
+	blueprint.type             = type;
+	blueprint.id               = id;
+	blueprint.repairNWNPremium = repairNWNPremium;
+
+	blueprint.count++;
+	_instanceCount++;
+}
+
+void BlueprintPreloader::addList(const Aurora::GFF3List &list, Aurora::FileType type,
+                            uint32 id, bool repairNWNPremium) {
+
+	for (Aurora::GFF3List::const_iterator l = list.begin(); l != list.end(); ++l)
+		add((*l)->getString("TemplateResRef"), type, id, repairNWNPremium);
+}
+
+size_t BlueprintPreloader::getResourceCount() const {
+	return _blueprints.size();
+}
+
+size_t BlueprintPreloader::getInstanceCount() const {
+	return _instanceCount;
+}
+
+void BlueprintPreloader::read() {
+	for (BlueprintMap::iterator b = _blueprints.begin(); b != _blueprints.end(); ++b) {
+		Blueprint &blueprint = b->second;
+		if (blueprint.found)
+			continue;
+
+		Common::ScopedPtr<Common::SeekableReadStream> stream(ResMan.getResource(blueprint.name, blueprint.type));
+		if (!stream)
+			continue;
+
+		try {
+			blueprint.data.resize(stream->size());
+			if (!blueprint.data.empty())
+				stream->read(&blueprint.data[0], blueprint.data.size());
+
+			blueprint.found = true;
+		} catch (...) {
+			blueprint.data.clear();
+		}
+	}
+}
+
+void BlueprintPreloader::parse() {
+	// Create one job for every instance of every blueprint we have the data of
+	std::vector< std::pair<Blueprint *, size_t> > jobs;
+	jobs.reserve(_instanceCount);
+
+	for (BlueprintMap::iterator b = _blueprints.begin(); b != _blueprints.end(); ++b) {
+		Blueprint &blueprint = b->second;
+		if (!blueprint.found || !blueprint.gff3s.empty())
+			continue;
+
+		blueprint.gff3s.resize(blueprint.count, 0);
+		for (size_t i = 0; i < blueprint.count; i++)
+			jobs.push_back(std::make_pair(&blueprint, i));
+	}
+
+	// Every job only writes its own slot, so they don't need any locking
+	Common::parallelFor(jobs.size(), [&jobs](size_t i) {
+		const Blueprint &blueprint = *jobs[i].first;
+
+		const size_t size = blueprint.data.size();
+
+		byte *data = new byte[size];
+		if (size > 0)
+			std::memcpy(data, &blueprint.data[0], size);
+
+		try {
+			jobs[i].first->gff3s[jobs[i].second] =
+				new Aurora::GFF3File(new Common::MemoryReadStream(data, size, true),
+				                     blueprint.id, blueprint.repairNWNPremium);
+		} catch (...) {
+			// Just like loadOptionalGFF3(), a broken GFF3 is a missing GFF3
+		}
+	});
+
+	// The raw data is not needed anymore
+	for (BlueprintMap::iterator b = _blueprints.begin(); b != _blueprints.end(); ++b)
+		std::vector<byte>().swap(b->second.data);
+
+	_parsed = true;
+}
+
+bool BlueprintPreloader::take(const Common::UString &name, Aurora::FileType type, Aurora::GFF3File *&gff3) {
+	if (!_parsed)
+		return false;
+
+	BlueprintMap::iterator b = _blueprints.find(getKey(name, type));
+	if (b == _blueprints.end())
+		return false;
+
+	Blueprint &blueprint = b->second;
+	if (blueprint.taken >= blueprint.count)
+		return false;
+
+	gff3 = 0;
+	if (blueprint.taken < blueprint.gff3s.size()) {
+		gff3 = blueprint.gff3s[blueprint.taken];
+		blueprint.gff3s[blueprint.taken] = 0;
+	}
+
+	blueprint.taken++;
+	return true;
+}
+
+} // End of namespace Engines
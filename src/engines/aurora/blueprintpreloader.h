@@ -0,0 +1,137 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Preloading the GFF3 blueprints of an area's objects.
+ */
+
+#ifndef ENGINES_AURORA_BLUEPRINTPRELOADER_H
+#define ENGINES_AURORA_BLUEPRINTPRELOADER_H
+
+#include <vector>
+#include <map>
+
+#include <boost/noncopyable.hpp>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+
+#include "src/aurora/types.h"
+
+namespace Aurora {
+	class GFF3File;
+}
+
+namespace Engines {
+
+/** Preload the GFF3 blueprints of an area's objects.
+ *
+ *  Instantiating the objects of an area reads one blueprint (UTC, UTP, ...)
+ *  per object instance, one after the other. The BlueprintPreloader moves
+ *  this out of the object constructors, into two steps that run before the
+ *  objects are created:
+ *
+ *  - read():  Read every distinct blueprint out of the ResourceManager.
+ *             This has to happen on the thread that owns the ResourceManager.
+ *  - parse(): Parse one GFF3File per queued instance, spread over all cores.
+ *
+ *  While a BlueprintPreloader exists, loadOptionalGFF3() takes its GFF3s from it,
+ *  so the object constructors don't need to know about it at all. A request
+ *  for a blueprint that wasn't queued, or that was requested more often than
+ *  queued, falls through to the ResourceManager as usual.
+ *
+ *  Only the blueprints are preloaded. The objects' models and textures are
+ *  still loaded by the object constructors, on the calling thread.
+ *
+ *  Only one BlueprintPreloader can be active at any given time, and it may only
+ *  be used by the thread that created it.
+ */
+class BlueprintPreloader : boost::noncopyable {
+public:
+	BlueprintPreloader();
+	~BlueprintPreloader();
+
+	/** Queue a GFF3 to be loaded for one object instance. */
+	void add(const Common::UString &name, Aurora::FileType type,
+	         uint32 id = 0xFFFFFFFF, bool repairNWNPremium = false);
+
+	/** Queue the "TemplateResRef" GFF3 of every struct in an instance list. */
+	void addList(const Aurora::GFF3List &list, Aurora::FileType type,
+	             uint32 id = 0xFFFFFFFF, bool repairNWNPremium = false);
+
+	/** Read all queued GFF3s into memory. */
+	void read();
+	/** Parse all read GFF3s, in parallel. */
+	void parse();
+
+	/** Return the number of distinct GFF3s queued. */
+	size_t getResourceCount() const;
+	/** Return the number of GFF3 instances queued. */
+	size_t getInstanceCount() const;
+
+	/** Take a preloaded GFF3.
+	 *
+	 *  Returns false if no more instances of this GFF3 are available. Otherwise,
+	 *  returns true and sets gff3 to the GFF3, or to 0 if the GFF3 does not exist
+	 *  or failed to load. The caller takes over ownership of the GFF3.
+	 */
+	bool take(const Common::UString &name, Aurora::FileType type, Aurora::GFF3File *&gff3);
+
+	/** Return the currently active BlueprintPreloader, or 0 if there is none. */
+	static BlueprintPreloader *getActive();
+
+private:
+	/** A distinct GFF3 and all the instances loaded from it. */
+	struct Blueprint {
+		Common::UString name;
+		Aurora::FileType type;
+
+		uint32 id;
+		bool repairNWNPremium;
+
+		/** Number of instances queued. */
+		size_t count;
+		/** Number of instances already taken. */
+		size_t taken;
+
+		bool found;             ///< Was the resource found?
+		std::vector<byte> data; ///< The raw resource data.
+
+		/** The parsed instances. */
+		std::vector<Aurora::GFF3File *> gff3s;
+
+		Blueprint();
+	};
+
+	typedef std::map<Common::UString, Blueprint> BlueprintMap;
+
+	BlueprintMap _blueprints;
+	size_t _instanceCount;
+
+	bool _parsed; ///< Have we parsed the GFF3s yet?
+
+	static BlueprintPreloader *_active;
+
+	static Common::UString getKey(const Common::UString &name, Aurora::FileType type);
+};
+
+} // End of namespace Engines
+
+#endif // ENGINES_AURORA_BLUEPRINTPRELOADER_H
@@ -35,6 +35,8 @@
 #include "src/common/filepath.h"
 #include "src/common/readline.h"
 #include "src/common/configman.h"
+#include "src/common/trace.h"
+#include "src/common/memaccount.h"
 
 #include "src/aurora/resman.h"
 #include "src/aurora/talkman.h"
@@ -801,6 +803,10 @@ Console::Console(Engine &engine, const Common::UString &font, int fontHeight) :
 			"Usage: setoption <option> <value>\nSet the value of a config option for this session");
 	registerCommand("showfps"    , std::bind(&Console::cmdShowFPS    , this, std::placeholders::_1),
 			"Usage: showfps <true/false>\nShow/Hide the frames-per-second display");
+	registerCommand("frametimes" , std::bind(&Console::cmdFrameTimes , this, std::placeholders::_1),
+			"Usage: frametimes [reset]\nPrint statistics and hitches of the recent frame times, or reset them");
+	registerCommand("memory"     , std::bind(&Console::cmdMemory     , this, std::placeholders::_1),
+			"Usage: memory [resetpeaks]\nPrint the memory usage of each subsystem, or reset the peak usages");
 	registerCommand("listlangs"  , std::bind(&Console::cmdListLangs  , this, std::placeholders::_1),
 			"Usage: listlangs\nLists all languages supported by this game version");
 	registerCommand("getlang"    , std::bind(&Console::cmdGetLang    , this, std::placeholders::_1),
@@ -815,6 +821,9 @@ Console::Console(Engine &engine, const Common::UString &font, int fontHeight) :
 	registerCommand("setcamera"  , std::bind(&Console::cmdSetCamera  , this, std::placeholders::_1),
 			"Usage: setcamera <posX> <posY> <posZ> [<orientX> <orientY> <orientZ>]\n"
 			"Set the camera position (and orientation)");
+	registerCommand("trace"      , std::bind(&Console::cmdTrace      , this, std::placeholders::_1),
+			"Usage: trace start\n       trace stop\n       trace dump [<file>]\n"
+			"Start/Stop tracing, or write the recorded trace as a Chrome trace JSON file");
 
 	_console->print("Console ready...");
 }
@@ -1381,6 +1390,106 @@ void Console::cmdShowFPS(const CommandLine &cl) {
 	_engine->showFPS();
 }
 
+void Console::cmdFrameTimes(const CommandLine &cl) {
+	if (cl.args == "reset") {
+		GfxMan.resetFrameTimes();
+
+		printf("Frame times reset");
+		return;
+	}
+
+	if (!cl.args.empty()) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	const Graphics::FrameTimeStats frame = GfxMan.getFrameTimeStats(Graphics::kFramePhaseMAX);
+	if (frame.frames == 0) {
+		printf("No frame times recorded yet");
+		return;
+	}
+
+	printf("Frame times of the last %u frames, in ms (p50 / p95 / p99 / max):", frame.frames);
+	printf("%-6s: %6.2f / %6.2f / %6.2f / %6.2f", "Frame",
+	       frame.p50 / 1000.0f, frame.p95 / 1000.0f, frame.p99 / 1000.0f, frame.max / 1000.0f);
+
+	for (size_t i = 0; i < Graphics::kFramePhaseMAX; i++) {
+		const Graphics::FramePhase phase = (Graphics::FramePhase) i;
+		const Graphics::FrameTimeStats stats = GfxMan.getFrameTimeStats(phase);
+
+		printf("%-6s: %6.2f / %6.2f / %6.2f / %6.2f", Graphics::getFramePhaseName(phase),
+		       stats.p50 / 1000.0f, stats.p95 / 1000.0f, stats.p99 / 1000.0f, stats.max / 1000.0f);
+	}
+
+	// Limits of 120, 60, 30, 20 and 10 fps
+	static const uint32 kLimits[] = { 8333, 16667, 33333, 50000, 100000 };
+
+	std::vector<uint32> limits(kLimits, kLimits + ARRAYSIZE(kLimits)), counts;
+	GfxMan.getFrameTimeHistogram(limits, counts);
+
+	printf("Histogram:");
+	for (size_t i = 0; i < counts.size(); i++) {
+		const Common::UString range = (i < limits.size()) ?
+			Common::UString::format("< %6.2f ms", limits[i] / 1000.0f) :
+			Common::UString::format(">= %6.2f ms", limits.back() / 1000.0f);
+
+		printf("%-12s: %5u (%5.1f%%)", range.c_str(), counts[i], (counts[i] * 100.0f) / frame.frames);
+	}
+
+	std::vector<Graphics::FrameHitch> hitches;
+	GfxMan.getFrameHitches(hitches);
+
+	if (hitches.empty()) {
+		printf("No hitches");
+		return;
+	}
+
+	printf("Hitches:");
+	for (std::vector<Graphics::FrameHitch>::const_iterator h = hitches.begin(); h != hitches.end(); ++h) {
+		Common::UString phases;
+		for (size_t i = 0; i < Graphics::kFramePhaseMAX; i++)
+			phases += Common::UString::format("%s%s %.2f", (i == 0) ? "" : ", ",
+			                                  Graphics::getFramePhaseName((Graphics::FramePhase) i),
+			                                  h->phaseTimes[i] / 1000.0f);
+
+		printf("At %u.%03us: %.2f ms, mostly %s (%s)", h->timestamp / 1000, h->timestamp % 1000,
+		       h->time / 1000.0f, Graphics::getFramePhaseName(h->worstPhase), phases.c_str());
+	}
+}
+
+void Console::cmdMemory(const CommandLine &cl) {
+	if (cl.args == "resetpeaks") {
+		Common::resetMemoryPeaks();
+
+		printf("Memory peaks reset");
+		return;
+	}
+
+	if (!cl.args.empty()) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	printf("%-12s %12s %12s %8s", "Subsystem", "Current", "Peak", "Objects");
+
+	uint64 current = 0, peak = 0, objects = 0;
+	for (size_t i = 0; i < Common::kMemoryCategoryMAX; i++) {
+		const Common::MemoryCategory category = (Common::MemoryCategory) i;
+		const Common::MemoryUsage usage = Common::getMemoryUsage(category);
+
+		printf("%-12s %12s %12s %8s", Common::getMemoryCategoryName(category),
+		       Common::formatMemorySize(usage.current).c_str(), Common::formatMemorySize(usage.peak).c_str(),
+		       Common::composeString(usage.objects).c_str());
+
+		current += usage.current;
+		peak    += usage.peak;
+		objects += usage.objects;
+	}
+
+	printf("%-12s %12s %12s %8s", "Total", Common::formatMemorySize(current).c_str(),
+	       Common::formatMemorySize(peak).c_str(), Common::composeString(objects).c_str());
+}
+
 void Console::cmdListLangs(const CommandLine &UNUSED(cl)) {
 	std::vector<Aurora::Language> langs;
 	if (_engine->detectLanguages(langs)) {
@@ -1519,6 +1628,52 @@ void Console::cmdSetCamera(const CommandLine &cl) {
 	CameraMan.update();
 }
 
+void Console::cmdTrace(const CommandLine &cl) {
+	std::vector<Common::UString> args;
+	splitArguments(cl.args, args);
+
+	if (args.empty() || (args.size() > 2)) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+#ifndef ENABLE_TRACING
+	printf("Tracing has been disabled in this build");
+	return;
+#endif
+
+	if ((args[0] == "start") && (args.size() == 1)) {
+		TraceMan.start();
+
+		printf("Tracing started");
+
+	} else if ((args[0] == "stop") && (args.size() == 1)) {
+		TraceMan.stop();
+
+		printf("Tracing stopped, %u zones recorded", (uint)TraceMan.getZoneCount());
+
+	} else if (args[0] == "dump") {
+		const Common::UString file = (args.size() > 1) ? args[1] : Common::FilePath::getUserDataFile("trace.json");
+
+		try {
+			TraceMan.exportChromeTrace(file);
+		} catch (...) {
+			Common::exceptionDispatcherWarning();
+
+			printf("Failed writing trace to \"%s\"", file.c_str());
+			return;
+		}
+
+		printf("Dumped %u zones to \"%s\"", (uint)TraceMan.getZoneCount(), file.c_str());
+
+		const size_t dropped = TraceMan.getDroppedCount();
+		if (dropped > 0)
+			printf("%u zones were dropped, because the trace buffers ran full", (uint)dropped);
+
+	} else
+		printCommandHelp(cl.cmd);
+}
+
 void Console::printFullHelp() {
 	print("Available commands (help <command> for further help on each command):");
 
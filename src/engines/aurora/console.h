@@ -307,12 +307,15 @@ private:
 	void cmdGetOption  (const CommandLine &cl);
 	void cmdSetOption  (const CommandLine &cl);
 	void cmdShowFPS    (const CommandLine &cl);
+	void cmdFrameTimes (const CommandLine &cl);
+	void cmdMemory     (const CommandLine &cl);
 	void cmdListLangs  (const CommandLine &cl);
 	void cmdGetLang    (const CommandLine &cl);
 	void cmdSetLang    (const CommandLine &cl);
 	void cmdGetString  (const CommandLine &cl);
 	void cmdGetCamera  (const CommandLine &cl);
 	void cmdSetCamera  (const CommandLine &cl);
+	void cmdTrace      (const CommandLine &cl);
 
 	void updateHelpArguments();
 
@@ -25,6 +25,7 @@
 #include <cassert>
 
 #include "src/common/util.h"
+#include "src/common/debug.h"
 
 #include "src/graphics/graphics.h"
 #include "src/graphics/font.h"
@@ -38,13 +39,19 @@
 
 namespace Engines {
 
-LoadProgress::LoadProgress(size_t steps) : _steps(steps), _currentStep(0),
-	_currentAmount(0.0f), _startTime(0) {
+LoadProgress::LoadProgress(size_t steps, bool display) : _steps(steps), _currentStep(0),
+	_display(display), _currentAmount(0.0f), _startTime(0) {
 
 	assert(_steps >= 2);
 
 	_stepAmount = 1.0f / (_steps - 1);
 
+	_stepDescriptions.reserve(_steps);
+	_stepTimes.reserve(_steps);
+
+	if (!_display)
+		return;
+
 	Graphics::Aurora::FontHandle font = FontMan.get(Graphics::Aurora::kSystemFontMono, 13);
 
 	const Common::UString barUpperStr = createProgressbarUpper(kBarLength);
@@ -78,6 +85,9 @@ void LoadProgress::step(const Common::UString &description) {
 	if (_currentStep == 0)
 		_startTime = timeNow;
 
+	_stepDescriptions.push_back(description);
+	_stepTimes.push_back(timeNow);
+
 	// The first step is the 0% mark, so don't add to the amount yet
 	if (_currentStep > 0)
 		_currentAmount += _stepAmount;
@@ -93,6 +103,12 @@ void LoadProgress::step(const Common::UString &description) {
 
 	const Common::UString timeStr = Common::UString::format("(%.2fs)", timeElapsed / 1000.0);
 
+	if (!_display) {
+		debugC(Common::kDebugEngineLogic, 1, "[%3d%%] %s %s", percentage, description.c_str(), timeStr.c_str());
+		printStepDurations();
+		return;
+	}
+
 	// Update the text
 	{
 		// Create string representing the percentage of done-ness and progress bar
@@ -116,6 +132,27 @@ void LoadProgress::step(const Common::UString &description) {
 
 	// And also print the status
 	status("[%3d%%] %s %s", percentage, description.c_str(), timeStr.c_str());
+
+	printStepDurations();
+}
+
+uint32 LoadProgress::getStepDuration(size_t step) const {
+	if (step >= _stepTimes.size())
+		return 0;
+
+	const uint32 endTime = ((step + 1) < _stepTimes.size()) ? _stepTimes[step + 1] : EventMan.getTimestamp();
+
+	return endTime - _stepTimes[step];
+}
+
+void LoadProgress::printStepDurations() const {
+	// Only print the break-down once we've reached 100%
+	if (_stepTimes.size() != _steps)
+		return;
+
+	for (size_t i = 0; (i + 1) < _stepTimes.size(); i++)
+		debugC(Common::kDebugEngineLogic, 2, "       %s: %.3fs",
+		       _stepDescriptions[i].c_str(), getStepDuration(i) / 1000.0);
 }
 
 Common::UString LoadProgress::createProgressbar(size_t length, double filled) {
@@ -25,6 +25,8 @@
 #ifndef ENGINES_AURORA_LOADPROGRESS_H
 #define ENGINES_AURORA_LOADPROGRESS_H
 
+#include <vector>
+
 #include <boost/noncopyable.hpp>
 
 #include "src/common/scopedptr.h"
@@ -53,13 +55,24 @@ public:
 	 *  - Step 2:  50%
 	 *  - Step 3:  75%
 	 *  - Step 4: 100%
+	 *
+	 *  If display is false, the progress is not shown on screen, and the
+	 *  steps are only printed to the "ELogic" debug channel. This is meant
+	 *  for loading steps that happen behind another loading screen.
 	 */
-	LoadProgress(size_t steps);
+	LoadProgress(size_t steps, bool display = true);
 	~LoadProgress();
 
 	/** Take a step in advancing the progress. */
 	void step(const Common::UString &description);
 
+	/** Return the number of milliseconds spent in this step.
+	 *
+	 *  A step lasts until the next step is taken. For the current
+	 *  step, this returns the time spent in it so far.
+	 */
+	uint32 getStepDuration(size_t step) const;
+
 private:
 	/** The length of the progress bar in characters. */
 	static const int kBarLength = 50;
@@ -67,11 +80,16 @@ private:
 	size_t _steps;       ///< The number of total steps.
 	size_t _currentStep; ///< The current step we're on.
 
+	bool _display; ///< Show the progress on screen?
+
 	double _stepAmount;    ///< The amount to step each time.
 	double _currentAmount; ///< The accumulated amount.
 
 	uint32 _startTime; ///< The timestamp the first step happened.
 
+	std::vector<Common::UString> _stepDescriptions; ///< The descriptions of all steps taken.
+	std::vector<uint32>          _stepTimes;        ///< The timestamps of all steps taken.
+
 	/** The text containing the description of the current step. */
 	Common::ScopedPtr<Graphics::Aurora::Text> _description;
 
@@ -84,6 +102,9 @@ private:
 	Common::ScopedPtr<Graphics::Aurora::Text> _percent;
 
 
+	/** Print how long each step took, once all steps are done. */
+	void printStepDurations() const;
+
 	static Common::UString createProgressbar(size_t length, double filled);
 	static Common::UString createProgressbarUpper(size_t length);
 	static Common::UString createProgressbarLower(size_t length);
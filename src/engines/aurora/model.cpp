@@ -26,6 +26,7 @@
 
 #include "src/common/ustring.h"
 #include "src/common/error.h"
+#include "src/common/trace.h"
 
 #include "src/engines/aurora/model.h"
 #include "src/engines/aurora/modelloader.h"
@@ -46,6 +47,8 @@ void unregisterModelLoader() {
 
 Graphics::Aurora::Model *loadModelObject(const Common::UString &resref,
                                          const Common::UString &texture) {
+	TRACE_ZONE("ModelLoader::load", "models");
+
 	assert(kModelLoader);
 
 	Graphics::Aurora::Model *model = 0;
@@ -63,6 +66,8 @@ Graphics::Aurora::Model *loadModelObject(const Common::UString &resref,
 }
 
 Graphics::Aurora::Model *loadModelGUI(const Common::UString &resref) {
+	TRACE_ZONE("ModelLoader::load", "models");
+
 	assert(kModelLoader);
 
 	Graphics::Aurora::Model *model = 0;
@@ -24,6 +24,7 @@ src_engines_aurora_libaurora_la_SOURCES =
 
 src_engines_aurora_libaurora_la_SOURCES += \
     src/engines/aurora/util.h \
+    src/engines/aurora/blueprintpreloader.h \
     src/engines/aurora/resources.h \
     src/engines/aurora/tokenman.h \
     src/engines/aurora/modelloader.h \
@@ -42,6 +43,7 @@ src_engines_aurora_libaurora_la_SOURCES += \
 
 src_engines_aurora_libaurora_la_SOURCES += \
     src/engines/aurora/util.cpp \
+    src/engines/aurora/blueprintpreloader.cpp \
     src/engines/aurora/resources.cpp \
     src/engines/aurora/tokenman.cpp \
     src/engines/aurora/modelloader.cpp \
@@ -49,6 +49,7 @@
 #include "src/events/events.h"
 
 #include "src/engines/aurora/util.h"
+#include "src/engines/aurora/blueprintpreloader.h"
 
 namespace Engines {
 
@@ -151,6 +152,13 @@ bool longDelay(uint32 ms) {
 Aurora::GFF3File *loadOptionalGFF3(const Common::UString &gff3, Aurora::FileType type,
                                    uint32 id, bool repairNWNPremium) {
 
+	// Prefer a GFF3 that was already loaded as part of a batch
+	BlueprintPreloader *preloader = BlueprintPreloader::getActive();
+
+	Aurora::GFF3File *preloaded = 0;
+	if (preloader && preloader->take(gff3, type, preloaded))
+		return preloaded;
+
 	try {
 		return new Aurora::GFF3File(gff3, type, id, repairNWNPremium);
 	} catch (...) {
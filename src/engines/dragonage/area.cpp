@@ -22,9 +22,13 @@
  *  The context holding a Dragon Age: Origins area.
  */
 
+#include <cfloat>
+
 #include "src/common/util.h"
 #include "src/common/strutil.h"
 #include "src/common/error.h"
+#include "src/common/debug.h"
+#include "src/common/configman.h"
 
 #include "src/aurora/resman.h"
 #include "src/aurora/rimfile.h"
@@ -34,10 +38,15 @@
 #include "src/graphics/graphics.h"
 #include "src/graphics/renderable.h"
 
+#include "src/graphics/camera.h"
+
 #include "src/graphics/aurora/cursorman.h"
 
 #include "src/events/events.h"
 
+#include "src/engines/aurora/blueprintpreloader.h"
+#include "src/engines/aurora/loadprogress.h"
+
 #include "src/engines/dragonage/area.h"
 #include "src/engines/dragonage/campaign.h"
 #include "src/engines/dragonage/room.h"
@@ -56,6 +65,9 @@ static const uint32 kVersion40 = MKTAG('V', '4', '.', '0');
 
 static const uint32 kROOMID    = MKTAG('R', 'O', 'O', 'M');
 
+/** Rooms closer to the camera than this are needed, regardless of visibility information. */
+static const float kRoomStreamRadius = 20.0f;
+
 using ::Aurora::GFF3File;
 using ::Aurora::GFF3Struct;
 using ::Aurora::GFF3List;
@@ -68,7 +80,11 @@ using namespace ::Aurora::GFF4FieldNamesEnum;
 
 Area::Area(Campaign &campaign, const Common::UString &resRef,
            const Common::UString &env, const Common::UString &rim) :
-	Object(kObjectTypeArea), _campaign(&campaign), _resRef(resRef), _environmentID(0xFFFFFFFF), _activeObject(0), _highlightAll(0) {
+	Object(kObjectTypeArea), _campaign(&campaign), _resRef(resRef), _environmentID(0xFFFFFFFF),
+	_roomStreaming(false), _roomBudget(0), _activeObject(0), _highlightAll(0) {
+
+	_roomStreaming = ConfigMan.getBool("roomstreaming", false);
+	_roomBudget    = ((size_t) MAX(ConfigMan.getInt("roomstreambudget", 256), 0)) * 1024 * 1024;
 
 	try {
 
@@ -142,8 +158,17 @@ void Area::loadEnvironment(const Common::UString &resRef) {
 		if (!*r || ((*r)->getLabel() != kROOMID))
 			continue;
 
-		_rooms.push_back(new Room(**r));
+		Room *room = new Room(**r);
+		_rooms.push_back(room);
+
+		_roomIDs.insert(std::make_pair(room->getID(), _rooms.size() - 1));
+
+		// Without streaming, all rooms are loaded up front
+		if (!_roomStreaming)
+			room->loadModels();
 	}
+
+	_roomStates.resize(_rooms.size());
 }
 
 void Area::loadARE(const Common::UString &resRef) {
@@ -159,12 +184,33 @@ void Area::loadARE(const Common::UString &resRef) {
 	readScript(areTop);
 	enableEvents(true);
 
+	LoadProgress progress(4, false);
+
+	// Parse the blueprints of all objects in parallel, before creating the objects
+	BlueprintPreloader preloader;
+
+	progress.step(Common::UString::format("Reading object blueprints of area \"%s\"", resRef.c_str()));
+
+	if (areTop.hasField("PlaceableList"))
+		preloader.addList(areTop.getList("PlaceableList"), Aurora::kFileTypeUTP, MKTAG('U', 'T', 'P', ' '));
+	if (areTop.hasField("CreatureList"))
+		preloader.addList(areTop.getList("CreatureList") , Aurora::kFileTypeUTC, MKTAG('U', 'T', 'C', ' '));
+
+	preloader.read();
+
+	progress.step(Common::UString::format("Parsing %u object blueprints", (uint) preloader.getInstanceCount()));
+	preloader.parse();
+
+	progress.step("Creating objects");
+
 	if (areTop.hasField("WaypointList"))
 		loadWaypoints (areTop.getList("WaypointList"));
 	if (areTop.hasField("PlaceableList"))
 		loadPlaceables(areTop.getList("PlaceableList"));
 	if (areTop.hasField("CreatureList"))
 		loadCreatures (areTop.getList("CreatureList"));
+
+	progress.step("Done loading area objects");
 }
 
 void Area::loadObject(DragonAge::Object &object) {
@@ -207,6 +253,9 @@ void Area::loadCreatures(const Aurora::GFF3List &list) {
 void Area::show() {
 	_eventQueue.clear();
 
+	// Make sure everything around the camera is there from the start
+	updateRooms(true);
+
 	GfxMan.lockFrame();
 
 	for (Rooms::iterator r = _rooms.begin(); r != _rooms.end(); ++r)
@@ -287,11 +336,165 @@ void Area::getEntryLocation(float &posX, float &posY, float &posZ,
 	orientAngle = 0.0f;
 }
 
+bool Area::isRoomStreaming() const {
+	return _roomStreaming;
+}
+
+size_t Area::getRoomBudget() const {
+	return _roomBudget;
+}
+
+void Area::getRoomStatus(std::vector<RoomStatus> &status) const {
+	status.resize(_rooms.size());
+
+	for (size_t i = 0; i < _rooms.size(); i++) {
+		status[i].id           = _rooms[i]->getID();
+		status[i].name         = _rooms[i]->getName();
+		status[i].loaded       = _rooms[i]->isLoaded();
+		status[i].loadDuration = _rooms[i]->getLoadDuration();
+		status[i].latency      = _roomStates[i].latency;
+		status[i].memorySize   = _rooms[i]->getMemorySize();
+	}
+}
+
+void Area::findNeededRooms(const float *position, std::vector<bool> &needed) const {
+	needed.assign(_rooms.size(), false);
+
+	// The rooms the camera is in, or the closest one if it's in none
+	std::vector<size_t> current;
+
+	size_t closest = 0;
+	float closestDistance = FLT_MAX;
+
+	for (size_t i = 0; i < _rooms.size(); i++) {
+		const float distance = _rooms[i]->getDistance(position[0], position[1], position[2]);
+
+		if (distance == 0.0f)
+			current.push_back(i);
+
+		if (distance < closestDistance) {
+			closest = i;
+			closestDistance = distance;
+		}
+
+		// Everything close by, in case the rooms are missing visibility information
+		if (distance <= kRoomStreamRadius)
+			needed[i] = true;
+	}
+
+	if (current.empty())
+		current.push_back(closest);
+
+	// The rooms the camera is in, and everything visible or reachable from there
+	for (std::vector<size_t>::const_iterator c = current.begin(); c != current.end(); ++c) {
+		needed[*c] = true;
+
+		const std::vector<int32> &neighbors = _rooms[*c]->getNeighbors();
+		for (std::vector<int32>::const_iterator n = neighbors.begin(); n != neighbors.end(); ++n) {
+			std::map<int32, size_t>::const_iterator id = _roomIDs.find(*n);
+			if (id != _roomIDs.end())
+				needed[id->second] = true;
+		}
+	}
+}
+
+void Area::freeRooms(const std::vector<bool> &needed) {
+	size_t loadedSize = 0;
+	for (Rooms::const_iterator r = _rooms.begin(); r != _rooms.end(); ++r)
+		if ((*r)->isLoaded())
+			loadedSize += (*r)->getMemorySize();
+
+	while (loadedSize > _roomBudget) {
+		size_t oldest = _rooms.size();
+		for (size_t i = 0; i < _rooms.size(); i++) {
+			if (needed[i] || !_rooms[i]->isLoaded())
+				continue;
+
+			if ((oldest == _rooms.size()) || (_roomStates[i].lastNeeded < _roomStates[oldest].lastNeeded))
+				oldest = i;
+		}
+
+		// Everything left is needed
+		if (oldest == _rooms.size())
+			break;
+
+		debugC(Common::kDebugEngineGraphics, 1, "Freeing room \"%s\" (%d)",
+		       _rooms[oldest]->getName().c_str(), _rooms[oldest]->getID());
+
+		loadedSize -= _rooms[oldest]->getMemorySize();
+
+		GfxMan.lockFrame();
+		_rooms[oldest]->unloadModels();
+		GfxMan.unlockFrame();
+	}
+}
+
+void Area::updateRooms(bool loadAll) {
+	if (!_roomStreaming || _rooms.empty())
+		return;
+
+	const float *position = CameraMan.getPosition();
+
+	std::vector<bool> needed;
+	findNeededRooms(position, needed);
+
+	const uint32 now = EventMan.getTimestamp();
+	for (size_t i = 0; i < _rooms.size(); i++) {
+		if (!needed[i])
+			continue;
+
+		_roomStates[i].lastNeeded = now;
+
+		if (!_rooms[i]->isLoaded() && !_roomStates[i].waiting) {
+			_roomStates[i].waiting     = true;
+			_roomStates[i].neededSince = now;
+		}
+	}
+
+	// Load the needed rooms, closest first
+	while (true) {
+		size_t next = _rooms.size();
+		float nextDistance = FLT_MAX;
+
+		for (size_t i = 0; i < _rooms.size(); i++) {
+			if (!needed[i] || _rooms[i]->isLoaded())
+				continue;
+
+			const float distance = _rooms[i]->getDistance(position[0], position[1], position[2]);
+			if ((next == _rooms.size()) || (distance < nextDistance)) {
+				next = i;
+				nextDistance = distance;
+			}
+		}
+
+		if ((next == _rooms.size()) || EventMan.quitRequested())
+			break;
+
+		Room &room = *_rooms[next];
+		RoomState &state = _roomStates[next];
+
+		room.loadModels();
+
+		state.waiting = false;
+		state.latency = EventMan.getTimestamp() - state.neededSince;
+
+		debugC(Common::kDebugEngineGraphics, 1, "Loaded room \"%s\" (%d) in %ums, %ums after it was needed",
+		       room.getName().c_str(), room.getID(), room.getLoadDuration(), state.latency);
+
+		if (!loadAll)
+			break;
+	}
+
+	freeRooms(needed);
+}
+
 void Area::addEvent(const Events::Event &event) {
 	_eventQueue.push_back(event);
 }
 
 void Area::processEventQueue() {
+	updateRooms(false);
+
 	bool hasMove = false;
 	for (std::list<Events::Event>::const_iterator e = _eventQueue.begin();
 	     e != _eventQueue.end(); ++e) {
@@ -63,6 +63,18 @@ class Object;
  */
 class Area : public DragonAge::Object, public Events::Notifyable {
 public:
+	/** The streaming status of a room, for debugging. */
+	struct RoomStatus {
+		int32 id;
+		Common::UString name;
+
+		bool loaded;
+
+		uint32 loadDuration; ///< Time the last load took, in milliseconds.
+		uint32 latency;      ///< Time between needing the room and having it loaded, in milliseconds.
+		size_t memorySize;   ///< Estimated size of the room's textures, in bytes.
+	};
+
 	Area(Campaign &campaign, const Common::UString &resRef,
 	     const Common::UString &env, const Common::UString &rim);
 	~Area();
@@ -87,6 +99,13 @@ public:
 
 	static Common::UString getName(const Common::UString &resRef, const Common::UString &rimFile = "");
 
+	/** Are rooms loaded and freed according to the camera position? */
+	bool isRoomStreaming() const;
+	/** Return the memory budget for loaded rooms, in bytes. */
+	size_t getRoomBudget() const;
+	/** Return the streaming status of all rooms. */
+	void getRoomStatus(std::vector<RoomStatus> &status) const;
+
 
 protected:
 	void notifyCameraMoved();
@@ -95,6 +114,17 @@ protected:
 private:
 	typedef Common::PtrVector<Room> Rooms;
 
+	/** Streaming bookkeeping of a room. */
+	struct RoomState {
+		uint32 lastNeeded;  ///< Timestamp of the last time the room was needed.
+		uint32 neededSince; ///< Timestamp of when the room was first needed while not loaded.
+		uint32 latency;     ///< Time between needing the room and having it loaded.
+
+		bool waiting; ///< Is the room needed, but not yet loaded?
+
+		RoomState() : lastNeeded(0), neededSince(0), latency(0), waiting(false) { }
+	};
+
 	typedef Common::PtrList<DragonAge::Object> Objects;
 	typedef std::map<uint32, DragonAge::Object *> ObjectMap;
 
@@ -114,6 +144,12 @@ private:
 
 	Rooms _rooms;
 
+	std::vector<RoomState> _roomStates; ///< Streaming bookkeeping, one for each room.
+	std::map<int32, size_t> _roomIDs;   ///< Indices into _rooms, by room ID.
+
+	bool   _roomStreaming; ///< Load and free rooms according to the camera position?
+	size_t _roomBudget;    ///< Memory budget for loaded rooms, in bytes.
+
 	ChangeList _resources;
 	std::list<Events::Event> _eventQueue;
 
@@ -132,6 +168,17 @@ private:
 	void loadEnvironment(const Common::UString &resRef);
 	void loadARE(const Common::UString &resRef);
 
+	/** Load the rooms needed at the current camera position, and free unneeded ones.
+	 *
+	 *  If loadAll is false, only one room is loaded, to keep the frame time
+	 *  in check. Otherwise, all needed rooms are loaded.
+	 */
+	void updateRooms(bool loadAll);
+	/** Find the rooms needed at this position. */
+	void findNeededRooms(const float *position, std::vector<bool> &needed) const;
+	/** Free unneeded rooms, least recently needed first, until the loaded rooms fit into the budget. */
+	void freeRooms(const std::vector<bool> &needed);
+
 	void loadObject(DragonAge::Object &object);
 	void loadWaypoints (const Aurora::GFF3List &list);
 	void loadPlaceables(const Aurora::GFF3List &list);
@@ -50,6 +50,8 @@ Console::Console(DragonAgeEngine &engine) :
 			"Usage: listcampaigns\nList all playable campaigns");
 	registerCommand("loadcampaign" , std::bind(&Console::cmdLoadCampaign , this, std::placeholders::_1),
 			"Usage: loadcampaign <name>\nLoad and run a specific campaign");
+	registerCommand("listrooms"    , std::bind(&Console::cmdListRooms    , this, std::placeholders::_1),
+			"Usage: listrooms\nList all rooms in the current area, and which of them are loaded");
 }
 
 Console::~Console() {
@@ -153,6 +155,37 @@ void Console::cmdLoadCampaign(const CommandLine &cl) {
 	printf("No such campaign \"%s\"", cl.args.c_str());
 }
 
+void Console::cmdListRooms(const CommandLine &UNUSED(cl)) {
+	const Campaign *campaign = _engine->getGame().getCampaigns().getCurrentCampaign();
+	if (!campaign || !campaign->getCurrentArea())
+		return;
+
+	const Area &area = *campaign->getCurrentArea();
+
+	std::vector<Area::RoomStatus> rooms;
+	area.getRoomStatus(rooms);
+
+	size_t loadedCount = 0, loadedSize = 0;
+	for (std::vector<Area::RoomStatus>::const_iterator r = rooms.begin(); r != rooms.end(); ++r) {
+		if (!r->loaded) {
+			printf("%4d %s", r->id, r->name.c_str());
+			continue;
+		}
+
+		printf("%4d %s: loaded in %ums, %ums after it was needed, %u KB",
+		       r->id, r->name.c_str(), r->loadDuration, r->latency, (uint) (r->memorySize / 1024));
+
+		loadedCount += 1;
+		loadedSize  += r->memorySize;
+	}
+
+	if (area.isRoomStreaming())
+		printf("%u of %u rooms loaded, %u of %u KB", (uint) loadedCount, (uint) rooms.size(),
+		       (uint) (loadedSize / 1024), (uint) (area.getRoomBudget() / 1024));
+	else
+		printf("%u of %u rooms loaded, room streaming is disabled", (uint) loadedCount, (uint) rooms.size());
+}
+
 } // End of namespace DragonAge
 
 } // End of namespace Engines
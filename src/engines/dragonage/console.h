@@ -51,6 +51,7 @@ private:
 	void cmdLoadArea     (const CommandLine &cl);
 	void cmdListCampaigns(const CommandLine &cl);
 	void cmdLoadCampaign (const CommandLine &cl);
+	void cmdListRooms    (const CommandLine &cl);
 
 };
 
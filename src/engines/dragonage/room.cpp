@@ -22,6 +22,11 @@
  *  A room in a Dragon Age: Origins area.
  */
 
+#include <cfloat>
+#include <cmath>
+
+#include <algorithm>
+
 #include "external/glm/mat4x4.hpp"
 #include "external/glm/gtc/matrix_transform.hpp"
 #include "external/glm/gtx/matrix_interpolation.hpp"
@@ -30,6 +35,7 @@
 #include "src/common/strutil.h"
 #include "src/common/maths.h"
 #include "src/common/error.h"
+#include "src/common/memaccount.h"
 
 #include "src/aurora/resman.h"
 #include "src/aurora/gff4file.h"
@@ -57,7 +63,13 @@ using ::Aurora::GFF4List;
 
 using namespace ::Aurora::GFF4FieldNamesEnum;
 
-Room::Room(const Aurora::GFF4Struct &room) {
+static uint64 getImageMemory() {
+	return Common::getMemoryUsage(Common::kMemoryImages).current;
+}
+
+Room::Room(const Aurora::GFF4Struct &room) : _id(-1), _loaded(false), _visible(false),
+	_loadDuration(0), _memorySize(0) {
+
 	try {
 		load(room);
 	} catch (...) {
@@ -68,6 +80,7 @@ Room::Room(const Aurora::GFF4Struct &room) {
 
 Room::~Room() {
 	hide();
+	unloadModels();
 	clean();
 }
 
@@ -75,6 +88,41 @@ int32 Room::getID() const {
 	return _id;
 }
 
+const Common::UString &Room::getName() const {
+	return _name;
+}
+
+const std::vector<int32> &Room::getNeighbors() const {
+	return _neighbors;
+}
+
+float Room::getDistance(float x, float y, float z) const {
+	if (_bound.empty())
+		return FLT_MAX;
+
+	float minX, minY, minZ, maxX, maxY, maxZ;
+	_bound.getMin(minX, minY, minZ);
+	_bound.getMax(maxX, maxY, maxZ);
+
+	const float dX = MAX(MAX(minX - x, x - maxX), 0.0f);
+	const float dY = MAX(MAX(minY - y, y - maxY), 0.0f);
+	const float dZ = MAX(MAX(minZ - z, z - maxZ), 0.0f);
+
+	return sqrtf(dX * dX + dY * dY + dZ * dZ);
+}
+
+bool Room::isLoaded() const {
+	return _loaded;
+}
+
+uint32 Room::getLoadDuration() const {
+	return _loadDuration;
+}
+
+size_t Room::getMemorySize() const {
+	return _memorySize;
+}
+
 void Room::clean() {
 	try {
 		deindexResources(_resources);
@@ -86,6 +134,10 @@ void Room::load(const GFF4Struct &room) {
 	_id = room.getSint(kGFF4EnvRoomID, -1);
 
 	const Common::UString roomFile = room.getString(kGFF4EnvRoomFile);
+	_name = roomFile;
+
+	loadNeighbors(room, kGFF4EnvRoomVisibilityList    , kGFF4EnvRoomVisibilityID);
+	loadNeighbors(room, kGFF4EnvRoomPathConnectionList, kGFF4EnvRoomPathConnectionID);
 
 	indexOptionalArchive(roomFile + ".rim"      , 12000, _resources);
 	indexOptionalArchive(roomFile + ".gpu.rim"  , 12001, _resources);
@@ -97,6 +149,23 @@ void Room::load(const GFF4Struct &room) {
 	loadLayout(roomFile + "_1");
 }
 
+void Room::loadNeighbors(const GFF4Struct &room, uint32 list, uint32 field) {
+	if (!room.hasField(list))
+		return;
+
+	const GFF4List &neighbors = room.getList(list);
+	for (GFF4List::const_iterator n = neighbors.begin(); n != neighbors.end(); ++n) {
+		if (!*n)
+			continue;
+
+		const int32 id = (*n)->getSint(field, -1);
+		if ((id < 0) || (id == _id) || (std::find(_neighbors.begin(), _neighbors.end(), id) != _neighbors.end()))
+			continue;
+
+		_neighbors.push_back(id);
+	}
+}
+
 void Room::loadLayout(const Common::UString &roomFile) {
 	if (!ResMan.hasResource(roomFile, Aurora::kFileTypeRML) || EventMan.quitRequested())
 		return;
@@ -123,10 +192,8 @@ void Room::loadLayout(const Common::UString &roomFile) {
 				Common::deg2rad(roomOrient[3]),
 				glm::vec3(roomOrient[0], roomOrient[1], roomOrient[2]));
 
-	status("Loading room \"%s\" (%d)", roomFile.c_str(), _id);
-
 	const GFF4List &models = rmlTop.getList(kGFF4EnvRoomModelList);
-	_models.reserve(models.size());
+	_placements.reserve(_placements.size() + models.size());
 
 	for (GFF4List::const_iterator m = models.begin(); m != models.end(); ++m) {
 		if (!*m || ((*m)->getLabel() != kMDLID))
@@ -143,12 +210,6 @@ void Room::loadLayout(const Common::UString &roomFile) {
 
 		// TODO: Instances
 
-		Graphics::Aurora::Model *model = loadModelObject((*m)->getString(kGFF4EnvModelFile));
-		if (!model)
-			continue;
-
-		_models.push_back(model);
-
 		glm::mat4 modelTransform(roomTransform);
 
 		modelTransform = glm::translate(modelTransform, glm::vec3(pos[0], pos[1], pos[2]));
@@ -158,29 +219,91 @@ void Room::loadLayout(const Common::UString &roomFile) {
 					Common::deg2rad(orient[3]),
 					glm::vec3(orient[0], orient[1], orient[2]));
 
-		pos[0] = modelTransform[3][0];
-		pos[1] = modelTransform[3][1];
-		pos[2] = modelTransform[3][2];
+		Placement placement;
+
+		placement.model = (*m)->getString(kGFF4EnvModelFile);
+		placement.scale = scale;
+
+		placement.position[0] = modelTransform[3][0];
+		placement.position[1] = modelTransform[3][1];
+		placement.position[2] = modelTransform[3][2];
 
 		glm::vec3 axis;
-		glm::axisAngle(modelTransform, axis, orient[3]);
-		orient[3] = Common::rad2deg(orient[3]);
-		orient[0] = axis.x;
-		orient[1] = axis.y;
-		orient[2] = axis.z;
-
-		model->setPosition(pos[0], pos[1], pos[2]);
-		model->setOrientation(orient[0], orient[1], orient[2], orient[3]);
-		model->setScale(scale, scale, scale);
+		glm::axisAngle(modelTransform, axis, placement.orientation[3]);
+		placement.orientation[3] = Common::rad2deg(placement.orientation[3]);
+		placement.orientation[0] = axis.x;
+		placement.orientation[1] = axis.y;
+		placement.orientation[2] = axis.z;
+
+		_placements.push_back(placement);
+
+		// Until the models are loaded, the model positions are all we know about the room's extent
+		_bound.add(placement.position[0], placement.position[1], placement.position[2]);
 	}
 }
 
+void Room::loadModels() {
+	if (_loaded)
+		return;
+
+	status("Loading room \"%s\" (%d)", _name.c_str(), _id);
+
+	const uint32 startTime = EventMan.getTimestamp();
+	const uint64 startMemory = getImageMemory();
+
+	_models.reserve(_placements.size());
+
+	for (std::vector<Placement>::const_iterator p = _placements.begin(); p != _placements.end(); ++p) {
+		if (EventMan.quitRequested())
+			break;
+
+		Graphics::Aurora::Model *model = loadModelObject(p->model);
+		if (!model)
+			continue;
+
+		_models.push_back(model);
+
+		model->setPosition(p->position[0], p->position[1], p->position[2]);
+		model->setOrientation(p->orientation[0], p->orientation[1], p->orientation[2], p->orientation[3]);
+		model->setScale(p->scale, p->scale, p->scale);
+
+		_bound.add(model->getAbsoluteBound());
+
+		if (_visible)
+			model->show();
+	}
+
+	_loaded = true;
+
+	_loadDuration = EventMan.getTimestamp() - startTime;
+
+	/* Only the textures go away again when the room is unloaded. The meshes stay
+	 * cached in the MeshManager, because models outside of rooms may share them.
+	 * Textures that were already loaded before aren't counted again. The OpenGL
+	 * textures are only created later, so we count the images they're made of. */
+	const uint64 endMemory = getImageMemory();
+	_memorySize = (endMemory > startMemory) ? (endMemory - startMemory) : 0;
+}
+
+void Room::unloadModels() {
+	for (Models::iterator m = _models.begin(); m != _models.end(); ++m)
+		(*m)->hide();
+
+	_models.clear();
+
+	_loaded = false;
+}
+
 void Room::show() {
+	_visible = true;
+
 	for (Models::iterator m = _models.begin(); m != _models.end(); ++m)
 		(*m)->show();
 }
 
 void Room::hide() {
+	_visible = false;
+
 	for (Models::iterator m = _models.begin(); m != _models.end(); ++m)
 		(*m)->hide();
 }
@@ -29,6 +29,7 @@
 
 #include "src/common/ptrvector.h"
 #include "src/common/ustring.h"
+#include "src/common/boundingbox.h"
 
 #include "src/aurora/types.h"
 
@@ -40,12 +41,39 @@ namespace Engines {
 
 namespace DragonAge {
 
+/** A room in a Dragon Age: Origins area.
+ *
+ *  Creating a room only reads its layout. The models placed in the room
+ *  are loaded and freed separately, so that an area can keep only the
+ *  rooms around the camera in memory.
+ */
 class Room {
 public:
 	Room(const Aurora::GFF4Struct &room);
 	~Room();
 
 	int32 getID() const;
+	const Common::UString &getName() const;
+
+	/** Return the IDs of the rooms that are visible or reachable from this room. */
+	const std::vector<int32> &getNeighbors() const;
+
+	/** Return the distance from this point to the room's bounds, 0.0f if the point is within. */
+	float getDistance(float x, float y, float z) const;
+
+	/** Are the room's models loaded? */
+	bool isLoaded() const;
+
+	void loadModels();
+	void unloadModels();
+
+	/** Return how long the last loadModels() took, in milliseconds. */
+	uint32 getLoadDuration() const;
+	/** Return the size of the texture images the last loadModels() loaded, in bytes.
+	 *
+	 *  This is the memory unloading the room frees again.
+	 */
+	size_t getMemorySize() const;
 
 	void show();
 	void hide();
@@ -53,13 +81,36 @@ public:
 private:
 	typedef Common::PtrVector<Graphics::Aurora::Model> Models;
 
+	/** A model placed into the room by the room's layout. */
+	struct Placement {
+		Common::UString model;
+
+		float position[3];
+		float orientation[4];
+		float scale;
+	};
+
 	int32 _id;
+	Common::UString _name;
+
+	std::vector<int32> _neighbors;
+	std::vector<Placement> _placements;
+
+	/** The area covered by the room, grown to the models' bounds once they're loaded. */
+	Common::BoundingBox _bound;
 
 	Models _models;
 
+	bool _loaded;
+	bool _visible;
+
+	uint32 _loadDuration;
+	size_t _memorySize;
+
 	ChangeList _resources;
 
 	void load(const Aurora::GFF4Struct &room);
+	void loadNeighbors(const Aurora::GFF4Struct &room, uint32 list, uint32 field);
 	void loadLayout(const Common::UString &roomFile);
 
 	void clean();
@@ -26,6 +26,7 @@
 
 #include "src/aurora/2dareg.h"
 #include "src/aurora/gdafile.h"
+#include "src/aurora/gdaheaders.h"
 
 #include "src/engines/dragonage2/util.h"
 
@@ -33,10 +34,12 @@ namespace Engines {
 
 namespace DragonAge2 {
 
+static const uint32 kColumnWorksheet = Aurora::hashGDAHeader("Worksheet");
+
 const Aurora::GDAFile &getMGDA(uint32 id) {
 	const Aurora::GDAFile &m2da  = TwoDAReg.getMGDA("m2da_");
 
-	const Common::UString sheetName = m2da.getString(m2da.findRow(id), "Worksheet");
+	const Common::UString sheetName = m2da.getString(m2da.findRow(id), kColumnWorksheet);
 
 	return TwoDAReg.getMGDA(sheetName);
 }
@@ -41,6 +41,8 @@
 #include "src/sound/sound.h"
 
 #include "src/engines/aurora/util.h"
+#include "src/engines/aurora/blueprintpreloader.h"
+#include "src/engines/aurora/loadprogress.h"
 #include "src/engines/aurora/localpathfinding.h"
 
 #include "src/engines/kotorbase/room.h"
@@ -369,6 +371,33 @@ void Area::loadGIT(const Aurora::GFF3Struct &git) {
 	if (git.hasField("AreaProperties"))
 		loadProperties(git.getStruct("AreaProperties"));
 
+	LoadProgress progress(4, false);
+
+	// Parse the blueprints of all objects in parallel, before creating the objects
+	BlueprintPreloader preloader;
+
+	progress.step(Common::UString::format("Reading object blueprints of area \"%s\"", _resRef.c_str()));
+
+	if (git.hasField("WaypointList"))
+		preloader.addList(git.getList("WaypointList")  , Aurora::kFileTypeUTW, MKTAG('U', 'T', 'W', ' '));
+	if (git.hasField("Placeable List"))
+		preloader.addList(git.getList("Placeable List"), Aurora::kFileTypeUTP, MKTAG('U', 'T', 'P', ' '));
+	if (git.hasField("Door List"))
+		preloader.addList(git.getList("Door List")     , Aurora::kFileTypeUTD, MKTAG('U', 'T', 'D', ' '));
+	if (git.hasField("Creature List"))
+		preloader.addList(git.getList("Creature List") , Aurora::kFileTypeUTC, MKTAG('U', 'T', 'C', ' '));
+	if (git.hasField("SoundList"))
+		preloader.addList(git.getList("SoundList")     , Aurora::kFileTypeUTS, MKTAG('U', 'T', 'S', ' '));
+	if (git.hasField("TriggerList"))
+		preloader.addList(git.getList("TriggerList")   , Aurora::kFileTypeUTT, MKTAG('U', 'T', 'T', ' '));
+
+	preloader.read();
+
+	progress.step(Common::UString::format("Parsing %u object blueprints", (uint) preloader.getInstanceCount()));
+	preloader.parse();
+
+	progress.step("Creating objects");
+
 	if (git.hasField("WaypointList"))
 		loadWaypoints(git.getList("WaypointList"));
 
@@ -386,6 +415,8 @@ void Area::loadGIT(const Aurora::GFF3Struct &git) {
 
 	if (git.hasField("TriggerList"))
 		loadTriggers(git.getList("TriggerList"));
+
+	progress.step("Done loading area objects");
 }
 
 void Area::loadProperties(const Aurora::GFF3Struct &props) {
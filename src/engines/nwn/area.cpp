@@ -27,6 +27,7 @@
 #include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/maths.h"
+#include "src/common/debug.h"
 
 #include "src/aurora/gff3file.h"
 #include "src/aurora/2dafile.h"
@@ -34,12 +35,16 @@
 
 #include "src/graphics/graphics.h"
 
+#include "src/graphics/mesh/meshman.h"
+
 #include "src/graphics/aurora/cursorman.h"
 #include "src/graphics/aurora/model.h"
 
 #include "src/sound/sound.h"
 
 #include "src/engines/aurora/util.h"
+#include "src/engines/aurora/blueprintpreloader.h"
+#include "src/engines/aurora/loadprogress.h"
 #include "src/engines/aurora/model.h"
 #include "src/engines/aurora/localpathfinding.h"
 
@@ -320,6 +325,29 @@ void Area::loadGIT(const Aurora::GFF3Struct &git) {
 	if (git.hasField("AreaProperties"))
 		loadProperties(git.getStruct("AreaProperties"));
 
+	LoadProgress progress(4, false);
+
+	// Parse the blueprints of all objects in parallel, before creating the objects
+	BlueprintPreloader preloader;
+
+	progress.step(Common::UString::format("Reading object blueprints of area \"%s\"", _resRef.c_str()));
+
+	if (git.hasField("WaypointList"))
+		preloader.addList(git.getList("WaypointList")  , Aurora::kFileTypeUTW, MKTAG('U', 'T', 'W', ' '), true);
+	if (git.hasField("Placeable List"))
+		preloader.addList(git.getList("Placeable List"), Aurora::kFileTypeUTP, MKTAG('U', 'T', 'P', ' '), true);
+	if (git.hasField("Door List"))
+		preloader.addList(git.getList("Door List")     , Aurora::kFileTypeUTD, MKTAG('U', 'T', 'D', ' '), true);
+	if (git.hasField("Creature List"))
+		preloader.addList(git.getList("Creature List") , Aurora::kFileTypeUTC, MKTAG('U', 'T', 'C', ' '), true);
+
+	preloader.read();
+
+	progress.step(Common::UString::format("Parsing %u object blueprints", (uint) preloader.getInstanceCount()));
+	preloader.parse();
+
+	progress.step("Creating objects");
+
 	// Waypoints
 	if (git.hasField("WaypointList"))
 		loadWaypoints(git.getList("WaypointList"));
@@ -335,6 +363,8 @@ void Area::loadGIT(const Aurora::GFF3Struct &git) {
 	// Creatures
 	if (git.hasField("Creature List"))
 		loadCreatures(git.getList("Creature List"));
+
+	progress.step("Done loading area objects");
 }
 
 void Area::loadProperties(const Aurora::GFF3Struct &props) {
@@ -407,6 +437,8 @@ void Area::loadTile(const Aurora::GFF3Struct &t, Tile &tile) {
 }
 
 void Area::loadModels() {
+	const Graphics::Mesh::MeshManager::Statistics before = MeshMan.getStatistics();
+
 	loadTileModels();
 
 	for (ObjectList::iterator o = _objects.begin(); o != _objects.end(); ++o) {
@@ -421,6 +453,15 @@ void Area::loadModels() {
 				_objectMap.insert(std::make_pair(*id, &object));
 		}
 	}
+
+	const Graphics::Mesh::MeshManager::Statistics after = MeshMan.getStatistics();
+
+	debugC(Common::kDebugEngineGraphics, 1, "Area \"%s\": %d new meshes, %d KB vertex data, %d KB index data, "
+	       "%u meshes shared, saving %u KB",
+	       _resRef.c_str(), (int) (after.meshCount - before.meshCount),
+	       (int) ((int64) after.vertexSize - (int64) before.vertexSize) / 1024,
+	       (int) ((int64) after.indexSize  - (int64) before.indexSize)  / 1024,
+	       (uint) (after.sharedCount - before.sharedCount), (uint) ((after.sharedSize - before.sharedSize) / 1024));
 }
 
 void Area::unloadModels() {
@@ -22,10 +22,19 @@
  *  Neverwinter Nights model loader.
  */
 
+#include <list>
+
+#include "src/common/util.h"
 #include "src/common/error.h"
+#include "src/common/scopedptr.h"
 #include "src/common/readstream.h"
 
+#include "src/aurora/resman.h"
+
+#include "src/events/events.h"
+
 #include "src/graphics/aurora/model_nwn.h"
+#include "src/graphics/aurora/compiledmodelcache.h"
 
 #include "src/engines/nwn/modelloader.h"
 
@@ -42,6 +51,49 @@ Graphics::Aurora::Model *NWNModelLoader::load(const Common::UString &resref,
 	return new Graphics::Aurora::Model_NWN(resref, type, texture, &_modelCache);
 }
 
+void warmModelCache() {
+	if (!CompiledModelMan.isEnabled()) {
+		warning("Can't warm the model cache: The model cache is disabled");
+		return;
+	}
+
+	std::list<Aurora::ResourceManager::ResourceID> models;
+	ResMan.getAvailableResources(Aurora::kFileTypeMDL, models);
+
+	status("Warming the model cache...");
+
+	Graphics::Aurora::ModelCache superModels;
+
+	size_t count = 0;
+	const uint32 start = EventMan.getTimestamp();
+
+	for (std::list<Aurora::ResourceManager::ResourceID>::const_iterator m = models.begin(); m != models.end(); ++m) {
+		// Only ASCII models get compiled
+		{
+			Common::ScopedPtr<Common::SeekableReadStream> mdl(ResMan.getResource(m->name, Aurora::kFileTypeMDL));
+			if (!mdl || (mdl->size() < 4) || (mdl->readUint32LE() == 0))
+				continue;
+		}
+
+		try {
+			/* Loading the model compiles it and puts it into the cache, unless
+			 * it's already in there. Add "-d GGraphics:3" to see the load time
+			 * of each model, either parsed or compiled. */
+			Common::ScopedPtr<Graphics::Aurora::Model> model(
+				new Graphics::Aurora::Model_NWN(m->name, Graphics::Aurora::kModelTypeObject, "", &superModels));
+
+			count++;
+
+		} catch (Common::Exception &e) {
+			e.add("Failed to compile model \"%s\"", m->name.c_str());
+			Common::printException(e, "WARNING: ");
+		}
+	}
+
+	status("Warmed the model cache with %u ASCII models in %ums",
+	       (uint)count, EventMan.getTimestamp() - start);
+}
+
 } // End of namespace NWN
 
 } // End of namespace Engines
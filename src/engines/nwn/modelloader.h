@@ -42,6 +42,9 @@ private:
 	Graphics::Aurora::ModelCache _modelCache;
 };
 
+/** Compile all ASCII models currently available into the compiled model cache. */
+void warmModelCache();
+
 } // End of namespace NWN
 
 } // End of namespace Engines
@@ -52,6 +52,7 @@
 #include "src/engines/nwn/types.h"
 #include "src/engines/nwn/version.h"
 #include "src/engines/nwn/module.h"
+#include "src/engines/nwn/modelloader.h"
 #include "src/engines/nwn/game.h"
 #include "src/engines/nwn/area.h"
 #include "src/engines/nwn/creature.h"
@@ -345,6 +346,10 @@ void Module::enter() {
 
 		loadTLK();
 		loadHAKs();
+
+		if (ConfigMan.getBool("warmmodels"))
+			warmModelCache();
+
 		loadAreas();
 
 	} catch (Common::Exception &e) {
@@ -22,8 +22,14 @@
  *  Loader for Neverwinter Nights 2 baked terrain files (TRX).
  */
 
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
 #include "src/common/scopedptr.h"
+#include "src/common/util.h"
 #include "src/common/error.h"
+#include "src/common/debug.h"
 #include "src/common/readstream.h"
 #include "src/common/encoding.h"
 #include "src/common/ustring.h"
@@ -35,7 +41,7 @@
 #include "src/graphics/vertexbuffer.h"
 #include "src/graphics/indexbuffer.h"
 
-#include "src/graphics/aurora/geometryobject.h"
+#include "src/graphics/aurora/chunkedgeometry.h"
 
 #include "src/engines/nwn2/trxfile.h"
 
@@ -43,7 +49,22 @@ namespace Engines {
 
 namespace NWN2 {
 
-TRXFile::TRXFile(const Common::UString &resRef) : _visible(false) {
+/** Size of a terrain vertex: float position[3], int16 normal[3], padding, byte color[4]. */
+static const size_t kTerrainVertexSize = 24;
+/** Size of a water vertex: float position[3], byte color[4]. */
+static const size_t kWaterVertexSize   = 16;
+
+static inline int16 packNormal(float n) {
+	return (int16) roundf(CLIP(n, -1.0f, 1.0f) * 32767.0f);
+}
+
+static inline byte packColor(float c) {
+	return (byte) roundf(CLIP(c, 0.0f, 1.0f) * 255.0f);
+}
+
+TRXFile::TRXFile(const Common::UString &resRef) : _visible(false),
+	_terrain(new Graphics::Aurora::ChunkedGeometry), _water(new Graphics::Aurora::ChunkedGeometry) {
+
 	try {
 		Common::ScopedPtr<Common::SeekableReadStream> trx(ResMan.getResource(resRef, Aurora::kFileTypeTRX));
 		if (!trx)
@@ -55,6 +76,18 @@ TRXFile::TRXFile(const Common::UString &resRef) : _visible(false) {
 		e.add("Failed to load TRX \"%s\"", resRef.c_str());
 		throw e;
 	}
+
+	_terrain->finalize();
+	_water->finalize();
+
+	debugC(Common::kDebugEngineGraphics, 1, "TRX \"%s\": %u terrain tiles, %u KB vertex data, "
+	       "%u/%u/%u triangles per level of detail", resRef.c_str(), (uint) _terrain->getChunkCount(),
+	       (uint) (_terrain->getVertexDataSize() / 1024), (uint) _terrain->getTriangleCount(0),
+	       (uint) _terrain->getTriangleCount(1), (uint) _terrain->getTriangleCount(2));
+	debugC(Common::kDebugEngineGraphics, 1, "TRX \"%s\": %u water tiles, %u KB vertex data, "
+	       "%u/%u/%u triangles per level of detail", resRef.c_str(), (uint) _water->getChunkCount(),
+	       (uint) (_water->getVertexDataSize() / 1024), (uint) _water->getTriangleCount(0),
+	       (uint) _water->getTriangleCount(1), (uint) _water->getTriangleCount(2));
 }
 
 TRXFile::~TRXFile() {
@@ -67,10 +100,8 @@ void TRXFile::show() {
 
 	GfxMan.lockFrame();
 
-	for (ObjectList::iterator t = _terrain.begin(); t != _terrain.end(); ++t)
-		(*t)->show();
-	for (ObjectList::iterator w = _water.begin(); w != _water.end(); ++w)
-		(*w)->show();
+	_terrain->show();
+	_water->show();
 
 	_visible = true;
 
@@ -83,10 +114,8 @@ void TRXFile::hide() {
 
 	GfxMan.lockFrame();
 
-	for (ObjectList::iterator t = _terrain.begin(); t != _terrain.end(); ++t)
-		(*t)->hide();
-	for (ObjectList::iterator w = _water.begin(); w != _water.end(); ++w)
-		(*w)->hide();
+	_terrain->hide();
+	_water->hide();
 
 	_visible = false;
 
@@ -180,55 +209,75 @@ void TRXFile::loadTRRN(Common::SeekableReadStream &trx, Packet &packet) {
 	const uint32 vCount = ttrn.readUint32LE();
 	const uint32 fCount = ttrn.readUint32LE();
 
+	Graphics::VertexBuffer vBuf;
+	vBuf.setSize(vCount, kTerrainVertexSize);
+
+	byte *vData = reinterpret_cast<byte *>(vBuf.getData());
+
 	Graphics::VertexDecl vertexDecl;
 
-	vertexDecl.push_back(Graphics::VertexAttrib(Graphics::VPOSITION, 3, GL_FLOAT));
-	vertexDecl.push_back(Graphics::VertexAttrib(Graphics::VNORMAL  , 3, GL_FLOAT));
-	vertexDecl.push_back(Graphics::VertexAttrib(Graphics::VCOLOR   , 4, GL_FLOAT));
+	vertexDecl.push_back(Graphics::VertexAttrib(Graphics::VPOSITION, 3, GL_FLOAT        , kTerrainVertexSize, vData +  0));
+	vertexDecl.push_back(Graphics::VertexAttrib(Graphics::VNORMAL  , 3, GL_SHORT        , kTerrainVertexSize, vData + 12));
+	vertexDecl.push_back(Graphics::VertexAttrib(Graphics::VCOLOR   , 4, GL_UNSIGNED_BYTE, kTerrainVertexSize, vData + 20));
 
-	Graphics::VertexBuffer vBuf;
-	vBuf.setVertexDeclInterleave(vCount, vertexDecl);
+	vBuf.setVertexDecl(vertexDecl);
+
+	static const size_t kVertexSize = 44; // Size of a vertex in the file
+
+	const size_t vertexStart = ttrn.pos();
 
-	float *v = reinterpret_cast<float *>(vBuf.getData());
-	for (uint32 i = 0; i < vCount; i++) {
-		*v++ = ttrn.readIEEEFloatLE();
-		*v++ = ttrn.readIEEEFloatLE();
-		*v++ = ttrn.readIEEEFloatLE();
+	// Position and normal
+	std::vector<float> positions(vCount * 6);
+	ttrn.readArrayStridedLE(positions.data(), vCount, 6, 6, kVertexSize);
 
-		*v++ = ttrn.readIEEEFloatLE();
-		*v++ = ttrn.readIEEEFloatLE();
-		*v++ = ttrn.readIEEEFloatLE();
+	// Vertex colors
+	std::vector<byte> colors(vCount * 4);
 
-		for (int j = 0; j < 3; j++) {
-			int   vals = 1;
-			float rgb  = ttrn.readByte() / 255.0f;
+	ttrn.seek(vertexStart + 6 * 4);
+	ttrn.readArrayStridedLE(colors.data(), vCount, 4, 4, kVertexSize);
 
-			for (int k = 0; k < 6; k++) {
-				if (!textures[k].empty()) {
-					rgb += textureColors[k][j];
-					vals++;
-				}
-			}
+	float textureColor[3];
+	int   textureColorCount = 1;
 
-			rgb /= vals;
+	for (int j = 0; j < 3; j++)
+		textureColor[j] = 0.0f;
 
-			*v++ = rgb;
+	for (int k = 0; k < 6; k++) {
+		if (!textures[k].empty()) {
+			for (int j = 0; j < 3; j++)
+				textureColor[j] += textureColors[k][j];
+
+			textureColorCount++;
 		}
+	}
+
+	const float *p = positions.data();
+	const byte  *c = colors.data();
+	for (uint32 i = 0; i < vCount; i++, p += 6, c += 4, vData += kTerrainVertexSize) {
+		float *position = reinterpret_cast<float *>(vData +  0);
+		int16 *normal   = reinterpret_cast<int16 *>(vData + 12);
+		byte  *color    = vData + 20;
+
+		for (int j = 0; j < 3; j++)
+			position[j] = p[j];
+
+		for (int j = 0; j < 3; j++)
+			normal[j] = packNormal(p[3 + j]);
+
+		normal[3] = 0; // Padding
 
-		*v++ = ttrn.readByte() / 255.0f;
+		for (int j = 0; j < 3; j++)
+			color[j] = packColor((c[j] / 255.0f + textureColor[j]) / textureColorCount);
 
-		ttrn.skip(16); // Some texture coordinates?
+		color[3] = c[3];
 	}
 
+	ttrn.seek(vertexStart + vCount * kVertexSize); // Skipping some texture coordinates?
+
 	Graphics::IndexBuffer iBuf;
 	iBuf.setSize(fCount * 3, sizeof(uint16), GL_UNSIGNED_SHORT);
 
-	uint16 *f = reinterpret_cast<uint16 *>(iBuf.getData());
-	for (uint32 i = 0; i < fCount; i++) {
-		*f++ = ttrn.readUint16LE();
-		*f++ = ttrn.readUint16LE();
-		*f++ = ttrn.readUint16LE();
-	}
+	ttrn.readArrayLE(reinterpret_cast<uint16 *>(iBuf.getData()), fCount * 3);
 
 	/* TODO:
 	 *   - uint32 dds1Size
@@ -239,7 +288,7 @@ void TRXFile::loadTRRN(Common::SeekableReadStream &trx, Packet &packet) {
 	 *   - Grass  grass
 	 */
 
-	_terrain.push_back(new Graphics::Aurora::GeometryObject(vBuf, iBuf));
+	_terrain->addChunk(vBuf, iBuf);
 }
 
 void TRXFile::loadWATR(Common::SeekableReadStream &trx, Packet &packet) {
@@ -279,20 +328,24 @@ void TRXFile::loadWATR(Common::SeekableReadStream &trx, Packet &packet) {
 	Graphics::VertexDecl vertexDecl;
 
 	vertexDecl.push_back(Graphics::VertexAttrib(Graphics::VPOSITION, 3, GL_FLOAT));
-	vertexDecl.push_back(Graphics::VertexAttrib(Graphics::VCOLOR   , 3, GL_FLOAT));
+	vertexDecl.push_back(Graphics::VertexAttrib(Graphics::VCOLOR   , 4, GL_UNSIGNED_BYTE));
 
 	Graphics::VertexBuffer vBuf;
 	vBuf.setVertexDeclInterleave(vCount, vertexDecl);
 
-	float *v = reinterpret_cast<float *>(vBuf.getData());
-	for (uint32 i = 0; i < vCount; i++) {
-		*v++ = watr.readIEEEFloatLE();
-		*v++ = watr.readIEEEFloatLE();
-		*v++ = watr.readIEEEFloatLE();
+	assert(vBuf.getSize() == kWaterVertexSize);
+
+	const byte packedColor[4] = { packColor(color[0]), packColor(color[1]), packColor(color[2]), 255 };
+
+	byte *v = reinterpret_cast<byte *>(vBuf.getData());
+	for (uint32 i = 0; i < vCount; i++, v += kWaterVertexSize) {
+		float *position = reinterpret_cast<float *>(v);
+
+		position[0] = watr.readIEEEFloatLE();
+		position[1] = watr.readIEEEFloatLE();
+		position[2] = watr.readIEEEFloatLE();
 
-		*v++ = color[0];
-		*v++ = color[1];
-		*v++ = color[2];
+		std::memcpy(v + 12, packedColor, 4);
 
 		watr.skip(16); // texture coordinates?
 	}
@@ -315,7 +368,7 @@ void TRXFile::loadWATR(Common::SeekableReadStream &trx, Packet &packet) {
 	 *   - uint32  tileY
 	 */
 
-	_water.push_back(new Graphics::Aurora::GeometryObject(vBuf, iBuf));
+	_water->addChunk(vBuf, iBuf);
 }
 
 void TRXFile::loadASWM(Common::SeekableReadStream &UNUSED(trx), Packet &UNUSED(packet)) {
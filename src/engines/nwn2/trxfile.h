@@ -25,11 +25,10 @@
 #ifndef ENGINES_NWN2_TRXFILE_H
 #define ENGINES_NWN2_TRXFILE_H
 
-#include <list>
 #include <vector>
 
 #include "src/common/types.h"
-#include "src/common/ptrlist.h"
+#include "src/common/scopedptr.h"
 
 namespace Common {
 	class UString;
@@ -38,7 +37,7 @@ namespace Common {
 
 namespace Graphics {
 	namespace Aurora {
-		class GeometryObject;
+		class ChunkedGeometry;
 	}
 }
 
@@ -62,6 +61,11 @@ namespace NWN2 {
  *  number of TRRN, WATR and ASWM packets. TRRN packets are divided into tiles,
  *  rectangular areas for a piece of the ground, while WATR packets divide
  *  the bodies of water in more natural ways.
+ *
+ *  The terrain and water tiles are each gathered into a ChunkedGeometry,
+ *  which culls tiles outside the view and draws distant tiles with less
+ *  detail. The tiles' vertices are stored in a compact format: normals
+ *  as shorts and colors as bytes.
  */
 class TRXFile {
 public:
@@ -79,16 +83,13 @@ private:
 		uint32 size;   ///< Size of the packet.
 	};
 
-	typedef Common::PtrList<Graphics::Aurora::GeometryObject> ObjectList;
-
-
 	bool _visible;
 
 	uint32 _width;
 	uint32 _height;
 
-	ObjectList _terrain;
-	ObjectList _water;
+	Common::ScopedPtr<Graphics::Aurora::ChunkedGeometry> _terrain;
+	Common::ScopedPtr<Graphics::Aurora::ChunkedGeometry> _water;
 
 
 	void load(Common::SeekableReadStream &trx);
@@ -348,6 +348,7 @@ void EventsManager::raiseFatalError() {
 void EventsManager::runMainLoop() {
 	while (!_doQuit) {
 		// (Pre)Process all events
+		GfxMan.startFramePhase(Graphics::kFramePhaseEvents);
 		processEvents();
 
 		_queueProcessed.notify_one();
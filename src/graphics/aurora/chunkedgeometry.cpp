@@ -0,0 +1,359 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Static 3D geometry, split into culled chunks with levels of detail.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+
+#include "src/graphics/graphics.h"
+#include "src/graphics/camera.h"
+
+#include "src/graphics/aurora/chunkedgeometry.h"
+#include "src/graphics/aurora/textureman.h"
+
+namespace Graphics {
+
+namespace Aurora {
+
+/** Grid resolution of the vertex clustering, per level of detail. */
+static const size_t kLODResolution[] = { 0, 8, 4 };
+
+/** Distance to the camera, in chunk sizes, from which on to use a level of detail. */
+static const float kLODDistance[] = { 0.0f, 2.0f, 4.0f };
+
+/** Size of a culling grid cell, in chunk sizes. */
+static const float kCellSize = 4.0f;
+
+/** A coarser level of detail needs to have at most this fraction of the triangles. */
+static const float kLODMinReduction = 0.9f;
+
+static uint32 getIndex(const IndexBuffer &buffer, size_t i) {
+	if (buffer.getType() == GL_UNSIGNED_SHORT)
+		return reinterpret_cast<const uint16 *>(buffer.getData())[i];
+
+	return reinterpret_cast<const uint32 *>(buffer.getData())[i];
+}
+
+static void setIndex(IndexBuffer &buffer, size_t i, uint32 index) {
+	if (buffer.getType() == GL_UNSIGNED_SHORT)
+		reinterpret_cast<uint16 *>(buffer.getData())[i] = index;
+	else
+		reinterpret_cast<uint32 *>(buffer.getData())[i] = index;
+}
+
+static void readPositions(const VertexBuffer &vBuf, std::vector<float> &positions) {
+	const VertexAttrib *position = 0;
+
+	const VertexDecl &decl = vBuf.getVertexDecl();
+	for (VertexDecl::const_iterator a = decl.begin(); a != decl.end(); ++a)
+		if (a->index == VPOSITION)
+			position = &*a;
+
+	if (!position || (position->size != 3) || (position->type != GL_FLOAT))
+		throw Common::Exception("ChunkedGeometry: Vertex positions need to be 3 floats");
+
+	const size_t stride = (position->stride != 0) ? position->stride : (3 * sizeof(float));
+	const byte  *data   = reinterpret_cast<const byte *>(position->pointer);
+
+	positions.resize(vBuf.getCount() * 3);
+	for (size_t i = 0; i < vBuf.getCount(); i++, data += stride)
+		std::memcpy(&positions[i * 3], data, 3 * sizeof(float));
+}
+
+
+ChunkedGeometry::ChunkedGeometry() : Renderable(kRenderableTypeObject) {
+}
+
+ChunkedGeometry::~ChunkedGeometry() {
+	hide();
+}
+
+void ChunkedGeometry::addChunk(const VertexBuffer &vBuf, const IndexBuffer &iBuf) {
+	if ((iBuf.getType() != GL_UNSIGNED_SHORT) && (iBuf.getType() != GL_UNSIGNED_INT))
+		throw Common::Exception("ChunkedGeometry: Unsupported index type 0x%X", (uint) iBuf.getType());
+
+	std::vector<float> positions;
+	readPositions(vBuf, positions);
+
+	Chunk *chunk = new Chunk;
+	_chunks.push_back(chunk);
+
+	chunk->vertexBuffer = vBuf;
+
+	for (size_t i = 0; i < vBuf.getCount(); i++)
+		chunk->bound.add(positions[i * 3 + 0], positions[i * 3 + 1], positions[i * 3 + 2]);
+
+	chunk->lods.reserve(kLODCount);
+	chunk->lods.push_back(iBuf);
+
+	for (size_t i = 1; i < kLODCount; i++) {
+		IndexBuffer lod;
+		createLOD(positions, chunk->lods.back(), chunk->bound, kLODResolution[i], lod);
+
+		// Not worth it
+		if (lod.getCount() > (chunk->lods.back().getCount() * kLODMinReduction))
+			break;
+
+		chunk->lods.push_back(lod);
+	}
+}
+
+void ChunkedGeometry::createLOD(const std::vector<float> &positions, const IndexBuffer &full,
+                                const Common::BoundingBox &bound, size_t resolution, IndexBuffer &lod) {
+
+	float minX, minY, minZ, maxX, maxY, maxZ;
+	bound.getMin(minX, minY, minZ);
+	bound.getMax(maxX, maxY, maxZ);
+
+	const float cellWidth  = MAX(maxX - minX, 0.001f) / resolution;
+	const float cellHeight = MAX(maxY - minY, 0.001f) / resolution;
+
+	const float epsilonX = cellWidth  * 0.01f;
+	const float epsilonY = cellHeight * 0.01f;
+
+	const size_t vertexCount = positions.size() / 3;
+
+	/* Map each vertex to the vertex closest to the center of its grid cell.
+	 * Vertices on the edges of the chunk always map to themselves. */
+
+	std::vector<uint32> map(vertexCount);
+
+	std::vector<uint32> cellVertex(resolution * resolution, 0xFFFFFFFF);
+	std::vector<float>  cellDistance(resolution * resolution, 0.0f);
+
+	std::vector<uint32> vertexCell(vertexCount, 0xFFFFFFFF);
+
+	for (size_t i = 0; i < vertexCount; i++) {
+		const float x = positions[i * 3 + 0];
+		const float y = positions[i * 3 + 1];
+
+		map[i] = i;
+
+		if ((x <= (minX + epsilonX)) || (x >= (maxX - epsilonX)) ||
+		    (y <= (minY + epsilonY)) || (y >= (maxY - epsilonY)))
+			continue;
+
+		const size_t cellX = MIN<size_t>((x - minX) / cellWidth , resolution - 1);
+		const size_t cellY = MIN<size_t>((y - minY) / cellHeight, resolution - 1);
+		const size_t cell  = cellY * resolution + cellX;
+
+		const float dX = x - (minX + (cellX + 0.5f) * cellWidth);
+		const float dY = y - (minY + (cellY + 0.5f) * cellHeight);
+		const float distance = dX * dX + dY * dY;
+
+		if ((cellVertex[cell] == 0xFFFFFFFF) || (distance < cellDistance[cell])) {
+			cellVertex[cell]   = i;
+			cellDistance[cell] = distance;
+		}
+
+		vertexCell[i] = cell;
+	}
+
+	for (size_t i = 0; i < vertexCount; i++)
+		if (vertexCell[i] != 0xFFFFFFFF)
+			map[i] = cellVertex[vertexCell[i]];
+
+	// Remap the triangles, dropping those that collapsed
+
+	std::vector<uint32> indices;
+	indices.reserve(full.getCount());
+
+	for (size_t i = 0; (i + 2) < full.getCount(); i += 3) {
+		const uint32 a = getIndex(full, i + 0);
+		const uint32 b = getIndex(full, i + 1);
+		const uint32 c = getIndex(full, i + 2);
+
+		if ((a >= vertexCount) || (b >= vertexCount) || (c >= vertexCount))
+			continue;
+
+		const uint32 mA = map[a], mB = map[b], mC = map[c];
+		if ((mA == mB) || (mA == mC) || (mB == mC))
+			continue;
+
+		indices.push_back(mA);
+		indices.push_back(mB);
+		indices.push_back(mC);
+	}
+
+	lod.setSize(indices.size(), (full.getType() == GL_UNSIGNED_SHORT) ? sizeof(uint16) : sizeof(uint32), full.getType());
+	for (size_t i = 0; i < indices.size(); i++)
+		setIndex(lod, i, indices[i]);
+}
+
+void ChunkedGeometry::finalize() {
+	_cells.clear();
+	if (_chunks.empty())
+		return;
+
+	// The grid cell size is based on the largest chunk
+
+	Common::BoundingBox bound;
+	float chunkSize = 0.0f;
+
+	for (Common::PtrVector<Chunk>::const_iterator c = _chunks.begin(); c != _chunks.end(); ++c) {
+		bound.add((*c)->bound);
+
+		chunkSize = MAX(chunkSize, MAX((*c)->bound.getWidth(), (*c)->bound.getHeight()));
+	}
+
+	float minX, minY, minZ;
+	bound.getMin(minX, minY, minZ);
+
+	const float  cellSize = MAX(chunkSize * kCellSize, 1.0f);
+	const size_t width    = MAX<size_t>(std::ceil(bound.getWidth () / cellSize), 1);
+	const size_t height   = MAX<size_t>(std::ceil(bound.getHeight() / cellSize), 1);
+
+	std::vector<Cell> cells(width * height);
+
+	for (Common::PtrVector<Chunk>::iterator c = _chunks.begin(); c != _chunks.end(); ++c) {
+		float cMinX, cMinY, cMinZ, cMaxX, cMaxY, cMaxZ;
+		(*c)->bound.getMin(cMinX, cMinY, cMinZ);
+		(*c)->bound.getMax(cMaxX, cMaxY, cMaxZ);
+
+		const size_t x = MIN<size_t>(((cMinX + cMaxX) * 0.5f - minX) / cellSize, width  - 1);
+		const size_t y = MIN<size_t>(((cMinY + cMaxY) * 0.5f - minY) / cellSize, height - 1);
+
+		Cell &cell = cells[y * width + x];
+
+		cell.chunks.push_back(*c);
+		cell.bound.add((*c)->bound);
+	}
+
+	// Only keep the cells that have any chunks in them
+	for (std::vector<Cell>::const_iterator c = cells.begin(); c != cells.end(); ++c)
+		if (!c->chunks.empty())
+			_cells.push_back(*c);
+}
+
+size_t ChunkedGeometry::getChunkCount() const {
+	return _chunks.size();
+}
+
+size_t ChunkedGeometry::getVertexDataSize() const {
+	size_t size = 0;
+	for (Common::PtrVector<Chunk>::const_iterator c = _chunks.begin(); c != _chunks.end(); ++c)
+		size += (*c)->vertexBuffer.getCount() * (*c)->vertexBuffer.getSize();
+
+	return size;
+}
+
+size_t ChunkedGeometry::getTriangleCount(size_t lod) const {
+	size_t count = 0;
+	for (Common::PtrVector<Chunk>::const_iterator c = _chunks.begin(); c != _chunks.end(); ++c)
+		count += (*c)->lods[MIN(lod, (*c)->lods.size() - 1)].getCount() / 3;
+
+	return count;
+}
+
+void ChunkedGeometry::calculateDistance() {
+	_distance = 0;
+}
+
+void ChunkedGeometry::getFrustum(const glm::mat4 &clip, Plane planes[6]) {
+	// Extract the planes out of the combined projection and modelview matrix
+
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 2; j++) {
+			const float sign = (j == 0) ? 1.0f : -1.0f;
+
+			Plane &plane = planes[i * 2 + j];
+
+			plane.a = clip[0][3] + sign * clip[0][i];
+			plane.b = clip[1][3] + sign * clip[1][i];
+			plane.c = clip[2][3] + sign * clip[2][i];
+			plane.d = clip[3][3] + sign * clip[3][i];
+		}
+	}
+}
+
+bool ChunkedGeometry::isInFrustum(const Plane planes[6], const Common::BoundingBox &bound) {
+	float minX, minY, minZ, maxX, maxY, maxZ;
+	bound.getMin(minX, minY, minZ);
+	bound.getMax(maxX, maxY, maxZ);
+
+	for (int i = 0; i < 6; i++) {
+		const Plane &p = planes[i];
+
+		// The corner of the box that's the furthest along the plane normal
+		const float x = (p.a >= 0.0f) ? maxX : minX;
+		const float y = (p.b >= 0.0f) ? maxY : minY;
+		const float z = (p.c >= 0.0f) ? maxZ : minZ;
+
+		if ((p.a * x + p.b * y + p.c * z + p.d) < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+size_t ChunkedGeometry::getLOD(const Common::BoundingBox &bound, size_t lodCount, const float *cameraPosition) {
+	float minX, minY, minZ, maxX, maxY, maxZ;
+	bound.getMin(minX, minY, minZ);
+	bound.getMax(maxX, maxY, maxZ);
+
+	// Distance from the camera to the closest point of the chunk
+	const float dX = cameraPosition[0] - CLIP(cameraPosition[0], minX, maxX);
+	const float dY = cameraPosition[1] - CLIP(cameraPosition[1], minY, maxY);
+	const float dZ = cameraPosition[2] - CLIP(cameraPosition[2], minZ, maxZ);
+
+	const float distance = std::sqrt(dX * dX + dY * dY + dZ * dZ);
+	const float size     = MAX(maxX - minX, maxY - minY);
+
+	size_t lod = 0;
+	while (((lod + 1) < lodCount) && (distance >= (kLODDistance[lod + 1] * size)))
+		lod++;
+
+	return lod;
+}
+
+void ChunkedGeometry::render(RenderPass pass) {
+	if (pass == kRenderPassTransparent)
+		return;
+
+	Plane planes[6];
+	getFrustum(GfxMan.getProjectionMatrix() * GfxMan.getModelviewMatrix(), planes);
+
+	const float *cameraPosition = CameraMan.getPosition();
+
+	TextureMan.reset();
+
+	for (std::vector<Cell>::const_iterator cell = _cells.begin(); cell != _cells.end(); ++cell) {
+		if (!isInFrustum(planes, cell->bound))
+			continue;
+
+		for (std::vector<Chunk *>::const_iterator c = cell->chunks.begin(); c != cell->chunks.end(); ++c) {
+			if (!isInFrustum(planes, (*c)->bound))
+				continue;
+
+			(*c)->vertexBuffer.draw(GL_TRIANGLES, (*c)->lods[getLOD((*c)->bound, (*c)->lods.size(), cameraPosition)]);
+		}
+	}
+}
+
+} // End of namespace Aurora
+
+} // End of namespace Graphics
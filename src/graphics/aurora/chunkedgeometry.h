@@ -0,0 +1,136 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Static 3D geometry, split into culled chunks with levels of detail.
+ */
+
+#ifndef GRAPHICS_AURORA_CHUNKEDGEOMETRY_H
+#define GRAPHICS_AURORA_CHUNKEDGEOMETRY_H
+
+#include <vector>
+
+#include "external/glm/mat4x4.hpp"
+
+#include "src/common/ptrvector.h"
+#include "src/common/boundingbox.h"
+
+#include "src/graphics/renderable.h"
+#include "src/graphics/indexbuffer.h"
+#include "src/graphics/vertexbuffer.h"
+
+namespace Graphics {
+
+namespace Aurora {
+
+/** Static, untextured 3D geometry in world space, made up of many chunks.
+ *
+ *  This is meant for large meshes that are already divided into pieces,
+ *  like the terrain tiles of a Neverwinter Nights 2 outdoor area.
+ *
+ *  Every chunk gets a bounding box and a few levels of detail, created
+ *  by clustering the vertices onto a coarser grid. Vertices on the edges
+ *  of a chunk are never moved, so neighbouring chunks with different
+ *  levels of detail still fit together.
+ *
+ *  The chunks are sorted into a coarser grid of cells. Each frame, cells
+ *  and then chunks outside the view frustum are skipped, and the visible
+ *  chunks are drawn with a level of detail fitting their distance to the
+ *  camera.
+ */
+class ChunkedGeometry : public Renderable {
+public:
+	ChunkedGeometry();
+	~ChunkedGeometry();
+
+	/** Add a chunk.
+	 *
+	 *  The vertex buffer needs to contain a VPOSITION attribute made of
+	 *  3 floats. The index buffer needs to describe a triangle list.
+	 */
+	void addChunk(const VertexBuffer &vBuf, const IndexBuffer &iBuf);
+
+	/** Sort the chunks into the culling grid. Call after all chunks have been added. */
+	void finalize();
+
+	/** Return the number of chunks. */
+	size_t getChunkCount() const;
+	/** Return the size of all vertex data, in bytes. */
+	size_t getVertexDataSize() const;
+	/** Return the number of triangles in all chunks at this level of detail. */
+	size_t getTriangleCount(size_t lod) const;
+
+	// Renderable
+	void calculateDistance();
+	void render(RenderPass pass);
+
+	// Geometry helpers
+
+	/** A plane of the view frustum: a * x + b * y + c * z + d = 0. */
+	struct Plane {
+		float a, b, c, d;
+	};
+
+	/** Create a level of detail of a chunk by clustering its vertices onto a grid of this resolution.
+	 *
+	 *  Vertices on the edges of the chunk bound are never moved. Triangles
+	 *  that collapse are dropped.
+	 */
+	static void createLOD(const std::vector<float> &positions, const IndexBuffer &full,
+	                      const Common::BoundingBox &bound, size_t resolution, IndexBuffer &lod);
+
+	/** Extract the 6 planes of the view frustum out of a combined projection and modelview matrix. */
+	static void getFrustum(const glm::mat4 &clip, Plane planes[6]);
+	/** Is the bounding box at least partially within the view frustum? */
+	static bool isInFrustum(const Plane planes[6], const Common::BoundingBox &bound);
+
+	/** Return the level of detail to draw a chunk with, seen from this camera position. */
+	static size_t getLOD(const Common::BoundingBox &bound, size_t lodCount, const float *cameraPosition);
+
+private:
+	/** The number of levels of detail, including the full detail. */
+	static const size_t kLODCount = 3;
+
+	struct Chunk {
+		VertexBuffer vertexBuffer;
+
+		/** The index buffers of all levels of detail, from full detail down. */
+		std::vector<IndexBuffer> lods;
+
+		Common::BoundingBox bound;
+	};
+
+	/** A cell of the culling grid. */
+	struct Cell {
+		std::vector<Chunk *> chunks;
+
+		Common::BoundingBox bound;
+	};
+
+	Common::PtrVector<Chunk> _chunks;
+
+	std::vector<Cell> _cells;
+};
+
+} // End of namespace Aurora
+
+} // End of namespace Graphics
+
+#endif // GRAPHICS_AURORA_CHUNKEDGEOMETRY_H
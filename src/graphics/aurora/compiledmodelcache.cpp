@@ -0,0 +1,215 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A cache for models compiled into a binary representation.
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/memreadstream.h"
+#include "src/common/readfile.h"
+#include "src/common/writefile.h"
+#include "src/common/filepath.h"
+#include "src/common/uuid.h"
+#include "src/common/configman.h"
+
+#include "src/graphics/aurora/compiledmodelcache.h"
+
+DECLARE_SINGLETON(Graphics::Aurora::CompiledModelCache)
+
+namespace Graphics {
+
+namespace Aurora {
+
+CompiledModelCache::CompiledModelCache() : _memory(Common::kMemoryModelCache) {
+}
+
+CompiledModelCache::~CompiledModelCache() {
+}
+
+bool CompiledModelCache::isEnabled() const {
+	return ConfigMan.getBool("modelcache", false);
+}
+
+void CompiledModelCache::clear() {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_compiled.clear();
+	_lru.clear();
+	_memory.set(0);
+}
+
+Common::SeekableReadStream *CompiledModelCache::get(const Common::UString &format,
+                                                     const std::vector<byte> &hash) {
+
+	const Common::UString key = getKey(format, hash);
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		Common::SeekableReadStream *compiled = getFromMemory(key);
+		if (compiled)
+			return compiled;
+	}
+
+	// Not in memory. Look whether we have it on disk
+
+	Common::ReadFile file;
+	if (!file.open(getCacheDirectory() + "/" + key))
+		return 0;
+
+	std::vector<byte> data;
+	try {
+		data.resize(file.size());
+		if (file.read(data.data(), data.size()) != data.size())
+			throw Common::Exception(Common::kReadError);
+
+	} catch (...) {
+		warning("Failed to read compiled model \"%s\"", key.c_str());
+		return 0;
+	}
+
+	byte *copy = new byte[data.size()];
+	std::memcpy(copy, data.data(), data.size());
+
+	Common::SeekableReadStream *compiled = new Common::MemoryReadStream(copy, data.size(), true);
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	addToMemory(key, data);
+
+	return compiled;
+}
+
+void CompiledModelCache::put(const Common::UString &format, const std::vector<byte> &hash,
+                             const byte *data, size_t size) {
+
+	const Common::UString key = getKey(format, hash);
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		/* The same original model data always compiles into the same compiled data.
+		 * If we already have it, someone else already wrote the cache file. */
+		if (_compiled.find(key) != _compiled.end())
+			return;
+
+		std::vector<byte> compiled(data, data + size);
+		addToMemory(key, compiled);
+	}
+
+	/* Write into a temporary file first, and then rename it over the cache file.
+	 * That way, a crash or another instance writing the same model at the same
+	 * time never leaves a truncated cache file behind for get() to load. */
+
+	const Common::UString directory = getCacheDirectory();
+	const Common::UString fileName  = directory + "/" + key;
+	const Common::UString tempName  = fileName + "." + Common::generateIDRandomString() + ".tmp";
+
+	try {
+		if (!Common::FilePath::isDirectory(directory))
+			Common::FilePath::createDirectories(directory);
+
+		Common::WriteFile file;
+		if (!file.open(tempName))
+			throw Common::Exception(Common::kOpenError);
+
+		if (file.write(data, size) != size)
+			throw Common::Exception(Common::kWriteError);
+
+		file.flush();
+		file.close();
+
+		Common::FilePath::renameFile(tempName, fileName);
+
+	} catch (...) {
+		warning("Failed to write compiled model \"%s\"", key.c_str());
+
+		try {
+			Common::FilePath::removeFile(tempName);
+		} catch (...) {
+		}
+	}
+}
+
+Common::SeekableReadStream *CompiledModelCache::getFromMemory(const Common::UString &key) {
+	CompiledMap::iterator compiled = _compiled.find(key);
+	if (compiled == _compiled.end())
+		return 0;
+
+	_lru.splice(_lru.begin(), _lru, compiled->second.lru);
+
+	const std::vector<byte> &data = compiled->second.data;
+
+	byte *copy = new byte[data.size()];
+	std::memcpy(copy, data.data(), data.size());
+
+	return new Common::MemoryReadStream(copy, data.size(), true);
+}
+
+void CompiledModelCache::addToMemory(const Common::UString &key, std::vector<byte> &data) {
+	// Too large to ever fit, or someone else was faster
+	if ((data.size() > kMemoryLimit) || (_compiled.find(key) != _compiled.end()))
+		return;
+
+	while (!_lru.empty() && ((_memory.get() + data.size()) > kMemoryLimit)) {
+		CompiledMap::iterator oldest = _compiled.find(_lru.back());
+		assert(oldest != _compiled.end());
+
+		_memory.remove(oldest->second.data.size());
+
+		_compiled.erase(oldest);
+		_lru.pop_back();
+	}
+
+	_lru.push_front(key);
+
+	Compiled &compiled = _compiled[key];
+
+	compiled.data.swap(data);
+	compiled.lru = _lru.begin();
+
+	_memory.add(compiled.data.size());
+}
+
+Common::UString CompiledModelCache::getKey(const Common::UString &format, const std::vector<byte> &hash) {
+	Common::UString key;
+
+	for (std::vector<byte>::const_iterator h = hash.begin(); h != hash.end(); ++h)
+		key += Common::UString::format("%02x", *h);
+
+	return key + "." + format;
+}
+
+Common::UString CompiledModelCache::getCacheDirectory() {
+	const Common::UString directory = ConfigMan.getString("modelcachedir");
+	if (!directory.empty())
+		return directory;
+
+	return Common::FilePath::getUserDataFile("modelcache");
+}
+
+} // End of namespace Aurora
+
+} // End of namespace Graphics
@@ -0,0 +1,125 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  A cache for models compiled into a binary representation.
+ */
+
+#ifndef GRAPHICS_AURORA_COMPILEDMODELCACHE_H
+#define GRAPHICS_AURORA_COMPILEDMODELCACHE_H
+
+#include <vector>
+#include <list>
+#include <map>
+
+#include "src/common/types.h"
+#include "src/common/ustring.h"
+#include "src/common/singleton.h"
+#include "src/common/mutex.h"
+#include "src/common/memaccount.h"
+
+namespace Common {
+	class SeekableReadStream;
+}
+
+namespace Graphics {
+
+namespace Aurora {
+
+/** A cache for compiled models.
+ *
+ *  Some model formats, like NWN's ASCII MDLs, are slow to parse. Their
+ *  loaders can instead compile a parsed model into a binary form, which is
+ *  then stored here, both in memory and on disk, keyed by the MD5 hash of
+ *  the original model data. Later loads of the same model data can then
+ *  use the compiled form directly.
+ *
+ *  Only the most recently used compiled models, up to kMemoryLimit bytes,
+ *  are held in memory. The others are read back from disk when needed.
+ *
+ *  What the compiled data contains is completely up to the model loader.
+ *
+ *  The cache is only used when the config option "modelcache" is true. The
+ *  config option "modelcachedir" can be used to change the directory where
+ *  the cache files are stored.
+ */
+class CompiledModelCache : public Common::Singleton<CompiledModelCache> {
+public:
+	CompiledModelCache();
+	~CompiledModelCache();
+
+	/** Is the cache enabled? */
+	bool isEnabled() const;
+
+	/** Clear the in-memory part of the cache. */
+	void clear();
+
+	/** Return the compiled model data of this format for the original model data with this MD5 hash.
+	 *
+	 *  @param  format A short identifier of the format of the compiled model data.
+	 *  @param  hash The MD5 hash of the original model data.
+	 *  @return The compiled model data, or 0 if there's none in the cache.
+	 */
+	Common::SeekableReadStream *get(const Common::UString &format, const std::vector<byte> &hash);
+
+	/** Add compiled model data of this format for the original model data with this MD5 hash.
+	 *
+	 *  Errors writing the cache file to disk are not fatal. They are only
+	 *  reported as a warning.
+	 */
+	void put(const Common::UString &format, const std::vector<byte> &hash, const byte *data, size_t size);
+
+	/** The maximum size of all compiled model data held in memory. */
+	static const size_t kMemoryLimit = 32 * 1024 * 1024;
+
+private:
+	typedef std::list<Common::UString> KeyList;
+
+	struct Compiled {
+		std::vector<byte> data;
+		KeyList::iterator lru; ///< Position within the list of recently used keys.
+	};
+
+	typedef std::map<Common::UString, Compiled> CompiledMap;
+
+	CompiledMap _compiled;
+	KeyList     _lru; ///< The keys of all compiled models in memory, most recently used first.
+
+	Common::MemoryAccount _memory; ///< The memory of all compiled model data held in memory.
+
+	std::mutex _mutex;
+
+	/** Copy the compiled model data in memory into a new stream, marking it as recently used. */
+	Common::SeekableReadStream *getFromMemory(const Common::UString &key);
+	/** Add compiled model data to the memory part, dropping the least recently used if necessary. */
+	void addToMemory(const Common::UString &key, std::vector<byte> &data);
+
+	static Common::UString getKey(const Common::UString &format, const std::vector<byte> &hash);
+	static Common::UString getCacheDirectory();
+};
+
+} // End of namespace Aurora
+
+} // End of namespace Graphics
+
+/** Shortcut for accessing the compiled model cache. */
+#define CompiledModelMan Graphics::Aurora::CompiledModelCache::instance()
+
+#endif // GRAPHICS_AURORA_COMPILEDMODELCACHE_H
@@ -52,27 +52,36 @@ void FPS::render(RenderPass pass) {
 	if (pass == kRenderPassOpaque)
 		return;
 
-	uint32 fps = GfxMan.getFPS();
-
-	if (fps != _fps) {
-		_fps = fps;
-
-		setText(Common::UString::format("%d fps", _fps));
-	}
+	update();
 
 	Text::render(pass);
 }
 
 void FPS::renderImmediate(const glm::mat4 &parentTransform) {
-	uint32 fps = GfxMan.getFPS();
+	update();
+
+	Text::renderImmediate(parentTransform);
+}
+
+void FPS::update() {
+	const uint32 fps = GfxMan.getFPS();
+	const FrameTimeStats stats = GfxMan.getFrameTimeStats();
+
+	// The values only change once per second
+	if ((fps == _fps) && (stats.frames == _stats.frames) && (stats.p50 == _stats.p50) &&
+	    (stats.p95 == _stats.p95) && (stats.p99 == _stats.p99) && (stats.max == _stats.max))
+		return;
 
-	if (fps != _fps) {
-		_fps = fps;
+	_fps   = fps;
+	_stats = stats;
 
+	if (_stats.frames == 0) {
 		setText(Common::UString::format("%d fps", _fps));
+		return;
 	}
 
-	Text::renderImmediate(parentTransform);
+	setText(Common::UString::format("%d fps, frame times: %.1f / %.1f / %.1f / %.1f ms (p50 / p95 / p99 / max)",
+	        _fps, _stats.p50 / 1000.0f, _stats.p95 / 1000.0f, _stats.p99 / 1000.0f, _stats.max / 1000.0f));
 }
 
 void FPS::notifyResized(int UNUSED(oldWidth), int UNUSED(oldHeight), int newWidth, int newHeight) {
@@ -27,13 +27,15 @@
 
 #include "src/events/notifyable.h"
 
+#include "src/graphics/fpscounter.h"
+
 #include "src/graphics/aurora/text.h"
 
 namespace Graphics {
 
 namespace Aurora {
 
-/** An autonomous FPS display. */
+/** An autonomous FPS display, also showing the frame time percentiles. */
 class FPS : public Text, public Events::Notifyable {
 public:
 	FPS(const FontHandle &font);
@@ -46,8 +48,10 @@ public:
 
 private:
 	uint32 _fps;
+	FrameTimeStats _stats;
 
 	void init();
+	void update();
 
 	void notifyResized(int oldWidth, int oldHeight, int newWidth, int newHeight);
 };
@@ -171,6 +171,10 @@ float Model::getDepth() const {
 	return _boundBox.getDepth() * _scale[2];
 }
 
+const Common::BoundingBox &Model::getAbsoluteBound() const {
+	return _absoluteBoundBox;
+}
+
 void Model::drawBound(bool enabled) {
 	_drawBound = enabled;
 }
@@ -896,14 +900,6 @@ void Model::createBound() {
 	_absoluteBoundBox.absolutize();
 }
 
-void Model::readValue(Common::SeekableReadStream &stream, uint32 &value) {
-	value = stream.readUint32LE();
-}
-
-void Model::readValue(Common::SeekableReadStream &stream, float &value) {
-	value = stream.readIEEEFloatLE();
-}
-
 void Model::readArrayDef(Common::SeekableReadStream &stream,
                          uint32 &offset, uint32 &count) {
 
@@ -926,8 +922,7 @@ void Model::readArray(Common::SeekableReadStream &stream,
 	const size_t pos = stream.seek(offset);
 
 	values.resize(count);
-	for (uint32 i = 0; i < count; i++)
-		readValue(stream, values[i]);
+	stream.readArrayLE(values.data(), count);
 
 	stream.seek(pos);
 }
@@ -86,6 +86,9 @@ public:
 	/** Get the depth of the model's bounding box. */
 	float getDepth () const;
 
+	/** Get the model's bounding box, positioned, rotated and scaled into the world. */
+	const Common::BoundingBox &getAbsoluteBound() const;
+
 	/** Is that point within the model's bounding box? */
 	bool isIn(float x, float y) const;
 	/** Is that point within the model's bounding box? */
@@ -308,9 +311,6 @@ private:
 public:
 	// General loading helpers
 
-	static void readValue(Common::SeekableReadStream &stream, uint32 &value);
-	static void readValue(Common::SeekableReadStream &stream, float  &value);
-
 	static void readArrayDef(Common::SeekableReadStream &stream,
 	                         uint32 &offset, uint32 &count);
 
@@ -516,11 +516,10 @@ void ModelNode_DragonAge::load(Model_DragonAge::ParserContext &ctx, const GFF4St
 		meshName += _name;
 
 		_mesh->data->rawMesh->setName(meshName);
-		_mesh->data->rawMesh->init();
 		if (MeshMan.getMesh(meshName)) {
 			warning("Warning: probable mesh duplication of: %s", meshName.c_str());
 		}
-		MeshMan.addMesh(_mesh->data->rawMesh);
+		_mesh->data->rawMesh = MeshMan.addSharedMesh(_mesh->data->rawMesh);
 	}
 
 	// Read the children
@@ -652,8 +651,7 @@ void ModelNode_DragonAge::createIndexBuffer(const GFF4Struct &meshChunk,
 	indexData.skip(startIndex * 2);
 
 	uint16 *indices = reinterpret_cast<uint16 *>(_mesh->data->rawMesh->getIndexBuffer()->getData());
-	while (indexCount-- > 0)
-		*indices++ = indexData.readUint16LE();
+	indexData.readArrayLE(indices, indexCount);
 }
 
 void ModelNode_DragonAge::createVertexBuffer(const GFF4Struct &meshChunk,
@@ -369,7 +369,6 @@ void ModelNode_Jade::load(Model_Jade::ParserContext &ctx) {
 		return;
 	}
 
-	_mesh->data->rawMesh->init();
 	if (MeshMan.getMesh(meshName)) {
 		warning("Warning: probable mesh duplication of: %s", meshName.c_str());
 
@@ -377,7 +376,7 @@ void ModelNode_Jade::load(Model_Jade::ParserContext &ctx) {
 		meshName += "#" + Common::generateIDRandomString();
 	}
 	_mesh->data->rawMesh->setName(meshName);
-	MeshMan.addMesh(_mesh->data->rawMesh);
+	_mesh->data->rawMesh = MeshMan.addSharedMesh(_mesh->data->rawMesh);
 
 	if (GfxMan.isRendererExperimental())
 		buildMaterial();
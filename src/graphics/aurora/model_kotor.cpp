@@ -882,36 +882,30 @@ void ModelNode_KotOR::readMesh(Model_KotOR::ParserContext &ctx) {
 	float *v = reinterpret_cast<float *>(_mesh->data->rawMesh->getVertexBuffer()->getData());
 	float *iv = _mesh->data->initialVertexCoords.data();
 
-	for (uint32 i = 0; i < ctx.vertexCount; i++) {
-		// Position
-		ctx.mdx->seek(ctx.offNodeData + i * ctx.mdxStructSize);
-		iv[0] = ctx.mdx->readIEEEFloatLE();
-		iv[1] = ctx.mdx->readIEEEFloatLE();
-		iv[2] = ctx.mdx->readIEEEFloatLE();
-		*v++ = iv[0];
-		*v++ = iv[1];
-		*v++ = iv[2];
-		iv += 3;
-
-		// Normal
-		//ctx.mdx->seek(offNodeData + i * mdxStructSize + offNormals);
-		*v++ = ctx.mdx->readIEEEFloatLE();
-		*v++ = ctx.mdx->readIEEEFloatLE();
-		*v++ = ctx.mdx->readIEEEFloatLE();
-
-		// Bone indices and bone weights are loaded later on
-		if (ctx.flags & kNodeFlagHasSkin)
-			v += 8;
-
-		// TexCoords
-		for (uint16 t = 0; t < ctx.textureCount; t++) {
-			if (offUV[t] != 0xFFFFFFFF) {
-				ctx.mdx->seek(ctx.offNodeData + i * ctx.mdxStructSize + offUV[t]);
-				*v++ = ctx.mdx->readIEEEFloatLE();
-				*v++ = ctx.mdx->readIEEEFloatLE();
-			} else {
-				*v++ = 0.0f;
-				*v++ = 0.0f;
+	const size_t vertexWidth = 6 + ((ctx.flags & kNodeFlagHasSkin) ? 8 : 0) + 2 * ctx.textureCount;
+
+	// Position and normal
+	ctx.mdx->seek(ctx.offNodeData);
+	ctx.mdx->readArrayStridedLE(v, ctx.vertexCount, 6, vertexWidth, ctx.mdxStructSize);
+
+	for (uint32 i = 0; i < ctx.vertexCount; i++, iv += 3) {
+		iv[0] = v[i * vertexWidth + 0];
+		iv[1] = v[i * vertexWidth + 1];
+		iv[2] = v[i * vertexWidth + 2];
+	}
+
+	// Bone indices and bone weights are loaded later on
+	float *uv = v + 6 + ((ctx.flags & kNodeFlagHasSkin) ? 8 : 0);
+
+	// TexCoords
+	for (uint16 t = 0; t < ctx.textureCount; t++, uv += 2) {
+		if (offUV[t] != 0xFFFFFFFF) {
+			ctx.mdx->seek(ctx.offNodeData + offUV[t]);
+			ctx.mdx->readArrayStridedLE(uv, ctx.vertexCount, 2, vertexWidth, ctx.mdxStructSize);
+		} else {
+			for (uint32 i = 0; i < ctx.vertexCount; i++) {
+				uv[i * vertexWidth + 0] = 0.0f;
+				uv[i * vertexWidth + 1] = 0.0f;
 			}
 		}
 	}
@@ -927,8 +921,7 @@ void ModelNode_KotOR::readMesh(Model_KotOR::ParserContext &ctx) {
 	_mesh->data->rawMesh->getIndexBuffer()->setSize(facesCount * 3, sizeof(uint16), GL_UNSIGNED_SHORT);
 
 	uint16 *f = reinterpret_cast<uint16 *>(_mesh->data->rawMesh->getIndexBuffer()->getData());
-	for (uint32 i = 0; i < facesCount * 3; i++)
-		f[i] = ctx.mdl->readUint16LE();
+	ctx.mdl->readArrayLE(f, facesCount * 3);
 
 	createBound();
 
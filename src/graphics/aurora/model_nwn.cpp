@@ -29,6 +29,7 @@
  */
 
 #include <cassert>
+#include <cstring>
 
 #include <boost/unordered_set.hpp>
 
@@ -41,12 +42,19 @@
 #include "src/common/readstream.h"
 #include "src/common/strutil.h"
 #include "src/common/encoding.h"
-#include "src/common/streamtokenizer.h"
+#include "src/common/scopedptr.h"
+#include "src/common/md5.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+#include "src/common/memorytokenizer.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/resman.h"
 
+#include "src/events/events.h"
+
 #include "src/graphics/aurora/model_nwn.h"
+#include "src/graphics/aurora/compiledmodelcache.h"
 #include "src/graphics/aurora/animation.h"
 #include "src/graphics/aurora/animnode.h"
 #include "src/graphics/aurora/animationchannel.h"
@@ -69,6 +77,11 @@ static const int kNodeFlagHasAnim      = 0x00000080;
 static const int kNodeFlagHasDangly    = 0x00000100;
 static const int kNodeFlagHasAABB      = 0x00000200;
 
+static const uint32 kCompiledID      = MKTAG('N', 'W', 'N', 'C');
+static const uint32 kCompiledVersion = 1;
+
+static const char * const kCompiledFormat = "nwnmdl";
+
 static const uint16 kControllerTypePosition             = 8;
 static const uint16 kControllerTypeOrientation          = 20;
 static const uint16 kControllerTypeScale                = 36;
@@ -125,7 +138,7 @@ namespace Aurora {
 
 Model_NWN::ParserContext::ParserContext(const Common::UString &name,
                                         const Common::UString &t) :
-	mdl(0), state(0), texture(t) {
+	mdl(0), state(0), texture(t), mdlASCII(0), tokenize(0) {
 
 	mdl = ResMan.getResource(name, ::Aurora::kFileTypeMDL);
 	if (!mdl)
@@ -135,13 +148,20 @@ Model_NWN::ParserContext::ParserContext(const Common::UString &name,
 	isASCII = mdl->readUint32LE() != 0;
 
 	if (isASCII) {
-		tokenize = new Common::StreamTokenizer(Common::StreamTokenizer::kRuleIgnoreAll);
+		/* Read the whole ASCII model into memory, so that the tokenizer can
+		 * directly look at the characters instead of reading them one by one. */
+		mdl->seek(0);
+		mdlASCII = mdl->readStream(mdl->size());
+
+		delete mdl;
+		mdl = mdlASCII;
+
+		tokenize = new Common::MemoryTokenizer(Common::StreamTokenizer::kRuleIgnoreAll);
 
 		tokenize->addSeparator(' ');
 		tokenize->addChunkEnd('\n');
 		tokenize->addIgnore('\r');
-	} else
-		tokenize = 0;
+	}
 }
 
 Model_NWN::ParserContext::~ParserContext() {
@@ -196,7 +216,7 @@ Model_NWN::Model_NWN(const Common::UString &name, ModelType type,
 	ParserContext ctx(name, texture);
 
 	if (ctx.isASCII)
-		loadASCII(ctx);
+		loadASCIICached(ctx);
 	else
 		loadBinary(ctx);
 
@@ -292,9 +312,9 @@ void Model_NWN::loadASCII(ParserContext &ctx) {
 	while (!ctx.mdl->eos()) {
 		std::vector<Common::UString> line;
 
-		size_t count = ctx.tokenize->getTokens(*ctx.mdl, line, 3);
+		size_t count = ctx.tokenize->getTokens(*ctx.mdlASCII, line, 3);
 
-		ctx.tokenize->nextChunk(*ctx.mdl);
+		ctx.tokenize->nextChunk(*ctx.mdlASCII);
 
 		// Ignore empty lines and comments
 		if ((count == 0) || line[0].empty() || (*line[0].begin() == '#'))
@@ -349,6 +369,207 @@ void Model_NWN::loadASCII(ParserContext &ctx) {
 		readAnimASCII(ctx);
 	}
 }
+
+Model_NWN::CompiledNode::CompiledNode() : render(true), hasMesh(false), meshRender(true),
+	transparencyHint(false), dangly(false) {
+
+	position[0] = position[1] = position[2] = 0.0f;
+
+	orientation[0] = orientation[1] = orientation[2] = orientation[3] = 0.0f;
+}
+
+void Model_NWN::loadASCIICached(ParserContext &ctx) {
+	if (!CompiledModelMan.isEnabled()) {
+		loadASCII(ctx);
+		return;
+	}
+
+	const uint32 start = EventMan.getTimestamp();
+
+	std::vector<byte> hash;
+	Common::hashMD5(ctx.mdlASCII->getData(), ctx.mdlASCII->size(), hash);
+
+	Common::ScopedPtr<Common::SeekableReadStream> compiled(CompiledModelMan.get(kCompiledFormat, hash));
+	if (compiled && loadCompiled(ctx, *compiled)) {
+		debugC(kDebugGraphics, 3, "Loaded compiled NWN ASCII model \"%s\" in %ums",
+		       _fileName.c_str(), EventMan.getTimestamp() - start);
+		return;
+	}
+
+	loadASCII(ctx);
+
+	debugC(kDebugGraphics, 3, "Parsed NWN ASCII model \"%s\" in %ums",
+	       _fileName.c_str(), EventMan.getTimestamp() - start);
+
+	/* The texture override is applied while loading the model, so we can't
+	 * compile such a model. However, models loaded with a texture override
+	 * can still use a model compiled without one. */
+	if (!ctx.texture.empty())
+		return;
+
+	Common::MemoryWriteStreamDynamic out(true);
+	saveCompiled(out);
+
+	CompiledModelMan.put(kCompiledFormat, hash, out.getData(), out.size());
+}
+
+bool Model_NWN::loadCompiled(ParserContext &ctx, Common::SeekableReadStream &compiled) {
+	/* First read everything, so that broken or outdated compiled models can
+	 * be thrown away without leaving a partially created model behind. */
+
+	Common::UString name, superModelName;
+	float animationScale;
+
+	std::vector<CompiledNode> nodes;
+
+	try {
+		if ((compiled.readUint32BE() != kCompiledID) || (compiled.readUint32LE() != kCompiledVersion))
+			return false;
+
+		name           = Common::readString(compiled, Common::kEncodingUTF8);
+		superModelName = Common::readString(compiled, Common::kEncodingUTF8);
+		animationScale = compiled.readIEEEFloatLE();
+
+		const uint32 nodeCount = compiled.readUint32LE();
+		if (nodeCount > (compiled.size() - compiled.pos()))
+			throw Common::Exception("Invalid node count %u", nodeCount);
+
+		nodes.resize(nodeCount);
+		for (std::vector<CompiledNode>::iterator n = nodes.begin(); n != nodes.end(); ++n)
+			readCompiledNode(compiled, *n);
+
+	} catch (Common::Exception &e) {
+		e.add("Failed to read compiled model \"%s\"", _fileName.c_str());
+		Common::printException(e, "WARNING: ");
+
+		return false;
+	}
+
+	_name           = name;
+	_superModelName = superModelName;
+	_animationScale = animationScale;
+
+	ctx.mdlName = _name;
+
+	newState(ctx);
+
+	for (std::vector<CompiledNode>::const_iterator n = nodes.begin(); n != nodes.end(); ++n) {
+		ModelNode_NWN_ASCII *newNode = new ModelNode_NWN_ASCII(*this);
+		ctx.nodes.push_back(newNode);
+
+		newNode->loadCompiled(ctx, *n);
+	}
+
+	addState(ctx);
+
+	return true;
+}
+
+void Model_NWN::saveCompiled(Common::WriteStream &compiled) const {
+	compiled.writeUint32BE(kCompiledID);
+	compiled.writeUint32LE(kCompiledVersion);
+
+	Common::writeString(compiled, _name, Common::kEncodingUTF8);
+	Common::writeString(compiled, _superModelName, Common::kEncodingUTF8);
+	compiled.writeIEEEFloatLE(_animationScale);
+
+	// ASCII models only ever have the default state
+	if (_stateList.empty()) {
+		compiled.writeUint32LE(0);
+		return;
+	}
+
+	const NodeList &nodes = _stateList.front()->nodeList;
+
+	compiled.writeUint32LE(nodes.size());
+	for (NodeList::const_iterator n = nodes.begin(); n != nodes.end(); ++n) {
+		CompiledNode node;
+		static_cast<const ModelNode_NWN_ASCII *>(*n)->saveCompiled(node);
+
+		writeCompiledNode(compiled, node);
+	}
+}
+
+template<typename T>
+static void readCompiledArray(Common::SeekableReadStream &compiled, std::vector<T> &array) {
+	const uint32 count = compiled.readUint32LE();
+	if (count > ((compiled.size() - compiled.pos()) / sizeof(T)))
+		throw Common::Exception("Invalid array size %u", count);
+
+	array.resize(count);
+	compiled.readArrayLE(array.data(), count);
+}
+
+void Model_NWN::readCompiledNode(Common::SeekableReadStream &compiled, CompiledNode &node) {
+	node.name   = Common::readString(compiled, Common::kEncodingUTF8);
+	node.parent = Common::readString(compiled, Common::kEncodingUTF8);
+
+	compiled.readArrayLE(node.position   , ARRAYSIZE(node.position));
+	compiled.readArrayLE(node.orientation, ARRAYSIZE(node.orientation));
+
+	node.render = compiled.readByte() != 0;
+
+	node.hasMesh = compiled.readByte() != 0;
+	if (!node.hasMesh)
+		return;
+
+	node.meshRender       = compiled.readByte() != 0;
+	node.transparencyHint = compiled.readByte() != 0;
+	node.dangly           = compiled.readByte() != 0;
+
+	const uint32 textureCount = compiled.readUint32LE();
+	if (textureCount > (compiled.size() - compiled.pos()))
+		throw Common::Exception("Invalid texture count %u", textureCount);
+
+	node.textures.resize(textureCount);
+	for (std::vector<Common::UString>::iterator t = node.textures.begin(); t != node.textures.end(); ++t)
+		*t = Common::readString(compiled, Common::kEncodingUTF8);
+
+	readCompiledArray(compiled, node.vertices);
+	readCompiledArray(compiled, node.indices);
+
+	const size_t vertexSize = 6 + 2 * node.textures.size();
+	if ((node.vertices.size() % vertexSize) != 0)
+		throw Common::Exception("Invalid vertex data size");
+
+	const size_t vertexCount = node.vertices.size() / vertexSize;
+	for (std::vector<uint32>::const_iterator i = node.indices.begin(); i != node.indices.end(); ++i)
+		if (*i >= vertexCount)
+			throw Common::Exception("Invalid vertex index %u", *i);
+}
+
+void Model_NWN::writeCompiledNode(Common::WriteStream &compiled, const CompiledNode &node) {
+	Common::writeString(compiled, node.name  , Common::kEncodingUTF8);
+	Common::writeString(compiled, node.parent, Common::kEncodingUTF8);
+
+	for (size_t i = 0; i < ARRAYSIZE(node.position); i++)
+		compiled.writeIEEEFloatLE(node.position[i]);
+	for (size_t i = 0; i < ARRAYSIZE(node.orientation); i++)
+		compiled.writeIEEEFloatLE(node.orientation[i]);
+
+	compiled.writeByte(node.render ? 1 : 0);
+
+	compiled.writeByte(node.hasMesh ? 1 : 0);
+	if (!node.hasMesh)
+		return;
+
+	compiled.writeByte(node.meshRender       ? 1 : 0);
+	compiled.writeByte(node.transparencyHint ? 1 : 0);
+	compiled.writeByte(node.dangly           ? 1 : 0);
+
+	compiled.writeUint32LE(node.textures.size());
+	for (std::vector<Common::UString>::const_iterator t = node.textures.begin(); t != node.textures.end(); ++t)
+		Common::writeString(compiled, *t, Common::kEncodingUTF8);
+
+	compiled.writeUint32LE(node.vertices.size());
+	for (std::vector<float>::const_iterator v = node.vertices.begin(); v != node.vertices.end(); ++v)
+		compiled.writeIEEEFloatLE(*v);
+
+	compiled.writeUint32LE(node.indices.size());
+	for (std::vector<uint32>::const_iterator i = node.indices.begin(); i != node.indices.end(); ++i)
+		compiled.writeUint32LE(*i);
+}
+
 void Model_NWN::newState(ParserContext &ctx) {
 	ctx.clear();
 
@@ -363,9 +584,9 @@ void Model_NWN::skipAnimASCII(ParserContext &ctx) {
 	while (!ctx.mdl->eos()) {
 		std::vector<Common::UString> line;
 
-		size_t count = ctx.tokenize->getTokens(*ctx.mdl, line, 1);
+		size_t count = ctx.tokenize->getTokens(*ctx.mdlASCII, line, 1);
 
-		ctx.tokenize->nextChunk(*ctx.mdl);
+		ctx.tokenize->nextChunk(*ctx.mdlASCII);
 
 		// Ignore empty lines and comments
 		if ((count == 0) || line[0].empty() || (*line[0].begin() == '#'))
@@ -823,8 +1044,7 @@ void ModelNode_NWN_Binary::readMesh(Model_NWN::ParserContext &ctx) {
 
 	assert (vertexOffset != 0xFFFFFFFF);
 	ctx.mdl->seek(ctx.offRawData + vertexOffset);
-	for (std::vector<float>::iterator v = vertices.begin(); v != vertices.end(); ++v)
-		*v = ctx.mdl->readIEEEFloatLE();
+	ctx.mdl->readArrayLE(vertices.data(), vertices.size());
 
 	// Read faces
 
@@ -869,15 +1089,11 @@ void ModelNode_NWN_Binary::readMesh(Model_NWN::ParserContext &ctx) {
 	texCoords.resize(textureCount * vertexCount * 2);
 
 	for (uint16 t = 0; t < textureCount; t++) {
-		const bool hasTexture = textureVertexOffset[t] != 0xFFFFFFFF;
-		if (hasTexture)
-			ctx.mdl->seek(ctx.offRawData + textureVertexOffset[t]);
-
-		float *v = &texCoords[t * vertexCount * 2];
-		for (uint32 i = 0; i < vertexCount; i++) {
-			*v++ = hasTexture ? ctx.mdl->readIEEEFloatLE() : 0.0f;
-			*v++ = hasTexture ? ctx.mdl->readIEEEFloatLE() : 0.0f;
-		}
+		if (textureVertexOffset[t] == 0xFFFFFFFF)
+			continue;
+
+		ctx.mdl->seek(ctx.offRawData + textureVertexOffset[t]);
+		ctx.mdl->readArrayLE(&texCoords[t * vertexCount * 2], vertexCount * 2);
 	}
 
 	// Create vertex buffer
@@ -961,8 +1177,7 @@ void ModelNode_NWN_Binary::readMesh(Model_NWN::ParserContext &ctx) {
 		_mesh->data->rawMesh = checkMesh;
 	} else {
 		_mesh->data->rawMesh->setName(meshName);
-		_mesh->data->rawMesh->init();
-		MeshMan.addMesh(_mesh->data->rawMesh);
+		_mesh->data->rawMesh = MeshMan.addSharedMesh(_mesh->data->rawMesh);
 	}
 
 	if (GfxMan.isRendererExperimental())
@@ -1114,9 +1329,9 @@ void ModelNode_NWN_ASCII::load(Model_NWN::ParserContext &ctx,
 	while (!ctx.mdl->eos()) {
 		std::vector<Common::UString> line;
 
-		size_t count = ctx.tokenize->getTokens(*ctx.mdl, line, 5);
+		size_t count = ctx.tokenize->getTokens(*ctx.mdlASCII, line, 5);
 
-		ctx.tokenize->nextChunk(*ctx.mdl);
+		ctx.tokenize->nextChunk(*ctx.mdlASCII);
 
 		// Ignore empty lines and comments
 		if ((count == 0) || line[0].empty() || (*line[0].begin() == '#'))
@@ -1184,11 +1399,110 @@ void ModelNode_NWN_ASCII::load(Model_NWN::ParserContext &ctx,
 	if (!end)
 		throw Common::Exception("ModelNode_NWN_ASCII::load(): node without endnode");
 
+	_textures = mesh.textures;
+
 	if (!mesh.textures.empty() && !ctx.texture.empty())
 		mesh.textures[0] = ctx.texture;
 
 	processMesh(mesh);
+	finishMesh(ctx);
+}
+
+void ModelNode_NWN_ASCII::loadCompiled(Model_NWN::ParserContext &ctx,
+                                       const Model_NWN::CompiledNode &node) {
+
+	_name = node.name;
+
+	ModelNode *parent = 0;
+	if (!ctx.findNode(node.parent, parent))
+		warning("ModelNode_NWN_ASCII::loadCompiled(): Non-existent parent node \"%s\"",
+		        node.parent.c_str());
+
+	setParent(parent);
+
+	std::memcpy(_position   , node.position   , sizeof(_position));
+	std::memcpy(_orientation, node.orientation, sizeof(_orientation));
 
+	_render = node.render;
+
+	if (!node.hasMesh)
+		return;
+
+	_mesh = new ModelNode::Mesh();
+	_mesh->hasTransparencyHint = true;
+	_mesh->render              = node.meshRender;
+	_mesh->transparencyHint    = node.transparencyHint;
+	if (node.dangly)
+		_mesh->dangly = new Dangly();
+
+	if (node.indices.empty())
+		return;
+
+	_textures = node.textures;
+
+	std::vector<Common::UString> textures = node.textures;
+	if (!textures.empty() && !ctx.texture.empty())
+		textures[0] = ctx.texture;
+
+	_mesh->data = new MeshData();
+	_mesh->data->rawMesh = new Graphics::Mesh::Mesh();
+
+	loadTextures(textures);
+
+	VertexDecl vertexDecl;
+
+	vertexDecl.push_back(VertexAttrib(VPOSITION, 3, GL_FLOAT));
+	vertexDecl.push_back(VertexAttrib(VNORMAL  , 3, GL_FLOAT));
+	for (uint t = 0; t < textures.size(); t++)
+		vertexDecl.push_back(VertexAttrib(VTCOORD + t, 2, GL_FLOAT));
+
+	const uint32 vertexCount = node.vertices.size() / (6 + 2 * textures.size());
+
+	VertexBuffer &vertexBuffer = *_mesh->data->rawMesh->getVertexBuffer();
+	vertexBuffer.setVertexDeclInterleave(vertexCount, vertexDecl);
+	std::memcpy(vertexBuffer.getData(), node.vertices.data(), node.vertices.size() * sizeof(float));
+
+	IndexBuffer &indexBuffer = *_mesh->data->rawMesh->getIndexBuffer();
+	indexBuffer.setSize(node.indices.size(), sizeof(uint32), GL_UNSIGNED_INT);
+	std::memcpy(indexBuffer.getData(), node.indices.data(), node.indices.size() * sizeof(uint32));
+
+	createBound();
+
+	finishMesh(ctx);
+}
+
+void ModelNode_NWN_ASCII::saveCompiled(Model_NWN::CompiledNode &node) const {
+	node.name   = _name;
+	node.parent = _parent ? _parent->getName() : "NULL";
+
+	std::memcpy(node.position   , _position   , sizeof(_position));
+	std::memcpy(node.orientation, _orientation, sizeof(_orientation));
+
+	node.render = _render;
+
+	node.hasMesh = _mesh != 0;
+	if (!node.hasMesh)
+		return;
+
+	node.meshRender       = _mesh->render;
+	node.transparencyHint = _mesh->transparencyHint;
+	node.dangly           = _mesh->dangly != 0;
+
+	if (!_mesh->data || !_mesh->data->rawMesh)
+		return;
+
+	node.textures = _textures;
+
+	const VertexBuffer &vertexBuffer = *_mesh->data->rawMesh->getVertexBuffer();
+	const float *vertices = static_cast<const float *>(vertexBuffer.getData());
+	node.vertices.assign(vertices, vertices + (vertexBuffer.getCount() * vertexBuffer.getSize()) / sizeof(float));
+
+	const IndexBuffer &indexBuffer = *_mesh->data->rawMesh->getIndexBuffer();
+	const uint32 *indices = static_cast<const uint32 *>(indexBuffer.getData());
+	node.indices.assign(indices, indices + indexBuffer.getCount());
+}
+
+void ModelNode_NWN_ASCII::finishMesh(Model_NWN::ParserContext &ctx) {
 	Common::UString meshName = ctx.mdlName;
 	meshName += ".";
 	if (ctx.state->name.size() != 0) {
@@ -1212,26 +1526,26 @@ void ModelNode_NWN_ASCII::load(Model_NWN::ParserContext &ctx,
 	}
 
 	_mesh->data->rawMesh->setName(meshName);
-	_mesh->data->rawMesh->init();
 	if (MeshMan.getMesh(meshName)) {
 		warning("Warning: probable mesh duplication of: %s", meshName.c_str());
 	}
-	MeshMan.addMesh(_mesh->data->rawMesh);
+
+	// Keep the vertices as floats, saveCompiled() reads them back
+	_mesh->data->rawMesh = MeshMan.addSharedMesh(_mesh->data->rawMesh, false);
 
 	if (GfxMan.isRendererExperimental())
 		buildMaterial();
 }
 
 void ModelNode_NWN_ASCII::readConstraints(Model_NWN::ParserContext &ctx, uint32 n) {
+	std::vector<Common::TokenView> line;
 	for (uint32 i = 0; i < n; ) {
-		std::vector<Common::UString> line;
-
-		size_t count = ctx.tokenize->getTokens(*ctx.mdl, line, 1);
+		size_t count = ctx.tokenize->getTokens(*ctx.mdlASCII, line, 1);
 
-		ctx.tokenize->nextChunk(*ctx.mdl);
+		ctx.tokenize->nextChunk(*ctx.mdlASCII);
 
 		// Ignore empty lines and comments
-		if ((count == 0) || line[0].empty() || (*line[0].begin() == '#'))
+		if ((count == 0) || line[0].empty() || (line[0][0] == '#'))
 			continue;
 
 		i++;
@@ -1239,15 +1553,14 @@ void ModelNode_NWN_ASCII::readConstraints(Model_NWN::ParserContext &ctx, uint32
 }
 
 void ModelNode_NWN_ASCII::readWeights(Model_NWN::ParserContext &ctx, uint32 n) {
+	std::vector<Common::TokenView> line;
 	for (uint32 i = 0; i < n; ) {
-		std::vector<Common::UString> line;
+		size_t count = ctx.tokenize->getTokens(*ctx.mdlASCII, line, 1);
 
-		size_t count = ctx.tokenize->getTokens(*ctx.mdl, line, 1);
-
-		ctx.tokenize->nextChunk(*ctx.mdl);
+		ctx.tokenize->nextChunk(*ctx.mdlASCII);
 
 		// Ignore empty lines and comments
-		if ((count == 0) || line[0].empty() || (*line[0].begin() == '#'))
+		if ((count == 0) || line[0].empty() || (line[0][0] == '#'))
 			continue;
 
 		i++;
@@ -1269,20 +1582,19 @@ void ModelNode_NWN_ASCII::readVCoords(Model_NWN::ParserContext &ctx, Mesh &mesh)
 	mesh.vY.resize(mesh.vCount);
 	mesh.vZ.resize(mesh.vCount);
 
+	std::vector<Common::TokenView> line;
 	for (uint32 i = 0; i < mesh.vCount; ) {
-		std::vector<Common::UString> line;
-
-		size_t count = ctx.tokenize->getTokens(*ctx.mdl, line, 3);
+		size_t count = ctx.tokenize->getTokens(*ctx.mdlASCII, line, 3);
 
-		ctx.tokenize->nextChunk(*ctx.mdl);
+		ctx.tokenize->nextChunk(*ctx.mdlASCII);
 
 		// Ignore empty lines and comments
-		if ((count == 0) || line[0].empty() || (*line[0].begin() == '#'))
+		if ((count == 0) || line[0].empty() || (line[0][0] == '#'))
 			continue;
 
-		Common::parseString(line[0], mesh.vX[i]);
-		Common::parseString(line[1], mesh.vY[i]);
-		Common::parseString(line[2], mesh.vZ[i]);
+		line[0].parse(mesh.vX[i]);
+		line[1].parse(mesh.vY[i]);
+		line[2].parse(mesh.vZ[i]);
 
 		i++;
 	}
@@ -1292,19 +1604,18 @@ void ModelNode_NWN_ASCII::readTCoords(Model_NWN::ParserContext &ctx, Mesh &mesh)
 	mesh.tX.resize(mesh.tCount);
 	mesh.tY.resize(mesh.tCount);
 
+	std::vector<Common::TokenView> line;
 	for (uint32 i = 0; i < mesh.tCount; ) {
-		std::vector<Common::UString> line;
-
-		size_t count = ctx.tokenize->getTokens(*ctx.mdl, line, 2);
+		size_t count = ctx.tokenize->getTokens(*ctx.mdlASCII, line, 2);
 
-		ctx.tokenize->nextChunk(*ctx.mdl);
+		ctx.tokenize->nextChunk(*ctx.mdlASCII);
 
 		// Ignore empty lines and comments
-		if ((count == 0) || line[0].empty() || (*line[0].begin() == '#'))
+		if ((count == 0) || line[0].empty() || (line[0][0] == '#'))
 			continue;
 
-		Common::parseString(line[0], mesh.tX[i]);
-		Common::parseString(line[1], mesh.tY[i]);
+		line[0].parse(mesh.tX[i]);
+		line[1].parse(mesh.tY[i]);
 
 		i++;
 	}
@@ -1322,28 +1633,27 @@ void ModelNode_NWN_ASCII::readFaces(Model_NWN::ParserContext &ctx, Mesh &mesh) {
 	mesh.smooth.resize(mesh.faceCount);
 	mesh.mat.resize(mesh.faceCount);
 
+	std::vector<Common::TokenView> line;
 	for (uint32 i = 0; i < mesh.faceCount; ) {
-		std::vector<Common::UString> line;
+		size_t count = ctx.tokenize->getTokens(*ctx.mdlASCII, line, 8);
 
-		size_t count = ctx.tokenize->getTokens(*ctx.mdl, line, 8);
-
-		ctx.tokenize->nextChunk(*ctx.mdl);
+		ctx.tokenize->nextChunk(*ctx.mdlASCII);
 
 		// Ignore empty lines and comments
-		if ((count == 0) || line[0].empty() || (*line[0].begin() == '#'))
+		if ((count == 0) || line[0].empty() || (line[0][0] == '#'))
 			continue;
 
-		Common::parseString(line[0], mesh.vIA[i]);
-		Common::parseString(line[1], mesh.vIB[i]);
-		Common::parseString(line[2], mesh.vIC[i]);
+		line[0].parse(mesh.vIA[i]);
+		line[1].parse(mesh.vIB[i]);
+		line[2].parse(mesh.vIC[i]);
 
-		Common::parseString(line[3], mesh.smooth[i]);
+		line[3].parse(mesh.smooth[i]);
 
-		Common::parseString(line[4], mesh.tIA[i]);
-		Common::parseString(line[5], mesh.tIB[i]);
-		Common::parseString(line[6], mesh.tIC[i]);
+		line[4].parse(mesh.tIA[i]);
+		line[5].parse(mesh.tIB[i]);
+		line[6].parse(mesh.tIC[i]);
 
-		Common::parseString(line[7], mesh.mat[i]);
+		line[7].parse(mesh.mat[i]);
 
 		i++;
 	}
@@ -30,7 +30,9 @@
 
 namespace Common {
 	class SeekableReadStream;
-	class StreamTokenizer;
+	class WriteStream;
+	class MemoryReadStream;
+	class MemoryTokenizer;
 }
 
 namespace Graphics {
@@ -47,6 +49,41 @@ public:
 	          const Common::UString &texture = "", ModelCache *modelCache = 0);
 	~Model_NWN();
 
+	// Compiled ASCII models
+
+	/** A node of an ASCII model, compiled into a binary representation.
+	 *
+	 *  The mesh data has already been processed into interleaved vertices
+	 *  (position, normal, and a texture coordinate pair for each texture)
+	 *  and vertex indices.
+	 */
+	struct CompiledNode {
+		Common::UString name;
+		Common::UString parent;
+
+		float position[3];
+		float orientation[4];
+
+		bool render;
+
+		bool hasMesh;
+		bool meshRender;
+		bool transparencyHint;
+		bool dangly;
+
+		std::vector<Common::UString> textures;
+
+		std::vector<float>  vertices;
+		std::vector<uint32> indices;
+
+		CompiledNode();
+	};
+
+	/** Read a compiled node, as written by writeCompiledNode(). */
+	static void readCompiledNode(Common::SeekableReadStream &compiled, CompiledNode &node);
+	/** Write a compiled node into the compiled model data. */
+	static void writeCompiledNode(Common::WriteStream &compiled, const CompiledNode &node);
+
 private:
 	struct ParserContext {
 		Common::SeekableReadStream *mdl;
@@ -67,7 +104,9 @@ private:
 		bool hasPosition;
 		bool hasOrientation;
 
-		Common::StreamTokenizer *tokenize;
+		/** The MDL, read into memory, if it's an ASCII model. */
+		Common::MemoryReadStream *mdlASCII;
+		Common::MemoryTokenizer *tokenize;
 		std::vector<uint32> anims;
 
 		ParserContext(const Common::UString &name, const Common::UString &t);
@@ -78,7 +117,6 @@ private:
 		void clear();
 	};
 
-
 	void newState(ParserContext &ctx);
 	void addState(ParserContext &ctx);
 
@@ -86,9 +124,13 @@ private:
 	void readAnimBinary(ParserContext &ctx, uint32 offset);
 
 	void loadASCII(ParserContext &ctx);
+	void loadASCIICached(ParserContext &ctx);
 	void readAnimASCII(ParserContext &ctx);
 	void skipAnimASCII(ParserContext &ctx);
 
+	bool loadCompiled(ParserContext &ctx, Common::SeekableReadStream &compiled);
+	void saveCompiled(Common::WriteStream &compiled) const;
+
 	void loadSuperModel(ModelCache *modelCache);
 
 	void populateDefaultAnimations();
@@ -124,6 +166,11 @@ public:
 	void load(Model_NWN::ParserContext &ctx,
 	          const Common::UString &type, const Common::UString &name);
 
+	/** Load the node from its compiled representation. */
+	void loadCompiled(Model_NWN::ParserContext &ctx, const Model_NWN::CompiledNode &node);
+	/** Compile the node into a binary representation. */
+	void saveCompiled(Model_NWN::CompiledNode &node) const;
+
 private:
 	struct Mesh {
 		uint32 vCount;
@@ -143,6 +190,9 @@ private:
 		Mesh();
 	};
 
+	/** The names of the textures, as found in the model file. */
+	std::vector<Common::UString> _textures;
+
 	void readConstraints(Model_NWN::ParserContext &ctx, uint32 n);
 	void readWeights(Model_NWN::ParserContext &ctx, uint32 n);
 
@@ -155,6 +205,7 @@ private:
 	void readFaces(Model_NWN::ParserContext &ctx, Mesh &mesh);
 
 	void processMesh(ModelNode_NWN_ASCII::Mesh &mesh);
+	void finishMesh(Model_NWN::ParserContext &ctx);
 };
 
 } // End of namespace Aurora
@@ -319,8 +319,7 @@ bool ModelNode_NWN2::loadRigid(Model_NWN2::ParserContext &ctx) {
 		_mesh->data->rawMesh = checkMesh;
 	} else {
 		_mesh->data->rawMesh->setName(meshName);
-		_mesh->data->rawMesh->init();
-		MeshMan.addMesh(_mesh->data->rawMesh);
+		_mesh->data->rawMesh = MeshMan.addSharedMesh(_mesh->data->rawMesh);
 	}
 
 	createBound();
@@ -449,8 +448,7 @@ bool ModelNode_NWN2::loadSkin(Model_NWN2::ParserContext &ctx) {
 		_mesh->data->rawMesh = checkMesh;
 	} else {
 		_mesh->data->rawMesh->setName(meshName);
-		_mesh->data->rawMesh->init();
-		MeshMan.addMesh(_mesh->data->rawMesh);
+		_mesh->data->rawMesh = MeshMan.addSharedMesh(_mesh->data->rawMesh);
 	}
 
 	return true;
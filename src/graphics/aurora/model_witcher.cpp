@@ -333,8 +333,7 @@ void ModelNode_Witcher::load(Model_Witcher::ParserContext &ctx) {
 				_mesh->data->rawMesh = checkMesh;
 			} else {
 				_mesh->data->rawMesh->setName(meshName);
-				_mesh->data->rawMesh->init();
-				MeshMan.addMesh(_mesh->data->rawMesh);
+				_mesh->data->rawMesh = MeshMan.addSharedMesh(_mesh->data->rawMesh);
 			}
 		} else {
 			delete _mesh->data->rawMesh;
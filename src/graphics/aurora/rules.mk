@@ -41,8 +41,10 @@ src_graphics_libgraphics_la_SOURCES += \
     src/graphics/aurora/guiquad.h \
     src/graphics/aurora/highlightableguiquad.h \
     src/graphics/aurora/geometryobject.h \
+    src/graphics/aurora/chunkedgeometry.h \
     src/graphics/aurora/modelnode.h \
     src/graphics/aurora/model.h \
+    src/graphics/aurora/compiledmodelcache.h \
     src/graphics/aurora/animnode.h \
     src/graphics/aurora/animation.h \
     src/graphics/aurora/fadequad.h \
@@ -84,8 +86,10 @@ src_graphics_libgraphics_la_SOURCES += \
     src/graphics/aurora/highlightableguiquad.cpp \
     src/graphics/aurora/guiquad.cpp \
     src/graphics/aurora/geometryobject.cpp \
+    src/graphics/aurora/chunkedgeometry.cpp \
     src/graphics/aurora/modelnode.cpp \
     src/graphics/aurora/model.cpp \
+    src/graphics/aurora/compiledmodelcache.cpp \
     src/graphics/aurora/animnode.cpp \
     src/graphics/aurora/animation.cpp \
     src/graphics/aurora/fadequad.cpp \
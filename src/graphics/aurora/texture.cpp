@@ -29,6 +29,7 @@
 #include "src/common/strutil.h"
 #include "src/common/error.h"
 #include "src/common/readstream.h"
+#include "src/common/trace.h"
 
 #include "src/graphics/aurora/texture.h"
 #include "src/graphics/aurora/pltfile.h"
@@ -55,12 +56,14 @@ namespace Graphics {
 
 namespace Aurora {
 
-Texture::Texture() : _type(::Aurora::kFileTypeNone), _width(0), _height(0), _deswizzle(false) {
+Texture::Texture() : _type(::Aurora::kFileTypeNone), _width(0), _height(0), _deswizzle(false),
+	_textureMemory(Common::kMemoryTextures) {
 }
 
 Texture::Texture(const Common::UString &name, ImageDecoder *image,
                  ::Aurora::FileType type, TXI *txi, bool deswizzle) :
-	_name(name), _type(type), _width(0), _height(0), _deswizzle(deswizzle) {
+	_name(name), _type(type), _width(0), _height(0), _deswizzle(deswizzle),
+	_textureMemory(Common::kMemoryTextures) {
 
 	set(name, image, type, txi, deswizzle);
 	addToQueues();
@@ -150,9 +153,13 @@ void Texture::doDestroy() {
 	glDeleteTextures(1, &_textureID);
 
 	_textureID = 0;
+
+	_textureMemory.set(0);
 }
 
 void Texture::doRebuild() {
+	TRACE_ZONE("Texture::doRebuild", "graphics");
+
 	if (!_image)
 		// No image
 		return;
@@ -161,6 +168,16 @@ void Texture::doRebuild() {
 	if (_textureID == 0)
 		glGenTextures(1, &_textureID);
 
+	// Only cube maps upload more than the first layer
+	const size_t layerCount = _image->isCubeMap() ? _image->getLayerCount() : 1;
+
+	size_t textureSize = 0;
+	for (size_t i = 0; i < layerCount; i++)
+		for (size_t j = 0; j < _image->getMipMapCount(); j++)
+			textureSize += _image->getMipMap(j, i).size;
+
+	_textureMemory.set(textureSize);
+
 	if (_image->isCubeMap()) {
 		createCubeMapTexture();
 		return;
@@ -321,6 +338,8 @@ Texture *Texture::createPLT(const Common::UString &name, Common::SeekableReadStr
 }
 
 Texture *Texture::create(const Common::UString &name, bool deswizzle) {
+	TRACE_ZONE("Texture::create", "graphics");
+
 	::Aurora::FileType type = ::Aurora::kFileTypeNone;
 	ImageDecoder *image = 0;
 	ImageDecoder *layers[6] = { 0, 0, 0, 0, 0, 0 };
@@ -27,6 +27,7 @@
 
 #include "src/common/scopedptr.h"
 #include "src/common/ustring.h"
+#include "src/common/memaccount.h"
 
 #include "src/graphics/types.h"
 #include "src/graphics/texture.h"
@@ -94,6 +95,8 @@ protected:
 
 	bool _deswizzle;
 
+	Common::MemoryAccount _textureMemory; ///< The memory of the image data uploaded into the texture.
+
 
 	Texture();
 	Texture(const Common::UString &name, ImageDecoder *image, ::Aurora::FileType type, TXI *txi = 0,
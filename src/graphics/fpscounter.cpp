@@ -19,12 +19,18 @@
  */
 
 /** @file
- *  Counting FPS.
+ *  Counting FPS and measuring frame times.
  */
 
 #include <cassert>
+#include <cstring>
+
+#include <chrono>
+#include <algorithm>
 
 #include "src/common/util.h"
+#include "src/common/maths.h"
+#include "src/common/debug.h"
 
 #include "src/graphics/fpscounter.h"
 
@@ -32,11 +38,44 @@
 
 namespace Graphics {
 
+/** Frames taking longer than this many times the average are hitches. */
+static const float kHitchFactor = 2.5f;
+/** Frames need to take at least this many microseconds to be hitches. */
+static const uint32 kHitchMinimum = 33333;
+/** Number of frames needed before hitches are detected. */
+static const size_t kHitchWarmup = 30;
+/** Weight of a new frame in the running averages. */
+static const float kAverageWeight = 1.0f / 32.0f;
+
+static const char * const kFramePhaseNames[kFramePhaseMAX] = {
+	"Events", "Upload", "Render", "Swap", "Other"
+};
+
+static uint64 getMicroseconds() {
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const char *getFramePhaseName(FramePhase phase) {
+	if (((size_t) phase) >= kFramePhaseMAX)
+		return "Frame";
+
+	return kFramePhaseNames[phase];
+}
+
+
+FrameTimeStats::FrameTimeStats() : frames(0), p50(0), p95(0), p99(0), max(0) {
+}
+
+
 FPSCounter::FPSCounter(size_t secs) : _seconds(secs) {
 	assert(_seconds > 0);
 
 	_frames.reset(new uint32[_seconds]);
 
+	_history.resize(kFrameHistory);
+	_hitches.resize(kHitchHistory);
+
 	reset();
 }
 
@@ -47,6 +86,43 @@ uint32 FPSCounter::getFPS() const {
 	return _fps;
 }
 
+FrameTimeStats FPSCounter::getFrameTimeStats() const {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	return _stats;
+}
+
+FrameTimeStats FPSCounter::getFrameTimeStats(FramePhase phase) const {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	return calculateStats(phase);
+}
+
+void FPSCounter::getFrameTimeHistogram(const std::vector<uint32> &limits, std::vector<uint32> &counts) const {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	counts.assign(limits.size() + 1, 0);
+
+	for (size_t i = 0; i < _historyFrames; i++) {
+		const uint32 time = _history[i].time;
+
+		counts[std::upper_bound(limits.begin(), limits.end(), time) - limits.begin()]++;
+	}
+}
+
+void FPSCounter::getHitches(std::vector<FrameHitch> &hitches) const {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	hitches.clear();
+
+	for (size_t i = 0; i < kHitchHistory; i++) {
+		const FrameHitch &hitch = _hitches[(_hitchPos + i) % kHitchHistory];
+
+		if (hitch.time > 0)
+			hitches.push_back(hitch);
+	}
+}
+
 void FPSCounter::reset() {
 	_lastSampled = 0;
 
@@ -58,6 +134,50 @@ void FPSCounter::reset() {
 
 	for (size_t i = 0; i < _seconds; i++)
 		_frames[i] = 0;
+
+	_phase      = kFramePhaseOther;
+	_phaseStart = 0;
+	_frameStart = 0;
+
+	std::memset(&_current, 0, sizeof(_current));
+
+	resetFrameTimes();
+}
+
+void FPSCounter::resetFrameTimes() {
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_averageTime = 0.0f;
+	for (size_t i = 0; i < kFramePhaseMAX; i++)
+		_averagePhaseTime[i] = 0.0f;
+
+	_historyPos    = 0;
+	_historyFrames = 0;
+
+	for (std::vector<FrameHitch>::iterator h = _hitches.begin(); h != _hitches.end(); ++h)
+		std::memset(&*h, 0, sizeof(*h));
+
+	_hitchPos = 0;
+
+	_stats = FrameTimeStats();
+}
+
+FramePhase FPSCounter::startPhase(FramePhase phase) {
+	assert(((size_t) phase) < kFramePhaseMAX);
+
+	const uint64 now = getMicroseconds();
+
+	if (_frameStart == 0)
+		_frameStart = now;
+	else
+		_current.phaseTimes[_phase] += now - _phaseStart;
+
+	const FramePhase previous = _phase;
+
+	_phase      = phase;
+	_phaseStart = now;
+
+	return previous;
 }
 
 void FPSCounter::finishedFrame() {
@@ -66,7 +186,9 @@ void FPSCounter::finishedFrame() {
 	if (_lastSampled == 0)
 		_lastSampled = now;
 
-	if ((now - _lastSampled) >= 1000) {
+	const bool newSecond = (now - _lastSampled) >= 1000;
+
+	if (newSecond) {
 		// We had one second worth of frames
 
 		// Advance to the next second
@@ -86,6 +208,45 @@ void FPSCounter::finishedFrame() {
 
 	// Another frame!
 	_frames[_currentSecond]++;
+
+	// Close the last phase and record the frame. What follows until the next frame is "other"
+	const bool hadFrame = _frameStart != 0;
+	const uint64 frameEnd = getMicroseconds();
+
+	startPhase(kFramePhaseOther);
+
+	if (hadFrame) {
+		_current.time = frameEnd - _frameStart;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		recordFrame(_current);
+
+		if (newSecond)
+			_stats = calculateStats(kFramePhaseMAX);
+	}
+
+	std::memset(&_current, 0, sizeof(_current));
+	_frameStart = frameEnd;
+}
+
+void FPSCounter::skippedFrame() {
+	std::memset(&_current, 0, sizeof(_current));
+
+	_frameStart = 0;
+	_phase      = kFramePhaseOther;
+}
+
+void FPSCounter::addFrame(uint32 time, const uint32 (&phaseTimes)[kFramePhaseMAX]) {
+	FrameTimes frame;
+
+	frame.time = time;
+	for (size_t i = 0; i < kFramePhaseMAX; i++)
+		frame.phaseTimes[i] = phaseTimes[i];
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	recordFrame(frame);
 }
 
 void FPSCounter::calculateFPS() {
@@ -97,4 +258,86 @@ void FPSCounter::calculateFPS() {
 	_fps = seconds ? (frames / seconds) : 0;
 }
 
+void FPSCounter::recordFrame(const FrameTimes &frame) {
+	_history[_historyPos] = frame;
+
+	_historyPos    = (_historyPos + 1) % kFrameHistory;
+	_historyFrames = MIN(_historyFrames + 1, kFrameHistory);
+
+	checkHitch(frame);
+
+	// Update the running averages
+	if (_historyFrames == 1) {
+		_averageTime = frame.time;
+		for (size_t i = 0; i < kFramePhaseMAX; i++)
+			_averagePhaseTime[i] = frame.phaseTimes[i];
+
+		return;
+	}
+
+	_averageTime += (frame.time - _averageTime) * kAverageWeight;
+	for (size_t i = 0; i < kFramePhaseMAX; i++)
+		_averagePhaseTime[i] += (frame.phaseTimes[i] - _averagePhaseTime[i]) * kAverageWeight;
+}
+
+void FPSCounter::checkHitch(const FrameTimes &frame) {
+	if (_historyFrames < kHitchWarmup)
+		return;
+
+	if ((frame.time < kHitchMinimum) || (frame.time < (_averageTime * kHitchFactor)))
+		return;
+
+	// Find the phase that overshot its usual time the most
+	FramePhase worstPhase = kFramePhaseOther;
+	float worstExcess = -1.0f;
+
+	for (size_t i = 0; i < kFramePhaseMAX; i++) {
+		const float excess = frame.phaseTimes[i] - _averagePhaseTime[i];
+		if (excess > worstExcess) {
+			worstPhase  = (FramePhase) i;
+			worstExcess = excess;
+		}
+	}
+
+	FrameHitch &hitch = _hitches[_hitchPos];
+
+	hitch.timestamp  = EventMan.getTimestamp();
+	hitch.time       = frame.time;
+	hitch.worstPhase = worstPhase;
+
+	for (size_t i = 0; i < kFramePhaseMAX; i++)
+		hitch.phaseTimes[i] = frame.phaseTimes[i];
+
+	_hitchPos = (_hitchPos + 1) % kHitchHistory;
+
+	debugC(Common::kDebugGraphics, 1, "Frame hitch: %.2fms, mostly %s (%.2fms, usually %.2fms)",
+	       hitch.time / 1000.0f, getFramePhaseName(worstPhase),
+	       hitch.phaseTimes[worstPhase] / 1000.0f, _averagePhaseTime[worstPhase] / 1000.0f);
+}
+
+FrameTimeStats FPSCounter::calculateStats(int phase) const {
+	FrameTimeStats stats;
+
+	stats.frames = _historyFrames;
+	if (_historyFrames == 0)
+		return stats;
+
+	std::vector<uint32> times;
+	times.reserve(_historyFrames);
+
+	for (size_t i = 0; i < _historyFrames; i++)
+		times.push_back((phase < kFramePhaseMAX) ? _history[i].phaseTimes[phase] : _history[i].time);
+
+	std::sort(times.begin(), times.end());
+
+	const size_t last = times.size() - 1;
+
+	stats.p50 = times[(last * 50) / 100];
+	stats.p95 = times[(last * 95) / 100];
+	stats.p99 = times[(last * 99) / 100];
+	stats.max = times[last];
+
+	return stats;
+}
+
 } // End of namespace Graphics
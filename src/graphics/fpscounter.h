@@ -19,20 +19,66 @@
  */
 
 /** @file
- *  Counting FPS.
+ *  Counting FPS and measuring frame times.
  */
 
 #ifndef GRAPHICS_FPSCOUNTER_H
 #define GRAPHICS_FPSCOUNTER_H
 
+#include <vector>
+
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
+#include "src/common/mutex.h"
 
 namespace Graphics {
 
-/** A class counting frames per second. */
+/** The phases a frame is split into. */
+enum FramePhase {
+	kFramePhaseEvents = 0, ///< Processing events.
+	kFramePhaseUpload    , ///< Uploading new and deleting abandoned textures, shaders and lists.
+	kFramePhaseRender    , ///< Issuing the render calls for the video, world and GUI.
+	kFramePhaseSwap      , ///< Swapping the buffers, waiting for the GPU and vsync.
+	kFramePhaseOther     , ///< Everything else the main thread does between frames.
+
+	kFramePhaseMAX
+};
+
+/** Statistics over the frame times of the most recent frames. All times are in microseconds. */
+struct FrameTimeStats {
+	uint32 frames; ///< Number of frames the statistics are over.
+
+	uint32 p50; ///< Median frame time.
+	uint32 p95; ///< 95th percentile frame time.
+	uint32 p99; ///< 99th percentile frame time.
+	uint32 max; ///< Maximum frame time.
+
+	FrameTimeStats();
+};
+
+/** A frame that took considerably longer than usual. */
+struct FrameHitch {
+	uint32 timestamp; ///< The time the hitch happened, in milliseconds since the start of xoreos.
+
+	uint32 time;                       ///< Time the whole frame took, in microseconds.
+	uint32 phaseTimes[kFramePhaseMAX]; ///< Time each phase took, in microseconds.
+	FramePhase worstPhase;             ///< The phase that exceeded its usual time the most.
+};
+
+/** A class counting frames per second.
+ *
+ *  Additionally, the time each frame takes is measured, split into phases.
+ *  The frame times of the most recent frames are kept, to provide frame
+ *  time percentiles, and frames that take a lot longer than usual are
+ *  recorded as hitches.
+ */
 class FPSCounter  {
 public:
+	/** Number of recent frames the frame time statistics are over. */
+	static const size_t kFrameHistory = 1024;
+	/** Number of recent hitches that are kept. */
+	static const size_t kHitchHistory = 32;
+
 	/** Average the FPS over that many seconds. */
 	FPSCounter(size_t secs);
 	~FPSCounter();
@@ -40,13 +86,50 @@ public:
 	/** Get the current FPS value. */
 	uint32 getFPS() const;
 
+	/** Return the frame time statistics of the whole frame, updated once per second. */
+	FrameTimeStats getFrameTimeStats() const;
+	/** Calculate the current frame time statistics of a frame phase. */
+	FrameTimeStats getFrameTimeStats(FramePhase phase) const;
+
+	/** Count how many of the recent frames fall within each of these frame time limits.
+	 *
+	 *  @param limits  Frame time limits in microseconds, in ascending order.
+	 *  @param counts  counts[i] is the number of frames that took less than
+	 *                 limits[i] (and at least limits[i - 1]). The last
+	 *                 element counts the frames over the last limit.
+	 */
+	void getFrameTimeHistogram(const std::vector<uint32> &limits, std::vector<uint32> &counts) const;
+
+	/** Return the most recent hitches, oldest first. */
+	void getHitches(std::vector<FrameHitch> &hitches) const;
+
 	/** Reset the counter. */
 	void reset();
+	/** Forget all recorded frame times and hitches. Can be called from any thread. */
+	void resetFrameTimes();
+
+	/** Enter a new phase of the current frame, returning the previous phase. */
+	FramePhase startPhase(FramePhase phase);
 
 	/** Signal a finished frame. */
 	void finishedFrame();
+	/** Signal that no frame was rendered this time around. Its time is discarded. */
+	void skippedFrame();
+
+	/** Record a frame that took these times, in microseconds, without measuring it.
+	 *
+	 *  The frame goes into the frame time statistics and the hitch detection,
+	 *  but doesn't count towards the FPS value.
+	 */
+	void addFrame(uint32 time, const uint32 (&phaseTimes)[kFramePhaseMAX]);
 
 private:
+	/** The times of a frame. */
+	struct FrameTimes {
+		uint32 time;
+		uint32 phaseTimes[kFramePhaseMAX];
+	};
+
 	uint32 _lastSampled;     ///< The last time a finished frame was signaled.
 
 	size_t _seconds;       ///< Number of seconds over which to average the FPS.
@@ -58,9 +141,37 @@ private:
 
 	Common::ScopedArray<uint32> _frames; ///< All frame counters.
 
+	FramePhase _phase;      ///< The current phase.
+	uint64     _phaseStart; ///< The time the current phase started, in microseconds.
+	uint64     _frameStart; ///< The time the current frame started, in microseconds.
+
+	FrameTimes _current; ///< The times of the current frame so far.
+
+	float _averageTime;                      ///< Running average of the frame time.
+	float _averagePhaseTime[kFramePhaseMAX]; ///< Running average of the phase times.
+
+	std::vector<FrameTimes> _history; ///< The times of the most recent frames.
+	size_t _historyPos;               ///< Position of the next frame within the history.
+	size_t _historyFrames;            ///< Number of valid frames within the history.
+
+	std::vector<FrameHitch> _hitches; ///< The most recent hitches.
+	size_t _hitchPos;                 ///< Position of the next hitch.
+
+	FrameTimeStats _stats; ///< The current statistics of the whole frame.
+
+	mutable std::mutex _mutex; ///< Mutex protecting the history, the hitches and the statistics.
+
 	void calculateFPS(); ///< Calculate the average FPS value.
+
+	void recordFrame(const FrameTimes &frame); ///< Record the times of the frame that just finished.
+	void checkHitch(const FrameTimes &frame);  ///< Check whether the frame that just finished was a hitch.
+
+	FrameTimeStats calculateStats(int phase) const;
 };
 
+/** Return the name of a frame phase. */
+const char *getFramePhaseName(FramePhase phase);
+
 } // End of namespace Graphics
 
 #endif // GRAPHICS_FPSCOUNTER_H
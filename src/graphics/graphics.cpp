@@ -38,6 +38,7 @@
 #include "src/common/configman.h"
 #include "src/common/debugman.h"
 #include "src/common/threads.h"
+#include "src/common/trace.h"
 
 #include "src/events/requests.h"
 #include "src/events/events.h"
@@ -207,6 +208,30 @@ uint32 GraphicsManager::getFPS() const {
 	return _fpsCounter->getFPS();
 }
 
+FrameTimeStats GraphicsManager::getFrameTimeStats() const {
+	return _fpsCounter->getFrameTimeStats();
+}
+
+FrameTimeStats GraphicsManager::getFrameTimeStats(FramePhase phase) const {
+	return _fpsCounter->getFrameTimeStats(phase);
+}
+
+void GraphicsManager::getFrameTimeHistogram(const std::vector<uint32> &limits, std::vector<uint32> &counts) const {
+	_fpsCounter->getFrameTimeHistogram(limits, counts);
+}
+
+void GraphicsManager::getFrameHitches(std::vector<FrameHitch> &hitches) const {
+	_fpsCounter->getHitches(hitches);
+}
+
+void GraphicsManager::resetFrameTimes() {
+	_fpsCounter->resetFrameTimes();
+}
+
+void GraphicsManager::startFramePhase(FramePhase phase) {
+	_fpsCounter->startPhase(phase);
+}
+
 bool GraphicsManager::setFSAA(int level) {
 	// Force calling it from the main thread
 	if (!Common::isMainThread()) {
@@ -937,6 +962,8 @@ Renderable *GraphicsManager::getObjectAt(float x, float y) {
 }
 
 void GraphicsManager::buildNewTextures() {
+	const FramePhase phase = _fpsCounter->startPhase(kFramePhaseUpload);
+
 	QueueMan.lockQueue(kQueueNewShader);
 	const std::list<Queueable *> &shadq = QueueMan.getQueue(kQueueNewShader);
 	if (shadq.empty()) {
@@ -951,16 +978,15 @@ void GraphicsManager::buildNewTextures() {
 
 	QueueMan.lockQueue(kQueueNewTexture);
 	const std::list<Queueable *> &text = QueueMan.getQueue(kQueueNewTexture);
-	if (text.empty()) {
-		QueueMan.unlockQueue(kQueueNewTexture);
-		return;
-	}
-
-	for (std::list<Queueable *>::const_iterator t = text.begin(); t != text.end(); ++t)
-		static_cast<GLContainer *>(*t)->rebuild();
+	if (!text.empty()) {
+		for (std::list<Queueable *>::const_iterator t = text.begin(); t != text.end(); ++t)
+			static_cast<GLContainer *>(*t)->rebuild();
 
-	QueueMan.clearQueue(kQueueNewTexture);
+		QueueMan.clearQueue(kQueueNewTexture);
+	}
 	QueueMan.unlockQueue(kQueueNewTexture);
+
+	_fpsCounter->startPhase(phase);
 }
 
 void GraphicsManager::beginScene() {
@@ -1247,8 +1273,12 @@ bool GraphicsManager::renderCursorShader() {
 }
 
 void GraphicsManager::endScene() {
+	_fpsCounter->startPhase(kFramePhaseSwap);
+
 	WindowMan.endScene();
 
+	_fpsCounter->startPhase(kFramePhaseOther);
+
 	if (_takeScreenshot) {
 		Graphics::takeScreenshot();
 		_takeScreenshot = false;
@@ -1261,16 +1291,24 @@ void GraphicsManager::endScene() {
 }
 
 void GraphicsManager::renderScene() {
+	TRACE_ZONE("GraphicsManager::renderScene", "graphics");
+
 	Common::enforceMainThread();
 
+	_fpsCounter->startPhase(kFramePhaseUpload);
+
 	cleanupAbandoned();
 
 	if (EventMan.quitRequested() || (_frameLock.load(std::memory_order_acquire) > 0)) {
+		_fpsCounter->skippedFrame();
+
 		_frameEndSignal.store(true, std::memory_order_release);
 
 		return;
 	}
 
+	_fpsCounter->startPhase(kFramePhaseRender);
+
 	beginScene();
 
 	if (playVideo()) {
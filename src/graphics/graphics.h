@@ -39,6 +39,7 @@
 
 #include "src/graphics/types.h"
 #include "src/graphics/windowman.h"
+#include "src/graphics/fpscounter.h"
 
 #include "src/graphics/aurora/animationthread.h"
 
@@ -50,7 +51,6 @@ namespace Aurora {
 	class Model;
 }
 
-class FPSCounter;
 class Cursor;
 class Renderable;
 
@@ -94,6 +94,20 @@ public:
 	/** How many frames per second to we render at the moments? */
 	uint32 getFPS() const;
 
+	/** Return the frame time statistics of the most recent frames, updated once per second. */
+	FrameTimeStats getFrameTimeStats() const;
+	/** Return the current frame time statistics of one phase of the most recent frames. */
+	FrameTimeStats getFrameTimeStats(FramePhase phase) const;
+	/** Sort the most recent frames into a histogram of frame times. See FPSCounter. */
+	void getFrameTimeHistogram(const std::vector<uint32> &limits, std::vector<uint32> &counts) const;
+	/** Return the most recent frame hitches, oldest first. */
+	void getFrameHitches(std::vector<FrameHitch> &hitches) const;
+	/** Forget all recorded frame times and hitches. */
+	void resetFrameTimes();
+
+	/** Enter a new phase of the current frame. */
+	void startFramePhase(FramePhase phase);
+
 	/** Enable/Disable face culling. */
 	void setCullFace(bool enabled, GLenum mode = GL_BACK);
 
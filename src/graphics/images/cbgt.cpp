@@ -221,7 +221,7 @@ void CBGT::createImage(uint32 width, uint32 height) {
 	_mipMaps.back()->height = height;
 	_mipMaps.back()->size   = width * height * 4;
 
-	_mipMaps.back()->data.reset(new byte[_mipMaps.back()->size]);
+	_mipMaps.back()->allocateData();
 	std::memset(_mipMaps.back()->data.get(), 0, _mipMaps.back()->size);
 }
 
@@ -216,7 +216,7 @@ void DDS::setSize(MipMap &mipMap) {
 
 void DDS::readData(Common::SeekableReadStream &dds, DataType dataType) {
 	for (MipMaps::iterator mipMap = _mipMaps.begin(); mipMap != _mipMaps.end(); ++mipMap) {
-		(*mipMap)->data.reset(new byte[(*mipMap)->size]);
+		(*mipMap)->allocateData();
 
 		if (dataType == kDataType4444) {
 
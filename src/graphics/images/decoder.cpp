@@ -38,13 +38,15 @@
 
 namespace Graphics {
 
-ImageDecoder::MipMap::MipMap(const ImageDecoder *i) : width(0), height(0), size(0), image(i) {
+ImageDecoder::MipMap::MipMap(const ImageDecoder *i) : width(0), height(0), size(0), image(i),
+	memory(Common::kMemoryImages) {
 }
 
 ImageDecoder::MipMap::MipMap(const MipMap &mipMap, const ImageDecoder *i) :
-	width(mipMap.width), height(mipMap.height), size(mipMap.size), image(i) {
+	width(mipMap.width), height(mipMap.height), size(mipMap.size), image(i),
+	memory(Common::kMemoryImages) {
 
-	data.reset(new byte[size]);
+	allocateData();
 
 	std::memcpy(data.get(), mipMap.data.get(), size);
 }
@@ -59,6 +61,12 @@ void ImageDecoder::MipMap::swap(MipMap &right) {
 	SWAP(image , right.image );
 
 	data.swap(right.data);
+	memory.swap(right.memory);
+}
+
+void ImageDecoder::MipMap::allocateData() {
+	data.reset(new byte[size]);
+	memory.set(size);
 }
 
 void ImageDecoder::MipMap::getPixel(int x, int y, float &r, float &g, float &b, float &a) const {
@@ -227,7 +235,7 @@ void ImageDecoder::decompress(MipMap &out, const MipMap &in, PixelFormatRaw form
 	out.height = in.height;
 	out.size   = out.width * out.height * 4;
 
-	out.data.reset(new byte[out.size]);
+	out.allocateData();
 
 	Common::ScopedPtr<Common::MemoryReadStream> stream(new Common::MemoryReadStream(in.data.get(), in.size));
 
@@ -32,6 +32,7 @@
 #include "src/common/types.h"
 #include "src/common/scopedptr.h"
 #include "src/common/ptrvector.h"
+#include "src/common/memaccount.h"
 
 #include "src/graphics/types.h"
 
@@ -57,12 +58,18 @@ public:
 
 		const ImageDecoder *image; ///< The image the mip map belongs to.
 
+		/** The memory accounted for the mip map's data. Updated by allocateData(). */
+		Common::MemoryAccount memory;
+
 		MipMap(const ImageDecoder *i = 0);
 		MipMap(const MipMap &mipMap, const ImageDecoder *i = 0);
 		~MipMap();
 
 		void swap(MipMap &right);
 
+		/** Allocate (uninitialized) data for the mip map, according to its size. */
+		void allocateData();
+
 		/** Get the color values of the pixel at this position. */
 		void getPixel(int x, int y, float &r, float &g, float &b, float &a) const;
 		/** Get the color values of the pixel at this index. */
@@ -93,7 +93,7 @@ void NBFS::readImage(Common::SeekableReadStream &nbfs, const byte *palette,
 	_mipMaps.back()->height = height;
 	_mipMaps.back()->size   = width * height * 4;
 
-	_mipMaps.back()->data.reset(new byte[_mipMaps.back()->size]);
+	_mipMaps.back()->allocateData();
 
 	bool is0Transp = (palette[0] == 0xF8) && (palette[1] == 0x00) && (palette[2] == 0xF8);
 
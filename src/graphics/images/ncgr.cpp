@@ -48,10 +48,14 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cassert>
+#include <cstring>
+
 #include "src/common/util.h"
 #include "src/common/strutil.h"
 #include "src/common/readstream.h"
 #include "src/common/error.h"
+#include "src/common/threads.h"
 
 #include "src/graphics/images/ncgr.h"
 #include "src/graphics/images/nclr.h"
@@ -244,6 +248,34 @@ void NCGR::calculateGrid(ReadContext &ctx, uint32 &imageWidth, uint32 &imageHeig
 	}
 }
 
+/** Decode a tiled 8-bit NCGR image.
+ *
+ *  The image data is a sequence of 8x8 pixel tiles, each of them stored row by
+ *  row, with the tiles themselves ordered in rows as well. Every pixel is an
+ *  index into the 32-bit color lookup table.
+ */
+static void decodeTiles(const byte *src, uint32 tilesX, uint32 tilesY, const uint32 *lut,
+                        byte *dest, uint32 destPitch) {
+
+	static const uint32 kTileWidth  = 8;
+	static const uint32 kTileHeight = 8;
+
+	for (uint32 yT = 0; yT < tilesY; yT++) {
+		byte *tileRow = dest + yT * kTileHeight * destPitch;
+
+		for (uint32 xT = 0; xT < tilesX; xT++) {
+			byte *tile = tileRow + xT * kTileWidth * 4;
+
+			for (uint32 y = 0; y < kTileHeight; y++, src += kTileWidth) {
+				byte *row = tile + y * destPitch;
+
+				for (uint32 x = 0; x < kTileWidth; x++)
+					std::memcpy(row + x * 4, &lut[src[x]], 4);
+			}
+		}
+	}
+}
+
 void NCGR::draw(ReadContext &ctx) {
 	uint32 imageWidth, imageHeight;
 	calculateGrid(ctx, imageWidth, imageHeight);
@@ -261,69 +293,70 @@ void NCGR::draw(ReadContext &ctx) {
 	_mipMaps.back()->height = imageHeight;
 	_mipMaps.back()->size   = imageWidth * imageHeight * 4;
 
-	_mipMaps.back()->data.reset(new byte[_mipMaps.back()->size]);
+	_mipMaps.back()->allocateData();
 	byte *data = _mipMaps.back()->data.get();
 
 	const bool is0Transp = (ctx.pal[0] == 0xF8) && (ctx.pal[1] == 0x00) && (ctx.pal[2] == 0xF8);
 
-	// Fill with palette entry 0. Some NCGR cells might be empty, or smaller
-	for (uint32 i = 0; i < (imageWidth * imageHeight); i++) {
-		data[i * 4 + 0] = ctx.pal[0];
-		data[i * 4 + 1] = ctx.pal[1];
-		data[i * 4 + 2] = ctx.pal[2];
-		data[i * 4 + 3] = is0Transp ? 0x00 : 0xFF;
+	// Expand the palette into a lookup table of complete BGRA pixels
+	uint32 lut[256];
+	for (uint32 i = 0; i < 256; i++) {
+		const byte pixel[4] = {
+			ctx.pal[i * 3 + 0], ctx.pal[i * 3 + 1], ctx.pal[i * 3 + 2], ((i == 0) && is0Transp) ? (byte)0x00 : (byte)0xFF
+		};
+
+		std::memcpy(&lut[i], pixel, 4);
 	}
 
+	// Fill with palette entry 0. Some NCGR cells might be empty, or smaller
+	for (uint32 i = 0; i < (imageWidth * imageHeight); i++)
+		std::memcpy(data + i * 4, &lut[0], 4);
+
 	/* The actual image data is stored in a "tiled" fashion, so we need to unswizzle
 	 * this manually. Moreover, we ourselves stitch together several NCGR files into
-	 * one image. */
+	 * one image.
+	 *
+	 * Grab the data of all NCGRs first, without copying if possible. The streams
+	 * might share a parent, so this has to happen in this thread. */
 
-	const uint32 tileWidth  = 8;
-	const uint32 tileHeight = 8;
+	std::vector<const byte *> tiles(ctx.ncgrs.size(), 0);
+	std::vector< std::vector<byte> > tileBuffers(ctx.ncgrs.size());
 
-	for (std::vector<NCGRFile>::iterator n = ctx.ncgrs.begin(); n != ctx.ncgrs.end(); ++n) {
-		if (!n->image)
+	for (size_t i = 0; i < ctx.ncgrs.size(); i++) {
+		NCGRFile &n = ctx.ncgrs[i];
+		if (!n.image)
 			continue;
 
-		n->image->seek(0);
-
-		// Position of this NCGR within the big image
-		const uint32 imagePos = n->offsetX + n->offsetY * imageWidth;
-
-		// Number of "tiles" in this image's rows/columns
-		const uint32 tilesX = n->width  / tileWidth;
-		const uint32 tilesY = n->height / tileHeight;
-
-		// Go over all tiles
-		for (uint32 yT = 0; yT < tilesY; yT++) {
-			for (uint32 xT = 0; xT < tilesX; xT++) {
+		// calculateGrid() made sure every NCGR fits into the full image
+		assert(((n.offsetX + n.width) <= imageWidth) && ((n.offsetY + n.height) <= imageHeight));
 
-				// Position of the tile within the NCGR
-				const uint32 tilePos = xT * tileWidth + yT * tileHeight * imageWidth;
+		const size_t tileDataSize = n.width * n.height;
+		if (n.image->size() < tileDataSize)
+			throw Common::Exception(Common::kReadError);
 
-				// Go over all pixels in the tile
-				for (uint32 y = 0; y < tileHeight; y++) {
-					for (uint32 x = 0; x < tileWidth; x++) {
+		n.image->seek(0);
+		if (!(tiles[i] = n.image->readInPlace(tileDataSize))) {
+			tileBuffers[i].resize(tileDataSize);
+			n.image->read(&tileBuffers[i][0], tileDataSize);
 
-						// Position of the pixel within the tile
-						const uint32 pos   = imagePos + tilePos + x + y * imageWidth;
-						const uint8  pixel = n->image->readByte();
-
-						if (pos > (imageWidth * imageHeight))
-							continue;
+			tiles[i] = &tileBuffers[i][0];
+		}
+	}
 
-						data[pos * 4 + 0] = ctx.pal[pixel * 3 + 0];
-						data[pos * 4 + 1] = ctx.pal[pixel * 3 + 1];
-						data[pos * 4 + 2] = ctx.pal[pixel * 3 + 2];
-						data[pos * 4 + 3] = ((pixel == 0) && is0Transp) ? 0x00 : 0xFF;
+	/* Each NCGR covers its own part of the image, so we can decode them all in parallel.
+	 * Small images aren't worth spinning up threads for, though. */
+	static const uint32 kParallelMinPixels = 256 * 256;
+	const unsigned int maxThreads = ((imageWidth * imageHeight) >= kParallelMinPixels) ? 0 : 1;
 
-					}
-				}
+	Common::parallelFor(ctx.ncgrs.size(), [&](size_t i) {
+		const NCGRFile &n = ctx.ncgrs[i];
+		if (!tiles[i])
+			return;
 
-			}
-		}
+		byte *dest = data + (n.offsetX + n.offsetY * imageWidth) * 4;
 
-	}
+		decodeTiles(tiles[i], n.width / 8, n.height / 8, lut, dest, imageWidth * 4);
+	}, maxThreads);
 }
 
 } // End of namespace Graphics
@@ -24,6 +24,7 @@ src_graphics_images_libimages_la_SOURCES =
 
 src_graphics_images_libimages_la_SOURCES += \
     src/graphics/images/util.h \
+    src/graphics/images/swizzle.h \
     src/graphics/images/decoder.h \
     src/graphics/images/dumptga.h \
     src/graphics/images/screenshot.h \
@@ -47,6 +48,7 @@ src_graphics_images_libimages_la_SOURCES += \
 
 src_graphics_images_libimages_la_SOURCES += \
     src/graphics/images/decoder.cpp \
+    src/graphics/images/swizzle.cpp \
     src/graphics/images/dumptga.cpp \
     src/graphics/images/screenshot.cpp \
     src/graphics/images/surface.cpp \
@@ -29,7 +29,7 @@
 #include "src/common/error.h"
 
 #include "src/graphics/images/sbm.h"
-#include "src/graphics/images/util.h"
+#include "src/graphics/images/swizzle.h"
 
 namespace Graphics {
 
@@ -69,7 +69,7 @@ void SBM::readData(Common::SeekableReadStream &sbm, bool deswizzle) {
 	_mipMaps[0]->height = NEXTPOWER2((uint32) rowCount * 32);
 	_mipMaps[0]->size   = _mipMaps[0]->width * _mipMaps[0]->height * 4;
 
-	_mipMaps[0]->data.reset(new byte[_mipMaps[0]->size]);
+	_mipMaps[0]->allocateData();
 
 	// SBM data consists of character sized 32 * 32 pixels, with 2 bits per pixel.
 	// 4 characters each are on top of each other, occupying the same x/y
@@ -79,6 +79,9 @@ void SBM::readData(Common::SeekableReadStream &sbm, bool deswizzle) {
 	static const int masks [4] = { 0x03, 0x0C, 0x30, 0xC0 };
 	static const int shifts[4] = {    0,    2,    4,    6 };
 
+	// Offsets of the pixels within a character
+	const DeSwizzleTable swizzle(32, (uint32) rowCount, 32, 32);
+
 	byte *data = _mipMaps[0]->data.get();
 	byte buffer[1024];
 	for (size_t c = 0; c < rowCount; c++) {
@@ -89,7 +92,7 @@ void SBM::readData(Common::SeekableReadStream &sbm, bool deswizzle) {
 		for (int y = 0; y < 32; y++) {
 			for (int plane = 0; plane < 4; plane++) {
 				for (int x = 0; x < 32; x++) {
-					const uint32 offset = deswizzle ? deSwizzleOffset(x, y, 32, rowCount) : (y * 32 + x);
+					const uint32 offset = deswizzle ? swizzle.getOffset(x, y) : (y * 32 + x);
 
 					const byte a = ((buffer[offset] & masks[plane]) >> shifts[plane]) * 0x55;
 
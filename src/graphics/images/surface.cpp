@@ -44,7 +44,7 @@ Surface::Surface(int width, int height) {
 	_mipMaps[0]->height = height;
 	_mipMaps[0]->size   = _mipMaps[0]->width * _mipMaps[0]->height * 4;
 
-	_mipMaps[0]->data.reset(new byte[_mipMaps[0]->size]);
+	_mipMaps[0]->allocateData();
 }
 
 Surface::~Surface() {
@@ -94,7 +94,7 @@ void Surface::resize(unsigned int newWidth, unsigned int newHeight) {
 	_mipMaps[0]->height = newHeight;
 	_mipMaps[0]->size   = _mipMaps[0]->width * _mipMaps[0]->height * 4;
 
-	_mipMaps[0]->data.reset(new byte[_mipMaps[0]->size]);
+	_mipMaps[0]->allocateData();
 
 	double xRatio = static_cast<double>(oldWidth) / static_cast<double>(newWidth);
 	double yRatio = static_cast<double>(oldHeight) / static_cast<double>(newHeight);
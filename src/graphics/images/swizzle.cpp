@@ -0,0 +1,162 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  De-swizzling of console texture memory layouts.
+ */
+
+#include <cstring>
+
+#include "src/common/util.h"
+#include "src/common/maths.h"
+#include "src/common/threads.h"
+
+#include "src/graphics/images/swizzle.h"
+
+namespace Graphics {
+
+/** Fill the table with the values 0 to count - 1, with their bits deposited
+ *  into the bits set in mask, in ascending order. Bits of the values that
+ *  exceed the number of bits in the mask are dropped. */
+static void depositBits(std::vector<uint32> &table, uint32 count, uint32 mask) {
+	table.resize(MAX<uint32>(count, 1));
+
+	/* Instead of spreading out the bits of every value one by one, we step
+	 * from one deposited value to the next: setting all bits outside the
+	 * mask lets the carry of the increment skip over them. */
+
+	table[0] = 0;
+	for (uint32 i = 1; i < count; i++)
+		table[i] = ((table[i - 1] | ~mask) + 1) & mask;
+}
+
+DeSwizzleTable::DeSwizzleTable(uint32 width, uint32 height) {
+	create(width, height, width, height);
+}
+
+DeSwizzleTable::DeSwizzleTable(uint32 width, uint32 height, uint32 countX, uint32 countY) {
+	create(width, height, countX, countY);
+}
+
+void DeSwizzleTable::create(uint32 width, uint32 height, uint32 countX, uint32 countY) {
+	uint32 bitsX = MAX(Common::intLog2(width) , 0);
+	uint32 bitsY = MAX(Common::intLog2(height), 0);
+
+	// Interleave the bits, starting with x, until one dimension runs out of bits
+	uint32 maskX = 0, maskY = 0;
+	for (uint32 bit = 0; (bitsX | bitsY) && (bit < 32); ) {
+		if (bitsX) {
+			maskX |= 1 << bit++;
+			bitsX--;
+		}
+
+		if (bitsY && (bit < 32)) {
+			maskY |= 1 << bit++;
+			bitsY--;
+		}
+	}
+
+	depositBits(_x, countX, maskX);
+	depositBits(_y, countY, maskY);
+}
+
+const uint32 *DeSwizzleTable::getColumnOffsets() const {
+	return &_x[0];
+}
+
+uint32 DeSwizzleTable::getRowOffset(uint32 y) const {
+	return _y[y];
+}
+
+template<uint32 kBPP>
+static void deSwizzleRows(byte *dst, const byte *src, const DeSwizzleTable &table,
+                          uint32 width, uint32 yStart, uint32 yEnd) {
+
+	const uint32 *columns = table.getColumnOffsets();
+
+	dst += yStart * width * kBPP;
+	for (uint32 y = yStart; y < yEnd; y++) {
+		const byte *srcRow = src + table.getRowOffset(y) * kBPP;
+
+		for (uint32 x = 0; x < width; x++, dst += kBPP)
+			std::memcpy(dst, srcRow + columns[x] * kBPP, kBPP);
+	}
+}
+
+static void deSwizzleRows(byte *dst, const byte *src, const DeSwizzleTable &table,
+                          uint32 width, uint32 yStart, uint32 yEnd, uint32 bpp) {
+
+	switch (bpp) {
+		case 1:
+			deSwizzleRows<1>(dst, src, table, width, yStart, yEnd);
+			break;
+
+		case 2:
+			deSwizzleRows<2>(dst, src, table, width, yStart, yEnd);
+			break;
+
+		case 3:
+			deSwizzleRows<3>(dst, src, table, width, yStart, yEnd);
+			break;
+
+		case 4:
+			deSwizzleRows<4>(dst, src, table, width, yStart, yEnd);
+			break;
+
+		default:
+			{
+				const uint32 *columns = table.getColumnOffsets();
+
+				dst += yStart * width * bpp;
+				for (uint32 y = yStart; y < yEnd; y++) {
+					const byte *srcRow = src + table.getRowOffset(y) * bpp;
+
+					for (uint32 x = 0; x < width; x++, dst += bpp)
+						std::memcpy(dst, srcRow + columns[x] * bpp, bpp);
+				}
+			}
+			break;
+	}
+}
+
+void deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height, uint32 bpp) {
+	if ((width == 0) || (height == 0) || (bpp == 0))
+		return;
+
+	const DeSwizzleTable table(width, height);
+
+	/* Large images are split into bands of rows, de-swizzled in parallel.
+	 * The swizzled source is read all over the place anyway, so this doesn't
+	 * hurt locality much, and the destination bands are disjoint. */
+
+	static const uint32 kBandPixels = 64 * 1024;
+
+	const uint32 bandHeight = MAX<uint32>(kBandPixels / width, 1);
+	const uint32 bandCount  = (height + bandHeight - 1) / bandHeight;
+
+	Common::parallelFor(bandCount, [&](size_t band) {
+		const uint32 yStart = band * bandHeight;
+		const uint32 yEnd   = MIN(yStart + bandHeight, height);
+
+		deSwizzleRows(dst, src, table, width, yStart, yEnd, bpp);
+	});
+}
+
+} // End of namespace Graphics
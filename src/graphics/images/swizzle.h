@@ -0,0 +1,81 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  De-swizzling of console texture memory layouts.
+ */
+
+#ifndef GRAPHICS_IMAGES_SWIZZLE_H
+#define GRAPHICS_IMAGES_SWIZZLE_H
+
+#include <vector>
+
+#include "src/common/types.h"
+
+namespace Graphics {
+
+/** Lookup tables mapping pixel coordinates into a "swizzled" texture.
+ *
+ *  Swizzled textures, as found on the Xbox, store their pixels in Morton
+ *  order: the offset of a pixel is formed by interleaving the bits of its
+ *  x and y coordinates. Since the x and y bits never overlap, the offset of
+ *  any pixel is simply the combination of one entry out of each table.
+ *
+ *  The tables produce exactly the same offsets as deSwizzleOffset(), including
+ *  its treatment of dimensions that aren't a power of two.
+ */
+class DeSwizzleTable {
+public:
+	/** Create the tables for a swizzled texture of these dimensions, for all its pixels. */
+	DeSwizzleTable(uint32 width, uint32 height);
+	/** Create the tables for a swizzled texture of these dimensions,
+	 *  for countX columns and countY rows. */
+	DeSwizzleTable(uint32 width, uint32 height, uint32 countX, uint32 countY);
+
+	/** Return the swizzled offset, in pixels, of the pixel at these coordinates. */
+	uint32 getOffset(uint32 x, uint32 y) const {
+		return _x[x] | _y[y];
+	}
+
+	/** Return the swizzled offsets of all columns, to be combined with a row offset. */
+	const uint32 *getColumnOffsets() const;
+	/** Return the swizzled offset of a row. */
+	uint32 getRowOffset(uint32 y) const;
+
+private:
+	std::vector<uint32> _x;
+	std::vector<uint32> _y;
+
+	void create(uint32 width, uint32 height, uint32 countX, uint32 countY);
+};
+
+/** De-swizzle a whole image.
+ *
+ *  @param dst    The destination buffer, width * height * bpp bytes large.
+ *  @param src    The swizzled source image data, width * height * bpp bytes large.
+ *  @param width  The width of the image in pixels.
+ *  @param height The height of the image in pixels.
+ *  @param bpp    The number of bytes per pixel.
+ */
+void deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height, uint32 bpp);
+
+} // End of namespace Graphics
+
+#endif // GRAPHICS_IMAGES_SWIZZLE_H
@@ -33,6 +33,7 @@
 
 #include "src/graphics/images/tpc.h"
 #include "src/graphics/images/util.h"
+#include "src/graphics/images/swizzle.h"
 
 static const byte kEncodingGray         = 0x01;
 static const byte kEncodingRGB          = 0x02;
@@ -309,19 +310,6 @@ bool TPC::checkAnimated(uint32 &width, uint32 &height, uint32 &dataSize) {
 	return true;
 }
 
-void TPC::deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height) {
-	for (uint32 y = 0; y < height; y++) {
-		for (uint32 x = 0; x < width; x++) {
-			const uint32 offset = deSwizzleOffset(x, y, width, height) * 4;
-
-			*dst++ = src[offset + 0];
-			*dst++ = src[offset + 1];
-			*dst++ = src[offset + 2];
-			*dst++ = src[offset + 3];
-		}
-	}
-}
-
 void TPC::readData(Common::SeekableReadStream &tpc, byte encoding) {
 	for (MipMaps::iterator mipMap = _mipMaps.begin(); mipMap != _mipMaps.end(); ++mipMap) {
 
@@ -329,7 +317,7 @@ void TPC::readData(Common::SeekableReadStream &tpc, byte encoding) {
 		const bool widthPOT = ((*mipMap)->width & ((*mipMap)->width - 1)) == 0;
 		const bool swizzled = (encoding == kEncodingSwizzledBGRA) && widthPOT;
 
-		(*mipMap)->data.reset(new byte[(*mipMap)->size]);
+		(*mipMap)->allocateData();
 
 		if (swizzled) {
 			std::vector<byte> tmp((*mipMap)->size);
@@ -337,7 +325,7 @@ void TPC::readData(Common::SeekableReadStream &tpc, byte encoding) {
 			if (tpc.read(&tmp[0], (*mipMap)->size) != (*mipMap)->size)
 				throw Common::Exception(Common::kReadError);
 
-			deSwizzle((*mipMap)->data.get(), &tmp[0], (*mipMap)->width, (*mipMap)->height);
+			deSwizzle((*mipMap)->data.get(), &tmp[0], (*mipMap)->width, (*mipMap)->height, 4);
 
 		} else {
 			if (tpc.read((*mipMap)->data.get(), (*mipMap)->size) != (*mipMap)->size)
@@ -348,7 +336,7 @@ void TPC::readData(Common::SeekableReadStream &tpc, byte encoding) {
 				Common::ScopedArray<byte> dataGray((*mipMap)->data.release());
 
 				(*mipMap)->size = (*mipMap)->width * (*mipMap)->height * 3;
-				(*mipMap)->data.reset(new byte[(*mipMap)->size]);
+				(*mipMap)->allocateData();
 
 				for (int i = 0; i < ((*mipMap)->width * (*mipMap)->height); i++)
 					std::memset((*mipMap)->data.get() + i * 3, dataGray[i], 3);
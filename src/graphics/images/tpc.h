@@ -59,8 +59,6 @@ private:
 	bool checkCubeMap(uint32 &width, uint32 &height);
 	bool checkAnimated(uint32 &width, uint32 &height, uint32 &dataSize);
 	void fixupCubeMap();
-
-	static void deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height);
 };
 
 } // End of namespace Graphics
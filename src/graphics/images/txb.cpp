@@ -29,6 +29,7 @@
 
 #include "src/graphics/images/txb.h"
 #include "src/graphics/images/util.h"
+#include "src/graphics/images/swizzle.h"
 
 static const byte kEncodingBGRA = 0x04;
 static const byte kEncodingGray = 0x09;
@@ -163,17 +164,6 @@ void TXB::readHeader(Common::SeekableReadStream &txb, byte &encoding, uint32 &da
 
 }
 
-void TXB::deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height, uint8 bpp) {
-	for (uint32 y = 0; y < height; y++) {
-		for (uint32 x = 0; x < width; x++) {
-			const uint32 offset = deSwizzleOffset(x, y, width, height) * bpp;
-
-			for (uint8 p = 0; p < bpp; p++)
-				*dst++ = src[offset + p];
-		}
-	}
-}
-
 void TXB::readData(Common::SeekableReadStream &txb, byte encoding) {
 	for (MipMaps::iterator mipMap = _mipMaps.begin(); mipMap != _mipMaps.end(); ++mipMap) {
 		const bool needDeSwizzle = (encoding == kEncodingBGRA) || (encoding == kEncodingGray);
@@ -182,7 +172,7 @@ void TXB::readData(Common::SeekableReadStream &txb, byte encoding) {
 		const bool widthPOT = ((*mipMap)->width & ((*mipMap)->width - 1)) == 0;
 		const bool swizzled = needDeSwizzle && widthPOT;
 
-		(*mipMap)->data.reset(new byte[(*mipMap)->size]);
+		(*mipMap)->allocateData();
 		if (txb.read((*mipMap)->data.get(), (*mipMap)->size) != (*mipMap)->size)
 			throw Common::Exception(Common::kReadError);
 
@@ -205,6 +195,7 @@ void TXB::readData(Common::SeekableReadStream &txb, byte encoding) {
 
 			(*mipMap)->data.swap(tmp1);
 			(*mipMap)->size = newSize;
+			(*mipMap)->memory.set(newSize);
 
 		} else if (swizzled) {
 			Common::ScopedArray<byte> tmp(new byte[(*mipMap)->size]);
@@ -52,8 +52,6 @@ private:
 	void readHeader(Common::SeekableReadStream &txb, byte &encoding, uint32 &dataSize);
 	void readData(Common::SeekableReadStream &txb, byte encoding);
 	void readTXI(Common::SeekableReadStream &txb);
-
-	static void deSwizzle(byte *dst, const byte *src, uint32 width, uint32 height, uint8 bpp);
 };
 
 } // End of namespace Graphics
@@ -175,7 +175,11 @@ static inline void rotate90(byte *data, int width, int height, int bpp, int step
 	}
 }
 
-/** De-"swizzle" a texture pixel offset. */
+/** De-"swizzle" a texture pixel offset.
+ *
+ *  This is slow, since it works bit by bit. To de-swizzle whole images, use
+ *  deSwizzle() or a DeSwizzleTable, from swizzle.h, instead.
+ */
 static inline uint32 deSwizzleOffset(uint32 x, uint32 y, uint32 width, uint32 height) {
 	width  = Common::intLog2(width);
 	height = Common::intLog2(height);
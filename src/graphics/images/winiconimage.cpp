@@ -149,7 +149,7 @@ void WinIconImage::readData(Common::SeekableReadStream &cur) {
 	_mipMaps[0]->height = height;
 	_mipMaps[0]->size   = width * height * 4;
 
-	_mipMaps[0]->data.reset(new byte[_mipMaps[0]->size]);
+	_mipMaps[0]->allocateData();
 
 	const byte *xorSrc = xorMap.get();
 	      byte *dst    = _mipMaps[0]->data.get();
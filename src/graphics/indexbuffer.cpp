@@ -29,10 +29,13 @@
 
 namespace Graphics {
 
-IndexBuffer::IndexBuffer() : _count(0), _size(0), _type(GL_UNSIGNED_INT), _data(0), _ibo(0), _hint(GL_STATIC_DRAW) {
+IndexBuffer::IndexBuffer() : _count(0), _size(0), _type(GL_UNSIGNED_INT), _data(0), _ibo(0), _hint(GL_STATIC_DRAW),
+	_memory(Common::kMemoryMeshes) {
 }
 
-IndexBuffer::IndexBuffer(const IndexBuffer &other) : _data(0), _ibo(0), _hint(GL_STATIC_DRAW) {
+IndexBuffer::IndexBuffer(const IndexBuffer &other) : _data(0), _ibo(0), _hint(GL_STATIC_DRAW),
+	_memory(Common::kMemoryMeshes) {
+
 	*this = other;
 }
 
@@ -73,6 +76,8 @@ void IndexBuffer::setSize(uint32 indexCount, uint32 indexSize, GLenum indexType)
 	if (_count && _size) {
 		_data = new byte[_count * _size];
 	}
+
+	_memory.set(_data ? (_count * _size) : 0);
 }
 
 GLvoid *IndexBuffer::getData() {
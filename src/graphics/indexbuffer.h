@@ -25,6 +25,8 @@
 #ifndef GRAPHICS_INDEXBUFFER_H
 #define GRAPHICS_INDEXBUFFER_H
 
+#include "src/common/memaccount.h"
+
 #include "src/graphics/types.h"
 
 namespace Graphics {
@@ -74,6 +76,8 @@ private:
 
 	GLuint _ibo;   ///< "Index" Buffer Object.
 	GLuint _hint;  ///< GL hint for static or dynamic data.
+
+	Common::MemoryAccount _memory; ///< The memory accounted for the buffer data.
 };
 
 } // End of namespace Graphics
@@ -22,12 +22,45 @@
  *  Generic mesh handling class.
  */
 
+#include <cstring>
+#include <cmath>
+
+#include "src/common/util.h"
+#include "src/common/hash.h"
+
 #include "src/graphics/mesh/mesh.h"
+#include "src/graphics/mesh/vertexcache.h"
 
 namespace Graphics {
 
 namespace Mesh {
 
+/** Texture coordinates need to be within [-kHalfFloatRange, kHalfFloatRange]
+ *  to be stored as half-precision floats. Beyond that, the 10-bit mantissa
+ *  would start to visibly shift texels around on larger textures.
+ */
+static const float kHalfFloatRange = 2.0f;
+
+static uint32 getIndexSize(GLenum type) {
+	switch (type) {
+		case GL_UNSIGNED_BYTE:
+			return 1;
+		case GL_UNSIGNED_SHORT:
+			return 2;
+		case GL_UNSIGNED_INT:
+			return 4;
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+/** Return the size of an attribute in bytes, padded to 4 to keep all attributes aligned. */
+static uint32 getAttribSize(GLint size, GLenum type) {
+	return (size * VertexBuffer::getTypeSize(type) + 3) & ~3;
+}
+
 Mesh::Mesh(GLuint type, GLuint hint) : GLContainer(), _type(type), _hint(hint), _usageCount(0), _vao(0), _radius(0.0f), _bindPosePtr(0) {
 }
 
@@ -108,6 +141,181 @@ void Mesh::init() {
 	addToQueue(kQueueNewTexture);
 }
 
+void Mesh::optimizeIndices() {
+	if ((_type != GL_TRIANGLES) || (_indexBuffer.getCount() < 6))
+		return;
+
+	GLvoid *indices = _indexBuffer.getData();
+	if (_indexBuffer.getType() == GL_UNSIGNED_SHORT)
+		optimizeVertexCache(static_cast<uint16 *>(indices), _indexBuffer.getCount(), _vertexBuffer.getCount());
+	else if (_indexBuffer.getType() == GL_UNSIGNED_INT)
+		optimizeVertexCache(static_cast<uint32 *>(indices), _indexBuffer.getCount(), _vertexBuffer.getCount());
+}
+
+void Mesh::compactVertices(bool halfFloats) {
+	const uint32 vertexCount = _vertexBuffer.getCount();
+	if (vertexCount == 0)
+		return;
+
+	const VertexDecl &oldDecl = _vertexBuffer.getVertexDecl();
+
+	// Find the new layout
+
+	VertexDecl decl;
+	std::vector<uint32> offsets;
+
+	bool changed = false;
+	uint32 stride = 0;
+	for (VertexDecl::const_iterator a = oldDecl.begin(); a != oldDecl.end(); ++a) {
+		VertexAttrib attrib(a->index, a->size, a->type);
+
+		if (a->type == GL_FLOAT) {
+			if ((a->index == VNORMAL) && (a->size == 3)) {
+				attrib.type = GL_SHORT;
+			} else if (a->index == VCOLOR) {
+				attrib.type = GL_UNSIGNED_BYTE;
+			} else if (halfFloats && (a->index >= VTCOORD)) {
+				const uint32 aStride = a->stride ? a->stride : (a->size * sizeof(float));
+				const byte *data = static_cast<const byte *>(a->pointer);
+
+				bool inRange = true;
+				for (uint32 v = 0; (v < vertexCount) && inRange; v++, data += aStride) {
+					const float *f = reinterpret_cast<const float *>(data);
+					for (GLint i = 0; i < a->size; i++)
+						inRange = inRange && (ABS(f[i]) <= kHalfFloatRange);
+				}
+
+				if (inRange)
+					attrib.type = GL_HALF_FLOAT;
+			}
+		}
+
+		changed = changed || (attrib.type != a->type);
+
+		offsets.push_back(stride);
+		stride += getAttribSize(attrib.size, attrib.type);
+
+		decl.push_back(attrib);
+	}
+
+	if (!changed || (stride >= _vertexBuffer.getSize()))
+		return;
+
+	// Convert the vertices
+
+	const VertexBuffer oldBuffer(_vertexBuffer);
+	const VertexDecl &srcDecl = oldBuffer.getVertexDecl();
+
+	_vertexBuffer.setSize(vertexCount, stride);
+
+	byte *data = static_cast<byte *>(_vertexBuffer.getData());
+	std::memset(data, 0, vertexCount * stride);
+
+	for (size_t i = 0; i < decl.size(); i++) {
+		const VertexAttrib &src = srcDecl[i];
+		VertexAttrib &dst = decl[i];
+
+		dst.stride  = stride;
+		dst.pointer = data + offsets[i];
+
+		const uint32 srcSize   = src.size * VertexBuffer::getTypeSize(src.type);
+		const uint32 srcStride = src.stride ? src.stride : srcSize;
+
+		const byte *srcData = static_cast<const byte *>(src.pointer);
+		byte *dstData = data + offsets[i];
+
+		for (uint32 v = 0; v < vertexCount; v++, srcData += srcStride, dstData += stride) {
+			const float *f = reinterpret_cast<const float *>(srcData);
+
+			if (dst.type == src.type) {
+				std::memcpy(dstData, srcData, srcSize);
+
+			} else if (dst.type == GL_SHORT) {
+				int16 *n = reinterpret_cast<int16 *>(dstData);
+				for (GLint c = 0; c < dst.size; c++)
+					n[c] = (int16) roundf(CLIP(f[c], -1.0f, 1.0f) * 32767.0f);
+
+			} else if (dst.type == GL_UNSIGNED_BYTE) {
+				for (GLint c = 0; c < dst.size; c++)
+					dstData[c] = (byte) roundf(CLIP(f[c], 0.0f, 1.0f) * 255.0f);
+
+			} else if (dst.type == GL_HALF_FLOAT) {
+				uint16 *h = reinterpret_cast<uint16 *>(dstData);
+				for (GLint c = 0; c < dst.size; c++)
+					h[c] = writeIEEEFloat16(f[c]);
+			}
+		}
+	}
+
+	_vertexBuffer.setVertexDecl(decl);
+}
+
+size_t Mesh::getVertexDataSize() const {
+	return _vertexBuffer.getCount() * _vertexBuffer.getSize();
+}
+
+size_t Mesh::getIndexDataSize() const {
+	return _indexBuffer.getCount() * getIndexSize(_indexBuffer.getType());
+}
+
+uint64 Mesh::getContentHash() const {
+	uint64 hash = Common::hashDataFNV64(0xCBF29CE484222325LL, reinterpret_cast<const byte *>(&_type), sizeof(_type));
+
+	const byte *vertices = static_cast<const byte *>(_vertexBuffer.getData());
+
+	const VertexDecl &decl = _vertexBuffer.getVertexDecl();
+	for (VertexDecl::const_iterator a = decl.begin(); a != decl.end(); ++a) {
+		const uint32 layout[5] = {
+			a->index, (uint32) a->size, a->type, (uint32) a->stride,
+			(uint32) (static_cast<const byte *>(a->pointer) - vertices)
+		};
+
+		hash = Common::hashDataFNV64(hash, reinterpret_cast<const byte *>(layout), sizeof(layout));
+	}
+
+	const GLenum indexType = _indexBuffer.getType();
+
+	hash = Common::hashDataFNV64(hash, vertices, getVertexDataSize());
+	hash = Common::hashDataFNV64(hash, reinterpret_cast<const byte *>(&indexType), sizeof(indexType));
+	hash = Common::hashDataFNV64(hash, static_cast<const byte *>(_indexBuffer.getData()), getIndexDataSize());
+
+	return hash;
+}
+
+bool Mesh::hasSameContent(const Mesh &mesh) const {
+	if ((_type != mesh._type) ||
+	    (_vertexBuffer.getCount() != mesh._vertexBuffer.getCount()) ||
+	    (_vertexBuffer.getSize()  != mesh._vertexBuffer.getSize())  ||
+	    (_indexBuffer.getCount()  != mesh._indexBuffer.getCount())  ||
+	    (_indexBuffer.getType()   != mesh._indexBuffer.getType()))
+		return false;
+
+	const byte *vertices1 = static_cast<const byte *>(_vertexBuffer.getData());
+	const byte *vertices2 = static_cast<const byte *>(mesh._vertexBuffer.getData());
+
+	const VertexDecl &decl1 = _vertexBuffer.getVertexDecl();
+	const VertexDecl &decl2 = mesh._vertexBuffer.getVertexDecl();
+	if (decl1.size() != decl2.size())
+		return false;
+
+	for (size_t i = 0; i < decl1.size(); i++) {
+		if ((decl1[i].index  != decl2[i].index) || (decl1[i].size != decl2[i].size) ||
+		    (decl1[i].type   != decl2[i].type)  || (decl1[i].stride != decl2[i].stride) ||
+		    ((static_cast<const byte *>(decl1[i].pointer) - vertices1) !=
+		     (static_cast<const byte *>(decl2[i].pointer) - vertices2)))
+			return false;
+	}
+
+	if ((getVertexDataSize() > 0) && std::memcmp(vertices1, vertices2, getVertexDataSize()))
+		return false;
+
+	if ((getIndexDataSize() > 0) &&
+	    std::memcmp(_indexBuffer.getData(), mesh._indexBuffer.getData(), getIndexDataSize()))
+		return false;
+
+	return true;
+}
+
 void Mesh::initGL() {
 	_vertexBuffer.initGL(_hint);
 	_indexBuffer.initGL(_hint);
@@ -124,10 +332,15 @@ void Mesh::initGL() {
 			// Using intptr_t to ensure correct bit length for the architecture.
 			intptr_t offset = (intptr_t) (decl[i].pointer);
 			offset -= (intptr_t) (_vertexBuffer.getData());
+
+			// Compacted normals and colors are stored as normalized integers
+			const bool normalized = ((decl[i].index == VNORMAL) || (decl[i].index == VCOLOR)) &&
+			                        (decl[i].type != GL_FLOAT) && (decl[i].type != GL_HALF_FLOAT);
+
 			glVertexAttribPointer(decl[i].index,
 			                      decl[i].size,
 			                      decl[i].type,
-			                      GL_FALSE,
+			                      normalized ? GL_TRUE : GL_FALSE,
 			                      decl[i].stride,
 			                      reinterpret_cast<void *>(offset));
 			glEnableVertexAttribArray(decl[i].index);
@@ -58,6 +58,29 @@ public:
 	/** General mesh initialisation, queuing the mesh for GL resource creation. */
 	void init();
 
+	/** Reorder the indices of a triangle list to better use the post-transform vertex cache. */
+	void optimizeIndices();
+	/** Store normals, colors and, optionally, texture coordinates in smaller types.
+	 *
+	 *  Normals are converted into normalized shorts, colors into normalized
+	 *  unsigned bytes. If halfFloats is true, texture coordinates within a
+	 *  small range are converted into half-precision floats.
+	 *
+	 *  Positions and bone data are left alone, since they are read and
+	 *  modified on the CPU. Needs to be called before init().
+	 */
+	void compactVertices(bool halfFloats);
+
+	/** Return the size of the vertex data in bytes. */
+	size_t getVertexDataSize() const;
+	/** Return the size of the index data in bytes. */
+	size_t getIndexDataSize() const;
+
+	/** Return a hash over the layout and contents of this mesh. */
+	uint64 getContentHash() const;
+	/** Does this mesh have the same layout and contents as another mesh? */
+	bool hasSameContent(const Mesh &mesh) const;
+
 	void initGL();
 	void updateGL();
 	void destroyGL();
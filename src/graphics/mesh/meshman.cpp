@@ -25,6 +25,7 @@
 
 #include "src/common/util.h"
 #include "src/common/uuid.h"
+#include "src/common/configman.h"
 
 #include "src/graphics/mesh/meshman.h"
 #include "src/graphics/mesh/meshwirebox.h"
@@ -37,7 +38,10 @@ namespace Graphics {
 
 namespace Mesh {
 
-MeshManager::MeshManager() {
+MeshManager::Statistics::Statistics() : meshCount(0), vertexSize(0), indexSize(0), sharedCount(0), sharedSize(0) {
+}
+
+MeshManager::MeshManager() : _compactMeshes(false), _halfFloatTexCoords(false), _sharedCount(0), _sharedSize(0) {
 }
 
 MeshManager::~MeshManager() {
@@ -47,6 +51,9 @@ MeshManager::~MeshManager() {
 void MeshManager::init() {
 	status("Initialising default mesh containers...");
 
+	_compactMeshes      = ConfigMan.getBool("compactmeshes", false);
+	_halfFloatTexCoords = GfxMan.isGL3() || GLEW_ARB_half_float_vertex;
+
 	MeshWireBox *wirebox = new MeshWireBox();
 	wirebox->init();
 	wirebox->setName("defaultWireBox");
@@ -68,6 +75,11 @@ void MeshManager::deinit() {
 		delete iter->second;
 	}
 	_resourceMap.clear();
+	_aliasMap.clear();
+	_contentMap.clear();
+
+	_sharedCount = 0;
+	_sharedSize  = 0;
 }
 
 void MeshManager::cleanup() {
@@ -97,6 +109,44 @@ void MeshManager::addMesh(Mesh *mesh, bool forceAddMesh) {
 	}
 }
 
+Mesh *MeshManager::addSharedMesh(Mesh *mesh, bool compact) {
+	if (!mesh) {
+		return 0;
+	}
+
+	mesh->optimizeIndices();
+	if (_compactMeshes && compact) {
+		mesh->compactVertices(_halfFloatTexCoords);
+	}
+
+	const uint64 hash = mesh->getContentHash();
+
+	std::pair<ContentMap::iterator, ContentMap::iterator> range = _contentMap.equal_range(hash);
+	for (ContentMap::iterator iter = range.first; iter != range.second; ++iter) {
+		Mesh *shared = iter->second;
+		if (!shared->hasSameContent(*mesh)) {
+			continue;
+		}
+
+		if (!getMesh(mesh->getName())) {
+			_aliasMap[mesh->getName()] = shared;
+		}
+
+		_sharedCount += 1;
+		_sharedSize  += mesh->getVertexDataSize() + mesh->getIndexDataSize();
+
+		delete mesh;
+		return shared;
+	}
+
+	mesh->init();
+	addMesh(mesh);
+
+	_contentMap.insert(std::make_pair(hash, mesh));
+
+	return mesh;
+}
+
 void MeshManager::delMesh(Mesh *mesh) {
 	if (!mesh) {
 		return;
@@ -112,20 +162,61 @@ Mesh *MeshManager::getMesh(const Common::UString &name) {
 	std::map<Common::UString, Mesh *>::iterator iter = _resourceMap.find(name);
 	if (iter != _resourceMap.end()) {
 		return iter->second;
-	} else {
-		return 0;
 	}
+
+	iter = _aliasMap.find(name);
+	if (iter != _aliasMap.end()) {
+		return iter->second;
+	}
+
+	return 0;
+}
+
+MeshManager::Statistics MeshManager::getStatistics() const {
+	Statistics stats;
+
+	for (std::map<Common::UString, Mesh *>::const_iterator iter = _resourceMap.begin(); iter != _resourceMap.end(); ++iter) {
+		stats.meshCount  += 1;
+		stats.vertexSize += iter->second->getVertexDataSize();
+		stats.indexSize  += iter->second->getIndexDataSize();
+	}
+
+	stats.sharedCount = _sharedCount;
+	stats.sharedSize  = _sharedSize;
+
+	return stats;
 }
 
 std::map<Common::UString, Mesh *>::iterator MeshManager::delResource(std::map<Common::UString, Mesh *>::iterator iter) {
 	std::map<Common::UString, Mesh *>::iterator inext = iter;
 	inext++;
+	forgetMesh(iter->second);
 	delete iter->second;
 	_resourceMap.erase(iter);
 
 	return inext;
 }
 
+void MeshManager::forgetMesh(Mesh *mesh) {
+	std::map<Common::UString, Mesh *>::iterator alias = _aliasMap.begin();
+	while (alias != _aliasMap.end()) {
+		if (alias->second == mesh) {
+			_aliasMap.erase(alias++);
+		} else {
+			++alias;
+		}
+	}
+
+	ContentMap::iterator content = _contentMap.begin();
+	while (content != _contentMap.end()) {
+		if (content->second == mesh) {
+			_contentMap.erase(content++);
+		} else {
+			++content;
+		}
+	}
+}
+
 } // End of namespace Mesh
 
 } // End of namespace Graphics
@@ -39,6 +39,18 @@ namespace Mesh {
 /** The mesh manager. */
 class MeshManager : public Common::Singleton<MeshManager> {
 public:
+	/** Memory statistics of all managed meshes. */
+	struct Statistics {
+		size_t meshCount;   ///< Number of managed meshes.
+		size_t vertexSize;  ///< Size of all vertex data, in bytes.
+		size_t indexSize;   ///< Size of all index data, in bytes.
+
+		size_t sharedCount; ///< Number of added meshes replaced by an identical, existing mesh.
+		size_t sharedSize;  ///< Size of the vertex and index data saved by that, in bytes.
+
+		Statistics();
+	};
+
 	MeshManager();
 	~MeshManager();
 
@@ -53,15 +65,47 @@ public:
 	/** Adds a mesh to be managed. Cleanup will delete the mesh if usage count is zero. */
 	void addMesh(Mesh *mesh, bool forceAddMesh = true);
 
+	/** Adds a freshly loaded mesh to be managed, sharing it with an identical mesh if possible.
+	 *
+	 *  The indices are reordered for the vertex cache. If compacting meshes is
+	 *  enabled and compact is true, the vertex attributes are stored in smaller
+	 *  types as well.
+	 *
+	 *  If a mesh with the same contents is already managed, the given mesh is
+	 *  deleted, its name is made to refer to the existing mesh, and the existing
+	 *  mesh is returned. Otherwise, the given mesh is initialised, added and
+	 *  returned.
+	 */
+	Mesh *addSharedMesh(Mesh *mesh, bool compact = true);
+
 	/** Forcibly remove the mesh from the map. Consider using cleanup instead. */
 	void delMesh(Mesh *mesh);
 
 	/** Returns a mesh with the given name, or zero if it does not exist. */
 	Mesh *getMesh(const Common::UString &name);
 
+	/** Return the memory statistics of all managed meshes. */
+	Statistics getStatistics() const;
+
 private:
+	typedef std::multimap<uint64, Mesh *> ContentMap;
+
 	std::map<Common::UString, Mesh *> _resourceMap;
 
+	/** Names of meshes that were replaced by an identical mesh. */
+	std::map<Common::UString, Mesh *> _aliasMap;
+	/** Meshes added by addSharedMesh(), by content hash. */
+	ContentMap _contentMap;
+
+	bool _compactMeshes;      ///< Store vertex attributes of shared meshes in smaller types?
+	bool _halfFloatTexCoords; ///< Can texture coordinates be stored as half-precision floats?
+
+	size_t _sharedCount;
+	size_t _sharedSize;
+
+	/** Remove all references to a mesh that's about to be deleted. */
+	void forgetMesh(Mesh *mesh);
+
 	std::map<Common::UString, Mesh *>::iterator delResource(std::map<Common::UString, Mesh *>::iterator iter);
 };
 
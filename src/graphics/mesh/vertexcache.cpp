@@ -0,0 +1,243 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Reordering triangle indices for the post-transform vertex cache.
+ */
+
+#include <cmath>
+
+#include <vector>
+#include <algorithm>
+
+#include "src/graphics/mesh/vertexcache.h"
+
+namespace Graphics {
+
+namespace Mesh {
+
+/** Size of the simulated LRU cache. */
+static const int kCacheSize = 32;
+
+static const float kCacheDecayPower   = 1.5f;
+static const float kLastTriangleScore = 0.75f;
+static const float kValenceBoostScale = 2.0f;
+static const float kValenceBoostPower = 0.5f;
+
+static float getVertexScore(int cachePosition, uint32 remainingTriangles) {
+	// No triangles left to use this vertex
+	if (remainingTriangles == 0)
+		return -1.0f;
+
+	float score = 0.0f;
+
+	if (cachePosition >= 0) {
+		if (cachePosition < 3) {
+			// Used by the last triangle. Fixed score, so that it's not favoured too much
+			score = kLastTriangleScore;
+		} else {
+			const float scaler = 1.0f / (kCacheSize - 3);
+
+			score = std::pow(1.0f - (cachePosition - 3) * scaler, kCacheDecayPower);
+		}
+	}
+
+	// Bonus for vertices with only a few triangles left, to get rid of lone triangles
+	score += kValenceBoostScale * std::pow((float) remainingTriangles, -kValenceBoostPower);
+
+	return score;
+}
+
+template<typename T>
+static void optimizeVertexCacheImpl(T *indices, size_t indexCount, size_t vertexCount) {
+	const size_t triangleCount = indexCount / 3;
+	if ((triangleCount < 2) || (vertexCount == 0))
+		return;
+
+	for (size_t i = 0; i < (triangleCount * 3); i++)
+		if (indices[i] >= vertexCount)
+			return;
+
+	// Find all the triangles that use a vertex
+
+	std::vector<uint32> remaining(vertexCount, 0);
+	for (size_t i = 0; i < (triangleCount * 3); i++)
+		remaining[indices[i]]++;
+
+	std::vector<uint32> offsets(vertexCount + 1, 0);
+	for (size_t v = 0; v < vertexCount; v++)
+		offsets[v + 1] = offsets[v] + remaining[v];
+
+	std::vector<uint32> triangles(triangleCount * 3);
+	{
+		std::vector<uint32> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < (triangleCount * 3); i++)
+			triangles[fill[indices[i]]++] = i / 3;
+	}
+
+	// Initial scores
+
+	std::vector<int>   cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+		vertexScore[v] = getVertexScore(-1, remaining[v]);
+
+	std::vector<float> triangleScore(triangleCount);
+	std::vector<bool>  triangleAdded(triangleCount, false);
+
+	int bestTriangle = -1;
+	for (size_t t = 0; t < triangleCount; t++) {
+		triangleScore[t] = vertexScore[indices[t * 3 + 0]] +
+		                   vertexScore[indices[t * 3 + 1]] +
+		                   vertexScore[indices[t * 3 + 2]];
+
+		if ((bestTriangle < 0) || (triangleScore[t] > triangleScore[bestTriangle]))
+			bestTriangle = t;
+	}
+
+	std::vector<T> output;
+	output.reserve(triangleCount * 3);
+
+	std::vector<uint32> cache, newCache;
+	cache.reserve(kCacheSize + 3);
+	newCache.reserve(kCacheSize + 3);
+
+	size_t nextUnadded = 0;
+
+	for (size_t n = 0; n < triangleCount; n++) {
+		// Nothing in the cache is useful anymore, continue with the next free triangle
+		if (bestTriangle < 0) {
+			while (triangleAdded[nextUnadded])
+				nextUnadded++;
+
+			bestTriangle = nextUnadded;
+		}
+
+		const uint32 t = bestTriangle;
+		const T *triangle = indices + t * 3;
+
+		triangleAdded[t] = true;
+
+		output.push_back(triangle[0]);
+		output.push_back(triangle[1]);
+		output.push_back(triangle[2]);
+
+		// Remove the triangle from the lists of its vertices, keeping the still unused ones at the front
+		for (int i = 0; i < 3; i++) {
+			const T v = triangle[i];
+
+			uint32 *first = &triangles[offsets[v]];
+			uint32 *last  = first + remaining[v];
+			uint32 *found = std::find(first, last, t);
+
+			if (found != last) {
+				std::swap(*found, *(last - 1));
+				remaining[v]--;
+			}
+		}
+
+		// Move the triangle's vertices to the front of the cache
+
+		newCache.clear();
+		for (int i = 0; i < 3; i++)
+			if (std::find(newCache.begin(), newCache.end(), triangle[i]) == newCache.end())
+				newCache.push_back(triangle[i]);
+
+		for (std::vector<uint32>::const_iterator c = cache.begin(); c != cache.end(); ++c)
+			if (std::find(newCache.begin(), newCache.end(), *c) == newCache.end())
+				newCache.push_back(*c);
+
+		for (size_t i = 0; i < newCache.size(); i++) {
+			const uint32 v = newCache[i];
+
+			cachePosition[v] = (i < (size_t) kCacheSize) ? (int) i : -1;
+			vertexScore[v]   = getVertexScore(cachePosition[v], remaining[v]);
+		}
+
+		// Rescore all triangles touching the cache, and find the best one
+
+		bestTriangle = -1;
+		for (std::vector<uint32>::const_iterator c = newCache.begin(); c != newCache.end(); ++c) {
+			for (uint32 i = 0; i < remaining[*c]; i++) {
+				const uint32 u = triangles[offsets[*c] + i];
+
+				triangleScore[u] = vertexScore[indices[u * 3 + 0]] +
+				                   vertexScore[indices[u * 3 + 1]] +
+				                   vertexScore[indices[u * 3 + 2]];
+
+				if ((bestTriangle < 0) || (triangleScore[u] > triangleScore[bestTriangle]))
+					bestTriangle = u;
+			}
+		}
+
+		if (newCache.size() > (size_t) kCacheSize)
+			newCache.resize(kCacheSize);
+
+		cache.swap(newCache);
+	}
+
+	std::copy(output.begin(), output.end(), indices);
+}
+
+template<typename T>
+static float getACMRImpl(const T *indices, size_t indexCount, size_t cacheSize) {
+	const size_t triangleCount = indexCount / 3;
+	if ((triangleCount == 0) || (cacheSize == 0))
+		return 0.0f;
+
+	const size_t vertexCount = ((size_t) *std::max_element(indices, indices + triangleCount * 3)) + 1;
+
+	// The miss counter value when each vertex was put into the FIFO cache
+	std::vector<size_t> inserted(vertexCount, 0);
+	std::vector<bool>   cached(vertexCount, false);
+
+	size_t misses = 0;
+	for (size_t i = 0; i < (triangleCount * 3); i++) {
+		const T v = indices[i];
+
+		if (cached[v] && ((misses - inserted[v]) < cacheSize))
+			continue;
+
+		inserted[v] = misses++;
+		cached[v]   = true;
+	}
+
+	return ((float) misses) / triangleCount;
+}
+
+void optimizeVertexCache(uint16 *indices, size_t indexCount, size_t vertexCount) {
+	optimizeVertexCacheImpl(indices, indexCount, vertexCount);
+}
+
+void optimizeVertexCache(uint32 *indices, size_t indexCount, size_t vertexCount) {
+	optimizeVertexCacheImpl(indices, indexCount, vertexCount);
+}
+
+float getACMR(const uint16 *indices, size_t indexCount, size_t cacheSize) {
+	return getACMRImpl(indices, indexCount, cacheSize);
+}
+
+float getACMR(const uint32 *indices, size_t indexCount, size_t cacheSize) {
+	return getACMRImpl(indices, indexCount, cacheSize);
+}
+
+} // End of namespace Mesh
+
+} // End of namespace Graphics
@@ -0,0 +1,61 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Reordering triangle indices for the post-transform vertex cache.
+ */
+
+#ifndef GRAPHICS_MESH_VERTEXCACHE_H
+#define GRAPHICS_MESH_VERTEXCACHE_H
+
+#include <cstddef>
+
+#include "src/common/types.h"
+
+namespace Graphics {
+
+namespace Mesh {
+
+/** Reorder the triangles of an indexed triangle list for the post-transform vertex cache.
+ *
+ *  This is Tom Forsyth's "Linear-Speed Vertex Cache Optimisation": triangles
+ *  are greedily emitted by a score that favours vertices still in a simulated
+ *  LRU cache, and vertices with few remaining triangles.
+ *
+ *  Only the order of the triangles changes, the triangles themselves stay the
+ *  same. If any index is outside [0, vertexCount), the indices are left alone.
+ */
+void optimizeVertexCache(uint16 *indices, size_t indexCount, size_t vertexCount);
+void optimizeVertexCache(uint32 *indices, size_t indexCount, size_t vertexCount);
+
+/** Return the average cache miss ratio of an indexed triangle list.
+ *
+ *  This is the number of vertices transformed per triangle, with a FIFO
+ *  post-transform cache of cacheSize entries. 3.0 is the worst case,
+ *  0.5 about the best possible for a regular grid.
+ */
+float getACMR(const uint16 *indices, size_t indexCount, size_t cacheSize = 16);
+float getACMR(const uint32 *indices, size_t indexCount, size_t cacheSize = 16);
+
+} // End of namespace Mesh
+
+} // End of namespace Graphics
+
+#endif // GRAPHICS_MESH_VERTEXCACHE_H
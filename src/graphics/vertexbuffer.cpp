@@ -99,10 +99,13 @@ void VertexAttrib::disable() const {
 }
 
 
-VertexBuffer::VertexBuffer() : _count(0), _size(0), _data(0), _vbo(0), _hint(GL_STATIC_DRAW) {
+VertexBuffer::VertexBuffer() : _count(0), _size(0), _data(0), _vbo(0), _hint(GL_STATIC_DRAW),
+	_memory(Common::kMemoryMeshes) {
 }
 
-VertexBuffer::VertexBuffer(const VertexBuffer &other) : _data(0), _vbo(0), _hint(GL_STATIC_DRAW) {
+VertexBuffer::VertexBuffer(const VertexBuffer &other) : _data(0), _vbo(0), _hint(GL_STATIC_DRAW),
+	_memory(Common::kMemoryMeshes) {
+
 	*this = other;
 }
 
@@ -158,6 +161,8 @@ void VertexBuffer::setSize(uint32 vertCount, uint32 vertSize) {
 	if (_count && _size) {
 		_data = new byte[_count * _size];
 	}
+
+	_memory.set(_data ? (_count * _size) : 0);
 }
 
 void VertexBuffer::setVertexDecl(const VertexDecl &decl) {
@@ -166,8 +171,10 @@ void VertexBuffer::setVertexDecl(const VertexDecl &decl) {
 
 uint32 VertexBuffer::getTypeSize(GLenum type) {
 	switch (type) {
+		case GL_BYTE:
 		case GL_UNSIGNED_BYTE:
 			return 1;
+		case GL_HALF_FLOAT:
 		case GL_SHORT:
 		case GL_UNSIGNED_SHORT:
 		case GL_2_BYTES:
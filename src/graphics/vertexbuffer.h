@@ -27,6 +27,8 @@
 
 #include <vector>
 
+#include "src/common/memaccount.h"
+
 #include "src/graphics/types.h"
 
 namespace Graphics {
@@ -136,6 +138,9 @@ public:
 	/** Draw this IndexBuffer/VertexBuffer combination. */
 	void draw(GLenum mode, const IndexBuffer &indexBuffer) const;
 
+	/** Return the size of a GL data type in bytes. */
+	static uint32 getTypeSize(GLenum type);
+
 private:
 	VertexDecl _decl; ///< Vertex declaration.
 	uint32 _count;    ///< Number of elements in buffer.
@@ -145,7 +150,7 @@ private:
 	GLuint _vbo;      ///< Vertex Buffer Object.
 	GLuint _hint;     ///< GL hint for static or dynamic data.
 
-	static uint32 getTypeSize(GLenum type);
+	Common::MemoryAccount _memory; ///< The memory accounted for the buffer data.
 };
 
 } // End of namespace Graphics
@@ -33,6 +33,7 @@
 #include "src/common/error.h"
 #include "src/common/configman.h"
 #include "src/common/debug.h"
+#include "src/common/trace.h"
 
 #include "src/sound/sound.h"
 #include "src/sound/audiostream.h"
@@ -67,7 +68,7 @@ namespace Sound {
 SoundManager::Channel::Channel(uint32 i, size_t idx, SoundType t,
                                const TypeList::iterator &ti, AudioStream *s, bool d) :
 	id(i), index(idx), state(AL_PAUSED), stream(s, d), source(0),
-	type(t), typeIt(ti), finishedBuffers(0), gain(1.0f) {
+	type(t), typeIt(ti), finishedBuffers(0), gain(1.0f), memory(Common::kMemorySound) {
 
 }
 
@@ -383,6 +384,8 @@ ChannelHandle SoundManager::playAudioStream(AudioStream *audStream, SoundType ty
 			channel.buffers.push_back(buffer);
 		}
 
+		updateBufferMemory(channel);
+
 		// Set the gain to the current sound type gain
 		alSourcef(channel.source, AL_GAIN, _types[channel.type].gain);
 		// Set the sound per default as relative.
@@ -775,6 +778,16 @@ void SoundManager::bufferData(Channel &channel) {
 
 		buffer = channel.freeBuffers.erase(buffer);
 	}
+
+	updateBufferMemory(channel);
+}
+
+void SoundManager::updateBufferMemory(Channel &channel) {
+	size_t size = 0;
+	for (std::map<ALuint, ALsizei>::const_iterator b = channel.bufferSize.begin(); b != channel.bufferSize.end(); ++b)
+		size += b->second;
+
+	channel.memory.set(size);
 }
 
 void SoundManager::checkReady() {
@@ -783,6 +796,8 @@ void SoundManager::checkReady() {
 }
 
 void SoundManager::update() {
+	TRACE_ZONE("SoundManager::update", "sound");
+
 	std::lock_guard<std::recursive_mutex> lock(_mutex);
 
 	size_t channelCount = 0;
@@ -45,6 +45,7 @@
 #include "src/common/thread.h"
 #include "src/common/ustring.h"
 #include "src/common/mutex.h"
+#include "src/common/memaccount.h"
 
 #include "src/sound/types.h"
 
@@ -222,6 +223,9 @@ private:
 
 		float gain; ///< The channel's gain.
 
+		/** The memory of the sound data in the channel's OpenAL buffers. */
+		Common::MemoryAccount memory;
+
 		Channel(uint32 i, size_t idx, SoundType t, const TypeList::iterator &ti, AudioStream *s, bool d);
 	};
 
@@ -281,6 +285,9 @@ private:
 	void threadMethod();
 
 	/** Fill the buffer with data from the audio stream. */
+	/** Update the memory accounted for the sound data in this channel's buffers. */
+	static void updateBufferMemory(Channel &channel);
+
 	bool fillBuffer(const Channel &channel, ALuint alBuffer,
 	                AudioStream *stream, ALsizei &bufferedSize) const;
 
@@ -39,6 +39,8 @@
 #include "src/common/filepath.h"
 #include "src/common/threads.h"
 #include "src/common/debugman.h"
+#include "src/common/trace.h"
+#include "src/common/memaccount.h"
 #include "src/common/configman.h"
 #include "src/common/random.h"
 #ifdef ENABLE_XML
@@ -63,6 +65,7 @@
 #include "src/graphics/aurora/textureman.h"
 #include "src/graphics/aurora/cursorman.h"
 #include "src/graphics/aurora/fontman.h"
+#include "src/graphics/aurora/compiledmodelcache.h"
 
 #include "src/graphics/mesh/meshman.h"
 
@@ -91,8 +94,13 @@ static void deinit();
 
 static void listDebug();
 
+static void startMemoryLog();
+static void stopMemoryLog();
+
 static bool configFileIsBroken = false;
 
+static Events::TimerHandle *memoryLogTimer = 0;
+
 int main(int argc, char **argv) {
 	initPlatform();
 	initConfig();
@@ -185,9 +193,16 @@ int main(int argc, char **argv) {
 		// Enable requested debug channels
 		DebugMan.setVerbosityLevelsFromConfig();
 
+		// Start tracing right away, if requested
+		if (!ConfigMan.getString("trace", "").empty())
+			TraceMan.start();
+
 		// Initialize all necessary subsystems
 		init();
 
+		// Periodically write the memory usage into the log
+		startMemoryLog();
+
 		// Create all our engine probes
 		createEngineProbes(probes);
 
@@ -219,6 +234,21 @@ int main(int argc, char **argv) {
 
 	destroyEngineProbes(probes);
 
+	stopMemoryLog();
+
+	// Write the trace, if requested
+	const Common::UString traceFile = ConfigMan.getString("trace", "");
+	if (!traceFile.empty()) {
+		try {
+			TraceMan.stop();
+			TraceMan.exportChromeTrace(traceFile);
+
+			status("Wrote trace to \"%s\"", traceFile.c_str());
+		} catch (...) {
+			Common::exceptionDispatcherWarning();
+		}
+	}
+
 	try {
 		// Sync changed debug channel settings
 		DebugMan.setConfigToVerbosityLevels();
@@ -318,6 +348,32 @@ static void init() {
 	status("Event subsystem initialized");
 }
 
+static uint32 logMemoryUsage(uint32 interval) {
+	DebugMan.logString("Memory usage: " + Common::getMemoryUsageSummary() + "\n");
+
+	return interval;
+}
+
+static void startMemoryLog() {
+	const int interval = ConfigMan.getInt("memorylog", 60);
+	if (interval <= 0)
+		return;
+
+	memoryLogTimer = new Events::TimerHandle;
+	TimerMan.addTimer(interval * 1000, *memoryLogTimer, &logMemoryUsage);
+}
+
+static void stopMemoryLog() {
+	if (!memoryLogTimer)
+		return;
+
+	// Log the final state once more before we shut down
+	logMemoryUsage(0);
+
+	delete memoryLogTimer;
+	memoryLogTimer = 0;
+}
+
 static void deinit() {
 	// Deinit subsystems
 	try {
@@ -338,6 +394,7 @@ static void deinit() {
 	Graphics::Aurora::FontManager::destroy();
 	Graphics::Aurora::CursorManager::destroy();
 	Graphics::Aurora::TextureManager::destroy();
+	Graphics::Aurora::CompiledModelCache::destroy();
 
 	Aurora::LanguageManager::destroy();
 	Aurora::TalkManager::destroy();
@@ -372,6 +429,7 @@ static void deinit() {
 
 	Events::NotificationManager::destroy();
 
+	Common::TraceManager::destroy();
 	Common::DebugManager::destroy();
 	Common::ConfigManager::destroy();
 	Common::Random::destroy();
@@ -30,6 +30,8 @@
 #include "src/aurora/actionscript/asbuffer.h"
 #include "src/aurora/actionscript/function.h"
 #include "src/aurora/actionscript/array.h"
+#include "src/aurora/actionscript/movieclip.h"
+#include "src/aurora/actionscript/stage.h"
 
 /*
  *  class Test {
@@ -378,3 +380,141 @@ GTEST_TEST(ActionScript, ArrayTestClass) {
 
 	delete stream;
 }
+
+GTEST_TEST(ActionScript, invalidTag) {
+	// A push claiming more data than the script holds
+	static const byte kInvalidPush[] = { 0x96, 0x10, 0x00, 0x07, 0x01, 0x00, 0x00, 0x00, 0x00 };
+
+	Common::MemoryReadStream stream(kInvalidPush);
+	Aurora::ActionScript::ASBuffer asBuffer(&stream);
+
+	Aurora::ActionScript::AVM avm;
+	EXPECT_THROW(asBuffer.run(avm), Common::Exception);
+}
+
+GTEST_TEST(ActionScript, functionEndsEarly) {
+	/* f = function() { end; x = 2; }; y = 1;
+	 *
+	 * The function body holds more code after its action end opcode,
+	 * which must neither be run nor be decoded as part of the outer code.
+	 */
+	static const byte kScript[] = {
+		0x96, 0x03, 0x00, 0x00, 'f', 0x00,
+		0x9B, 0x06, 0x00, 'f', 0x00, 0x00, 0x00, 0x10, 0x00,
+			0x00,
+			0x96, 0x03, 0x00, 0x00, 'x', 0x00,
+			0x96, 0x05, 0x00, 0x07, 0x02, 0x00, 0x00, 0x00,
+			0x1D,
+		0x1D,
+		0x96, 0x03, 0x00, 0x00, 'y', 0x00,
+		0x96, 0x05, 0x00, 0x07, 0x01, 0x00, 0x00, 0x00,
+		0x1D,
+		0x00
+	};
+
+	Common::MemoryReadStream stream(kScript);
+	Aurora::ActionScript::ASBuffer asBuffer(&stream);
+
+	Aurora::ActionScript::AVM avm;
+	asBuffer.run(avm);
+
+	ASSERT_TRUE(avm.hasVariable("f"));
+	EXPECT_TRUE(avm.getVariable("f").isFunction());
+
+	ASSERT_TRUE(avm.hasVariable("y"));
+	EXPECT_EQ(avm.getVariable("y").asNumber(), 1);
+
+	EXPECT_FALSE(avm.hasVariable("x"));
+}
+
+GTEST_TEST(ActionScript, invalidFunctionTag) {
+	// A function definition whose tag length doesn't match its header
+	static const byte kScript[] = {
+		0x9B, 0x07, 0x00, 'f', 0x00, 0x00, 0x00, 0x01, 0x00, 0x00,
+			0x00,
+		0x00
+	};
+
+	Common::MemoryReadStream stream(kScript);
+	Aurora::ActionScript::ASBuffer asBuffer(&stream);
+
+	Aurora::ActionScript::AVM avm;
+	EXPECT_THROW(asBuffer.run(avm), Common::Exception);
+}
+
+static size_t updateStage(Aurora::ActionScript::AVM &avm, std::vector<Aurora::ActionScript::MovieClip *> &redrawn) {
+	redrawn.clear();
+
+	return avm.getStage().updateDisplayList([&redrawn](Aurora::ActionScript::MovieClip &clip, uint32 UNUSED(dirty)) {
+		redrawn.push_back(&clip);
+	});
+}
+
+GTEST_TEST(ActionScript, displayList) {
+	Aurora::ActionScript::AVM avm;
+
+	Aurora::ActionScript::MovieClipPtr root = avm.getStage().getRoot();
+	ASSERT_TRUE(root.get());
+	EXPECT_EQ(avm.getVariable("_root").asObject().get(), root.get());
+
+	Aurora::ActionScript::MovieClipPtr a(new Aurora::ActionScript::MovieClip);
+	Aurora::ActionScript::MovieClipPtr b(new Aurora::ActionScript::MovieClip);
+	Aurora::ActionScript::MovieClipPtr c(new Aurora::ActionScript::MovieClip);
+
+	root->placeChild(1, a);
+	root->placeChild(2, b);
+	b->placeChild(1, c);
+
+	EXPECT_EQ(root->getChildCount(), 2);
+	EXPECT_EQ(b->getChild(1).get(), c.get());
+	EXPECT_EQ(c->getParent(), b.get());
+
+	std::vector<Aurora::ActionScript::MovieClip *> redrawn;
+
+	// Everything is new
+	EXPECT_EQ(updateStage(avm, redrawn), 4);
+	EXPECT_EQ(avm.getStage().getLastRedrawCount(), 4);
+
+	// Nothing changed
+	EXPECT_EQ(updateStage(avm, redrawn), 0);
+
+	// Changing a clip from actionscript only redraws that clip
+	c->setMember("_x", 10.0);
+	EXPECT_EQ(c->getMember("_x").asNumber(), 10.0);
+	EXPECT_EQ(c->getDirtyFlags(), Aurora::ActionScript::MovieClip::kDirtyTransform);
+
+	ASSERT_EQ(updateStage(avm, redrawn), 1);
+	EXPECT_EQ(redrawn[0], c.get());
+
+	// Setting the same value again doesn't change anything
+	c->setMember("_x", 10.0);
+	EXPECT_EQ(updateStage(avm, redrawn), 0);
+
+	// Changes inside an invisible clip wait until the clip is visible again
+	b->setVisible(false);
+	c->setAlpha(50.0f);
+
+	ASSERT_EQ(updateStage(avm, redrawn), 1);
+	EXPECT_EQ(redrawn[0], b.get());
+
+	a->setCharacterId(5);
+
+	ASSERT_EQ(updateStage(avm, redrawn), 1);
+	EXPECT_EQ(redrawn[0], a.get());
+
+	b->setMember("_visible", true);
+
+	ASSERT_EQ(updateStage(avm, redrawn), 2);
+	EXPECT_EQ(redrawn[0], b.get());
+	EXPECT_EQ(redrawn[1], c.get());
+
+	// Removing a clip redraws its parent
+	root->removeChild(1);
+	EXPECT_EQ(a->getParent(), (Aurora::ActionScript::MovieClip *) 0);
+
+	ASSERT_EQ(updateStage(avm, redrawn), 1);
+	EXPECT_EQ(redrawn[0], root.get());
+
+	EXPECT_EQ(avm.getStage().getTotalRedrawCount(), 10);
+	EXPECT_EQ(avm.getStage().getUpdateCount(), 8);
+}
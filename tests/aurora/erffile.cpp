@@ -22,8 +22,11 @@
  *  Unit tests for our ERF file archive class.
  */
 
+#include <vector>
+
 #include "gtest/gtest.h"
 
+#include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/hash.h"
 #include "src/common/memreadstream.h"
@@ -1649,6 +1652,31 @@ GTEST_TEST(ERFFile22BlowfishDeflateRaw, getResource) {
 	delete file;
 }
 
+GTEST_TEST(ERFFile22BlowfishDeflateRaw, getResourcePartialBlock) {
+	/* Grow the packed data by a few bytes past the end of the DEFLATE stream,
+	 * so that its size isn't a multiple of the Blowfish block size anymore. */
+	static const size_t kPackedSizeOffset = 0x7C;
+	static const size_t kExtraBytes       = 3;
+
+	std::vector<byte> data(kERFFile22BDR, kERFFile22BDR + sizeof(kERFFile22BDR));
+	data.resize(data.size() + kExtraBytes, 0x00);
+
+	WRITE_LE_UINT32(&data[kPackedSizeOffset], READ_LE_UINT32(&data[kPackedSizeOffset]) + kExtraBytes);
+
+	PasswordStore password(kERF22BDRPassword);
+	const Aurora::ERFFile erf(new Common::MemoryReadStream(&data[0], data.size()), password);
+
+	Common::SeekableReadStream *file = erf.getResource(0);
+	ASSERT_NE(file, static_cast<Common::SeekableReadStream *>(0));
+
+	ASSERT_EQ(file->size(), strlen(kFileData));
+
+	for (size_t i = 0; i < strlen(kFileData); i++)
+		EXPECT_EQ(file->readByte(), kFileData[i]) << "At index " << i;
+
+	delete file;
+}
+
 // --- ERF V3.0 (plain) ---
 
 // Percy Bysshe Shelley's "Ozymandias", within an ERF V3.0 (plain) file
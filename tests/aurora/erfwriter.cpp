@@ -24,6 +24,8 @@
 
 #include "gtest/gtest.h"
 
+#include "src/common/scopedptr.h"
+#include "src/common/memreadstream.h"
 #include "src/common/memwritestream.h"
 
 #include "src/aurora/erfwriter.h"
@@ -538,3 +540,56 @@ GTEST_TEST(ERFWriter, WriteMultipleFiles) {
 	delete readStream2;
 	delete readStream3;
 }
+
+static void testWriteV22(Aurora::ERFWriter::Compression compression) {
+	Common::MemoryReadStream dataStream1(kFileData, true);
+	const size_t kFileDataSize = dataStream1.size();
+
+	const size_t kLogoDataSize = sizeof(kLogoData);
+	Common::MemoryReadStream dataStream2(kLogoData, kLogoDataSize);
+
+	Common::MemoryWriteStreamDynamic writeStream;
+	Aurora::ERFWriter erfWriter(MKTAG('E', 'R', 'F', ' '), 2, writeStream,
+	                            Aurora::ERFWriter::kERFVersion22, Aurora::LocString(), compression);
+	erfWriter.add("ozymandias", Aurora::kFileTypeTXT, dataStream1);
+	erfWriter.add("logo", Aurora::kFileTypeBMP, dataStream2);
+
+	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size(), true));
+
+	ASSERT_EQ(erf.getResources().size(), 2);
+
+	EXPECT_EQ(erf.findResource("ozymandias", Aurora::kFileTypeTXT), 0);
+	EXPECT_EQ(erf.findResource("logo", Aurora::kFileTypeBMP), 1);
+
+	EXPECT_EQ(erf.getResourceSize(0), kFileDataSize);
+	EXPECT_EQ(erf.getResourceSize(1), kLogoDataSize);
+
+	Common::ScopedPtr<Common::SeekableReadStream> readStream1(erf.getResource(0));
+	ASSERT_EQ(readStream1->size(), kFileDataSize);
+	Common::ScopedPtr<Common::SeekableReadStream> readStream2(erf.getResource(1));
+	ASSERT_EQ(readStream2->size(), kLogoDataSize);
+
+	for (size_t i = 0; i < kFileDataSize; ++i)
+		EXPECT_EQ(readStream1->readByte(), (byte)kFileData[i]) << "At index " << i;
+	for (size_t i = 0; i < kLogoDataSize; ++i)
+		EXPECT_EQ(readStream2->readByte(), kLogoData[i]) << "At index " << i;
+}
+
+GTEST_TEST(ERFWriter, WriteV22) {
+	testWriteV22(Aurora::ERFWriter::kCompressionNone);
+}
+
+GTEST_TEST(ERFWriter, WriteV22BioWareZlib) {
+	testWriteV22(Aurora::ERFWriter::kCompressionBioWareZlib);
+}
+
+GTEST_TEST(ERFWriter, WriteV22HeaderlessZlib) {
+	testWriteV22(Aurora::ERFWriter::kCompressionHeaderlessZlib);
+}
+
+GTEST_TEST(ERFWriter, CompressionUnsupported) {
+	Common::MemoryWriteStreamDynamic writeStream;
+
+	EXPECT_THROW(Aurora::ERFWriter(MKTAG('E', 'R', 'F', ' '), 0, writeStream, Aurora::ERFWriter::kERFVersion10,
+	                               Aurora::LocString(), Aurora::ERFWriter::kCompressionBioWareZlib), Common::Exception);
+}
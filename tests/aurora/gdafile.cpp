@@ -29,10 +29,12 @@
 #include "src/common/encoding.h"
 #include "src/common/hash.h"
 #include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
 #include "src/aurora/gff4file.h"
 #include "src/aurora/gff4fields.h"
 
 #include "src/aurora/gdafile.h"
+#include "src/aurora/gdaheaders.h"
 
 static const byte kGDAFile[] = {
 	0x47,0x46,0x46,0x20,0x56,0x34,0x2E,0x30,0x50,0x43,0x20,0x20,0x47,0x32,0x44,0x41,
@@ -369,3 +371,185 @@ GTEST_TEST(GDAFile, add) {
 		EXPECT_EQ(gda.getInt(index, "Value"), kIDs[i]);
 	}
 }
+
+GTEST_TEST(GDAFile, hashGDAHeader) {
+	static constexpr uint32 kHashID = Aurora::hashGDAHeader("ID");
+	EXPECT_EQ(kHashID, Common::hashStringCRC32("id", Common::kEncodingUTF16LE));
+
+	for (size_t i = 0; i < kColumnCount; i++) {
+		EXPECT_EQ(Aurora::hashGDAHeader(kHeaders[i]),
+		          Common::hashStringCRC32(kHeadersLow[i], Common::kEncodingUTF16LE)) << "At index " << i;
+		EXPECT_EQ(Aurora::hashGDAHeader(kHeadersLow[i]),
+		          Common::hashStringCRC32(kHeadersLow[i], Common::kEncodingUTF16LE)) << "At index " << i;
+	}
+
+	EXPECT_STREQ(Aurora::findGDAHeader(Aurora::hashGDAHeader("SoundMap")), "SoundMap");
+}
+
+GTEST_TEST(GDAFile, getColumn) {
+	const Aurora::GDAFile gda(new Common::MemoryReadStream(kGDAFile));
+
+	for (size_t i = 0; i < kColumnCount; i++) {
+		EXPECT_TRUE(gda.getColumn(kHeaders[i]).isValid());
+		EXPECT_TRUE(gda.getColumn(Aurora::hashGDAHeader(kHeaders[i])).isValid());
+	}
+
+	EXPECT_FALSE(gda.getColumn("NOPE").isValid());
+	EXPECT_FALSE(gda.getColumn(9999).isValid());
+	EXPECT_FALSE(Aurora::GDAFile::ColumnHandle().isValid());
+}
+
+GTEST_TEST(GDAFile, getColumnHandle) {
+	const Aurora::GDAFile gda(new Common::MemoryReadStream(kGDAFile));
+
+	const Aurora::GDAFile::ColumnHandle columnID       = gda.getColumn(kHeaders[0]);
+	const Aurora::GDAFile::ColumnHandle columnString   = gda.getColumn(kHeaders[1]);
+	const Aurora::GDAFile::ColumnHandle columnInt      = gda.getColumn(kHeaders[2]);
+	const Aurora::GDAFile::ColumnHandle columnFloat    = gda.getColumn(kHeaders[3]);
+	const Aurora::GDAFile::ColumnHandle columnBool     = gda.getColumn(kHeaders[4]);
+	const Aurora::GDAFile::ColumnHandle columnResource = gda.getColumn(kHeaders[5]);
+
+	for (size_t i = 0; i < kRowCount; i++) {
+		EXPECT_EQ(gda.getInt(i, columnID), kDataID[i]);
+		EXPECT_STREQ(gda.getString(i, columnString).c_str(), kDataString[i]);
+		EXPECT_EQ(gda.getInt(i, columnInt), kDataInt[i]);
+		EXPECT_FLOAT_EQ(gda.getFloat(i, columnFloat), kDataFloat[i]);
+		EXPECT_EQ(gda.getInt(i, columnBool), kDataBool[i]);
+		EXPECT_STREQ(gda.getString(i, columnResource).c_str(), kDataResource[i]);
+	}
+
+	const Aurora::GDAFile::ColumnHandle invalid;
+
+	EXPECT_STREQ(gda.getString(9999, columnString).c_str(), "");
+	EXPECT_STREQ(gda.getString(   0, invalid, "nope").c_str(), "nope");
+	EXPECT_EQ(gda.getInt(9999, columnInt, 9999), 9999);
+	EXPECT_EQ(gda.getInt(   0, invalid  , 9999), 9999);
+	EXPECT_FLOAT_EQ(gda.getFloat(9999, columnFloat, 9999.0f), 9999.0f);
+	EXPECT_FLOAT_EQ(gda.getFloat(   0, invalid    , 9999.0f), 9999.0f);
+
+	EXPECT_THROW(gda.getString(0, columnID), Common::Exception);
+	EXPECT_THROW(gda.getInt(0, columnString), Common::Exception);
+	EXPECT_THROW(gda.getFloat(0, columnInt), Common::Exception);
+}
+
+GTEST_TEST(GDAFile, addOverride) {
+	Aurora::GDAFile gda(new Common::MemoryReadStream(kGDAFile));
+
+	gda.add(new Common::MemoryReadStream(kGDAFile));
+
+	EXPECT_EQ(gda.getRowCount(), 2 * kRowCount);
+
+	// The rows of the GDA added last override the ones with the same ID
+	for (size_t i = 0; i < kRowCount; i++) {
+		const size_t index = gda.findRow(kDataID[i]);
+
+		EXPECT_EQ(index, kRowCount + i);
+		EXPECT_STREQ(gda.getString(index, kHeaders[1]).c_str(), kDataString[i]);
+	}
+
+	// But all rows are still accessible by row index
+	for (size_t i = 0; i < 2 * kRowCount; i++)
+		EXPECT_EQ(gda.getInt(i, kHeaders[0]), kDataID[i % kRowCount]);
+}
+
+/** Generate a V0.2 GDA with one column declared as int, but holding strings. */
+static Common::MemoryReadStream *createMismatchedGDA() {
+	static const uint32 kHeaderSize   = 28;
+	static const uint32 kTemplateSize = 16;
+	static const uint32 kFieldSize    = 12;
+
+	static const uint32 kFieldOffset = kHeaderSize  + 3 * kTemplateSize;
+	static const uint32 kDataOffset  = kFieldOffset + 5 * kFieldSize;
+
+	static const char * const kStrings[] = { "Foo", "23" };
+
+	static const uint32 kColumnsOffset = 8;
+	static const uint32 kRowsOffset    = kColumnsOffset + 4 + 8;
+	static const uint32 kStringsOffset = kRowsOffset    + 4 + ARRAYSIZE(kStrings) * 4;
+
+	Common::MemoryWriteStreamDynamic gda(true);
+
+	gda.writeUint32BE(MKTAG('G', 'F', 'F', ' '));
+	gda.writeUint32BE(MKTAG('V', '4', '.', '0'));
+	gda.writeUint32BE(MKTAG('P', 'C', ' ', ' '));
+	gda.writeUint32BE(MKTAG('G', '2', 'D', 'A'));
+	gda.writeUint32BE(MKTAG('V', '0', '.', '2'));
+	gda.writeUint32LE(3);
+	gda.writeUint32LE(kDataOffset);
+
+	// Struct templates: top-level, column, row
+	gda.writeUint32BE(MKTAG('g', 't', 'o', 'p'));
+	gda.writeUint32LE(2);
+	gda.writeUint32LE(kFieldOffset);
+	gda.writeUint32LE(8);
+
+	gda.writeUint32BE(MKTAG('c', 'o', 'l', 'm'));
+	gda.writeUint32LE(2);
+	gda.writeUint32LE(kFieldOffset + 2 * kFieldSize);
+	gda.writeUint32LE(8);
+
+	gda.writeUint32BE(MKTAG('r', 'o', 'w', 's'));
+	gda.writeUint32LE(1);
+	gda.writeUint32LE(kFieldOffset + 4 * kFieldSize);
+	gda.writeUint32LE(4);
+
+	// Fields: column list, row list; column hash, column type; the column's value
+	gda.writeUint32LE(Aurora::kGFF4G2DAColumnList);
+	gda.writeUint32LE(0xC000U << 16 | 1);
+	gda.writeUint32LE(0);
+	gda.writeUint32LE(Aurora::kGFF4G2DARowList);
+	gda.writeUint32LE(0xC000U << 16 | 2);
+	gda.writeUint32LE(4);
+
+	gda.writeUint32LE(Aurora::kGFF4G2DAColumnHash);
+	gda.writeUint32LE(Aurora::GFF4Struct::kFieldTypeUint32);
+	gda.writeUint32LE(0);
+	gda.writeUint32LE(Aurora::kGFF4G2DAColumnType);
+	gda.writeUint32LE(Aurora::GFF4Struct::kFieldTypeUint32);
+	gda.writeUint32LE(4);
+
+	gda.writeUint32LE(Aurora::kGFF4G2DAColumn1);
+	gda.writeUint32LE(Aurora::GFF4Struct::kFieldTypeString);
+	gda.writeUint32LE(0);
+
+	// Data: the top-level struct, the column list, the row list and the strings
+	gda.writeUint32LE(kColumnsOffset);
+	gda.writeUint32LE(kRowsOffset);
+
+	gda.writeUint32LE(1);
+	gda.writeUint32LE(Aurora::hashGDAHeader("Value"));
+	gda.writeUint32LE(Aurora::GDAFile::kTypeInt);
+
+	gda.writeUint32LE(ARRAYSIZE(kStrings));
+
+	uint32 stringOffset = kStringsOffset;
+	for (size_t i = 0; i < ARRAYSIZE(kStrings); i++) {
+		gda.writeUint32LE(stringOffset);
+
+		stringOffset += 4 + strlen(kStrings[i]) * 2;
+	}
+
+	for (size_t i = 0; i < ARRAYSIZE(kStrings); i++) {
+		gda.writeUint32LE(strlen(kStrings[i]));
+		Common::writeString(gda, kStrings[i], Common::kEncodingUTF16LE, false);
+	}
+
+	gda.setDisposable(false);
+	return new Common::MemoryReadStream(gda.getData(), gda.size(), true);
+}
+
+GTEST_TEST(GDAFile, mismatchedCell) {
+	const Aurora::GDAFile gda(createMismatchedGDA());
+
+	ASSERT_EQ(gda.getRowCount(), 2);
+
+	const Aurora::GDAFile::ColumnHandle column = gda.getColumn("Value");
+	ASSERT_TRUE(column.isValid());
+
+	// Cells not matching their column's type are still read out of the GFF4
+	EXPECT_STREQ(gda.getString(0, column).c_str(), "Foo");
+	EXPECT_STREQ(gda.getString(1, "Value").c_str(), "23");
+
+	EXPECT_THROW(gda.getInt(0, column), Common::Exception);
+	EXPECT_THROW(gda.getFloat(1, column), Common::Exception);
+}
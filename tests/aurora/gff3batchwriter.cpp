@@ -0,0 +1,147 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our parallel GFF3 batch writer.
+ */
+
+#include <boost/make_shared.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/scopedptr.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/aurora/gff3batchwriter.h"
+#include "src/aurora/gff3writer.h"
+#include "src/aurora/gff3file.h"
+#include "src/aurora/erfwriter.h"
+#include "src/aurora/erffile.h"
+#include "src/aurora/thewitchersavewriter.h"
+#include "src/aurora/thewitchersavefile.h"
+
+static const size_t kGFF3Count = 100;
+
+static boost::shared_ptr<Aurora::GFF3Writer> createGFF3(size_t i) {
+	boost::shared_ptr<Aurora::GFF3Writer> gff =
+		boost::make_shared<Aurora::GFF3Writer>(MKTAG('U', 'T', 'C', ' '), MKTAG('V', '3', '.', '2'));
+
+	gff->getTopLevel()->addUint32("Index", i);
+	gff->getTopLevel()->addExoString("Tag", Common::UString::format("creature%u", (uint)i));
+
+	Aurora::GFF3WriterListPtr list = gff->getTopLevel()->addList("Items");
+	for (size_t j = 0; j < (i % 8); j++)
+		list->addStruct("")->addSint32("Value", (int32)(i * j));
+
+	return gff;
+}
+
+static void fillBatch(Aurora::GFF3BatchWriter &batch) {
+	for (size_t i = 0; i < kGFF3Count; i++)
+		batch.add(Common::UString::format("creature%u", (uint)i), Aurora::kFileTypeUTC, createGFF3(i));
+}
+
+static void checkGFF3(Common::SeekableReadStream *stream, size_t i) {
+	ASSERT_NE(stream, static_cast<Common::SeekableReadStream *>(0));
+
+	const Aurora::GFF3File gff(stream, MKTAG('U', 'T', 'C', ' '));
+	const Aurora::GFF3Struct &top = gff.getTopLevel();
+
+	EXPECT_EQ(top.getUint("Index"), i);
+	EXPECT_STREQ(top.getString("Tag").c_str(), Common::UString::format("creature%u", (uint)i).c_str());
+	EXPECT_EQ(top.getList("Items").size(), i % 8);
+}
+
+GTEST_TEST(GFF3BatchWriter, writeOrder) {
+	Aurora::GFF3BatchWriter batch(4);
+	fillBatch(batch);
+
+	EXPECT_EQ(batch.size(), kGFF3Count);
+
+	size_t count = 0;
+	const Aurora::GFF3BatchWriter::Statistics stats =
+		batch.write([&count](const Common::UString &resRef, Aurora::FileType type,
+		                     Common::SeekableReadStream &data) {
+
+		EXPECT_STREQ(resRef.c_str(), Common::UString::format("creature%u", (uint)count).c_str());
+		EXPECT_EQ(type, Aurora::kFileTypeUTC);
+
+		checkGFF3(data.readStream(data.size()), count);
+		count++;
+	});
+
+	EXPECT_EQ(count, kGFF3Count);
+	EXPECT_EQ(batch.size(), 0);
+
+	EXPECT_EQ(stats.count, kGFF3Count);
+	EXPECT_GT(stats.size, 0);
+	EXPECT_GT(stats.peakSerializedSize, 0);
+	EXPECT_LT(stats.peakSerializedSize, stats.size);
+}
+
+GTEST_TEST(GFF3BatchWriter, writeERF) {
+	Aurora::GFF3BatchWriter batch;
+	fillBatch(batch);
+
+	Common::MemoryWriteStreamDynamic writeStream(true);
+	Aurora::ERFWriter erfWriter(MKTAG('S', 'A', 'V', ' '), kGFF3Count, writeStream,
+	                            Aurora::ERFWriter::kERFVersion22, Aurora::LocString(),
+	                            Aurora::ERFWriter::kCompressionHeaderlessZlib);
+
+	const Aurora::GFF3BatchWriter::Statistics stats = batch.write(erfWriter);
+
+	EXPECT_EQ(stats.count, kGFF3Count);
+	EXPECT_LE(stats.peakSerializedSize, stats.size);
+
+	const Aurora::ERFFile erf(new Common::MemoryReadStream(writeStream.getData(), writeStream.size()));
+	ASSERT_EQ(erf.getResources().size(), kGFF3Count);
+
+	for (size_t i = 0; i < kGFF3Count; i++) {
+		const uint32 index = erf.findResource(Common::UString::format("creature%u", (uint)i), Aurora::kFileTypeUTC);
+		ASSERT_EQ(index, i);
+
+		checkGFF3(erf.getResource(index), i);
+	}
+}
+
+GTEST_TEST(GFF3BatchWriter, writeTheWitcherSave) {
+	Aurora::GFF3BatchWriter batch(2);
+	fillBatch(batch);
+
+	Common::MemoryWriteStreamDynamic writeStream(true);
+	Aurora::TheWitcherSaveWriter saveWriter("Test Area", writeStream);
+
+	const Aurora::GFF3BatchWriter::Statistics stats = batch.write(saveWriter);
+	saveWriter.finish();
+
+	EXPECT_EQ(stats.count, kGFF3Count);
+
+	const Aurora::TheWitcherSaveFile save(new Common::MemoryReadStream(writeStream.getData(), writeStream.size()));
+	ASSERT_EQ(save.getResources().size(), kGFF3Count);
+
+	for (size_t i = 0; i < kGFF3Count; i++) {
+		const uint32 index = save.findResource(Common::UString::format("creature%u", (uint)i), Aurora::kFileTypeUTC);
+		ASSERT_EQ(index, i);
+
+		checkGFF3(save.getResource(index), i);
+	}
+}
@@ -348,3 +348,93 @@ GTEST_TEST(GFF3Writer, WriteEquivalentValues) {
 
 	delete writeStream;
 }
+
+GTEST_TEST(GFF3Writer, WriteRawValues) {
+	static const byte vData[8] = { '!', '[', 'D', 'A', 'T', 'A', ']', '!' };
+
+	Aurora::GFF3Writer writer(MKTAG('G', 'F', 'F', ' '));
+	writer.getTopLevel()->addExoString("FieldExoString", new Common::MemoryReadStream(vData));
+	writer.getTopLevel()->addResRef("FieldResRef", new Common::MemoryReadStream(vData));
+	writer.getTopLevel()->addExoString("FieldExoString2", "![DATA]!");
+
+	Common::MemoryWriteStreamDynamic writeStream(true);
+	writer.write(writeStream);
+
+	Aurora::GFF3File gff(new Common::MemoryReadStream(writeStream.getData(), writeStream.size()));
+
+	EXPECT_STREQ(gff.getTopLevel().getString("FieldExoString").c_str(), "![DATA]!");
+	EXPECT_STREQ(gff.getTopLevel().getString("FieldResRef").c_str(), "![DATA]!");
+	EXPECT_STREQ(gff.getTopLevel().getString("FieldExoString2").c_str(), "![DATA]!");
+}
+
+GTEST_TEST(GFF3Writer, WriteTwice) {
+	Aurora::GFF3Writer writer(MKTAG('G', 'F', 'F', ' '));
+	writer.getTopLevel()->addExoString("FieldExoString", "NiceString");
+	writer.getTopLevel()->addUint64("FieldUint64", 5000000000);
+
+	Common::MemoryWriteStreamDynamic writeStream1(true);
+	writer.write(writeStream1);
+	Common::MemoryWriteStreamDynamic writeStream2(true);
+	writer.write(writeStream2);
+
+	ASSERT_EQ(writeStream1.size(), writeStream2.size());
+	for (size_t i = 0; i < writeStream1.size(); i++)
+		EXPECT_EQ(writeStream1.getData()[i], writeStream2.getData()[i]) << "At index " << i;
+}
+
+GTEST_TEST(GFF3Writer, RoundTripLarge) {
+	static const size_t kStructCount = 20000;
+
+	Aurora::GFF3Writer writer(MKTAG('G', 'F', 'F', ' '));
+	Aurora::GFF3WriterListPtr list = writer.getTopLevel()->addList("List");
+
+	for (size_t i = 0; i < kStructCount; i++) {
+		Aurora::GFF3WriterStructPtr strct = list->addStruct("", i);
+
+		strct->addUint32("Index", i);
+		strct->addSint64("Sint64", -(int64)i * 1000000000);
+		strct->addDouble("Double", i * 0.5);
+		strct->addExoString("Tag", Common::UString::format("tag%u", (uint)(i % 100)));
+		strct->addResRef("ResRef", Common::UString::format("resref%u", (uint)i));
+		strct->addVector("Position", glm::vec3(i, 2.0f * i, 0.0f));
+		strct->addOrientation("Orientation", glm::vec4(0.0f, 0.0f, (i % 4) * 0.5f, 1.0f));
+
+		Aurora::GFF3WriterListPtr items = strct->addList("Items");
+		for (size_t j = 0; j < (i % 3); j++)
+			items->addStruct("")->addSint32("Value", i * j);
+	}
+
+	Common::MemoryWriteStreamDynamic writeStream(true);
+	writer.write(writeStream);
+
+	Aurora::GFF3File gff(new Common::MemoryReadStream(writeStream.getData(), writeStream.size()));
+
+	const Aurora::GFF3List &readList = gff.getTopLevel().getList("List");
+	ASSERT_EQ(readList.size(), kStructCount);
+
+	for (size_t i = 0; i < kStructCount; i++) {
+		const Aurora::GFF3Struct &strct = *readList[i];
+
+		ASSERT_EQ(strct.getID(), i);
+
+		EXPECT_EQ(strct.getUint("Index"), i);
+		EXPECT_EQ(strct.getSint("Sint64"), -(int64)i * 1000000000);
+		EXPECT_EQ(strct.getDouble("Double"), i * 0.5);
+		EXPECT_STREQ(strct.getString("Tag").c_str(), Common::UString::format("tag%u", (uint)(i % 100)).c_str());
+		EXPECT_STREQ(strct.getString("ResRef").c_str(), Common::UString::format("resref%u", (uint)i).c_str());
+
+		float x, y, z, w;
+		strct.getVector("Position", x, y, z);
+		EXPECT_EQ(x, (float)i);
+		EXPECT_EQ(y, 2.0f * i);
+
+		strct.getOrientation("Orientation", x, y, z, w);
+		EXPECT_EQ(z, (i % 4) * 0.5f);
+		EXPECT_EQ(w, 1.0f);
+
+		const Aurora::GFF3List &items = strct.getList("Items");
+		ASSERT_EQ(items.size(), i % 3);
+		for (size_t j = 0; j < items.size(); j++)
+			EXPECT_EQ(items[j]->getSint("Value"), (int64)(i * j));
+	}
+}
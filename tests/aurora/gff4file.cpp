@@ -41,6 +41,7 @@
 #include "src/common/error.h"
 #include "src/common/encoding.h"
 #include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
 
 #include "src/aurora/gff4file.h"
 
@@ -2907,8 +2908,8 @@ static const byte kGFF4Structs[] = {
 	0x17,0x18,0x19,0x1A,0x1B,0x1C,0x1D
 };
 
-GTEST_TEST(GFF4StructStructs, getStruct) {
-	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4Structs));
+static void testStructsGetStruct(bool lazy) {
+	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4Structs), 0xFFFFFFFF, lazy);
 	const Aurora::GFF4Struct &strct0 = gff4.getTopLevel();
 
 	EXPECT_EQ(strct0.getLabel(), MKTAG('S', 'C', 'T', '1'));
@@ -2949,6 +2950,14 @@ GTEST_TEST(GFF4StructStructs, getStruct) {
 	EXPECT_THROW(strct0.getStruct(256), Common::Exception);
 }
 
+GTEST_TEST(GFF4StructStructs, getStruct) {
+	testStructsGetStruct(false);
+}
+
+GTEST_TEST(GFF4StructStructs, getStructLazy) {
+	testStructsGetStruct(true);
+}
+
 // --- GFF4, lists ---
 
 static const byte kGFF4Lists[] = {
@@ -2966,8 +2975,8 @@ static const byte kGFF4Lists[] = {
 	0x1F,0x20
 };
 
-GTEST_TEST(GFF4StructLists, getList) {
-	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4Lists));
+static void testListsGetList(bool lazy) {
+	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4Lists), 0xFFFFFFFF, lazy);
 	const Aurora::GFF4Struct &strct0 = gff4.getTopLevel();
 
 	EXPECT_EQ(strct0.getLabel(), MKTAG('S', 'C', 'T', '1'));
@@ -3020,6 +3029,14 @@ GTEST_TEST(GFF4StructLists, getList) {
 	EXPECT_THROW(strct0.getStruct(257), Common::Exception);
 }
 
+GTEST_TEST(GFF4StructLists, getList) {
+	testListsGetList(false);
+}
+
+GTEST_TEST(GFF4StructLists, getListLazy) {
+	testListsGetList(true);
+}
+
 // --- GFF4, structs, with references ---
 
 static const byte kGFF4StructsRef[] = {
@@ -3037,8 +3054,8 @@ static const byte kGFF4StructsRef[] = {
 	0x1B
 };
 
-GTEST_TEST(GFF4StructStructsRef, getStruct) {
-	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4StructsRef));
+static void testStructsRefGetStruct(bool lazy) {
+	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4StructsRef), 0xFFFFFFFF, lazy);
 	const Aurora::GFF4Struct &strct0 = gff4.getTopLevel();
 
 	EXPECT_EQ(strct0.getLabel(), MKTAG('S', 'C', 'T', '1'));
@@ -3082,6 +3099,14 @@ GTEST_TEST(GFF4StructStructsRef, getStruct) {
 	EXPECT_EQ(strct4->getRefCount(), 3);
 }
 
+GTEST_TEST(GFF4StructStructsRef, getStruct) {
+	testStructsRefGetStruct(false);
+}
+
+GTEST_TEST(GFF4StructStructsRef, getStructLazy) {
+	testStructsRefGetStruct(true);
+}
+
 // --- GFF4, lists, with references ---
 
 static const byte kGFF4ListsRef[] = {
@@ -3100,8 +3125,8 @@ static const byte kGFF4ListsRef[] = {
 	0x3C,0x00,0x00,0x00,0x1B
 };
 
-GTEST_TEST(GFF4StructListsRef, getList) {
-	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4ListsRef));
+static void testListsRefGetList(bool lazy) {
+	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4ListsRef), 0xFFFFFFFF, lazy);
 	const Aurora::GFF4Struct &strct0 = gff4.getTopLevel();
 
 	EXPECT_EQ(strct0.getLabel(), MKTAG('S', 'C', 'T', '1'));
@@ -3159,6 +3184,14 @@ GTEST_TEST(GFF4StructListsRef, getList) {
 	EXPECT_EQ(list1[0]->getRefCount(), 6);
 }
 
+GTEST_TEST(GFF4StructListsRef, getList) {
+	testListsRefGetList(false);
+}
+
+GTEST_TEST(GFF4StructListsRef, getListLazy) {
+	testListsRefGetList(true);
+}
+
 // --- GFF4, generics ---
 
 static const byte kGFF4Generic[] = {
@@ -3174,8 +3207,8 @@ static const byte kGFF4Generic[] = {
 	0x00,0x00,0x2C,0x00,0x00,0x00,0x19,0x1A,0x1B
 };
 
-GTEST_TEST(GFF4StructGeneric, getGeneric) {
-	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4Generic));
+static void testGenericGetGeneric(bool lazy) {
+	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4Generic), 0xFFFFFFFF, lazy);
 	const Aurora::GFF4Struct &strct0 = gff4.getTopLevel();
 
 	EXPECT_EQ(strct0.getLabel(), MKTAG('S', 'C', 'T', '1'));
@@ -3200,6 +3233,14 @@ GTEST_TEST(GFF4StructGeneric, getGeneric) {
 	EXPECT_THROW(generic1->getGeneric(0), Common::Exception);
 }
 
+GTEST_TEST(GFF4StructGeneric, getGeneric) {
+	testGenericGetGeneric(false);
+}
+
+GTEST_TEST(GFF4StructGeneric, getGenericLazy) {
+	testGenericGetGeneric(true);
+}
+
 // --- GFF4, shared strings ---
 
 static const byte kGFF4Shared[] = {
@@ -3211,8 +3252,8 @@ static const byte kGFF4Shared[] = {
 	0x17,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x46,0x6F,0x6F,0x62,0x61,0x72,0x00
 };
 
-GTEST_TEST(GFF4StructShared, getString) {
-	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4Shared));
+static void testSharedGetString(bool lazy) {
+	Aurora::GFF4File gff4(new Common::MemoryReadStream(kGFF4Shared), 0xFFFFFFFF, lazy);
 	const Aurora::GFF4Struct &strct0 = gff4.getTopLevel();
 
 	EXPECT_STREQ(strct0.getString(256).c_str(), "Foobar");
@@ -3224,3 +3265,160 @@ GTEST_TEST(GFF4StructShared, getString) {
 	EXPECT_EQ(strRef, 23);
 	EXPECT_STREQ(tlkString.c_str(), "Foobar");
 }
+
+GTEST_TEST(GFF4StructShared, getString) {
+	testSharedGetString(false);
+}
+
+GTEST_TEST(GFF4StructShared, getStringLazy) {
+	testSharedGetString(true);
+}
+
+// --- GFF4, large generated file ---
+
+static const size_t kLargeRowCount    = 20000;
+static const size_t kLargeStringCount = 1000;
+
+/** Generate a V4.1 GFF4 with a list of rows, each with a value, a shared string
+ *  and a reference to a child struct. */
+static void generateLargeGFF4(Common::MemoryWriteStreamDynamic &gff4) {
+	static const uint32 kHeaderSize   = 36;
+	static const uint32 kTemplateSize = 16;
+	static const uint32 kFieldSize    = 12;
+
+	const uint32 fieldOffset = kHeaderSize + 3 * kTemplateSize;
+	const uint32 dataOffset  = fieldOffset + 5 * kFieldSize;
+
+	const uint32 rowsOffset     = 8;
+	const uint32 childrenOffset = rowsOffset + 4 + kLargeRowCount * 12;
+	const uint32 stringOffset   = dataOffset + childrenOffset + kLargeRowCount * 4;
+
+	gff4.writeUint32BE(MKTAG('G', 'F', 'F', ' '));
+	gff4.writeUint32BE(MKTAG('V', '4', '.', '1'));
+	gff4.writeUint32BE(MKTAG('P', 'C', ' ', ' '));
+	gff4.writeUint32BE(MKTAG('T', 'E', 'S', 'T'));
+	gff4.writeUint32BE(MKTAG('V', '1', '.', '0'));
+	gff4.writeUint32LE(3);
+	gff4.writeUint32LE(kLargeStringCount);
+	gff4.writeUint32LE(stringOffset);
+	gff4.writeUint32LE(dataOffset);
+
+	// Struct templates: top-level, row, child
+	gff4.writeUint32BE(MKTAG('T', 'O', 'P', 'L'));
+	gff4.writeUint32LE(1);
+	gff4.writeUint32LE(fieldOffset);
+	gff4.writeUint32LE(4);
+
+	gff4.writeUint32BE(MKTAG('R', 'O', 'W', ' '));
+	gff4.writeUint32LE(3);
+	gff4.writeUint32LE(fieldOffset + 1 * kFieldSize);
+	gff4.writeUint32LE(12);
+
+	gff4.writeUint32BE(MKTAG('C', 'H', 'L', 'D'));
+	gff4.writeUint32LE(1);
+	gff4.writeUint32LE(fieldOffset + 4 * kFieldSize);
+	gff4.writeUint32LE(4);
+
+	// Fields: list of rows; value, string, child reference; child value
+	gff4.writeUint32LE(1);
+	gff4.writeUint32LE(0xC0000001);
+	gff4.writeUint32LE(0);
+
+	gff4.writeUint32LE(10);
+	gff4.writeUint32LE(Aurora::GFF4Struct::kFieldTypeUint32);
+	gff4.writeUint32LE(0);
+	gff4.writeUint32LE(11);
+	gff4.writeUint32LE(Aurora::GFF4Struct::kFieldTypeString);
+	gff4.writeUint32LE(4);
+	gff4.writeUint32LE(12);
+	gff4.writeUint32LE(0x60000002);
+	gff4.writeUint32LE(8);
+
+	gff4.writeUint32LE(20);
+	gff4.writeUint32LE(Aurora::GFF4Struct::kFieldTypeUint32);
+	gff4.writeUint32LE(0);
+
+	// Data
+	gff4.writeUint32LE(rowsOffset);
+	gff4.writeUint32LE(0);
+
+	gff4.writeUint32LE(kLargeRowCount);
+	for (size_t i = 0; i < kLargeRowCount; i++) {
+		gff4.writeUint32LE(i);
+		gff4.writeUint32LE(i % kLargeStringCount);
+		gff4.writeUint32LE(childrenOffset + i * 4);
+	}
+
+	for (size_t i = 0; i < kLargeRowCount; i++)
+		gff4.writeUint32LE(i * 2);
+
+	for (size_t i = 0; i < kLargeStringCount; i++) {
+		gff4.writeString(Common::UString::format("String%u", (uint)i));
+		gff4.writeByte(0);
+	}
+}
+
+static void checkLargeRow(const Aurora::GFF4Struct *row, size_t i) {
+	ASSERT_NE(row, static_cast<const Aurora::GFF4Struct *>(0));
+
+	EXPECT_EQ(row->getLabel(), MKTAG('R', 'O', 'W', ' '));
+	EXPECT_EQ(row->getUint(10), i);
+	EXPECT_STREQ(row->getString(11).c_str(), Common::UString::format("String%u", (uint)(i % kLargeStringCount)).c_str());
+
+	const Aurora::GFF4Struct *child = row->getStruct(12);
+	ASSERT_NE(child, static_cast<const Aurora::GFF4Struct *>(0));
+
+	EXPECT_EQ(child->getLabel(), MKTAG('C', 'H', 'L', 'D'));
+	EXPECT_EQ(child->getUint(20), i * 2);
+	EXPECT_EQ(child->getRefCount(), 1);
+}
+
+static void loadLargeGFF4(Common::MemoryWriteStreamDynamic &data, bool lazy, bool traverse) {
+	Aurora::GFF4File gff4(new Common::MemoryReadStream(data.getData(), data.size()), MKTAG('T', 'E', 'S', 'T'), lazy);
+	EXPECT_EQ(gff4.isLazy(), lazy);
+
+	const Aurora::GFF4List &rows = gff4.getTopLevel().getList(1);
+	EXPECT_EQ(rows.size(), kLargeRowCount);
+
+	if (traverse) {
+		for (size_t i = 0; i < rows.size(); i++)
+			checkLargeRow(rows[i], i);
+	} else if (!rows.empty())
+		checkLargeRow(rows.back(), rows.size() - 1);
+}
+
+GTEST_TEST(GFF4StructLarge, load) {
+	Common::MemoryWriteStreamDynamic data(true);
+	generateLargeGFF4(data);
+
+	loadLargeGFF4(data, false, true);
+}
+
+GTEST_TEST(GFF4StructLarge, loadLazy) {
+	Common::MemoryWriteStreamDynamic data(true);
+	generateLargeGFF4(data);
+
+	loadLargeGFF4(data, true, true);
+	loadLargeGFF4(data, true, false);
+}
+
+GTEST_TEST(GFF4StructLarge, lazyRefCount) {
+	Common::MemoryWriteStreamDynamic data(true);
+	generateLargeGFF4(data);
+
+	Aurora::GFF4File gff4(new Common::MemoryReadStream(data.getData(), data.size()), 0xFFFFFFFF, true);
+
+	const Aurora::GFF4List &rows = gff4.getTopLevel().getList(1);
+	ASSERT_EQ(rows.size(), kLargeRowCount);
+
+	// Only the rows have been loaded, not yet their children
+	EXPECT_EQ(rows[0]->getRefCount(), 1);
+
+	const Aurora::GFF4Struct *child = rows[0]->getStruct(12);
+	ASSERT_NE(child, static_cast<const Aurora::GFF4Struct *>(0));
+	EXPECT_EQ(child->getRefCount(), 1);
+
+	// Following the same reference again must not load the child again
+	EXPECT_EQ(rows[0]->getStruct(12), child);
+	EXPECT_EQ(child->getRefCount(), 1);
+}
@@ -24,6 +24,7 @@
 
 #include "gtest/gtest.h"
 
+#include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/memreadstream.h"
 
@@ -4881,3 +4882,34 @@ GTEST_TEST(NDSFile, getResource) {
 
 	delete file;
 }
+
+GTEST_TEST(NDSFile, getResourceNoCopy) {
+	Common::MemoryReadStream *stream = new Common::MemoryReadStream(kNDSFile);
+	const Aurora::NDSFile nds(stream);
+
+	Common::SeekableReadStream *file = nds.getResource(0, true);
+	ASSERT_NE(file, static_cast<Common::SeekableReadStream *>(0));
+
+	ASSERT_EQ(file->size(), strlen(kFileData));
+
+	// The ROM is in memory, so we should get a view directly into the ROM data
+	const byte *data = file->readInPlace(file->size());
+	ASSERT_NE(data, static_cast<const byte *>(0));
+
+	EXPECT_GE(data, kNDSFile);
+	EXPECT_LE(data + strlen(kFileData), kNDSFile + sizeof(kNDSFile));
+
+	for (size_t i = 0; i < strlen(kFileData); i++)
+		EXPECT_EQ(data[i], kFileData[i]) << "At index " << i;
+
+	delete file;
+}
+
+GTEST_TEST(NDSFile, truncatedNames) {
+	// Cut the ROM off in the middle of the 8 bytes before the file name table's names
+	const uint32 namesOffset = READ_LE_UINT32(kNDSFile + 0x40);
+
+	Common::MemoryReadStream *stream = new Common::MemoryReadStream(kNDSFile, namesOffset + 4);
+
+	EXPECT_THROW(Aurora::NDSFile nds(stream), Common::Exception);
+}
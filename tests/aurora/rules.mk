@@ -175,6 +175,11 @@ tests_aurora_test_gff3writer_SOURCES  = tests/aurora/gff3writer.cpp
 tests_aurora_test_gff3writer_LDADD    = $(aurora_LIBS)
 tests_aurora_test_gff3writer_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                           += tests/aurora/test_gff3batchwriter
+tests_aurora_test_gff3batchwriter_SOURCES  = tests/aurora/gff3batchwriter.cpp
+tests_aurora_test_gff3batchwriter_LDADD    = $(aurora_LIBS)
+tests_aurora_test_gff3batchwriter_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                               += tests/aurora/test_thewitchersavefile
 tests_aurora_test_thewitchersavefile_SOURCES  = tests/aurora/thewitchersavefile.cpp
 tests_aurora_test_thewitchersavefile_LDADD    = $(aurora_LIBS)
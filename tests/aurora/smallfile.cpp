@@ -22,8 +22,13 @@
  *  Unit tests for our Nintendo DS compression.
  */
 
+#include <vector>
+
 #include "gtest/gtest.h"
 
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
 #include "src/common/memreadstream.h"
 #include "src/common/memwritestream.h"
 
@@ -262,3 +267,163 @@ GTEST_TEST(Small0x10, compressRoundTrip) {
 	ASSERT_EQ(uncompressedWrite.size(), strlen(kDataUncompressed));
 	compareData(uncompressedWrite.getData(), kDataUncompressed);
 }
+
+/** Create test data: words out of a small dictionary, with runs of repeating bytes and patterns. */
+static std::vector<byte> createTestData(size_t size) {
+	static const char * const kWords[] = {
+		"ozymandias ", "king ", "of ", "kings ", "look ", "on ", "my ", "works ", "ye ", "mighty ", "and ", "despair "
+	};
+
+	std::vector<byte> data;
+	data.reserve(size);
+
+	uint32 random = 12345;
+	while (data.size() < size) {
+		random = random * 1103515245 + 12345;
+
+		const uint32 choice = (random >> 16) % 16;
+		if (choice < ARRAYSIZE(kWords)) {
+			for (const char *w = kWords[choice]; *w && (data.size() < size); w++)
+				data.push_back(*w);
+
+		} else if (choice == 12) {
+			// Run of a single byte
+			for (size_t i = 0; (i < ((random >> 8) & 0x3F)) && (data.size() < size); i++)
+				data.push_back(random >> 24);
+
+		} else if (choice == 13) {
+			// Run of a short pattern
+			for (size_t i = 0; (i < ((random >> 8) & 0x3F)) && (data.size() < size); i++)
+				data.push_back("abc"[i % 3]);
+
+		} else
+			data.push_back(random >> 24);
+	}
+
+	return data;
+}
+
+/** The original exhaustive LZSS 0x10 compressor, for comparison. */
+static std::vector<byte> compress10Reference(const std::vector<byte> &in) {
+	std::vector<byte> out;
+
+	const uint32 header = (in.size() << 8) | 0x10;
+	for (int i = 0; i < 4; i++)
+		out.push_back(header >> (i * 8));
+
+	size_t flagsPos = 0, blocks = 8;
+	for (size_t pos = 0; pos < in.size(); blocks++) {
+		if (blocks == 8) {
+			flagsPos = out.size();
+			out.push_back(0);
+			blocks = 0;
+		}
+
+		const size_t newLength = MIN<size_t>(in.size() - pos, 0x12);
+		const size_t oldLength = MIN<size_t>(pos, 0x1000);
+
+		size_t maxLength = 0, displacement = 0;
+		for (size_t i = 0; (oldLength >= 1) && (i < oldLength - 1); i++) {
+			size_t length = 0;
+			while ((length < newLength) && (in[pos - oldLength + i + length] == in[pos + length]))
+				length++;
+
+			if (length > maxLength) {
+				maxLength    = length;
+				displacement = oldLength - i;
+
+				if (maxLength == newLength)
+					break;
+			}
+		}
+
+		if (maxLength >= 3) {
+			out[flagsPos] |= 1 << (7 - blocks);
+
+			out.push_back((((maxLength - 3) << 4) & 0xF0) | (((displacement - 1) >> 8) & 0x0F));
+			out.push_back((displacement - 1) & 0xFF);
+
+			pos += maxLength;
+		} else
+			out.push_back(in[pos++]);
+	}
+
+	return out;
+}
+
+GTEST_TEST(Small0x10, compressReference) {
+	const std::vector<byte> data = createTestData(20000);
+
+	Common::MemoryWriteStreamDynamic compressed(true);
+	Common::MemoryReadStream uncompressed(data.data(), data.size());
+
+	Aurora::Small::compress10(uncompressed, compressed);
+
+	const std::vector<byte> reference = compress10Reference(data);
+
+	ASSERT_EQ(compressed.size(), reference.size());
+	compareData(compressed.getData(), reference.data(), reference.size());
+}
+
+GTEST_TEST(Small0x10, compressRoundTripLarge) {
+	const std::vector<byte> data = createTestData(200000);
+
+	Common::MemoryWriteStreamDynamic compressed(true);
+	Common::MemoryReadStream uncompressed(data.data(), data.size());
+
+	Aurora::Small::compress10(uncompressed, compressed);
+	ASSERT_LT(compressed.size(), data.size());
+
+	{
+		Common::MemoryWriteStreamDynamic decompressed(true);
+		Common::MemoryReadStream compressedRead(compressed.getData(), compressed.size());
+
+		Aurora::Small::decompress(compressedRead, decompressed);
+
+		ASSERT_EQ(decompressed.size(), data.size());
+		compareData(decompressed.getData(), data.data(), data.size());
+	}
+
+	{
+		Common::MemoryReadStream compressedRead(compressed.getData(), compressed.size());
+
+		Common::ScopedPtr<Common::SeekableReadStream> decompressed(Aurora::Small::decompress(compressedRead));
+
+		ASSERT_EQ(decompressed->size(), data.size());
+
+		std::vector<byte> decompressedData(data.size());
+		decompressed->read(decompressedData.data(), decompressedData.size());
+
+		compareData(decompressedData.data(), data.data(), data.size());
+	}
+
+	{
+		Common::ScopedPtr<Common::SeekableReadStream> decompressed(Aurora::Small::decompress(
+			static_cast<Common::SeekableReadStream *>(new Common::MemoryReadStream(compressed.getData(), compressed.size()))));
+
+		ASSERT_EQ(decompressed->size(), data.size());
+
+		std::vector<byte> decompressedData(data.size());
+		decompressed->read(decompressedData.data(), decompressedData.size());
+
+		compareData(decompressedData.data(), data.data(), data.size());
+	}
+}
+
+GTEST_TEST(Small0x10, decompressInvalid) {
+	// A block copying from before the start of the data
+	static const byte kBeforeStart[] = { 0x10, 0x04, 0x00, 0x00, 0x40, 0x41, 0x00, 0x01 };
+	// A block copying more than the size of the data
+	static const byte kTooLong[] = { 0x10, 0x04, 0x00, 0x00, 0x40, 0x41, 0x10, 0x00 };
+	// Ending prematurely
+	static const byte kTruncated[] = { 0x10, 0x04, 0x00, 0x00, 0x00, 0x41, 0x42 };
+
+	Common::MemoryReadStream beforeStart(kBeforeStart);
+	EXPECT_THROW(Aurora::Small::decompress(beforeStart), Common::Exception);
+
+	Common::MemoryReadStream tooLong(kTooLong);
+	EXPECT_THROW(Aurora::Small::decompress(tooLong), Common::Exception);
+
+	EXPECT_THROW(Aurora::Small::decompress(
+		static_cast<Common::SeekableReadStream *>(new Common::MemoryReadStream(kTruncated))), Common::Exception);
+}
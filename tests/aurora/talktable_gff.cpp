@@ -22,10 +22,13 @@
  *  Unit tests for our TalkTable_GFF class.
  */
 
+#include <atomic>
+
 #include "gtest/gtest.h"
 
 #include "src/common/util.h"
 #include "src/common/encoding.h"
+#include "src/common/threads.h"
 #include "src/common/memreadstream.h"
 
 #include "src/aurora/types.h"
@@ -175,6 +178,24 @@ GTEST_TEST(TalkTable_TLK05, getSoundID) {
 	EXPECT_EQ(tlk.getSoundID(5), Aurora::kFieldIDInvalid);
 }
 
+GTEST_TEST(TalkTable_TLK05, threads) {
+	static const char * const kStrings[] = { "Foobar", "", "", "", "Barfoo", "" };
+
+	const Aurora::TalkTable_GFF tlk(new Common::MemoryReadStream(kTLKV05), Common::kEncodingUTF16LE);
+
+	std::atomic<uint32> mismatches(0);
+
+	// Several threads looking up and caching strings out of the same talk table at once
+	Common::parallelFor(1000, [&tlk, &mismatches](size_t i) {
+		const uint32 strRef = (uint32) (i % ARRAYSIZE(kStrings));
+
+		if (tlk.getString(strRef) != kStrings[strRef])
+			mismatches++;
+	}, 4);
+
+	EXPECT_EQ(mismatches, 0);
+}
+
 GTEST_TEST(TalkTable_TLK05, fromGeneric) {
 	Common::MemoryReadStream *stream = new Common::MemoryReadStream(kTLKV05);
 
@@ -22,11 +22,15 @@
  *  Unit tests for our TalkTable_TLK class.
  */
 
+#include <atomic>
+
 #include "gtest/gtest.h"
 
 #include "src/common/util.h"
 #include "src/common/encoding.h"
+#include "src/common/threads.h"
 #include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
 
 #include "src/aurora/types.h"
 #include "src/aurora/talktable.h"
@@ -194,3 +198,85 @@ GTEST_TEST(TalkTable_TLK40, fromGeneric) {
 
 	delete tlk;
 }
+
+// --- Large TLK V3.0 ---
+
+/** Number of entries in our generated large TLK, about the size of NWN2's dialog.tlk. */
+static const uint32 kLargeTLKCount = 150000;
+
+static Common::UString getLargeString(uint32 strRef) {
+	return Common::UString::format("String number %u, with some more text", strRef);
+}
+
+static Common::UString getLargeSoundResRef(uint32 strRef) {
+	return ((strRef % 2) == 0) ? Common::UString::format("snd_%u", strRef) : "";
+}
+
+/** Generate a large V3.0 TLK with kLargeTLKCount entries. */
+static Common::MemoryReadStream *createLargeTLK() {
+	Common::MemoryWriteStreamDynamic tlk(false);
+
+	const uint32 stringsOffset = 20 + kLargeTLKCount * 40;
+
+	tlk.writeUint32BE(MKTAG('T', 'L', 'K', ' '));
+	tlk.writeUint32BE(MKTAG('V', '3', '.', '0'));
+	tlk.writeUint32LE(0);
+	tlk.writeUint32LE(kLargeTLKCount);
+	tlk.writeUint32LE(stringsOffset);
+
+	uint32 offset = 0;
+	for (uint32 i = 0; i < kLargeTLKCount; i++) {
+		const Common::UString text = getLargeString(i);
+		const Common::UString sound = getLargeSoundResRef(i);
+
+		tlk.writeUint32LE(sound.empty() ? 0x01 : 0x03);
+		Common::writeStringFixed(tlk, sound, Common::kEncodingASCII, 16);
+		tlk.writeUint32LE(0);
+		tlk.writeUint32LE(0);
+		tlk.writeUint32LE(offset);
+		tlk.writeUint32LE(text.size());
+		tlk.writeIEEEFloatLE(0.0f);
+
+		offset += text.size();
+	}
+
+	for (uint32 i = 0; i < kLargeTLKCount; i++)
+		Common::writeString(tlk, getLargeString(i), Common::kEncodingASCII, false);
+
+	const size_t size = tlk.size();
+	tlk.setDisposable(false);
+
+	return new Common::MemoryReadStream(tlk.getData(), size, true);
+}
+
+GTEST_TEST(TalkTable_TLK30Large, load) {
+	Aurora::TalkTable_TLK tlk(createLargeTLK(), Common::kEncodingUTF8);
+
+	for (uint32 i = 0; i < kLargeTLKCount; i++) {
+		ASSERT_STREQ(tlk.getString(i).c_str(), getLargeString(i).c_str()) << "At string " << i;
+		ASSERT_STREQ(tlk.getSoundResRef(i).c_str(), getLargeSoundResRef(i).c_str()) << "At string " << i;
+	}
+
+	EXPECT_FALSE(tlk.hasEntry(kLargeTLKCount));
+}
+
+GTEST_TEST(TalkTable_TLK30Large, threads) {
+	const Aurora::TalkTable_TLK tlk(createLargeTLK(), Common::kEncodingUTF8);
+
+	std::atomic<uint32> mismatches(0);
+
+	// Several threads looking up and caching strings out of the same talk table at once
+	Common::parallelFor(kLargeTLKCount, [&tlk, &mismatches](size_t i) {
+		const uint32 strRef = (uint32) i;
+
+		if ((tlk.getString(strRef) != getLargeString(strRef)) ||
+		    (tlk.getSoundResRef(strRef) != getLargeSoundResRef(strRef)))
+			mismatches++;
+	}, 4);
+
+	EXPECT_EQ(mismatches, 0);
+
+	// The cached strings must still be intact afterwards
+	for (uint32 i = 0; i < kLargeTLKCount; i += 97)
+		ASSERT_STREQ(tlk.getString(i).c_str(), getLargeString(i).c_str()) << "At string " << i;
+}
@@ -22,12 +22,15 @@
  *  Unit tests for our Blowfish implementation.
  */
 
+#include <cstring>
+
 #include <vector>
 
 #include "gtest/gtest.h"
 
 #include "src/common/util.h"
 #include "src/common/error.h"
+#include "src/common/scopedptr.h"
 #include "src/common/memreadstream.h"
 #include "src/common/blowfish.h"
 
@@ -81,3 +84,150 @@ GTEST_TEST(Blowfish, misalign) {
 
 	EXPECT_THROW(Common::decryptBlowfishEBC(cipherText, key), Common::Exception);
 }
+
+GTEST_TEST(Blowfish, encryptInPlace) {
+	std::vector<byte> key;
+	createKey(key);
+
+	byte data[ARRAYSIZE(kCypherText)];
+	std::memset(data, 0, sizeof(data));
+	std::memcpy(data, kClearText, sizeof(kClearText));
+
+	Common::encryptBlowfishEBC(data, sizeof(data), key);
+
+	for (size_t i = 0; i < ARRAYSIZE(kCypherText); i++)
+		EXPECT_EQ(data[i], kCypherText[i]) << "At index " << i;
+
+	EXPECT_THROW(Common::encryptBlowfishEBC(data, 7, key), Common::Exception);
+}
+
+GTEST_TEST(Blowfish, decryptInPlace) {
+	std::vector<byte> key;
+	createKey(key);
+
+	byte data[ARRAYSIZE(kCypherText)];
+	std::memcpy(data, kCypherText, sizeof(data));
+
+	Common::decryptBlowfishEBC(data, sizeof(data), key);
+
+	for (size_t i = 0; i < ARRAYSIZE(kClearText); i++)
+		EXPECT_EQ(data[i], kClearText[i]) << "At index " << i;
+
+	EXPECT_THROW(Common::decryptBlowfishEBC(data, 7, key), Common::Exception);
+}
+
+GTEST_TEST(Blowfish, manyBlocks) {
+	// Several blocks at once are worked on interleaved, so check that against single blocks
+	static const size_t kBlockCount = 13;
+
+	std::vector<byte> key;
+	createKey(key);
+
+	byte clearText[kBlockCount * 8];
+	for (size_t i = 0; i < sizeof(clearText); i++)
+		clearText[i] = (byte) (i * 11 + 7);
+
+	byte cipherText[sizeof(clearText)];
+	std::memcpy(cipherText, clearText, sizeof(clearText));
+
+	Common::encryptBlowfishEBC(cipherText, sizeof(cipherText), key);
+
+	for (size_t i = 0; i < kBlockCount; i++) {
+		byte block[8];
+		std::memcpy(block, clearText + i * 8, 8);
+
+		Common::encryptBlowfishEBC(block, 8, key);
+
+		for (size_t j = 0; j < 8; j++)
+			EXPECT_EQ(cipherText[i * 8 + j], block[j]) << "At index " << i << "." << j;
+	}
+
+	Common::decryptBlowfishEBC(cipherText, sizeof(cipherText), key);
+
+	for (size_t i = 0; i < sizeof(clearText); i++)
+		EXPECT_EQ(cipherText[i], clearText[i]) << "At index " << i;
+}
+
+GTEST_TEST(Blowfish, decryptStream) {
+	static const size_t kBlockCount = 13;
+
+	std::vector<byte> key;
+	createKey(key);
+
+	byte clearText[kBlockCount * 8];
+	for (size_t i = 0; i < sizeof(clearText); i++)
+		clearText[i] = (byte) (i * 11 + 7);
+
+	byte cipherText[sizeof(clearText)];
+	std::memcpy(cipherText, clearText, sizeof(clearText));
+
+	Common::encryptBlowfishEBC(cipherText, sizeof(cipherText), key);
+
+	Common::MemoryReadStream cipherStream(cipherText);
+	Common::BlowfishEBCDecryptStream stream(&cipherStream, key);
+
+	// Read in odd sizes, to mix partial and complete blocks
+	static const size_t kReadSizes[] = { 3, 1, 20, 5, 16, 7, 9 };
+
+	byte data[sizeof(clearText)];
+
+	size_t pos = 0;
+	for (size_t i = 0; pos < sizeof(data); i++) {
+		const size_t size = MIN(kReadSizes[i % ARRAYSIZE(kReadSizes)], sizeof(data) - pos);
+
+		ASSERT_EQ(stream.read(data + pos, size), size);
+		pos += size;
+	}
+
+	for (size_t i = 0; i < sizeof(clearText); i++)
+		EXPECT_EQ(data[i], clearText[i]) << "At index " << i;
+
+	EXPECT_EQ(stream.read(data, 1), 0);
+	EXPECT_TRUE(stream.eos());
+}
+
+GTEST_TEST(Blowfish, decryptStreamPartial) {
+	std::vector<byte> key;
+	createKey(key);
+
+	// The last block is padded with zeros before decrypting it
+	byte clearText[16] = { 0 };
+	std::memcpy(clearText, kCypherText, 13);
+	Common::decryptBlowfishEBC(clearText, sizeof(clearText), key);
+
+	Common::MemoryReadStream cipherStream(kCypherText, 13);
+	Common::BlowfishEBCDecryptStream stream(&cipherStream, key);
+
+	byte data[16];
+	ASSERT_EQ(stream.read(data, 3), 3);
+	ASSERT_EQ(stream.read(data + 3, 7), 7);
+	ASSERT_EQ(stream.read(data + 10, 6), 6);
+
+	for (size_t i = 0; i < sizeof(clearText); i++)
+		EXPECT_EQ(data[i], clearText[i]) << "At index " << i;
+
+	EXPECT_EQ(stream.read(data, 1), 0);
+	EXPECT_TRUE(stream.eos());
+}
+
+GTEST_TEST(Blowfish, decryptStreamPartialLarge) {
+	std::vector<byte> key;
+	createKey(key);
+
+	byte clearText[16] = { 0 };
+	std::memcpy(clearText, kCypherText, 13);
+	Common::decryptBlowfishEBC(clearText, sizeof(clearText), key);
+
+	// A read of complete blocks that runs into the short end of the parent stream
+	Common::MemoryReadStream cipherStream(kCypherText, 13);
+	Common::BlowfishEBCDecryptStream stream(&cipherStream, key);
+
+	byte data[24];
+	ASSERT_EQ(stream.read(data, sizeof(data)), 16);
+
+	for (size_t i = 0; i < sizeof(clearText); i++)
+		EXPECT_EQ(data[i], clearText[i]) << "At index " << i;
+
+	EXPECT_EQ(stream.read(data, 1), 0);
+	EXPECT_TRUE(stream.eos());
+}
@@ -0,0 +1,235 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our debug manager.
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/platform.h"
+#include "src/common/debugman.h"
+
+static boost::filesystem::path kLogPath;
+
+class DebugManager : public ::testing::Test {
+protected:
+	static void SetUpTestCase() {
+		Common::Platform::init();
+
+		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
+		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		kLogPath = tmpPath / uniquePath;
+	}
+
+	static void TearDownTestCase() {
+		if (!kLogPath.empty())
+			boost::filesystem::remove(kLogPath);
+	}
+
+	void SetUp() {
+		if (!kLogPath.empty())
+			boost::filesystem::remove(kLogPath);
+	}
+
+	void TearDown() {
+		DebugMan.closeLogFile();
+	}
+
+	static void openLog() {
+		ASSERT_TRUE(DebugMan.openLogFile(kLogPath.generic_string()));
+	}
+
+	/** Read the log file, stripping the timestamps and the version line. */
+	static std::vector<std::string> readLog() {
+		std::vector<std::string> lines;
+
+		boost::filesystem::ifstream log(kLogPath);
+
+		std::string line;
+		while (std::getline(log, line)) {
+			// "[YYYY-MM-DDTHH:MM:SS] "
+			EXPECT_GE(line.size(), 22);
+			EXPECT_EQ(line[0], '[');
+			EXPECT_EQ(line[11], 'T');
+			EXPECT_EQ(line[20], ']');
+
+			lines.push_back(line.substr(22));
+		}
+
+		if (!lines.empty())
+			lines.erase(lines.begin());
+
+		return lines;
+	}
+};
+
+GTEST_TEST_F(DebugManager, verbosity) {
+	DebugMan.setVerbosityLevel("GScripts", 3);
+
+	EXPECT_EQ(DebugMan.getVerbosityLevel(Common::kDebugScripts), 3);
+
+	EXPECT_TRUE (DebugMan.isEnabled(Common::kDebugScripts, 3));
+	EXPECT_FALSE(DebugMan.isEnabled(Common::kDebugScripts, 4));
+	EXPECT_FALSE(DebugMan.isEnabled("GSound", 1));
+
+	DebugMan.setVerbosityLevel(Common::kDebugChannelAll, 0);
+
+	EXPECT_FALSE(DebugMan.isEnabled(Common::kDebugScripts, 1));
+}
+
+GTEST_TEST_F(DebugManager, logLines) {
+	openLog();
+
+	DebugMan.logString("Foo");
+	DebugMan.logString(Common::UString("bar\nBaz"));
+	DebugMan.logString("\n\nQux\n");
+
+	DebugMan.closeLogFile();
+
+	const std::vector<std::string> lines = readLog();
+	ASSERT_EQ(lines.size(), 4);
+
+	EXPECT_EQ(lines[0], "Foobar");
+	EXPECT_EQ(lines[1], "Baz");
+	EXPECT_EQ(lines[2], "");
+	EXPECT_EQ(lines[3], "Qux");
+}
+
+GTEST_TEST_F(DebugManager, logUnfinished) {
+	openLog();
+
+	DebugMan.logString("Foo\n");
+	DebugMan.logString("Bar");
+
+	DebugMan.closeLogFile();
+
+	const std::vector<std::string> lines = readLog();
+	ASSERT_EQ(lines.size(), 2);
+
+	EXPECT_EQ(lines[0], "Foo");
+	EXPECT_EQ(lines[1], "Bar");
+}
+
+GTEST_TEST_F(DebugManager, logFlush) {
+	openLog();
+
+	DebugMan.logString("Foo\n");
+	DebugMan.flushLogFile();
+
+	// The line has to be in the file now, without closing it
+	const std::vector<std::string> lines = readLog();
+	ASSERT_EQ(lines.size(), 1);
+
+	EXPECT_EQ(lines[0], "Foo");
+}
+
+GTEST_TEST_F(DebugManager, logLongLine) {
+	openLog();
+
+	const std::string longLine(100000, 'x');
+
+	DebugMan.logString("Foo\n");
+	DebugMan.logString((longLine + "\n").c_str());
+	DebugMan.logString("Bar\n");
+
+	DebugMan.closeLogFile();
+
+	const std::vector<std::string> lines = readLog();
+	ASSERT_EQ(lines.size(), 3);
+
+	EXPECT_EQ(lines[0], "Foo");
+	EXPECT_EQ(lines[1], longLine);
+	EXPECT_EQ(lines[2], "Bar");
+}
+
+GTEST_TEST_F(DebugManager, logThreads) {
+	static const size_t kThreadCount = 4;
+	static const size_t kLineCount   = 10000;
+
+	openLog();
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < kThreadCount; i++) {
+		threads.push_back(std::thread([i]() {
+			for (size_t j = 0; j < kLineCount; j++) {
+				DebugMan.logString(Common::UString::format("%u ", (uint) i));
+				DebugMan.logString(Common::UString::format("%u\n", (uint) j));
+			}
+		}));
+	}
+
+	for (std::vector<std::thread>::iterator t = threads.begin(); t != threads.end(); ++t)
+		t->join();
+
+	DebugMan.closeLogFile();
+
+	const std::vector<std::string> lines = readLog();
+	ASSERT_EQ(lines.size(), kThreadCount * kLineCount);
+
+	// Every thread's lines need to be complete and in order
+	size_t next[kThreadCount] = { 0 };
+	for (std::vector<std::string>::const_iterator l = lines.begin(); l != lines.end(); ++l) {
+		unsigned int thread = 0, line = 0;
+		ASSERT_EQ(std::sscanf(l->c_str(), "%u %u", &thread, &line), 2) << *l;
+
+		ASSERT_LT(thread, kThreadCount);
+		EXPECT_EQ(line, next[thread]++);
+	}
+
+	for (size_t i = 0; i < kThreadCount; i++)
+		EXPECT_EQ(next[i], kLineCount);
+}
+
+GTEST_TEST_F(DebugManager, logThreadEnd) {
+	openLog();
+
+	// A thread ending in the middle of a line still gets that line out
+	std::thread first([]() {
+		DebugMan.logString("Foo\n");
+		DebugMan.logString("Bar");
+	});
+	first.join();
+
+	// And the next thread continues after it
+	std::thread second([]() {
+		DebugMan.logString("Baz\n");
+	});
+	second.join();
+
+	DebugMan.closeLogFile();
+
+	const std::vector<std::string> lines = readLog();
+	ASSERT_EQ(lines.size(), 3);
+
+	EXPECT_EQ(lines[0], "Foo");
+	EXPECT_EQ(lines[1], "Bar");
+	EXPECT_EQ(lines[2], "Baz");
+}
@@ -19,13 +19,14 @@
  */
 
 /** @file
- *  Unit tests for our DEFLATE decompressor (which uses zlib).
+ *  Unit tests for our DEFLATE compressor and decompressor (which use zlib).
  */
 
 #include "gtest/gtest.h"
 
 #include "src/common/deflate.h"
 #include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
 #include "src/common/error.h"
 
 // Percy Bysshe Shelley's "Ozymandias"
@@ -282,3 +283,51 @@ GTEST_TEST(DEFLATE, decompressChunked) {
 
 	delete[] output;
 }
+
+static void testCompressStream(int windowBits, unsigned int frameSize) {
+	static const size_t kSizeDecompressed = strlen(kDataUncompressed);
+
+	Common::MemoryReadStream input(kDataUncompressed);
+	Common::MemoryWriteStreamDynamic compressed(true);
+
+	size_t inputSize = 0;
+	const size_t compressedSize = Common::compressDeflate(input, compressed, windowBits, inputSize, 9, frameSize);
+
+	ASSERT_EQ(inputSize, kSizeDecompressed);
+	ASSERT_EQ(compressedSize, compressed.size());
+	EXPECT_LT(compressedSize, kSizeDecompressed);
+
+	const byte *decompressed =
+		Common::decompressDeflate(compressed.getData(), compressed.size(), kSizeDecompressed, windowBits);
+	ASSERT_NE(decompressed, static_cast<const byte *>(0));
+
+	for (size_t i = 0; i < kSizeDecompressed; i++)
+		EXPECT_EQ(decompressed[i], kDataUncompressed[i]) << "At index " << i;
+
+	delete[] decompressed;
+}
+
+GTEST_TEST(DEFLATE, compressStream) {
+	testCompressStream(Common::kWindowBitsMaxRaw, 4096);
+}
+
+GTEST_TEST(DEFLATE, compressStreamSmallFrames) {
+	// Frames dividing the input evenly, and frames that do not
+	testCompressStream(Common::kWindowBitsMaxRaw, 89);
+	testCompressStream(Common::kWindowBitsMaxRaw, 16);
+}
+
+GTEST_TEST(DEFLATE, compressStreamZlibHeader) {
+	testCompressStream(Common::kWindowBitsMax, 64);
+}
+
+GTEST_TEST(DEFLATE, compressStreamEmpty) {
+	Common::MemoryReadStream input(static_cast<const byte *>(0), 0);
+	Common::MemoryWriteStreamDynamic compressed(true);
+
+	size_t inputSize = 1;
+	Common::compressDeflate(input, compressed, Common::kWindowBitsMaxRaw, inputSize);
+
+	EXPECT_EQ(inputSize, 0);
+	EXPECT_GT(compressed.size(), 0);
+}
@@ -0,0 +1,149 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for reading encoded strings out of streams.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/encoding.h"
+#include "src/common/memreadstream.h"
+#include "src/common/ustring.h"
+
+/** Number of strings we read in each test. */
+static const size_t kStringCount = 64;
+
+/** Create kStringCount terminated copies of a string, one after the other. */
+static std::vector<byte> createStringData(const byte *data, size_t size, size_t termSize) {
+	std::vector<byte> buffer;
+	buffer.reserve((size + termSize) * kStringCount);
+
+	for (size_t i = 0; i < kStringCount; i++) {
+		buffer.insert(buffer.end(), data, data + size);
+		buffer.insert(buffer.end(), termSize, 0x00);
+	}
+
+	return buffer;
+}
+
+/** Read all strings out of the data and check them. */
+static void readStrings(const std::vector<byte> &data, Common::Encoding encoding,
+                        const Common::UString &expected) {
+
+	Common::MemoryReadStream stream(&data[0], data.size());
+
+	size_t count = 0;
+	while (stream.pos() < stream.size()) {
+		const Common::UString string = Common::readString(stream, encoding);
+		ASSERT_STREQ(string.c_str(), expected.c_str()) << "At string " << count;
+
+		count++;
+	}
+
+	EXPECT_EQ(count, kStringCount);
+}
+
+// A long, mostly ASCII string, with a few extended characters sprinkled in
+static const byte kCP1252Data[] = {
+	'T', 'h', 'e', ' ', 'q', 'u', 'i', 'c', 'k', ' ', 'b', 'r', 'o', 'w', 'n', ' ',
+	'f', 'o', 'x', ' ', 'j', 'u', 'm', 'p', 's', ' ', 'o', 'v', 'e', 'r', ' ', 't',
+	'h', 'e', ' ', 'l', 'a', 'z', 'y', ' ', 'd', 'o', 'g', ' ', 0x80, ' ', 'F', 0xF6,
+	0xF6, 'b', 0xE4, 'r', ' ', 0x85, ' ', 'T', 'h', 'e', ' ', 'e', 'n', 'd', '.', ' ',
+	'A', 'n', 'd', ' ', 'a', ' ', 'f', 'e', 'w', ' ', 'm', 'o', 'r', 'e', ' ', 'w',
+	'o', 'r', 'd', 's', ' ', 't', 'o', ' ', 'p', 'a', 'd', ' ', 'i', 't', ' ', 'o',
+	'u', 't', ' ', 'a', ' ', 'b', 'i', 't', '.'
+};
+
+static const Common::UString kCP1252String =
+	Common::UString("The quick brown fox jumps over the lazy dog ""\xe2""\x82""\xac"" F""\xc3""\xb6""\xc3""\xb6""b""\xc3""\xa4""r ") +
+	Common::UString("\xe2""\x80""\xa6"" The end. And a few more words to pad it out a bit.");
+
+GTEST_TEST(EncodingReadString, readStringCP1252) {
+	const std::vector<byte> data = createStringData(kCP1252Data, sizeof(kCP1252Data), 1);
+
+	readStrings(data, Common::kEncodingCP1252, kCP1252String);
+}
+
+GTEST_TEST(EncodingReadString, readStringUTF16LE) {
+	Common::ScopedPtr<Common::MemoryReadStream>
+		utf16(Common::convertString(kCP1252String, Common::kEncodingUTF16LE, false));
+	ASSERT_TRUE(utf16);
+
+	const std::vector<byte> data = createStringData(utf16->getData(), utf16->size(), 2);
+
+	readStrings(data, Common::kEncodingUTF16LE, kCP1252String);
+}
+
+GTEST_TEST(EncodingReadString, readStringASCII) {
+	static const byte kASCIIData[] = "The quick brown fox jumps over the lazy dog, again and again and again.";
+
+	const std::vector<byte> data = createStringData(kASCIIData, sizeof(kASCIIData) - 1, 1);
+
+	readStrings(data, Common::kEncodingASCII, reinterpret_cast<const char *>(kASCIIData));
+}
+
+GTEST_TEST(EncodingReadString, readStringLong) {
+	// A string longer than a single read chunk, to test reading across the chunk boundaries
+	std::vector<byte> data;
+	for (size_t i = 0; i < 1000; i++)
+		data.push_back('a' + (i % 26));
+
+	data.push_back(0x00);
+	data.push_back('x');
+
+	Common::MemoryReadStream stream(&data[0], data.size());
+
+	const Common::UString string = Common::readString(stream, Common::kEncodingCP1252);
+
+	EXPECT_EQ(string.size(), 1000);
+	EXPECT_EQ(stream.pos(), 1001);
+	EXPECT_FALSE(stream.eos());
+}
+
+GTEST_TEST(EncodingReadString, surrogates) {
+	// U+1F600, as a UTF-16 surrogate pair
+	static const byte kUTF16Data[] = { 'a', 0x00, 0x3D, 0xD8, 0x00, 0xDE, 'b', 0x00 };
+	static const Common::UString kUTF8 = Common::UString("a""\xf0""\x9f""\x98""\x80""b");
+
+	const Common::UString string = Common::readString(kUTF16Data, sizeof(kUTF16Data), Common::kEncodingUTF16LE);
+	EXPECT_STREQ(string.c_str(), kUTF8.c_str());
+
+	Common::ScopedPtr<Common::MemoryReadStream> stream(Common::convertString(kUTF8, Common::kEncodingUTF16LE, false));
+	ASSERT_TRUE(stream);
+	ASSERT_EQ(stream->size(), sizeof(kUTF16Data));
+
+	for (size_t i = 0; i < sizeof(kUTF16Data); i++)
+		EXPECT_EQ(stream->readByte(), kUTF16Data[i]) << "At index " << i;
+}
+
+GTEST_TEST(EncodingReadString, invalid) {
+	// 0x81 is not a valid character in Windows codepage 1252
+	static const byte kCP1252Invalid[] = { 'a', 0x81, 'b' };
+	// A lone low surrogate
+	static const byte kUTF16Invalid[]  = { 'a', 0x00, 0x00, 0xDE, 'b', 0x00 };
+
+	EXPECT_STREQ(Common::readString(kCP1252Invalid, sizeof(kCP1252Invalid), Common::kEncodingCP1252).c_str(), "[!?!]");
+	EXPECT_STREQ(Common::readString(kUTF16Invalid , sizeof(kUTF16Invalid) , Common::kEncodingUTF16LE).c_str(), "[!?!]");
+}
@@ -34,6 +34,8 @@
  * - Common::FilePath::findSubDirectory()
  * - Common::FilePath::getSubDirectories()
  * - Common::FilePath::createDirectories()
+ * - Common::FilePath::renameFile()
+ * - Common::FilePath::removeFile()
  *
  * The following methods can't be tested because their behaviour changes
  * both with the operating system and user configuration:
@@ -63,3 +63,97 @@ GTEST_TEST(Hash, CRC32Encoding) {
 GTEST_TEST(Hash, formatHash) {
 	EXPECT_STREQ(Common::formatHash(UINT64_C(0x1234567890ABCDEF)).c_str(), "0x1234567890ABCDEF");
 }
+
+static const Common::HashAlgo kAlgos[] = {
+	Common::kHashDJB2, Common::kHashFNV32, Common::kHashFNV64, Common::kHashCRC32
+};
+
+/** Hash the string the plain old way, character by character. */
+static uint64 hashStringReference(const Common::UString &string, Common::HashAlgo algo) {
+	uint64 hash = 0;
+	switch (algo) {
+		case Common::kHashDJB2:
+			hash = 5381;
+			for (Common::UString::iterator it = string.begin(); it != string.end(); ++it)
+				hash = Common::hashDJB2(hash, *it);
+			return hash;
+
+		case Common::kHashFNV32:
+			hash = 0x811C9DC5;
+			for (Common::UString::iterator it = string.begin(); it != string.end(); ++it)
+				hash = Common::hashFNV32(hash, *it);
+			return hash;
+
+		case Common::kHashFNV64:
+			hash = 0xCBF29CE484222325LL;
+			for (Common::UString::iterator it = string.begin(); it != string.end(); ++it)
+				hash = Common::hashFNV64(hash, *it);
+			return hash;
+
+		case Common::kHashCRC32:
+			hash = 0xFFFFFFFF;
+			for (Common::UString::iterator it = string.begin(); it != string.end(); ++it)
+				hash = Common::hashCRC32(hash, *it);
+			return hash ^ 0xFFFFFFFF;
+
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+GTEST_TEST(Hash, hashDataCRC32) {
+	static const size_t kSize = 67;
+
+	byte data[kSize];
+	for (size_t i = 0; i < kSize; i++)
+		data[i] = (byte) (i * 13 + 5);
+
+	for (size_t size = 0; size <= kSize; size++) {
+		uint32 hash = 0xFFFFFFFF;
+		for (size_t i = 0; i < size; i++)
+			hash = Common::hashCRC32(hash, data[i]);
+
+		EXPECT_EQ(Common::hashDataCRC32(0xFFFFFFFF, data, size), hash) << "At size " << size;
+	}
+}
+
+GTEST_TEST(Hash, nonASCII) {
+	// "Föobär", which goes through the character-by-character path
+	const Common::UString string("F\xC3\xB6obar\xC3\xA4");
+
+	for (size_t i = 0; i < ARRAYSIZE(kAlgos); i++)
+		EXPECT_EQ(Common::hashString(string, kAlgos[i]), hashStringReference(string, kAlgos[i])) << "At index " << i;
+}
+
+GTEST_TEST(Hash, hashStringLower) {
+	static const char * const kStrings[] = {
+		"", "Foobar", "FOOBAR.TGA", "Some/Long/Path/With_Many-Characters[0123456789]/ABCXYZ@.mdl",
+		"F\xC3\xB6obar\xC3\xA4"
+	};
+
+	for (size_t i = 0; i < ARRAYSIZE(kStrings); i++) {
+		const Common::UString string(kStrings[i]);
+		const Common::UString lower(string.toLower());
+
+		for (size_t j = 0; j < ARRAYSIZE(kAlgos); j++) {
+			EXPECT_EQ(Common::hashStringLower(string, kAlgos[j]),
+			          Common::hashString(lower, kAlgos[j])) << "At index " << i << "." << j;
+
+			EXPECT_EQ(Common::hashStringLower(string, kAlgos[j], Common::kEncodingUTF16LE),
+			          Common::hashString(lower, kAlgos[j], Common::kEncodingUTF16LE)) << "At index " << i << "." << j;
+
+			EXPECT_EQ(Common::hashStringLower(string, kAlgos[j], Common::kEncodingUTF16BE),
+			          Common::hashString(lower, kAlgos[j], Common::kEncodingUTF16BE)) << "At index " << i << "." << j;
+		}
+	}
+}
+
+GTEST_TEST(Hash, UTF16BE) {
+	// Compare the direct path for ASCII strings with the converted non-ASCII path
+	static const byte kFoobarUTF16BE[] = { 0x00, 'F', 0x00, 'o', 0x00, 'o', 0x00, 'b', 0x00, 'a', 0x00, 'r' };
+
+	EXPECT_EQ(Common::hashString(kString, Common::kHashCRC32, Common::kEncodingUTF16BE),
+	          Common::hashDataCRC32(0xFFFFFFFF, kFoobarUTF16BE, sizeof(kFoobarUTF16BE)) ^ 0xFFFFFFFF);
+}
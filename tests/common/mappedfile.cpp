@@ -0,0 +1,92 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our read-only file mapping.
+ */
+
+#include <cstring>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/platform.h"
+#include "src/common/mappedfile.h"
+
+static boost::filesystem::path kFilePath;
+
+class MappedFile : public ::testing::Test {
+protected:
+	static void SetUpTestCase() {
+		Common::Platform::init();
+
+		boost::filesystem::path tmpPath    = boost::filesystem::temp_directory_path();
+		boost::filesystem::path uniquePath = boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		kFilePath = tmpPath / uniquePath;
+	}
+
+	static void TearDownTestCase() {
+		if (!kFilePath.empty())
+			boost::filesystem::remove(kFilePath);
+	}
+};
+
+GTEST_TEST_F(MappedFile, map) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	static const byte data[5] = { 0x12, 0x34, 0x56, 0x78, 0x90 };
+
+	boost::filesystem::ofstream testFile(kFilePath, std::ofstream::binary);
+
+	testFile.write(reinterpret_cast<const char *>(data), ARRAYSIZE(data));
+	testFile.flush();
+	ASSERT_FALSE(testFile.fail());
+
+	testFile.close();
+
+	const Common::MappedFile file(kFilePath.generic_string());
+
+	ASSERT_EQ(file.size(), ARRAYSIZE(data));
+	ASSERT_NE(file.getData(), static_cast<const byte *>(0));
+
+	EXPECT_EQ(std::memcmp(file.getData(), data, ARRAYSIZE(data)), 0);
+}
+
+GTEST_TEST_F(MappedFile, mapEmpty) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	boost::filesystem::ofstream testFile(kFilePath, std::ofstream::binary);
+	testFile.close();
+
+	EXPECT_THROW(Common::MappedFile file(kFilePath.generic_string()), Common::Exception);
+}
+
+GTEST_TEST_F(MappedFile, mapMissing) {
+	ASSERT_FALSE(kFilePath.empty());
+
+	boost::filesystem::remove(kFilePath);
+
+	EXPECT_THROW(Common::MappedFile file(kFilePath.generic_string()), Common::Exception);
+}
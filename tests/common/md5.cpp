@@ -122,3 +122,40 @@ GTEST_TEST(MD5, compareVector) {
 
 	EXPECT_TRUE(Common::compareMD5Digest(data, digest));
 }
+
+GTEST_TEST(MD5, hashMultiple) {
+	// Cover all lengths around the padding and block boundaries
+	static const size_t kCount = 200;
+
+	std::vector<byte> data(kCount);
+	for (size_t i = 0; i < kCount; i++)
+		data[i] = (byte) (i * 7 + 3);
+
+	std::vector<const byte *> blocks(kCount);
+	std::vector<size_t> lengths(kCount);
+	for (size_t i = 0; i < kCount; i++) {
+		blocks [i] = &data[0];
+		lengths[i] = i;
+	}
+
+	std::vector< std::vector<byte> > digests;
+	Common::hashMD5(&blocks[0], &lengths[0], kCount, digests);
+
+	ASSERT_EQ(digests.size(), kCount);
+
+	for (size_t i = 0; i < kCount; i++) {
+		std::vector<byte> digest;
+		Common::hashMD5(&data[0], i, digest);
+
+		ASSERT_EQ(digests[i].size(), Common::kMD5Length);
+		EXPECT_EQ(std::memcmp(&digests[i][0], &digest[0], Common::kMD5Length), 0) << "At length " << i;
+	}
+
+	const byte *dataString = reinterpret_cast<const byte *>(kString);
+	const size_t sizeString = std::strlen(kString);
+
+	Common::hashMD5(&dataString, &sizeString, 1, digests);
+	ASSERT_EQ(digests.size(), 1);
+
+	compareData(digests[0], kDigestString);
+}
@@ -0,0 +1,135 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our per-subsystem memory accounting.
+ */
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "src/common/memaccount.h"
+#include "src/common/ustring.h"
+
+GTEST_TEST(MemoryAccount, set) {
+	const Common::MemoryUsage before = Common::getMemoryUsage(Common::kMemoryImages);
+
+	{
+		Common::MemoryAccount account(Common::kMemoryImages);
+		EXPECT_EQ(account.get(), 0);
+
+		account.set(1000);
+		EXPECT_EQ(account.get(), 1000);
+
+		Common::MemoryUsage usage = Common::getMemoryUsage(Common::kMemoryImages);
+		EXPECT_EQ(usage.current, before.current + 1000);
+		EXPECT_EQ(usage.objects, before.objects + 1);
+
+		account.set(500);
+
+		usage = Common::getMemoryUsage(Common::kMemoryImages);
+		EXPECT_EQ(usage.current, before.current + 500);
+		EXPECT_EQ(usage.objects, before.objects + 1);
+		EXPECT_GE(usage.peak, before.current + 1000);
+
+		account.set(0);
+
+		usage = Common::getMemoryUsage(Common::kMemoryImages);
+		EXPECT_EQ(usage.current, before.current);
+		EXPECT_EQ(usage.objects, before.objects);
+	}
+}
+
+GTEST_TEST(MemoryAccount, addRemove) {
+	const Common::MemoryUsage before = Common::getMemoryUsage(Common::kMemorySound);
+
+	{
+		Common::MemoryAccount account(Common::kMemorySound);
+
+		account.add(100);
+		account.add(200);
+		EXPECT_EQ(account.get(), 300);
+
+		account.remove(50);
+		EXPECT_EQ(account.get(), 250);
+
+		const Common::MemoryUsage usage = Common::getMemoryUsage(Common::kMemorySound);
+		EXPECT_EQ(usage.current, before.current + 250);
+		EXPECT_EQ(usage.objects, before.objects + 1);
+	}
+
+	// The destructor gives the memory back
+	const Common::MemoryUsage after = Common::getMemoryUsage(Common::kMemorySound);
+	EXPECT_EQ(after.current, before.current);
+	EXPECT_EQ(after.objects, before.objects);
+}
+
+GTEST_TEST(MemoryAccount, swap) {
+	const Common::MemoryUsage before = Common::getMemoryUsage(Common::kMemoryMeshes);
+
+	Common::MemoryAccount account1(Common::kMemoryMeshes), account2(Common::kMemoryMeshes);
+
+	account1.set(10);
+	account2.set(20);
+
+	account1.swap(account2);
+	EXPECT_EQ(account1.get(), 20);
+	EXPECT_EQ(account2.get(), 10);
+
+	const Common::MemoryUsage usage = Common::getMemoryUsage(Common::kMemoryMeshes);
+	EXPECT_EQ(usage.current, before.current + 30);
+	EXPECT_EQ(usage.objects, before.objects + 2);
+}
+
+GTEST_TEST(MemoryAccount, categories) {
+	Common::MemoryAccount account(Common::kMemoryScripts);
+	account.set(64);
+
+	EXPECT_EQ(Common::getMemoryUsage(Common::kMemoryScripts).current, 64);
+	EXPECT_EQ(Common::getMemoryUsage(Common::kMemoryParsers).current, 0);
+}
+
+GTEST_TEST(MemoryAccount, resetPeaks) {
+	Common::MemoryAccount account(Common::kMemoryTextures);
+
+	account.set(4096);
+	account.set(1024);
+	EXPECT_EQ(Common::getMemoryUsage(Common::kMemoryTextures).peak, 4096);
+
+	Common::resetMemoryPeaks();
+	EXPECT_EQ(Common::getMemoryUsage(Common::kMemoryTextures).peak, 1024);
+}
+
+GTEST_TEST(MemoryAccount, formatMemorySize) {
+	EXPECT_STREQ(Common::formatMemorySize(0).c_str(), "0 B");
+	EXPECT_STREQ(Common::formatMemorySize(1023).c_str(), "1023 B");
+	EXPECT_STREQ(Common::formatMemorySize(1536).c_str(), "1.50 KiB");
+	EXPECT_STREQ(Common::formatMemorySize(3 * 1024 * 1024).c_str(), "3.00 MiB");
+	EXPECT_STREQ(Common::formatMemorySize(5ULL * 1024 * 1024 * 1024).c_str(), "5.00 GiB");
+}
+
+GTEST_TEST(MemoryAccount, summary) {
+	const Common::UString summary = Common::getMemoryUsageSummary();
+
+	EXPECT_NE(std::strstr(summary.c_str(), "Images: "), (const char *) 0);
+	EXPECT_NE(std::strstr(summary.c_str(), "Scripts: "), (const char *) 0);
+	EXPECT_NE(std::strstr(summary.c_str(), "total: "), (const char *) 0);
+}
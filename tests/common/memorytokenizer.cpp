@@ -0,0 +1,254 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our memory tokenizer.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/memorytokenizer.h"
+#include "src/common/streamtokenizer.h"
+#include "src/common/util.h"
+#include "src/common/ustring.h"
+#include "src/common/memreadstream.h"
+
+GTEST_TEST(TokenView, compare) {
+	const Common::TokenView token("foobar", 3);
+
+	EXPECT_TRUE(token == "foo");
+	EXPECT_TRUE(token != "foobar");
+	EXPECT_TRUE(token.equalsIgnoreCase("FoO"));
+	EXPECT_FALSE(token.equalsIgnoreCase("fo"));
+
+	EXPECT_STREQ(token.toString().c_str(), "foo");
+}
+
+GTEST_TEST(TokenView, parse) {
+	float f = 0.0f;
+	Common::TokenView("1.5xyz", 3).parse(f);
+	EXPECT_EQ(f, 1.5f);
+
+	int i = 0;
+	Common::TokenView("-23").parse(i);
+	EXPECT_EQ(i, -23);
+
+	EXPECT_THROW(Common::TokenView("1.5xyz").parse(f), Common::Exception);
+	EXPECT_THROW(Common::TokenView().parse(i), Common::Exception);
+}
+
+GTEST_TEST(MemoryTokenizer, getToken) {
+	static const char * const kTokens[] = { "foo", "foobar", "bar" };
+
+	static const char *kData = "foo,foobar,bar";
+	Common::MemoryReadStream stream(kData);
+
+	Common::MemoryTokenizer tokenizer;
+	tokenizer.addSeparator(',');
+
+	for (size_t i = 0; i < ARRAYSIZE(kTokens); i++)
+		EXPECT_TRUE(tokenizer.getToken(stream) == kTokens[i]) << "At index " << i;
+
+	EXPECT_TRUE(stream.eos());
+}
+
+GTEST_TEST(MemoryTokenizer, getTokensQuotes) {
+	static const char *kData = "f\"o,o\"\r,b\"a\"r\nfoo";
+	Common::MemoryReadStream stream(kData);
+
+	Common::MemoryTokenizer tokenizer;
+	tokenizer.addSeparator(',');
+	tokenizer.addQuote('\"');
+	tokenizer.addIgnore('\r');
+	tokenizer.addChunkEnd('\n');
+
+	std::vector<Common::TokenView> tokens;
+	EXPECT_EQ(tokenizer.getTokens(stream, tokens, 3, 3, "def"), 2);
+
+	ASSERT_EQ(tokens.size(), 3);
+	EXPECT_TRUE(tokens[0] == "fo,o");
+	EXPECT_TRUE(tokens[1] == "bar");
+	EXPECT_TRUE(tokens[2] == "def");
+
+	EXPECT_EQ(stream.pos(), 13);
+	EXPECT_FALSE(stream.eos());
+
+	tokenizer.nextChunk(stream);
+	EXPECT_TRUE(tokenizer.getToken(stream) == "foo");
+	EXPECT_TRUE(stream.eos());
+}
+
+GTEST_TEST(MemoryTokenizer, nullCharacter) {
+	static const byte kData[] = { 'f', 'o', '\0', 'o', ' ', 'b', 'a', 'r' };
+	Common::MemoryReadStream stream(kData);
+
+	Common::MemoryTokenizer tokenizer;
+	tokenizer.addSeparator(' ');
+
+	EXPECT_TRUE(tokenizer.getToken(stream) == "fo");
+	EXPECT_TRUE(tokenizer.getToken(stream) == "bar");
+}
+
+/** Run the MemoryTokenizer and the StreamTokenizer side by side, and compare the results. */
+static void compareTokenizers(const char *data, Common::StreamTokenizer::ConsecutiveSeparatorRule rule) {
+	Common::StreamTokenizer streamTokenizer(rule);
+	Common::MemoryTokenizer memoryTokenizer(rule);
+
+	streamTokenizer.addSeparator(' ');
+	streamTokenizer.addSeparator('\t');
+	streamTokenizer.addQuote('\"');
+	streamTokenizer.addChunkEnd('\n');
+	streamTokenizer.addIgnore('\r');
+
+	memoryTokenizer.addSeparator(' ');
+	memoryTokenizer.addSeparator('\t');
+	memoryTokenizer.addQuote('\"');
+	memoryTokenizer.addChunkEnd('\n');
+	memoryTokenizer.addIgnore('\r');
+
+	Common::MemoryReadStream stream1(data);
+	Common::MemoryReadStream stream2(data);
+
+	for (size_t step = 0; !stream1.eos() && (step < 1000); step++) {
+		switch (step % 5) {
+			case 0: {
+				std::vector<Common::UString> tokens1, tokens2;
+
+				const size_t count1 = streamTokenizer.getTokens(stream1, tokens1, 2, 4, "****");
+				const size_t count2 = memoryTokenizer.getTokens(stream2, tokens2, 2, 4, "****");
+
+				EXPECT_EQ(count1, count2) << "At step " << step;
+				ASSERT_EQ(tokens1.size(), tokens2.size()) << "At step " << step;
+
+				for (size_t i = 0; i < tokens1.size(); i++)
+					EXPECT_STREQ(tokens1[i].c_str(), tokens2[i].c_str()) << "At step " << step << ", token " << i;
+				break;
+			}
+
+			case 1:
+				EXPECT_STREQ(streamTokenizer.getToken(stream1).c_str(),
+				             memoryTokenizer.getToken(stream2).toString().c_str()) << "At step " << step;
+				break;
+
+			case 2:
+				streamTokenizer.findFirstToken(stream1);
+				memoryTokenizer.findFirstToken(stream2);
+				break;
+
+			case 3:
+				streamTokenizer.skipToken(stream1, 2);
+				memoryTokenizer.skipToken(stream2, 2);
+				break;
+
+			default:
+				streamTokenizer.nextChunk(stream1);
+				memoryTokenizer.nextChunk(stream2);
+				break;
+		}
+
+		ASSERT_EQ(stream1.pos(), stream2.pos()) << "At step " << step;
+		ASSERT_EQ(stream1.eos(), stream2.eos()) << "At step " << step;
+	}
+
+	EXPECT_TRUE(stream2.eos());
+}
+
+GTEST_TEST(MemoryTokenizer, compareStreamTokenizer) {
+	static const char * const kData[] = {
+		"",
+		"foo",
+		"foo bar\n",
+		"  foo   bar\t\tbaz \t quux\r\n\n\nfoobar\n",
+		"row \"quoted token\" \"with\ttab\" x\"y\"z\r\n  0 1 2 3 4 5 6\n\r\n\"unterminated\n quote",
+		"a\tb\t\tc\nd  e\n \n\t\n\"\"\n\" \" xy z\n",
+		"1 2 3 4 5 6 7 8 9 10 11 12 13 14 15\n16 17 18\n19\n\n\n20 21 22 23 24 25"
+	};
+
+	static const Common::StreamTokenizer::ConsecutiveSeparatorRule kRules[] = {
+		Common::StreamTokenizer::kRuleHeed,
+		Common::StreamTokenizer::kRuleIgnoreSame,
+		Common::StreamTokenizer::kRuleIgnoreAll
+	};
+
+	for (size_t r = 0; r < ARRAYSIZE(kRules); r++) {
+		for (size_t d = 0; d < ARRAYSIZE(kData); d++) {
+			SCOPED_TRACE(Common::UString::format("Rule %u, data %u", (uint)r, (uint)d).c_str());
+
+			compareTokenizers(kData[d], kRules[r]);
+		}
+	}
+}
+
+GTEST_TEST(MemoryTokenizer, parseVertices) {
+	// Parse the vertices out of an ASCII model mesh, with both tokenizers
+
+	static const size_t kVertexCount = 64;
+
+	Common::UString model = "  verts 64\n";
+	for (size_t i = 0; i < kVertexCount; i++)
+		model += Common::UString::format("    %.6f %.6f %.6f\r\n", i * 0.001f, i * -0.25f, i * 3.5f);
+
+	std::vector<float> verts1(kVertexCount * 3);
+	{
+		Common::MemoryReadStream stream(model.c_str());
+
+		Common::StreamTokenizer tokenizer(Common::StreamTokenizer::kRuleIgnoreAll);
+		tokenizer.addSeparator(' ');
+		tokenizer.addChunkEnd('\n');
+		tokenizer.addIgnore('\r');
+
+		std::vector<Common::UString> line;
+		tokenizer.nextChunk(stream);
+
+		for (size_t i = 0; i < kVertexCount; i++) {
+			tokenizer.getTokens(stream, line, 3);
+			tokenizer.nextChunk(stream);
+
+			for (size_t j = 0; j < 3; j++)
+				Common::parseString(line[j], verts1[i * 3 + j]);
+		}
+	}
+
+	std::vector<float> verts2(kVertexCount * 3);
+	{
+		Common::MemoryReadStream stream(model.c_str());
+
+		Common::MemoryTokenizer tokenizer(Common::StreamTokenizer::kRuleIgnoreAll);
+		tokenizer.addSeparator(' ');
+		tokenizer.addChunkEnd('\n');
+		tokenizer.addIgnore('\r');
+
+		std::vector<Common::TokenView> line;
+		tokenizer.nextChunk(stream);
+
+		for (size_t i = 0; i < kVertexCount; i++) {
+			tokenizer.getTokens(stream, line, 3);
+			tokenizer.nextChunk(stream);
+
+			for (size_t j = 0; j < 3; j++)
+				line[j].parse(verts2[i * 3 + j]);
+		}
+	}
+
+	for (size_t i = 0; i < verts1.size(); i++)
+		ASSERT_EQ(verts1[i], verts2[i]) << "At index " << i;
+}
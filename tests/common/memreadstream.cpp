@@ -22,6 +22,9 @@
  *  Unit tests for our memory read stream.
  */
 
+#include <cstring>
+#include <vector>
+
 #include "gtest/gtest.h"
 
 #include "src/common/util.h"
@@ -332,3 +335,204 @@ GTEST_TEST(SeekableSubReadStreamEndian, streamEndianBE) {
 	EXPECT_EQ(subStream.readUint32(), 305419896);
 	EXPECT_THROW(subStream.readUint32(), Common::Exception);
 }
+
+/** A stream that only implements read(), so that it can't be read in place. */
+class ForwardReadStream : public Common::ReadStream {
+public:
+	ForwardReadStream(Common::ReadStream &parent) : _parent(&parent) { }
+
+	bool eos() const {
+		return _parent->eos();
+	}
+
+	size_t read(void *dataPtr, size_t dataSize) {
+		return _parent->read(dataPtr, dataSize);
+	}
+
+private:
+	Common::ReadStream *_parent;
+};
+
+GTEST_TEST(MemoryReadStream, readInPlace) {
+	static const byte data[4] = { 1, 2, 3, 4 };
+	Common::MemoryReadStream stream(data);
+
+	stream.skip(1);
+	EXPECT_EQ(stream.readInPlace(2), data + 1);
+	EXPECT_EQ(stream.pos(), 3);
+
+	EXPECT_EQ(stream.readInPlace(2), static_cast<const byte *>(0));
+	EXPECT_EQ(stream.pos(), 3);
+	EXPECT_FALSE(stream.eos());
+
+	Common::SubReadStream subStream(&stream, 1);
+	EXPECT_EQ(subStream.readInPlace(2), static_cast<const byte *>(0));
+	EXPECT_EQ(subStream.readInPlace(1), data + 3);
+}
+
+GTEST_TEST(MemoryReadStream, readArrayLE) {
+	static const byte data[] = { 0x34, 0x12, 0x78, 0x56, 0x00, 0x00, 0x80, 0x3F, 0xFF };
+	Common::MemoryReadStream stream(data);
+
+	uint16 values16[2];
+	stream.readArrayLE(values16, 2);
+
+	EXPECT_EQ(values16[0], 0x1234);
+	EXPECT_EQ(values16[1], 0x5678);
+
+	float valueFloat;
+	stream.readArrayLE(&valueFloat, 1);
+
+	EXPECT_EQ(valueFloat, 1.0f);
+
+	EXPECT_THROW(stream.readArrayLE(values16, 1), Common::Exception);
+}
+
+GTEST_TEST(MemoryReadStream, readArrayBE) {
+	static const byte data[] = {
+		0x12, 0x34, 0x56, 0x78, 0x3F, 0x80, 0x00, 0x00,
+		0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08
+	};
+	Common::MemoryReadStream stream(data);
+
+	uint32 value32;
+	stream.readArrayBE(&value32, 1);
+	EXPECT_EQ(value32, 0x12345678);
+
+	float valueFloat;
+	stream.readArrayBE(&valueFloat, 1);
+	EXPECT_EQ(valueFloat, 1.0f);
+
+	uint64 value64;
+	stream.readArrayBE(&value64, 1);
+	EXPECT_EQ(value64, UINT64_C(0x0102030405060708));
+}
+
+GTEST_TEST(MemoryReadStream, readArrayLong) {
+	// Long enough to go through the vectorized byte swapping, with a tail
+
+	static const size_t kCount = 37;
+
+	std::vector<byte> data(kCount * 4);
+	for (size_t i = 0; i < kCount; i++) {
+		data[i * 4 + 0] = i;
+		data[i * 4 + 1] = 0x10;
+		data[i * 4 + 2] = 0x20;
+		data[i * 4 + 3] = 0x30;
+	}
+
+	Common::MemoryReadStream streamLE(data.data(), data.size());
+	Common::MemoryReadStream streamBE(data.data(), data.size());
+
+	std::vector<uint32> valuesLE(kCount), valuesBE(kCount);
+	streamLE.readArrayLE(valuesLE.data(), kCount);
+	streamBE.readArrayBE(valuesBE.data(), kCount);
+
+	for (size_t i = 0; i < kCount; i++) {
+		EXPECT_EQ(valuesLE[i], 0x30201000 + i) << "At index " << i;
+		EXPECT_EQ(valuesBE[i], (i << 24) + 0x102030) << "At index " << i;
+	}
+
+	Common::MemoryReadStream stream16(data.data(), data.size());
+
+	std::vector<uint16> values16(kCount * 2);
+	stream16.readArrayBE(values16.data(), kCount * 2);
+
+	for (size_t i = 0; i < kCount; i++) {
+		EXPECT_EQ(values16[i * 2 + 0], (i << 8) + 0x10) << "At index " << i;
+		EXPECT_EQ(values16[i * 2 + 1], 0x2030) << "At index " << i;
+	}
+}
+
+static void testReadArrayStrided(Common::ReadStream &stream, size_t count) {
+	// Read the first two of the four uint16 of each element, into every other pair of a buffer
+
+	std::vector<uint16> values(count * 4, 0xFFFF);
+	stream.readArrayStridedBE(values.data(), count, 2, 4, 8);
+
+	for (size_t i = 0; i < count; i++) {
+		EXPECT_EQ(values[i * 4 + 0], i * 4 + 0) << "At index " << i;
+		EXPECT_EQ(values[i * 4 + 1], i * 4 + 1) << "At index " << i;
+		EXPECT_EQ(values[i * 4 + 2], 0xFFFF) << "At index " << i;
+		EXPECT_EQ(values[i * 4 + 3], 0xFFFF) << "At index " << i;
+	}
+}
+
+GTEST_TEST(MemoryReadStream, readArrayStrided) {
+	static const size_t kCount = 1000;
+
+	std::vector<byte> data(kCount * 8);
+	for (size_t i = 0; i < data.size() / 2; i++) {
+		data[i * 2 + 0] = i >> 8;
+		data[i * 2 + 1] = i & 0xFF;
+	}
+
+	// Gathered in place
+	Common::MemoryReadStream stream(data.data(), data.size());
+	testReadArrayStrided(stream, kCount);
+	EXPECT_EQ(stream.pos(), data.size() - 4);
+
+	// Read in chunks
+	Common::MemoryReadStream stream2(data.data(), data.size());
+	ForwardReadStream forwardStream(stream2);
+	testReadArrayStrided(forwardStream, kCount);
+	EXPECT_EQ(stream2.pos(), data.size() - 4);
+
+	// Too short
+	Common::MemoryReadStream stream3(data.data(), data.size() - 6);
+	std::vector<uint16> values(kCount * 2);
+	EXPECT_THROW(stream3.readArrayStridedLE(values.data(), kCount, 2, 2, 8), Common::Exception);
+
+	// Overlapping elements
+	Common::MemoryReadStream stream4(data.data(), data.size());
+	EXPECT_THROW(stream4.readArrayStridedLE(values.data(), 2, 2, 2, 2), Common::Exception);
+}
+
+GTEST_TEST(MemoryReadStreamEndian, readArray) {
+	static const byte data[] = { 0x12, 0x34, 0x12, 0x34 };
+
+	Common::MemoryReadStreamEndian streamLE(data, sizeof(data), false);
+	Common::MemoryReadStreamEndian streamBE(data, sizeof(data), true);
+
+	uint16 valueLE, valueBE;
+	streamLE.readArray(&valueLE, 1);
+	streamBE.readArray(&valueBE, 1);
+
+	EXPECT_EQ(valueLE, 0x3412);
+	EXPECT_EQ(valueBE, 0x1234);
+}
+
+GTEST_TEST(MemoryReadStream, readArraySubStream) {
+	/* Reading an array of vertices in bulk through a sub stream, like the
+	 * model loaders do, has to give the same values as reading them one by one. */
+
+	static const size_t kVertexCount = 64;
+	static const size_t kVertexWidth = 8;
+
+	std::vector<byte> data(kVertexCount * kVertexWidth * 4);
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = i * 7;
+
+	Common::MemoryReadStream stream(data.data(), data.size());
+
+	std::vector<float> values(kVertexCount * kVertexWidth);
+
+	{
+		Common::SeekableSubReadStream subStream(&stream, 0, stream.size());
+
+		float *v = values.data();
+		for (size_t i = 0; i < values.size(); i++)
+			*v++ = subStream.readIEEEFloatLE();
+	}
+
+	std::vector<float> bulkValues(kVertexCount * kVertexWidth);
+
+	{
+		Common::SeekableSubReadStream subStream(&stream, 0, stream.size());
+
+		subStream.readArrayLE(bulkValues.data(), bulkValues.size());
+		EXPECT_EQ(subStream.pos(), subStream.size());
+	}
+
+	EXPECT_EQ(std::memcmp(values.data(), bulkValues.data(), values.size() * sizeof(float)), 0);
+}
@@ -90,6 +90,11 @@ tests_common_test_readfile_SOURCES  = tests/common/readfile.cpp
 tests_common_test_readfile_LDADD    = $(common_LIBS)
 tests_common_test_readfile_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                       += tests/common/test_mappedfile
+tests_common_test_mappedfile_SOURCES  = tests/common/mappedfile.cpp
+tests_common_test_mappedfile_LDADD    = $(common_LIBS)
+tests_common_test_mappedfile_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                      += tests/common/test_writefile
 tests_common_test_writefile_SOURCES  = tests/common/writefile.cpp
 tests_common_test_writefile_LDADD    = $(common_LIBS)
@@ -187,6 +192,11 @@ tests_common_test_encoding_cp950_SOURCES  = tests/common/encoding_cp950.cpp
 tests_common_test_encoding_cp950_LDADD    = $(common_LIBS)
 tests_common_test_encoding_cp950_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                                += tests/common/test_encoding_readstring
+tests_common_test_encoding_readstring_SOURCES  = tests/common/encoding_readstring.cpp
+tests_common_test_encoding_readstring_LDADD    = $(common_LIBS)
+tests_common_test_encoding_readstring_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                     += tests/common/test_filepath
 tests_common_test_filepath_SOURCES  = tests/common/filepath.cpp
 tests_common_test_filepath_LDADD    = $(common_LIBS)
@@ -236,6 +246,11 @@ tests_common_test_streamtokenizer_SOURCES  = tests/common/streamtokenizer.cpp
 tests_common_test_streamtokenizer_LDADD    = $(common_LIBS)
 tests_common_test_streamtokenizer_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                             += tests/common/test_memorytokenizer
+tests_common_test_memorytokenizer_SOURCES  = tests/common/memorytokenizer.cpp
+tests_common_test_memorytokenizer_LDADD    = $(common_LIBS)
+tests_common_test_memorytokenizer_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                  += tests/common/test_maths
 tests_common_test_maths_SOURCES  = tests/common/maths.cpp
 tests_common_test_maths_LDADD    = $(common_LIBS)
@@ -260,3 +275,23 @@ check_PROGRAMS                     += tests/common/test_aabbnode
 tests_common_test_aabbnode_SOURCES  = tests/common/aabbnode.cpp
 tests_common_test_aabbnode_LDADD    = $(common_LIBS)
 tests_common_test_aabbnode_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                     += tests/common/test_debugman
+tests_common_test_debugman_SOURCES  = tests/common/debugman.cpp
+tests_common_test_debugman_LDADD    = $(common_LIBS)
+tests_common_test_debugman_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                    += tests/common/test_threads
+tests_common_test_threads_SOURCES  = tests/common/threads.cpp
+tests_common_test_threads_LDADD    = $(common_LIBS)
+tests_common_test_threads_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                  += tests/common/test_trace
+tests_common_test_trace_SOURCES  = tests/common/trace.cpp
+tests_common_test_trace_LDADD    = $(common_LIBS)
+tests_common_test_trace_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                      += tests/common/test_memaccount
+tests_common_test_memaccount_SOURCES  = tests/common/memaccount.cpp
+tests_common_test_memaccount_LDADD    = $(common_LIBS)
+tests_common_test_memaccount_CXXFLAGS = $(test_CXXFLAGS)
@@ -22,8 +22,13 @@
  *  Unit tests for our string and stream utilities.
  */
 
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
 #include "gtest/gtest.h"
 
+#include "src/common/util.h"
 #include "src/common/error.h"
 #include "src/common/ustring.h"
 #include "src/common/strutil.h"
@@ -349,6 +354,76 @@ GTEST_TEST(StrUtil, parseDouble) {
 	EXPECT_DOUBLE_EQ(x, 0.0);
 }
 
+GTEST_TEST(StrUtil, parseNonDecimal) {
+	int32 x = 0;
+
+	Common::parseString("0x10", x);
+	EXPECT_EQ(x, 16);
+	Common::parseString("010", x);
+	EXPECT_EQ(x, 8);
+	Common::parseString("23 ", x);
+	EXPECT_EQ(x, 23);
+	Common::parseString("+23", x);
+	EXPECT_EQ(x, 23);
+
+	float y = 0.0f;
+
+	Common::parseString("1e3", y);
+	EXPECT_EQ(y, 1000.0f);
+	Common::parseString(".5", y);
+	EXPECT_EQ(y, 0.5f);
+	Common::parseString("0x1p3", y);
+	EXPECT_EQ(y, 8.0f);
+	Common::parseString("1.5 ", y);
+	EXPECT_EQ(y, 1.5f);
+
+	EXPECT_THROW(Common::parseString("1e", y), Common::Exception);
+	EXPECT_THROW(Common::parseString(".", y), Common::Exception);
+	EXPECT_THROW(Common::parseString("1.5.", y), Common::Exception);
+}
+
+GTEST_TEST(StrUtil, parseLength) {
+	static const char *kData = "123.25456";
+
+	int32 x = 0;
+	Common::parseString(kData, 3, x);
+	EXPECT_EQ(x, 123);
+
+	float y = 0.0f;
+	Common::parseString(kData, 6, y);
+	EXPECT_EQ(y, 123.25f);
+
+	y = 1.0f;
+	Common::parseString(kData, 0, y, true);
+	EXPECT_EQ(y, 1.0f);
+
+	EXPECT_THROW(Common::parseString(kData, 0, y), Common::Exception);
+}
+
+GTEST_TEST(StrUtil, parseFloatStrtof) {
+	// Parsing needs to give the exact same result as strtof()/strtod()
+
+	static const char * const kFormats[] = { "%.3f", "%.6f", "%.9f", "%.6e", "%.8g", "%.17g" };
+
+	uint32 random = 1;
+	for (size_t i = 0; i < 100000; i++) {
+		random = random * 1103515245 + 12345;
+
+		const double value = ((int32) random) / ((double) (1 << ((random >> 8) % 31)));
+
+		char str[64];
+		std::snprintf(str, sizeof(str), kFormats[i % ARRAYSIZE(kFormats)], value);
+
+		float f = 0.0f;
+		Common::parseString(str, std::strlen(str), f);
+		EXPECT_EQ(f, std::strtof(str, 0)) << str;
+
+		double d = 0.0;
+		Common::parseString(str, std::strlen(str), d);
+		EXPECT_EQ(d, std::strtod(str, 0)) << str;
+	}
+}
+
 GTEST_TEST(StrUtil, searchBackwards) {
 	static const byte kHaystack[] = { 'a','x',' ','a','b','c',' ','a','x','y',' ','a','z','x' };
 	Common::MemoryReadStream haystack(kHaystack, sizeof(kHaystack));
@@ -0,0 +1,72 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our threading helpers.
+ */
+
+#include <atomic>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/error.h"
+#include "src/common/threads.h"
+
+GTEST_TEST(Threads, getHardwareConcurrency) {
+	EXPECT_GE(Common::getHardwareConcurrency(), 1);
+}
+
+GTEST_TEST(Threads, parallelFor) {
+	static const size_t kCount = 1000;
+
+	std::vector<std::atomic<unsigned int>> calls(kCount);
+	for (size_t i = 0; i < kCount; i++)
+		calls[i] = 0;
+
+	Common::parallelFor(kCount, [&calls](size_t i) {
+		calls[i]++;
+	}, 4);
+
+	for (size_t i = 0; i < kCount; i++)
+		EXPECT_EQ(calls[i], 1) << "At index " << i;
+}
+
+GTEST_TEST(Threads, parallelForEmpty) {
+	bool called = false;
+	Common::parallelFor(0, [&called](size_t UNUSED(i)) {
+		called = true;
+	});
+
+	EXPECT_FALSE(called);
+}
+
+GTEST_TEST(Threads, parallelForException) {
+	std::atomic<unsigned int> calls(0);
+
+	EXPECT_THROW(Common::parallelFor(100, [&calls](size_t i) {
+		calls++;
+		if (i == 10)
+			throw Common::Exception("Failing at %u", (uint)i);
+	}, 4), Common::Exception);
+
+	EXPECT_GE(calls, 1);
+	EXPECT_LE(calls, 100);
+}
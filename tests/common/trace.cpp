@@ -0,0 +1,163 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our scoped zone tracing.
+ */
+
+#include <cstring>
+
+#include <thread>
+
+#include "gtest/gtest.h"
+
+#include "src/common/trace.h"
+#include "src/common/ustring.h"
+#include "src/common/threads.h"
+#include "src/common/memwritestream.h"
+
+static Common::UString exportTrace() {
+	Common::MemoryWriteStreamDynamic stream(true);
+	TraceMan.exportChromeTrace(stream);
+
+	return Common::UString(reinterpret_cast<const char *>(stream.getData()), stream.size());
+}
+
+GTEST_TEST(Trace, stopped) {
+	TraceMan.stop();
+
+	{
+		Common::TraceZone zone("stopped", "test");
+	}
+
+	TraceMan.start();
+	TraceMan.stop();
+
+	EXPECT_EQ(TraceMan.getZoneCount(), 0);
+}
+
+GTEST_TEST(Trace, zone) {
+	TraceMan.start();
+
+	{
+		Common::TraceZone outer("outer", "test");
+		{
+			Common::TraceZone inner("inner", "test");
+		}
+	}
+
+	TraceMan.stop();
+
+	{
+		Common::TraceZone zone("stopped", "test");
+	}
+
+	EXPECT_EQ(TraceMan.getZoneCount(), 2);
+	EXPECT_EQ(TraceMan.getDroppedCount(), 0);
+
+	const Common::UString trace = exportTrace();
+
+	EXPECT_TRUE(trace.beginsWith("{"));
+	EXPECT_TRUE(trace.endsWith("]}\n"));
+
+	EXPECT_TRUE(trace.contains("\"name\":\"outer\",\"cat\":\"test\",\"ph\":\"X\""));
+	EXPECT_TRUE(trace.contains("\"name\":\"inner\",\"cat\":\"test\",\"ph\":\"X\""));
+	EXPECT_FALSE(trace.contains("\"stopped\""));
+}
+
+GTEST_TEST(Trace, restart) {
+	TraceMan.start();
+
+	{
+		Common::TraceZone zone("first", "test");
+	}
+
+	TraceMan.start();
+
+	{
+		Common::TraceZone zone("second", "test");
+	}
+
+	TraceMan.stop();
+
+	EXPECT_EQ(TraceMan.getZoneCount(), 1);
+
+	const Common::UString trace = exportTrace();
+
+	EXPECT_FALSE(trace.contains("\"first\""));
+	EXPECT_TRUE(trace.contains("\"second\""));
+}
+
+GTEST_TEST(Trace, threads) {
+	static const size_t kCount = 100;
+
+	TraceMan.start();
+
+	Common::parallelFor(kCount, [](size_t) {
+		Common::TraceZone zone("parallel", "test");
+	}, 4);
+
+	TraceMan.stop();
+
+	EXPECT_EQ(TraceMan.getZoneCount(), kCount);
+}
+
+GTEST_TEST(Trace, threadReuse) {
+	TraceMan.start();
+
+	std::thread first([]() {
+		Common::TraceZone zone("first", "test");
+	});
+	first.join();
+
+	std::thread second([]() {
+		Common::TraceZone zone("second", "test");
+	});
+	second.join();
+
+	TraceMan.stop();
+
+	// The zones of the ended thread are kept
+	EXPECT_EQ(TraceMan.getZoneCount(), 2);
+
+	const Common::UString trace = exportTrace();
+
+	EXPECT_TRUE(trace.contains("\"first\""));
+	EXPECT_TRUE(trace.contains("\"second\""));
+
+	// The second thread continued the buffer of the first one
+	const char *name = std::strstr(trace.c_str(), "\"thread_name\"");
+	ASSERT_NE(name, static_cast<const char *>(0));
+	EXPECT_EQ(std::strstr(name + 1, "\"thread_name\""), static_cast<const char *>(0));
+}
+
+GTEST_TEST(Trace, escape) {
+	TraceMan.start();
+
+	{
+		Common::TraceZone zone("with \"quotes\"", "test\\");
+	}
+
+	TraceMan.stop();
+
+	const Common::UString trace = exportTrace();
+
+	EXPECT_TRUE(trace.contains("\"name\":\"with \\\"quotes\\\"\",\"cat\":\"test\\\\\""));
+}
@@ -22,6 +22,10 @@
  *  Unit tests for our utility templates and functions.
  */
 
+#include <cmath>
+
+#include <limits>
+
 #include "gtest/gtest.h"
 
 #include "src/common/util.h"
@@ -169,6 +173,36 @@ GTEST_TEST(Util, readIEEEFloat16) {
 	EXPECT_NEAR(readIEEEFloat16(0x453B), 5.23f, 0.0005);
 }
 
+GTEST_TEST(Util, writeIEEEFloat16) {
+	EXPECT_EQ(writeIEEEFloat16(  0.00f), 0x0000);
+	EXPECT_EQ(writeIEEEFloat16(- 0.00f), 0x8000);
+	EXPECT_EQ(writeIEEEFloat16(  1.00f), 0x3C00);
+	EXPECT_EQ(writeIEEEFloat16(- 1.00f), 0xBC00);
+	EXPECT_EQ(writeIEEEFloat16( 23.50f), 0x4DE0);
+	EXPECT_EQ(writeIEEEFloat16(  5.23f), 0x453B);
+
+	// Out of range, and infinity
+	EXPECT_EQ(writeIEEEFloat16( 70000.0f), 0x7C00);
+	EXPECT_EQ(writeIEEEFloat16(-70000.0f), 0xFC00);
+	EXPECT_EQ(writeIEEEFloat16(std::numeric_limits<float>::infinity()), 0x7C00);
+
+	// Denormalized
+	EXPECT_EQ(writeIEEEFloat16(std::ldexp(1.0f, -24)), 0x0001);
+	EXPECT_EQ(writeIEEEFloat16(std::ldexp(1.0f, -26)), 0x0000);
+
+	const uint16 nan = writeIEEEFloat16(std::numeric_limits<float>::quiet_NaN());
+	EXPECT_EQ(nan & 0x7C00, 0x7C00);
+	EXPECT_NE(nan & 0x03FF, 0x0000);
+
+	// Every finite float16 needs to survive a round-trip
+	for (uint32 i = 0; i < 0x10000; i++) {
+		if ((i & 0x7C00) == 0x7C00)
+			continue;
+
+		EXPECT_EQ(writeIEEEFloat16(readIEEEFloat16(i)), i) << "At index " << i;
+	}
+}
+
 GTEST_TEST(Util, readNintendoFixedPoint) {
 	EXPECT_DOUBLE_EQ(readNintendoFixedPoint(0x00000000,  true, 15, 16),      0.00);
 	EXPECT_DOUBLE_EQ(readNintendoFixedPoint(0x00010000,  true, 15, 16),      1.00);
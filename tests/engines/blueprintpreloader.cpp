@@ -0,0 +1,186 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for the Engines::BlueprintPreloader class.
+ */
+
+#include <boost/filesystem.hpp>
+
+#include "gtest/gtest.h"
+
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+#include "src/common/writefile.h"
+
+#include "src/aurora/resman.h"
+#include "src/aurora/gff3file.h"
+#include "src/aurora/gff3writer.h"
+
+#include "src/engines/aurora/util.h"
+#include "src/engines/aurora/blueprintpreloader.h"
+
+static const uint32 kUTCID = MKTAG('U', 'T', 'C', ' ');
+
+/** Number of distinct blueprints in the test area. */
+static const size_t kBlueprintCount = 64;
+/** Number of object instances in the test area. */
+static const size_t kInstanceCount  = 256;
+
+class BlueprintPreloader : public ::testing::Test {
+protected:
+	boost::filesystem::path _baseDir;
+
+	void SetUp() {
+		_baseDir = boost::filesystem::temp_directory_path() /
+		           boost::filesystem::unique_path("%%%%_%%%%_%%%%_%%%%.xoreos");
+
+		boost::filesystem::create_directories(_baseDir / "override");
+
+		for (size_t i = 0; i < kBlueprintCount; i++)
+			writeBlueprint(i);
+
+		ResMan.registerDataBase(_baseDir.generic_string());
+		ResMan.indexResourceDir("override", 0, 0, 100);
+	}
+
+	void TearDown() {
+		ResMan.clear();
+
+		boost::system::error_code error;
+		boost::filesystem::remove_all(_baseDir, error);
+	}
+
+	void writeBlueprint(size_t i) {
+		Aurora::GFF3Writer gff(kUTCID);
+
+		gff.getTopLevel()->addUint32("Index", i);
+		gff.getTopLevel()->addExoString("Tag", Common::UString::format("creature%u", (uint)i));
+
+		// Give the blueprints a bit of bulk, like a creature's inventory
+		Aurora::GFF3WriterListPtr list = gff.getTopLevel()->addList("ItemList");
+		for (size_t j = 0; j < 64; j++) {
+			Aurora::GFF3WriterStructPtr item = list->addStruct("");
+
+			item->addExoString("InventoryRes", Common::UString::format("item%u", (uint)j));
+			item->addUint16("Repos_PosX", j % 8);
+			item->addUint16("Repos_Posy", j / 8);
+		}
+
+		const boost::filesystem::path file = _baseDir / "override" / getName(i).c_str();
+
+		Common::WriteFile stream(file.generic_string() + ".utc");
+		gff.write(stream);
+	}
+
+	static Common::UString getName(size_t i) {
+		return Common::UString::format("creature%u", (uint)i);
+	}
+};
+
+GTEST_TEST_F(BlueprintPreloader, take) {
+	Engines::BlueprintPreloader preloader;
+
+	preloader.add(getName(0), Aurora::kFileTypeUTC, kUTCID);
+	preloader.add(getName(0), Aurora::kFileTypeUTC, kUTCID);
+	preloader.add(getName(1), Aurora::kFileTypeUTC, kUTCID);
+	preloader.add("nonexistent", Aurora::kFileTypeUTC, kUTCID);
+
+	EXPECT_EQ(preloader.getResourceCount(), 3);
+	EXPECT_EQ(preloader.getInstanceCount(), 4);
+
+	Aurora::GFF3File *gff3 = 0;
+
+	// Nothing is available before parsing
+	EXPECT_FALSE(preloader.take(getName(0), Aurora::kFileTypeUTC, gff3));
+
+	preloader.read();
+	preloader.parse();
+
+	for (size_t i = 0; i < 2; i++) {
+		ASSERT_TRUE(preloader.take(getName(0), Aurora::kFileTypeUTC, gff3));
+		ASSERT_NE(gff3, static_cast<Aurora::GFF3File *>(0));
+
+		Common::ScopedPtr<Aurora::GFF3File> owned(gff3);
+		EXPECT_EQ(owned->getTopLevel().getUint("Index"), 0);
+		EXPECT_EQ(owned->getTopLevel().getList("ItemList").size(), 64);
+	}
+
+	// All instances of creature0 have been taken
+	EXPECT_FALSE(preloader.take(getName(0), Aurora::kFileTypeUTC, gff3));
+
+	// Names are case-insensitive, but types are not
+	EXPECT_FALSE(preloader.take("CREATURE1", Aurora::kFileTypeUTP, gff3));
+	ASSERT_TRUE(preloader.take("CREATURE1", Aurora::kFileTypeUTC, gff3));
+	ASSERT_NE(gff3, static_cast<Aurora::GFF3File *>(0));
+	delete gff3;
+
+	// Missing resources are handed out as missing
+	gff3 = reinterpret_cast<Aurora::GFF3File *>(1);
+	ASSERT_TRUE(preloader.take("nonexistent", Aurora::kFileTypeUTC, gff3));
+	EXPECT_EQ(gff3, static_cast<Aurora::GFF3File *>(0));
+
+	EXPECT_FALSE(preloader.take(getName(2), Aurora::kFileTypeUTC, gff3));
+}
+
+GTEST_TEST_F(BlueprintPreloader, loadOptionalGFF3) {
+	{
+		Engines::BlueprintPreloader preloader;
+		EXPECT_EQ(Engines::BlueprintPreloader::getActive(), &preloader);
+
+		preloader.add(getName(3), Aurora::kFileTypeUTC, kUTCID);
+		preloader.read();
+		preloader.parse();
+
+		// The first one comes out of the preloader, the second one out of the ResMan
+		for (size_t i = 0; i < 2; i++) {
+			Common::ScopedPtr<Aurora::GFF3File> gff3(Engines::loadOptionalGFF3(getName(3), Aurora::kFileTypeUTC, kUTCID));
+			ASSERT_TRUE(gff3);
+
+			EXPECT_EQ(gff3->getTopLevel().getUint("Index"), 3);
+		}
+
+		EXPECT_FALSE(Engines::loadOptionalGFF3("nonexistent", Aurora::kFileTypeUTC, kUTCID));
+	}
+
+	EXPECT_EQ(Engines::BlueprintPreloader::getActive(), static_cast<Engines::BlueprintPreloader *>(0));
+}
+
+GTEST_TEST_F(BlueprintPreloader, area) {
+	// Load all instances of an area through a preloader, like the area loaders do
+
+	Engines::BlueprintPreloader preloader;
+	for (size_t i = 0; i < kInstanceCount; i++)
+		preloader.add(getName(i % kBlueprintCount), Aurora::kFileTypeUTC, kUTCID);
+
+	EXPECT_EQ(preloader.getResourceCount(), kBlueprintCount);
+	EXPECT_EQ(preloader.getInstanceCount(), kInstanceCount);
+
+	preloader.read();
+	preloader.parse();
+
+	for (size_t i = 0; i < kInstanceCount; i++) {
+		Common::ScopedPtr<Aurora::GFF3File> gff3(Engines::loadOptionalGFF3(getName(i % kBlueprintCount),
+		                                         Aurora::kFileTypeUTC, kUTCID));
+		ASSERT_TRUE(gff3);
+
+		EXPECT_EQ(gff3->getTopLevel().getUint("Index"), i % kBlueprintCount);
+	}
+}
@@ -33,3 +33,8 @@ check_PROGRAMS                     += tests/engines/test_trigger
 tests_engines_test_trigger_SOURCES  = tests/engines/trigger.cpp
 tests_engines_test_trigger_LDADD    = $(engines_LIBS)
 tests_engines_test_trigger_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                                += tests/engines/test_blueprintpreloader
+tests_engines_test_blueprintpreloader_SOURCES  = tests/engines/blueprintpreloader.cpp
+tests_engines_test_blueprintpreloader_LDADD    = $(engines_LIBS)
+tests_engines_test_blueprintpreloader_CXXFLAGS = $(test_CXXFLAGS)
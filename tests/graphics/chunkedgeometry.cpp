@@ -0,0 +1,244 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for the chunked, culled and LODed static geometry.
+ */
+
+#include <cmath>
+
+#include <vector>
+#include <set>
+#include <map>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+#include "external/glm/mat4x4.hpp"
+#include "external/glm/gtc/matrix_transform.hpp"
+
+#include "src/common/util.h"
+#include "src/common/maths.h"
+#include "src/common/boundingbox.h"
+
+#include "src/graphics/indexbuffer.h"
+
+#include "src/graphics/aurora/chunkedgeometry.h"
+
+using Graphics::Aurora::ChunkedGeometry;
+
+typedef std::pair<uint32, uint32> Edge;
+
+/** Number of quads along each side of the test chunk. */
+static const size_t kGridSize = 16;
+
+/** The resolutions of the levels of detail to test. */
+static const size_t kResolutions[] = { 8, 4, 2 };
+
+/** Create a bumpy terrain chunk made of a grid of quads, each split into two triangles. */
+static void createChunk(std::vector<float> &positions, Graphics::IndexBuffer &indices, Common::BoundingBox &bound) {
+	positions.clear();
+	for (size_t y = 0; y <= kGridSize; y++) {
+		for (size_t x = 0; x <= kGridSize; x++) {
+			const float z = std::sin(x * 0.7f) * std::cos(y * 0.4f);
+
+			positions.push_back(x);
+			positions.push_back(y);
+			positions.push_back(z);
+
+			bound.add(x, y, z);
+		}
+	}
+
+	indices.setSize(kGridSize * kGridSize * 6, sizeof(uint16), GL_UNSIGNED_SHORT);
+	uint16 *data = reinterpret_cast<uint16 *>(indices.getData());
+
+	for (size_t y = 0; y < kGridSize; y++) {
+		for (size_t x = 0; x < kGridSize; x++) {
+			const uint16 v = y * (kGridSize + 1) + x;
+
+			*data++ = v;
+			*data++ = v + 1;
+			*data++ = v + kGridSize + 2;
+
+			*data++ = v;
+			*data++ = v + kGridSize + 2;
+			*data++ = v + kGridSize + 1;
+		}
+	}
+}
+
+static std::vector<uint32> getIndices(const Graphics::IndexBuffer &buffer) {
+	const uint16 *data = reinterpret_cast<const uint16 *>(buffer.getData());
+
+	return std::vector<uint32>(data, data + buffer.getCount());
+}
+
+/** Return the edges of the mesh only used by a single triangle, i.e. its outline. */
+static std::set<Edge> getOutline(const std::vector<uint32> &indices) {
+	std::map<Edge, size_t> edges;
+
+	for (size_t i = 0; (i + 2) < indices.size(); i += 3) {
+		for (size_t j = 0; j < 3; j++) {
+			const uint32 a = indices[i + j];
+			const uint32 b = indices[i + ((j + 1) % 3)];
+
+			edges[std::make_pair(MIN(a, b), MAX(a, b))]++;
+		}
+	}
+
+	std::set<Edge> outline;
+	for (std::map<Edge, size_t>::const_iterator e = edges.begin(); e != edges.end(); ++e)
+		if (e->second == 1)
+			outline.insert(e->first);
+
+	return outline;
+}
+
+GTEST_TEST(ChunkedGeometry, lodKeepsEdges) {
+	std::vector<float> positions;
+	Graphics::IndexBuffer full;
+	Common::BoundingBox bound;
+
+	createChunk(positions, full, bound);
+
+	const std::set<Edge> fullOutline = getOutline(getIndices(full));
+	ASSERT_EQ(fullOutline.size(), kGridSize * 4);
+
+	for (size_t r = 0; r < ARRAYSIZE(kResolutions); r++) {
+		SCOPED_TRACE(kResolutions[r]);
+
+		Graphics::IndexBuffer lod;
+		ChunkedGeometry::createLOD(positions, full, bound, kResolutions[r], lod);
+
+		EXPECT_LT(lod.getCount(), full.getCount());
+
+		// The outline of the chunk still runs through all the same vertices, so there are no cracks
+		EXPECT_EQ(getOutline(getIndices(lod)), fullOutline);
+	}
+}
+
+GTEST_TEST(ChunkedGeometry, lodNoDegenerateTriangles) {
+	std::vector<float> positions;
+	Graphics::IndexBuffer full;
+	Common::BoundingBox bound;
+
+	createChunk(positions, full, bound);
+
+	for (size_t r = 0; r < ARRAYSIZE(kResolutions); r++) {
+		SCOPED_TRACE(kResolutions[r]);
+
+		Graphics::IndexBuffer lod;
+		ChunkedGeometry::createLOD(positions, full, bound, kResolutions[r], lod);
+
+		const std::vector<uint32> indices = getIndices(lod);
+		ASSERT_EQ(indices.size() % 3, 0);
+
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			const uint32 a = indices[i + 0], b = indices[i + 1], c = indices[i + 2];
+
+			ASSERT_LT(a, positions.size() / 3);
+			ASSERT_LT(b, positions.size() / 3);
+			ASSERT_LT(c, positions.size() / 3);
+
+			EXPECT_NE(a, b) << "Triangle " << (i / 3);
+			EXPECT_NE(a, c) << "Triangle " << (i / 3);
+			EXPECT_NE(b, c) << "Triangle " << (i / 3);
+
+			// Twice the area of the triangle, projected onto the ground
+			const float abX = positions[b * 3 + 0] - positions[a * 3 + 0];
+			const float abY = positions[b * 3 + 1] - positions[a * 3 + 1];
+			const float acX = positions[c * 3 + 0] - positions[a * 3 + 0];
+			const float acY = positions[c * 3 + 1] - positions[a * 3 + 1];
+
+			EXPECT_GT(ABS(abX * acY - abY * acX), 0.0f) << "Triangle " << (i / 3);
+		}
+	}
+}
+
+GTEST_TEST(ChunkedGeometry, frustum) {
+	// A camera at the origin, looking along the positive y axis
+	const glm::mat4 projection = glm::perspective(Common::deg2rad(60.0f), 4.0f / 3.0f, 1.0f, 1000.0f);
+	const glm::mat4 modelview  = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+	                                         glm::vec3(0.0f, 0.0f, 1.0f));
+
+	ChunkedGeometry::Plane planes[6];
+	ChunkedGeometry::getFrustum(projection * modelview, planes);
+
+	Common::BoundingBox ahead;
+	ahead.add(-8.0f, 50.0f, -1.0f);
+	ahead.add( 8.0f, 66.0f,  1.0f);
+	EXPECT_TRUE(ChunkedGeometry::isInFrustum(planes, ahead));
+
+	// Only partially within the frustum
+	Common::BoundingBox partially;
+	partially.add(-100.0f, 50.0f, -1.0f);
+	partially.add(   0.0f, 66.0f,  1.0f);
+	EXPECT_TRUE(ChunkedGeometry::isInFrustum(planes, partially));
+
+	Common::BoundingBox behind;
+	behind.add(-8.0f, -66.0f, -1.0f);
+	behind.add( 8.0f, -50.0f,  1.0f);
+	EXPECT_FALSE(ChunkedGeometry::isInFrustum(planes, behind));
+
+	Common::BoundingBox left;
+	left.add(-216.0f, 50.0f, -1.0f);
+	left.add(-200.0f, 66.0f,  1.0f);
+	EXPECT_FALSE(ChunkedGeometry::isInFrustum(planes, left));
+
+	Common::BoundingBox above;
+	above.add(-8.0f, 50.0f, 200.0f);
+	above.add( 8.0f, 66.0f, 216.0f);
+	EXPECT_FALSE(ChunkedGeometry::isInFrustum(planes, above));
+
+	Common::BoundingBox tooFar;
+	tooFar.add(-8.0f, 1050.0f, -1.0f);
+	tooFar.add( 8.0f, 1066.0f,  1.0f);
+	EXPECT_FALSE(ChunkedGeometry::isInFrustum(planes, tooFar));
+}
+
+GTEST_TEST(ChunkedGeometry, lodDistance) {
+	Common::BoundingBox bound;
+	bound.add( 0.0f,  0.0f, 0.0f);
+	bound.add(16.0f, 16.0f, 1.0f);
+
+	// Directly above the chunk
+	const float above[3] = { 8.0f, 8.0f, 10.0f };
+	EXPECT_EQ(ChunkedGeometry::getLOD(bound, 3, above), 0);
+
+	// Far away, but the chunk doesn't have any coarser levels of detail
+	const float far[3] = { 1000.0f, 8.0f, 0.5f };
+	EXPECT_EQ(ChunkedGeometry::getLOD(bound, 1, far), 0);
+	EXPECT_EQ(ChunkedGeometry::getLOD(bound, 2, far), 1);
+	EXPECT_EQ(ChunkedGeometry::getLOD(bound, 3, far), 2);
+
+	// Moving away from the chunk never increases the detail
+	size_t lastLOD = 0;
+	for (float x = 16.0f; x < 1000.0f; x += 4.0f) {
+		const float camera[3] = { x, 8.0f, 0.5f };
+
+		const size_t lod = ChunkedGeometry::getLOD(bound, 3, camera);
+		EXPECT_GE(lod, lastLOD) << "At " << x;
+
+		lastLOD = lod;
+	}
+
+	EXPECT_EQ(lastLOD, 2);
+}
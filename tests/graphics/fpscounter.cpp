@@ -0,0 +1,204 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for the frame time statistics of the FPS counter.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/graphics/fpscounter.h"
+
+using Graphics::FPSCounter;
+
+/** A frame of 60 FPS, in microseconds. */
+static const uint32 kFrameTime = 16667;
+
+/** Add a frame, with all of its time spent in this phase. */
+static void addFrame(FPSCounter &counter, uint32 time, Graphics::FramePhase phase = Graphics::kFramePhaseRender) {
+	uint32 phaseTimes[Graphics::kFramePhaseMAX] = { 0 };
+	phaseTimes[phase] = time;
+
+	counter.addFrame(time, phaseTimes);
+}
+
+/** Add a frame whose time is split evenly into all phases. */
+static void addEvenFrame(FPSCounter &counter, uint32 time) {
+	uint32 phaseTimes[Graphics::kFramePhaseMAX];
+	for (size_t i = 0; i < Graphics::kFramePhaseMAX; i++)
+		phaseTimes[i] = time / Graphics::kFramePhaseMAX;
+
+	counter.addFrame(time, phaseTimes);
+}
+
+GTEST_TEST(FPSCounter, percentiles) {
+	FPSCounter counter(1);
+
+	const Graphics::FrameTimeStats empty = counter.getFrameTimeStats(Graphics::kFramePhaseRender);
+	EXPECT_EQ(empty.frames, 0);
+	EXPECT_EQ(empty.max   , 0);
+
+	// Frame times of 1ms to 100ms, in a scrambled order
+	for (uint32 i = 0; i < 100; i++)
+		addFrame(counter, (((i * 37) % 100) + 1) * 1000);
+
+	const Graphics::FrameTimeStats stats = counter.getFrameTimeStats(Graphics::kFramePhaseRender);
+
+	EXPECT_EQ(stats.frames, 100);
+	EXPECT_EQ(stats.p50, 50000);
+	EXPECT_EQ(stats.p95, 95000);
+	EXPECT_EQ(stats.p99, 99000);
+	EXPECT_EQ(stats.max, 100000);
+
+	// The other phases didn't take any time
+	const Graphics::FrameTimeStats swap = counter.getFrameTimeStats(Graphics::kFramePhaseSwap);
+
+	EXPECT_EQ(swap.frames, 100);
+	EXPECT_EQ(swap.max   , 0);
+}
+
+GTEST_TEST(FPSCounter, percentilesHistory) {
+	FPSCounter counter(1);
+
+	// Only the most recent frames count
+	for (size_t i = 0; i < FPSCounter::kFrameHistory; i++)
+		addFrame(counter, 100000);
+	for (size_t i = 0; i < FPSCounter::kFrameHistory; i++)
+		addFrame(counter, kFrameTime);
+
+	const Graphics::FrameTimeStats stats = counter.getFrameTimeStats(Graphics::kFramePhaseRender);
+
+	EXPECT_EQ(stats.frames, (size_t) FPSCounter::kFrameHistory);
+	EXPECT_EQ(stats.p50, kFrameTime);
+	EXPECT_EQ(stats.max, kFrameTime);
+
+	counter.resetFrameTimes();
+
+	EXPECT_EQ(counter.getFrameTimeStats(Graphics::kFramePhaseRender).frames, 0);
+}
+
+GTEST_TEST(FPSCounter, histogram) {
+	FPSCounter counter(1);
+
+	addFrame(counter,  5000);
+	addFrame(counter, 16666);
+	addFrame(counter, 16667);
+	addFrame(counter, 20000);
+	addFrame(counter, 33332);
+	addFrame(counter, 33333);
+	addFrame(counter, 50000);
+	addFrame(counter, 90000);
+
+	std::vector<uint32> limits;
+	limits.push_back(16667);
+	limits.push_back(33333);
+
+	std::vector<uint32> counts;
+	counter.getFrameTimeHistogram(limits, counts);
+
+	// A frame right at a limit belongs to the bucket above it
+	ASSERT_EQ(counts.size(), 3);
+	EXPECT_EQ(counts[0], 2);
+	EXPECT_EQ(counts[1], 3);
+	EXPECT_EQ(counts[2], 3);
+
+	// Without any limits, everything falls into a single bucket
+	counter.getFrameTimeHistogram(std::vector<uint32>(), counts);
+
+	ASSERT_EQ(counts.size(), 1);
+	EXPECT_EQ(counts[0], 8);
+}
+
+GTEST_TEST(FPSCounter, hitch) {
+	FPSCounter counter(1);
+
+	for (size_t i = 0; i < 60; i++)
+		addEvenFrame(counter, kFrameTime);
+
+	std::vector<Graphics::FrameHitch> hitches;
+	counter.getHitches(hitches);
+	EXPECT_TRUE(hitches.empty());
+
+	// Twice the usual frame time isn't enough for a hitch
+	addFrame(counter, 2 * kFrameTime, Graphics::kFramePhaseUpload);
+
+	counter.getHitches(hitches);
+	EXPECT_TRUE(hitches.empty());
+
+	// But thrice the usual frame time is, with the upload taking all of it
+	addFrame(counter, 3 * kFrameTime, Graphics::kFramePhaseUpload);
+
+	counter.getHitches(hitches);
+	ASSERT_EQ(hitches.size(), 1);
+
+	EXPECT_EQ(hitches[0].time, 3 * kFrameTime);
+	EXPECT_EQ(hitches[0].worstPhase, Graphics::kFramePhaseUpload);
+	EXPECT_EQ(hitches[0].phaseTimes[Graphics::kFramePhaseUpload], 3 * kFrameTime);
+}
+
+GTEST_TEST(FPSCounter, hitchWarmup) {
+	FPSCounter counter(1);
+
+	// No hitches until there are enough frames to know the usual frame time
+	addFrame(counter, kFrameTime);
+	addFrame(counter, 10 * kFrameTime);
+
+	std::vector<Graphics::FrameHitch> hitches;
+	counter.getHitches(hitches);
+	EXPECT_TRUE(hitches.empty());
+}
+
+GTEST_TEST(FPSCounter, hitchMinimum) {
+	FPSCounter counter(1);
+
+	// A slow frame at several hundred FPS is still fast enough not to be a hitch
+	for (size_t i = 0; i < 60; i++)
+		addFrame(counter, 2000);
+
+	addFrame(counter, 20000);
+
+	std::vector<Graphics::FrameHitch> hitches;
+	counter.getHitches(hitches);
+	EXPECT_TRUE(hitches.empty());
+}
+
+GTEST_TEST(FPSCounter, hitchHistory) {
+	FPSCounter counter(1);
+
+	for (size_t i = 0; i < 60; i++)
+		addFrame(counter, kFrameTime);
+
+	// Only the most recent hitches are kept, oldest first
+	for (size_t i = 0; i < FPSCounter::kHitchHistory + 8; i++) {
+		addFrame(counter, 100000 + i);
+
+		for (size_t j = 0; j < 60; j++)
+			addFrame(counter, kFrameTime);
+	}
+
+	std::vector<Graphics::FrameHitch> hitches;
+	counter.getHitches(hitches);
+	ASSERT_EQ(hitches.size(), (size_t) FPSCounter::kHitchHistory);
+
+	for (size_t i = 0; i < hitches.size(); i++)
+		EXPECT_EQ(hitches[i].time, 100000 + 8 + i);
+}
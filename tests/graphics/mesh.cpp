@@ -0,0 +1,191 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for meshes and the mesh manager.
+ */
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/scopedptr.h"
+#include "src/common/ustring.h"
+
+#include "src/graphics/mesh/mesh.h"
+#include "src/graphics/mesh/meshman.h"
+
+static const size_t kVertexCount = 4;
+
+/** Position, normal, color and texture coordinates of each vertex. */
+static const float kVertices[kVertexCount][12] = {
+	{ 0.0f, 0.0f, 0.0f,   0.0f,  0.0f, 1.0f,   1.0f, 0.0f, 0.0f, 1.0f,    0.0f,  0.0f  },
+	{ 1.0f, 0.0f, 0.0f,   0.6f,  0.0f, 0.8f,   0.0f, 1.0f, 0.0f, 0.5f,    1.0f,  0.0f  },
+	{ 1.0f, 1.0f, 0.5f,  -0.6f,  0.0f, 0.8f,   0.0f, 0.0f, 1.0f, 0.25f,   1.0f,  1.5f  },
+	{ 0.0f, 1.0f, 0.5f,   0.0f, -1.0f, 0.0f,   0.2f, 0.4f, 0.6f, 0.0f,   -0.75f, 1.25f }
+};
+
+static const uint16 kIndices[] = { 0, 1, 2, 0, 2, 3 };
+
+static Graphics::Mesh::Mesh *createMesh(const Common::UString &name, float offset = 0.0f) {
+	Graphics::Mesh::Mesh *mesh = new Graphics::Mesh::Mesh;
+	mesh->setName(name);
+
+	Graphics::VertexDecl decl;
+	decl.push_back(Graphics::VertexAttrib(Graphics::VPOSITION, 3, GL_FLOAT));
+	decl.push_back(Graphics::VertexAttrib(Graphics::VNORMAL  , 3, GL_FLOAT));
+	decl.push_back(Graphics::VertexAttrib(Graphics::VCOLOR   , 4, GL_FLOAT));
+	decl.push_back(Graphics::VertexAttrib(Graphics::VTCOORD  , 2, GL_FLOAT));
+
+	mesh->getVertexBuffer()->setVertexDeclInterleave(kVertexCount, decl);
+
+	float *vertices = static_cast<float *>(mesh->getVertexBuffer()->getData());
+	for (size_t v = 0; v < kVertexCount; v++)
+		for (size_t i = 0; i < ARRAYSIZE(kVertices[v]); i++)
+			*vertices++ = kVertices[v][i] + ((i == 0) ? offset : 0.0f);
+
+	mesh->getIndexBuffer()->setSize(ARRAYSIZE(kIndices), sizeof(uint16), GL_UNSIGNED_SHORT);
+	std::memcpy(mesh->getIndexBuffer()->getData(), kIndices, sizeof(kIndices));
+
+	return mesh;
+}
+
+static const Graphics::VertexAttrib &getAttrib(Graphics::Mesh::Mesh &mesh, GLuint index) {
+	const Graphics::VertexDecl &decl = mesh.getVertexBuffer()->getVertexDecl();
+	for (Graphics::VertexDecl::const_iterator a = decl.begin(); a != decl.end(); ++a)
+		if (a->index == index)
+			return *a;
+
+	throw Common::Exception("No vertex attribute %u", index);
+}
+
+template<typename T>
+static const T *getAttribData(Graphics::Mesh::Mesh &mesh, GLuint index, size_t vertex) {
+	const Graphics::VertexAttrib &attrib = getAttrib(mesh, index);
+
+	return reinterpret_cast<const T *>(static_cast<const byte *>(attrib.pointer) + vertex * attrib.stride);
+}
+
+GTEST_TEST(Mesh, compactVertices) {
+	Common::ScopedPtr<Graphics::Mesh::Mesh> mesh(createMesh("compact"));
+
+	const size_t oldSize = mesh->getVertexDataSize();
+
+	mesh->compactVertices(true);
+
+	EXPECT_LT(mesh->getVertexDataSize(), oldSize);
+
+	EXPECT_EQ(getAttrib(*mesh, Graphics::VPOSITION).type, (GLenum) GL_FLOAT);
+	EXPECT_EQ(getAttrib(*mesh, Graphics::VNORMAL  ).type, (GLenum) GL_SHORT);
+	EXPECT_EQ(getAttrib(*mesh, Graphics::VCOLOR   ).type, (GLenum) GL_UNSIGNED_BYTE);
+	EXPECT_EQ(getAttrib(*mesh, Graphics::VTCOORD  ).type, (GLenum) GL_HALF_FLOAT);
+
+	for (size_t v = 0; v < kVertexCount; v++) {
+		SCOPED_TRACE(v);
+
+		const float  *position = getAttribData<float >(*mesh, Graphics::VPOSITION, v);
+		const int16  *normal   = getAttribData<int16 >(*mesh, Graphics::VNORMAL  , v);
+		const byte   *color    = getAttribData<byte  >(*mesh, Graphics::VCOLOR   , v);
+		const uint16 *tCoord   = getAttribData<uint16>(*mesh, Graphics::VTCOORD  , v);
+
+		for (size_t i = 0; i < 3; i++)
+			EXPECT_EQ(position[i], kVertices[v][i]);
+
+		for (size_t i = 0; i < 3; i++)
+			EXPECT_NEAR(normal[i] / 32767.0f, kVertices[v][3 + i], 1.0f / 32767.0f);
+
+		for (size_t i = 0; i < 4; i++)
+			EXPECT_NEAR(color[i] / 255.0f, kVertices[v][6 + i], 1.0f / 255.0f);
+
+		for (size_t i = 0; i < 2; i++)
+			EXPECT_NEAR(readIEEEFloat16(tCoord[i]), kVertices[v][10 + i], 0.001f);
+	}
+}
+
+GTEST_TEST(Mesh, compactVerticesNoHalfFloats) {
+	Common::ScopedPtr<Graphics::Mesh::Mesh> mesh(createMesh("compact"));
+
+	mesh->compactVertices(false);
+
+	EXPECT_EQ(getAttrib(*mesh, Graphics::VTCOORD).type, (GLenum) GL_FLOAT);
+
+	for (size_t v = 0; v < kVertexCount; v++) {
+		const float *tCoord = getAttribData<float>(*mesh, Graphics::VTCOORD, v);
+
+		EXPECT_EQ(tCoord[0], kVertices[v][10]);
+		EXPECT_EQ(tCoord[1], kVertices[v][11]);
+	}
+}
+
+GTEST_TEST(Mesh, hasSameContent) {
+	Common::ScopedPtr<Graphics::Mesh::Mesh> mesh1(createMesh("mesh1"));
+	Common::ScopedPtr<Graphics::Mesh::Mesh> mesh2(createMesh("mesh2"));
+	Common::ScopedPtr<Graphics::Mesh::Mesh> mesh3(createMesh("mesh3", 1.0f));
+
+	// The name doesn't matter
+	EXPECT_TRUE(mesh1->hasSameContent(*mesh2));
+	EXPECT_EQ(mesh1->getContentHash(), mesh2->getContentHash());
+
+	EXPECT_FALSE(mesh1->hasSameContent(*mesh3));
+
+	// The vertex layout has to match as well
+	mesh2->compactVertices(false);
+	EXPECT_FALSE(mesh1->hasSameContent(*mesh2));
+
+	mesh1->compactVertices(false);
+	EXPECT_TRUE(mesh1->hasSameContent(*mesh2));
+}
+
+GTEST_TEST(MeshManager, addSharedMesh) {
+	Graphics::Mesh::Mesh *mesh1 = createMesh("mesh1");
+	Graphics::Mesh::Mesh *mesh2 = createMesh("mesh2");
+	Graphics::Mesh::Mesh *mesh3 = createMesh("mesh3", 1.0f);
+
+	const size_t meshSize = mesh1->getVertexDataSize() + mesh1->getIndexDataSize();
+
+	EXPECT_EQ(MeshMan.addSharedMesh(mesh1), mesh1);
+
+	// mesh2 is identical to mesh1, so it's replaced by it
+	EXPECT_EQ(MeshMan.addSharedMesh(mesh2), mesh1);
+
+	// mesh3 is different
+	EXPECT_EQ(MeshMan.addSharedMesh(mesh3), mesh3);
+
+	EXPECT_EQ(MeshMan.getMesh("mesh1"), mesh1);
+	EXPECT_EQ(MeshMan.getMesh("mesh2"), mesh1);
+	EXPECT_EQ(MeshMan.getMesh("mesh3"), mesh3);
+
+	const Graphics::Mesh::MeshManager::Statistics stats = MeshMan.getStatistics();
+
+	EXPECT_EQ(stats.meshCount  , 2);
+	EXPECT_EQ(stats.sharedCount, 1);
+	EXPECT_EQ(stats.sharedSize , meshSize);
+
+	// Cleaning up unused meshes also removes the names referring to them
+	MeshMan.cleanup();
+
+	EXPECT_EQ(MeshMan.getMesh("mesh1"), static_cast<Graphics::Mesh::Mesh *>(0));
+	EXPECT_EQ(MeshMan.getMesh("mesh2"), static_cast<Graphics::Mesh::Mesh *>(0));
+	EXPECT_EQ(MeshMan.getMesh("mesh3"), static_cast<Graphics::Mesh::Mesh *>(0));
+
+	Graphics::Mesh::MeshManager::destroy();
+}
@@ -0,0 +1,177 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for the compiled form of NWN's ASCII models.
+ */
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+#include "src/common/error.h"
+#include "src/common/memreadstream.h"
+#include "src/common/memwritestream.h"
+
+#include "src/graphics/aurora/model_nwn.h"
+
+typedef Graphics::Aurora::Model_NWN::CompiledNode CompiledNode;
+
+/** Read back a compiled node, making sure all of the compiled data has been read. */
+static void readNode(Common::MemoryWriteStreamDynamic &compiled, CompiledNode &node) {
+	Common::MemoryReadStream stream(compiled.getData(), compiled.size());
+
+	Graphics::Aurora::Model_NWN::readCompiledNode(stream, node);
+
+	EXPECT_EQ(stream.pos(), stream.size());
+}
+
+static void createMeshNode(CompiledNode &node) {
+	node.name   = "plc_chair01";
+	node.parent = "root";
+
+	node.position[0] = 1.0f;
+	node.position[1] = -2.5f;
+	node.position[2] = 0.125f;
+
+	node.orientation[0] = 0.0f;
+	node.orientation[1] = 0.0f;
+	node.orientation[2] = 1.0f;
+	node.orientation[3] = 90.0f;
+
+	node.render  = false;
+	node.hasMesh = true;
+
+	node.meshRender       = false;
+	node.transparencyHint = true;
+	node.dangly           = true;
+
+	node.textures.push_back("tex_wood");
+	node.textures.push_back("tex_cloth");
+
+	// 3 vertices: position, normal, and 2 texture coordinates for each of the 2 textures
+	for (size_t i = 0; i < 3 * 10; i++)
+		node.vertices.push_back(i * 0.5f - 3.0f);
+
+	node.indices.push_back(0);
+	node.indices.push_back(2);
+	node.indices.push_back(1);
+}
+
+GTEST_TEST(Model_NWN, compiledNodeRoundTrip) {
+	CompiledNode node;
+	createMeshNode(node);
+
+	Common::MemoryWriteStreamDynamic compiled(true);
+	Graphics::Aurora::Model_NWN::writeCompiledNode(compiled, node);
+
+	CompiledNode read;
+	readNode(compiled, read);
+
+	EXPECT_STREQ(read.name.c_str()  , node.name.c_str());
+	EXPECT_STREQ(read.parent.c_str(), node.parent.c_str());
+
+	for (size_t i = 0; i < ARRAYSIZE(node.position); i++)
+		EXPECT_EQ(read.position[i], node.position[i]) << "At index " << i;
+	for (size_t i = 0; i < ARRAYSIZE(node.orientation); i++)
+		EXPECT_EQ(read.orientation[i], node.orientation[i]) << "At index " << i;
+
+	EXPECT_EQ(read.render , node.render);
+	EXPECT_EQ(read.hasMesh, node.hasMesh);
+
+	EXPECT_EQ(read.meshRender      , node.meshRender);
+	EXPECT_EQ(read.transparencyHint, node.transparencyHint);
+	EXPECT_EQ(read.dangly          , node.dangly);
+
+	ASSERT_EQ(read.textures.size(), node.textures.size());
+	for (size_t i = 0; i < node.textures.size(); i++)
+		EXPECT_STREQ(read.textures[i].c_str(), node.textures[i].c_str()) << "At index " << i;
+
+	EXPECT_EQ(read.vertices, node.vertices);
+	EXPECT_EQ(read.indices , node.indices);
+}
+
+GTEST_TEST(Model_NWN, compiledNodeRoundTripNoMesh) {
+	CompiledNode node;
+	node.name   = "rootdummy";
+	node.parent = "NULL";
+
+	node.position[2] = 4.0f;
+
+	Common::MemoryWriteStreamDynamic compiled(true);
+	Graphics::Aurora::Model_NWN::writeCompiledNode(compiled, node);
+
+	CompiledNode read;
+	readNode(compiled, read);
+
+	EXPECT_STREQ(read.name.c_str()  , "rootdummy");
+	EXPECT_STREQ(read.parent.c_str(), "NULL");
+
+	EXPECT_EQ(read.position[2], 4.0f);
+
+	EXPECT_TRUE(read.render);
+	EXPECT_FALSE(read.hasMesh);
+
+	EXPECT_TRUE(read.textures.empty());
+	EXPECT_TRUE(read.vertices.empty());
+	EXPECT_TRUE(read.indices.empty());
+}
+
+GTEST_TEST(Model_NWN, compiledNodeInvalidIndex) {
+	CompiledNode node;
+	createMeshNode(node);
+
+	node.indices.push_back(3);
+
+	Common::MemoryWriteStreamDynamic compiled(true);
+	Graphics::Aurora::Model_NWN::writeCompiledNode(compiled, node);
+
+	Common::MemoryReadStream stream(compiled.getData(), compiled.size());
+
+	CompiledNode read;
+	EXPECT_THROW(Graphics::Aurora::Model_NWN::readCompiledNode(stream, read), Common::Exception);
+}
+
+GTEST_TEST(Model_NWN, compiledNodeInvalidVertexSize) {
+	CompiledNode node;
+	createMeshNode(node);
+
+	node.vertices.pop_back();
+
+	Common::MemoryWriteStreamDynamic compiled(true);
+	Graphics::Aurora::Model_NWN::writeCompiledNode(compiled, node);
+
+	Common::MemoryReadStream stream(compiled.getData(), compiled.size());
+
+	CompiledNode read;
+	EXPECT_THROW(Graphics::Aurora::Model_NWN::readCompiledNode(stream, read), Common::Exception);
+}
+
+GTEST_TEST(Model_NWN, compiledNodeTruncated) {
+	CompiledNode node;
+	createMeshNode(node);
+
+	Common::MemoryWriteStreamDynamic compiled(true);
+	Graphics::Aurora::Model_NWN::writeCompiledNode(compiled, node);
+
+	Common::MemoryReadStream stream(compiled.getData(), compiled.size() - 4);
+
+	CompiledNode read;
+	EXPECT_THROW(Graphics::Aurora::Model_NWN::readCompiledNode(stream, read), Common::Exception);
+}
@@ -0,0 +1,54 @@
+# xoreos - A reimplementation of BioWare's Aurora engine
+#
+# xoreos is the legal property of its developers, whose names
+# can be found in the AUTHORS file distributed with this source
+# distribution.
+#
+# xoreos is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 3
+# of the License, or (at your option) any later version.
+#
+# xoreos is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+
+# Unit tests for the Graphics namespace.
+
+graphics_LIBS = \
+    $(test_LIBS) \
+    src/graphics/libgraphics.la \
+    src/aurora/libaurora.la \
+    src/common/libcommon.la \
+    src/events/libevents.la \
+    tests/version/libversion.la \
+    $(LDADD)
+
+check_PROGRAMS                       += tests/graphics/test_model_nwn
+tests_graphics_test_model_nwn_SOURCES  = tests/graphics/model_nwn.cpp
+tests_graphics_test_model_nwn_LDADD    = $(graphics_LIBS)
+tests_graphics_test_model_nwn_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                              += tests/graphics/test_chunkedgeometry
+tests_graphics_test_chunkedgeometry_SOURCES  = tests/graphics/chunkedgeometry.cpp
+tests_graphics_test_chunkedgeometry_LDADD    = $(graphics_LIBS)
+tests_graphics_test_chunkedgeometry_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                           += tests/graphics/test_vertexcache
+tests_graphics_test_vertexcache_SOURCES  = tests/graphics/vertexcache.cpp
+tests_graphics_test_vertexcache_LDADD    = $(graphics_LIBS)
+tests_graphics_test_vertexcache_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                    += tests/graphics/test_mesh
+tests_graphics_test_mesh_SOURCES  = tests/graphics/mesh.cpp
+tests_graphics_test_mesh_LDADD    = $(graphics_LIBS)
+tests_graphics_test_mesh_CXXFLAGS = $(test_CXXFLAGS)
+
+check_PROGRAMS                          += tests/graphics/test_fpscounter
+tests_graphics_test_fpscounter_SOURCES  = tests/graphics/fpscounter.cpp
+tests_graphics_test_fpscounter_LDADD    = $(graphics_LIBS)
+tests_graphics_test_fpscounter_CXXFLAGS = $(test_CXXFLAGS)
@@ -0,0 +1,140 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for the post-transform vertex cache optimization.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/common/util.h"
+
+#include "src/graphics/mesh/vertexcache.h"
+
+/** Number of quads along each side of the test grid. */
+static const size_t kGridSize = 32;
+
+/** Create a grid of quads, with the triangles in a scattered order. */
+template<typename T>
+static std::vector<T> createScatteredGrid() {
+	std::vector<T> triangles;
+
+	for (size_t y = 0; y < kGridSize; y++) {
+		for (size_t x = 0; x < kGridSize; x++) {
+			const T v = y * (kGridSize + 1) + x;
+
+			triangles.push_back(v);
+			triangles.push_back(v + 1);
+			triangles.push_back(v + kGridSize + 2);
+
+			triangles.push_back(v);
+			triangles.push_back(v + kGridSize + 2);
+			triangles.push_back(v + kGridSize + 1);
+		}
+	}
+
+	// Stride through the triangles, so that consecutive ones don't share vertices
+	const size_t triangleCount = triangles.size() / 3;
+	const size_t stride = 97;
+
+	std::vector<T> scattered;
+	for (size_t i = 0; i < triangleCount; i++) {
+		const size_t t = (i * stride) % triangleCount;
+
+		scattered.insert(scattered.end(), triangles.begin() + t * 3, triangles.begin() + t * 3 + 3);
+	}
+
+	return scattered;
+}
+
+/** Return the triangles, each rotated to start with its smallest index, sorted. */
+template<typename T>
+static std::vector< std::vector<T> > getTriangleSet(const std::vector<T> &indices) {
+	std::vector< std::vector<T> > triangles;
+
+	for (size_t i = 0; (i + 2) < indices.size(); i += 3) {
+		std::vector<T> triangle(indices.begin() + i, indices.begin() + i + 3);
+		std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+
+		triangles.push_back(triangle);
+	}
+
+	std::sort(triangles.begin(), triangles.end());
+	return triangles;
+}
+
+template<typename T>
+static void testOptimize() {
+	const size_t vertexCount = (kGridSize + 1) * (kGridSize + 1);
+
+	const std::vector<T> scattered = createScatteredGrid<T>();
+
+	std::vector<T> optimized = scattered;
+	Graphics::Mesh::optimizeVertexCache(optimized.data(), optimized.size(), vertexCount);
+
+	// Same triangles, with the same winding, just in a different order
+	EXPECT_EQ(getTriangleSet(optimized), getTriangleSet(scattered));
+
+	const float acmrBefore = Graphics::Mesh::getACMR(scattered.data(), scattered.size());
+	const float acmrAfter  = Graphics::Mesh::getACMR(optimized.data(), optimized.size());
+
+	EXPECT_LT(acmrAfter, acmrBefore);
+
+	// A regular grid should get close to the ideal of 0.5
+	EXPECT_LT(acmrAfter, 1.0f);
+}
+
+GTEST_TEST(VertexCache, optimize16) {
+	testOptimize<uint16>();
+}
+
+GTEST_TEST(VertexCache, optimize32) {
+	testOptimize<uint32>();
+}
+
+GTEST_TEST(VertexCache, invalidIndex) {
+	std::vector<uint16> indices = createScatteredGrid<uint16>();
+	indices[5] = (kGridSize + 1) * (kGridSize + 1);
+
+	const std::vector<uint16> original = indices;
+
+	// An index outside the vertices leaves the indices alone
+	Graphics::Mesh::optimizeVertexCache(indices.data(), indices.size(), (kGridSize + 1) * (kGridSize + 1));
+
+	EXPECT_EQ(indices, original);
+}
+
+GTEST_TEST(VertexCache, getACMR) {
+	// Two triangles sharing an edge: 4 vertices for 2 triangles
+	static const uint16 kQuad[] = { 0, 1, 2, 0, 2, 3 };
+	EXPECT_FLOAT_EQ(Graphics::Mesh::getACMR(kQuad, ARRAYSIZE(kQuad)), 2.0f);
+
+	// Two separate triangles: 6 vertices for 2 triangles
+	static const uint32 kSeparate[] = { 0, 1, 2, 3, 4, 5 };
+	EXPECT_FLOAT_EQ(Graphics::Mesh::getACMR(kSeparate, ARRAYSIZE(kSeparate)), 3.0f);
+
+	// With a cache of 1, the shared vertices have already been evicted again
+	EXPECT_FLOAT_EQ(Graphics::Mesh::getACMR(kQuad, ARRAYSIZE(kQuad), 1), 3.0f);
+
+	EXPECT_FLOAT_EQ(Graphics::Mesh::getACMR(kQuad, 0), 0.0f);
+}
@@ -32,6 +32,11 @@ tests_images_test_util_SOURCES  = tests/images/util.cpp
 tests_images_test_util_LDADD    = $(images_LIBS)
 tests_images_test_util_CXXFLAGS = $(test_CXXFLAGS)
 
+check_PROGRAMS                    += tests/images/test_swizzle
+tests_images_test_swizzle_SOURCES  = tests/images/swizzle.cpp
+tests_images_test_swizzle_LDADD    = $(images_LIBS)
+tests_images_test_swizzle_CXXFLAGS = $(test_CXXFLAGS)
+
 check_PROGRAMS                    += tests/images/test_surface
 tests_images_test_surface_SOURCES  = tests/images/surface.cpp
 tests_images_test_surface_LDADD    = $(images_LIBS)
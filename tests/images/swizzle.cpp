@@ -0,0 +1,135 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names
+ * can be found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * xoreos is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * xoreos is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with xoreos. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/** @file
+ *  Unit tests for our texture de-swizzling.
+ */
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "src/graphics/images/util.h"
+#include "src/graphics/images/swizzle.h"
+
+/** Fill a buffer with a recognizable pattern. */
+static void fillPattern(std::vector<byte> &data) {
+	for (size_t i = 0; i < data.size(); i++)
+		data[i] = (byte) ((i * 7) ^ (i >> 8));
+}
+
+/** De-swizzle the slow way, one pixel at a time. */
+static void deSwizzleReference(byte *dst, const byte *src, uint32 width, uint32 height, uint32 bpp) {
+	for (uint32 y = 0; y < height; y++) {
+		for (uint32 x = 0; x < width; x++) {
+			const uint32 offset = Graphics::deSwizzleOffset(x, y, width, height) * bpp;
+
+			for (uint32 p = 0; p < bpp; p++)
+				*dst++ = src[offset + p];
+		}
+	}
+}
+
+static void testDeSwizzle(uint32 width, uint32 height, uint32 bpp) {
+	std::vector<byte> src(width * height * bpp);
+	fillPattern(src);
+
+	std::vector<byte> dst(src.size()), reference(src.size());
+
+	Graphics::deSwizzle(&dst[0], &src[0], width, height, bpp);
+	deSwizzleReference(&reference[0], &src[0], width, height, bpp);
+
+	for (size_t i = 0; i < src.size(); i++)
+		ASSERT_EQ(dst[i], reference[i]) << "At index " << i << " (" << width << "x" << height << "x" << bpp << ")";
+}
+
+GTEST_TEST(DeSwizzleTable, getOffset) {
+	static const uint32 kWidth = 4, kHeight = 4;
+	static const uint32 kSwizzled[kWidth * kHeight] = {
+		 0,  1,  4,  5,
+		 2,  3,  6,  7,
+		 8,  9, 12, 13,
+		10, 11, 14, 15,
+	};
+
+	const Graphics::DeSwizzleTable table(kWidth, kHeight);
+
+	for (uint32 y = 0; y < kHeight; y++)
+		for (uint32 x = 0; x < kWidth; x++)
+			EXPECT_EQ(table.getOffset(x, y), kSwizzled[y * kWidth + x]) << "At " << x << "." << y;
+}
+
+GTEST_TEST(DeSwizzleTable, getOffsetReference) {
+	static const uint32 kSizes[] = { 1, 2, 3, 4, 5, 8, 16, 31, 32, 64, 100, 128, 512 };
+
+	for (size_t w = 0; w < ARRAYSIZE(kSizes); w++) {
+		for (size_t h = 0; h < ARRAYSIZE(kSizes); h++) {
+			const uint32 width = kSizes[w], height = kSizes[h];
+
+			const Graphics::DeSwizzleTable table(width, height);
+
+			for (uint32 y = 0; y < height; y++)
+				for (uint32 x = 0; x < width; x++)
+					ASSERT_EQ(table.getOffset(x, y), Graphics::deSwizzleOffset(x, y, width, height))
+						<< "At " << x << "." << y << " (" << width << "x" << height << ")";
+		}
+	}
+}
+
+GTEST_TEST(DeSwizzleTable, getOffsetCount) {
+	// Coordinates beyond the texture dimensions, like SBM characters use them
+	static const uint32 kRowCounts[] = { 1, 2, 3, 7, 8, 33 };
+
+	for (size_t i = 0; i < ARRAYSIZE(kRowCounts); i++) {
+		const Graphics::DeSwizzleTable table(32, kRowCounts[i], 32, 32);
+
+		for (uint32 y = 0; y < 32; y++)
+			for (uint32 x = 0; x < 32; x++)
+				ASSERT_EQ(table.getOffset(x, y), Graphics::deSwizzleOffset(x, y, 32, kRowCounts[i]))
+					<< "At " << x << "." << y << " (" << kRowCounts[i] << ")";
+	}
+}
+
+GTEST_TEST(DeSwizzle, square) {
+	testDeSwizzle(  1,   1, 4);
+	testDeSwizzle(  4,   4, 4);
+	testDeSwizzle( 64,  64, 4);
+	testDeSwizzle(256, 256, 3);
+}
+
+GTEST_TEST(DeSwizzle, rectangle) {
+	testDeSwizzle(  8,   2, 4);
+	testDeSwizzle(  2,   8, 4);
+	testDeSwizzle(128,  32, 1);
+	testDeSwizzle( 16, 512, 3);
+}
+
+GTEST_TEST(DeSwizzle, nonPowerOfTwoHeight) {
+	testDeSwizzle( 16,  12, 4);
+	testDeSwizzle( 64,  50, 3);
+	testDeSwizzle(256, 300, 4);
+}
+
+GTEST_TEST(DeSwizzle, large) {
+	// Large enough to be split over several threads
+	testDeSwizzle(1024, 1024, 4);
+	testDeSwizzle( 512, 2048, 2);
+	testDeSwizzle(1024,  256, 5);
+}